@@ -0,0 +1,545 @@
+//*****************************************************************************
+//
+// IQmathFixed.h - A C++ fixed-point type for any IQ format, built on a single
+//                 template rather than a structure per format.
+//
+//*****************************************************************************
+
+#ifndef __IQMATHFIXED_H__
+#define __IQMATHFIXED_H__
+
+//*****************************************************************************
+//
+// The type needs a C++11 compiler, for constexpr.  IQmathCPP.h provides the
+// older per-format classes for compilers without it.  Values are held in 32
+// bits whatever the size of a long, so that a table computed on the host is
+// the same as on the target.
+//
+//*****************************************************************************
+#if !defined(__cplusplus) || (__cplusplus < 201103L)
+#error "IQmathFixed.h requires a C++11 compiler."
+#endif
+
+#include <stdint.h>
+
+//*****************************************************************************
+//
+// The policies that a fixed-point type follows for the results of arithmetic
+// that do not fit exactly.  By default, as with _IQmpy(), products are
+// truncated and results that overflow wrap around.  FIXED_ROUND rounds
+// products, conversions and quotients to the nearest value, as with
+// _IQrmpy(), and FIXED_SATURATE limits results that overflow to the largest
+// or smallest value, as with _IQrsmpy().  Division always saturates, as with
+// _IQdiv().  The policies of the left operand apply to the result.
+//
+//*****************************************************************************
+#define FIXED_TRUNCATE          0
+#define FIXED_ROUND             1
+#define FIXED_SATURATE          2
+
+//*****************************************************************************
+//
+// The largest and smallest values held by a fixed-point type.
+//
+//*****************************************************************************
+#define FIXED_MAX               ((int64_t)2147483647)
+#define FIXED_MIN               (-FIXED_MAX - 1)
+
+//*****************************************************************************
+//
+// The type and everything that operates on it are in the IQmath namespace, so
+// that the short names fixed, mpy and abs do not collide with those of the
+// application or the standard library.  Operators and the array functions
+// are found from their arguments; mpy<QR>() must be named as IQmath::mpy.
+//
+//*****************************************************************************
+namespace IQmath
+{
+
+//*****************************************************************************
+//
+// Helpers for the type, which are each a single expression so that they can
+// be evaluated at compile time.
+//
+//*****************************************************************************
+
+//
+// Narrows a result to 32 bits, saturating it or letting it wrap.
+//
+constexpr int32_t
+FixedNarrow(int64_t llValue, unsigned uPolicy)
+{
+    return((uPolicy & FIXED_SATURATE) ?
+           ((llValue > FIXED_MAX) ? (int32_t)FIXED_MAX :
+            (llValue < FIXED_MIN) ? (int32_t)FIXED_MIN : (int32_t)llValue) :
+           (int32_t)llValue);
+}
+
+//
+// Shifts a value right by the given number of bits, or left by minus that
+// number, rounding if the policy asks for it.  The shift is known at
+// compile time, so only one of the branches is generated.
+//
+constexpr int64_t
+FixedShift(int64_t llValue, int iShift, unsigned uPolicy)
+{
+    return((iShift > 0) ?
+           ((uPolicy & FIXED_ROUND) ?
+            ((llValue + ((int64_t)1 << (iShift - 1))) >> iShift) :
+            (llValue >> iShift)) :
+           (llValue * ((int64_t)1 << -iShift)));
+}
+
+//
+// Scales a value to a format with more fractional bits, so that two values
+// can be compared.
+//
+constexpr int64_t
+FixedAlign(int32_t lValue, int iQ, int iQOther)
+{
+    return((int64_t)lValue * ((int64_t)1 << ((iQOther > iQ) ?
+                                             (iQOther - iQ) : 0)));
+}
+
+//
+// Rounds a scaled double to the nearest value, saturating it.
+//
+constexpr int32_t
+FixedRoundDouble(double dValue)
+{
+    return((dValue >= 2147483647.0) ? (int32_t)FIXED_MAX :
+           (dValue <= -2147483648.0) ? (int32_t)FIXED_MIN :
+           (int32_t)((dValue >= 0) ? (dValue + 0.5) : (dValue - 0.5)));
+}
+
+//
+// Divides, saturating the quotient.  A quotient by zero saturates by the sign
+// of the dividend.
+//
+constexpr int32_t
+FixedDivide(int64_t llNum, int32_t lDen, unsigned uPolicy)
+{
+    return((lDen == 0) ? ((llNum < 0) ? (int32_t)FIXED_MIN :
+                          (int32_t)FIXED_MAX) :
+           FixedNarrow((uPolicy & FIXED_ROUND) ?
+                       (((llNum < 0) == (lDen < 0)) ?
+                        ((llNum + (lDen / 2)) / lDen) :
+                        ((llNum - (lDen / 2)) / lDen)) :
+                       (llNum / lDen), FIXED_SATURATE));
+}
+
+//*****************************************************************************
+//
+// A fixed-point number with Q fractional bits, from 0 to 31, which follows
+// the given policies.  A constant is made from a literal at compile time:
+//
+//     constexpr IQmath::fixed<16> sGain(1.25);
+//
+// A table of constants is placed in flash with no code to convert it at
+// startup.  Values in different formats can be mixed freely; the shifts
+// between them are found at compile time.
+//
+//*****************************************************************************
+template<int Q, unsigned P = FIXED_TRUNCATE>
+class fixed
+{
+    static_assert((Q >= 0) && (Q <= 31), "The format must be Q0 to Q31");
+
+public:
+    //
+    // Constructs a zero.
+    //
+    constexpr fixed() : val(0)
+    {
+    }
+
+    //
+    // Constructs the nearest value to a floating-point number, saturated.
+    // This is done at compile time for a constant.
+    //
+    constexpr explicit fixed(double dValue) :
+        val(FixedRoundDouble(dValue * (double)((int64_t)1 << Q)))
+    {
+    }
+
+    //
+    // Constructs a value from one in another format, following the policies
+    // of this type.
+    //
+    template<int QX, unsigned PX>
+    constexpr explicit fixed(const fixed<QX, PX> &sValue) :
+        val(FixedNarrow(FixedShift(sValue.val, QX - Q, P), P))
+    {
+    }
+
+    //
+    // Constructs a value from its representation.
+    //
+    static constexpr fixed
+    raw(int32_t lValue)
+    {
+        return(fixed(lValue, 0));
+    }
+
+    //
+    // Converts the value to floating-point, or to an integer rounded toward
+    // minus infinity as with _IQint().
+    //
+    constexpr float
+    toFloat() const
+    {
+        return((float)val * (1.0f / (float)((int64_t)1 << Q)));
+    }
+
+    constexpr double
+    toDouble() const
+    {
+        return((double)val * (1.0 / (double)((int64_t)1 << Q)));
+    }
+
+    constexpr int32_t
+    toInt() const
+    {
+        return(val >> Q);
+    }
+
+    //
+    // Arithmetic operators that update the value, with a value in any
+    // format.
+    //
+    template<int QX, unsigned PX> fixed &operator+=(const fixed<QX, PX> &sB);
+    template<int QX, unsigned PX> fixed &operator-=(const fixed<QX, PX> &sB);
+    template<int QX, unsigned PX> fixed &operator*=(const fixed<QX, PX> &sB);
+    template<int QX, unsigned PX> fixed &operator/=(const fixed<QX, PX> &sB);
+
+    //
+    // The representation of the number, which is the value times 2^Q.
+    //
+    int32_t val;
+
+private:
+    //
+    // Constructs a value from its representation, for raw().
+    //
+    constexpr fixed(int32_t lValue, int) : val(lValue)
+    {
+    }
+};
+
+//*****************************************************************************
+//
+// Operators "+" and "-".  The right operand is converted to the format of
+// the left.
+//
+//*****************************************************************************
+template<int QA, unsigned PA>
+constexpr fixed<QA, PA>
+operator-(const fixed<QA, PA> &sA)
+{
+    return(fixed<QA, PA>::raw(FixedNarrow(-(int64_t)sA.val, PA)));
+}
+
+template<int QA, unsigned PA, int QB, unsigned PB>
+constexpr fixed<QA, PA>
+operator+(const fixed<QA, PA> &sA, const fixed<QB, PB> &sB)
+{
+    return(fixed<QA, PA>::raw(FixedNarrow((int64_t)sA.val +
+                                          FixedShift(sB.val, QB - QA, PA),
+                                          PA)));
+}
+
+template<int QA, unsigned PA, int QB, unsigned PB>
+constexpr fixed<QA, PA>
+operator-(const fixed<QA, PA> &sA, const fixed<QB, PB> &sB)
+{
+    return(fixed<QA, PA>::raw(FixedNarrow((int64_t)sA.val -
+                                          FixedShift(sB.val, QB - QA, PA),
+                                          PA)));
+}
+
+//*****************************************************************************
+//
+// Operators "*" and "/".  The result is in the format of the left operand, so
+// the product is shifted by the fractional bits of the right.  mpy<QR>()
+// gives the product in any other format, as with _IQmpyIQX().
+//
+//*****************************************************************************
+template<int QA, unsigned PA, int QB, unsigned PB>
+constexpr fixed<QA, PA>
+operator*(const fixed<QA, PA> &sA, const fixed<QB, PB> &sB)
+{
+    return(fixed<QA, PA>::raw(FixedNarrow(FixedShift((int64_t)sA.val * sB.val,
+                                                     QB, PA), PA)));
+}
+
+template<int QR, unsigned PR = FIXED_TRUNCATE, int QA, unsigned PA, int QB,
+         unsigned PB>
+constexpr fixed<QR, PR>
+mpy(const fixed<QA, PA> &sA, const fixed<QB, PB> &sB)
+{
+    return(fixed<QR, PR>::raw(FixedNarrow(FixedShift((int64_t)sA.val * sB.val,
+                                                     QA + QB - QR, PR), PR)));
+}
+
+template<int QA, unsigned PA, int QB, unsigned PB>
+constexpr fixed<QA, PA>
+operator/(const fixed<QA, PA> &sA, const fixed<QB, PB> &sB)
+{
+    return(fixed<QA, PA>::raw(FixedDivide((int64_t)sA.val * ((int64_t)1 << QB),
+                                          sB.val, PA)));
+}
+
+//*****************************************************************************
+//
+// Multiplication and division by an integer, as with _IQmpyI32().
+//
+//*****************************************************************************
+template<int QA, unsigned PA>
+constexpr fixed<QA, PA>
+operator*(const fixed<QA, PA> &sA, int32_t lB)
+{
+    return(fixed<QA, PA>::raw(FixedNarrow((int64_t)sA.val * lB, PA)));
+}
+
+template<int QA, unsigned PA>
+constexpr fixed<QA, PA>
+operator*(int32_t lA, const fixed<QA, PA> &sB)
+{
+    return(sB * lA);
+}
+
+template<int QA, unsigned PA>
+constexpr fixed<QA, PA>
+operator/(const fixed<QA, PA> &sA, int32_t lB)
+{
+    return(fixed<QA, PA>::raw(FixedDivide(sA.val, lB, PA)));
+}
+
+//*****************************************************************************
+//
+// Operators "==", "!=", "<", ">", "<=" and ">=", which compare the values
+// exactly whatever their formats.
+//
+//*****************************************************************************
+template<int QA, unsigned PA, int QB, unsigned PB>
+constexpr bool
+operator==(const fixed<QA, PA> &sA, const fixed<QB, PB> &sB)
+{
+    return(FixedAlign(sA.val, QA, QB) == FixedAlign(sB.val, QB, QA));
+}
+
+template<int QA, unsigned PA, int QB, unsigned PB>
+constexpr bool
+operator!=(const fixed<QA, PA> &sA, const fixed<QB, PB> &sB)
+{
+    return(!(sA == sB));
+}
+
+template<int QA, unsigned PA, int QB, unsigned PB>
+constexpr bool
+operator<(const fixed<QA, PA> &sA, const fixed<QB, PB> &sB)
+{
+    return(FixedAlign(sA.val, QA, QB) < FixedAlign(sB.val, QB, QA));
+}
+
+template<int QA, unsigned PA, int QB, unsigned PB>
+constexpr bool
+operator>(const fixed<QA, PA> &sA, const fixed<QB, PB> &sB)
+{
+    return(sB < sA);
+}
+
+template<int QA, unsigned PA, int QB, unsigned PB>
+constexpr bool
+operator<=(const fixed<QA, PA> &sA, const fixed<QB, PB> &sB)
+{
+    return(!(sB < sA));
+}
+
+template<int QA, unsigned PA, int QB, unsigned PB>
+constexpr bool
+operator>=(const fixed<QA, PA> &sA, const fixed<QB, PB> &sB)
+{
+    return(!(sA < sB));
+}
+
+//*****************************************************************************
+//
+// The absolute value, saturated if the policy asks for it.
+//
+//*****************************************************************************
+template<int QA, unsigned PA>
+constexpr fixed<QA, PA>
+abs(const fixed<QA, PA> &sA)
+{
+    return((sA.val < 0) ? -sA : sA);
+}
+
+//*****************************************************************************
+//
+// The operators that update a value.
+//
+//*****************************************************************************
+template<int Q, unsigned P>
+template<int QX, unsigned PX>
+inline fixed<Q, P> &
+fixed<Q, P>::operator+=(const fixed<QX, PX> &sB)
+{
+    return(*this = *this + sB);
+}
+
+template<int Q, unsigned P>
+template<int QX, unsigned PX>
+inline fixed<Q, P> &
+fixed<Q, P>::operator-=(const fixed<QX, PX> &sB)
+{
+    return(*this = *this - sB);
+}
+
+template<int Q, unsigned P>
+template<int QX, unsigned PX>
+inline fixed<Q, P> &
+fixed<Q, P>::operator*=(const fixed<QX, PX> &sB)
+{
+    return(*this = *this * sB);
+}
+
+template<int Q, unsigned P>
+template<int QX, unsigned PX>
+inline fixed<Q, P> &
+fixed<Q, P>::operator/=(const fixed<QX, PX> &sB)
+{
+    return(*this = *this / sB);
+}
+
+//*****************************************************************************
+//
+// Functions that process an array of values in one call, so that the loop
+// is compiled once for the formats in use and the shifts are constants.
+//
+//*****************************************************************************
+
+//
+// Converts an array of values to another format.
+//
+template<int QO, unsigned PO, int QI, unsigned PI>
+inline void
+FixedConvert(fixed<QO, PO> *psOut, const fixed<QI, PI> *psIn,
+             unsigned long ulCount)
+{
+    unsigned long ulIdx;
+
+    for(ulIdx = 0; ulIdx < ulCount; ulIdx++)
+    {
+        psOut[ulIdx] = fixed<QO, PO>(psIn[ulIdx]);
+    }
+}
+
+//
+// Converts an array of floating-point values to fixed-point, and back.
+//
+template<int Q, unsigned P>
+inline void
+FixedFromFloat(fixed<Q, P> *psOut, const float *pfIn, unsigned long ulCount)
+{
+    unsigned long ulIdx;
+
+    for(ulIdx = 0; ulIdx < ulCount; ulIdx++)
+    {
+        psOut[ulIdx] = fixed<Q, P>(pfIn[ulIdx]);
+    }
+}
+
+template<int Q, unsigned P>
+inline void
+FixedToFloat(float *pfOut, const fixed<Q, P> *psIn, unsigned long ulCount)
+{
+    unsigned long ulIdx;
+
+    for(ulIdx = 0; ulIdx < ulCount; ulIdx++)
+    {
+        pfOut[ulIdx] = psIn[ulIdx].toFloat();
+    }
+}
+
+//
+// Adds two arrays of values.
+//
+template<int Q, unsigned P, int QB, unsigned PB>
+inline void
+FixedAdd(fixed<Q, P> *psOut, const fixed<Q, P> *psA,
+         const fixed<QB, PB> *psB, unsigned long ulCount)
+{
+    unsigned long ulIdx;
+
+    for(ulIdx = 0; ulIdx < ulCount; ulIdx++)
+    {
+        psOut[ulIdx] = psA[ulIdx] + psB[ulIdx];
+    }
+}
+
+//
+// Multiplies an array of values by a scale factor in any format.
+//
+template<int Q, unsigned P, int QS, unsigned PS>
+inline void
+FixedScale(fixed<Q, P> *psOut, const fixed<Q, P> *psIn,
+           const fixed<QS, PS> &sScale, unsigned long ulCount)
+{
+    unsigned long ulIdx;
+
+    for(ulIdx = 0; ulIdx < ulCount; ulIdx++)
+    {
+        psOut[ulIdx] = psIn[ulIdx] * sScale;
+    }
+}
+
+//
+// Blends two arrays of values, giving A + (B - A) * T, where T is from 0 to
+// 1, such as for a step of an animation between two frames.  The difference
+// is found as B * T - A * T, from two 32x32->64 multiplies, so that it does
+// not overflow.
+//
+template<int Q, unsigned P, int QT, unsigned PT>
+inline void
+FixedLerp(fixed<Q, P> *psOut, const fixed<Q, P> *psA, const fixed<Q, P> *psB,
+          const fixed<QT, PT> &sT, unsigned long ulCount)
+{
+    unsigned long ulIdx;
+
+    for(ulIdx = 0; ulIdx < ulCount; ulIdx++)
+    {
+        psOut[ulIdx] = fixed<Q, P>::raw(
+            FixedNarrow(psA[ulIdx].val +
+                        FixedShift(((int64_t)psB[ulIdx].val * sT.val) -
+                                   ((int64_t)psA[ulIdx].val * sT.val), QT,
+                                   P), P));
+    }
+}
+
+//
+// Returns the sum of the products of two arrays of values, in the format of
+// the first.  The products are summed in 64 bits and shifted once at the
+// end, which is both faster and more accurate than summing the products
+// after each is shifted.
+//
+template<int Q, unsigned P, int QB, unsigned PB>
+inline fixed<Q, P>
+FixedDot(const fixed<Q, P> *psA, const fixed<QB, PB> *psB,
+         unsigned long ulCount)
+{
+    unsigned long ulIdx;
+    int64_t llSum;
+
+    llSum = 0;
+    for(ulIdx = 0; ulIdx < ulCount; ulIdx++)
+    {
+        llSum += (int64_t)psA[ulIdx].val * psB[ulIdx].val;
+    }
+
+    return(fixed<Q, P>::raw(FixedNarrow(FixedShift(llSum, QB, P), P)));
+}
+
+} // namespace IQmath
+
+#endif // __IQMATHFIXED_H__
@@ -0,0 +1,1151 @@
+//*****************************************************************************
+//
+// iqmath.c - A C implementation of the IQmath library, for all IQ formats.
+//
+//*****************************************************************************
+
+#include <stdint.h>
+
+//*****************************************************************************
+//
+// This file implements the fixed-point functions, whatever the build chooses
+// for the rest of the application.
+//
+//*****************************************************************************
+#ifdef MATH_TYPE
+#undef MATH_TYPE
+#endif
+#define MATH_TYPE               IQ_MATH
+#include "IQmath/IQmathLib.h"
+
+//*****************************************************************************
+//
+// The values are held in a long, as declared by IQmathLib.h, but are 32 bit
+// values.  The arithmetic is done with explicitly sized types so that the
+// results are the same on a 64 bit host, where a long is wider, as on the
+// target.  Results that do not fit are saturated to these limits.
+//
+//*****************************************************************************
+#define IQ_MAX                  ((int32_t)0x7fffffff)
+#define IQ_MIN                  (-IQ_MAX - 1)
+
+//*****************************************************************************
+//
+// Counts the leading zeros in a non-zero 32 bit value, with the CLZ
+// instruction where the compiler provides a way to use it.
+//
+//*****************************************************************************
+#if defined(codered) || defined(gcc) || defined(sourcerygxx) || \
+    defined(__GNUC__)
+#define IQ_CLZ(ulValue)         __builtin_clz(ulValue)
+#elif defined(ewarm)
+#include <intrinsics.h>
+#define IQ_CLZ(ulValue)         __CLZ(ulValue)
+#elif defined(rvmdk) || defined(__ARMCC_VERSION)
+#define IQ_CLZ(ulValue)         __clz(ulValue)
+#else
+#define IQ_CLZ(ulValue)         IQCountLeadingZeros(ulValue)
+static int
+IQCountLeadingZeros(uint32_t ulValue)
+{
+    int iCount;
+
+    iCount = 0;
+    if(!(ulValue & 0xffff0000))
+    {
+        iCount += 16;
+        ulValue <<= 16;
+    }
+    if(!(ulValue & 0xff000000))
+    {
+        iCount += 8;
+        ulValue <<= 8;
+    }
+    if(!(ulValue & 0xf0000000))
+    {
+        iCount += 4;
+        ulValue <<= 4;
+    }
+    if(!(ulValue & 0xc0000000))
+    {
+        iCount += 2;
+        ulValue <<= 2;
+    }
+    if(!(ulValue & 0x80000000))
+    {
+        iCount++;
+    }
+
+    return(iCount);
+}
+#endif
+
+//*****************************************************************************
+//
+// Constants used by the kernels, in the fixed-point format given by their
+// names.  Angles are handled internally as a phase, where a full turn is
+// 2^32, so that wrapping around the circle is free.  log2(e) is split into
+// two words, since exp() of a large value needs more than 32 bits of it.
+//
+//*****************************************************************************
+#define IQ_PI_Q30               INT64_C(3373259426)
+#define IQ_TWO_PI_Q29           INT64_C(3373259426)
+#define IQ_TURNS_PER_RADIAN_Q34 INT64_C(2734261102)
+#define IQ_TURNS_PER_RADIAN_Q32 INT64_C(683565276)
+#define IQ_LOG2E_Q30            INT64_C(1549082004)
+#define IQ_LOG2E_LOW_Q62        INT64_C(2920020062)
+#define IQ_LN2_Q32              UINT64_C(2977044472)
+#define IQ_SQRT2_Q30            UINT64_C(1518500250)
+
+//*****************************************************************************
+//
+// The sine of each 1/256 of a turn, in Q30.  The cosine is read from the
+// same table a quarter of a turn further on.
+//
+//*****************************************************************************
+static const int32_t g_plIQSinTable[256] =
+{
+             0,   26350943,   52686014,   78989349,  105245103,  131437462,
+     157550647,  183568930,  209476638,  235258165,  260897982,  286380643,
+     311690799,  336813204,  361732726,  386434353,  410903207,  435124548,
+     459083786,  482766489,  506158392,  529245404,  552013618,  574449320,
+     596538995,  618269338,  639627258,  660599890,  681174602,  701339000,
+     721080937,  740388522,  759250125,  777654384,  795590213,  813046808,
+     830013654,  846480531,  862437520,  877875009,  892783698,  907154608,
+     920979082,  934248793,  946955747,  959092290,  970651112,  981625251,
+     992008094, 1001793390, 1010975242, 1019548121, 1027506862, 1034846671,
+    1041563127, 1047652185, 1053110176, 1057933813, 1062120190, 1065666786,
+    1068571464, 1070832474, 1072448455, 1073418433, 1073741824, 1073418433,
+    1072448455, 1070832474, 1068571464, 1065666786, 1062120190, 1057933813,
+    1053110176, 1047652185, 1041563127, 1034846671, 1027506862, 1019548121,
+    1010975242, 1001793390,  992008094,  981625251,  970651112,  959092290,
+     946955747,  934248793,  920979082,  907154608,  892783698,  877875009,
+     862437520,  846480531,  830013654,  813046808,  795590213,  777654384,
+     759250125,  740388522,  721080937,  701339000,  681174602,  660599890,
+     639627258,  618269338,  596538995,  574449320,  552013618,  529245404,
+     506158392,  482766489,  459083786,  435124548,  410903207,  386434353,
+     361732726,  336813204,  311690799,  286380643,  260897982,  235258165,
+     209476638,  183568930,  157550647,  131437462,  105245103,   78989349,
+      52686014,   26350943,          0,  -26350943,  -52686014,  -78989349,
+    -105245103, -131437462, -157550647, -183568930, -209476638, -235258165,
+    -260897982, -286380643, -311690799, -336813204, -361732726, -386434353,
+    -410903207, -435124548, -459083786, -482766489, -506158392, -529245404,
+    -552013618, -574449320, -596538995, -618269338, -639627258, -660599890,
+    -681174602, -701339000, -721080937, -740388522, -759250125, -777654384,
+    -795590213, -813046808, -830013654, -846480531, -862437520, -877875009,
+    -892783698, -907154608, -920979082, -934248793, -946955747, -959092290,
+    -970651112, -981625251, -992008094,-1001793390,-1010975242,-1019548121,
+   -1027506862,-1034846671,-1041563127,-1047652185,-1053110176,-1057933813,
+   -1062120190,-1065666786,-1068571464,-1070832474,-1072448455,-1073418433,
+   -1073741824,-1073418433,-1072448455,-1070832474,-1068571464,-1065666786,
+   -1062120190,-1057933813,-1053110176,-1047652185,-1041563127,-1034846671,
+   -1027506862,-1019548121,-1010975242,-1001793390, -992008094, -981625251,
+    -970651112, -959092290, -946955747, -934248793, -920979082, -907154608,
+    -892783698, -877875009, -862437520, -846480531, -830013654, -813046808,
+    -795590213, -777654384, -759250125, -740388522, -721080937, -701339000,
+    -681174602, -660599890, -639627258, -618269338, -596538995, -574449320,
+    -552013618, -529245404, -506158392, -482766489, -459083786, -435124548,
+    -410903207, -386434353, -361732726, -336813204, -311690799, -286380643,
+    -260897982, -235258165, -209476638, -183568930, -157550647, -131437462,
+    -105245103,  -78989349,  -52686014,  -26350943
+};
+
+//*****************************************************************************
+//
+// The arctangent of i/64 for i from 0 to 64, as a phase.
+//
+//*****************************************************************************
+static const uint32_t g_pulIQAtanTable[65] =
+{
+    0x00000000, 0x00a2f61e, 0x0145d7e1, 0x01e890fd, 0x028b0d43, 0x032d38b4,
+    0x03ceff8a, 0x04704e4b, 0x051111d4, 0x05b13767, 0x0650acb7, 0x06ef5ff2,
+    0x078d3fcf, 0x082a3b95, 0x08c64325, 0x09614704, 0x09fb385b, 0x0a940907,
+    0x0b2bab95, 0x0bc2134c, 0x0c57342b, 0x0ceb02ef, 0x0d7d7515, 0x0e0e80d4,
+    0x0e9e1d24, 0x0f2c41b7, 0x0fb8e6f9, 0x1044060f, 0x10cd98d1, 0x115599c7,
+    0x11dc0423, 0x1260d3c2, 0x12e4051e, 0x1365954f, 0x13e58204, 0x1463c97a,
+    0x14e06a7b, 0x155b6450, 0x15d4b6c5, 0x164c6217, 0x16c266f7, 0x1736c67f,
+    0x17a9822d, 0x181a9bdb, 0x188a15bc, 0x18f7f252, 0x1964346e, 0x19cedf22,
+    0x1a37f5c5, 0x1a9f7be5, 0x1b057548, 0x1b69e5e6, 0x1bccd1e0, 0x1c2e3d81,
+    0x1c8e2d38, 0x1ceca593, 0x1d49ab3b, 0x1da542f1, 0x1dff718c, 0x1e583bf4,
+    0x1eafa71f, 0x1f05b80e, 0x1f5a73cd, 0x1faddf6b, 0x20000000
+};
+
+//*****************************************************************************
+//
+// The first estimate of 2^62/d, for d from 2^31 to 2^32 in 64 steps.
+//
+//*****************************************************************************
+static const uint32_t g_pulIQRecipTable[64] =
+{
+    0x7f01fc08, 0x7d119679, 0x7b301ecc, 0x795ceb24, 0x77975b90, 0x75ded953,
+    0x7432d63e, 0x7292cc15, 0x70fe3c07, 0x6f74ae26, 0x6df5b0f7, 0x6c80d902,
+    0x6b15c06b, 0x69b4069b, 0x685b4fe6, 0x670b453c, 0x65c393e0, 0x6483ed27,
+    0x634c0635, 0x621b97c3, 0x60f25deb, 0x5fd017f4, 0x5eb48824, 0x5d9f7391,
+    0x5c90a1fd, 0x5b87ddad, 0x5a84f345, 0x5987b1a9, 0x588fe9dc, 0x579d6ee3,
+    0x56b015ac, 0x55c7b4f1, 0x54e42524, 0x54054054, 0x532ae21d, 0x5254e78f,
+    0x51832f20, 0x50b59897, 0x4fec04ff, 0x4f265692, 0x4e6470b0, 0x4da637cf,
+    0x4ceb916d, 0x4c346405, 0x4b809701, 0x4ad012b4, 0x4a22c04a, 0x497889c2,
+    0x48d159e2, 0x482d1c32, 0x478bbced, 0x46ed2901, 0x46514e02, 0x45b81a25,
+    0x45217c38, 0x448d639d, 0x43fbc044, 0x436c82a2, 0x42df9bb1, 0x4254fce4,
+    0x41cc9829, 0x41465fdf, 0x40c246d4, 0x40404040
+};
+
+//*****************************************************************************
+//
+// The first estimate of 2^30/sqrt(d/2^32), for d from 2^30 to 2^32 in steps
+// of 2^25.
+//
+//*****************************************************************************
+static const uint32_t g_pulIQRsqrtTable[96] =
+{
+    0x7f02f623, 0x7d19fca0, 0x7b466dd8, 0x7986c4e4, 0x77d9a26e, 0x763dc824,
+    0x74b214d4, 0x73358118, 0x71c71c72, 0x70660acc, 0x6f11824c, 0x6dc8c96e,
+    0x6c8b355b, 0x6b582874, 0x6a2f1107, 0x690f682b, 0x67f8b0c5, 0x66ea769b,
+    0x65e44d8c, 0x64e5d0da, 0x63eea287, 0x62fe6ac2, 0x6214d764, 0x61319b7c,
+    0x60546ee2, 0x5f7d0dd6, 0x5eab38ac, 0x5ddeb37a, 0x5d1745d1, 0x5c54ba7d,
+    0x5b96df46, 0x5add84bb, 0x5a287e03, 0x5977a0ac, 0x58cac480, 0x5821c364,
+    0x577c7930, 0x56dac38e, 0x563c81e0, 0x55a19522, 0x5509dfd0, 0x547545d0,
+    0x53e3ac5b, 0x5354f9e7, 0x52c91618, 0x523fe9ac, 0x51b95e6b, 0x51355f1a,
+    0x50b3d768, 0x5034b3e7, 0x4fb7e1fa, 0x4f3d4fcf, 0x4ec4ec4f, 0x4e4ea718,
+    0x4dda7073, 0x4d683948, 0x4cf7f31b, 0x4c899000, 0x4c1d0294, 0x4bb23df9,
+    0x4b4935cf, 0x4ae1de2a, 0x4a7c2b93, 0x4a1812fa, 0x49b589bb, 0x49548592,
+    0x48f4fc97, 0x4896e53d, 0x483a364d, 0x47dee6e1, 0x4784ee60, 0x472c447c,
+    0x46d4e130, 0x467ebcba, 0x4629cf98, 0x45d6128a, 0x45837e88, 0x45320cc8,
+    0x44e1b6b4, 0x449275ed, 0x44444444, 0x43f71bbf, 0x43aaf68f, 0x435fcf15,
+    0x43159fdc, 0x42cc6398, 0x42841527, 0x423caf8d, 0x41f62df2, 0x41b08ba2,
+    0x416bc40d, 0x4127d2c3, 0x40e4b374, 0x40a261ef, 0x4060da22, 0x40201814
+};
+
+//*****************************************************************************
+//
+// 2^(i/64) for i from 0 to 63, in Q31.
+//
+//*****************************************************************************
+static const uint32_t g_pulIQExp2Table[64] =
+{
+    0x80000000, 0x8164d1f4, 0x82cd8699, 0x843a28c4, 0x85aac368, 0x871f6197,
+    0x88980e81, 0x8a14d575, 0x8b95c1e4, 0x8d1adf5b, 0x8ea4398b, 0x9031dc43,
+    0x91c3d374, 0x935a2b2f, 0x94f4efa9, 0x96942d37, 0x9837f052, 0x99e04593,
+    0x9b8d39ba, 0x9d3ed9a7, 0x9ef53261, 0xa0b05110, 0xa2704303, 0xa43515ae,
+    0xa5fed6aa, 0xa7cd93b5, 0xa9a15ab5, 0xab7a39b6, 0xad583eea, 0xaf3b78ad,
+    0xb123f582, 0xb311c413, 0xb504f334, 0xb6fd91e3, 0xb8fbaf47, 0xbaff5ab2,
+    0xbd08a39f, 0xbf1799b6, 0xc12c4cca, 0xc346ccda, 0xc5672a11, 0xc78d74c9,
+    0xc9b9bd86, 0xcbec14ff, 0xce248c15, 0xd06333db, 0xd2a81d92, 0xd4f35aac,
+    0xd744fccb, 0xd99d15c2, 0xdbfbb798, 0xde60f482, 0xe0ccdeec, 0xe33f8973,
+    0xe5b906e7, 0xe8396a50, 0xeac0c6e8, 0xed4f301f, 0xefe4b99c, 0xf281773c,
+    0xf5257d15, 0xf7d0df73, 0xfa83b2db, 0xfd3e0c0d
+};
+
+//*****************************************************************************
+//
+// Returns an estimate of 2^62/ulDen, for ulDen from 2^31 to 2^32, that is
+// within a few parts in 2^32.  A table gives eight bits, and two
+// Newton-Raphson steps, each of two long multiplies, give the rest.
+//
+//*****************************************************************************
+static uint32_t
+IQRecip(uint32_t ulDen)
+{
+    uint32_t ulRecip;
+    int64_t llErr;
+    int iStep;
+
+    ulRecip = g_pulIQRecipTable[(ulDen >> 25) & 63];
+    for(iStep = 0; iStep < 2; iStep++)
+    {
+        llErr = (int64_t)(((uint64_t)1 << 62) - ((uint64_t)ulDen * ulRecip));
+        ulRecip = (uint32_t)((int64_t)ulRecip +
+                             (((int64_t)ulRecip * (llErr >> 30)) >> 32));
+    }
+
+    return(ulRecip);
+}
+
+//*****************************************************************************
+//
+// Returns an estimate of 2^30/sqrt(ulValue/2^32), for ulValue from 2^30 to
+// 2^32, from a table and three Newton-Raphson steps.
+//
+//*****************************************************************************
+static uint32_t
+IQRsqrt(uint32_t ulValue)
+{
+    uint64_t ullSquare;
+    uint32_t ulRoot;
+    int32_t lErr;
+    int iStep;
+
+    ulRoot = g_pulIQRsqrtTable[(ulValue >> 25) - 32];
+    for(iStep = 0; iStep < 3; iStep++)
+    {
+        ullSquare = ((uint64_t)ulRoot * ulRoot) >> 30;
+        lErr = (int32_t)(0x40000000 - (int64_t)((ulValue * ullSquare) >> 32));
+        ulRoot = (uint32_t)((int64_t)ulRoot +
+                            (((int64_t)ulRoot * lErr) >> 31));
+    }
+
+    return(ulRoot);
+}
+
+//*****************************************************************************
+//
+// Returns the square root of a value below 2^63, rounded to the nearest
+// integer.  The estimate from IQRsqrt() is corrected to be exact.
+//
+//*****************************************************************************
+static uint64_t
+IQSqrt64(uint64_t ullValue)
+{
+    uint64_t ullRoot;
+    uint32_t ulTop;
+    int iShift;
+
+    if(!ullValue)
+    {
+        return(0);
+    }
+
+    //
+    // Normalize the value by an even number of bits, so that the top word is
+    // at least 2^30, and estimate the root from the top word.
+    //
+    if(ullValue >> 32)
+    {
+        iShift = IQ_CLZ((uint32_t)(ullValue >> 32));
+    }
+    else
+    {
+        iShift = 32 + IQ_CLZ((uint32_t)ullValue);
+    }
+    iShift &= ~1;
+    ulTop = (uint32_t)((ullValue << iShift) >> 32);
+    ullRoot = ((uint64_t)ulTop * IQRsqrt(ulTop)) >> 30;
+    ullRoot >>= iShift / 2;
+
+    //
+    // Correct the estimate to the integer root, then round it.
+    //
+    while((ullRoot * ullRoot) > ullValue)
+    {
+        ullRoot--;
+    }
+    while(((ullRoot + 1) * (ullRoot + 1)) <= ullValue)
+    {
+        ullRoot++;
+    }
+    if((ullValue - (ullRoot * ullRoot)) > ullRoot)
+    {
+        ullRoot++;
+    }
+
+    return(ullRoot);
+}
+
+//*****************************************************************************
+//
+// Divides two IQ numbers in the given format, truncating toward zero.  A
+// quotient that does not fit, including division by zero, is saturated.
+//
+//*****************************************************************************
+static int32_t
+IQDiv(int32_t lNum, int32_t lDen, int iQ)
+{
+    uint64_t ullNum, ullProd;
+    uint32_t ulNum, ulDen, ulQuot;
+    int iShift;
+
+    ulNum = (lNum < 0) ? (0 - (uint32_t)lNum) : (uint32_t)lNum;
+    ulDen = (lDen < 0) ? (0 - (uint32_t)lDen) : (uint32_t)lDen;
+    ullNum = (uint64_t)ulNum << iQ;
+    if(!ulDen || ((ullNum >> 31) >= ulDen))
+    {
+        return(((lNum ^ lDen) < 0) ? IQ_MIN : IQ_MAX);
+    }
+
+    //
+    // Normalize the divisor, multiply by its reciprocal, and correct the
+    // estimate to the exact quotient.
+    //
+    iShift = IQ_CLZ(ulDen);
+    ulDen <<= iShift;
+    ullNum <<= iShift;
+    ulQuot = IQRecip(ulDen);
+    ulQuot = (uint32_t)((((ullNum >> 32) * ulQuot) +
+                         (((ullNum & 0xffffffff) * ulQuot) >> 32)) >> 30);
+    ullProd = (uint64_t)ulQuot * ulDen;
+    while(ullProd > ullNum)
+    {
+        ulQuot--;
+        ullProd -= ulDen;
+    }
+    while((ullNum - ullProd) >= ulDen)
+    {
+        ulQuot++;
+        ullProd += ulDen;
+    }
+
+    return(((lNum ^ lDen) < 0) ? -(int32_t)ulQuot : (int32_t)ulQuot);
+}
+
+//*****************************************************************************
+//
+// Returns the sine of a phase in the given format.  The nearest entry of the
+// table is moved to the exact angle with sin(a + d) = sin(a)cos(d) +
+// cos(a)sin(d), where d is at most 1/512 of a turn so that short series for
+// sin(d) and cos(d) are exact to Q30.
+//
+//*****************************************************************************
+static int32_t
+IQSinPhase(uint32_t ulPhase, int iQ)
+{
+    int32_t lSin, lCos, lDelta, lDelta2, lSinD, lOneMinusCosD, lResult;
+    uint32_t ulIdx;
+
+    ulIdx = (ulPhase + 0x00800000) >> 24;
+    lDelta = (int32_t)(ulPhase - (ulIdx << 24));
+    lSin = g_plIQSinTable[ulIdx & 255];
+    lCos = g_plIQSinTable[(ulIdx + 64) & 255];
+
+    //
+    // Find d in radians, in Q31, and the series for sin(d) and 1 - cos(d).
+    //
+    lDelta = (int32_t)(((int64_t)lDelta * IQ_PI_Q30) >> 30);
+    lDelta2 = (int32_t)(((int64_t)lDelta * lDelta) >> 31);
+    lSinD = lDelta - ((int32_t)(((int64_t)lDelta2 * lDelta) >> 31) / 6);
+    lOneMinusCosD = ((lDelta2 / 2) -
+                     ((int32_t)(((int64_t)lDelta2 * lDelta2) >> 31) / 24));
+
+    lResult = (lSin - (int32_t)(((int64_t)lSin * lOneMinusCosD) >> 31) +
+               (int32_t)(((int64_t)lCos * lSinD) >> 31));
+
+    if(iQ < 30)
+    {
+        lResult = (lResult + (1 << (29 - iQ))) >> (30 - iQ);
+    }
+
+    return(lResult);
+}
+
+//*****************************************************************************
+//
+// Converts an angle in radians, in the given format, to a phase.
+//
+//*****************************************************************************
+static uint32_t
+IQRadiansToPhase(int32_t lAngle, int iQ)
+{
+    return((uint32_t)(((int64_t)lAngle * IQ_TURNS_PER_RADIAN_Q34 +
+                       ((int64_t)1 << (iQ + 1))) >> (iQ + 2)));
+}
+
+//*****************************************************************************
+//
+// Returns the angle of the point (lX, lY) as a phase.  The point is folded
+// into the first octant so that the ratio t of the shorter side to the longer
+// is at most one.  The nearest entry of the table, for i/64, is moved to the
+// exact angle with atan(t) = atan(i/64) + atan(u), where u is (64y - ix) /
+// (64x + iy) and is small enough for a short series.
+//
+//*****************************************************************************
+static uint32_t
+IQAtan2Phase(int32_t lY, int32_t lX)
+{
+    uint32_t ulY, ulX, ulTemp, ulRecip, ulIdx, ulPhase;
+    int32_t lU, lU2, lU3, lAtan;
+    uint64_t ullDen;
+    int64_t llNum;
+    int iShift, bSwap;
+
+    ulY = (lY < 0) ? (0 - (uint32_t)lY) : (uint32_t)lY;
+    ulX = (lX < 0) ? (0 - (uint32_t)lX) : (uint32_t)lX;
+    if(!ulX && !ulY)
+    {
+        return(0);
+    }
+
+    //
+    // Fold into the first octant, and normalize.
+    //
+    bSwap = ulY > ulX;
+    if(bSwap)
+    {
+        ulTemp = ulX;
+        ulX = ulY;
+        ulY = ulTemp;
+    }
+    iShift = IQ_CLZ(ulX);
+    ulX <<= iShift;
+    ulY <<= iShift;
+
+    //
+    // Find the nearest entry of the table from an estimate of t in Q31.
+    //
+    ulRecip = IQRecip(ulX);
+    ulIdx = (uint32_t)(((((uint64_t)ulY * ulRecip) >> 31) + 0x01000000) >> 25);
+
+    //
+    // Find u in Q31, normalizing the denominator to use IQRecip().
+    //
+    llNum = ((int64_t)ulY << 6) - ((int64_t)ulIdx * ulX);
+    ullDen = ((uint64_t)ulX << 6) + ((uint64_t)ulIdx * ulY);
+    iShift = 32 - IQ_CLZ((uint32_t)(ullDen >> 32));
+    ulRecip = IQRecip((uint32_t)(ullDen >> iShift));
+    lU = (int32_t)(((llNum >> (iShift - 3)) * ulRecip) >> 34);
+
+    //
+    // Add atan(u) = u - u^3/3 + u^5/5, converted to a phase.
+    //
+    lU2 = (int32_t)(((int64_t)lU * lU) >> 31);
+    lU3 = (int32_t)(((int64_t)lU2 * lU) >> 31);
+    lAtan = lU - (lU3 / 3) + ((int32_t)(((int64_t)lU3 * lU2) >> 31) / 5);
+    ulPhase = (g_pulIQAtanTable[ulIdx] +
+               (int32_t)(((int64_t)lAtan * IQ_TURNS_PER_RADIAN_Q32) >> 31));
+    if((int32_t)ulPhase < 0)
+    {
+        ulPhase = 0;
+    }
+
+    //
+    // Unfold to the octant of the point.
+    //
+    if(bSwap)
+    {
+        ulPhase = 0x40000000 - ulPhase;
+    }
+    if(lX < 0)
+    {
+        ulPhase = 0x80000000 - ulPhase;
+    }
+    if(lY < 0)
+    {
+        ulPhase = 0 - ulPhase;
+    }
+
+    return(ulPhase);
+}
+
+//*****************************************************************************
+//
+// Returns the angle of the point (lX, lY) in radians, from -pi to pi, in the
+// given format.
+//
+//*****************************************************************************
+static int32_t
+IQAtan2(int32_t lY, int32_t lX, int iQ)
+{
+    int64_t llPhase;
+
+    //
+    // The phase is from 0 to 1/2 of a turn for a point on or above the x
+    // axis, and from 1/2 to 1 below it.
+    //
+    llPhase = IQAtan2Phase(lY, lX);
+    if((lY < 0) && llPhase)
+    {
+        llPhase -= (int64_t)1 << 32;
+    }
+
+    return((int32_t)((llPhase * IQ_TWO_PI_Q29 +
+                      ((int64_t)1 << (60 - iQ))) >> (61 - iQ)));
+}
+
+//*****************************************************************************
+//
+// Returns the angle of the point (lX, lY) as a fraction of a turn, from 0 to
+// 1, in the given format.
+//
+//*****************************************************************************
+static int32_t
+IQAtan2PU(int32_t lY, int32_t lX, int iQ)
+{
+    return((int32_t)(((uint64_t)IQAtan2Phase(lY, lX) +
+                      ((uint64_t)1 << (31 - iQ))) >> (32 - iQ)));
+}
+
+//*****************************************************************************
+//
+// Returns the arcsine in radians, in the given format, as the angle of the
+// point (sqrt(1 - x^2), x).  Values outside -1 to 1 are limited to it.
+//
+//*****************************************************************************
+static int32_t
+IQAsin(int32_t lValue, int iQ)
+{
+    uint32_t ulCos;
+
+    if(lValue > (1 << iQ))
+    {
+        lValue = 1 << iQ;
+    }
+    if(lValue < -(1 << iQ))
+    {
+        lValue = -(1 << iQ);
+    }
+    lValue *= 1 << (30 - iQ);
+    ulCos = (uint32_t)IQSqrt64(((uint64_t)1 << 60) -
+                               (uint64_t)((int64_t)lValue * lValue));
+
+    return(IQAtan2(lValue, (int32_t)ulCos, iQ));
+}
+
+//*****************************************************************************
+//
+// Returns 1/sqrt(x) in the given format.  Zero gives the largest value and
+// negative values give zero.
+//
+//*****************************************************************************
+static int32_t
+IQIsqrt(int32_t lValue, int iQ)
+{
+    uint64_t ullResult;
+    uint32_t ulRoot;
+    int iShift, iExp;
+
+    if(lValue <= 0)
+    {
+        return(lValue ? 0 : IQ_MAX);
+    }
+
+    //
+    // Normalize by an even number of bits.  The result is the estimate from
+    // IQRsqrt() scaled by 2^(iExp/2).
+    //
+    iShift = IQ_CLZ((uint32_t)lValue) & ~1;
+    ulRoot = IQRsqrt((uint32_t)lValue << iShift);
+    iExp = iShift + (3 * iQ) - 92;
+    if(iExp & 1)
+    {
+        ulRoot = (uint32_t)(((uint64_t)ulRoot * IQ_SQRT2_Q30) >> 30);
+        iExp--;
+    }
+    iExp /= 2;
+
+    if(iExp >= 0)
+    {
+        ullResult = (uint64_t)ulRoot << iExp;
+        return((ullResult > IQ_MAX) ? IQ_MAX : (int32_t)ullResult);
+    }
+    if(iExp < -32)
+    {
+        return(0);
+    }
+
+    return((int32_t)(((uint64_t)ulRoot + ((uint64_t)1 << (-iExp - 1))) >>
+                     -iExp));
+}
+
+//*****************************************************************************
+//
+// Returns 2^x in the given format, where x has iFrac fractional bits.  The
+// fraction selects an entry of the table for 2^(i/64), which is moved to the
+// exact value with the series for e^w, where w is the rest of the fraction
+// times ln(2) and is below 1/90.  Results that are too large are saturated.
+//
+//*****************************************************************************
+static int32_t
+IQExp2(int64_t llX, int iFrac, int iQ)
+{
+    uint32_t ulFrac, ulMant, ulW, ulW2, ulW3, ulSeries;
+    uint64_t ullMant;
+    int64_t llShift;
+
+    //
+    // The mantissa found below is from 1 to 2 in Q31, so the result is the
+    // mantissa shifted right by this many bits, and does not fit unless the
+    // shift is to the right.  A shift of 32 leaves a value from 1/2 to 1,
+    // which rounds to 1.
+    //
+    llShift = 31 - iQ - (llX >> iFrac);
+    if(llShift <= 0)
+    {
+        return(IQ_MAX);
+    }
+    if(llShift >= 32)
+    {
+        return((llShift == 32) ? 1 : 0);
+    }
+
+    //
+    // Find the fraction in Q32.
+    //
+    if(iFrac >= 32)
+    {
+        ulFrac = (uint32_t)(llX >> (iFrac - 32));
+    }
+    else
+    {
+        ulFrac = (uint32_t)llX << (32 - iFrac);
+    }
+
+    //
+    // Find 2^fraction in Q31.
+    //
+    ulMant = g_pulIQExp2Table[ulFrac >> 26];
+    ulW = (uint32_t)((((uint64_t)(ulFrac & 0x03ffffff) * IQ_LN2_Q32) +
+                      0x80000000) >> 32);
+    ulW2 = (uint32_t)(((uint64_t)ulW * ulW) >> 32);
+    ulW3 = (uint32_t)(((uint64_t)ulW2 * ulW) >> 32);
+    ulSeries = (ulW + (ulW2 / 2) + (ulW3 / 6) +
+                ((uint32_t)(((uint64_t)ulW2 * ulW2) >> 32) / 24));
+    ullMant = ((uint64_t)ulMant << 32) + ((uint64_t)ulMant * ulSeries);
+
+    return((int32_t)(((ullMant >> (llShift + 31)) + 1) >> 1));
+}
+
+//*****************************************************************************
+//
+// Multiplies an IQ number by an integer, and splits the product into its
+// integer and fractional parts, both truncated toward zero so that they keep
+// the sign of the product.  The integer part is saturated.
+//
+//*****************************************************************************
+static int32_t
+IQMpyI32Int(int32_t lA, int32_t lB, int iQ)
+{
+    int64_t llProd;
+
+    llProd = (int64_t)lA * lB;
+    llProd = (llProd < 0) ? -(-llProd >> iQ) : (llProd >> iQ);
+    if(llProd > IQ_MAX)
+    {
+        return(IQ_MAX);
+    }
+    if(llProd < IQ_MIN)
+    {
+        return(IQ_MIN);
+    }
+
+    return((int32_t)llProd);
+}
+
+static int32_t
+IQMpyI32Frac(int32_t lA, int32_t lB, int iQ)
+{
+    int64_t llProd, llMask;
+
+    llProd = (int64_t)lA * lB;
+    llMask = ((int64_t)1 << iQ) - 1;
+
+    return((int32_t)((llProd < 0) ? -(-llProd & llMask) : (llProd & llMask)));
+}
+
+//*****************************************************************************
+//
+// Returns the fractional part of an IQ number, keeping its sign.
+//
+//*****************************************************************************
+static int32_t
+IQFrac(int32_t lValue, int iQ)
+{
+    uint32_t ulMag;
+
+    ulMag = (lValue < 0) ? (0 - (uint32_t)lValue) : (uint32_t)lValue;
+    ulMag &= ((uint32_t)1 << iQ) - 1;
+
+    return((lValue < 0) ? -(int32_t)ulMag : (int32_t)ulMag);
+}
+
+//*****************************************************************************
+//
+// Multiplies two IQ numbers with rounding and saturation.
+//
+//*****************************************************************************
+static int32_t
+IQRsmpy(int32_t lA, int32_t lB, int iQ)
+{
+    int64_t llProd;
+
+    llProd = ((int64_t)lA * lB + ((int64_t)1 << (iQ - 1))) >> iQ;
+    if(llProd > IQ_MAX)
+    {
+        return(IQ_MAX);
+    }
+    if(llProd < IQ_MIN)
+    {
+        return(IQ_MIN);
+    }
+
+    return((int32_t)llProd);
+}
+
+//*****************************************************************************
+//
+// Returns the magnitude of the vector (lA, lB), saturated.
+//
+//*****************************************************************************
+static int32_t
+IQMag(int32_t lA, int32_t lB)
+{
+    uint64_t ullRoot;
+
+    ullRoot = IQSqrt64((uint64_t)((int64_t)lA * lA) +
+                       (uint64_t)((int64_t)lB * lB));
+
+    return((ullRoot > IQ_MAX) ? IQ_MAX : (int32_t)ullRoot);
+}
+
+//*****************************************************************************
+//
+// Defines the functions for the given format.  Each is a call to the kernel
+// above with the format as an argument, so that the compiler can fold the
+// shifts into constants.  The arguments are taken as 32-bit values so that
+// the results are the same where a long is 64 bits wide.
+//
+//*****************************************************************************
+#define IQ_FUNCTIONS(N)                                                       \
+    float                                                                     \
+    _IQ##N##toF(_iq##N A)                                                     \
+    {                                                                         \
+        return((float)(int32_t)A * (1.0f / (float)(1L << N)));                \
+    }                                                                         \
+    double                                                                    \
+    _IQ##N##toD(_iq##N A)                                                     \
+    {                                                                         \
+        return((double)(int32_t)A * (1.0 / (double)(1L << N)));               \
+    }                                                                         \
+    _iq##N                                                                    \
+    _IQ##N##mpy(_iq##N A, _iq##N B)                                           \
+    {                                                                         \
+        return((int32_t)(((int64_t)(int32_t)A * (int32_t)B) >> N));           \
+    }                                                                         \
+    _iq##N                                                                    \
+    _IQ##N##rmpy(_iq##N A, _iq##N B)                                          \
+    {                                                                         \
+        return((int32_t)(((int64_t)(int32_t)A * (int32_t)B +                  \
+                          ((int64_t)1 << (N - 1))) >> N));                    \
+    }                                                                         \
+    _iq##N                                                                    \
+    _IQ##N##rsmpy(_iq##N A, _iq##N B)                                         \
+    {                                                                         \
+        return(IQRsmpy((int32_t)A, (int32_t)B, N));                           \
+    }                                                                         \
+    _iq##N                                                                    \
+    _IQ##N##div(_iq##N A, _iq##N B)                                           \
+    {                                                                         \
+        return(IQDiv((int32_t)A, (int32_t)B, N));                             \
+    }                                                                         \
+    _iq##N                                                                    \
+    _IQ##N##sinPU(_iq##N A)                                                   \
+    {                                                                         \
+        return(IQSinPhase((uint32_t)A << (32 - N), N));                       \
+    }                                                                         \
+    _iq##N                                                                    \
+    _IQ##N##cosPU(_iq##N A)                                                   \
+    {                                                                         \
+        return(IQSinPhase(((uint32_t)A << (32 - N)) + 0x40000000, N));        \
+    }                                                                         \
+    _iq##N                                                                    \
+    _IQ##N##atan2PU(_iq##N A, _iq##N B)                                       \
+    {                                                                         \
+        return(IQAtan2PU((int32_t)A, (int32_t)B, N));                         \
+    }                                                                         \
+    _iq##N                                                                    \
+    _IQ##N##sqrt(_iq##N A)                                                    \
+    {                                                                         \
+        return(((int32_t)A <= 0) ? 0 :                                        \
+               (int32_t)IQSqrt64((uint64_t)(int32_t)A << N));                 \
+    }                                                                         \
+    _iq##N                                                                    \
+    _IQ##N##isqrt(_iq##N A)                                                   \
+    {                                                                         \
+        return(IQIsqrt((int32_t)A, N));                                       \
+    }                                                                         \
+    _iq##N                                                                    \
+    _IQ##N##exp(_iq##N A)                                                     \
+    {                                                                         \
+        return(IQExp2(((int64_t)(int32_t)A * IQ_LOG2E_Q30) +               \
+                      (((int64_t)(int32_t)A * IQ_LOG2E_LOW_Q62) >> 32),       \
+                      N + 30, N));                                            \
+    }                                                                         \
+    _iq##N                                                                    \
+    _IQ##N##exp2(_iq##N A)                                                    \
+    {                                                                         \
+        return(IQExp2((int32_t)A, N, N));                                     \
+    }                                                                         \
+    _iq##N                                                                    \
+    _IQ##N##frac(_iq##N A)                                                    \
+    {                                                                         \
+        return(IQFrac((int32_t)A, N));                                        \
+    }                                                                         \
+    _iq##N                                                                    \
+    _IQ##N##mpyI32int(_iq##N A, long B)                                       \
+    {                                                                         \
+        return(IQMpyI32Int((int32_t)A, (int32_t)B, N));                       \
+    }                                                                         \
+    _iq##N                                                                    \
+    _IQ##N##mpyI32frac(_iq##N A, long B)                                      \
+    {                                                                         \
+        return(IQMpyI32Frac((int32_t)A, (int32_t)B, N));                      \
+    }                                                                         \
+    _iq##N                                                                    \
+    _IQ##N##mag(_iq##N A, _iq##N B)                                           \
+    {                                                                         \
+        return(IQMag((int32_t)A, (int32_t)B));                                \
+    }
+
+//*****************************************************************************
+//
+// Defines the functions that take or return radians, which are only provided
+// for formats that can hold pi.
+//
+//*****************************************************************************
+#define IQ_RADIAN_FUNCTIONS(N)                                                \
+    _iq##N                                                                    \
+    _IQ##N##sin(_iq##N A)                                                     \
+    {                                                                         \
+        return(IQSinPhase(IQRadiansToPhase((int32_t)A, N), N));               \
+    }                                                                         \
+    _iq##N                                                                    \
+    _IQ##N##cos(_iq##N A)                                                     \
+    {                                                                         \
+        return(IQSinPhase(IQRadiansToPhase((int32_t)A, N) + 0x40000000, N));  \
+    }                                                                         \
+    _iq##N                                                                    \
+    _IQ##N##asin(_iq##N A)                                                    \
+    {                                                                         \
+        return(IQAsin((int32_t)A, N));                                        \
+    }                                                                         \
+    _iq##N                                                                    \
+    _IQ##N##atan2(_iq##N A, _iq##N B)                                         \
+    {                                                                         \
+        return(IQAtan2((int32_t)A, (int32_t)B, N));                           \
+    }
+
+//*****************************************************************************
+//
+// The functions for each format.
+//
+//*****************************************************************************
+IQ_FUNCTIONS(30)
+IQ_FUNCTIONS(29)
+IQ_FUNCTIONS(28)
+IQ_FUNCTIONS(27)
+IQ_FUNCTIONS(26)
+IQ_FUNCTIONS(25)
+IQ_FUNCTIONS(24)
+IQ_FUNCTIONS(23)
+IQ_FUNCTIONS(22)
+IQ_FUNCTIONS(21)
+IQ_FUNCTIONS(20)
+IQ_FUNCTIONS(19)
+IQ_FUNCTIONS(18)
+IQ_FUNCTIONS(17)
+IQ_FUNCTIONS(16)
+IQ_FUNCTIONS(15)
+IQ_FUNCTIONS(14)
+IQ_FUNCTIONS(13)
+IQ_FUNCTIONS(12)
+IQ_FUNCTIONS(11)
+IQ_FUNCTIONS(10)
+IQ_FUNCTIONS(9)
+IQ_FUNCTIONS(8)
+IQ_FUNCTIONS(7)
+IQ_FUNCTIONS(6)
+IQ_FUNCTIONS(5)
+IQ_FUNCTIONS(4)
+IQ_FUNCTIONS(3)
+IQ_FUNCTIONS(2)
+IQ_FUNCTIONS(1)
+IQ_RADIAN_FUNCTIONS(29)
+IQ_RADIAN_FUNCTIONS(28)
+IQ_RADIAN_FUNCTIONS(27)
+IQ_RADIAN_FUNCTIONS(26)
+IQ_RADIAN_FUNCTIONS(25)
+IQ_RADIAN_FUNCTIONS(24)
+IQ_RADIAN_FUNCTIONS(23)
+IQ_RADIAN_FUNCTIONS(22)
+IQ_RADIAN_FUNCTIONS(21)
+IQ_RADIAN_FUNCTIONS(20)
+IQ_RADIAN_FUNCTIONS(19)
+IQ_RADIAN_FUNCTIONS(18)
+IQ_RADIAN_FUNCTIONS(17)
+IQ_RADIAN_FUNCTIONS(16)
+IQ_RADIAN_FUNCTIONS(15)
+IQ_RADIAN_FUNCTIONS(14)
+IQ_RADIAN_FUNCTIONS(13)
+IQ_RADIAN_FUNCTIONS(12)
+IQ_RADIAN_FUNCTIONS(11)
+IQ_RADIAN_FUNCTIONS(10)
+IQ_RADIAN_FUNCTIONS(9)
+IQ_RADIAN_FUNCTIONS(8)
+IQ_RADIAN_FUNCTIONS(7)
+IQ_RADIAN_FUNCTIONS(6)
+IQ_RADIAN_FUNCTIONS(5)
+IQ_RADIAN_FUNCTIONS(4)
+IQ_RADIAN_FUNCTIONS(3)
+IQ_RADIAN_FUNCTIONS(2)
+IQ_RADIAN_FUNCTIONS(1)
+
+//*****************************************************************************
+//
+// Multiplies two IQ numbers in different formats, where S is the format of
+// the result plus 32 minus the formats of the operands.
+//
+//*****************************************************************************
+long
+__IQxmpy(long A, long B, long S)
+{
+    int64_t llProd;
+
+    llProd = (int64_t)(int32_t)A * (int32_t)B;
+    if(S >= 32)
+    {
+        return((int32_t)((uint64_t)llProd << (S - 32)));
+    }
+
+    return((int32_t)(llProd >> (32 - S)));
+}
+
+//*****************************************************************************
+//
+// Converts a string, with an optional sign and fraction, to an IQ number in
+// the format given by B.  The value is rounded and saturated.
+//
+//*****************************************************************************
+_iq
+_atoIQN(const char *A, long B)
+{
+    uint64_t ullInt, ullFrac, ullScale;
+    int bNeg;
+
+    //
+    // Skip leading spaces and read the sign.
+    //
+    while(*A == ' ')
+    {
+        A++;
+    }
+    bNeg = (*A == '-');
+    if((*A == '-') || (*A == '+'))
+    {
+        A++;
+    }
+
+    //
+    // Read the integer part, stopping once it is out of range.
+    //
+    ullInt = 0;
+    while((*A >= '0') && (*A <= '9'))
+    {
+        if(ullInt < ((uint64_t)1 << 32))
+        {
+            ullInt = (ullInt * 10) + (*A - '0');
+        }
+        A++;
+    }
+
+    //
+    // Read up to nine digits of the fraction.
+    //
+    ullFrac = 0;
+    ullScale = 1;
+    if(*A == '.')
+    {
+        A++;
+        while((*A >= '0') && (*A <= '9') && (ullScale < 1000000000))
+        {
+            ullFrac = (ullFrac * 10) + (*A - '0');
+            ullScale *= 10;
+            A++;
+        }
+    }
+
+    //
+    // Combine the parts, rounding the fraction.
+    //
+    ullInt = ((ullInt << B) +
+              (((ullFrac << B) + (ullScale / 2)) / ullScale));
+    if(bNeg)
+    {
+        return((ullInt > ((uint64_t)1 << 31)) ? IQ_MIN :
+               (int32_t)(0 - ullInt));
+    }
+
+    return((ullInt > IQ_MAX) ? IQ_MAX : (int32_t)ullInt);
+}
+
+//*****************************************************************************
+//
+// Converts an IQ number in the format given by D to a string, as described
+// by the format B, which is "%I.Ff" with at most two digits for I and F.
+// The fraction is truncated to F digits.  Returns 0 on success, 1 if the
+// integer part needs more than I digits, or 2 if the format is bad.
+//
+//*****************************************************************************
+int
+__IQNtoa(char *A, const char *B, _iq C, int D)
+{
+    unsigned long ulInt, ulDigits, ulMax;
+    uint64_t ullFrac;
+    uint32_t ulMag;
+    int iInt, iFrac, iIdx;
+
+    //
+    // Parse the format.
+    //
+    if(*B++ != '%')
+    {
+        return(2);
+    }
+    for(iInt = 0; (*B >= '0') && (*B <= '9'); B++)
+    {
+        iInt = (iInt * 10) + (*B - '0');
+    }
+    if((*B++ != '.') || (iInt < 1) || (iInt > 10))
+    {
+        return(2);
+    }
+    for(iFrac = 0; (*B >= '0') && (*B <= '9'); B++)
+    {
+        iFrac = (iFrac * 10) + (*B - '0');
+    }
+    if((*B != 'f') || (iFrac > 9))
+    {
+        return(2);
+    }
+
+    //
+    // Split the magnitude into its parts, and check that the integer part
+    // fits.
+    //
+    ulMag = ((int32_t)C < 0) ? (0 - (uint32_t)C) : (uint32_t)C;
+    ulInt = ulMag >> D;
+    ullFrac = ulMag & (((uint32_t)1 << D) - 1);
+    for(ulDigits = 1, ulMax = 10; (ulInt >= ulMax) && (ulDigits < 10);
+        ulDigits++)
+    {
+        ulMax *= 10;
+    }
+    if((int)ulDigits > iInt)
+    {
+        return(1);
+    }
+
+    //
+    // Write the sign and the integer part.
+    //
+    if((int32_t)C < 0)
+    {
+        *A++ = '-';
+    }
+    for(iIdx = ulDigits - 1; iIdx >= 0; iIdx--)
+    {
+        A[iIdx] = '0' + (ulInt % 10);
+        ulInt /= 10;
+    }
+    A += ulDigits;
+
+    //
+    // Write the fraction.
+    //
+    *A++ = '.';
+    for(iIdx = 0; iIdx < iFrac; iIdx++)
+    {
+        ullFrac *= 10;
+        *A++ = '0' + (char)(ullFrac >> D);
+        ullFrac &= ((uint64_t)1 << D) - 1;
+    }
+    *A = '\0';
+
+    return(0);
+}
@@ -32,6 +32,7 @@
 #include "driverlib/rom.h"
 #include "driverlib/sysctl.h"
 #include "driverlib/systick.h"
+#include "utils/bitplane.h"
 #include "utils/softssi.h"
 #include "utils/uartstdio.h"
 
@@ -123,24 +124,6 @@ const unsigned char g_ucFaces[NUM_FACES][8] =
                     {0x86, 0x46, 0x40, 0x5C, 0x5C, 0x40, 0x46, 0x86}
                     };  
 
-//*****************************************************************************
-//
-// Bit-wise reverses a number.
-//
-//*****************************************************************************
-unsigned char
-Reverse(unsigned char ucNumber)
-{
-    unsigned short ucIndex;
-    unsigned short ucReversedNumber = 0;
-    for(ucIndex=0; ucIndex<8; ucIndex++)
-    {
-        ucReversedNumber = ucReversedNumber << 1;
-        ucReversedNumber |= ((1 << ucIndex) & ucNumber) >> ucIndex;
-    }
-    return ucReversedNumber;
-}
-
 //*****************************************************************************
 //
 // The interrupt handler for the SysTick interrupt.
@@ -180,7 +163,15 @@ PrintByteArray(const unsigned char * pucBytes)
 {
     unsigned long ulIndex; 
     unsigned long ulData;
+    unsigned short pusWords[NUM_SSI_DATA];
     
+    //
+    // Build the word for each row, with the columns reversed to match the
+    // wiring of the matrix in the upper byte and the row select in the lower
+    // byte.
+    //
+    BitPlaneMatrix(pusWords, pucBytes, NUM_SSI_DATA, BITPLANE_REVERSE_BITS);
+
     //
     // Display indication that the SoftSSI is transmitting data.
     //
@@ -191,7 +182,7 @@ PrintByteArray(const unsigned char * pucBytes)
     //
     for(ulIndex = 0; ulIndex < NUM_SSI_DATA; ulIndex++)
     {
-        ulData = (Reverse(pucBytes[ulIndex]) << 8) + (1 << ulIndex);
+        ulData = pusWords[ulIndex];
         
         //
         // Display the data that SSI is transferring.
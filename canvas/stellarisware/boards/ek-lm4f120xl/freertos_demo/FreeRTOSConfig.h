@@ -104,4 +104,11 @@ to exclude the API function. */
 #define configKERNEL_INTERRUPT_PRIORITY         ( 7 << 5 )    /* Priority 7, or 0xE0 as only the top three bits are implemented.  This is the lowest priority. */
 #define configMAX_SYSCALL_INTERRUPT_PRIORITY     ( 5 << 5 )  /* Priority 5, or 0xA0 as only the top three bits are implemented. */
 
+/* Define RTOS_TRACE to record kernel events with utils/rtostrace.c.  The
+trace hooks must be defined here, before FreeRTOS.h supplies its defaults, and
+are not wanted when this file is included by assembler source. */
+#if defined( RTOS_TRACE ) && !defined( __IAR_SYSTEMS_ASM__ )
+    #include "utils/rtostrace.h"
+#endif
+
 #endif /* FREERTOS_CONFIG_H */
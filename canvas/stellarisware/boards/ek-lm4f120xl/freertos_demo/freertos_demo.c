@@ -29,6 +29,7 @@
 #include "driverlib/rom.h"
 #include "driverlib/sysctl.h"
 #include "driverlib/uart.h"
+#include "utils/rtostrace.h"
 #include "utils/uartstdio.h"
 #include "led_task.h"
 #include "switch_task.h"
@@ -69,12 +70,33 @@
 //! - A non-blocking FreeRTOS Delay to put the tasks in blocked state when they
 //!   have nothing to do.
 //!
+//! When built with RTOS_TRACE defined, kernel events are recorded by the trace
+//! recorder in utils/rtostrace.c.  Pressing both buttons together writes the
+//! trace to the UART, for decoding on the host with tools/tracedecode.
+//!
 //! For additional details on FreeRTOS, refer to the FreeRTOS web page at:
 //! http://www.freertos.org/
 //
 //*****************************************************************************
 
 
+//*****************************************************************************
+//
+// The size of the buffer, taken from the FreeRTOS heap, that holds the kernel
+// event trace when built with RTOS_TRACE defined.  Each event uses 8 bytes.
+//
+//*****************************************************************************
+#ifndef RTOS_TRACE_SIZE
+#define RTOS_TRACE_SIZE         4096
+#endif
+
+//*****************************************************************************
+//
+// The queue that passes button presses to the LED task.
+//
+//*****************************************************************************
+extern xQueueHandle g_pLEDQueue;
+
 //*****************************************************************************
 //
 // The mutex that protects concurrent access of UART from multiple tasks.
@@ -142,6 +164,15 @@ main(void)
     //
     UARTprintf("\n\nWelcome to the Stellaris EK-LM4F120 FreeRTOS Demo!\n");
 
+#ifdef RTOS_TRACE
+    //
+    // Start recording kernel events before any tasks or queues are created,
+    // so that all of them are named in the trace.
+    //
+    RTOSTraceInit(pvPortMalloc(RTOS_TRACE_SIZE), RTOS_TRACE_SIZE,
+                  ROM_SysCtlClockGet(), RTOSTRACE_FLAG_START);
+#endif
+
     //
     // Create a mutex to guard the UART.
     //
@@ -169,6 +200,14 @@ main(void)
         }
     }
 
+#ifdef RTOS_TRACE
+    //
+    // Name the queues in the trace.
+    //
+    RTOSTraceQueueName(g_pUARTSemaphore, "UART");
+    RTOSTraceQueueName(g_pLEDQueue, "LED");
+#endif
+
     //
     // Start the scheduler.  This should not return.
     //
@@ -28,7 +28,9 @@
 #include "driverlib/sysctl.h"
 #include "driverlib/gpio.h"
 #include "driverlib/rom.h"
+#include "driverlib/uart.h"
 #include "drivers/buttons.h"
+#include "utils/rtostrace.h"
 #include "utils/uartstdio.h"
 #include "switch_task.h"
 #include "led_task.h"
@@ -48,6 +50,30 @@
 extern xQueueHandle g_pLEDQueue;
 extern xSemaphoreHandle g_pUARTSemaphore;
 
+#ifdef RTOS_TRACE
+//*****************************************************************************
+//
+// Writes the kernel event trace recorded so far to the UART and starts a new
+// trace.
+//
+//*****************************************************************************
+static void
+DumpTrace(void)
+{
+    //
+    // Guard UART from concurrent access.
+    //
+    xSemaphoreTake(g_pUARTSemaphore, portMAX_DELAY);
+    UARTprintf("Writing %d trace events.\n", RTOSTraceCount());
+    RTOSTraceDumpUART(UART0_BASE);
+    UARTprintf("\n");
+    xSemaphoreGive(g_pUARTSemaphore);
+
+    RTOSTraceClear();
+    RTOSTraceStart();
+}
+#endif
+
 //*****************************************************************************
 //
 // This task reads the buttons' state and passes this information to LEDTask.
@@ -87,8 +113,16 @@ SwitchTask(void *pvParameters)
 
             //
             // Check to make sure the change in state is due to button press
-            // and not due to button release.
+            // and not due to button release.  When tracing, pressing both
+            // buttons writes out the trace.
             //
+#ifdef RTOS_TRACE
+            if((ucCurButtonState & ALL_BUTTONS) == ALL_BUTTONS)
+            {
+                DumpTrace();
+            }
+            else
+#endif
             if((ucCurButtonState & ALL_BUTTONS) != 0)
             {
                 if((ucCurButtonState & ALL_BUTTONS) == LEFT_BUTTON)
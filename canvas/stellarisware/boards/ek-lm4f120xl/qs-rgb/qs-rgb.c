@@ -36,6 +36,7 @@
 #include "driverlib/hibernate.h"
 #include "utils/uartstdio.h"
 #include "utils/cmdline.h"
+#include "utils/rpc.h"
 #include "drivers/rgb.h"
 #include "drivers/buttons.h"
 #include "rgb_commands.h"
@@ -67,6 +68,14 @@
 //! the brightness of the LED by that factor.
 //! Command 'rgb' followed by a six character hex value will set the color. For
 //! example 'rgb FF0000' will produce a red color.
+//!
+//! Command 'rpc' switches the UART to the binary command channel of
+//! utils/rpc.c, for control by a program rather than a person.  Command 0
+//! echoes its payload, command 1 sets the color from three 16 bit values,
+//! command 2 sets the intensity in hundredths of a percent, command 3 returns
+//! the color, intensity and mode, and command 4 returns to the text console.
+//! tools/rpcbench measures the channel, for example with
+//! 'rpcbench -d /dev/ttyACM0 -m rpc -x 4'.
 //
 //*****************************************************************************
 
@@ -94,6 +103,14 @@ static float fManualColors[7] = {0.0f, .214f, .428f, .642f, .856f, 1.07f,
 //*****************************************************************************
 static char g_cInput[APP_INPUT_BUF_SIZE];
 
+//*****************************************************************************
+//
+// The binary command channel, which takes the place of the command line
+// interpreter after the rpc command.
+//
+//*****************************************************************************
+static tRPCInstance g_sRPC;
+
 //*****************************************************************************
 //
 // Application state structure.  Gets stored to hibernate memory for 
@@ -455,6 +472,70 @@ AppHibernateEnter(void)
 
 }
 
+//*****************************************************************************
+//
+// Sends the frames of the binary command channel.  The bytes are written to
+// the UART directly since UARTwrite() would expand each '\n' byte.
+//
+//*****************************************************************************
+static void
+AppRPCWrite(void *pvInstance, const unsigned char *pucData,
+            unsigned long ulSize)
+{
+    while(ulSize--)
+    {
+        ROM_UARTCharPut(UART0_BASE, *pucData++);
+    }
+}
+
+//*****************************************************************************
+//
+// Runs the binary command channel until the console command is received.
+//
+//*****************************************************************************
+void
+AppRPCRun(void)
+{
+    unsigned char pucData[16];
+    unsigned long ulCount;
+
+    //
+    // Let the output of the command line finish, then pass received bytes
+    // through unchanged and start with nothing left over from the command.
+    //
+    UARTFlushTx(false);
+    UARTEchoSet(false);
+    UARTFlushRx();
+    RPCInit(&g_sRPC, g_psRPCTable, NUM_RPC, AppRPCWrite, 0);
+
+    while(g_bRPCMode)
+    {
+        //
+        // Pass on whatever has been received.  There is no delay here, since
+        // a frame can be longer than the receive buffer.
+        //
+        for(ulCount = 0; (ulCount < sizeof(pucData)) && UARTRxBytesAvail();
+            ulCount++)
+        {
+            pucData[ulCount] = UARTgetc();
+        }
+        if(ulCount)
+        {
+            RPCReceive(&g_sRPC, pucData, ulCount);
+        }
+
+        //
+        // Check for change of mode and enter hibernate if requested.
+        //
+        if(g_sAppState.ulMode == APP_MODE_HIB)
+        {
+            AppHibernateEnter();
+        }
+    }
+
+    UARTEchoSet(true);
+}
+
 //*****************************************************************************
 //
 // Main function performs init and manages system.
@@ -671,5 +752,13 @@ main(void)
         {
             UARTprintf("Too many arguments for command processor!\n");
         }
+
+        //
+        // Run the binary command channel if the rpc command asked for it.
+        //
+        if(g_bRPCMode)
+        {
+            AppRPCRun();
+        }
     }
 }
@@ -87,4 +87,5 @@ extern volatile sAppState_t g_sAppState;
 extern void AppButtonHandler(void);
 extern void AppRainbow(unsigned long ulForceUpdate);
 extern void AppHibernateEnter(void);
+extern void AppRPCRun(void);
 
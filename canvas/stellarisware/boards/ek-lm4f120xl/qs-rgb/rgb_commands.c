@@ -28,6 +28,7 @@
 #include "utils/ustdlib.h"
 #include "utils/uartstdio.h"
 #include "utils/cmdline.h"
+#include "utils/rpc.h"
 #include "rgb_commands.h"
 
 //*****************************************************************************
@@ -42,11 +43,37 @@ tCmdLineEntry g_sCmdTable[] =
     {"rand",     CMD_rand,      " : Start automatic color sequencing"},
     {"intensity",CMD_intensity, " : Adjust brightness 0 to 100 percent"},
     {"rgb",      CMD_rgb,       " : Adjust color 000000-FFFFFF HTML notation"},
+    {"rpc",      CMD_rpc,       " : Switch to the binary command channel"},
     { 0, 0, 0 }
 };
 
 const int NUM_CMD = sizeof(g_sCmdTable)/sizeof(tCmdLineEntry);
 
+//*****************************************************************************
+//
+// Table of binary commands, indexed by command identifier, with the shortest
+// and longest payload that each accepts.
+//
+//*****************************************************************************
+const tRPCEntry g_psRPCTable[] =
+{
+    { RPCEcho,       0, 255 },
+    { RPC_rgb,       6, 6 },
+    { RPC_intensity, 2, 2 },
+    { RPC_state,     0, 0 },
+    { RPC_console,   0, 0 }
+};
+
+const unsigned long NUM_RPC = sizeof(g_psRPCTable)/sizeof(tRPCEntry);
+
+//*****************************************************************************
+//
+// Set by the rpc command and cleared by the binary console command, while the
+// UART carries the binary command channel rather than the command line.
+//
+//*****************************************************************************
+tBoolean g_bRPCMode = false;
+
 //*****************************************************************************
 //
 // Command: help
@@ -163,3 +190,120 @@ CMD_rgb (int argc, char **argv)
     return (0);
 
 }
+
+//*****************************************************************************
+//
+// Command: rpc
+//
+// Switches the UART to the binary command channel, until binary command
+// RPC_CMD_CONSOLE is received.
+//
+//*****************************************************************************
+int
+CMD_rpc (int argc, char **argv)
+{
+    (void) argc;
+    (void) argv;
+    g_bRPCMode = true;
+
+    return (0);
+}
+
+//*****************************************************************************
+//
+// Binary command: rgb
+//
+// Takes the red, green and blue levels as three 16 bit values, least
+// significant byte first, and sets the color.
+//
+//*****************************************************************************
+unsigned long
+RPC_rgb (tRPCInstance *psInst, const unsigned char *pucData,
+         unsigned long ulLen)
+{
+    g_sAppState.ulColors[RED] = pucData[0] | (pucData[1] << 8);
+    g_sAppState.ulColors[GREEN] = pucData[2] | (pucData[3] << 8);
+    g_sAppState.ulColors[BLUE] = pucData[4] | (pucData[5] << 8);
+    g_sAppState.ulMode = APP_MODE_REMOTE;
+    g_sAppState.ulModeTimer = 0;
+    RGBColorSet(g_sAppState.ulColors);
+
+    return (RPC_STATUS_OK);
+}
+
+//*****************************************************************************
+//
+// Binary command: intensity
+//
+// Takes the brightness as a 16 bit value in hundredths of a percent, from 0
+// to 10000.
+//
+//*****************************************************************************
+unsigned long
+RPC_intensity (tRPCInstance *psInst, const unsigned char *pucData,
+               unsigned long ulLen)
+{
+    unsigned long ulIntensity;
+
+    ulIntensity = pucData[0] | (pucData[1] << 8);
+    if(ulIntensity > 10000)
+    {
+        return (RPC_STATUS_BAD_VALUE);
+    }
+
+    g_sAppState.fIntensity = ((float) ulIntensity) / 10000.0f;
+    RGBIntensitySet(g_sAppState.fIntensity);
+
+    return (RPC_STATUS_OK);
+}
+
+//*****************************************************************************
+//
+// Binary command: state
+//
+// Returns the red, green and blue levels and the brightness, in the form
+// taken by the rgb and intensity commands, followed by the mode.
+//
+//*****************************************************************************
+unsigned long
+RPC_state (tRPCInstance *psInst, const unsigned char *pucData,
+           unsigned long ulLen)
+{
+    unsigned char pucState[9];
+    unsigned long ulIdx, ulValue;
+
+    for(ulIdx = 0; ulIdx < 4; ulIdx++)
+    {
+        if(ulIdx < 3)
+        {
+            ulValue = g_sAppState.ulColors[ulIdx];
+        }
+        else
+        {
+            ulValue = (unsigned long)((g_sAppState.fIntensity * 10000.0f) +
+                                      0.5f);
+        }
+        pucState[ulIdx * 2] = ulValue & 0xFF;
+        pucState[(ulIdx * 2) + 1] = (ulValue >> 8) & 0xFF;
+    }
+    pucState[8] = (unsigned char)g_sAppState.ulMode;
+    RPCResponseWrite(psInst, pucState, sizeof(pucState));
+
+    return (RPC_STATUS_OK);
+}
+
+//*****************************************************************************
+//
+// Binary command: console
+//
+// Returns the UART to the command line.
+//
+//*****************************************************************************
+unsigned long
+RPC_console (tRPCInstance *psInst, const unsigned char *pucData,
+             unsigned long ulLen)
+{
+    g_bRPCMode = false;
+
+    return (RPC_STATUS_OK);
+}
@@ -47,5 +47,48 @@ extern int CMD_hib (int argc, char **argv);
 extern int CMD_rand (int argc, char **argv);
 extern int CMD_intensity (int argc, char **argv);
 extern int CMD_rgb (int argc, char **argv);
+extern int CMD_rpc (int argc, char **argv);
+
+//*****************************************************************************
+//
+// The identifiers of the commands of the binary command channel, which is
+// entered with the rpc command, and a status returned for a value that is
+// out of range.
+//
+//*****************************************************************************
+#define RPC_CMD_RGB             1
+#define RPC_CMD_INTENSITY       2
+#define RPC_CMD_STATE           3
+#define RPC_CMD_CONSOLE         4
+
+#define RPC_STATUS_BAD_VALUE    1
+
+//*****************************************************************************
+//
+// The table of binary commands, the number of entries in it, and whether
+// the UART is in use by the binary command channel.
+//
+//*****************************************************************************
+extern const tRPCEntry g_psRPCTable[];
+extern const unsigned long NUM_RPC;
+extern tBoolean g_bRPCMode;
+
+//*****************************************************************************
+//
+// Declaration for the callback functions that implement the binary commands.
+//
+//*****************************************************************************
+extern unsigned long RPC_rgb (tRPCInstance *psInst,
+                              const unsigned char *pucData,
+                              unsigned long ulLen);
+extern unsigned long RPC_intensity (tRPCInstance *psInst,
+                                    const unsigned char *pucData,
+                                    unsigned long ulLen);
+extern unsigned long RPC_state (tRPCInstance *psInst,
+                                const unsigned char *pucData,
+                                unsigned long ulLen);
+extern unsigned long RPC_console (tRPCInstance *psInst,
+                                  const unsigned char *pucData,
+                                  unsigned long ulLen);
 
 #endif //__RGB_COMMANDS_H__
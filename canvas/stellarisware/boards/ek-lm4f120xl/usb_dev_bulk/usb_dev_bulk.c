@@ -54,6 +54,13 @@
 //! Data received from the host is assumed to be ASCII text and it is
 //! echoed back with the case of all alphabetic characters swapped.
 //!
+//! If the host sends a packet containing a single zero byte, the device
+//! switches to a source/sink mode in which all data received from the host is
+//! discarded and the bulk IN endpoint is kept supplied with a stream of
+//! data.  This allows the throughput of both directions to be measured by the
+//! benchmark mode of usb_bulk_example.  The device returns to echo mode
+//! whenever the host sets its configuration.
+//!
 //! A Windows INF file for the device is provided on the installation CD and
 //! in the C:/StellarisWare/windows_drivers directory of StellarisWare
 //! releases.  This INF contains information required to install the WinUSB
@@ -96,6 +103,24 @@ volatile unsigned long g_ulSysTickCount = 0;
 //*****************************************************************************
 volatile unsigned long g_ulTxCount = 0;
 volatile unsigned long g_ulRxCount = 0;
+
+//*****************************************************************************
+//
+// The packet that switches the device from echo mode to source/sink mode is a
+// single byte with this value.  It cannot be sent by usb_bulk_example in its
+// interactive mode, which only sends non-empty strings.
+//
+//*****************************************************************************
+#define SOURCE_SINK_COMMAND     0x00
+
+//*****************************************************************************
+//
+// Set when the device is in source/sink mode, and the next byte of the data
+// that is sourced to the host, which is an incrementing count.
+//
+//*****************************************************************************
+static volatile tBoolean g_bSourceSink = false;
+static unsigned char g_ucSourceData = 0;
 #ifdef DEBUG
 unsigned long g_ulUARTRxErrors = 0;
 #endif
@@ -304,6 +329,44 @@ EchoNewDataToHost(tUSBDBulkDevice *psDevice, unsigned char *pcData,
     return(ulCount);
 }
 
+//*****************************************************************************
+//
+// Fills the transmit buffer with data for the host in source/sink mode.
+//
+// This function is called when the device enters source/sink mode and each
+// time a transmission completes, so that the bulk IN endpoint always has data
+// to send.  The data is an incrementing count which allows the host to check
+// that nothing was lost.
+//
+// \return None.
+//
+//*****************************************************************************
+static void
+SourceDataToHost(void)
+{
+    unsigned long ulSpace, ulCount, ulWriteIndex;
+    tUSBRingBufObject sTxRing;
+
+    //
+    // Write directly to the transmit buffer, as EchoNewDataToHost() does.
+    //
+    USBBufferInfoGet(&g_sTxBuffer, &sTxRing);
+    ulSpace = USBBufferSpaceAvailable(&g_sTxBuffer);
+    ulWriteIndex = sTxRing.ulWriteIndex;
+
+    for(ulCount = 0; ulCount < ulSpace; ulCount++)
+    {
+        g_pucUSBTxBuffer[ulWriteIndex] = g_ucSourceData++;
+        ulWriteIndex++;
+        ulWriteIndex = (ulWriteIndex == BULK_BUFFER_SIZE) ? 0 : ulWriteIndex;
+    }
+
+    //
+    // Send the new data.
+    //
+    USBBufferDataWritten(&g_sTxBuffer, ulSpace);
+}
+
 //*****************************************************************************
 //
 // Handles bulk driver notifications related to the transmit channel (data to
@@ -332,6 +395,14 @@ TxHandler(void *pvCBData, unsigned long ulEvent, unsigned long ulMsgValue,
     if(ulEvent == USB_EVENT_TX_COMPLETE)
     {
         g_ulTxCount += ulMsgValue;
+
+        //
+        // In source/sink mode, refill the space that has just been sent.
+        //
+        if(g_bSourceSink)
+        {
+            SourceDataToHost();
+        }
     }
 
     //
@@ -374,6 +445,7 @@ RxHandler(void *pvCBData, unsigned long ulEvent,
         case USB_EVENT_CONNECTED:
         {
             g_bUSBConfigured = true;
+            g_bSourceSink = false;
             UARTprintf("Host connected.\n");
 
             //
@@ -391,6 +463,7 @@ RxHandler(void *pvCBData, unsigned long ulEvent,
         case USB_EVENT_DISCONNECTED:
         {
             g_bUSBConfigured = false;
+            g_bSourceSink = false;
             UARTprintf("Host disconnected.\n");
             break;
         }
@@ -408,6 +481,29 @@ RxHandler(void *pvCBData, unsigned long ulEvent,
             //
             psDevice = (tUSBDBulkDevice *)pvCBData;
 
+            //
+            // In source/sink mode, discard everything the host sends.
+            //
+            if(g_bSourceSink)
+            {
+                g_ulRxCount += ulMsgValue;
+                return(ulMsgValue);
+            }
+
+            //
+            // Switch to source/sink mode if this is the command to do so,
+            // and start sending data to the host.
+            //
+            if((ulMsgValue == 1) &&
+               (*(unsigned char *)pvMsgData == SOURCE_SINK_COMMAND))
+            {
+                UARTprintf("Source/sink mode.\n");
+                g_bSourceSink = true;
+                g_ulRxCount++;
+                SourceDataToHost();
+                return(1);
+            }
+
             //
             // Read the new packet and echo it back to the host.
             //
@@ -0,0 +1,62 @@
+/*
+    FreeRTOS V7.1.1 - POSIX/Linux simulator demo configuration.
+
+    1 tab == 4 spaces!
+*/
+
+#ifndef FREERTOS_CONFIG_H
+#define FREERTOS_CONFIG_H
+
+/*-----------------------------------------------------------
+ * Application specific definitions.
+ *
+ * These definitions should be adjusted for your particular hardware and
+ * application requirements.
+ *
+ * THESE PARAMETERS ARE DESCRIBED WITHIN THE 'CONFIGURATION' SECTION OF THE
+ * FreeRTOS API DOCUMENTATION AVAILABLE ON THE FreeRTOS.org WEB SITE.
+ *
+ * See http://www.freertos.org/a00110.html.
+ *----------------------------------------------------------*/
+
+#define configUSE_PREEMPTION			1
+#define configUSE_IDLE_HOOK				0
+#define configUSE_TICK_HOOK				0
+#define configCPU_CLOCK_HZ				( ( unsigned long ) 50000000 )
+#define configTICK_RATE_HZ				( ( portTickType ) 1000 )
+#define configMINIMAL_STACK_SIZE		( ( unsigned short ) 64 )
+#define configTOTAL_HEAP_SIZE			( ( size_t ) ( 256 * 1024 ) )
+#define configMAX_TASK_NAME_LEN			( 12 )
+#define configUSE_TRACE_FACILITY		0
+#define configUSE_16_BIT_TICKS			0
+#define configIDLE_SHOULD_YIELD			1
+#define configUSE_MUTEXES				1
+#define configUSE_RECURSIVE_MUTEXES		1
+#define configUSE_COUNTING_SEMAPHORES	1
+#define configQUEUE_REGISTRY_SIZE		0
+#define configUSE_CO_ROUTINES			0
+#define configCHECK_FOR_STACK_OVERFLOW	0
+
+#define configMAX_PRIORITIES			( ( unsigned portBASE_TYPE ) 8 )
+#define configMAX_CO_ROUTINE_PRIORITIES	( 2 )
+
+/* Run on the virtual tick unless told otherwise on the command line.  See
+portmacro.h. */
+#ifndef configPOSIX_VIRTUAL_TIME
+#define configPOSIX_VIRTUAL_TIME		1
+#endif
+
+/* Set the following definitions to 1 to include the API function, or zero
+to exclude the API function. */
+
+#define INCLUDE_vTaskPrioritySet		1
+#define INCLUDE_uxTaskPriorityGet		1
+#define INCLUDE_vTaskDelete				1
+#define INCLUDE_vTaskCleanUpResources	0
+#define INCLUDE_vTaskSuspend			1
+#define INCLUDE_vTaskDelayUntil			1
+#define INCLUDE_vTaskDelay				1
+#define INCLUDE_xTaskGetSchedulerState	1
+#define INCLUDE_xTaskGetIdleTaskHandle	1
+
+#endif /* FREERTOS_CONFIG_H */
@@ -0,0 +1,61 @@
+/*
+    FreeRTOS V7.1.1 - POSIX/Linux simulator configuration for the EK-LM4F120XL
+    freertos_demo tasks.
+
+    1 tab == 4 spaces!
+*/
+
+#ifndef FREERTOS_CONFIG_H
+#define FREERTOS_CONFIG_H
+
+/*-----------------------------------------------------------
+ * Application specific definitions.
+ *
+ * These follow boards/ek-lm4f120xl/freertos_demo/FreeRTOSConfig.h, less the
+ * Cortex-M interrupt priorities and the trace and stack checking that need
+ * the target.
+ *
+ * THESE PARAMETERS ARE DESCRIBED WITHIN THE 'CONFIGURATION' SECTION OF THE
+ * FreeRTOS API DOCUMENTATION AVAILABLE ON THE FreeRTOS.org WEB SITE.
+ *
+ * See http://www.freertos.org/a00110.html.
+ *----------------------------------------------------------*/
+
+#define configUSE_PREEMPTION			1
+#define configUSE_IDLE_HOOK				0
+#define configUSE_TICK_HOOK				0
+#define configCPU_CLOCK_HZ				( ( unsigned long ) 50000000 )
+#define configTICK_RATE_HZ				( ( portTickType ) 1000 )
+#define configMINIMAL_STACK_SIZE		( ( unsigned short ) 200 )
+#define configTOTAL_HEAP_SIZE			( ( size_t ) ( 64 * 1024 ) )
+#define configMAX_TASK_NAME_LEN			( 12 )
+#define configUSE_TRACE_FACILITY		0
+#define configUSE_16_BIT_TICKS			0
+#define configIDLE_SHOULD_YIELD			0
+#define configUSE_CO_ROUTINES			0
+#define configUSE_MUTEXES				1
+#define configUSE_RECURSIVE_MUTEXES		1
+#define configCHECK_FOR_STACK_OVERFLOW	0
+
+#define configMAX_PRIORITIES			( ( unsigned portBASE_TYPE ) 16 )
+#define configMAX_CO_ROUTINE_PRIORITIES	( 2 )
+#define configQUEUE_REGISTRY_SIZE		0
+
+/* The tick is stepped by the test thread in main.c.  See portmacro.h. */
+#define configPOSIX_STEPPED_TIME		1
+#define configPOSIX_VIRTUAL_TIME		0
+
+/* Set the following definitions to 1 to include the API function, or zero
+to exclude the API function. */
+
+#define INCLUDE_vTaskPrioritySet		1
+#define INCLUDE_uxTaskPriorityGet		1
+#define INCLUDE_vTaskDelete				1
+#define INCLUDE_vTaskCleanUpResources	0
+#define INCLUDE_vTaskSuspend			1
+#define INCLUDE_vTaskDelayUntil			1
+#define INCLUDE_vTaskDelay				1
+#define INCLUDE_xTaskGetSchedulerState	1
+#define INCLUDE_xTaskGetIdleTaskHandle	1
+
+#endif /* FREERTOS_CONFIG_H */
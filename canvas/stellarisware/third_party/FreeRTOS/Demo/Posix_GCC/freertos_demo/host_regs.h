@@ -0,0 +1,23 @@
+/*
+    FreeRTOS V7.1.1 - POSIX/Linux simulator register access for board code.
+
+    1 tab == 4 spaces!
+*/
+
+#ifndef HOST_REGS_H
+#define HOST_REGS_H
+
+/*
+ * This header is included ahead of every source file built for the host, so
+ * that the direct register accesses made by board code, such as the GPIO
+ * unlock in SwitchTaskInit(), land in a register file held in host memory
+ * rather than at the target's peripheral addresses.
+ */
+#include "inc/hw_types.h"
+
+#undef HWREG
+#define HWREG( x )		( *pulHostRegister( ( unsigned long ) ( x ) ) )
+
+extern volatile unsigned long *pulHostRegister( unsigned long ulAddress );
+
+#endif /* HOST_REGS_H */
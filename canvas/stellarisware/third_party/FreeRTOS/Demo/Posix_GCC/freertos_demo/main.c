@@ -0,0 +1,378 @@
+/*
+    FreeRTOS V7.1.1 - POSIX/Linux simulator build of the EK-LM4F120XL
+    freertos_demo tasks.
+
+    1 tab == 4 spaces!
+*/
+
+/*
+ * This project builds led_task.c and switch_task.c from
+ * boards/ek-lm4f120xl/freertos_demo unchanged, on top of stand-ins for the
+ * RGB LED, the buttons and the UART, and runs them on a Linux or other POSIX
+ * host using the port in Source/portable/GCC/Posix.
+ *
+ * main() creates the UART mutex and the two tasks as the target's main() does,
+ * starts a test thread, then starts the scheduler.  The port is built with
+ * configPOSIX_STEPPED_TIME set to 1, so the tick only advances when the test
+ * thread calls vPortSimulatorStepTicks(), and every task has blocked again by
+ * the time that call returns.  The test thread presses and releases the
+ * buttons between steps and checks the exact tick at which the LED task turns
+ * the LED on and off, the colour it selects and the messages printed.  Since
+ * nothing depends on the host clock the result is the same on every run.
+ *
+ * The program exits with a status of zero only if every check passed.
+ */
+
+/* Standard includes. */
+#include <pthread.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Scheduler includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+#include "semphr.h"
+
+/* Board includes. */
+#include "inc/hw_memmap.h"
+#include "inc/hw_types.h"
+#include "driverlib/gpio.h"
+#include "drivers/buttons.h"
+#include "drivers/rgb.h"
+#include "utils/uartstdio.h"
+#include "led_task.h"
+#include "switch_task.h"
+
+/* The number of words in the register file that stands in for the target's
+peripherals, and the largest number of LED changes and characters of UART
+output that are recorded. */
+#define mainNUM_HOST_REGISTERS		64
+#define mainLED_LOG_SIZE			64
+#define mainUART_LOG_SIZE			4096
+
+/* The number of ticks for which a button is held down, which is longer than
+the switch task's polling period. */
+#define mainBUTTON_HOLD_TICKS		( ( portTickType ) 50 )
+
+/* A change of the LED made by the LED task, and the tick at which it was made. */
+typedef struct xLED_EVENT
+{
+	portTickType xTick;
+	portBASE_TYPE xOn;
+} xLEDEvent;
+
+/*
+ * The test thread, as described at the top of this file.
+ */
+static void *prvTestThread( void *pvParameters );
+
+/*
+ * Advances the tick count to xTick.
+ */
+static void prvStepTo( portTickType xTick );
+
+/*
+ * Holds down the given buttons long enough for the switch task to see them,
+ * then releases them.
+ */
+static void prvPressButtons( unsigned char ucButtons );
+
+/*
+ * Checks that the LED changes made since the last call are exactly those in
+ * pxExpected.
+ */
+static void prvCheckLED( const char *pcStage, const xLEDEvent *pxExpected, unsigned long ulExpected );
+
+/*
+ * Checks that the UART output includes pcExpected.
+ */
+static void prvCheckUART( const char *pcStage, const char *pcExpected );
+
+/*
+ * Records a change of the LED.
+ */
+static void prvRecordLED( portBASE_TYPE xOn );
+
+/* The mutex that guards the UART, which the board's tasks expect main() to
+create. */
+xSemaphoreHandle g_pUARTSemaphore;
+
+/* The state of the simulated board.  The buttons are only changed by the test
+thread while every task is blocked. */
+static volatile unsigned char ucButtonState = 0;
+static volatile unsigned long ulLEDColor[ 3 ];
+static xLEDEvent xLEDLog[ mainLED_LOG_SIZE ];
+static unsigned long ulLEDEvents = 0, ulLEDChecked = 0;
+static char cUARTLog[ mainUART_LOG_SIZE ];
+static unsigned long ulUARTLength = 0;
+
+/* The tick count reached by the test thread, which must not call the kernel
+itself since it is not a task. */
+static portTickType xTestTick = 0;
+
+/* Set to pdTRUE by the test thread if any check fails. */
+static volatile portBASE_TYPE xErrorOccurred = pdFALSE;
+
+/* The LED changes expected from the LED task at its default rate, which turns
+the LED on for 250 ticks out of every 500. */
+static const xLEDEvent xDefaultRate[] =
+{
+	{ 0, pdTRUE }, { 250, pdFALSE }, { 500, pdTRUE }, { 750, pdFALSE }, { 1000, pdTRUE }
+};
+
+/* The right button is pressed at tick 1000 and is seen by the switch task at
+its next poll at tick 1025.  The LED task reads the message at the start of its
+next cycle, at tick 1500, and doubles its delay. */
+static const xLEDEvent xRightButton[] =
+{
+	{ 1250, pdFALSE }, { 1500, pdTRUE }, { 2000, pdFALSE }, { 2500, pdTRUE }, { 3000, pdFALSE }
+};
+
+/* The left button is pressed at tick 3000, and the LED task selects the next
+colour at the start of its next cycle, at tick 3500. */
+static const xLEDEvent xLeftButton[] =
+{
+	{ 3500, pdTRUE }, { 4000, pdFALSE }
+};
+
+/*-----------------------------------------------------------*/
+
+int main( void )
+{
+pthread_t xTestThread;
+
+	/* Create a mutex to guard the UART, then the LED and switch tasks. */
+	g_pUARTSemaphore = xSemaphoreCreateMutex();
+
+	if( ( LEDTaskInit() != 0 ) || ( SwitchTaskInit() != 0 ) )
+	{
+		fprintf( stderr, "Unable to create the tasks.\n" );
+		return EXIT_FAILURE;
+	}
+
+	/* Start the test, then the scheduler.  This returns when the test ends
+	it. */
+	pthread_create( &xTestThread, NULL, prvTestThread, NULL );
+	vTaskStartScheduler();
+	pthread_join( xTestThread, NULL );
+
+	printf( "%lu: %s\n", ( unsigned long ) xTestTick, ( xErrorOccurred == pdFALSE ) ? "PASS" : "FAIL" );
+
+	return ( xErrorOccurred == pdFALSE ) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+/*-----------------------------------------------------------*/
+
+static void *prvTestThread( void *pvParameters )
+{
+	( void ) pvParameters;
+
+	/* The LED blinks green at the default rate. */
+	prvStepTo( 1000 );
+	prvCheckLED( "Default rate", xDefaultRate, sizeof( xDefaultRate ) / sizeof( xDefaultRate[ 0 ] ) );
+	prvCheckUART( "Default rate", "Led 0 is blinking. [G, R, B]\n" );
+	prvCheckUART( "Default rate", "Led blinking frequency is 500 ms.\n" );
+
+	/* The right button halves the rate. */
+	prvPressButtons( RIGHT_BUTTON );
+	prvStepTo( 3000 );
+	prvCheckLED( "Right button", xRightButton, sizeof( xRightButton ) / sizeof( xRightButton[ 0 ] ) );
+	prvCheckUART( "Right button", "Right Button is pressed.\n" );
+	prvCheckUART( "Right button", "Led blinking frequency is 1000 ms.\n" );
+
+	/* The left button selects the red LED. */
+	prvPressButtons( LEFT_BUTTON );
+	prvStepTo( 4000 );
+	prvCheckLED( "Left button", xLeftButton, sizeof( xLeftButton ) / sizeof( xLeftButton[ 0 ] ) );
+	prvCheckUART( "Left button", "Left Button is pressed.\n" );
+	prvCheckUART( "Left button", "Led 1 is blinking. [G, R, B]\n" );
+
+	if( ( ulLEDColor[ 0 ] != 0 ) || ( ulLEDColor[ 1 ] != 0x8000 ) || ( ulLEDColor[ 2 ] != 0 ) )
+	{
+		printf( "Left button: the LED colour is [%lx, %lx, %lx].\n", ulLEDColor[ 0 ], ulLEDColor[ 1 ], ulLEDColor[ 2 ] );
+		xErrorOccurred = pdTRUE;
+	}
+
+	vPortSimulatorEndScheduler();
+
+	return NULL;
+}
+/*-----------------------------------------------------------*/
+
+static void prvStepTo( portTickType xTick )
+{
+	vPortSimulatorStepTicks( xTick - xTestTick );
+	xTestTick = xTick;
+}
+/*-----------------------------------------------------------*/
+
+static void prvPressButtons( unsigned char ucButtons )
+{
+	ucButtonState = ucButtons;
+	prvStepTo( xTestTick + mainBUTTON_HOLD_TICKS );
+	ucButtonState = 0;
+}
+/*-----------------------------------------------------------*/
+
+static void prvCheckLED( const char *pcStage, const xLEDEvent *pxExpected, unsigned long ulExpected )
+{
+unsigned long ulIndex;
+
+	for( ulIndex = 0; ulIndex < ulExpected; ulIndex++ )
+	{
+		if( ( ulLEDChecked + ulIndex >= ulLEDEvents ) ||
+			( xLEDLog[ ulLEDChecked + ulIndex ].xTick != pxExpected[ ulIndex ].xTick ) ||
+			( xLEDLog[ ulLEDChecked + ulIndex ].xOn != pxExpected[ ulIndex ].xOn ) )
+		{
+			printf( "%s: expected the LED to turn %s at tick %lu.\n", pcStage, pxExpected[ ulIndex ].xOn ? "on" : "off", ( unsigned long ) pxExpected[ ulIndex ].xTick );
+			xErrorOccurred = pdTRUE;
+			break;
+		}
+	}
+
+	if( ulLEDEvents != ulLEDChecked + ulExpected )
+	{
+		printf( "%s: expected %lu LED changes, not %lu.\n", pcStage, ulExpected, ulLEDEvents - ulLEDChecked );
+		xErrorOccurred = pdTRUE;
+	}
+
+	ulLEDChecked = ulLEDEvents;
+}
+/*-----------------------------------------------------------*/
+
+static void prvCheckUART( const char *pcStage, const char *pcExpected )
+{
+	if( strstr( cUARTLog, pcExpected ) == NULL )
+	{
+		printf( "%s: expected \"%.*s\" on the UART.\n", pcStage, ( int ) strlen( pcExpected ) - 1, pcExpected );
+		xErrorOccurred = pdTRUE;
+	}
+}
+/*-----------------------------------------------------------*/
+
+static void prvRecordLED( portBASE_TYPE xOn )
+{
+	if( ulLEDEvents < mainLED_LOG_SIZE )
+	{
+		xLEDLog[ ulLEDEvents ].xTick = xTaskGetTickCount();
+		xLEDLog[ ulLEDEvents ].xOn = xOn;
+		ulLEDEvents++;
+	}
+}
+/*-----------------------------------------------------------*/
+
+/*
+ * The stand-in for the target's peripheral registers.  Accesses that are not
+ * modelled by the functions below, such as the GPIO unlock made by
+ * SwitchTaskInit(), are kept here and otherwise ignored.
+ */
+volatile unsigned long *pulHostRegister( unsigned long ulAddress )
+{
+static volatile unsigned long ulRegisters[ mainNUM_HOST_REGISTERS ];
+
+	return &ulRegisters[ ( ulAddress >> 2 ) % mainNUM_HOST_REGISTERS ];
+}
+/*-----------------------------------------------------------*/
+
+/*
+ * The stand-ins for drivers/rgb.c.
+ */
+void RGBInit( unsigned long ulEnable )
+{
+	( void ) ulEnable;
+}
+/*-----------------------------------------------------------*/
+
+void RGBIntensitySet( float fIntensity )
+{
+	( void ) fIntensity;
+}
+/*-----------------------------------------------------------*/
+
+void RGBColorSet( volatile unsigned long *pulRGBColor )
+{
+unsigned long ulIndex;
+
+	for( ulIndex = 0; ulIndex < 3; ulIndex++ )
+	{
+		ulLEDColor[ ulIndex ] = pulRGBColor[ ulIndex ];
+	}
+}
+/*-----------------------------------------------------------*/
+
+void RGBEnable( void )
+{
+	prvRecordLED( pdTRUE );
+}
+/*-----------------------------------------------------------*/
+
+void RGBDisable( void )
+{
+	prvRecordLED( pdFALSE );
+}
+/*-----------------------------------------------------------*/
+
+/*
+ * The stand-ins for drivers/buttons.c.  The buttons are already debounced.
+ */
+void ButtonsInit( void )
+{
+}
+/*-----------------------------------------------------------*/
+
+unsigned char ButtonsPoll( unsigned char *pucDelta, unsigned char *pucRaw )
+{
+static unsigned char ucLastState = 0;
+unsigned char ucState;
+
+	ucState = ucButtonState;
+
+	if( pucDelta != NULL )
+	{
+		*pucDelta = ucState ^ ucLastState;
+	}
+
+	if( pucRaw != NULL )
+	{
+		*pucRaw = ucState;
+	}
+
+	ucLastState = ucState;
+
+	return ucState;
+}
+/*-----------------------------------------------------------*/
+
+/*
+ * The stand-in for utils/uartstdio.c, which prints to the host's standard
+ * output and keeps a copy for the test to check.
+ */
+void UARTprintf( const char *pcString, ... )
+{
+va_list vaArgP;
+int iLength;
+
+	/* The host C library must not be entered by a task that can be
+	preempted while inside it. */
+	taskENTER_CRITICAL();
+	{
+		va_start( vaArgP, pcString );
+		iLength = vsnprintf( cUARTLog + ulUARTLength, mainUART_LOG_SIZE - ulUARTLength, pcString, vaArgP );
+		va_end( vaArgP );
+
+		if( iLength > 0 )
+		{
+			fputs( cUARTLog + ulUARTLength, stdout );
+			fflush( stdout );
+
+			ulUARTLength += ( unsigned long ) iLength;
+			if( ulUARTLength >= mainUART_LOG_SIZE )
+			{
+				ulUARTLength = mainUART_LOG_SIZE - 1;
+			}
+		}
+	}
+	taskEXIT_CRITICAL();
+}
+/*-----------------------------------------------------------*/
@@ -0,0 +1,258 @@
+/*
+    FreeRTOS V7.1.1 - POSIX/Linux simulator demo.
+
+    1 tab == 4 spaces!
+*/
+
+/*
+ * This project runs a selection of the standard demo tasks on a Linux or other
+ * POSIX host, using the port in Source/portable/GCC/Posix.  It is intended as
+ * a regression test for the kernel and for the port itself.
+ *
+ * main() creates the demo tasks and a 'check' task, then starts the scheduler.
+ * http://www.freertos.org/a00102.html provides more information on the
+ * standard demo tasks.
+ *
+ * + The 'check' task executes every mainCHECK_PERIOD ticks and checks that
+ * all the other tasks are still operational and that no errors have been
+ * detected at any time.  The result is printed together with the tick count.
+ * Once mainRUN_TIME ticks have passed the check task ends the scheduler, and
+ * the program exits with a status of zero only if every check passed.
+ *
+ * When built with configPOSIX_VIRTUAL_TIME set to 1 (the default) the time
+ * spent in the idle task is skipped.  Several of the standard demo tasks run
+ * continuously at the idle priority, so this demo still runs at close to real
+ * time, but an application whose tasks block runs far faster.
+ *
+ * When built with configUSE_TICKLESS_IDLE set to 1 only the demo tasks that
+ * block are created, so that the idle task can stop the tick, and the tick
+ * and sleep counters kept by the port are printed once the run is over.  The
+ * block time test tasks check that time is still kept correctly.
+ */
+
+/* Standard includes. */
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+/* Scheduler includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* Demo app includes. */
+#include "BlockQ.h"
+#include "blocktim.h"
+#include "countsem.h"
+#include "death.h"
+#include "dynamic.h"
+#include "GenQTest.h"
+#include "integer.h"
+#include "PollQ.h"
+#include "QPeek.h"
+#include "recmutex.h"
+#include "semtest.h"
+
+/* Demo task priorities. */
+#define mainQUEUE_POLL_PRIORITY		( tskIDLE_PRIORITY + 2 )
+#define mainSEM_TEST_PRIORITY		( tskIDLE_PRIORITY + 1 )
+#define mainBLOCK_Q_PRIORITY		( tskIDLE_PRIORITY + 2 )
+#define mainGEN_QUEUE_PRIORITY		( tskIDLE_PRIORITY )
+#define mainCREATOR_TASK_PRIORITY	( tskIDLE_PRIORITY + 3 )
+#define mainCHECK_TASK_PRIORITY		( configMAX_PRIORITIES - 1 )
+
+/* The period of the check task, and the length of the run, in ticks.  The
+run time can be overridden on the command line. */
+#define mainCHECK_PERIOD			( ( portTickType ) 5000 / portTICK_RATE_MS )
+#ifndef mainRUN_TIME
+	#define mainRUN_TIME			( ( portTickType ) 30000 / portTICK_RATE_MS )
+#endif
+
+/*
+ * The 'check' task, as described at the top of this file.
+ */
+static void vCheckTask( void *pvParameters );
+
+/*
+ * Returns pdTRUE if every demo task reports that it is still running without
+ * error.
+ */
+static portBASE_TYPE prvCheckOtherTasksAreStillRunning( void );
+
+/*
+ * Prints the tick and sleep counters kept by the port for a run that took
+ * ullRunNs nanoseconds of host time.
+ */
+static void prvPrintSleepStats( unsigned long long ullRunNs );
+
+/* Set to pdTRUE by the check task if an error has ever been detected. */
+static volatile portBASE_TYPE xErrorOccurred = pdFALSE;
+
+/*-----------------------------------------------------------*/
+
+int main( void )
+{
+struct timespec xStart, xEnd;
+
+	/* Start the standard demo tasks.  Those that never block keep the idle
+	task from running, so are left out of a tickless build. */
+	#if ( configUSE_TICKLESS_IDLE == 0 )
+	{
+		vStartIntegerMathTasks( tskIDLE_PRIORITY );
+		vStartSemaphoreTasks( mainSEM_TEST_PRIORITY );
+		vStartGenericQueueTasks( mainGEN_QUEUE_PRIORITY );
+		vStartCountingSemaphoreTasks();
+		vStartDynamicPriorityTasks();
+		vStartBlockingQueueTasks( mainBLOCK_Q_PRIORITY );
+		vStartRecursiveMutexTasks();
+	}
+	#endif
+	vStartPolledQueueTasks( mainQUEUE_POLL_PRIORITY );
+	vStartQueuePeekTasks();
+	vCreateBlockTimeTasks();
+
+	/* Start the task defined within this file. */
+	xTaskCreate( vCheckTask, ( signed char * ) "Check", configMINIMAL_STACK_SIZE, NULL, mainCHECK_TASK_PRIORITY, NULL );
+
+	/* The suicide tasks must be created last as they need to know how many
+	tasks were running prior to their creation in order to ascertain whether
+	or not the correct/expected number of tasks are running at any given
+	time. */
+	vCreateSuicidalTasks( mainCREATOR_TASK_PRIORITY );
+
+	/* Start the scheduler.  This returns when the check task ends it. */
+	clock_gettime( CLOCK_MONOTONIC, &xStart );
+	vTaskStartScheduler();
+	clock_gettime( CLOCK_MONOTONIC, &xEnd );
+
+	prvPrintSleepStats( ( ( unsigned long long ) ( xEnd.tv_sec - xStart.tv_sec ) * 1000000000ULL ) + ( unsigned long long ) xEnd.tv_nsec - ( unsigned long long ) xStart.tv_nsec );
+
+	return ( xErrorOccurred == pdFALSE ) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+/*-----------------------------------------------------------*/
+
+static void vCheckTask( void *pvParameters )
+{
+portTickType xLastExecutionTime;
+
+	( void ) pvParameters;
+
+	/* Initialise xLastExecutionTime so the first call to vTaskDelayUntil()
+	works correctly. */
+	xLastExecutionTime = xTaskGetTickCount();
+
+	for( ;; )
+	{
+		/* Perform this check every mainCHECK_PERIOD ticks. */
+		vTaskDelayUntil( &xLastExecutionTime, mainCHECK_PERIOD );
+
+		if( prvCheckOtherTasksAreStillRunning() != pdTRUE )
+		{
+			xErrorOccurred = pdTRUE;
+		}
+
+		/* The host C library must not be entered by a task that can be
+		preempted while inside it. */
+		taskENTER_CRITICAL();
+		{
+			printf( "%lu: %s\n", ( unsigned long ) xLastExecutionTime, ( xErrorOccurred == pdFALSE ) ? "PASS" : "FAIL" );
+			fflush( stdout );
+		}
+		taskEXIT_CRITICAL();
+
+		if( xLastExecutionTime >= mainRUN_TIME )
+		{
+			vTaskEndScheduler();
+		}
+	}
+}
+/*-----------------------------------------------------------*/
+
+static portBASE_TYPE prvCheckOtherTasksAreStillRunning( void )
+{
+portBASE_TYPE xReturn = pdTRUE;
+
+	#if ( configUSE_TICKLESS_IDLE == 0 )
+	{
+		if( xAreIntegerMathsTaskStillRunning() != pdTRUE )
+		{
+			xReturn = pdFALSE;
+		}
+
+		if( xAreSemaphoreTasksStillRunning() != pdTRUE )
+		{
+			xReturn = pdFALSE;
+		}
+
+		if( xAreGenericQueueTasksStillRunning() != pdTRUE )
+		{
+			xReturn = pdFALSE;
+		}
+
+		if( xAreCountingSemaphoreTasksStillRunning() != pdTRUE )
+		{
+			xReturn = pdFALSE;
+		}
+
+		if( xAreDynamicPriorityTasksStillRunning() != pdTRUE )
+		{
+			xReturn = pdFALSE;
+		}
+
+		if( xAreBlockingQueuesStillRunning() != pdTRUE )
+		{
+			xReturn = pdFALSE;
+		}
+
+		if( xAreRecursiveMutexTasksStillRunning() != pdTRUE )
+		{
+			xReturn = pdFALSE;
+		}
+	}
+	#endif
+
+	if( xArePollingQueuesStillRunning() != pdTRUE )
+	{
+		xReturn = pdFALSE;
+	}
+
+	if( xAreQueuePeekTasksStillRunning() != pdTRUE )
+	{
+		xReturn = pdFALSE;
+	}
+
+	if( xAreBlockTimeTestTasksStillRunning() != pdTRUE )
+	{
+		xReturn = pdFALSE;
+	}
+
+	if( xIsCreateTaskStillRunning() != pdTRUE )
+	{
+		xReturn = pdFALSE;
+	}
+
+	return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+static void prvPrintSleepStats( unsigned long long ullRunNs )
+{
+xPortSleepStats xStats;
+
+	vPortGetSleepStats( &xStats );
+
+	printf( "Run time:          %llu ms\n", ullRunNs / 1000000ULL );
+	printf( "Tick interrupts:   %lu\n", xStats.ulTickInterrupts );
+	printf( "Sleeps:            %lu (%lu aborted)\n", xStats.ulSleeps, xStats.ulAbortedSleeps );
+	printf( "Ticks suppressed:  %lu\n", xStats.ulTicksSuppressed );
+
+	if( ullRunNs != 0ULL )
+	{
+		printf( "Time asleep:       %llu.%llu%%\n", ( xStats.ullTimeAsleepNs * 100ULL ) / ullRunNs, ( ( xStats.ullTimeAsleepNs * 1000ULL ) / ullRunNs ) % 10ULL );
+	}
+
+	if( xStats.ulTimedWakes != 0UL )
+	{
+		printf( "Wake latency:      %llu us mean, %lu us worst\n", ( xStats.ullWakeLatencyNs / xStats.ulTimedWakes ) / 1000ULL, xStats.ulMaxWakeLatencyNs / 1000UL );
+	}
+}
+/*-----------------------------------------------------------*/
@@ -0,0 +1,94 @@
+/*
+    FreeRTOS V7.1.1 - Message buffers.
+
+    A message buffer passes variable length messages from a single writer to
+    a single reader, either of which may be a task or an interrupt.  Message
+    buffers are stream buffers that store the length of each message ahead
+    of its bytes, so the API is a set of macros over stream_buffer.h.  Each
+    message uses sizeof( configMESSAGE_BUFFER_LENGTH_TYPE ) bytes of the
+    buffer in addition to its own length.
+
+    1 tab == 4 spaces!
+*/
+
+#ifndef MESSAGE_BUFFER_H
+#define MESSAGE_BUFFER_H
+
+#ifndef INC_FREERTOS_H
+	#error "include FreeRTOS.h must appear in source files before include message_buffer.h"
+#endif
+
+#include "stream_buffer.h"
+
+/**
+ * Type by which message buffers are referenced.
+ */
+typedef xStreamBufferHandle xMessageBufferHandle;
+
+/**
+ * message_buffer.h
+ * <pre>xMessageBufferHandle xMessageBufferCreate( size_t xBufferSizeBytes );</pre>
+ *
+ * Creates a message buffer.  A task blocked reading a message buffer is
+ * unblocked as soon as a whole message has been written.
+ *
+ * @param xBufferSizeBytes The number of bytes the buffer can hold, including
+ * the length stored with each message.
+ *
+ * @return The handle of the created message buffer, or NULL if there was not
+ * enough heap to create it.
+ *
+ * \defgroup xMessageBufferCreate xMessageBufferCreate
+ * \ingroup MessageBufferManagement
+ */
+#define xMessageBufferCreate( xBufferSizeBytes ) ( xMessageBufferHandle ) xStreamBufferGenericCreate( ( xBufferSizeBytes ), ( size_t ) 0, pdTRUE )
+
+/**
+ * message_buffer.h
+ * <pre>size_t xMessageBufferSend( xMessageBufferHandle xMessageBuffer, const void *pvTxData, size_t xDataLengthBytes, portTickType xTicksToWait );</pre>
+ *
+ * Writes one message, waiting up to xTicksToWait for there to be room for
+ * all of it.  See xStreamBufferSend().
+ *
+ * @return xDataLengthBytes if the message was written, or 0 if it was not.
+ *
+ * \defgroup xMessageBufferSend xMessageBufferSend
+ * \ingroup MessageBufferManagement
+ */
+#define xMessageBufferSend( xMessageBuffer, pvTxData, xDataLengthBytes, xTicksToWait ) xStreamBufferSend( ( xStreamBufferHandle ) ( xMessageBuffer ), ( pvTxData ), ( xDataLengthBytes ), ( xTicksToWait ) )
+#define xMessageBufferSendFromISR( xMessageBuffer, pvTxData, xDataLengthBytes, pxHigherPriorityTaskWoken ) xStreamBufferSendFromISR( ( xStreamBufferHandle ) ( xMessageBuffer ), ( pvTxData ), ( xDataLengthBytes ), ( pxHigherPriorityTaskWoken ) )
+
+/**
+ * message_buffer.h
+ * <pre>size_t xMessageBufferReceive( xMessageBufferHandle xMessageBuffer, void *pvRxData, size_t xBufferLengthBytes, portTickType xTicksToWait );</pre>
+ *
+ * Reads one message, waiting up to xTicksToWait for one to arrive.  See
+ * xStreamBufferReceive().
+ *
+ * @return The length of the message received, or 0 if no message was
+ * received or the next message is longer than xBufferLengthBytes.
+ *
+ * \defgroup xMessageBufferReceive xMessageBufferReceive
+ * \ingroup MessageBufferManagement
+ */
+#define xMessageBufferReceive( xMessageBuffer, pvRxData, xBufferLengthBytes, xTicksToWait ) xStreamBufferReceive( ( xStreamBufferHandle ) ( xMessageBuffer ), ( pvRxData ), ( xBufferLengthBytes ), ( xTicksToWait ) )
+#define xMessageBufferReceiveFromISR( xMessageBuffer, pvRxData, xBufferLengthBytes, pxHigherPriorityTaskWoken ) xStreamBufferReceiveFromISR( ( xStreamBufferHandle ) ( xMessageBuffer ), ( pvRxData ), ( xBufferLengthBytes ), ( pxHigherPriorityTaskWoken ) )
+
+/**
+ * message_buffer.h
+ *
+ * The remaining message buffer operations, which behave as their stream
+ * buffer equivalents.  xMessageBufferNextLengthBytes() returns the length of
+ * the next message, so that a large enough buffer can be supplied to
+ * xMessageBufferReceive().
+ *
+ * \ingroup MessageBufferManagement
+ */
+#define xMessageBufferNextLengthBytes( xMessageBuffer ) xStreamBufferNextMessageLengthBytes( ( xStreamBufferHandle ) ( xMessageBuffer ) )
+#define xMessageBufferSpacesAvailable( xMessageBuffer ) xStreamBufferSpacesAvailable( ( xStreamBufferHandle ) ( xMessageBuffer ) )
+#define xMessageBufferIsEmpty( xMessageBuffer ) xStreamBufferIsEmpty( ( xStreamBufferHandle ) ( xMessageBuffer ) )
+#define xMessageBufferIsFull( xMessageBuffer ) xStreamBufferIsFull( ( xStreamBufferHandle ) ( xMessageBuffer ) )
+#define xMessageBufferReset( xMessageBuffer ) xStreamBufferReset( ( xStreamBufferHandle ) ( xMessageBuffer ) )
+#define vMessageBufferDelete( xMessageBuffer ) vStreamBufferDelete( ( xStreamBufferHandle ) ( xMessageBuffer ) )
+
+#endif /* MESSAGE_BUFFER_H */
@@ -100,6 +100,10 @@ only for ports that are using the MPU. */
 		#define uxTaskGetStackHighWaterMark		MPU_uxTaskGetStackHighWaterMark
 		#define xTaskGetCurrentTaskHandle		MPU_xTaskGetCurrentTaskHandle
 		#define xTaskGetSchedulerState			MPU_xTaskGetSchedulerState
+		#define xTaskGenericNotify				MPU_xTaskGenericNotify
+		#define xTaskNotifyWait					MPU_xTaskNotifyWait
+		#define ulTaskNotifyTake				MPU_ulTaskNotifyTake
+		#define xTaskNotifyStateClear			MPU_xTaskNotifyStateClear
 
 		#define xQueueGenericCreate				MPU_xQueueGenericCreate
 		#define xQueueCreateMutex				MPU_xQueueCreateMutex
@@ -370,6 +370,25 @@ void vPortFree( void *pv ) PRIVILEGED_FUNCTION;
 void vPortInitialiseBlocks( void ) PRIVILEGED_FUNCTION;
 size_t xPortGetFreeHeapSize( void ) PRIVILEGED_FUNCTION;
 
+/*
+ * Statistics about the heap, only provided by heap_4.c.  The fragmentation of
+ * the free space can be taken as the proportion of xFreeBytes that lies
+ * outside of the largest free block.
+ */
+typedef struct xHEAP_STATS
+{
+	size_t xFreeBytes;						/*<< The number of bytes in free blocks, including their headers. */
+	size_t xMinimumEverFreeBytes;			/*<< The lowest value of xFreeBytes since the heap was initialised. */
+	size_t xLargestFreeBlock;				/*<< The largest allocation that can currently succeed. */
+	unsigned long ulFreeBlocks;				/*<< The number of free blocks. */
+	unsigned long ulAllocations;			/*<< The number of successful calls to pvPortMalloc(). */
+	unsigned long ulFrees;					/*<< The number of blocks passed to vPortFree(). */
+	unsigned long ulFailedAllocations;		/*<< The number of calls to pvPortMalloc() that returned NULL. */
+} xHeapStats;
+
+size_t xPortGetMinimumEverFreeHeapSize( void ) PRIVILEGED_FUNCTION;
+void vPortGetHeapStats( xHeapStats *pxHeapStats ) PRIVILEGED_FUNCTION;
+
 /*
  * Setup the hardware ready for the scheduler to take control.  This generally
  * sets up a tick interrupt and sets timers for the correct tick frequency.
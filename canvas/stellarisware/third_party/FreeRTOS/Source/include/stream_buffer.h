@@ -0,0 +1,353 @@
+/*
+    FreeRTOS V7.1.1 - Stream buffers.
+
+    A stream buffer passes a stream of bytes from a single writer to a single
+    reader, either of which may be a task or an interrupt.  The bytes are
+    copied into and out of a circular buffer, or accessed in place through
+    the pointer functions, so that a DMA channel can fill or drain the buffer
+    directly.  See message_buffer.h for buffers of variable length messages.
+
+    1 tab == 4 spaces!
+*/
+
+#ifndef STREAM_BUFFER_H
+#define STREAM_BUFFER_H
+
+#ifndef INC_FREERTOS_H
+	#error "include FreeRTOS.h must appear in source files before include stream_buffer.h"
+#endif
+
+#include <stddef.h>
+#include "task.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Type by which stream buffers are referenced.  For example, a call to
+ * xStreamBufferCreate() returns an xStreamBufferHandle variable that can then
+ * be used as a parameter to xStreamBufferSend(), xStreamBufferReceive(), etc.
+ */
+typedef void * xStreamBufferHandle;
+
+/**
+ * stream_buffer.h
+ * <pre>xStreamBufferHandle xStreamBufferCreate( size_t xBufferSizeBytes, size_t xTriggerLevelBytes );</pre>
+ *
+ * Creates a stream buffer.  The buffer and its storage are allocated together
+ * with a single call to pvPortMalloc().
+ *
+ * Only one task or interrupt may write to a stream buffer, and only one task
+ * or interrupt may read from it.  Blocking is implemented with direct to task
+ * notifications, so configUSE_TASK_NOTIFICATIONS must be 1, and a task must
+ * not wait on a notification for another purpose while it is blocked on a
+ * stream buffer.
+ *
+ * @param xBufferSizeBytes The number of bytes the buffer can hold.
+ *
+ * @param xTriggerLevelBytes The number of bytes that must be in the buffer
+ * before a task blocked waiting for data is unblocked.  A trigger level of 0
+ * is treated as 1.  A task that times out is unblocked with however many
+ * bytes are in the buffer, if any.
+ *
+ * @return The handle of the created stream buffer, or NULL if there was not
+ * enough heap to create it.
+ *
+ * \defgroup xStreamBufferCreate xStreamBufferCreate
+ * \ingroup StreamBufferManagement
+ */
+#define xStreamBufferCreate( xBufferSizeBytes, xTriggerLevelBytes ) xStreamBufferGenericCreate( ( xBufferSizeBytes ), ( xTriggerLevelBytes ), pdFALSE )
+
+/**
+ * stream_buffer.h
+ * <pre>size_t xStreamBufferSend( xStreamBufferHandle xStreamBuffer, const void *pvTxData, size_t xDataLengthBytes, portTickType xTicksToWait );</pre>
+ *
+ * Copies bytes into a stream buffer from a task.  As many bytes as fit are
+ * written straight away, and the task then waits for more space until either
+ * all of the bytes have been written or xTicksToWait expires.
+ *
+ * Writing to a message buffer is all or nothing; the task waits until there
+ * is space for the whole message.
+ *
+ * @param xStreamBuffer The handle of the buffer to write to.
+ *
+ * @param pvTxData The bytes to write.
+ *
+ * @param xDataLengthBytes The number of bytes to write.
+ *
+ * @param xTicksToWait The maximum time to wait for space.  A block time of
+ * portMAX_DELAY waits indefinitely, provided INCLUDE_vTaskSuspend is 1.
+ *
+ * @return The number of bytes written.
+ *
+ * \defgroup xStreamBufferSend xStreamBufferSend
+ * \ingroup StreamBufferManagement
+ */
+size_t xStreamBufferSend( xStreamBufferHandle xStreamBuffer, const void *pvTxData, size_t xDataLengthBytes, portTickType xTicksToWait ) PRIVILEGED_FUNCTION;
+
+/**
+ * stream_buffer.h
+ * <pre>size_t xStreamBufferSendFromISR( xStreamBufferHandle xStreamBuffer, const void *pvTxData, size_t xDataLengthBytes, signed portBASE_TYPE *pxHigherPriorityTaskWoken );</pre>
+ *
+ * A version of xStreamBufferSend() that can be called from an interrupt.  It
+ * never waits, so writes only as many bytes as fit.
+ *
+ * @param pxHigherPriorityTaskWoken Set to pdTRUE if the write unblocked a
+ * task with a priority above that of the interrupted task, in which case a
+ * context switch should be requested before the interrupt exits.
+ *
+ * @return The number of bytes written.
+ *
+ * \defgroup xStreamBufferSendFromISR xStreamBufferSendFromISR
+ * \ingroup StreamBufferManagement
+ */
+size_t xStreamBufferSendFromISR( xStreamBufferHandle xStreamBuffer, const void *pvTxData, size_t xDataLengthBytes, signed portBASE_TYPE *pxHigherPriorityTaskWoken ) PRIVILEGED_FUNCTION;
+
+/**
+ * stream_buffer.h
+ * <pre>size_t xStreamBufferReceive( xStreamBufferHandle xStreamBuffer, void *pvRxData, size_t xBufferLengthBytes, portTickType xTicksToWait );</pre>
+ *
+ * Copies bytes out of a stream buffer into a task.  If the buffer is empty
+ * the task waits until the trigger level is reached or xTicksToWait expires,
+ * then receives however many bytes are available, up to xBufferLengthBytes.
+ *
+ * Reading from a message buffer receives one whole message.  If the message
+ * is longer than xBufferLengthBytes it is left in the buffer and 0 is
+ * returned.
+ *
+ * @param xStreamBuffer The handle of the buffer to read from.
+ *
+ * @param pvRxData The location to copy the bytes to.
+ *
+ * @param xBufferLengthBytes The size of pvRxData.
+ *
+ * @param xTicksToWait The maximum time to wait for data.
+ *
+ * @return The number of bytes received.
+ *
+ * \defgroup xStreamBufferReceive xStreamBufferReceive
+ * \ingroup StreamBufferManagement
+ */
+size_t xStreamBufferReceive( xStreamBufferHandle xStreamBuffer, void *pvRxData, size_t xBufferLengthBytes, portTickType xTicksToWait ) PRIVILEGED_FUNCTION;
+
+/**
+ * stream_buffer.h
+ * <pre>size_t xStreamBufferReceiveFromISR( xStreamBufferHandle xStreamBuffer, void *pvRxData, size_t xBufferLengthBytes, signed portBASE_TYPE *pxHigherPriorityTaskWoken );</pre>
+ *
+ * A version of xStreamBufferReceive() that can be called from an interrupt.
+ * It never waits.
+ *
+ * @return The number of bytes received.
+ *
+ * \defgroup xStreamBufferReceiveFromISR xStreamBufferReceiveFromISR
+ * \ingroup StreamBufferManagement
+ */
+size_t xStreamBufferReceiveFromISR( xStreamBufferHandle xStreamBuffer, void *pvRxData, size_t xBufferLengthBytes, signed portBASE_TYPE *pxHigherPriorityTaskWoken ) PRIVILEGED_FUNCTION;
+
+/**
+ * stream_buffer.h
+ * <pre>size_t xStreamBufferGetWritePointer( xStreamBufferHandle xStreamBuffer, void **ppvWrite );</pre>
+ *
+ * Gives the writer direct access to the free space in a stream buffer, so
+ * that data can be placed in it without being copied, for example by a DMA
+ * channel.  The free space may wrap around the end of the storage, so only
+ * the part that is contiguous is returned.  The bytes written are made
+ * available to the reader by vStreamBufferCommitWrite().  Does not wait, so
+ * can be called from an interrupt.  Cannot be used with message buffers.
+ *
+ * @param ppvWrite Set to the location at which to write.
+ *
+ * @return The number of contiguous bytes that can be written at *ppvWrite.
+ *
+ * \defgroup xStreamBufferGetWritePointer xStreamBufferGetWritePointer
+ * \ingroup StreamBufferManagement
+ */
+size_t xStreamBufferGetWritePointer( xStreamBufferHandle xStreamBuffer, void **ppvWrite ) PRIVILEGED_FUNCTION;
+
+/**
+ * stream_buffer.h
+ * <pre>void vStreamBufferCommitWrite( xStreamBufferHandle xStreamBuffer, size_t xBytesWritten );</pre>
+ *
+ * Makes bytes written through xStreamBufferGetWritePointer() available to the
+ * reader, unblocking the reader if the trigger level has been reached.
+ * vStreamBufferCommitWriteFromISR() is the version for use in an interrupt.
+ *
+ * @param xBytesWritten The number of bytes written, which must not be more
+ * than was returned by xStreamBufferGetWritePointer().
+ *
+ * \defgroup vStreamBufferCommitWrite vStreamBufferCommitWrite
+ * \ingroup StreamBufferManagement
+ */
+void vStreamBufferCommitWrite( xStreamBufferHandle xStreamBuffer, size_t xBytesWritten ) PRIVILEGED_FUNCTION;
+void vStreamBufferCommitWriteFromISR( xStreamBufferHandle xStreamBuffer, size_t xBytesWritten, signed portBASE_TYPE *pxHigherPriorityTaskWoken ) PRIVILEGED_FUNCTION;
+
+/**
+ * stream_buffer.h
+ * <pre>size_t xStreamBufferGetReadPointer( xStreamBufferHandle xStreamBuffer, const void **ppvRead );</pre>
+ *
+ * Gives the reader direct access to the bytes in a stream buffer, so that
+ * they can be used in place, for example by a DMA channel.  Only the part
+ * that is contiguous is returned.  The bytes are released back to the writer
+ * by vStreamBufferConsume().  Does not wait, so can be called from an
+ * interrupt.  Cannot be used with message buffers.
+ *
+ * @param ppvRead Set to the location of the first byte.
+ *
+ * @return The number of contiguous bytes that can be read at *ppvRead.
+ *
+ * \defgroup xStreamBufferGetReadPointer xStreamBufferGetReadPointer
+ * \ingroup StreamBufferManagement
+ */
+size_t xStreamBufferGetReadPointer( xStreamBufferHandle xStreamBuffer, const void **ppvRead ) PRIVILEGED_FUNCTION;
+
+/**
+ * stream_buffer.h
+ * <pre>void vStreamBufferConsume( xStreamBufferHandle xStreamBuffer, size_t xBytesRead );</pre>
+ *
+ * Releases bytes read through xStreamBufferGetReadPointer() back to the
+ * writer, unblocking the writer if it was waiting for space.
+ * vStreamBufferConsumeFromISR() is the version for use in an interrupt.
+ *
+ * @param xBytesRead The number of bytes read, which must not be more than was
+ * returned by xStreamBufferGetReadPointer().
+ *
+ * \defgroup vStreamBufferConsume vStreamBufferConsume
+ * \ingroup StreamBufferManagement
+ */
+void vStreamBufferConsume( xStreamBufferHandle xStreamBuffer, size_t xBytesRead ) PRIVILEGED_FUNCTION;
+void vStreamBufferConsumeFromISR( xStreamBufferHandle xStreamBuffer, size_t xBytesRead, signed portBASE_TYPE *pxHigherPriorityTaskWoken ) PRIVILEGED_FUNCTION;
+
+/**
+ * stream_buffer.h
+ * <pre>size_t xStreamBufferWaitForData( xStreamBufferHandle xStreamBuffer, portTickType xTicksToWait );</pre>
+ *
+ * Waits for data to read in place.  If the buffer is empty the task waits
+ * until the trigger level is reached or xTicksToWait expires.
+ *
+ * @return The number of bytes in the buffer, which may not all be contiguous.
+ *
+ * \defgroup xStreamBufferWaitForData xStreamBufferWaitForData
+ * \ingroup StreamBufferManagement
+ */
+size_t xStreamBufferWaitForData( xStreamBufferHandle xStreamBuffer, portTickType xTicksToWait ) PRIVILEGED_FUNCTION;
+
+/**
+ * stream_buffer.h
+ * <pre>size_t xStreamBufferWaitForSpace( xStreamBufferHandle xStreamBuffer, size_t xSpaceRequired, portTickType xTicksToWait );</pre>
+ *
+ * Waits until at least xSpaceRequired bytes are free, or xTicksToWait
+ * expires.
+ *
+ * @return The number of free bytes, which may not all be contiguous.
+ *
+ * \defgroup xStreamBufferWaitForSpace xStreamBufferWaitForSpace
+ * \ingroup StreamBufferManagement
+ */
+size_t xStreamBufferWaitForSpace( xStreamBufferHandle xStreamBuffer, size_t xSpaceRequired, portTickType xTicksToWait ) PRIVILEGED_FUNCTION;
+
+/**
+ * stream_buffer.h
+ * <pre>size_t xStreamBufferBytesAvailable( xStreamBufferHandle xStreamBuffer );</pre>
+ *
+ * @return The number of bytes that can be read from the buffer.  For a
+ * message buffer this includes the length stored with each message.
+ *
+ * \defgroup xStreamBufferBytesAvailable xStreamBufferBytesAvailable
+ * \ingroup StreamBufferManagement
+ */
+size_t xStreamBufferBytesAvailable( xStreamBufferHandle xStreamBuffer ) PRIVILEGED_FUNCTION;
+
+/**
+ * stream_buffer.h
+ * <pre>size_t xStreamBufferSpacesAvailable( xStreamBufferHandle xStreamBuffer );</pre>
+ *
+ * @return The number of bytes that can be written to the buffer.  For a
+ * message buffer this includes the space needed to store the length of the
+ * next message.
+ *
+ * \defgroup xStreamBufferSpacesAvailable xStreamBufferSpacesAvailable
+ * \ingroup StreamBufferManagement
+ */
+size_t xStreamBufferSpacesAvailable( xStreamBufferHandle xStreamBuffer ) PRIVILEGED_FUNCTION;
+
+/**
+ * stream_buffer.h
+ * <pre>size_t xStreamBufferNextMessageLengthBytes( xStreamBufferHandle xStreamBuffer );</pre>
+ *
+ * @return The length of the next message in a message buffer, or 0 if the
+ * message buffer is empty.
+ *
+ * \defgroup xStreamBufferNextMessageLengthBytes xStreamBufferNextMessageLengthBytes
+ * \ingroup StreamBufferManagement
+ */
+size_t xStreamBufferNextMessageLengthBytes( xStreamBufferHandle xStreamBuffer ) PRIVILEGED_FUNCTION;
+
+/**
+ * stream_buffer.h
+ * <pre>portBASE_TYPE xStreamBufferSetTriggerLevel( xStreamBufferHandle xStreamBuffer, size_t xTriggerLevel );</pre>
+ *
+ * Changes the trigger level of a stream buffer.  A trigger level of 0 is
+ * treated as 1.
+ *
+ * @return pdPASS if the trigger level was changed, or pdFAIL if it was
+ * larger than the buffer.
+ *
+ * \defgroup xStreamBufferSetTriggerLevel xStreamBufferSetTriggerLevel
+ * \ingroup StreamBufferManagement
+ */
+portBASE_TYPE xStreamBufferSetTriggerLevel( xStreamBufferHandle xStreamBuffer, size_t xTriggerLevel ) PRIVILEGED_FUNCTION;
+
+/**
+ * stream_buffer.h
+ * <pre>portBASE_TYPE xStreamBufferReset( xStreamBufferHandle xStreamBuffer );</pre>
+ *
+ * Empties a stream buffer.  A buffer can only be reset while no task is
+ * blocked on it.
+ *
+ * @return pdPASS if the buffer was reset, or pdFAIL if a task was blocked on
+ * it.
+ *
+ * \defgroup xStreamBufferReset xStreamBufferReset
+ * \ingroup StreamBufferManagement
+ */
+portBASE_TYPE xStreamBufferReset( xStreamBufferHandle xStreamBuffer ) PRIVILEGED_FUNCTION;
+
+/**
+ * stream_buffer.h
+ * <pre>portBASE_TYPE xStreamBufferIsEmpty( xStreamBufferHandle xStreamBuffer );</pre>
+ * <pre>portBASE_TYPE xStreamBufferIsFull( xStreamBufferHandle xStreamBuffer );</pre>
+ *
+ * @return pdTRUE if the buffer is empty, or full, respectively.  A message
+ * buffer is full when it does not have room for the length of another
+ * message.
+ *
+ * \defgroup xStreamBufferIsEmpty xStreamBufferIsEmpty
+ * \ingroup StreamBufferManagement
+ */
+portBASE_TYPE xStreamBufferIsEmpty( xStreamBufferHandle xStreamBuffer ) PRIVILEGED_FUNCTION;
+portBASE_TYPE xStreamBufferIsFull( xStreamBufferHandle xStreamBuffer ) PRIVILEGED_FUNCTION;
+
+/**
+ * stream_buffer.h
+ * <pre>void vStreamBufferDelete( xStreamBufferHandle xStreamBuffer );</pre>
+ *
+ * Frees the memory used by a stream buffer.  No task may be blocked on the
+ * buffer when it is deleted.
+ *
+ * \defgroup vStreamBufferDelete vStreamBufferDelete
+ * \ingroup StreamBufferManagement
+ */
+void vStreamBufferDelete( xStreamBufferHandle xStreamBuffer ) PRIVILEGED_FUNCTION;
+
+/*
+ * Functions beyond this part are not part of the public API and are intended
+ * for use by the stream and message buffer macros only.
+ */
+xStreamBufferHandle xStreamBufferGenericCreate( size_t xBufferSizeBytes, size_t xTriggerLevelBytes, portBASE_TYPE xIsMessageBuffer ) PRIVILEGED_FUNCTION;
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* STREAM_BUFFER_H */
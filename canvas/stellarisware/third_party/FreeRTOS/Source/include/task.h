@@ -131,6 +131,28 @@ typedef struct xTASK_PARAMTERS
 	xMemoryRegion xRegions[ portNUM_CONFIGURABLE_REGIONS ];
 } xTaskParameters;
 
+/*
+ * Possible return values for eTaskConfirmSleepModeStatus().
+ */
+typedef enum
+{
+	eAbortSleep = 0,		/* A task has been made ready or a context switch pended since portSUPPRESS_TICKS_AND_SLEEP() was called - abort entering a sleep mode. */
+	eStandardSleep,			/* Enter a sleep mode that will not last any longer than the expected idle time. */
+	eNoTasksWaitingTimeout	/* No tasks are waiting for a timeout so it is safe to enter a sleep mode that can only be exited by an external interrupt. */
+} eSleepModeStatus;
+
+/*
+ * Actions that can be performed when xTaskGenericNotify() is called.
+ */
+typedef enum
+{
+	eNoAction = 0,				/* Notify the task without updating its notify value. */
+	eSetBits,					/* Set bits in the task's notification value. */
+	eIncrement,					/* Increment the task's notification value. */
+	eSetValueWithOverwrite,		/* Set the task's notification value to a specific value even if the previous value has not yet been read by the task. */
+	eSetValueWithoutOverwrite	/* Set the task's notification value if the previous value has been read by the task. */
+} eNotifyAction;
+
 /*
  * Defines the priority used by the idle task.  This must not be modified.
  *
@@ -1188,6 +1210,147 @@ portBASE_TYPE xTaskCallApplicationTaskHook( xTaskHandle xTask, void *pvParameter
  */
 xTaskHandle xTaskGetIdleTaskHandle( void );
 
+/*-----------------------------------------------------------
+ * TASK NOTIFICATIONS
+ *----------------------------------------------------------*/
+
+/*
+ * Each task has a 32-bit notification value, and task notifications are only
+ * available when configUSE_TASK_NOTIFICATIONS is 1 (the default).
+ *
+ * Sending a notification to a task is an event that can unblock the task
+ * directly, without an intermediary object such as a queue, semaphore or
+ * event group.  The notification can update the receiving task's
+ * notification value in one of the ways described by eNotifyAction, so a
+ * notification can be used as a light weight binary or counting semaphore,
+ * an event group, or a mailbox that holds a single 32-bit value.  Giving a
+ * notification copies no data and walks no event list, and the receiving
+ * task is made ready in a single short critical section, which makes it
+ * considerably faster than using a queue or semaphore to do the same.
+ *
+ * A notification can only be sent to a single known task, and only the task
+ * itself can wait for its notification.
+ */
+
+/**
+ * task. h
+ * <PRE>portBASE_TYPE xTaskGenericNotify( xTaskHandle xTaskToNotify, unsigned long ulValue, eNotifyAction eAction, unsigned long *pulPreviousNotificationValue );</pre>
+ *
+ * Sends a notification directly to xTaskToNotify, updating its notification
+ * value according to eAction:
+ *
+ * eSetBits - ulValue is bitwise ORed into the notification value.
+ *
+ * eIncrement - the notification value is incremented and ulValue is unused.
+ *
+ * eSetValueWithOverwrite - the notification value is set to ulValue.
+ *
+ * eSetValueWithoutOverwrite - the notification value is set to ulValue if
+ * the task did not already have a notification pending, otherwise the
+ * function fails and returns pdFAIL.
+ *
+ * eNoAction - the task is notified without its notification value changing.
+ *
+ * If pulPreviousNotificationValue is not NULL it receives the notification
+ * value as it was before it was updated.
+ *
+ * Normally called through the xTaskNotify(), xTaskNotifyAndQuery() or
+ * xTaskNotifyGive() macros.  Must not be called from an interrupt; use
+ * xTaskGenericNotifyFromISR() instead.
+ *
+ * @return pdFAIL if eAction is eSetValueWithoutOverwrite and the value could
+ * not be written, otherwise pdPASS.
+ */
+portBASE_TYPE xTaskGenericNotify( xTaskHandle xTaskToNotify, unsigned long ulValue, eNotifyAction eAction, unsigned long *pulPreviousNotificationValue ) PRIVILEGED_FUNCTION;
+#define xTaskNotify( xTaskToNotify, ulValue, eAction ) xTaskGenericNotify( ( xTaskToNotify ), ( ulValue ), ( eAction ), NULL )
+#define xTaskNotifyAndQuery( xTaskToNotify, ulValue, eAction, pulPreviousNotifyValue ) xTaskGenericNotify( ( xTaskToNotify ), ( ulValue ), ( eAction ), ( pulPreviousNotifyValue ) )
+
+/**
+ * task. h
+ * <PRE>portBASE_TYPE xTaskGenericNotifyFromISR( xTaskHandle xTaskToNotify, unsigned long ulValue, eNotifyAction eAction, unsigned long *pulPreviousNotificationValue, signed portBASE_TYPE *pxHigherPriorityTaskWoken );</pre>
+ *
+ * A version of xTaskGenericNotify() that can be called from an interrupt
+ * service routine.
+ *
+ * *pxHigherPriorityTaskWoken is set to pdTRUE if sending the notification
+ * unblocked a task with a priority higher than that of the interrupted task,
+ * in which case a context switch should be requested before the interrupt
+ * exits.
+ */
+portBASE_TYPE xTaskGenericNotifyFromISR( xTaskHandle xTaskToNotify, unsigned long ulValue, eNotifyAction eAction, unsigned long *pulPreviousNotificationValue, signed portBASE_TYPE *pxHigherPriorityTaskWoken ) PRIVILEGED_FUNCTION;
+#define xTaskNotifyFromISR( xTaskToNotify, ulValue, eAction, pxHigherPriorityTaskWoken ) xTaskGenericNotifyFromISR( ( xTaskToNotify ), ( ulValue ), ( eAction ), NULL, ( pxHigherPriorityTaskWoken ) )
+#define xTaskNotifyAndQueryFromISR( xTaskToNotify, ulValue, eAction, pulPreviousNotificationValue, pxHigherPriorityTaskWoken ) xTaskGenericNotifyFromISR( ( xTaskToNotify ), ( ulValue ), ( eAction ), ( pulPreviousNotificationValue ), ( pxHigherPriorityTaskWoken ) )
+
+/**
+ * task. h
+ * <PRE>portBASE_TYPE xTaskNotifyWait( unsigned long ulBitsToClearOnEntry, unsigned long ulBitsToClearOnExit, unsigned long *pulNotificationValue, portTickType xTicksToWait );</pre>
+ *
+ * Waits, optionally in the Blocked state, for the calling task to receive a
+ * notification.
+ *
+ * Bits set in ulBitsToClearOnEntry are cleared in the notification value
+ * before the task checks for a pending notification, and bits set in
+ * ulBitsToClearOnExit are cleared before the function returns if a
+ * notification was received.  If pulNotificationValue is not NULL it receives
+ * the notification value as it was before the exit bits were cleared.
+ *
+ * xTicksToWait is the longest time to wait for a notification.  If
+ * INCLUDE_vTaskSuspend is 1 then portMAX_DELAY waits indefinitely.
+ *
+ * @return pdTRUE if a notification was received, or was already pending,
+ * otherwise pdFALSE.
+ */
+portBASE_TYPE xTaskNotifyWait( unsigned long ulBitsToClearOnEntry, unsigned long ulBitsToClearOnExit, unsigned long *pulNotificationValue, portTickType xTicksToWait ) PRIVILEGED_FUNCTION;
+
+/**
+ * task. h
+ * <PRE>portBASE_TYPE xTaskNotifyGive( xTaskHandle xTaskToNotify );</PRE>
+ *
+ * Increments the notification value of xTaskToNotify, so that the task can
+ * use it as a counting or binary semaphore in place of xSemaphoreGive().
+ * The receiving task takes the notification with ulTaskNotifyTake().
+ */
+#define xTaskNotifyGive( xTaskToNotify ) xTaskGenericNotify( ( xTaskToNotify ), ( 0 ), eIncrement, NULL )
+
+/**
+ * task. h
+ * <PRE>void vTaskNotifyGiveFromISR( xTaskHandle xTaskToNotify, signed portBASE_TYPE *pxHigherPriorityTaskWoken );</pre>
+ *
+ * A version of xTaskNotifyGive() that can be called from an interrupt
+ * service routine, in place of xSemaphoreGiveFromISR().  It is quicker than
+ * xTaskNotifyFromISR() as it does not have to handle a previous value or an
+ * action that can fail.
+ */
+void vTaskNotifyGiveFromISR( xTaskHandle xTaskToNotify, signed portBASE_TYPE *pxHigherPriorityTaskWoken ) PRIVILEGED_FUNCTION;
+
+/**
+ * task. h
+ * <PRE>unsigned long ulTaskNotifyTake( portBASE_TYPE xClearCountOnExit, portTickType xTicksToWait );</pre>
+ *
+ * Waits, optionally in the Blocked state, for the calling task's notification
+ * value to be non-zero, in place of xSemaphoreTake().
+ *
+ * If xClearCountOnExit is pdFALSE the notification value is decremented
+ * before the function returns, so it behaves as a counting semaphore.
+ * Otherwise it is cleared to zero, so it behaves as a binary semaphore.
+ *
+ * @return The notification value before it was decremented or cleared, which
+ * is zero if the wait timed out.
+ */
+unsigned long ulTaskNotifyTake( portBASE_TYPE xClearCountOnExit, portTickType xTicksToWait ) PRIVILEGED_FUNCTION;
+
+/**
+ * task. h
+ * <PRE>portBASE_TYPE xTaskNotifyStateClear( xTaskHandle xTask );</pre>
+ *
+ * Clears a notification that is pending for xTask, without changing its
+ * notification value.  Passing xTask as NULL clears the calling task's
+ * notification state.
+ *
+ * @return pdTRUE if a notification was pending, otherwise pdFALSE.
+ */
+portBASE_TYPE xTaskNotifyStateClear( xTaskHandle xTask ) PRIVILEGED_FUNCTION;
+
 /*-----------------------------------------------------------
  * SCHEDULER INTERNALS AVAILABLE FOR PORTING PURPOSES
  *----------------------------------------------------------*/
@@ -1204,6 +1367,37 @@ xTaskHandle xTaskGetIdleTaskHandle( void );
  */
 void vTaskIncrementTick( void ) PRIVILEGED_FUNCTION;
 
+/*
+ * THIS FUNCTION MUST NOT BE USED FROM APPLICATION CODE.  IT IS ONLY
+ * INTENDED FOR USE WHEN IMPLEMENTING A PORT OF THE SCHEDULER AND IS
+ * AN INTERFACE WHICH IS FOR THE EXCLUSIVE USE OF THE SCHEDULER.
+ *
+ * Only available when configUSE_TICKLESS_IDLE is set to 1.
+ * Called from portSUPPRESS_TICKS_AND_SLEEP() once the processor wakes, with
+ * the scheduler suspended, to add the number of whole tick periods that
+ * passed while the tick interrupt was stopped to the tick count.  The
+ * result must not pass the time at which the next task is due to unblock,
+ * so a port steps the tick to one short of that time and lets the tick
+ * interrupt perform the final increment.
+ */
+void vTaskStepTick( portTickType xTicksToJump ) PRIVILEGED_FUNCTION;
+
+/*
+ * THIS FUNCTION MUST NOT BE USED FROM APPLICATION CODE.  IT IS ONLY
+ * INTENDED FOR USE WHEN IMPLEMENTING A PORT OF THE SCHEDULER AND IS
+ * AN INTERFACE WHICH IS FOR THE EXCLUSIVE USE OF THE SCHEDULER.
+ *
+ * Only available when configUSE_TICKLESS_IDLE is set to 1.
+ * Called from portSUPPRESS_TICKS_AND_SLEEP() with interrupts disabled, just
+ * before the processor is put to sleep, to check that nothing has become
+ * ready to run since the expected idle time was calculated.
+ *
+ * @return eAbortSleep if the sleep must not be entered, eNoTasksWaitingTimeout
+ * if every task other than the idle task is suspended indefinitely, otherwise
+ * eStandardSleep.
+ */
+eSleepModeStatus eTaskConfirmSleepModeStatus( void ) PRIVILEGED_FUNCTION;
+
 /*
  * THIS FUNCTION MUST NOT BE USED FROM APPLICATION CODE.  IT IS AN
  * INTERFACE WHICH IS FOR THE EXCLUSIVE USE OF THE SCHEDULER.
@@ -195,6 +195,10 @@ portBASE_TYPE MPU_xTaskCallApplicationTaskHook( xTaskHandle xTask, void *pvParam
 unsigned portBASE_TYPE MPU_uxTaskGetStackHighWaterMark( xTaskHandle xTask );
 xTaskHandle MPU_xTaskGetCurrentTaskHandle( void );
 portBASE_TYPE MPU_xTaskGetSchedulerState( void );
+portBASE_TYPE MPU_xTaskGenericNotify( xTaskHandle xTaskToNotify, unsigned long ulValue, eNotifyAction eAction, unsigned long *pulPreviousNotificationValue );
+portBASE_TYPE MPU_xTaskNotifyWait( unsigned long ulBitsToClearOnEntry, unsigned long ulBitsToClearOnExit, unsigned long *pulNotificationValue, portTickType xTicksToWait );
+unsigned long MPU_ulTaskNotifyTake( portBASE_TYPE xClearCountOnExit, portTickType xTicksToWait );
+portBASE_TYPE MPU_xTaskNotifyStateClear( xTaskHandle xTask );
 xQueueHandle MPU_xQueueGenericCreate( unsigned portBASE_TYPE uxQueueLength, unsigned portBASE_TYPE uxItemSize, unsigned char ucQueueType );
 signed portBASE_TYPE MPU_xQueueGenericSend( xQueueHandle xQueue, const void * const pvItemToQueue, portTickType xTicksToWait, portBASE_TYPE xCopyPosition );
 unsigned portBASE_TYPE MPU_uxQueueMessagesWaiting( const xQueueHandle pxQueue );
@@ -933,6 +937,52 @@ portBASE_TYPE xRunningPrivileged = prvRaisePrivilege();
 #endif
 /*-----------------------------------------------------------*/
 
+#if ( configUSE_TASK_NOTIFICATIONS == 1 )
+	portBASE_TYPE MPU_xTaskGenericNotify( xTaskHandle xTaskToNotify, unsigned long ulValue, eNotifyAction eAction, unsigned long *pulPreviousNotificationValue )
+	{
+	portBASE_TYPE xReturn;
+	portBASE_TYPE xRunningPrivileged = prvRaisePrivilege();
+
+		xReturn = xTaskGenericNotify( xTaskToNotify, ulValue, eAction, pulPreviousNotificationValue );
+		portRESET_PRIVILEGE( xRunningPrivileged );
+		return xReturn;
+	}
+	/*-----------------------------------------------------------*/
+
+	portBASE_TYPE MPU_xTaskNotifyWait( unsigned long ulBitsToClearOnEntry, unsigned long ulBitsToClearOnExit, unsigned long *pulNotificationValue, portTickType xTicksToWait )
+	{
+	portBASE_TYPE xReturn;
+	portBASE_TYPE xRunningPrivileged = prvRaisePrivilege();
+
+		xReturn = xTaskNotifyWait( ulBitsToClearOnEntry, ulBitsToClearOnExit, pulNotificationValue, xTicksToWait );
+		portRESET_PRIVILEGE( xRunningPrivileged );
+		return xReturn;
+	}
+	/*-----------------------------------------------------------*/
+
+	unsigned long MPU_ulTaskNotifyTake( portBASE_TYPE xClearCountOnExit, portTickType xTicksToWait )
+	{
+	unsigned long ulReturn;
+	portBASE_TYPE xRunningPrivileged = prvRaisePrivilege();
+
+		ulReturn = ulTaskNotifyTake( xClearCountOnExit, xTicksToWait );
+		portRESET_PRIVILEGE( xRunningPrivileged );
+		return ulReturn;
+	}
+	/*-----------------------------------------------------------*/
+
+	portBASE_TYPE MPU_xTaskNotifyStateClear( xTaskHandle xTask )
+	{
+	portBASE_TYPE xReturn;
+	portBASE_TYPE xRunningPrivileged = prvRaisePrivilege();
+
+		xReturn = xTaskNotifyStateClear( xTask );
+		portRESET_PRIVILEGE( xRunningPrivileged );
+		return xReturn;
+	}
+#endif
+/*-----------------------------------------------------------*/
+
 xQueueHandle MPU_xQueueGenericCreate( unsigned portBASE_TYPE uxQueueLength, unsigned portBASE_TYPE uxItemSize, unsigned char ucQueueType )
 {
 xQueueHandle xReturn;
@@ -79,11 +79,13 @@
 /* Constants required to manipulate the NVIC. */
 #define portNVIC_SYSTICK_CTRL		( ( volatile unsigned long * ) 0xe000e010 )
 #define portNVIC_SYSTICK_LOAD		( ( volatile unsigned long * ) 0xe000e014 )
+#define portNVIC_SYSTICK_CURRENT_VALUE	( ( volatile unsigned long * ) 0xe000e018 )
 #define portNVIC_INT_CTRL			( ( volatile unsigned long * ) 0xe000ed04 )
 #define portNVIC_SYSPRI2			( ( volatile unsigned long * ) 0xe000ed20 )
 #define portNVIC_SYSTICK_CLK		0x00000004
 #define portNVIC_SYSTICK_INT		0x00000002
 #define portNVIC_SYSTICK_ENABLE		0x00000001
+#define portNVIC_SYSTICK_COUNT_FLAG	0x00010000
 #define portNVIC_PENDSVSET			0x10000000
 #define portNVIC_PENDSV_PRI			( ( ( unsigned long ) configKERNEL_INTERRUPT_PRIORITY ) << 16 )
 #define portNVIC_SYSTICK_PRI		( ( ( unsigned long ) configKERNEL_INTERRUPT_PRIORITY ) << 24 )
@@ -92,6 +94,12 @@
 #define portFPCCR					( ( volatile unsigned long * ) 0xe000ef34 ) /* Floating point context control register. */
 #define portASPEN_AND_LSPEN_BITS	( 0x3UL << 30UL )
 
+/* Constants used by the tickless idle implementation.  The SysTick counter is
+24 bits wide.  The compensation is an estimate of the number of SysTick counts
+that pass while the counter is stopped and its new value worked out. */
+#define portMAX_24_BIT_NUMBER		( 0xffffffUL )
+#define portMISSED_COUNTS_FACTOR	( 45UL )
+
 /* Constants required to set up the initial stack. */
 #define portINITIAL_XPSR			( 0x01000000 )
 #define portINITIAL_EXEC_RETURN		( 0xfffffffd )
@@ -104,6 +112,15 @@ const unsigned long ulKernelPriority = configKERNEL_INTERRUPT_PRIORITY;
 variable. */
 static unsigned portBASE_TYPE uxCriticalNesting = 0xaaaaaaaa;
 
+/* The number of SysTick counts that make up one tick period, the largest
+number of tick periods that will fit in the 24 bit counter, and the number of
+counts lost each time the counter is stopped and restarted. */
+#if configUSE_TICKLESS_IDLE == 1
+	static unsigned long ulTimerCountsForOneTick = 0;
+	static unsigned long xMaximumPossibleSuppressedTicks = 0;
+	static unsigned long ulStoppedTimerCompensation = 0;
+#endif
+
 /*
  * Setup the timer to generate the tick interrupts.
  */
@@ -126,6 +143,15 @@ static void vPortStartFirstTask( void ) __attribute__ (( naked ));
  */
  static void vPortEnableVFP( void ) __attribute__ (( naked ));
 
+/*
+ * Stops the tick interrupt and sleeps until the next task is due to unblock.
+ * The definition is weak so that an application can provide its own, for
+ * example one that uses a deeper sleep mode clocked from a low power timer.
+ */
+#if configUSE_TICKLESS_IDLE == 1
+	void vPortSuppressTicksAndSleep( portTickType xExpectedIdleTime ) __attribute__ (( weak ));
+#endif
+
 
 /*-----------------------------------------------------------*/
 
@@ -324,12 +350,173 @@ unsigned long ulDummy;
  */
 void prvSetupTimerInterrupt( void )
 {
+	/* Calculate the constants required to configure the tick interrupt. */
+	#if configUSE_TICKLESS_IDLE == 1
+	{
+		ulTimerCountsForOneTick = ( configCPU_CLOCK_HZ / configTICK_RATE_HZ );
+		xMaximumPossibleSuppressedTicks = portMAX_24_BIT_NUMBER / ulTimerCountsForOneTick;
+		ulStoppedTimerCompensation = portMISSED_COUNTS_FACTOR;
+	}
+	#endif
+
 	/* Configure SysTick to interrupt at the requested rate. */
 	*(portNVIC_SYSTICK_LOAD) = ( configCPU_CLOCK_HZ / configTICK_RATE_HZ ) - 1UL;
 	*(portNVIC_SYSTICK_CTRL) = portNVIC_SYSTICK_CLK | portNVIC_SYSTICK_INT | portNVIC_SYSTICK_ENABLE;
 }
 /*-----------------------------------------------------------*/
 
+#if configUSE_TICKLESS_IDLE == 1
+
+	void vPortSuppressTicksAndSleep( portTickType xExpectedIdleTime )
+	{
+	unsigned long ulReloadValue, ulCompleteTickPeriods, ulCompletedSysTickDecrements, ulSysTickCTRL;
+	portTickType xModifiableIdleTime;
+
+		/* Called from the idle task with the scheduler suspended.  Make sure
+		the SysTick reload value does not overflow the counter. */
+		if( xExpectedIdleTime > xMaximumPossibleSuppressedTicks )
+		{
+			xExpectedIdleTime = xMaximumPossibleSuppressedTicks;
+		}
+
+		/* Stop the SysTick momentarily.  The time the SysTick is stopped for
+		is accounted for as best it can be, but using the tickless mode will
+		inevitably result in some tiny drift of the time maintained by the
+		kernel with respect to calendar time. */
+		*(portNVIC_SYSTICK_CTRL) &= ~portNVIC_SYSTICK_ENABLE;
+
+		/* Calculate the reload value required to wait xExpectedIdleTime
+		tick periods.  -1 is used because this code will execute part way
+		through one of the tick periods.  The counts left in the current
+		period are kept, so the tick stays aligned with its original
+		schedule to within a fraction of a tick. */
+		ulReloadValue = *(portNVIC_SYSTICK_CURRENT_VALUE) + ( ulTimerCountsForOneTick * ( xExpectedIdleTime - 1UL ) );
+		if( ulReloadValue > ulStoppedTimerCompensation )
+		{
+			ulReloadValue -= ulStoppedTimerCompensation;
+		}
+
+		/* Enter a critical section but don't use the taskENTER_CRITICAL()
+		method as that will mask interrupts that should exit sleep mode. */
+		__asm volatile( "cpsid i" );
+
+		/* If a context switch is pending or a task is waiting for the
+		scheduler to be unsuspended then abandon the low power entry. */
+		if( eTaskConfirmSleepModeStatus() == eAbortSleep )
+		{
+			/* Restart the SysTick from the count it was stopped at, then
+			put back the standard reload value for the periods after it. */
+			*(portNVIC_SYSTICK_LOAD) = *(portNVIC_SYSTICK_CURRENT_VALUE);
+			*(portNVIC_SYSTICK_CTRL) |= portNVIC_SYSTICK_ENABLE;
+			*(portNVIC_SYSTICK_LOAD) = ulTimerCountsForOneTick - 1UL;
+
+			/* Re-enable interrupts - see comments above the cpsid
+			instruction above. */
+			__asm volatile( "cpsie i" );
+		}
+		else
+		{
+			/* Set the new reload value. */
+			*(portNVIC_SYSTICK_LOAD) = ulReloadValue;
+
+			/* Clear the SysTick count flag and set the count value back to
+			zero. */
+			*(portNVIC_SYSTICK_CURRENT_VALUE) = 0UL;
+
+			/* Restart SysTick. */
+			*(portNVIC_SYSTICK_CTRL) |= portNVIC_SYSTICK_ENABLE;
+
+			/* Sleep until something happens.  configPRE_SLEEP_PROCESSING()
+			can set its parameter to 0 to indicate that its implementation
+			contains its own wait for interrupt or wait for event
+			instruction, and so wfi should not be executed again.  However,
+			the original expected idle time variable must remain unmodified,
+			so a copy is taken. */
+			xModifiableIdleTime = xExpectedIdleTime;
+			configPRE_SLEEP_PROCESSING( xModifiableIdleTime );
+			if( xModifiableIdleTime > 0 )
+			{
+				__asm volatile( "dsb" );
+				__asm volatile( "wfi" );
+				__asm volatile( "isb" );
+			}
+			configPOST_SLEEP_PROCESSING( xExpectedIdleTime );
+
+			/* Stop SysTick.  Again, the time the SysTick is stopped for is
+			accounted for as best it can be, but using the tickless mode
+			will inevitably result in some tiny drift of the time
+			maintained by the kernel with respect to calendar time.  Reading
+			the control register also clears the count flag. */
+			ulSysTickCTRL = *(portNVIC_SYSTICK_CTRL);
+			*(portNVIC_SYSTICK_CTRL) = ( ulSysTickCTRL & ~portNVIC_SYSTICK_ENABLE );
+
+			/* Re-enable interrupts so that the interrupt that brought the
+			processor out of sleep, if any, is serviced now. */
+			__asm volatile( "cpsie i" );
+
+			if( ( ulSysTickCTRL & portNVIC_SYSTICK_COUNT_FLAG ) != 0 )
+			{
+			unsigned long ulCalculatedLoadValue;
+
+				/* The tick interrupt has already executed, and the SysTick
+				count reloaded with ulReloadValue.  Reset the reload value
+				with whatever remains of this tick period. */
+				ulCalculatedLoadValue = ( ulTimerCountsForOneTick - 1UL ) - ( ulReloadValue - *(portNVIC_SYSTICK_CURRENT_VALUE) );
+
+				/* Don't allow a tiny value, or values that have somehow
+				underflowed because the post sleep hook did something that
+				took too long. */
+				if( ( ulCalculatedLoadValue < ulStoppedTimerCompensation ) || ( ulCalculatedLoadValue > ulTimerCountsForOneTick ) )
+				{
+					ulCalculatedLoadValue = ( ulTimerCountsForOneTick - 1UL );
+				}
+
+				*(portNVIC_SYSTICK_LOAD) = ulCalculatedLoadValue;
+
+				/* The tick interrupt handler will already have pended the
+				tick processing in the kernel.  As the pending tick will be
+				processed as soon as this function exits, the tick value
+				maintained by the tick is stepped forward by one less than
+				the time spent waiting. */
+				ulCompleteTickPeriods = xExpectedIdleTime - 1UL;
+			}
+			else
+			{
+				/* Something other than the tick interrupt ended the sleep.
+				Work out how long the sleep lasted - rounded down to the
+				nearest whole tick period - and reload the SysTick with the
+				part of the current tick period that remains, so the next
+				tick interrupt arrives on time. */
+				ulCompletedSysTickDecrements = ( xExpectedIdleTime * ulTimerCountsForOneTick ) - *(portNVIC_SYSTICK_CURRENT_VALUE);
+
+				/* How many complete tick periods passed while the processor
+				was waiting? */
+				ulCompleteTickPeriods = ulCompletedSysTickDecrements / ulTimerCountsForOneTick;
+
+				/* The reload value is set to whatever fraction of a single
+				tick period remains. */
+				*(portNVIC_SYSTICK_LOAD) = ( ( ulCompleteTickPeriods + 1UL ) * ulTimerCountsForOneTick ) - ulCompletedSysTickDecrements;
+			}
+
+			/* Restart SysTick so it runs from portNVIC_SYSTICK_LOAD again,
+			then set portNVIC_SYSTICK_LOAD back to its standard value.  The
+			critical section is used to ensure the tick interrupt can only
+			execute once in the case that the reload register is near
+			zero. */
+			*(portNVIC_SYSTICK_CURRENT_VALUE) = 0UL;
+			portENTER_CRITICAL();
+			{
+				*(portNVIC_SYSTICK_CTRL) |= portNVIC_SYSTICK_ENABLE;
+				vTaskStepTick( ulCompleteTickPeriods );
+				*(portNVIC_SYSTICK_LOAD) = ulTimerCountsForOneTick - 1UL;
+			}
+			portEXIT_CRITICAL();
+		}
+	}
+
+#endif /* configUSE_TICKLESS_IDLE */
+/*-----------------------------------------------------------*/
+
 /* This is a naked function. */
 static void vPortEnableVFP( void )
 {
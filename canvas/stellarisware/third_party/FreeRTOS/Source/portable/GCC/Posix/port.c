@@ -0,0 +1,950 @@
+/*
+    FreeRTOS V7.1.1 - POSIX/Linux simulator port.
+
+    This port runs each FreeRTOS task as a POSIX thread, of which exactly one
+    is allowed to run at any time.  The tick interrupt is simulated with
+    SIGALRM, and the interrupt mask with the thread signal mask.
+
+    1 tab == 4 spaces!
+*/
+
+/*-----------------------------------------------------------
+ * Implementation of functions defined in portable.h for the POSIX simulator
+ * port.
+ *
+ * Every task is given a host thread and a semaphore.  A context switch posts
+ * the semaphore of the task selected by vTaskSwitchContext() and then waits
+ * on the semaphore of the task being switched out, so only the thread of
+ * pxCurrentTCB is ever running FreeRTOS code.
+ *
+ * The tick signal is blocked in every thread except the running one, and is
+ * also blocked while the running task has interrupts disabled, so the tick
+ * handler always runs in the context of the current task exactly as the
+ * SysTick handler does on the target.  A yield requested while interrupts are
+ * disabled is held pending until they are enabled again, in the same way that
+ * PendSV is on the Cortex-M ports.
+ *
+ * When configPOSIX_VIRTUAL_TIME is 1 the tick is generated by a helper
+ * thread rather than by an interval timer, which lets the port skip ahead
+ * whenever the idle task is left running with nothing else to do.
+ *
+ * When configPOSIX_STEPPED_TIME is 1 there is no tick source at all.  A host
+ * thread which is not running a task calls vPortSimulatorStepTicks() to take
+ * ticks one at a time, each of which is raised only once every task has run
+ * until it blocks and the idle task has been switched in, so a test sees the
+ * same interleaving of its tasks on every run whatever the host is doing.
+ *
+ * When configUSE_TICKLESS_IDLE is 1 the idle task stops the interval timer
+ * and sleeps on the host clock until the next task is due, as the Cortex-M
+ * ports do with SysTick, and the counters returned by vPortGetSleepStats()
+ * show how many tick interrupts were avoided and how late each wake was.
+ *
+ * Host library calls which take internal locks, such as printf(), can
+ * deadlock if the calling task is preempted while holding the lock.  Such
+ * calls should be made inside a critical section.
+ *----------------------------------------------------------*/
+
+/* Standard includes. */
+#include <errno.h>
+#include <pthread.h>
+#include <semaphore.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+#include <time.h>
+#include <unistd.h>
+
+/* Scheduler includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+#if ( configPOSIX_VIRTUAL_TIME == 1 ) && ( INCLUDE_xTaskGetIdleTaskHandle != 1 )
+	#error configPOSIX_VIRTUAL_TIME requires INCLUDE_xTaskGetIdleTaskHandle to be set to 1.
+#endif
+
+#if ( configPOSIX_VIRTUAL_TIME == 1 ) && ( configUSE_TICKLESS_IDLE == 1 ) && ( INCLUDE_xTaskGetSchedulerState != 1 ) && ( configUSE_TIMERS != 1 )
+	#error configPOSIX_VIRTUAL_TIME with configUSE_TICKLESS_IDLE requires INCLUDE_xTaskGetSchedulerState to be set to 1.
+#endif
+
+#if ( configPOSIX_STEPPED_TIME == 1 ) && ( ( configPOSIX_VIRTUAL_TIME == 1 ) || ( configUSE_TICKLESS_IDLE == 1 ) )
+	#error configPOSIX_STEPPED_TIME cannot be combined with configPOSIX_VIRTUAL_TIME or configUSE_TICKLESS_IDLE.
+#endif
+
+#if ( configPOSIX_STEPPED_TIME == 1 ) && ( INCLUDE_xTaskGetIdleTaskHandle != 1 )
+	#error configPOSIX_STEPPED_TIME requires INCLUDE_xTaskGetIdleTaskHandle to be set to 1.
+#endif
+
+/* The signal used to simulate the tick interrupt. */
+#define portTICK_SIGNAL				SIGALRM
+
+/* The state kept for the host thread of each task.  This is placed at the top
+of the stack allocated for the task by the kernel, and the address of it is
+stored as the task's top of stack so that it can be found from the TCB. */
+typedef struct xTHREAD_STATE
+{
+	pthread_t xThread;
+	sem_t xWake;
+	pdTASK_CODE pxCode;
+	void *pvParameters;
+	volatile portBASE_TYPE xExit;
+} xThreadState;
+
+/* The first member of the TCB is the task's top of stack. */
+#define prvThreadFromTCB( pxTCB )	( *( xThreadState ** ) ( pxTCB ) )
+
+extern void * volatile pxCurrentTCB;
+
+/* The nesting depth of critical sections, which can only be non-zero while
+interrupts are disabled. */
+static volatile unsigned portBASE_TYPE uxCriticalNesting = 0;
+
+/* Set while the running task has interrupts disabled. */
+static volatile portBASE_TYPE xInterruptsDisabled = pdFALSE;
+
+/* Set when a yield has been requested while interrupts were disabled. */
+static volatile portBASE_TYPE xYieldPending = pdFALSE;
+
+/* Set while the scheduler is running. */
+static volatile portBASE_TYPE xSchedulerStarted = pdFALSE;
+
+/* Posted by vPortEndScheduler() to return control to xPortStartScheduler(). */
+static sem_t xSchedulerEnd;
+
+/* The set containing only the tick signal. */
+static sigset_t xTickSignalSet;
+static pthread_once_t xTickSignalSetOnce = PTHREAD_ONCE_INIT;
+
+/* The tick and sleep counters returned by vPortGetSleepStats(). */
+static xPortSleepStats xSleepStats;
+
+#if ( configPOSIX_VIRTUAL_TIME == 1 )
+
+	/* Posted each time a tick has been taken, to request the next one. */
+	static sem_t xTickRequest;
+
+	/* Posted when the idle task is switched in, to deliver the requested tick
+	without waiting for the rest of the tick period. */
+	static sem_t xTickHurry;
+
+	static pthread_t xTickThread;
+
+#endif
+
+#if ( configPOSIX_STEPPED_TIME == 1 )
+
+	/* Posted each time the idle task is switched in, or is left running by a
+	tick, at which point every other task is blocked. */
+	static sem_t xSettled;
+	static pthread_once_t xSettledOnce = PTHREAD_ONCE_INIT;
+
+	/* Set once the tasks have settled after the scheduler was started. */
+	static portBASE_TYPE xFirstSettled = pdFALSE;
+
+	/* Set by vPortSimulatorEndScheduler() to have the next tick end the
+	scheduler. */
+	static volatile portBASE_TYPE xEndRequested = pdFALSE;
+
+#endif
+
+/*
+ * Initialises xTickSignalSet.
+ */
+static void prvInitTickSignalSet( void );
+
+/*
+ * The entry point of the host thread of every task.
+ */
+static void *prvThreadEntry( void *pvParameters );
+
+/*
+ * Waits until the thread is selected to run again.
+ */
+static void prvSuspendSelf( xThreadState *pxThread );
+
+/*
+ * Selects the next task and switches to its thread.  Must be called with
+ * interrupts disabled.  Returns pdTRUE if the calling thread was switched out
+ * and has since been switched back in.
+ */
+static portBASE_TYPE prvSwitchContext( void );
+
+/*
+ * The simulated tick interrupt handler.
+ */
+static void prvTickSignalHandler( int iSignal );
+
+#if ( configPOSIX_VIRTUAL_TIME == 1 )
+
+	/*
+	 * Generates a tick each time one is requested.
+	 */
+	static void *prvVirtualTickThread( void *pvParameters );
+
+	/*
+	 * Delivers the requested tick at once if the idle task is running.
+	 */
+	static void prvHurryVirtualTick( void );
+
+#endif
+
+#if ( configPOSIX_STEPPED_TIME == 1 )
+
+	/*
+	 * Initialises xSettled.
+	 */
+	static void prvInitSettled( void );
+
+	/*
+	 * Prepares the calling host thread to step the tick and waits for the
+	 * tasks to settle after the scheduler is started.
+	 */
+	static void prvStepperInit( void );
+
+	/*
+	 * Waits until the idle task next settles.
+	 */
+	static void prvWaitSettled( void );
+
+#endif
+
+#if ( configUSE_TICKLESS_IDLE == 1 ) && ( configPOSIX_VIRTUAL_TIME == 0 )
+
+	/*
+	 * Conversions between the host time formats and nanoseconds.
+	 */
+	static unsigned long long prvTimespecToNs( const struct timespec *pxTime );
+	static unsigned long long prvTimevalToNs( const struct timeval *pxTime );
+	static void prvNsToTimeval( unsigned long long ullNs, struct timeval *pxTime );
+
+#endif
+
+/*-----------------------------------------------------------*/
+
+static void prvInitTickSignalSet( void )
+{
+	sigemptyset( &xTickSignalSet );
+	sigaddset( &xTickSignalSet, portTICK_SIGNAL );
+}
+/*-----------------------------------------------------------*/
+
+/*
+ * See header file for description.
+ */
+portSTACK_TYPE *pxPortInitialiseStack( portSTACK_TYPE *pxTopOfStack, pdTASK_CODE pxCode, void *pvParameters )
+{
+xThreadState *pxThread;
+sigset_t xOldMask;
+
+	pthread_once( &xTickSignalSetOnce, prvInitTickSignalSet );
+
+	/* Place the thread state at the top of the task's stack, aligned for any
+	host type. */
+	pxThread = ( xThreadState * ) ( ( ( unsigned long ) ( pxTopOfStack + 1 ) - sizeof( xThreadState ) ) & ~( ( unsigned long ) 15 ) );
+	pxThread->pxCode = pxCode;
+	pxThread->pvParameters = pvParameters;
+	pxThread->xExit = pdFALSE;
+	sem_init( &pxThread->xWake, 0, 0 );
+
+	/* Keep the tick out while the C library creates the thread.  The new
+	thread inherits this mask, so it cannot take a tick until it first
+	runs. */
+	pthread_sigmask( SIG_BLOCK, &xTickSignalSet, &xOldMask );
+	if( pthread_create( &pxThread->xThread, NULL, prvThreadEntry, pxThread ) != 0 )
+	{
+		perror( "pxPortInitialiseStack: pthread_create" );
+		abort();
+	}
+	pthread_sigmask( SIG_SETMASK, &xOldMask, NULL );
+
+	return ( portSTACK_TYPE * ) pxThread;
+}
+/*-----------------------------------------------------------*/
+
+static void *prvThreadEntry( void *pvParameters )
+{
+xThreadState *pxThread = ( xThreadState * ) pvParameters;
+
+	/* Wait to be scheduled for the first time. */
+	prvSuspendSelf( pxThread );
+
+	/* A task starts with interrupts enabled. */
+	uxCriticalNesting = 0;
+	xInterruptsDisabled = pdFALSE;
+	pthread_sigmask( SIG_UNBLOCK, &xTickSignalSet, NULL );
+
+	pxThread->pxCode( pxThread->pvParameters );
+
+	/* Tasks must not return from their implementing function. */
+	#if ( INCLUDE_vTaskDelete == 1 )
+	{
+		vTaskDelete( NULL );
+	}
+	#endif
+
+	fprintf( stderr, "A task returned from its implementing function.\n" );
+	abort();
+
+	return NULL;
+}
+/*-----------------------------------------------------------*/
+
+static void prvSuspendSelf( xThreadState *pxThread )
+{
+	while( sem_wait( &pxThread->xWake ) != 0 )
+	{
+		/* Interrupted before the semaphore was posted. */
+	}
+
+	/* The thread is woken with xExit set when its task has been deleted. */
+	if( pxThread->xExit != pdFALSE )
+	{
+		pthread_exit( NULL );
+	}
+}
+/*-----------------------------------------------------------*/
+
+static portBASE_TYPE prvSwitchContext( void )
+{
+xThreadState *pxFrom, *pxTo;
+
+	pxFrom = prvThreadFromTCB( pxCurrentTCB );
+
+	xYieldPending = pdFALSE;
+	vTaskSwitchContext();
+
+	pxTo = prvThreadFromTCB( pxCurrentTCB );
+
+	if( pxTo == pxFrom )
+	{
+		return pdFALSE;
+	}
+
+	#if ( configPOSIX_STEPPED_TIME == 1 )
+	{
+		/* The idle task is only selected once every other task is blocked,
+		so a thread stepping the tick may raise the next one. */
+		if( ( xTaskHandle ) pxCurrentTCB == xTaskGetIdleTaskHandle() )
+		{
+			sem_post( &xSettled );
+		}
+	}
+	#endif
+
+	/* Start the selected thread, then wait to be selected again.  The two
+	threads overlap only while this thread goes to sleep, during which it
+	touches nothing but its own state. */
+	sem_post( &pxTo->xWake );
+	prvSuspendSelf( pxFrom );
+
+	return pdTRUE;
+}
+/*-----------------------------------------------------------*/
+
+static void prvTickSignalHandler( int iSignal )
+{
+int iSavedErrno;
+portBASE_TYPE xSwitched = pdFALSE;
+
+	( void ) iSignal;
+
+	iSavedErrno = errno;
+
+	/* The tick signal is blocked by the kernel while this handler runs, so
+	interrupts are already disabled. */
+	xInterruptsDisabled = pdTRUE;
+
+	#if ( configPOSIX_STEPPED_TIME == 1 )
+	{
+		/* The thread stepping the tick has finished with the scheduler.  This
+		does not return. */
+		if( xEndRequested != pdFALSE )
+		{
+			vTaskEndScheduler();
+		}
+	}
+	#endif
+
+	xSleepStats.ulTickInterrupts++;
+	vTaskIncrementTick();
+
+	#if ( configPOSIX_VIRTUAL_TIME == 1 )
+	{
+		/* Request the next tick before this thread can be switched out. */
+		sem_post( &xTickRequest );
+	}
+	#endif
+
+	/* If using preemption, also force a context switch. */
+	#if configUSE_PREEMPTION == 1
+		xYieldPending = pdTRUE;
+	#endif
+
+	if( xYieldPending != pdFALSE )
+	{
+		xSwitched = prvSwitchContext();
+	}
+
+	#if ( configPOSIX_VIRTUAL_TIME == 1 )
+	{
+		/* The idle task has been left running for a whole tick period, so
+		nothing else is ready to run.  Hurrying the tick as soon as the idle
+		task is switched in would preempt it before it could free the memory
+		of deleted tasks. */
+		if( xSwitched == pdFALSE )
+		{
+			prvHurryVirtualTick();
+		}
+	}
+	#elif ( configPOSIX_STEPPED_TIME == 1 )
+	{
+		/* If the tick left the idle task running then nothing was unblocked
+		by it, and the tick has been completely processed.  Otherwise the
+		thread that switched back to the idle task has already said so. */
+		if( ( xSwitched == pdFALSE ) && ( ( xTaskHandle ) pxCurrentTCB == xTaskGetIdleTaskHandle() ) )
+		{
+			sem_post( &xSettled );
+		}
+	}
+	#else
+	{
+		( void ) xSwitched;
+	}
+	#endif
+
+	xInterruptsDisabled = pdFALSE;
+	errno = iSavedErrno;
+}
+/*-----------------------------------------------------------*/
+
+#if ( configPOSIX_VIRTUAL_TIME == 1 )
+
+	static void prvHurryVirtualTick( void )
+	{
+		/* A tickless idle task holds the scheduler suspended around its
+		sleep.  Ticks taken then are only counted once the scheduler is
+		resumed, so hurrying them would starve the idle task of the host
+		time it needs to resume the scheduler. */
+		#if ( configUSE_TICKLESS_IDLE == 1 )
+		{
+			if( xTaskGetSchedulerState() == taskSCHEDULER_SUSPENDED )
+			{
+				return;
+			}
+		}
+		#endif
+
+		if( ( xTaskHandle ) pxCurrentTCB == xTaskGetIdleTaskHandle() )
+		{
+			sem_post( &xTickHurry );
+		}
+	}
+	/*-----------------------------------------------------------*/
+
+	static void *prvVirtualTickThread( void *pvParameters )
+	{
+	struct timespec xDeadline;
+
+		( void ) pvParameters;
+
+		for( ;; )
+		{
+			while( sem_wait( &xTickRequest ) != 0 )
+			{
+				/* Interrupted before the semaphore was posted. */
+			}
+
+			/* Wait for one tick period of host time, or until the idle task
+			runs, whichever comes first. */
+			clock_gettime( CLOCK_REALTIME, &xDeadline );
+			xDeadline.tv_nsec += 1000000000L / configTICK_RATE_HZ;
+			if( xDeadline.tv_nsec >= 1000000000L )
+			{
+				xDeadline.tv_sec++;
+				xDeadline.tv_nsec -= 1000000000L;
+			}
+
+			while( ( sem_timedwait( &xTickHurry, &xDeadline ) != 0 ) && ( errno == EINTR ) )
+			{
+				/* Interrupted before the semaphore was posted. */
+			}
+
+			/* Discard any further requests to hurry that were made during
+			this tick period. */
+			while( sem_trywait( &xTickHurry ) == 0 )
+			{
+			}
+
+			/* Every thread other than the running task blocks the signal,
+			so it is delivered to the running task. */
+			kill( getpid(), portTICK_SIGNAL );
+		}
+
+		return NULL;
+	}
+
+#endif
+/*-----------------------------------------------------------*/
+
+#if ( configPOSIX_STEPPED_TIME == 1 )
+
+	static void prvInitSettled( void )
+	{
+		sem_init( &xSettled, 0, 0 );
+	}
+	/*-----------------------------------------------------------*/
+
+	static void prvWaitSettled( void )
+	{
+		while( sem_wait( &xSettled ) != 0 )
+		{
+			/* Interrupted before the semaphore was posted. */
+		}
+	}
+	/*-----------------------------------------------------------*/
+
+	static void prvStepperInit( void )
+	{
+		pthread_once( &xTickSignalSetOnce, prvInitTickSignalSet );
+		pthread_once( &xSettledOnce, prvInitSettled );
+
+		/* The tick must only be taken by the running task, never by the
+		thread raising it. */
+		pthread_sigmask( SIG_BLOCK, &xTickSignalSet, NULL );
+
+		/* The tasks first settle once each has run until it blocks after the
+		scheduler is started. */
+		if( xFirstSettled == pdFALSE )
+		{
+			prvWaitSettled();
+			xFirstSettled = pdTRUE;
+		}
+	}
+	/*-----------------------------------------------------------*/
+
+	void vPortSimulatorStepTicks( portTickType xTicks )
+	{
+		prvStepperInit();
+
+		while( xTicks > ( portTickType ) 0 )
+		{
+			/* Discard any notices left by tasks at the idle priority taking
+			turns with the idle task, so that only the one for this tick
+			counts. */
+			while( sem_trywait( &xSettled ) == 0 )
+			{
+			}
+
+			/* Every thread other than the running task blocks the signal, so
+			it is taken by the idle task, then wait for every task that it
+			unblocks to block again. */
+			kill( getpid(), portTICK_SIGNAL );
+			prvWaitSettled();
+
+			xTicks--;
+		}
+	}
+	/*-----------------------------------------------------------*/
+
+	void vPortSimulatorEndScheduler( void )
+	{
+		prvStepperInit();
+
+		/* vTaskEndScheduler() must be called from a task, so have the idle
+		task call it when it takes the tick raised here. */
+		xEndRequested = pdTRUE;
+		kill( getpid(), portTICK_SIGNAL );
+	}
+	/*-----------------------------------------------------------*/
+
+#endif
+
+#if ( configUSE_TICKLESS_IDLE == 1 ) && ( configPOSIX_VIRTUAL_TIME == 0 )
+
+	static unsigned long long prvTimespecToNs( const struct timespec *pxTime )
+	{
+		return ( ( unsigned long long ) pxTime->tv_sec * 1000000000ULL ) + ( unsigned long long ) pxTime->tv_nsec;
+	}
+	/*-----------------------------------------------------------*/
+
+	static unsigned long long prvTimevalToNs( const struct timeval *pxTime )
+	{
+		return ( ( unsigned long long ) pxTime->tv_sec * 1000000000ULL ) + ( ( unsigned long long ) pxTime->tv_usec * 1000ULL );
+	}
+	/*-----------------------------------------------------------*/
+
+	static void prvNsToTimeval( unsigned long long ullNs, struct timeval *pxTime )
+	{
+		/* Round up, as a zero it_value would stop the timer. */
+		ullNs = ( ullNs + 999ULL ) / 1000ULL;
+		if( ullNs == 0ULL )
+		{
+			ullNs = 1ULL;
+		}
+
+		pxTime->tv_sec = ( time_t ) ( ullNs / 1000000ULL );
+		pxTime->tv_usec = ( suseconds_t ) ( ullNs % 1000000ULL );
+	}
+	/*-----------------------------------------------------------*/
+
+#endif
+
+#if ( configUSE_TICKLESS_IDLE == 1 )
+
+	void vPortSuppressTicksAndSleep( portTickType xExpectedIdleTime )
+	{
+	#if ( configPOSIX_VIRTUAL_TIME == 0 )
+		const unsigned long long ullTickPeriodNs = 1000000000ULL / configTICK_RATE_HZ;
+		unsigned long long ullToNextTickNs, ullDeadlineNs, ullElapsedNs, ullSleptPastTickNs, ullLatencyNs;
+		unsigned long ulCompleteTickPeriods;
+		struct itimerval xTimer, xStopped;
+		struct timespec xStart, xWake, xDeadline;
+	#endif
+	portTickType xModifiableIdleTime;
+	sigset_t xPending;
+
+		/* Called from the idle task with the scheduler suspended.  Disable
+		interrupts in the same way as the Cortex-M ports, so a task that is
+		made ready by an interrupt stops the sleep from being entered. */
+		vPortDisableInterrupts();
+
+		if( eTaskConfirmSleepModeStatus() == eAbortSleep )
+		{
+			xSleepStats.ulAbortedSleeps++;
+			vPortEnableInterrupts();
+			return;
+		}
+
+		#if ( configPOSIX_VIRTUAL_TIME == 1 )
+		{
+			/* Leave a tick that has already been raised to be taken. */
+			sigpending( &xPending );
+			if( sigismember( &xPending, portTICK_SIGNAL ) != 0 )
+			{
+				xSleepStats.ulAbortedSleeps++;
+				vPortEnableInterrupts();
+				return;
+			}
+
+			/* Host time spent in the idle task is skipped anyway, so step
+			straight to one short of the deadline and have the tick thread
+			deliver the last tick at once. */
+			xModifiableIdleTime = xExpectedIdleTime;
+			configPRE_SLEEP_PROCESSING( xModifiableIdleTime );
+			( void ) xModifiableIdleTime;
+			configPOST_SLEEP_PROCESSING( xExpectedIdleTime );
+
+			vTaskStepTick( xExpectedIdleTime - 1 );
+			xSleepStats.ulSleeps++;
+			xSleepStats.ulTimedWakes++;
+			xSleepStats.ulTicksSuppressed += xExpectedIdleTime - 1;
+			sem_post( &xTickHurry );
+		}
+		#else
+		{
+			/* Stop the interval timer, keeping the time left until the tick
+			that was due next so that the tick stays on its original
+			schedule. */
+			memset( &xStopped, 0, sizeof( xStopped ) );
+			setitimer( ITIMER_REAL, &xStopped, &xTimer );
+			clock_gettime( CLOCK_MONOTONIC, &xStart );
+
+			/* If the timer expired since interrupts were disabled then the
+			tick for this period is already pending, so don't sleep. */
+			sigpending( &xPending );
+			if( ( sigismember( &xPending, portTICK_SIGNAL ) != 0 ) || ( ( xTimer.it_value.tv_sec == 0 ) && ( xTimer.it_value.tv_usec == 0 ) ) )
+			{
+				setitimer( ITIMER_REAL, &xTimer, NULL );
+				xSleepStats.ulAbortedSleeps++;
+				vPortEnableInterrupts();
+				return;
+			}
+
+			/* Sleep until the tick at which the next task unblocks.  The tick
+			count is part way through the current period, so that is the rest
+			of this period plus xExpectedIdleTime - 1 whole periods. */
+			ullToNextTickNs = prvTimevalToNs( &xTimer.it_value );
+			ullDeadlineNs = prvTimespecToNs( &xStart ) + ullToNextTickNs + ( ( unsigned long long ) ( xExpectedIdleTime - 1 ) * ullTickPeriodNs );
+			xDeadline.tv_sec = ( time_t ) ( ullDeadlineNs / 1000000000ULL );
+			xDeadline.tv_nsec = ( long ) ( ullDeadlineNs % 1000000000ULL );
+
+			/* As on the target, configPRE_SLEEP_PROCESSING() can set its
+			parameter to 0 to show that it has already slept.  Any other
+			signal ends the sleep early, as an interrupt would end a wfi. */
+			xModifiableIdleTime = xExpectedIdleTime;
+			configPRE_SLEEP_PROCESSING( xModifiableIdleTime );
+			if( xModifiableIdleTime > 0 )
+			{
+				clock_nanosleep( CLOCK_MONOTONIC, TIMER_ABSTIME, &xDeadline, NULL );
+			}
+			configPOST_SLEEP_PROCESSING( xExpectedIdleTime );
+
+			clock_gettime( CLOCK_MONOTONIC, &xWake );
+			ullElapsedNs = prvTimespecToNs( &xWake ) - prvTimespecToNs( &xStart );
+
+			/* Work out how many tick periods ended during the sleep, and how
+			long it is until the end of the period the sleep ended in. */
+			if( ullElapsedNs < ullToNextTickNs )
+			{
+				ulCompleteTickPeriods = 0;
+				ullToNextTickNs -= ullElapsedNs;
+			}
+			else
+			{
+				ullSleptPastTickNs = ullElapsedNs - ullToNextTickNs;
+				ulCompleteTickPeriods = 1UL + ( unsigned long ) ( ullSleptPastTickNs / ullTickPeriodNs );
+				ullToNextTickNs = ullTickPeriodNs - ( ullSleptPastTickNs % ullTickPeriodNs );
+
+				/* The tick count must not pass the time at which the next
+				task unblocks, so any further periods overslept are lost. */
+				if( ulCompleteTickPeriods > ( unsigned long ) xExpectedIdleTime )
+				{
+					ulCompleteTickPeriods = ( unsigned long ) xExpectedIdleTime;
+				}
+			}
+
+			/* Restart the timer so the next tick falls where it would have
+			done had the timer never been stopped. */
+			xTimer.it_interval.tv_sec = 0;
+			xTimer.it_interval.tv_usec = 1000000UL / configTICK_RATE_HZ;
+			prvNsToTimeval( ullToNextTickNs, &xTimer.it_value );
+			setitimer( ITIMER_REAL, &xTimer, NULL );
+
+			/* Step the tick count over all but the last of the periods that
+			ended, and raise the tick for the last one so that it is processed
+			as a normal tick once interrupts are enabled. */
+			if( ulCompleteTickPeriods > 0UL )
+			{
+				vTaskStepTick( ( portTickType ) ( ulCompleteTickPeriods - 1UL ) );
+				xSleepStats.ulTicksSuppressed += ulCompleteTickPeriods - 1UL;
+				pthread_kill( pthread_self(), portTICK_SIGNAL );
+			}
+
+			xSleepStats.ulSleeps++;
+			xSleepStats.ullTimeAsleepNs += ullElapsedNs;
+
+			if( prvTimespecToNs( &xWake ) >= ullDeadlineNs )
+			{
+				ullLatencyNs = prvTimespecToNs( &xWake ) - ullDeadlineNs;
+				xSleepStats.ulTimedWakes++;
+				xSleepStats.ullWakeLatencyNs += ullLatencyNs;
+				if( ullLatencyNs > xSleepStats.ulMaxWakeLatencyNs )
+				{
+					xSleepStats.ulMaxWakeLatencyNs = ( unsigned long ) ullLatencyNs;
+				}
+			}
+		}
+		#endif
+
+		vPortEnableInterrupts();
+	}
+
+#endif /* configUSE_TICKLESS_IDLE */
+/*-----------------------------------------------------------*/
+
+void vPortGetSleepStats( xPortSleepStats *pxStats )
+{
+	vPortEnterCritical();
+	*pxStats = xSleepStats;
+	vPortExitCritical();
+}
+/*-----------------------------------------------------------*/
+
+/*
+ * See header file for description.
+ */
+portBASE_TYPE xPortStartScheduler( void )
+{
+struct sigaction xAction;
+#if ( configPOSIX_VIRTUAL_TIME == 0 ) && ( configPOSIX_STEPPED_TIME == 0 )
+	struct itimerval xTimer;
+#endif
+
+	pthread_once( &xTickSignalSetOnce, prvInitTickSignalSet );
+
+	/* This thread takes no further part once the first task is started, so
+	it must never take the tick. */
+	pthread_sigmask( SIG_BLOCK, &xTickSignalSet, NULL );
+
+	memset( &xAction, 0, sizeof( xAction ) );
+	xAction.sa_handler = prvTickSignalHandler;
+	xAction.sa_flags = SA_RESTART;
+	sigemptyset( &xAction.sa_mask );
+	sigaction( portTICK_SIGNAL, &xAction, NULL );
+
+	sem_init( &xSchedulerEnd, 0, 0 );
+
+	/* Initialise the critical nesting count ready for the first task. */
+	uxCriticalNesting = 0;
+	xYieldPending = pdFALSE;
+	xSchedulerStarted = pdTRUE;
+
+	/* Start the source of the tick. */
+	#if ( configPOSIX_VIRTUAL_TIME == 1 )
+	{
+		sem_init( &xTickRequest, 0, 0 );
+		sem_init( &xTickHurry, 0, 0 );
+		pthread_create( &xTickThread, NULL, prvVirtualTickThread, NULL );
+		prvHurryVirtualTick();
+		sem_post( &xTickRequest );
+	}
+	#elif ( configPOSIX_STEPPED_TIME == 1 )
+	{
+		/* The tick is raised by vPortSimulatorStepTicks().  If the idle task
+		is the only one ready then the tasks have already settled. */
+		pthread_once( &xSettledOnce, prvInitSettled );
+		if( ( xTaskHandle ) pxCurrentTCB == xTaskGetIdleTaskHandle() )
+		{
+			sem_post( &xSettled );
+		}
+	}
+	#else
+	{
+		xTimer.it_interval.tv_sec = 0;
+		xTimer.it_interval.tv_usec = 1000000UL / configTICK_RATE_HZ;
+		xTimer.it_value = xTimer.it_interval;
+		setitimer( ITIMER_REAL, &xTimer, NULL );
+	}
+	#endif
+
+	/* Start the first task, then wait for vPortEndScheduler(). */
+	sem_post( &prvThreadFromTCB( pxCurrentTCB )->xWake );
+
+	while( sem_wait( &xSchedulerEnd ) != 0 )
+	{
+		/* Interrupted before the semaphore was posted. */
+	}
+
+	/* Any tick still pending is of no further use. */
+	xAction.sa_handler = SIG_IGN;
+	sigaction( portTICK_SIGNAL, &xAction, NULL );
+
+	return pdTRUE;
+}
+/*-----------------------------------------------------------*/
+
+void vPortEndScheduler( void )
+{
+#if ( configPOSIX_VIRTUAL_TIME == 0 ) && ( configPOSIX_STEPPED_TIME == 0 )
+	struct itimerval xTimer;
+
+	/* Stop the tick. */
+	memset( &xTimer, 0, sizeof( xTimer ) );
+	setitimer( ITIMER_REAL, &xTimer, NULL );
+#endif
+
+	xSchedulerStarted = pdFALSE;
+
+	/* Return control to the thread that started the scheduler and stop the
+	calling task for good.  Interrupts are disabled by vTaskEndScheduler(). */
+	sem_post( &xSchedulerEnd );
+	prvSuspendSelf( prvThreadFromTCB( pxCurrentTCB ) );
+}
+/*-----------------------------------------------------------*/
+
+void vPortYield( void )
+{
+	if( xSchedulerStarted == pdFALSE )
+	{
+		return;
+	}
+
+	/* Like PendSV, a yield requested with interrupts disabled is held until
+	they are enabled again. */
+	if( xInterruptsDisabled != pdFALSE )
+	{
+		xYieldPending = pdTRUE;
+		return;
+	}
+
+	vPortDisableInterrupts();
+	prvSwitchContext();
+	vPortEnableInterrupts();
+}
+/*-----------------------------------------------------------*/
+
+void vPortYieldFromISR( void )
+{
+	xYieldPending = pdTRUE;
+
+	if( xInterruptsDisabled == pdFALSE )
+	{
+		vPortYield();
+	}
+}
+/*-----------------------------------------------------------*/
+
+void vPortDisableInterrupts( void )
+{
+	pthread_sigmask( SIG_BLOCK, &xTickSignalSet, NULL );
+	xInterruptsDisabled = pdTRUE;
+}
+/*-----------------------------------------------------------*/
+
+void vPortEnableInterrupts( void )
+{
+	xInterruptsDisabled = pdFALSE;
+	pthread_sigmask( SIG_UNBLOCK, &xTickSignalSet, NULL );
+
+	/* Perform any yield that was requested while interrupts were disabled. */
+	if( ( xYieldPending != pdFALSE ) && ( xSchedulerStarted != pdFALSE ) )
+	{
+		vPortYield();
+	}
+}
+/*-----------------------------------------------------------*/
+
+unsigned portBASE_TYPE uxPortSetInterruptMask( void )
+{
+unsigned portBASE_TYPE uxWasDisabled;
+
+	uxWasDisabled = ( unsigned portBASE_TYPE ) xInterruptsDisabled;
+	vPortDisableInterrupts();
+
+	return uxWasDisabled;
+}
+/*-----------------------------------------------------------*/
+
+void vPortClearInterruptMask( unsigned portBASE_TYPE uxMask )
+{
+	if( uxMask == 0 )
+	{
+		vPortEnableInterrupts();
+	}
+}
+/*-----------------------------------------------------------*/
+
+void vPortEnterCritical( void )
+{
+	vPortDisableInterrupts();
+	uxCriticalNesting++;
+}
+/*-----------------------------------------------------------*/
+
+void vPortExitCritical( void )
+{
+	uxCriticalNesting--;
+	if( uxCriticalNesting == 0 )
+	{
+		vPortEnableInterrupts();
+	}
+}
+/*-----------------------------------------------------------*/
+
+void vPortCleanUpTCB( void *pxTCB )
+{
+xThreadState *pxThread = prvThreadFromTCB( pxTCB );
+sigset_t xOldMask;
+
+	/* The deleted task's thread is waiting to be switched in.  Wake it with
+	xExit set so that it terminates, then release its resources before the
+	kernel frees the stack that holds them. */
+	pthread_sigmask( SIG_BLOCK, &xTickSignalSet, &xOldMask );
+	pxThread->xExit = pdTRUE;
+	sem_post( &pxThread->xWake );
+	pthread_join( pxThread->xThread, NULL );
+	sem_destroy( &pxThread->xWake );
+	pthread_sigmask( SIG_SETMASK, &xOldMask, NULL );
+}
+/*-----------------------------------------------------------*/
@@ -0,0 +1,159 @@
+/*
+    FreeRTOS V7.1.1 - POSIX/Linux simulator port.
+
+    This port runs each FreeRTOS task as a POSIX thread, of which exactly one
+    is allowed to run at any time.  The tick interrupt is simulated with
+    SIGALRM, and the interrupt mask with the thread signal mask.
+
+    1 tab == 4 spaces!
+*/
+
+#ifndef PORTMACRO_H
+#define PORTMACRO_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*-----------------------------------------------------------
+ * Port specific definitions.
+ *
+ * The settings in this file configure FreeRTOS correctly for the
+ * given hardware and compiler.
+ *
+ * These settings should not be altered.
+ *-----------------------------------------------------------
+ */
+
+/* Type definitions. */
+#define portCHAR		char
+#define portFLOAT		float
+#define portDOUBLE		double
+#define portLONG		long
+#define portSHORT		short
+#define portSTACK_TYPE	unsigned portLONG
+#define portBASE_TYPE	long
+
+/* The tick count is kept at 32 bits, even on 64-bit hosts, so that it wraps
+exactly as it does on the target. */
+#if( configUSE_16_BIT_TICKS == 1 )
+	typedef unsigned portSHORT portTickType;
+	#define portMAX_DELAY ( portTickType ) 0xffff
+#else
+	typedef unsigned int portTickType;
+	#define portMAX_DELAY ( portTickType ) 0xffffffff
+#endif
+/*-----------------------------------------------------------*/
+
+/* Architecture specifics. */
+#define portSTACK_GROWTH			( -1 )
+#define portTICK_RATE_MS			( ( portTickType ) 1000 / configTICK_RATE_HZ )
+#define portBYTE_ALIGNMENT			8
+/*-----------------------------------------------------------*/
+
+/* Simulator configuration.  When configPOSIX_VIRTUAL_TIME is 1 the tick
+skips the time spent in the idle task.  While any other task is running the
+tick follows the host clock, but once the idle task has run for a whole tick
+period the following ticks are generated at once until another task is
+unblocked.  An application whose tasks spend most of their time blocked
+therefore runs far faster than real time, and the order in which its tasks
+are released is repeatable from run to run.  This requires
+INCLUDE_xTaskGetIdleTaskHandle to be set to 1. */
+#ifndef configPOSIX_VIRTUAL_TIME
+	#define configPOSIX_VIRTUAL_TIME	0
+#endif
+/*-----------------------------------------------------------*/
+
+/* When configPOSIX_STEPPED_TIME is 1 the port has no tick source.  Instead a
+host thread which is not running a task calls vPortSimulatorStepTicks() to
+take a number of ticks.  Each tick is raised only once every task has run
+until it blocks, and the call returns once the tasks unblocked by the last
+tick have blocked again, so a test can drive the application one tick at a
+time and see the same result on every run.  Between calls the tasks are all
+blocked and the test may change the state they read.  The same thread ends
+the scheduler with vPortSimulatorEndScheduler().  This requires
+INCLUDE_xTaskGetIdleTaskHandle to be set to 1.  Tasks at the idle priority
+share the processor with the idle task, so they are taken to have settled
+whenever the idle task is switched in. */
+#ifndef configPOSIX_STEPPED_TIME
+	#define configPOSIX_STEPPED_TIME	0
+#endif
+
+#if configPOSIX_STEPPED_TIME == 1
+	extern void vPortSimulatorStepTicks( portTickType xTicks );
+	extern void vPortSimulatorEndScheduler( void );
+#endif
+/*-----------------------------------------------------------*/
+
+/* Tickless idle.  The interval timer is stopped while the idle task sleeps
+on the host clock until the next task is due to unblock, then the tick count
+is corrected for the time that passed.  With virtual time the sleep takes no
+time at all. */
+#if configUSE_TICKLESS_IDLE == 1
+	extern void vPortSuppressTicksAndSleep( portTickType xExpectedIdleTime );
+	#define portSUPPRESS_TICKS_AND_SLEEP( xExpectedIdleTime ) vPortSuppressTicksAndSleep( xExpectedIdleTime )
+#endif
+
+/* Counters kept by the port to measure the cost of the tick.  The number of
+tick interrupts taken and the fraction of time spent asleep stand in for the
+current that the target would draw, and the wake latency is how late the
+host woke the idle task relative to the deadline it asked for. */
+typedef struct xPORT_SLEEP_STATS
+{
+	unsigned long ulTickInterrupts;			/* The number of tick interrupts taken. */
+	unsigned long ulSleeps;					/* The number of times the tick was suppressed. */
+	unsigned long ulAbortedSleeps;			/* The number of sleeps abandoned because a task became ready. */
+	unsigned long ulTicksSuppressed;		/* The number of ticks stepped over instead of being taken. */
+	unsigned long long ullTimeAsleepNs;		/* The host time spent asleep. */
+	unsigned long long ullWakeLatencyNs;	/* The total of the wake latencies. */
+	unsigned long ulMaxWakeLatencyNs;		/* The largest wake latency. */
+	unsigned long ulTimedWakes;				/* The number of sleeps that ran to their deadline. */
+} xPortSleepStats;
+
+extern void vPortGetSleepStats( xPortSleepStats *pxStats );
+/*-----------------------------------------------------------*/
+
+/* Scheduler utilities. */
+extern void vPortYield( void );
+extern void vPortYieldFromISR( void );
+
+#define portYIELD()					vPortYield()
+
+#define portEND_SWITCHING_ISR( xSwitchRequired ) if( xSwitchRequired ) vPortYieldFromISR()
+/*-----------------------------------------------------------*/
+
+/* Critical section management. */
+extern void vPortDisableInterrupts( void );
+extern void vPortEnableInterrupts( void );
+extern unsigned portBASE_TYPE uxPortSetInterruptMask( void );
+extern void vPortClearInterruptMask( unsigned portBASE_TYPE uxMask );
+extern void vPortEnterCritical( void );
+extern void vPortExitCritical( void );
+
+#define portSET_INTERRUPT_MASK_FROM_ISR()		uxPortSetInterruptMask()
+#define portCLEAR_INTERRUPT_MASK_FROM_ISR(x)	vPortClearInterruptMask( x )
+
+#define portDISABLE_INTERRUPTS()	vPortDisableInterrupts()
+#define portENABLE_INTERRUPTS()		vPortEnableInterrupts()
+#define portENTER_CRITICAL()		vPortEnterCritical()
+#define portEXIT_CRITICAL()			vPortExitCritical()
+/*-----------------------------------------------------------*/
+
+/* Each task runs on its own host thread, which must be stopped when the task
+is deleted. */
+extern void vPortCleanUpTCB( void *pxTCB );
+
+#define portCLEAN_UP_TCB( pxTCB )	vPortCleanUpTCB( pxTCB )
+/*-----------------------------------------------------------*/
+
+/* Task function macros as described on the FreeRTOS.org WEB site. */
+#define portTASK_FUNCTION_PROTO( vFunction, pvParameters ) void vFunction( void *pvParameters )
+#define portTASK_FUNCTION( vFunction, pvParameters ) void vFunction( void *pvParameters )
+
+#define portNOP()
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* PORTMACRO_H */
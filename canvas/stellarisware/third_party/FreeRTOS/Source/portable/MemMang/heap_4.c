@@ -0,0 +1,461 @@
+/*
+    FreeRTOS V7.1.1 - Coalescing heap with segregated free lists.
+
+    1 tab == 4 spaces!
+*/
+
+/*
+ * A sample implementation of pvPortMalloc() and vPortFree() that combines
+ * adjacent free blocks into a single larger block, so that the heap does not
+ * fragment when blocks of different sizes are repeatedly allocated and freed.
+ *
+ * Every block starts with a header holding its own size and the size of the
+ * block immediately below it in memory.  This lets vPortFree() find both
+ * neighbours of the block being freed, and merge with either of them, without
+ * searching.  No two free blocks are ever adjacent.
+ *
+ * Free blocks are kept in heapNUM_BINS doubly linked lists.  The small bins
+ * each hold blocks of a single size, so a small allocation is satisfied from
+ * the head of its bin when that bin is not empty.  The large bins each hold a
+ * power of two range of sizes.  A bitmap records which bins are not empty, so
+ * the search for a larger block never visits an empty bin.
+ *
+ * See heap_1.c, heap_2.c and heap_3.c for alternative implementations, and the
+ * memory management pages of http://www.FreeRTOS.org for more information.
+ */
+#include <stdlib.h>
+
+/* Defining MPU_WRAPPERS_INCLUDED_FROM_API_FILE prevents task.h from redefining
+all the API functions to use the MPU wrappers.  That should only be done when
+task.h is included from an application file. */
+#define MPU_WRAPPERS_INCLUDED_FROM_API_FILE
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+#undef MPU_WRAPPERS_INCLUDED_FROM_API_FILE
+
+/* Allocate the memory for the heap.  The struct is used to force byte
+alignment without using any non-portable code. */
+static union xRTOS_HEAP
+{
+	#if portBYTE_ALIGNMENT == 8
+		volatile portDOUBLE dDummy;
+	#else
+		volatile unsigned long ulDummy;
+	#endif
+	unsigned char ucHeap[ configTOTAL_HEAP_SIZE ];
+} xHeap;
+
+/* The header at the start of every block.  The free list links are only
+present while the block is free, and occupy the start of the space that is
+returned to the application while the block is allocated. */
+typedef struct A_BLOCK_LINK
+{
+	size_t xPrevBlockSize;					/*<< The size of the block immediately below this one in memory, or zero for the first block. */
+	size_t xBlockSize;						/*<< The size of this block including the header, with heapBLOCK_ALLOCATED set while it is in use. */
+	struct A_BLOCK_LINK *pxNextFreeBlock;	/*<< The next free block in the same bin. */
+	struct A_BLOCK_LINK *pxPrevFreeBlock;	/*<< The previous free block in the same bin, or NULL for the first. */
+} xBlockLink;
+
+/* The size of the part of the header that is kept while a block is
+allocated, and the size of the smallest block that can hold the full header
+while it is free.  Both are rounded up to the byte alignment. */
+#define heapHEADER_SIZE			( ( ( 2 * sizeof( size_t ) ) + portBYTE_ALIGNMENT_MASK ) & ~( ( size_t ) portBYTE_ALIGNMENT_MASK ) )
+#define heapMINIMUM_BLOCK_SIZE	( ( sizeof( xBlockLink ) + portBYTE_ALIGNMENT_MASK ) & ~( ( size_t ) portBYTE_ALIGNMENT_MASK ) )
+
+/* Block sizes are a multiple of the byte alignment, so the bottom bit of
+xBlockSize is free to mark the block as allocated. */
+#define heapBLOCK_ALLOCATED		( ( size_t ) 1 )
+#define heapBLOCK_SIZE( pxBlock )	( ( pxBlock )->xBlockSize & ~heapBLOCK_ALLOCATED )
+
+/* The total size of the blocks in the heap.  The heap ends with a block that
+is permanently marked as allocated, which stops the last block from being
+merged with whatever follows the heap.  It is given room for a full header so
+that it can be accessed through an xBlockLink pointer like any other block. */
+#define heapUSABLE_SIZE			( ( ( size_t ) configTOTAL_HEAP_SIZE & ~( ( size_t ) portBYTE_ALIGNMENT_MASK ) ) - heapMINIMUM_BLOCK_SIZE )
+
+/* The free list bins.  Small bin n holds blocks of exactly
+n * portBYTE_ALIGNMENT bytes, so bins below heapMINIMUM_BLOCK_SIZE are never
+used.  The large bins hold blocks from heapSMALL_BIN_LIMIT bytes upwards, each
+covering twice the range of the one before, with the last bin holding every
+block too large for the others.  heapNUM_BINS must not exceed the number of
+bits in an unsigned long. */
+#define heapNUM_SMALL_BINS		( 16 )
+#define heapNUM_BINS			( 32 )
+#define heapSMALL_BIN_LIMIT		( ( size_t ) heapNUM_SMALL_BINS * portBYTE_ALIGNMENT )
+
+static xBlockLink *pxBins[ heapNUM_BINS ];
+
+/* Bit n is set while bin n is not empty. */
+static unsigned long ulBinMap = 0UL;
+
+/* The end of heap marker. */
+static xBlockLink *pxHeapEnd = NULL;
+
+/* Keeps track of the number of free bytes remaining, and the lowest number
+ever seen.  Neither says anything about fragmentation. */
+static size_t xFreeBytesRemaining = 0U;
+static size_t xMinimumEverFreeBytesRemaining = 0U;
+
+/* Counts of the calls made to the heap. */
+static unsigned long ulAllocations = 0UL;
+static unsigned long ulFrees = 0UL;
+static unsigned long ulFailedAllocations = 0UL;
+
+/*
+ * Sets up the heap as a single free block on the first call to
+ * pvPortMalloc().
+ */
+static void prvHeapInit( void );
+
+/*
+ * Returns the bin that holds free blocks of xBlockSize bytes.
+ */
+static unsigned portBASE_TYPE prvBinIndex( size_t xBlockSize );
+
+/*
+ * Add a free block to the head of its bin, or unlink it from its bin.
+ */
+static void prvInsertBlockIntoBin( xBlockLink *pxBlock );
+static void prvRemoveBlockFromBin( xBlockLink *pxBlock );
+
+/*
+ * Returns the index of the lowest bit set in a non-zero value.
+ */
+static unsigned portBASE_TYPE prvLowestSetBit( unsigned long ulValue );
+
+/*-----------------------------------------------------------*/
+
+static void prvHeapInit( void )
+{
+xBlockLink *pxFirstFreeBlock;
+
+	/* To start with there is a single free block that is sized to take up the
+	entire heap space, followed by the end marker. */
+	pxFirstFreeBlock = ( void * ) xHeap.ucHeap;
+	pxFirstFreeBlock->xPrevBlockSize = 0U;
+	pxFirstFreeBlock->xBlockSize = heapUSABLE_SIZE;
+
+	pxHeapEnd = ( void * ) ( xHeap.ucHeap + heapUSABLE_SIZE );
+	pxHeapEnd->xPrevBlockSize = heapUSABLE_SIZE;
+	pxHeapEnd->xBlockSize = heapBLOCK_ALLOCATED;
+
+	prvInsertBlockIntoBin( pxFirstFreeBlock );
+
+	xFreeBytesRemaining = heapUSABLE_SIZE;
+	xMinimumEverFreeBytesRemaining = heapUSABLE_SIZE;
+}
+/*-----------------------------------------------------------*/
+
+static unsigned portBASE_TYPE prvBinIndex( size_t xBlockSize )
+{
+unsigned portBASE_TYPE uxIndex;
+
+	if( xBlockSize < heapSMALL_BIN_LIMIT )
+	{
+		return ( unsigned portBASE_TYPE ) ( xBlockSize / portBYTE_ALIGNMENT );
+	}
+
+	/* Each large bin covers twice the range of the one before. */
+	uxIndex = heapNUM_SMALL_BINS;
+	xBlockSize /= heapSMALL_BIN_LIMIT;
+	while( ( xBlockSize > 1U ) && ( uxIndex < ( heapNUM_BINS - 1 ) ) )
+	{
+		uxIndex++;
+		xBlockSize >>= 1;
+	}
+
+	return uxIndex;
+}
+/*-----------------------------------------------------------*/
+
+static void prvInsertBlockIntoBin( xBlockLink *pxBlock )
+{
+unsigned portBASE_TYPE uxIndex;
+
+	uxIndex = prvBinIndex( pxBlock->xBlockSize );
+
+	pxBlock->pxPrevFreeBlock = NULL;
+	pxBlock->pxNextFreeBlock = pxBins[ uxIndex ];
+	if( pxBins[ uxIndex ] != NULL )
+	{
+		pxBins[ uxIndex ]->pxPrevFreeBlock = pxBlock;
+	}
+	pxBins[ uxIndex ] = pxBlock;
+
+	ulBinMap |= ( 1UL << uxIndex );
+}
+/*-----------------------------------------------------------*/
+
+static void prvRemoveBlockFromBin( xBlockLink *pxBlock )
+{
+unsigned portBASE_TYPE uxIndex;
+
+	if( pxBlock->pxNextFreeBlock != NULL )
+	{
+		pxBlock->pxNextFreeBlock->pxPrevFreeBlock = pxBlock->pxPrevFreeBlock;
+	}
+
+	if( pxBlock->pxPrevFreeBlock != NULL )
+	{
+		pxBlock->pxPrevFreeBlock->pxNextFreeBlock = pxBlock->pxNextFreeBlock;
+	}
+	else
+	{
+		/* The block was at the head of its bin. */
+		uxIndex = prvBinIndex( pxBlock->xBlockSize );
+		pxBins[ uxIndex ] = pxBlock->pxNextFreeBlock;
+		if( pxBins[ uxIndex ] == NULL )
+		{
+			ulBinMap &= ~( 1UL << uxIndex );
+		}
+	}
+}
+/*-----------------------------------------------------------*/
+
+static unsigned portBASE_TYPE prvLowestSetBit( unsigned long ulValue )
+{
+	#if defined( __GNUC__ )
+	{
+		return ( unsigned portBASE_TYPE ) __builtin_ctzl( ulValue );
+	}
+	#else
+	{
+	unsigned portBASE_TYPE uxBit = 0;
+
+		while( ( ulValue & 1UL ) == 0UL )
+		{
+			ulValue >>= 1;
+			uxBit++;
+		}
+
+		return uxBit;
+	}
+	#endif
+}
+/*-----------------------------------------------------------*/
+
+void *pvPortMalloc( size_t xWantedSize )
+{
+xBlockLink *pxBlock = NULL, *pxNewBlockLink, *pxNextBlock;
+unsigned portBASE_TYPE uxIndex;
+unsigned long ulLargerBins;
+size_t xBlockSize;
+void *pvReturn = NULL;
+
+	vTaskSuspendAll();
+	{
+		/* If this is the first call to malloc then the heap will require
+		initialisation to setup the list of free blocks. */
+		if( pxHeapEnd == NULL )
+		{
+			prvHeapInit();
+		}
+
+		/* The wanted size is increased so it can contain the block header in
+		addition to the requested amount of bytes, and rounded up so that
+		blocks are always aligned to the required number of bytes. */
+		if( ( xWantedSize > 0U ) && ( xWantedSize < heapUSABLE_SIZE ) )
+		{
+			xWantedSize = ( xWantedSize + heapHEADER_SIZE + portBYTE_ALIGNMENT_MASK ) & ~( ( size_t ) portBYTE_ALIGNMENT_MASK );
+			if( xWantedSize < heapMINIMUM_BLOCK_SIZE )
+			{
+				xWantedSize = heapMINIMUM_BLOCK_SIZE;
+			}
+
+			uxIndex = prvBinIndex( xWantedSize );
+
+			/* A small bin holds blocks of exactly the wanted size.  A large
+			bin holds a range of sizes, so search it for the first block
+			that is big enough. */
+			for( pxBlock = pxBins[ uxIndex ]; pxBlock != NULL; pxBlock = pxBlock->pxNextFreeBlock )
+			{
+				if( pxBlock->xBlockSize >= xWantedSize )
+				{
+					break;
+				}
+			}
+
+			/* Otherwise take the first block from the next bin that is not
+			empty.  Every block in it is larger than the wanted size. */
+			if( ( pxBlock == NULL ) && ( uxIndex < ( heapNUM_BINS - 1 ) ) )
+			{
+				ulLargerBins = ulBinMap & ~( ( 2UL << uxIndex ) - 1UL );
+				if( ulLargerBins != 0UL )
+				{
+					pxBlock = pxBins[ prvLowestSetBit( ulLargerBins ) ];
+				}
+			}
+		}
+
+		if( pxBlock != NULL )
+		{
+			/* This block is being returned for use so must be taken out of
+			the list of free blocks. */
+			prvRemoveBlockFromBin( pxBlock );
+
+			/* If the block is larger than required it can be split into two.
+			The block above it is already allocated, so the remainder does
+			not need to be merged with anything. */
+			xBlockSize = pxBlock->xBlockSize;
+			if( ( xBlockSize - xWantedSize ) >= heapMINIMUM_BLOCK_SIZE )
+			{
+				pxNewBlockLink = ( void * ) ( ( ( unsigned char * ) pxBlock ) + xWantedSize );
+				pxNewBlockLink->xPrevBlockSize = xWantedSize;
+				pxNewBlockLink->xBlockSize = xBlockSize - xWantedSize;
+
+				pxNextBlock = ( void * ) ( ( ( unsigned char * ) pxBlock ) + xBlockSize );
+				pxNextBlock->xPrevBlockSize = pxNewBlockLink->xBlockSize;
+
+				prvInsertBlockIntoBin( pxNewBlockLink );
+
+				xBlockSize = xWantedSize;
+			}
+
+			pxBlock->xBlockSize = xBlockSize | heapBLOCK_ALLOCATED;
+
+			xFreeBytesRemaining -= xBlockSize;
+			if( xFreeBytesRemaining < xMinimumEverFreeBytesRemaining )
+			{
+				xMinimumEverFreeBytesRemaining = xFreeBytesRemaining;
+			}
+
+			ulAllocations++;
+
+			/* Return the memory space - jumping over the header at its
+			start. */
+			pvReturn = ( void * ) ( ( ( unsigned char * ) pxBlock ) + heapHEADER_SIZE );
+		}
+		else
+		{
+			ulFailedAllocations++;
+		}
+	}
+	xTaskResumeAll();
+
+	#if( configUSE_MALLOC_FAILED_HOOK == 1 )
+	{
+		if( pvReturn == NULL )
+		{
+			extern void vApplicationMallocFailedHook( void );
+			vApplicationMallocFailedHook();
+		}
+	}
+	#endif
+
+	return pvReturn;
+}
+/*-----------------------------------------------------------*/
+
+void vPortFree( void *pv )
+{
+xBlockLink *pxBlock, *pxNeighbour;
+size_t xBlockSize;
+
+	if( pv )
+	{
+		/* The memory being freed will have a header immediately before it.
+		The void cast is used to prevent byte alignment warnings from the
+		compiler. */
+		pxBlock = ( void * ) ( ( ( unsigned char * ) pv ) - heapHEADER_SIZE );
+
+		/* Catch blocks that are freed twice, or were never allocated. */
+		configASSERT( ( pxBlock->xBlockSize & heapBLOCK_ALLOCATED ) != 0U );
+
+		vTaskSuspendAll();
+		{
+			xBlockSize = heapBLOCK_SIZE( pxBlock );
+			xFreeBytesRemaining += xBlockSize;
+			ulFrees++;
+
+			/* Merge with the block above if it is free.  The end marker is
+			always allocated. */
+			pxNeighbour = ( void * ) ( ( ( unsigned char * ) pxBlock ) + xBlockSize );
+			if( ( pxNeighbour->xBlockSize & heapBLOCK_ALLOCATED ) == 0U )
+			{
+				prvRemoveBlockFromBin( pxNeighbour );
+				xBlockSize += pxNeighbour->xBlockSize;
+			}
+
+			/* Merge with the block below if it is free. */
+			if( pxBlock->xPrevBlockSize != 0U )
+			{
+				pxNeighbour = ( void * ) ( ( ( unsigned char * ) pxBlock ) - pxBlock->xPrevBlockSize );
+				if( ( pxNeighbour->xBlockSize & heapBLOCK_ALLOCATED ) == 0U )
+				{
+					prvRemoveBlockFromBin( pxNeighbour );
+					xBlockSize += pxNeighbour->xBlockSize;
+					pxBlock = pxNeighbour;
+				}
+			}
+
+			pxBlock->xBlockSize = xBlockSize;
+
+			pxNeighbour = ( void * ) ( ( ( unsigned char * ) pxBlock ) + xBlockSize );
+			pxNeighbour->xPrevBlockSize = xBlockSize;
+
+			prvInsertBlockIntoBin( pxBlock );
+		}
+		xTaskResumeAll();
+	}
+}
+/*-----------------------------------------------------------*/
+
+size_t xPortGetFreeHeapSize( void )
+{
+	return xFreeBytesRemaining;
+}
+/*-----------------------------------------------------------*/
+
+size_t xPortGetMinimumEverFreeHeapSize( void )
+{
+	return xMinimumEverFreeBytesRemaining;
+}
+/*-----------------------------------------------------------*/
+
+void vPortGetHeapStats( xHeapStats *pxHeapStats )
+{
+xBlockLink *pxBlock;
+unsigned portBASE_TYPE uxIndex;
+size_t xLargest = 0U, xBlockSize;
+unsigned long ulFreeBlocks = 0UL;
+
+	vTaskSuspendAll();
+	{
+		if( pxHeapEnd == NULL )
+		{
+			prvHeapInit();
+		}
+
+		/* Walk every free block to count them and find the largest. */
+		for( uxIndex = 0; uxIndex < heapNUM_BINS; uxIndex++ )
+		{
+			for( pxBlock = pxBins[ uxIndex ]; pxBlock != NULL; pxBlock = pxBlock->pxNextFreeBlock )
+			{
+				xBlockSize = pxBlock->xBlockSize;
+				if( xBlockSize > xLargest )
+				{
+					xLargest = xBlockSize;
+				}
+
+				ulFreeBlocks++;
+			}
+		}
+
+		pxHeapStats->xFreeBytes = xFreeBytesRemaining;
+		pxHeapStats->xMinimumEverFreeBytes = xMinimumEverFreeBytesRemaining;
+		pxHeapStats->xLargestFreeBlock = ( xLargest > heapHEADER_SIZE ) ? ( xLargest - heapHEADER_SIZE ) : 0U;
+		pxHeapStats->ulFreeBlocks = ulFreeBlocks;
+		pxHeapStats->ulAllocations = ulAllocations;
+		pxHeapStats->ulFrees = ulFrees;
+		pxHeapStats->ulFailedAllocations = ulFailedAllocations;
+	}
+	xTaskResumeAll();
+}
+/*-----------------------------------------------------------*/
+
+void vPortInitialiseBlocks( void )
+{
+	/* This just exists to keep the linker quiet. */
+}
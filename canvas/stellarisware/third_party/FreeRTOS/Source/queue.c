@@ -101,6 +101,11 @@ task.h is included from an application file. */
 #define uxRecursiveCallCount			pcReadFrom
 #define queueQUEUE_IS_MUTEX				NULL
 
+/* The recursive call count is held in a pointer member, so it is adjusted as
+an integer.  Stepping a pointer to or from NULL is undefined, and allows GCC to
+assume that the count never returns to zero. */
+#define queueRECURSIVE_COUNT_ADD( pxMutex, lDelta )	( ( pxMutex )->uxRecursiveCallCount = ( signed char * ) ( ( unsigned long ) ( ( pxMutex )->uxRecursiveCallCount ) + ( unsigned long ) ( lDelta ) ) )
+
 /* Semaphores do not actually store or copy data, so have an items size of
 zero. */
 #define queueSEMAPHORE_QUEUE_ITEM_LENGTH ( ( unsigned portBASE_TYPE ) 0 )
@@ -478,7 +483,7 @@ xQueueHandle xReturn = NULL;
 			uxRecursiveCallCount is only modified by the mutex holder, and as
 			there can only be one, no mutual exclusion is required to modify the
 			uxRecursiveCallCount member. */
-			( pxMutex->uxRecursiveCallCount )--;
+			queueRECURSIVE_COUNT_ADD( pxMutex, -1 );
 
 			/* Have we unwound the call count? */
 			if( pxMutex->uxRecursiveCallCount == 0 )
@@ -519,7 +524,7 @@ xQueueHandle xReturn = NULL;
 
 		if( pxMutex->pxMutexHolder == xTaskGetCurrentTaskHandle() )
 		{
-			( pxMutex->uxRecursiveCallCount )++;
+			queueRECURSIVE_COUNT_ADD( pxMutex, 1 );
 			xReturn = pdPASS;
 		}
 		else
@@ -530,7 +535,7 @@ xQueueHandle xReturn = NULL;
 			we may have blocked to reach here. */
 			if( xReturn == pdPASS )
 			{
-				( pxMutex->uxRecursiveCallCount )++;
+				queueRECURSIVE_COUNT_ADD( pxMutex, 1 );
 			}
 			else
 			{
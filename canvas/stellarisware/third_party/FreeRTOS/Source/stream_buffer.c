@@ -0,0 +1,932 @@
+/*
+    FreeRTOS V7.1.1 - Stream buffers.
+
+    Stream and message buffers pass bytes from a single writer to a single
+    reader through a circular buffer.  The writer only ever moves the head
+    index and the reader only ever moves the tail index, so data is passed
+    without a critical section unless a task has to block or be unblocked.
+    Blocking is implemented with direct to task notifications.
+
+    1 tab == 4 spaces!
+*/
+
+#include <string.h>
+
+/* Defining MPU_WRAPPERS_INCLUDED_FROM_API_FILE prevents task.h from redefining
+all the API functions to use the MPU wrappers.  That should only be done when
+task.h is included from an application file. */
+#define MPU_WRAPPERS_INCLUDED_FROM_API_FILE
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "stream_buffer.h"
+
+#undef MPU_WRAPPERS_INCLUDED_FROM_API_FILE
+
+#if ( configUSE_TASK_NOTIFICATIONS != 1 )
+	#error configUSE_TASK_NOTIFICATIONS must be set to 1 to build stream_buffer.c
+#endif
+
+#if ( INCLUDE_xTaskGetCurrentTaskHandle != 1 ) && ( configUSE_MUTEXES != 1 )
+	#error INCLUDE_xTaskGetCurrentTaskHandle must be set to 1 to build stream_buffer.c
+#endif
+
+/* Bits used in the ucFlags member of a stream buffer. */
+#define sbFLAGS_IS_MESSAGE_BUFFER		( ( unsigned char ) 1 )
+
+/* The number of bytes used to store the length of each message in a message
+buffer. */
+#define sbBYTES_TO_STORE_MESSAGE_LENGTH	( sizeof( configMESSAGE_BUFFER_LENGTH_TYPE ) )
+
+/* Stops the compiler moving the copy of data into or out of the storage
+across the update of the index that hands the data to the other side.  The
+buffer is only shared between contexts on a single core so no hardware barrier
+is needed.  The other toolchains do not move accesses across the volatile
+index updates. */
+#ifdef __GNUC__
+	#define sbCOMPILER_BARRIER()		__asm volatile( "" ::: "memory" )
+#else
+	#define sbCOMPILER_BARRIER()
+#endif
+
+/* The definition of the stream buffers themselves. */
+typedef struct sbStreamBufferDefinition
+{
+	volatile size_t xTail;					/*<< Index of the next byte to read.  Only updated by the reader. */
+	volatile size_t xHead;					/*<< Index of the next byte to write.  Only updated by the writer. */
+	size_t xLength;							/*<< The size of the storage, which is one byte larger than the buffer so that a full buffer can be told from an empty one. */
+	size_t xTriggerLevelBytes;				/*<< The number of bytes that must be in the buffer before a waiting reader is unblocked. */
+	volatile xTaskHandle xTaskWaitingToReceive;	/*<< The reader, if it is blocked waiting for data. */
+	volatile xTaskHandle xTaskWaitingToSend;	/*<< The writer, if it is blocked waiting for space. */
+	unsigned char *pucBuffer;				/*<< The storage, which follows this structure in the same allocation. */
+	unsigned char ucFlags;					/*<< sbFLAGS_IS_MESSAGE_BUFFER if the buffer holds messages. */
+} xSTREAM_BUFFER;
+
+/*-----------------------------------------------------------*/
+
+/*
+ * The number of bytes that can be read, and the number that can be written.
+ * Each is only exact when called by the side that will act on it; the other
+ * side can only ever make the result larger.
+ */
+static size_t prvBytesInBuffer( const xSTREAM_BUFFER * const pxStreamBuffer ) PRIVILEGED_FUNCTION;
+static size_t prvSpacesInBuffer( const xSTREAM_BUFFER * const pxStreamBuffer ) PRIVILEGED_FUNCTION;
+
+/*
+ * Copy xCount bytes into or out of the storage starting at index xIndex,
+ * wrapping at the end of the storage.  Return the index following the last
+ * byte copied.  Neither updates the head or tail.
+ */
+static size_t prvWriteBytes( xSTREAM_BUFFER * const pxStreamBuffer, const unsigned char *pucData, size_t xCount, size_t xIndex ) PRIVILEGED_FUNCTION;
+static size_t prvReadBytes( const xSTREAM_BUFFER * const pxStreamBuffer, unsigned char *pucData, size_t xCount, size_t xIndex ) PRIVILEGED_FUNCTION;
+
+/*
+ * Write a stream of up to xDataLengthBytes, or a whole message, given that
+ * xSpace bytes are free.  Return the number of bytes of pvTxData written.
+ */
+static size_t prvWriteToBuffer( xSTREAM_BUFFER * const pxStreamBuffer, const void *pvTxData, size_t xDataLengthBytes, size_t xSpace ) PRIVILEGED_FUNCTION;
+
+/*
+ * Read up to xBufferLengthBytes, or a whole message, given that xAvailable
+ * bytes are in the buffer.  Return the number of bytes read into pvRxData.
+ */
+static size_t prvReadFromBuffer( xSTREAM_BUFFER * const pxStreamBuffer, void *pvRxData, size_t xBufferLengthBytes, size_t xAvailable ) PRIVILEGED_FUNCTION;
+
+/*
+ * Block the calling task until the buffer has xSpaceRequired free bytes or
+ * holds more than xBytesRequired bytes, or until the timeout expires.  Return
+ * pdFALSE once the timeout has expired, otherwise pdTRUE to have the caller
+ * check the buffer again.
+ */
+static portBASE_TYPE prvWaitForSpace( xSTREAM_BUFFER * const pxStreamBuffer, size_t xSpaceRequired, xTimeOutType *pxTimeOut, portTickType *pxTicksToWait ) PRIVILEGED_FUNCTION;
+static portBASE_TYPE prvWaitForData( xSTREAM_BUFFER * const pxStreamBuffer, size_t xBytesRequired, xTimeOutType *pxTimeOut, portTickType *pxTicksToWait ) PRIVILEGED_FUNCTION;
+
+/*
+ * Unblock the reader if it is waiting and the trigger level has been
+ * reached, or unblock the writer if it is waiting, after the buffer has been
+ * written or read respectively.  The FromISR versions are for use from an
+ * interrupt.
+ */
+static void prvSendCompleted( xSTREAM_BUFFER * const pxStreamBuffer ) PRIVILEGED_FUNCTION;
+static void prvSendCompletedFromISR( xSTREAM_BUFFER * const pxStreamBuffer, signed portBASE_TYPE *pxHigherPriorityTaskWoken ) PRIVILEGED_FUNCTION;
+static void prvReceiveCompleted( xSTREAM_BUFFER * const pxStreamBuffer ) PRIVILEGED_FUNCTION;
+static void prvReceiveCompletedFromISR( xSTREAM_BUFFER * const pxStreamBuffer, signed portBASE_TYPE *pxHigherPriorityTaskWoken ) PRIVILEGED_FUNCTION;
+
+/*-----------------------------------------------------------*/
+
+xStreamBufferHandle xStreamBufferGenericCreate( size_t xBufferSizeBytes, size_t xTriggerLevelBytes, portBASE_TYPE xIsMessageBuffer )
+{
+xSTREAM_BUFFER *pxStreamBuffer;
+
+	if( xIsMessageBuffer != pdFALSE )
+	{
+		/* A waiting reader is unblocked as soon as a message is written. */
+		configASSERT( xBufferSizeBytes > sbBYTES_TO_STORE_MESSAGE_LENGTH );
+		xTriggerLevelBytes = ( size_t ) 1;
+	}
+	else
+	{
+		configASSERT( xBufferSizeBytes > ( size_t ) 0 );
+	}
+
+	if( xTriggerLevelBytes == ( size_t ) 0 )
+	{
+		xTriggerLevelBytes = ( size_t ) 1;
+	}
+
+	configASSERT( xTriggerLevelBytes <= xBufferSizeBytes );
+
+	/* The structure and the storage are allocated together.  One extra byte
+	of storage is used so that a full buffer can be told from an empty one. */
+	pxStreamBuffer = ( xSTREAM_BUFFER * ) pvPortMalloc( sizeof( xSTREAM_BUFFER ) + xBufferSizeBytes + ( size_t ) 1 );
+
+	if( pxStreamBuffer != NULL )
+	{
+		memset( ( void * ) pxStreamBuffer, 0x00, sizeof( xSTREAM_BUFFER ) );
+		pxStreamBuffer->pucBuffer = ( unsigned char * ) ( pxStreamBuffer + 1 );
+		pxStreamBuffer->xLength = xBufferSizeBytes + ( size_t ) 1;
+		pxStreamBuffer->xTriggerLevelBytes = xTriggerLevelBytes;
+
+		if( xIsMessageBuffer != pdFALSE )
+		{
+			pxStreamBuffer->ucFlags |= sbFLAGS_IS_MESSAGE_BUFFER;
+		}
+	}
+
+	return ( xStreamBufferHandle ) pxStreamBuffer;
+}
+/*-----------------------------------------------------------*/
+
+void vStreamBufferDelete( xStreamBufferHandle xStreamBuffer )
+{
+xSTREAM_BUFFER * const pxStreamBuffer = ( xSTREAM_BUFFER * ) xStreamBuffer;
+
+	configASSERT( pxStreamBuffer );
+	configASSERT( pxStreamBuffer->xTaskWaitingToReceive == NULL );
+	configASSERT( pxStreamBuffer->xTaskWaitingToSend == NULL );
+
+	vPortFree( ( void * ) pxStreamBuffer );
+}
+/*-----------------------------------------------------------*/
+
+portBASE_TYPE xStreamBufferReset( xStreamBufferHandle xStreamBuffer )
+{
+xSTREAM_BUFFER * const pxStreamBuffer = ( xSTREAM_BUFFER * ) xStreamBuffer;
+portBASE_TYPE xReturn = pdFAIL;
+
+	configASSERT( pxStreamBuffer );
+
+	taskENTER_CRITICAL();
+	{
+		/* The buffer cannot be emptied from under a task that is blocked on
+		it. */
+		if( ( pxStreamBuffer->xTaskWaitingToReceive == NULL ) && ( pxStreamBuffer->xTaskWaitingToSend == NULL ) )
+		{
+			pxStreamBuffer->xHead = ( size_t ) 0;
+			pxStreamBuffer->xTail = ( size_t ) 0;
+			xReturn = pdPASS;
+		}
+	}
+	taskEXIT_CRITICAL();
+
+	return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+portBASE_TYPE xStreamBufferSetTriggerLevel( xStreamBufferHandle xStreamBuffer, size_t xTriggerLevel )
+{
+xSTREAM_BUFFER * const pxStreamBuffer = ( xSTREAM_BUFFER * ) xStreamBuffer;
+portBASE_TYPE xReturn;
+
+	configASSERT( pxStreamBuffer );
+
+	if( xTriggerLevel == ( size_t ) 0 )
+	{
+		xTriggerLevel = ( size_t ) 1;
+	}
+
+	if( xTriggerLevel < pxStreamBuffer->xLength )
+	{
+		pxStreamBuffer->xTriggerLevelBytes = xTriggerLevel;
+		xReturn = pdPASS;
+	}
+	else
+	{
+		xReturn = pdFAIL;
+	}
+
+	return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+size_t xStreamBufferSpacesAvailable( xStreamBufferHandle xStreamBuffer )
+{
+	configASSERT( xStreamBuffer );
+
+	return prvSpacesInBuffer( ( xSTREAM_BUFFER * ) xStreamBuffer );
+}
+/*-----------------------------------------------------------*/
+
+size_t xStreamBufferBytesAvailable( xStreamBufferHandle xStreamBuffer )
+{
+	configASSERT( xStreamBuffer );
+
+	return prvBytesInBuffer( ( xSTREAM_BUFFER * ) xStreamBuffer );
+}
+/*-----------------------------------------------------------*/
+
+portBASE_TYPE xStreamBufferIsEmpty( xStreamBufferHandle xStreamBuffer )
+{
+	configASSERT( xStreamBuffer );
+
+	return ( prvBytesInBuffer( ( xSTREAM_BUFFER * ) xStreamBuffer ) == ( size_t ) 0 ) ? pdTRUE : pdFALSE;
+}
+/*-----------------------------------------------------------*/
+
+portBASE_TYPE xStreamBufferIsFull( xStreamBufferHandle xStreamBuffer )
+{
+xSTREAM_BUFFER * const pxStreamBuffer = ( xSTREAM_BUFFER * ) xStreamBuffer;
+size_t xMinimumSpace;
+
+	configASSERT( pxStreamBuffer );
+
+	/* A message buffer is full when it cannot hold the length of another
+	message, let alone the message itself. */
+	if( ( pxStreamBuffer->ucFlags & sbFLAGS_IS_MESSAGE_BUFFER ) != ( unsigned char ) 0 )
+	{
+		xMinimumSpace = sbBYTES_TO_STORE_MESSAGE_LENGTH + ( size_t ) 1;
+	}
+	else
+	{
+		xMinimumSpace = ( size_t ) 1;
+	}
+
+	return ( prvSpacesInBuffer( pxStreamBuffer ) < xMinimumSpace ) ? pdTRUE : pdFALSE;
+}
+/*-----------------------------------------------------------*/
+
+size_t xStreamBufferNextMessageLengthBytes( xStreamBufferHandle xStreamBuffer )
+{
+xSTREAM_BUFFER * const pxStreamBuffer = ( xSTREAM_BUFFER * ) xStreamBuffer;
+configMESSAGE_BUFFER_LENGTH_TYPE xMessageLength = 0;
+
+	configASSERT( pxStreamBuffer );
+	configASSERT( ( pxStreamBuffer->ucFlags & sbFLAGS_IS_MESSAGE_BUFFER ) != ( unsigned char ) 0 );
+
+	if( prvBytesInBuffer( pxStreamBuffer ) > sbBYTES_TO_STORE_MESSAGE_LENGTH )
+	{
+		( void ) prvReadBytes( pxStreamBuffer, ( unsigned char * ) &xMessageLength, sbBYTES_TO_STORE_MESSAGE_LENGTH, pxStreamBuffer->xTail );
+	}
+
+	return ( size_t ) xMessageLength;
+}
+/*-----------------------------------------------------------*/
+
+size_t xStreamBufferSend( xStreamBufferHandle xStreamBuffer, const void *pvTxData, size_t xDataLengthBytes, portTickType xTicksToWait )
+{
+xSTREAM_BUFFER * const pxStreamBuffer = ( xSTREAM_BUFFER * ) xStreamBuffer;
+const unsigned char *pucTxData = ( const unsigned char * ) pvTxData;
+size_t xReturn = 0, xSpace, xSpaceRequired, xWritten;
+xTimeOutType xTimeOut;
+
+	configASSERT( pxStreamBuffer );
+	configASSERT( pvTxData );
+
+	if( ( pxStreamBuffer->ucFlags & sbFLAGS_IS_MESSAGE_BUFFER ) != ( unsigned char ) 0 )
+	{
+		/* A message is only ever written whole, so it must fit in the
+		buffer along with its length. */
+		xSpaceRequired = xDataLengthBytes + sbBYTES_TO_STORE_MESSAGE_LENGTH;
+		configASSERT( xSpaceRequired < pxStreamBuffer->xLength );
+	}
+	else
+	{
+		/* A stream is written as the space becomes free. */
+		xSpaceRequired = ( size_t ) 1;
+	}
+
+	vTaskSetTimeOutState( &xTimeOut );
+
+	while( xDataLengthBytes > ( size_t ) 0 )
+	{
+		xSpace = prvSpacesInBuffer( pxStreamBuffer );
+
+		if( xSpace >= xSpaceRequired )
+		{
+			xWritten = prvWriteToBuffer( pxStreamBuffer, pucTxData, xDataLengthBytes, xSpace );
+			prvSendCompleted( pxStreamBuffer );
+
+			xReturn += xWritten;
+			pucTxData += xWritten;
+			xDataLengthBytes -= xWritten;
+		}
+		else if( prvWaitForSpace( pxStreamBuffer, xSpaceRequired, &xTimeOut, &xTicksToWait ) == pdFALSE )
+		{
+			break;
+		}
+	}
+
+	return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+size_t xStreamBufferSendFromISR( xStreamBufferHandle xStreamBuffer, const void *pvTxData, size_t xDataLengthBytes, signed portBASE_TYPE *pxHigherPriorityTaskWoken )
+{
+xSTREAM_BUFFER * const pxStreamBuffer = ( xSTREAM_BUFFER * ) xStreamBuffer;
+size_t xReturn;
+
+	configASSERT( pxStreamBuffer );
+	configASSERT( pvTxData );
+
+	xReturn = prvWriteToBuffer( pxStreamBuffer, pvTxData, xDataLengthBytes, prvSpacesInBuffer( pxStreamBuffer ) );
+
+	if( xReturn > ( size_t ) 0 )
+	{
+		prvSendCompletedFromISR( pxStreamBuffer, pxHigherPriorityTaskWoken );
+	}
+
+	return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+size_t xStreamBufferReceive( xStreamBufferHandle xStreamBuffer, void *pvRxData, size_t xBufferLengthBytes, portTickType xTicksToWait )
+{
+xSTREAM_BUFFER * const pxStreamBuffer = ( xSTREAM_BUFFER * ) xStreamBuffer;
+size_t xReturn = 0, xAvailable, xBytesRequired;
+xTimeOutType xTimeOut;
+
+	configASSERT( pxStreamBuffer );
+	configASSERT( pvRxData );
+
+	/* A message buffer holds the length of each message ahead of it, so
+	holding no more than the length means the buffer is empty. */
+	if( ( pxStreamBuffer->ucFlags & sbFLAGS_IS_MESSAGE_BUFFER ) != ( unsigned char ) 0 )
+	{
+		xBytesRequired = sbBYTES_TO_STORE_MESSAGE_LENGTH;
+	}
+	else
+	{
+		xBytesRequired = ( size_t ) 0;
+	}
+
+	vTaskSetTimeOutState( &xTimeOut );
+
+	for( ;; )
+	{
+		xAvailable = prvBytesInBuffer( pxStreamBuffer );
+
+		if( xAvailable > xBytesRequired )
+		{
+			xReturn = prvReadFromBuffer( pxStreamBuffer, pvRxData, xBufferLengthBytes, xAvailable );
+
+			if( xReturn > ( size_t ) 0 )
+			{
+				prvReceiveCompleted( pxStreamBuffer );
+			}
+
+			break;
+		}
+		else if( prvWaitForData( pxStreamBuffer, xBytesRequired, &xTimeOut, &xTicksToWait ) == pdFALSE )
+		{
+			break;
+		}
+	}
+
+	return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+size_t xStreamBufferReceiveFromISR( xStreamBufferHandle xStreamBuffer, void *pvRxData, size_t xBufferLengthBytes, signed portBASE_TYPE *pxHigherPriorityTaskWoken )
+{
+xSTREAM_BUFFER * const pxStreamBuffer = ( xSTREAM_BUFFER * ) xStreamBuffer;
+size_t xReturn;
+
+	configASSERT( pxStreamBuffer );
+	configASSERT( pvRxData );
+
+	xReturn = prvReadFromBuffer( pxStreamBuffer, pvRxData, xBufferLengthBytes, prvBytesInBuffer( pxStreamBuffer ) );
+
+	if( xReturn > ( size_t ) 0 )
+	{
+		prvReceiveCompletedFromISR( pxStreamBuffer, pxHigherPriorityTaskWoken );
+	}
+
+	return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+size_t xStreamBufferGetWritePointer( xStreamBufferHandle xStreamBuffer, void **ppvWrite )
+{
+xSTREAM_BUFFER * const pxStreamBuffer = ( xSTREAM_BUFFER * ) xStreamBuffer;
+size_t xHead, xContiguous, xSpace;
+
+	configASSERT( pxStreamBuffer );
+	configASSERT( ppvWrite );
+	configASSERT( ( pxStreamBuffer->ucFlags & sbFLAGS_IS_MESSAGE_BUFFER ) == ( unsigned char ) 0 );
+
+	xHead = pxStreamBuffer->xHead;
+	xSpace = prvSpacesInBuffer( pxStreamBuffer );
+
+	/* The free space may wrap around the end of the storage, in which case
+	only the part up to the end is contiguous. */
+	xContiguous = pxStreamBuffer->xLength - xHead;
+
+	if( xContiguous > xSpace )
+	{
+		xContiguous = xSpace;
+	}
+
+	*ppvWrite = ( void * ) &( pxStreamBuffer->pucBuffer[ xHead ] );
+
+	return xContiguous;
+}
+/*-----------------------------------------------------------*/
+
+void vStreamBufferCommitWrite( xStreamBufferHandle xStreamBuffer, size_t xBytesWritten )
+{
+xSTREAM_BUFFER * const pxStreamBuffer = ( xSTREAM_BUFFER * ) xStreamBuffer;
+size_t xHead;
+
+	configASSERT( pxStreamBuffer );
+	configASSERT( xBytesWritten <= prvSpacesInBuffer( pxStreamBuffer ) );
+
+	xHead = pxStreamBuffer->xHead + xBytesWritten;
+
+	if( xHead >= pxStreamBuffer->xLength )
+	{
+		xHead -= pxStreamBuffer->xLength;
+	}
+
+	sbCOMPILER_BARRIER();
+	pxStreamBuffer->xHead = xHead;
+
+	prvSendCompleted( pxStreamBuffer );
+}
+/*-----------------------------------------------------------*/
+
+void vStreamBufferCommitWriteFromISR( xStreamBufferHandle xStreamBuffer, size_t xBytesWritten, signed portBASE_TYPE *pxHigherPriorityTaskWoken )
+{
+xSTREAM_BUFFER * const pxStreamBuffer = ( xSTREAM_BUFFER * ) xStreamBuffer;
+size_t xHead;
+
+	configASSERT( pxStreamBuffer );
+	configASSERT( xBytesWritten <= prvSpacesInBuffer( pxStreamBuffer ) );
+
+	xHead = pxStreamBuffer->xHead + xBytesWritten;
+
+	if( xHead >= pxStreamBuffer->xLength )
+	{
+		xHead -= pxStreamBuffer->xLength;
+	}
+
+	sbCOMPILER_BARRIER();
+	pxStreamBuffer->xHead = xHead;
+
+	prvSendCompletedFromISR( pxStreamBuffer, pxHigherPriorityTaskWoken );
+}
+/*-----------------------------------------------------------*/
+
+size_t xStreamBufferGetReadPointer( xStreamBufferHandle xStreamBuffer, const void **ppvRead )
+{
+xSTREAM_BUFFER * const pxStreamBuffer = ( xSTREAM_BUFFER * ) xStreamBuffer;
+size_t xTail, xContiguous, xAvailable;
+
+	configASSERT( pxStreamBuffer );
+	configASSERT( ppvRead );
+	configASSERT( ( pxStreamBuffer->ucFlags & sbFLAGS_IS_MESSAGE_BUFFER ) == ( unsigned char ) 0 );
+
+	xTail = pxStreamBuffer->xTail;
+	xAvailable = prvBytesInBuffer( pxStreamBuffer );
+
+	/* The data may wrap around the end of the storage, in which case only
+	the part up to the end is contiguous. */
+	xContiguous = pxStreamBuffer->xLength - xTail;
+
+	if( xContiguous > xAvailable )
+	{
+		xContiguous = xAvailable;
+	}
+
+	*ppvRead = ( const void * ) &( pxStreamBuffer->pucBuffer[ xTail ] );
+
+	return xContiguous;
+}
+/*-----------------------------------------------------------*/
+
+void vStreamBufferConsume( xStreamBufferHandle xStreamBuffer, size_t xBytesRead )
+{
+xSTREAM_BUFFER * const pxStreamBuffer = ( xSTREAM_BUFFER * ) xStreamBuffer;
+size_t xTail;
+
+	configASSERT( pxStreamBuffer );
+	configASSERT( xBytesRead <= prvBytesInBuffer( pxStreamBuffer ) );
+
+	xTail = pxStreamBuffer->xTail + xBytesRead;
+
+	if( xTail >= pxStreamBuffer->xLength )
+	{
+		xTail -= pxStreamBuffer->xLength;
+	}
+
+	sbCOMPILER_BARRIER();
+	pxStreamBuffer->xTail = xTail;
+
+	prvReceiveCompleted( pxStreamBuffer );
+}
+/*-----------------------------------------------------------*/
+
+void vStreamBufferConsumeFromISR( xStreamBufferHandle xStreamBuffer, size_t xBytesRead, signed portBASE_TYPE *pxHigherPriorityTaskWoken )
+{
+xSTREAM_BUFFER * const pxStreamBuffer = ( xSTREAM_BUFFER * ) xStreamBuffer;
+size_t xTail;
+
+	configASSERT( pxStreamBuffer );
+	configASSERT( xBytesRead <= prvBytesInBuffer( pxStreamBuffer ) );
+
+	xTail = pxStreamBuffer->xTail + xBytesRead;
+
+	if( xTail >= pxStreamBuffer->xLength )
+	{
+		xTail -= pxStreamBuffer->xLength;
+	}
+
+	sbCOMPILER_BARRIER();
+	pxStreamBuffer->xTail = xTail;
+
+	prvReceiveCompletedFromISR( pxStreamBuffer, pxHigherPriorityTaskWoken );
+}
+/*-----------------------------------------------------------*/
+
+size_t xStreamBufferWaitForData( xStreamBufferHandle xStreamBuffer, portTickType xTicksToWait )
+{
+xSTREAM_BUFFER * const pxStreamBuffer = ( xSTREAM_BUFFER * ) xStreamBuffer;
+size_t xAvailable;
+xTimeOutType xTimeOut;
+
+	configASSERT( pxStreamBuffer );
+
+	vTaskSetTimeOutState( &xTimeOut );
+
+	for( ;; )
+	{
+		xAvailable = prvBytesInBuffer( pxStreamBuffer );
+
+		if( ( xAvailable > ( size_t ) 0 ) || ( prvWaitForData( pxStreamBuffer, ( size_t ) 0, &xTimeOut, &xTicksToWait ) == pdFALSE ) )
+		{
+			break;
+		}
+	}
+
+	return xAvailable;
+}
+/*-----------------------------------------------------------*/
+
+size_t xStreamBufferWaitForSpace( xStreamBufferHandle xStreamBuffer, size_t xSpaceRequired, portTickType xTicksToWait )
+{
+xSTREAM_BUFFER * const pxStreamBuffer = ( xSTREAM_BUFFER * ) xStreamBuffer;
+size_t xSpace;
+xTimeOutType xTimeOut;
+
+	configASSERT( pxStreamBuffer );
+	configASSERT( xSpaceRequired < pxStreamBuffer->xLength );
+
+	vTaskSetTimeOutState( &xTimeOut );
+
+	for( ;; )
+	{
+		xSpace = prvSpacesInBuffer( pxStreamBuffer );
+
+		if( ( xSpace >= xSpaceRequired ) || ( prvWaitForSpace( pxStreamBuffer, xSpaceRequired, &xTimeOut, &xTicksToWait ) == pdFALSE ) )
+		{
+			break;
+		}
+	}
+
+	return xSpace;
+}
+/*-----------------------------------------------------------*/
+
+static size_t prvBytesInBuffer( const xSTREAM_BUFFER * const pxStreamBuffer )
+{
+size_t xCount;
+
+	xCount = pxStreamBuffer->xLength + pxStreamBuffer->xHead;
+	xCount -= pxStreamBuffer->xTail;
+
+	if( xCount >= pxStreamBuffer->xLength )
+	{
+		xCount -= pxStreamBuffer->xLength;
+	}
+
+	return xCount;
+}
+/*-----------------------------------------------------------*/
+
+static size_t prvSpacesInBuffer( const xSTREAM_BUFFER * const pxStreamBuffer )
+{
+size_t xSpace;
+
+	xSpace = pxStreamBuffer->xLength + pxStreamBuffer->xTail;
+	xSpace -= pxStreamBuffer->xHead;
+	xSpace -= ( size_t ) 1;
+
+	if( xSpace >= pxStreamBuffer->xLength )
+	{
+		xSpace -= pxStreamBuffer->xLength;
+	}
+
+	return xSpace;
+}
+/*-----------------------------------------------------------*/
+
+static size_t prvWriteBytes( xSTREAM_BUFFER * const pxStreamBuffer, const unsigned char *pucData, size_t xCount, size_t xIndex )
+{
+size_t xFirst;
+
+	/* Copy up to the end of the storage, then wrap to the start for the
+	remainder. */
+	xFirst = pxStreamBuffer->xLength - xIndex;
+
+	if( xFirst > xCount )
+	{
+		xFirst = xCount;
+	}
+
+	memcpy( ( void * ) &( pxStreamBuffer->pucBuffer[ xIndex ] ), ( const void * ) pucData, xFirst );
+
+	if( xCount > xFirst )
+	{
+		memcpy( ( void * ) pxStreamBuffer->pucBuffer, ( const void * ) &( pucData[ xFirst ] ), xCount - xFirst );
+	}
+
+	xIndex += xCount;
+
+	if( xIndex >= pxStreamBuffer->xLength )
+	{
+		xIndex -= pxStreamBuffer->xLength;
+	}
+
+	return xIndex;
+}
+/*-----------------------------------------------------------*/
+
+static size_t prvReadBytes( const xSTREAM_BUFFER * const pxStreamBuffer, unsigned char *pucData, size_t xCount, size_t xIndex )
+{
+size_t xFirst;
+
+	xFirst = pxStreamBuffer->xLength - xIndex;
+
+	if( xFirst > xCount )
+	{
+		xFirst = xCount;
+	}
+
+	memcpy( ( void * ) pucData, ( const void * ) &( pxStreamBuffer->pucBuffer[ xIndex ] ), xFirst );
+
+	if( xCount > xFirst )
+	{
+		memcpy( ( void * ) &( pucData[ xFirst ] ), ( const void * ) pxStreamBuffer->pucBuffer, xCount - xFirst );
+	}
+
+	xIndex += xCount;
+
+	if( xIndex >= pxStreamBuffer->xLength )
+	{
+		xIndex -= pxStreamBuffer->xLength;
+	}
+
+	return xIndex;
+}
+/*-----------------------------------------------------------*/
+
+static size_t prvWriteToBuffer( xSTREAM_BUFFER * const pxStreamBuffer, const void *pvTxData, size_t xDataLengthBytes, size_t xSpace )
+{
+configMESSAGE_BUFFER_LENGTH_TYPE xMessageLength;
+size_t xHead;
+
+	xHead = pxStreamBuffer->xHead;
+
+	if( ( pxStreamBuffer->ucFlags & sbFLAGS_IS_MESSAGE_BUFFER ) != ( unsigned char ) 0 )
+	{
+		/* The message is written whole or not at all.  The length is written
+		first, but the reader sees neither until the head is moved. */
+		if( xSpace >= ( xDataLengthBytes + sbBYTES_TO_STORE_MESSAGE_LENGTH ) )
+		{
+			xMessageLength = ( configMESSAGE_BUFFER_LENGTH_TYPE ) xDataLengthBytes;
+			configASSERT( ( size_t ) xMessageLength == xDataLengthBytes );
+			xHead = prvWriteBytes( pxStreamBuffer, ( const unsigned char * ) &xMessageLength, sbBYTES_TO_STORE_MESSAGE_LENGTH, xHead );
+		}
+		else
+		{
+			xDataLengthBytes = ( size_t ) 0;
+		}
+	}
+	else if( xDataLengthBytes > xSpace )
+	{
+		xDataLengthBytes = xSpace;
+	}
+
+	if( xDataLengthBytes > ( size_t ) 0 )
+	{
+		xHead = prvWriteBytes( pxStreamBuffer, ( const unsigned char * ) pvTxData, xDataLengthBytes, xHead );
+
+		/* Only hand the data to the reader once it is all in place. */
+		sbCOMPILER_BARRIER();
+		pxStreamBuffer->xHead = xHead;
+	}
+
+	return xDataLengthBytes;
+}
+/*-----------------------------------------------------------*/
+
+static size_t prvReadFromBuffer( xSTREAM_BUFFER * const pxStreamBuffer, void *pvRxData, size_t xBufferLengthBytes, size_t xAvailable )
+{
+configMESSAGE_BUFFER_LENGTH_TYPE xMessageLength;
+size_t xTail;
+
+	xTail = pxStreamBuffer->xTail;
+
+	if( ( pxStreamBuffer->ucFlags & sbFLAGS_IS_MESSAGE_BUFFER ) != ( unsigned char ) 0 )
+	{
+		/* A message is only read whole, so it is left in the buffer if it
+		will not fit in pvRxData. */
+		if( xAvailable > sbBYTES_TO_STORE_MESSAGE_LENGTH )
+		{
+			xTail = prvReadBytes( pxStreamBuffer, ( unsigned char * ) &xMessageLength, sbBYTES_TO_STORE_MESSAGE_LENGTH, xTail );
+
+			if( ( size_t ) xMessageLength <= xBufferLengthBytes )
+			{
+				xBufferLengthBytes = ( size_t ) xMessageLength;
+			}
+			else
+			{
+				xBufferLengthBytes = ( size_t ) 0;
+			}
+		}
+		else
+		{
+			xBufferLengthBytes = ( size_t ) 0;
+		}
+	}
+	else if( xBufferLengthBytes > xAvailable )
+	{
+		xBufferLengthBytes = xAvailable;
+	}
+
+	if( xBufferLengthBytes > ( size_t ) 0 )
+	{
+		xTail = prvReadBytes( pxStreamBuffer, ( unsigned char * ) pvRxData, xBufferLengthBytes, xTail );
+
+		/* Only hand the space back to the writer once the data has been
+		copied out of it. */
+		sbCOMPILER_BARRIER();
+		pxStreamBuffer->xTail = xTail;
+	}
+
+	return xBufferLengthBytes;
+}
+/*-----------------------------------------------------------*/
+
+static portBASE_TYPE prvWaitForSpace( xSTREAM_BUFFER * const pxStreamBuffer, size_t xSpaceRequired, xTimeOutType *pxTimeOut, portTickType *pxTicksToWait )
+{
+portBASE_TYPE xWait = pdFALSE;
+
+	if( xTaskCheckForTimeOut( pxTimeOut, pxTicksToWait ) != pdFALSE )
+	{
+		return pdFALSE;
+	}
+
+	taskENTER_CRITICAL();
+	{
+		/* Check again now that the reader cannot run.  If the space is still
+		not there the reader will see this task waiting once it has freed
+		some. */
+		if( prvSpacesInBuffer( pxStreamBuffer ) < xSpaceRequired )
+		{
+			( void ) xTaskNotifyStateClear( NULL );
+
+			/* There can only be one writer. */
+			configASSERT( pxStreamBuffer->xTaskWaitingToSend == NULL );
+			pxStreamBuffer->xTaskWaitingToSend = xTaskGetCurrentTaskHandle();
+			xWait = pdTRUE;
+		}
+	}
+	taskEXIT_CRITICAL();
+
+	if( xWait != pdFALSE )
+	{
+		( void ) xTaskNotifyWait( ( unsigned long ) 0, ( unsigned long ) 0, NULL, *pxTicksToWait );
+		pxStreamBuffer->xTaskWaitingToSend = NULL;
+	}
+
+	return pdTRUE;
+}
+/*-----------------------------------------------------------*/
+
+static portBASE_TYPE prvWaitForData( xSTREAM_BUFFER * const pxStreamBuffer, size_t xBytesRequired, xTimeOutType *pxTimeOut, portTickType *pxTicksToWait )
+{
+portBASE_TYPE xWait = pdFALSE;
+
+	if( xTaskCheckForTimeOut( pxTimeOut, pxTicksToWait ) != pdFALSE )
+	{
+		return pdFALSE;
+	}
+
+	taskENTER_CRITICAL();
+	{
+		if( prvBytesInBuffer( pxStreamBuffer ) <= xBytesRequired )
+		{
+			( void ) xTaskNotifyStateClear( NULL );
+
+			/* There can only be one reader. */
+			configASSERT( pxStreamBuffer->xTaskWaitingToReceive == NULL );
+			pxStreamBuffer->xTaskWaitingToReceive = xTaskGetCurrentTaskHandle();
+			xWait = pdTRUE;
+		}
+	}
+	taskEXIT_CRITICAL();
+
+	if( xWait != pdFALSE )
+	{
+		( void ) xTaskNotifyWait( ( unsigned long ) 0, ( unsigned long ) 0, NULL, *pxTicksToWait );
+		pxStreamBuffer->xTaskWaitingToReceive = NULL;
+	}
+
+	return pdTRUE;
+}
+/*-----------------------------------------------------------*/
+
+static void prvSendCompleted( xSTREAM_BUFFER * const pxStreamBuffer )
+{
+	/* The head has already been moved, so a reader that is not yet shown as
+	waiting will see the new data when it checks again before blocking.  This
+	keeps the critical section off the path where nobody is waiting. */
+	if( ( pxStreamBuffer->xTaskWaitingToReceive != NULL ) && ( prvBytesInBuffer( pxStreamBuffer ) >= pxStreamBuffer->xTriggerLevelBytes ) )
+	{
+		taskENTER_CRITICAL();
+		{
+			if( pxStreamBuffer->xTaskWaitingToReceive != NULL )
+			{
+				( void ) xTaskNotify( pxStreamBuffer->xTaskWaitingToReceive, ( unsigned long ) 0, eNoAction );
+				pxStreamBuffer->xTaskWaitingToReceive = NULL;
+			}
+		}
+		taskEXIT_CRITICAL();
+	}
+}
+/*-----------------------------------------------------------*/
+
+static void prvSendCompletedFromISR( xSTREAM_BUFFER * const pxStreamBuffer, signed portBASE_TYPE *pxHigherPriorityTaskWoken )
+{
+unsigned portBASE_TYPE uxSavedInterruptStatus;
+
+	if( ( pxStreamBuffer->xTaskWaitingToReceive != NULL ) && ( prvBytesInBuffer( pxStreamBuffer ) >= pxStreamBuffer->xTriggerLevelBytes ) )
+	{
+		uxSavedInterruptStatus = portSET_INTERRUPT_MASK_FROM_ISR();
+		{
+			if( pxStreamBuffer->xTaskWaitingToReceive != NULL )
+			{
+				( void ) xTaskNotifyFromISR( pxStreamBuffer->xTaskWaitingToReceive, ( unsigned long ) 0, eNoAction, pxHigherPriorityTaskWoken );
+				pxStreamBuffer->xTaskWaitingToReceive = NULL;
+			}
+		}
+		portCLEAR_INTERRUPT_MASK_FROM_ISR( uxSavedInterruptStatus );
+	}
+}
+/*-----------------------------------------------------------*/
+
+static void prvReceiveCompleted( xSTREAM_BUFFER * const pxStreamBuffer )
+{
+	/* See the comment in prvSendCompleted(). */
+	if( pxStreamBuffer->xTaskWaitingToSend != NULL )
+	{
+		taskENTER_CRITICAL();
+		{
+			if( pxStreamBuffer->xTaskWaitingToSend != NULL )
+			{
+				( void ) xTaskNotify( pxStreamBuffer->xTaskWaitingToSend, ( unsigned long ) 0, eNoAction );
+				pxStreamBuffer->xTaskWaitingToSend = NULL;
+			}
+		}
+		taskEXIT_CRITICAL();
+	}
+}
+/*-----------------------------------------------------------*/
+
+static void prvReceiveCompletedFromISR( xSTREAM_BUFFER * const pxStreamBuffer, signed portBASE_TYPE *pxHigherPriorityTaskWoken )
+{
+unsigned portBASE_TYPE uxSavedInterruptStatus;
+
+	if( pxStreamBuffer->xTaskWaitingToSend != NULL )
+	{
+		uxSavedInterruptStatus = portSET_INTERRUPT_MASK_FROM_ISR();
+		{
+			if( pxStreamBuffer->xTaskWaitingToSend != NULL )
+			{
+				( void ) xTaskNotifyFromISR( pxStreamBuffer->xTaskWaitingToSend, ( unsigned long ) 0, eNoAction, pxHigherPriorityTaskWoken );
+				pxStreamBuffer->xTaskWaitingToSend = NULL;
+			}
+		}
+		portCLEAR_INTERRUPT_MASK_FROM_ISR( uxSavedInterruptStatus );
+	}
+}
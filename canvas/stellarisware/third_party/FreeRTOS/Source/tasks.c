@@ -86,6 +86,14 @@ task.h is included from an application file. */
  */
 #define tskIDLE_STACK_SIZE	configMINIMAL_STACK_SIZE
 
+/* Values that can be assigned to the eNotifyState member of the TCB. */
+typedef enum
+{
+	eNotWaitingNotification = 0,
+	eWaitingNotification,
+	eNotified
+} eNotifyValue;
+
 /*
  * Task control block.  A task control block (TCB) is allocated to each task,
  * and stores the context of the task.
@@ -129,6 +137,11 @@ typedef struct tskTaskControlBlock
 		unsigned long ulRunTimeCounter;		/*< Used for calculating how much CPU time each task is utilising. */
 	#endif
 
+	#if ( configUSE_TASK_NOTIFICATIONS == 1 )
+		volatile unsigned long ulNotifiedValue;	/*< The value written by the last notification sent to the task. */
+		volatile eNotifyValue eNotifyState;		/*< Whether the task is waiting for, or has been sent, a notification. */
+	#endif
+
 } tskTCB;
 
 
@@ -346,6 +359,35 @@ static portTASK_FUNCTION_PROTO( prvIdleTask, pvParameters );
  */
 static void prvCheckTasksWaitingTermination( void ) PRIVILEGED_FUNCTION;
 
+/*
+ * Used only by the idle task when configUSE_TICKLESS_IDLE is 1.  Returns the
+ * number of ticks until the next task is due to leave the Blocked state, or
+ * zero if a task other than the idle task is able to run.
+ */
+#if ( configUSE_TICKLESS_IDLE != 0 )
+
+	static portTickType prvGetExpectedIdleTime( void ) PRIVILEGED_FUNCTION;
+
+#endif
+
+/*
+ * Used by the task notification functions.  prvUpdateNotifiedValue() applies
+ * eAction to the notification value of pxTCB, and must be called with
+ * interrupts masked.  prvBlockForNotification() moves the calling task from
+ * the ready list to the appropriate blocked list, and must be called from
+ * within a critical section.  prvTakeNotifiedCount() and prvTakeNotification()
+ * consume the calling task's notification once it has been received or the
+ * wait has timed out, and must also be called from within a critical section.
+ */
+#if ( configUSE_TASK_NOTIFICATIONS == 1 )
+
+	static portBASE_TYPE prvUpdateNotifiedValue( tskTCB *pxTCB, unsigned long ulValue, eNotifyAction eAction, unsigned long *pulPreviousNotificationValue, eNotifyValue *peOriginalNotifyState ) PRIVILEGED_FUNCTION;
+	static void prvBlockForNotification( portTickType xTicksToWait ) PRIVILEGED_FUNCTION;
+	static unsigned long prvTakeNotifiedCount( portBASE_TYPE xClearCountOnExit ) PRIVILEGED_FUNCTION;
+	static portBASE_TYPE prvTakeNotification( unsigned long ulBitsToClearOnExit, unsigned long *pulNotificationValue ) PRIVILEGED_FUNCTION;
+
+#endif
+
 /*
  * The currently executing task is entering the Blocked state.  Add the task to
  * either the current or the overflow delayed task list.
@@ -1506,6 +1548,54 @@ tskTCB * pxTCB;
 }
 /*-----------------------------------------------------------*/
 
+#if ( configUSE_TICKLESS_IDLE != 0 )
+
+	void vTaskStepTick( portTickType xTicksToJump )
+	{
+		/* Correct the tick count value after a period during which the tick
+		was suppressed.  Note this does *not* call the tick hook function for
+		each stepped tick. */
+		configASSERT( ( xTickCount + xTicksToJump ) <= xNextTaskUnblockTime );
+		xTickCount += xTicksToJump;
+	}
+	/*-----------------------------------------------------------*/
+
+	eSleepModeStatus eTaskConfirmSleepModeStatus( void )
+	{
+	eSleepModeStatus eReturn = eStandardSleep;
+
+		if( listCURRENT_LIST_LENGTH( &xPendingReadyList ) != 0 )
+		{
+			/* A task was made ready while the scheduler was suspended. */
+			eReturn = eAbortSleep;
+		}
+		else if( xMissedYield != pdFALSE )
+		{
+			/* A yield was pended while the scheduler was suspended. */
+			eReturn = eAbortSleep;
+		}
+		else
+		{
+			#if ( INCLUDE_vTaskSuspend == 1 )
+			{
+				/* If all the tasks are in the suspended list (which might
+				mean they have an infinite block time rather than actually
+				being suspended) then it is safe to turn all clocks off and
+				just wait for external interrupts. */
+				if( listCURRENT_LIST_LENGTH( &xSuspendedTaskList ) == ( uxCurrentNumberOfTasks - ( unsigned portBASE_TYPE ) 1 ) )
+				{
+					eReturn = eNoTasksWaitingTimeout;
+				}
+			}
+			#endif /* INCLUDE_vTaskSuspend */
+		}
+
+		return eReturn;
+	}
+	/*-----------------------------------------------------------*/
+
+#endif /* configUSE_TICKLESS_IDLE */
+
 #if ( configUSE_APPLICATION_TASK_TAG == 1 )
 
 	void vTaskSetApplicationTaskTag( xTaskHandle xTask, pdTASK_HOOK_CODE pxHookFunction )
@@ -1933,8 +2023,68 @@ static portTASK_FUNCTION( prvIdleTask, pvParameters )
 			vApplicationIdleHook();
 		}
 		#endif
+
+		#if ( configUSE_TICKLESS_IDLE != 0 )
+		{
+		portTickType xExpectedIdleTime;
+
+			/* Stop the tick interrupt and sleep until the next task is due to
+			unblock, unless that is too soon to be worthwhile.  The first test
+			is made without suspending the scheduler, so the scheduler is not
+			suspended and resumed each time round this loop. */
+			xExpectedIdleTime = prvGetExpectedIdleTime();
+
+			if( xExpectedIdleTime >= configEXPECTED_IDLE_TIME_BEFORE_SLEEP )
+			{
+				vTaskSuspendAll();
+				{
+					/* Now the scheduler is suspended the expected idle time
+					can be sampled again, and this time its value can be
+					used. */
+					configASSERT( xNextTaskUnblockTime >= xTickCount );
+					xExpectedIdleTime = prvGetExpectedIdleTime();
+
+					if( xExpectedIdleTime >= configEXPECTED_IDLE_TIME_BEFORE_SLEEP )
+					{
+						traceLOW_POWER_IDLE_BEGIN();
+						portSUPPRESS_TICKS_AND_SLEEP( xExpectedIdleTime );
+						traceLOW_POWER_IDLE_END();
+					}
+				}
+				xTaskResumeAll();
+			}
+		}
+		#endif
 	}
 } /*lint !e715 pvParameters is not accessed but all task functions require the same prototype. */
+/*-----------------------------------------------------------*/
+
+#if ( configUSE_TICKLESS_IDLE != 0 )
+
+	static portTickType prvGetExpectedIdleTime( void )
+	{
+	portTickType xReturn;
+
+		if( pxCurrentTCB->uxPriority > tskIDLE_PRIORITY )
+		{
+			xReturn = 0;
+		}
+		else if( listCURRENT_LIST_LENGTH( &( pxReadyTasksLists[ tskIDLE_PRIORITY ] ) ) > ( unsigned portBASE_TYPE ) 1 )
+		{
+			/* There are other idle priority tasks in the Ready state.  If
+			time slicing is used then the very next tick interrupt must be
+			processed. */
+			xReturn = 0;
+		}
+		else
+		{
+			xReturn = xNextTaskUnblockTime - xTickCount;
+		}
+
+		return xReturn;
+	}
+
+#endif /* configUSE_TICKLESS_IDLE */
 
 
 
@@ -2002,6 +2152,13 @@ static void prvInitialiseTCBVariables( tskTCB *pxTCB, const signed char * const
 	}
 	#endif
 
+	#if ( configUSE_TASK_NOTIFICATIONS == 1 )
+	{
+		pxTCB->ulNotifiedValue = 0UL;
+		pxTCB->eNotifyState = eNotWaitingNotification;
+	}
+	#endif
+
 	#if ( portUSING_MPU_WRAPPERS == 1 )
 	{
 		vPortStoreTaskMPUSettings( &( pxTCB->xMPUSettings ), xRegions, pxTCB->pxStack, usStackDepth );
@@ -2475,6 +2632,417 @@ void vTaskExitCritical( void )
 #endif
 /*-----------------------------------------------------------*/
 
+#if ( configUSE_TASK_NOTIFICATIONS == 1 )
+
+	static portBASE_TYPE prvUpdateNotifiedValue( tskTCB *pxTCB, unsigned long ulValue, eNotifyAction eAction, unsigned long *pulPreviousNotificationValue, eNotifyValue *peOriginalNotifyState )
+	{
+	portBASE_TYPE xReturn = pdPASS;
+
+		if( pulPreviousNotificationValue != NULL )
+		{
+			*pulPreviousNotificationValue = pxTCB->ulNotifiedValue;
+		}
+
+		*peOriginalNotifyState = pxTCB->eNotifyState;
+		pxTCB->eNotifyState = eNotified;
+
+		switch( eAction )
+		{
+			case eSetBits :
+				pxTCB->ulNotifiedValue |= ulValue;
+				break;
+
+			case eIncrement :
+				( pxTCB->ulNotifiedValue )++;
+				break;
+
+			case eSetValueWithOverwrite :
+				pxTCB->ulNotifiedValue = ulValue;
+				break;
+
+			case eSetValueWithoutOverwrite :
+				if( *peOriginalNotifyState != eNotified )
+				{
+					pxTCB->ulNotifiedValue = ulValue;
+				}
+				else
+				{
+					/* The value could not be written to the task. */
+					xReturn = pdFAIL;
+				}
+				break;
+
+			case eNoAction :
+			default :
+				/* The task is being notified without its notify value being
+				updated. */
+				break;
+		}
+
+		return xReturn;
+	}
+	/*-----------------------------------------------------------*/
+
+	static void prvBlockForNotification( portTickType xTicksToWait )
+	{
+	portTickType xTimeToWake;
+
+		/* The task is going to block.  First it must be removed from the
+		ready list.  A task waiting for a notification is not placed on an
+		event list - the notifying task finds it through its handle. */
+		vListRemove( ( xListItem * ) &( pxCurrentTCB->xGenericListItem ) );
+
+		#if ( INCLUDE_vTaskSuspend == 1 )
+		{
+			if( xTicksToWait == portMAX_DELAY )
+			{
+				/* Add the task to the suspended task list instead of a delayed
+				task list to ensure the task is not woken by a timing event.
+				It will block indefinitely. */
+				vListInsertEnd( ( xList * ) &xSuspendedTaskList, ( xListItem * ) &( pxCurrentTCB->xGenericListItem ) );
+			}
+			else
+			{
+				/* Calculate the time at which the task should be woken if no
+				notification is received.  This may overflow but this doesn't
+				matter. */
+				xTimeToWake = xTickCount + xTicksToWait;
+				prvAddCurrentTaskToDelayedList( xTimeToWake );
+			}
+		}
+		#else
+		{
+			xTimeToWake = xTickCount + xTicksToWait;
+			prvAddCurrentTaskToDelayedList( xTimeToWake );
+		}
+		#endif
+	}
+	/*-----------------------------------------------------------*/
+
+	unsigned long ulTaskNotifyTake( portBASE_TYPE xClearCountOnExit, portTickType xTicksToWait )
+	{
+	unsigned long ulReturn;
+	portBASE_TYPE xBlocked = pdFALSE;
+
+		taskENTER_CRITICAL();
+		{
+			/* Only block if the notification count is not already
+			non-zero. */
+			if( ( pxCurrentTCB->ulNotifiedValue == 0UL ) && ( xTicksToWait > ( portTickType ) 0 ) )
+			{
+				/* Mark this task as waiting for a notification. */
+				pxCurrentTCB->eNotifyState = eWaitingNotification;
+				prvBlockForNotification( xTicksToWait );
+				traceTASK_NOTIFY_TAKE_BLOCK();
+				xBlocked = pdTRUE;
+
+				/* All ports are written to allow a yield in a critical
+				section (some will yield immediately, others wait until
+				the critical section exits) - but it is not something that
+				application code should ever do. */
+				portYIELD_WITHIN_API();
+			}
+			else
+			{
+				/* The count is already non-zero, or the caller does not want
+				to wait, so the count can be taken without a second critical
+				section. */
+				ulReturn = prvTakeNotifiedCount( xClearCountOnExit );
+			}
+		}
+		taskEXIT_CRITICAL();
+
+		if( xBlocked != pdFALSE )
+		{
+			taskENTER_CRITICAL();
+			{
+				ulReturn = prvTakeNotifiedCount( xClearCountOnExit );
+			}
+			taskEXIT_CRITICAL();
+		}
+
+		return ulReturn;
+	}
+	/*-----------------------------------------------------------*/
+
+	static unsigned long prvTakeNotifiedCount( portBASE_TYPE xClearCountOnExit )
+	{
+	unsigned long ulReturn;
+
+		traceTASK_NOTIFY_TAKE();
+		ulReturn = pxCurrentTCB->ulNotifiedValue;
+
+		if( ulReturn != 0UL )
+		{
+			if( xClearCountOnExit != pdFALSE )
+			{
+				pxCurrentTCB->ulNotifiedValue = 0UL;
+			}
+			else
+			{
+				( pxCurrentTCB->ulNotifiedValue )--;
+			}
+		}
+
+		pxCurrentTCB->eNotifyState = eNotWaitingNotification;
+
+		return ulReturn;
+	}
+	/*-----------------------------------------------------------*/
+
+	portBASE_TYPE xTaskNotifyWait( unsigned long ulBitsToClearOnEntry, unsigned long ulBitsToClearOnExit, unsigned long *pulNotificationValue, portTickType xTicksToWait )
+	{
+	portBASE_TYPE xReturn;
+	portBASE_TYPE xBlocked = pdFALSE;
+
+		taskENTER_CRITICAL();
+		{
+			/* Only block if a notification is not already pending. */
+			if( pxCurrentTCB->eNotifyState != eNotified )
+			{
+				/* Clear bits in the task's notification value as bits may get
+				set by the notifying task or interrupt.  This can be used to
+				clear the value to zero. */
+				pxCurrentTCB->ulNotifiedValue &= ~ulBitsToClearOnEntry;
+
+				/* Mark this task as waiting for a notification. */
+				pxCurrentTCB->eNotifyState = eWaitingNotification;
+
+				if( xTicksToWait > ( portTickType ) 0 )
+				{
+					prvBlockForNotification( xTicksToWait );
+					traceTASK_NOTIFY_WAIT_BLOCK();
+					xBlocked = pdTRUE;
+
+					/* See the comment in ulTaskNotifyTake(). */
+					portYIELD_WITHIN_API();
+				}
+			}
+
+			if( xBlocked == pdFALSE )
+			{
+				xReturn = prvTakeNotification( ulBitsToClearOnExit, pulNotificationValue );
+			}
+		}
+		taskEXIT_CRITICAL();
+
+		if( xBlocked != pdFALSE )
+		{
+			taskENTER_CRITICAL();
+			{
+				xReturn = prvTakeNotification( ulBitsToClearOnExit, pulNotificationValue );
+			}
+			taskEXIT_CRITICAL();
+		}
+
+		return xReturn;
+	}
+	/*-----------------------------------------------------------*/
+
+	static portBASE_TYPE prvTakeNotification( unsigned long ulBitsToClearOnExit, unsigned long *pulNotificationValue )
+	{
+	portBASE_TYPE xReturn;
+
+		traceTASK_NOTIFY_WAIT();
+
+		if( pulNotificationValue != NULL )
+		{
+			/* Output the current notification value, which may or may not
+			have changed. */
+			*pulNotificationValue = pxCurrentTCB->ulNotifiedValue;
+		}
+
+		/* If eNotifyValue is set then either the task never entered the
+		blocked state (because a notification was already pending) or the
+		task unblocked because of a notification.  Otherwise the task
+		unblocked because of a timeout. */
+		if( pxCurrentTCB->eNotifyState == eWaitingNotification )
+		{
+			/* A notification was not received. */
+			xReturn = pdFALSE;
+		}
+		else
+		{
+			/* A notification was already pending or a notification was
+			received while the task was waiting. */
+			pxCurrentTCB->ulNotifiedValue &= ~ulBitsToClearOnExit;
+			xReturn = pdTRUE;
+		}
+
+		pxCurrentTCB->eNotifyState = eNotWaitingNotification;
+
+		return xReturn;
+	}
+	/*-----------------------------------------------------------*/
+
+	portBASE_TYPE xTaskGenericNotify( xTaskHandle xTaskToNotify, unsigned long ulValue, eNotifyAction eAction, unsigned long *pulPreviousNotificationValue )
+	{
+	tskTCB * pxTCB;
+	eNotifyValue eOriginalNotifyState;
+	portBASE_TYPE xReturn;
 
+		configASSERT( xTaskToNotify );
+		pxTCB = ( tskTCB * ) xTaskToNotify;
 
+		taskENTER_CRITICAL();
+		{
+			xReturn = prvUpdateNotifiedValue( pxTCB, ulValue, eAction, pulPreviousNotificationValue, &eOriginalNotifyState );
+			traceTASK_NOTIFY();
 
+			/* If the task is in the blocked state specifically to wait for a
+			notification then unblock it now. */
+			if( eOriginalNotifyState == eWaitingNotification )
+			{
+				/* The task should not have been on an event list. */
+				configASSERT( pxTCB->xEventListItem.pvContainer == NULL );
+
+				vListRemove( &( pxTCB->xGenericListItem ) );
+				prvAddTaskToReadyQueue( pxTCB );
+
+				if( pxTCB->uxPriority > pxCurrentTCB->uxPriority )
+				{
+					/* The notified task has a priority above the currently
+					executing task so a yield is required. */
+					portYIELD_WITHIN_API();
+				}
+			}
+		}
+		taskEXIT_CRITICAL();
+
+		return xReturn;
+	}
+	/*-----------------------------------------------------------*/
+
+	portBASE_TYPE xTaskGenericNotifyFromISR( xTaskHandle xTaskToNotify, unsigned long ulValue, eNotifyAction eAction, unsigned long *pulPreviousNotificationValue, signed portBASE_TYPE *pxHigherPriorityTaskWoken )
+	{
+	tskTCB * pxTCB;
+	eNotifyValue eOriginalNotifyState;
+	portBASE_TYPE xReturn;
+	unsigned portBASE_TYPE uxSavedInterruptStatus;
+
+		configASSERT( xTaskToNotify );
+		pxTCB = ( tskTCB * ) xTaskToNotify;
+
+		uxSavedInterruptStatus = portSET_INTERRUPT_MASK_FROM_ISR();
+		{
+			xReturn = prvUpdateNotifiedValue( pxTCB, ulValue, eAction, pulPreviousNotificationValue, &eOriginalNotifyState );
+			traceTASK_NOTIFY_FROM_ISR();
+
+			/* If the task is in the blocked state specifically to wait for a
+			notification then unblock it now. */
+			if( eOriginalNotifyState == eWaitingNotification )
+			{
+				/* The task should not have been on an event list. */
+				configASSERT( pxTCB->xEventListItem.pvContainer == NULL );
+
+				if( uxSchedulerSuspended == ( unsigned portBASE_TYPE ) pdFALSE )
+				{
+					vListRemove( &( pxTCB->xGenericListItem ) );
+					prvAddTaskToReadyQueue( pxTCB );
+				}
+				else
+				{
+					/* The delayed and ready lists cannot be accessed, so hold
+					this task pending until the scheduler is resumed. */
+					vListInsertEnd( ( xList * ) &( xPendingReadyList ), &( pxTCB->xEventListItem ) );
+				}
+
+				if( pxTCB->uxPriority > pxCurrentTCB->uxPriority )
+				{
+					/* The notified task has a priority above the currently
+					executing task so a yield is required. */
+					if( pxHigherPriorityTaskWoken != NULL )
+					{
+						*pxHigherPriorityTaskWoken = pdTRUE;
+					}
+				}
+			}
+		}
+		portCLEAR_INTERRUPT_MASK_FROM_ISR( uxSavedInterruptStatus );
+
+		return xReturn;
+	}
+	/*-----------------------------------------------------------*/
+
+	void vTaskNotifyGiveFromISR( xTaskHandle xTaskToNotify, signed portBASE_TYPE *pxHigherPriorityTaskWoken )
+	{
+	tskTCB * pxTCB;
+	eNotifyValue eOriginalNotifyState;
+	unsigned portBASE_TYPE uxSavedInterruptStatus;
+
+		configASSERT( xTaskToNotify );
+		pxTCB = ( tskTCB * ) xTaskToNotify;
+
+		uxSavedInterruptStatus = portSET_INTERRUPT_MASK_FROM_ISR();
+		{
+			eOriginalNotifyState = pxTCB->eNotifyState;
+			pxTCB->eNotifyState = eNotified;
+
+			/* 'Giving' is equivalent to incrementing a count in a counting
+			semaphore. */
+			( pxTCB->ulNotifiedValue )++;
+
+			traceTASK_NOTIFY_GIVE_FROM_ISR();
+
+			/* If the task is in the blocked state specifically to wait for a
+			notification then unblock it now. */
+			if( eOriginalNotifyState == eWaitingNotification )
+			{
+				/* The task should not have been on an event list. */
+				configASSERT( pxTCB->xEventListItem.pvContainer == NULL );
+
+				if( uxSchedulerSuspended == ( unsigned portBASE_TYPE ) pdFALSE )
+				{
+					vListRemove( &( pxTCB->xGenericListItem ) );
+					prvAddTaskToReadyQueue( pxTCB );
+				}
+				else
+				{
+					/* The delayed and ready lists cannot be accessed, so hold
+					this task pending until the scheduler is resumed. */
+					vListInsertEnd( ( xList * ) &( xPendingReadyList ), &( pxTCB->xEventListItem ) );
+				}
+
+				if( pxTCB->uxPriority > pxCurrentTCB->uxPriority )
+				{
+					/* The notified task has a priority above the currently
+					executing task so a yield is required. */
+					if( pxHigherPriorityTaskWoken != NULL )
+					{
+						*pxHigherPriorityTaskWoken = pdTRUE;
+					}
+				}
+			}
+		}
+		portCLEAR_INTERRUPT_MASK_FROM_ISR( uxSavedInterruptStatus );
+	}
+	/*-----------------------------------------------------------*/
+
+	portBASE_TYPE xTaskNotifyStateClear( xTaskHandle xTask )
+	{
+	tskTCB *pxTCB;
+	portBASE_TYPE xReturn;
+
+		/* If null is passed in here then it is the calling task that is
+		having its notification state cleared. */
+		pxTCB = prvGetTCBFromHandle( xTask );
+
+		taskENTER_CRITICAL();
+		{
+			if( pxTCB->eNotifyState == eNotified )
+			{
+				pxTCB->eNotifyState = eNotWaitingNotification;
+				xReturn = pdPASS;
+			}
+			else
+			{
+				xReturn = pdFAIL;
+			}
+		}
+		taskEXIT_CRITICAL();
+
+		return xReturn;
+	}
+
+#endif /* configUSE_TASK_NOTIFICATIONS */
+/*-----------------------------------------------------------*/
@@ -0,0 +1,736 @@
+//*****************************************************************************
+//
+// fat_bench.c - A benchmark suite for FatFs and the disk driver below it.
+//
+// The suite runs on any mounted drive, and prints its results through a
+// printf-like function, so that the same measurements can be taken on the
+// target over the UART and on the host against a disk image.
+//
+//*****************************************************************************
+
+#include "driverlib/debug.h"
+#include "fatfs/src/ff.h"
+#include "fat_bench.h"
+
+//*****************************************************************************
+//
+//! \addtogroup fat_bench_api
+//! @{
+//
+//*****************************************************************************
+
+//*****************************************************************************
+//
+// The directory that the suite works in, the file that is read and written
+// sequentially and at random, and the name of each of the small files, whose
+// digits are replaced by the number of the file.
+//
+//*****************************************************************************
+#define BENCH_DIR               "BENCH"
+#define BENCH_FILE              "BENCH.BIN"
+#define SMALL_FILE              "F0000.BIN"
+#define MAX_FILES               10000
+
+//*****************************************************************************
+//
+// The largest single read or write, which must fit in a WORD.
+//
+//*****************************************************************************
+#define MAX_CHUNK               32768
+
+//*****************************************************************************
+//
+// The parameters of the run in progress, and the objects used by the tests.
+// These are kept out of the stack, which is small on the target.
+//
+//*****************************************************************************
+static const tFatBenchParams *g_psParams;
+static FIL g_sFile;
+static DIR g_sDir;
+static FILINFO g_sInfo;
+static char g_pcPath[24];
+
+//*****************************************************************************
+//
+// The time spent in FatFs by the test in progress, the bytes it has moved,
+// and the disk driver counts when it started.
+//
+//*****************************************************************************
+static unsigned long g_ulElapsed;
+static unsigned long g_ulBytes;
+static unsigned long g_ulMark;
+static unsigned long g_ulCommands;
+static unsigned long g_ulSectors;
+
+//*****************************************************************************
+//
+// A simple pseudo random number generator, so that every run seeks to the
+// same offsets on every platform.
+//
+//*****************************************************************************
+static unsigned long g_ulRandom;
+
+static unsigned long
+Random(void)
+{
+    g_ulRandom = (g_ulRandom * 1664525) + 1013904223;
+    return((g_ulRandom >> 8) & 0xffffff);
+}
+
+//*****************************************************************************
+//
+// The value of the byte at a given offset in a file.  The seed differs
+// between files so that reading from the wrong file is caught.
+//
+//*****************************************************************************
+static unsigned char
+Pattern(unsigned long ulSeed, unsigned long ulOffset)
+{
+    return((unsigned char)(ulSeed ^ ulOffset ^ (ulOffset >> 8) ^
+                           (ulOffset >> 16)));
+}
+
+static void
+FillPattern(unsigned char *pucData, unsigned long ulSeed,
+            unsigned long ulOffset, unsigned long ulCount)
+{
+    while(ulCount--)
+    {
+        *pucData++ = Pattern(ulSeed, ulOffset++);
+    }
+}
+
+static FRESULT
+CheckPattern(const unsigned char *pucData, unsigned long ulSeed,
+             unsigned long ulOffset, unsigned long ulCount)
+{
+    while(ulCount--)
+    {
+        if(*pucData++ != Pattern(ulSeed, ulOffset))
+        {
+            g_psParams->pfnPrintf("Data mismatch at offset %u.\n", ulOffset);
+            return(FR_RW_ERROR);
+        }
+
+        ulOffset++;
+    }
+
+    return(FR_OK);
+}
+
+//*****************************************************************************
+//
+// Builds the path of the benchmark directory on the drive, or of a file in
+// it if a name is given.
+//
+//*****************************************************************************
+static const char *
+MakePath(const char *pcName)
+{
+    const char *pcDir;
+    char *pcPath;
+
+    pcPath = g_pcPath;
+    *pcPath++ = '0' + g_psParams->ucDrive;
+    *pcPath++ = ':';
+    *pcPath++ = '/';
+
+    for(pcDir = BENCH_DIR; *pcDir; )
+    {
+        *pcPath++ = *pcDir++;
+    }
+
+    if(pcName)
+    {
+        *pcPath++ = '/';
+        while(*pcName)
+        {
+            *pcPath++ = *pcName++;
+        }
+    }
+
+    *pcPath = '\0';
+
+    return(g_pcPath);
+}
+
+//*****************************************************************************
+//
+// Builds the path of one of the small files.
+//
+//*****************************************************************************
+static const char *
+MakeSmallPath(unsigned long ulFile)
+{
+    char pcName[sizeof(SMALL_FILE)];
+    unsigned long ulDigit;
+
+    for(ulDigit = 0; ulDigit < sizeof(SMALL_FILE); ulDigit++)
+    {
+        pcName[ulDigit] = SMALL_FILE[ulDigit];
+    }
+
+    for(ulDigit = 4; ulDigit > 0; ulDigit--)
+    {
+        pcName[ulDigit] = '0' + (ulFile % 10);
+        ulFile /= 10;
+    }
+
+    return(MakePath(pcName));
+}
+
+//*****************************************************************************
+//
+// Starts and stops the timer around FatFs calls, so that the time spent
+// generating and checking the data is not counted.
+//
+//*****************************************************************************
+static void
+TimerStart(void)
+{
+    g_ulMark = g_psParams->pfnMicroseconds();
+}
+
+static void
+TimerStop(void)
+{
+    g_ulElapsed += g_psParams->pfnMicroseconds() - g_ulMark;
+}
+
+//*****************************************************************************
+//
+// Starts a test, clearing the time and noting the disk driver counts.
+//
+//*****************************************************************************
+static void
+TestStart(void)
+{
+    g_ulElapsed = 0;
+    g_ulBytes = 0;
+
+    if(g_psParams->pfnDiskCounts)
+    {
+        g_psParams->pfnDiskCounts(&g_ulCommands, &g_ulSectors);
+    }
+}
+
+//*****************************************************************************
+//
+// Prints the results of a test: the number of operations and bytes, the
+// time taken, the throughput and the time per operation and, if the driver
+// counts them, the disk commands and sectors.
+//
+//*****************************************************************************
+static void
+TestReport(const char *pcTest, unsigned long ulOps)
+{
+    unsigned long ulCommands, ulSectors, ulRate, ulLen;
+    char pcName[16];
+
+    //
+    // Pad the name to the width of the column here, since UARTprintf() and
+    // printf() justify a padded string differently.
+    //
+    for(ulLen = 0; (ulLen < (sizeof(pcName) - 1)) && pcTest[ulLen]; ulLen++)
+    {
+        pcName[ulLen] = pcTest[ulLen];
+    }
+    while(ulLen < (sizeof(pcName) - 1))
+    {
+        pcName[ulLen++] = ' ';
+    }
+    pcName[ulLen] = '\0';
+
+    //
+    // Work out the throughput in KB/s without overflowing for large files.
+    //
+    ulRate = g_ulElapsed ? (unsigned long)(((unsigned long long)g_ulBytes *
+                                            1000000) / 1024 / g_ulElapsed) : 0;
+
+    g_psParams->pfnPrintf("%s%8u%11u%11u%9u%9u", pcName, ulOps, g_ulBytes,
+                          g_ulElapsed, ulRate, ulOps ? (g_ulElapsed / ulOps) :
+                          0);
+
+    if(g_psParams->pfnDiskCounts)
+    {
+        g_psParams->pfnDiskCounts(&ulCommands, &ulSectors);
+        g_psParams->pfnPrintf("%9u%9u", ulCommands - g_ulCommands,
+                              ulSectors - g_ulSectors);
+    }
+
+    g_psParams->pfnPrintf("\n");
+}
+
+//*****************************************************************************
+//
+// Writes the benchmark file from start to end in the largest chunks
+// possible.
+//
+//*****************************************************************************
+static FRESULT
+SequentialWrite(unsigned long *pulOps)
+{
+    unsigned long ulOffset, ulChunk;
+    FRESULT eResult;
+    WORD usWritten;
+
+    TimerStart();
+    eResult = f_open(&g_sFile, MakePath(BENCH_FILE),
+                     FA_WRITE | FA_CREATE_ALWAYS);
+    TimerStop();
+    if(eResult != FR_OK)
+    {
+        return(eResult);
+    }
+
+    for(ulOffset = 0; ulOffset < g_psParams->ulFileSize; ulOffset += ulChunk)
+    {
+        ulChunk = g_psParams->ulFileSize - ulOffset;
+        if(ulChunk > g_psParams->ulBufferSize)
+        {
+            ulChunk = g_psParams->ulBufferSize;
+        }
+        FillPattern(g_psParams->pucBuffer, 1, ulOffset, ulChunk);
+
+        TimerStart();
+        eResult = f_write(&g_sFile, g_psParams->pucBuffer, (WORD)ulChunk,
+                          &usWritten);
+        TimerStop();
+        if(eResult != FR_OK)
+        {
+            f_close(&g_sFile);
+            return(eResult);
+        }
+        if(usWritten != ulChunk)
+        {
+            f_close(&g_sFile);
+            return(FR_DENIED);
+        }
+
+        g_ulBytes += usWritten;
+        (*pulOps)++;
+    }
+
+    TimerStart();
+    eResult = f_close(&g_sFile);
+    TimerStop();
+
+    return(eResult);
+}
+
+//*****************************************************************************
+//
+// Reads the benchmark file from start to end in the largest chunks possible.
+//
+//*****************************************************************************
+static FRESULT
+SequentialRead(unsigned long *pulOps)
+{
+    unsigned long ulOffset;
+    FRESULT eResult;
+    WORD usRead;
+
+    TimerStart();
+    eResult = f_open(&g_sFile, MakePath(BENCH_FILE), FA_READ);
+    TimerStop();
+    if(eResult != FR_OK)
+    {
+        return(eResult);
+    }
+
+    for(ulOffset = 0; ulOffset < g_psParams->ulFileSize; ulOffset += usRead)
+    {
+        TimerStart();
+        eResult = f_read(&g_sFile, g_psParams->pucBuffer,
+                         (WORD)g_psParams->ulBufferSize, &usRead);
+        TimerStop();
+        if((eResult == FR_OK) && !usRead)
+        {
+            eResult = FR_RW_ERROR;
+        }
+        if(eResult == FR_OK)
+        {
+            eResult = CheckPattern(g_psParams->pucBuffer, 1, ulOffset,
+                                   usRead);
+        }
+        if(eResult != FR_OK)
+        {
+            f_close(&g_sFile);
+            return(eResult);
+        }
+
+        g_ulBytes += usRead;
+        (*pulOps)++;
+    }
+
+    TimerStart();
+    eResult = f_close(&g_sFile);
+    TimerStop();
+
+    return(eResult);
+}
+
+//*****************************************************************************
+//
+// Reads records from random offsets in the benchmark file.
+//
+//*****************************************************************************
+static FRESULT
+RandomRead(unsigned long *pulOps)
+{
+    unsigned long ulOffset;
+    FRESULT eResult;
+    WORD usRead;
+
+    TimerStart();
+    eResult = f_open(&g_sFile, MakePath(BENCH_FILE), FA_READ);
+    TimerStop();
+    if(eResult != FR_OK)
+    {
+        return(eResult);
+    }
+
+    g_ulRandom = 1;
+    for(*pulOps = 0; *pulOps < g_psParams->ulSeeks; (*pulOps)++)
+    {
+        ulOffset = Random() % (g_psParams->ulFileSize -
+                               g_psParams->ulRecordSize + 1);
+
+        TimerStart();
+        eResult = f_lseek(&g_sFile, ulOffset);
+        if(eResult == FR_OK)
+        {
+            eResult = f_read(&g_sFile, g_psParams->pucBuffer,
+                             (WORD)g_psParams->ulRecordSize, &usRead);
+        }
+        TimerStop();
+        if((eResult == FR_OK) && (usRead != g_psParams->ulRecordSize))
+        {
+            eResult = FR_RW_ERROR;
+        }
+        if(eResult == FR_OK)
+        {
+            eResult = CheckPattern(g_psParams->pucBuffer, 1, ulOffset,
+                                   usRead);
+        }
+        if(eResult != FR_OK)
+        {
+            f_close(&g_sFile);
+            return(eResult);
+        }
+
+        g_ulBytes += usRead;
+    }
+
+    TimerStart();
+    eResult = f_close(&g_sFile);
+    TimerStop();
+
+    return(eResult);
+}
+
+//*****************************************************************************
+//
+// Creates each of the small files and writes it in one go.
+//
+//*****************************************************************************
+static FRESULT
+SmallCreate(unsigned long *pulOps)
+{
+    FRESULT eResult;
+    WORD usWritten;
+
+    for(*pulOps = 0; *pulOps < g_psParams->ulFiles; (*pulOps)++)
+    {
+        FillPattern(g_psParams->pucBuffer, *pulOps, 0,
+                    g_psParams->ulSmallSize);
+
+        TimerStart();
+        eResult = f_open(&g_sFile, MakeSmallPath(*pulOps),
+                         FA_WRITE | FA_CREATE_ALWAYS);
+        if(eResult == FR_OK)
+        {
+            eResult = f_write(&g_sFile, g_psParams->pucBuffer,
+                              (WORD)g_psParams->ulSmallSize, &usWritten);
+            if((eResult == FR_OK) && (usWritten != g_psParams->ulSmallSize))
+            {
+                eResult = FR_DENIED;
+            }
+            if(eResult == FR_OK)
+            {
+                eResult = f_close(&g_sFile);
+            }
+            else
+            {
+                f_close(&g_sFile);
+            }
+        }
+        TimerStop();
+        if(eResult != FR_OK)
+        {
+            return(eResult);
+        }
+
+        g_ulBytes += usWritten;
+    }
+
+    return(FR_OK);
+}
+
+//*****************************************************************************
+//
+// Reads every entry of the benchmark directory.  The small files and the
+// benchmark file must all be found.
+//
+//*****************************************************************************
+static FRESULT
+DirectoryScan(unsigned long *pulOps)
+{
+    FRESULT eResult;
+
+    TimerStart();
+    eResult = f_opendir(&g_sDir, MakePath(0));
+    while(eResult == FR_OK)
+    {
+        eResult = f_readdir(&g_sDir, &g_sInfo);
+        if((eResult != FR_OK) || !g_sInfo.fname[0])
+        {
+            break;
+        }
+        (*pulOps)++;
+    }
+    TimerStop();
+
+    if((eResult == FR_OK) && (*pulOps < (g_psParams->ulFiles + 1)))
+    {
+        eResult = FR_NO_FILE;
+    }
+
+    return(eResult);
+}
+
+//*****************************************************************************
+//
+// Opens, reads and closes each of the small files.
+//
+//*****************************************************************************
+static FRESULT
+SmallRead(unsigned long *pulOps)
+{
+    FRESULT eResult;
+    WORD usRead;
+
+    for(*pulOps = 0; *pulOps < g_psParams->ulFiles; (*pulOps)++)
+    {
+        TimerStart();
+        eResult = f_open(&g_sFile, MakeSmallPath(*pulOps), FA_READ);
+        if(eResult == FR_OK)
+        {
+            eResult = f_read(&g_sFile, g_psParams->pucBuffer,
+                             (WORD)g_psParams->ulBufferSize, &usRead);
+            if(eResult == FR_OK)
+            {
+                eResult = f_close(&g_sFile);
+            }
+            else
+            {
+                f_close(&g_sFile);
+            }
+        }
+        TimerStop();
+        if((eResult == FR_OK) && (usRead != g_psParams->ulSmallSize))
+        {
+            eResult = FR_RW_ERROR;
+        }
+        if(eResult == FR_OK)
+        {
+            eResult = CheckPattern(g_psParams->pucBuffer, *pulOps, 0, usRead);
+        }
+        if(eResult != FR_OK)
+        {
+            return(eResult);
+        }
+
+        g_ulBytes += usRead;
+    }
+
+    return(FR_OK);
+}
+
+//*****************************************************************************
+//
+// Deletes each of the small files.
+//
+//*****************************************************************************
+static FRESULT
+SmallDelete(unsigned long *pulOps)
+{
+    FRESULT eResult;
+
+    for(*pulOps = 0; *pulOps < g_psParams->ulFiles; (*pulOps)++)
+    {
+        TimerStart();
+        eResult = f_unlink(MakeSmallPath(*pulOps));
+        TimerStop();
+        if(eResult != FR_OK)
+        {
+            return(eResult);
+        }
+    }
+
+    return(FR_OK);
+}
+
+//*****************************************************************************
+//
+// The tests, in the order that they are run.  Each one leaves behind what
+// the ones after it need.
+//
+//*****************************************************************************
+typedef struct
+{
+    const char *pcName;
+    FRESULT (*pfnTest)(unsigned long *pulOps);
+}
+tFatBenchTest;
+
+static const tFatBenchTest g_psTests[] =
+{
+    { "Seq write", SequentialWrite },
+    { "Seq read", SequentialRead },
+    { "Random read", RandomRead },
+    { "Create small", SmallCreate },
+    { "Dir scan", DirectoryScan },
+    { "Read small", SmallRead },
+    { "Delete small", SmallDelete }
+};
+
+#define NUM_TESTS               (sizeof(g_psTests) / sizeof(g_psTests[0]))
+
+//*****************************************************************************
+//
+//! Runs the benchmark suite on a drive.
+//!
+//! \param psParams points to the parameters of the run.
+//!
+//! This function writes a file sequentially and reads it back, reads records
+//! from random offsets in it, then creates, lists, reads and deletes a number
+//! of small files, all in a directory called BENCH that is made in the root
+//! of the drive and removed again at the end.  Every byte read is checked.
+//! For each test, a line is printed giving the number of operations, the
+//! number of bytes transferred, the microseconds spent in FatFs, the
+//! throughput in KB/s and the microseconds per operation.  If the disk
+//! driver counts them, the disk commands and sectors are also given.
+//!
+//! The time is counted only while FatFs is called, so a slow processor does
+//! not show up as a slow file system, and the same run on the same volume
+//! always takes the same number of disk commands.
+//!
+//! \return Returns FR_OK if every test passed, or the error from the first
+//! FatFs call that failed.  A data mismatch is reported as FR_RW_ERROR.
+//
+//*****************************************************************************
+FRESULT
+FatBenchRun(const tFatBenchParams *psParams)
+{
+    unsigned long ulTest, ulOps;
+    FATFS *psFatFs;
+    FRESULT eResult;
+    DWORD ulFree;
+
+    //
+    // Check the arguments.  The small files and records must fit in the
+    // buffer, and the records in the file.
+    //
+    ASSERT(psParams);
+    ASSERT(psParams->pucBuffer);
+    ASSERT(psParams->ulBufferSize && (psParams->ulBufferSize <= MAX_CHUNK));
+    ASSERT(psParams->ulFileSize);
+    ASSERT(psParams->ulRecordSize &&
+           (psParams->ulRecordSize <= psParams->ulBufferSize) &&
+           (psParams->ulRecordSize <= psParams->ulFileSize));
+    ASSERT(psParams->ulSmallSize &&
+           (psParams->ulSmallSize <= psParams->ulBufferSize));
+    ASSERT(psParams->ulFiles < MAX_FILES);
+    ASSERT(psParams->pfnPrintf);
+    ASSERT(psParams->pfnMicroseconds);
+
+    g_psParams = psParams;
+
+    //
+    // Describe the volume, since the results depend on it.
+    //
+    MakePath(0);
+    g_pcPath[2] = '\0';
+    eResult = f_getfree(g_pcPath, &ulFree, &psFatFs);
+    if(eResult != FR_OK)
+    {
+        psParams->pfnPrintf("Unable to read the volume: error %u.\n",
+                            (unsigned long)eResult);
+        return(eResult);
+    }
+
+    psParams->pfnPrintf("FAT%s volume, %u byte clusters, %u of %u clusters "
+                        "free.\n\n", (psFatFs->fs_type == FS_FAT12) ? "12" :
+                        (psFatFs->fs_type == FS_FAT16) ? "16" : "32",
+                        (unsigned long)psFatFs->sects_clust * 512,
+                        (unsigned long)ulFree,
+                        (unsigned long)(psFatFs->max_clust - 2));
+
+    //
+    // Make the directory to work in.  It is left behind if a run fails, and
+    // used again by the next one.
+    //
+    eResult = f_mkdir(MakePath(0));
+    if((eResult != FR_OK) && (eResult != FR_EXIST))
+    {
+        psParams->pfnPrintf("Unable to make %s: error %u.\n", g_pcPath,
+                            (unsigned long)eResult);
+        return(eResult);
+    }
+
+    psParams->pfnPrintf("Test                Ops      Bytes    Time us     "
+                        "KB/s    us/op");
+    if(psParams->pfnDiskCounts)
+    {
+        psParams->pfnPrintf("     Cmds  Sectors");
+    }
+    psParams->pfnPrintf("\n");
+
+    //
+    // Run each of the tests in turn, stopping at the first that fails.
+    //
+    for(ulTest = 0; ulTest < NUM_TESTS; ulTest++)
+    {
+        ulOps = 0;
+        TestStart();
+        eResult = g_psTests[ulTest].pfnTest(&ulOps);
+        if(eResult != FR_OK)
+        {
+            psParams->pfnPrintf("%s failed after %u operations: error %u.\n",
+                                g_psTests[ulTest].pcName, ulOps,
+                                (unsigned long)eResult);
+            return(eResult);
+        }
+
+        TestReport(g_psTests[ulTest].pcName, ulOps);
+    }
+
+    //
+    // Remove the benchmark file and directory.
+    //
+    eResult = f_unlink(MakePath(BENCH_FILE));
+    if(eResult == FR_OK)
+    {
+        eResult = f_unlink(MakePath(0));
+    }
+
+    return(eResult);
+}
+
+//*****************************************************************************
+//
+// Close the Doxygen group.
+//! @}
+//
+//*****************************************************************************
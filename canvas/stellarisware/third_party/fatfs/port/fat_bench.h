@@ -0,0 +1,112 @@
+//*****************************************************************************
+//
+// fat_bench.h - Prototypes for the FatFs benchmark suite.
+//
+//*****************************************************************************
+
+#ifndef __FAT_BENCH_H__
+#define __FAT_BENCH_H__
+
+//*****************************************************************************
+//
+// If building with a C++ compiler, make all of the definitions in this header
+// have a C binding.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+//*****************************************************************************
+//
+//! \addtogroup fat_bench_api
+//! @{
+//
+//*****************************************************************************
+
+//*****************************************************************************
+//
+//! The parameters of a run of the benchmark suite.  The same structure is
+//! used on the target, with the results printed through UARTprintf(), and on
+//! the host, with the drive held in an image file.
+//
+//*****************************************************************************
+typedef struct
+{
+    //
+    //! The drive to run on, which must already be mounted with f_mount().
+    //
+    unsigned char ucDrive;
+
+    //
+    //! A buffer for the data read and written.  Its size is the largest
+    //! single read or write, and should be a multiple of 512 bytes.
+    //
+    unsigned char *pucBuffer;
+    unsigned long ulBufferSize;
+
+    //
+    //! The size of the file written and read sequentially, in bytes.
+    //
+    unsigned long ulFileSize;
+
+    //
+    //! The number of reads from random offsets in that file, and the size of
+    //! each one in bytes.
+    //
+    unsigned long ulSeeks;
+    unsigned long ulRecordSize;
+
+    //
+    //! The number of small files created, scanned, read and deleted, and the
+    //! size of each one in bytes.
+    //
+    unsigned long ulFiles;
+    unsigned long ulSmallSize;
+
+    //
+    //! The function that prints the results.  Only the %s and %u formats are
+    //! used, with field widths, and every %u is passed an unsigned long, so
+    //! UARTprintf() will do.
+    //
+    void (*pfnPrintf)(const char *pcString, ...);
+
+    //
+    //! A function that returns a free running count of microseconds.
+    //
+    unsigned long (*pfnMicroseconds)(void);
+
+    //
+    //! An optional function that returns the number of commands and sectors
+    //! seen by the disk driver so far.  If NULL, these are not reported.
+    //
+    void (*pfnDiskCounts)(unsigned long *pulCommands,
+                          unsigned long *pulSectors);
+}
+tFatBenchParams;
+
+//*****************************************************************************
+//
+// Close the Doxygen group.
+//! @}
+//
+//*****************************************************************************
+
+//*****************************************************************************
+//
+// Prototypes for the APIs.
+//
+//*****************************************************************************
+extern FRESULT FatBenchRun(const tFatBenchParams *psParams);
+
+//*****************************************************************************
+//
+// Mark the end of the C bindings section for C++ compilers.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __FAT_BENCH_H__
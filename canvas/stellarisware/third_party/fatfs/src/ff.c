@@ -35,6 +35,10 @@
 /                       Added FSInfo support.
 /                       Fixed DBCS name can result FR_INVALID_NAME.
 /                       Fixed short seek (<= csize) collapses the file object.
+/  Oct 19, 2026  local  Added a configuration option _USE_FASTSEEK and f_linkmap().
+/                       Added a configuration option _FS_CACHE and f_prealloc().
+/                       Enabled FSInfo support by default.
+/                       Fixed f_mkfs() writes an incorrect free count to FSInfo.
 /---------------------------------------------------------------------------*/
 
 #include <string.h>
@@ -55,10 +59,189 @@ WORD fsid;                /* File system mount ID */
 
 
 
+/*-----------------------------------------------------------------------*/
+/* Write a sector of the FAT/directory area                              */
+/*-----------------------------------------------------------------------*/
+
+#if !_FS_READONLY
+static
+BOOL write_sect (        /* TRUE: successful, FALSE: failed */
+    FATFS *fs,            /* File system object */
+    const BYTE *buff,    /* Sector data */
+    DWORD sector        /* Sector number */
+)
+{
+    BYTE n;
+
+
+    if (disk_write(fs->drive, buff, sector, 1) != RES_OK)
+        return FALSE;
+    if (sector < (fs->fatbase + fs->sects_fat)) {    /* In FAT area */
+        for (n = fs->n_fats; n >= 2; n--) {    /* Refrect the change to FAT copy */
+            sector += fs->sects_fat;
+            disk_write(fs->drive, buff, sector, 1);
+        }
+    }
+    return TRUE;
+}
+#endif
+
+
+
+
+#if _FS_CACHE
+/*-----------------------------------------------------------------------*/
+/* Find a sector in the cache                                            */
+/*-----------------------------------------------------------------------*/
+
+static
+BYTE cache_find (        /* Cache line holding the sector, _FS_CACHE: not cached */
+    FATFS *fs,            /* File system object */
+    DWORD sector        /* Sector number */
+)
+{
+    BYTE i;
+
+
+    for (i = 0; i < _FS_CACHE && fs->csect[i] != sector; i++) ;
+    return i;
+}
+
+
+
+
+/*-----------------------------------------------------------------------*/
+/* Free the least recently used cache line                               */
+/*-----------------------------------------------------------------------*/
+
+static
+BYTE cache_evict (        /* Freed cache line, 0xFF: write back failed */
+    FATFS *fs            /* File system object */
+)
+{
+    BYTE i, v;
+
+
+    for (i = v = 0; i < _FS_CACHE; i++) {    /* Empty lines have the oldest stamp */
+        if (fs->cstamp[i] < fs->cstamp[v]) v = i;
+    }
+#if !_FS_READONLY
+    if (fs->cflag[v]) {                        /* Write back dirty line if needed */
+        if (!write_sect(fs, fs->cbuf[v], fs->csect[v]))
+            return 0xFF;
+        fs->cflag[v] = 0;
+    }
+#endif
+    fs->csect[v] = 0;
+    fs->cstamp[v] = 0;
+    return v;
+}
+
+
+
+
+#if !_FS_READONLY
+/*-----------------------------------------------------------------------*/
+/* Write back all dirty cache lines                                      */
+/*-----------------------------------------------------------------------*/
+
+static
+BOOL cache_flush (        /* TRUE: successful, FALSE: failed */
+    FATFS *fs            /* File system object */
+)
+{
+    BYTE i;
+
+
+    for (i = 0; i < _FS_CACHE; i++) {
+        if (fs->cflag[i]) {
+            if (!write_sect(fs, fs->cbuf[i], fs->csect[i]))
+                return FALSE;
+            fs->cflag[i] = 0;
+        }
+    }
+    return TRUE;
+}
+
+
+
+
+/*-----------------------------------------------------------------------*/
+/* Discard cached sectors that are overwritten on the disk directly      */
+/*-----------------------------------------------------------------------*/
+
+static
+void cache_drop (
+    FATFS *fs,            /* File system object */
+    DWORD sector,        /* First sector */
+    BYTE count            /* Number of sectors */
+)
+{
+    BYTE i;
+
+
+    for (i = 0; i < _FS_CACHE; i++) {
+        if (fs->csect[i] - sector < count) {
+            fs->csect[i] = 0;
+            fs->cstamp[i] = 0;
+            fs->cflag[i] = 0;
+        }
+    }
+}
+#endif /* !_FS_READONLY */
+#endif /* _FS_CACHE */
+
+
+
+
 /*-----------------------------------------------------------------------*/
 /* Change window offset                                                  */
 /*-----------------------------------------------------------------------*/
 
+#if _FS_CACHE
+static
+BOOL move_window (        /* TRUE: successful, FALSE: failed */
+    FATFS *fs,            /* File system object */
+    DWORD sector        /* Sector number to make apperance in the fs->win[] */
+)                        /* Move to zero writes back dirty window and cache */
+{
+    DWORD wsect;
+    BYTE i;
+
+
+    wsect = fs->winsect;
+    if (sector && wsect == sector) return TRUE;
+#if !_FS_READONLY
+    if (wsect && fs->winflag) {    /* Put dirty window into the cache */
+        i = cache_find(fs, wsect);
+        if (i == _FS_CACHE) {
+            i = cache_evict(fs);
+            if (i == 0xFF) return FALSE;
+            fs->csect[i] = wsect;
+        }
+        memcpy(fs->cbuf[i], fs->win, S_SIZ);
+        fs->cflag[i] = 1;
+        fs->cstamp[i] = ++fs->ctick;
+    }
+    fs->winflag = 0;
+    if (!sector) return cache_flush(fs);
+#else
+    if (!sector) return TRUE;
+#endif
+    i = cache_find(fs, sector);
+    if (i == _FS_CACHE) {        /* Load the sector into the least recently used line */
+        i = cache_evict(fs);
+        if (i == 0xFF || disk_read(fs->drive, fs->cbuf[i], sector, 1) != RES_OK)
+            return FALSE;
+        fs->csect[i] = sector;
+    }
+    fs->cstamp[i] = ++fs->ctick;
+    memcpy(fs->win, fs->cbuf[i], S_SIZ);
+    fs->winsect = sector;
+    return TRUE;
+}
+
+#else
 static
 BOOL move_window (        /* TRUE: successful, FALSE: failed */
     FATFS *fs,            /* File system object */
@@ -71,17 +254,10 @@ BOOL move_window (        /* TRUE: successful, FALSE: failed */
     wsect = fs->winsect;
     if (wsect != sector) {    /* Changed current window */
 #if !_FS_READONLY
-        BYTE n;
         if (fs->winflag) {    /* Write back dirty window if needed */
-            if (disk_write(fs->drive, fs->win, wsect, 1) != RES_OK)
+            if (!write_sect(fs, fs->win, wsect))
                 return FALSE;
             fs->winflag = 0;
-            if (wsect < (fs->fatbase + fs->sects_fat)) {    /* In FAT area */
-                for (n = fs->n_fats; n >= 2; n--) {    /* Refrect the change to FAT copy */
-                    wsect += fs->sects_fat;
-                    disk_write(fs->drive, fs->win, wsect, 1);
-                }
-            }
         }
 #endif
         if (sector) {
@@ -92,6 +268,7 @@ BOOL move_window (        /* TRUE: successful, FALSE: failed */
     }
     return TRUE;
 }
+#endif /* _FS_CACHE */
 
 
 
@@ -117,7 +294,7 @@ FRESULT sync (            /* FR_OK: successful, FR_RW_ERROR: failed */
         ST_DWORD(&fs->win[FSI_StrucSig], 0x61417272);
         ST_DWORD(&fs->win[FSI_Free_Count], fs->free_clust);
         ST_DWORD(&fs->win[FSI_Nxt_Free], fs->last_clust);
-        disk_write(0, fs->win, fs->fsi_sector, 1);
+        disk_write(fs->drive, fs->win, fs->fsi_sector, 1);
         fs->fsi_flag = 0;
     }
 #endif
@@ -269,28 +446,33 @@ DWORD create_chain (    /* 0: no free cluster, 1: error, >=2: new cluster number
     DWORD cstat, ncl, scl, mcl = fs->max_clust;
 
 
-    if (clust == 0) {        /* Create new chain */
-        scl = fs->last_clust;            /* Get suggested start point */
-        if (scl == 0 || scl >= mcl) scl = 1;
-    }
-    else {                    /* Stretch existing chain */
+    ncl = 0;
+    if (clust) {            /* Stretch existing chain */
         cstat = get_cluster(fs, clust);    /* Check the cluster status */
         if (cstat < 2) return 1;        /* It is an invalid cluster */
         if (cstat < mcl) return cstat;    /* It is already followed by next cluster */
-        scl = clust;
+    }
+    if (clust && clust + 1 < mcl) {    /* Keep the chain contiguous if the next cluster is free */
+        cstat = get_cluster(fs, clust + 1);
+        if (cstat == 1) return 1;
+        if (cstat == 0) ncl = clust + 1;
     }
 
-    ncl = scl;                /* Start cluster */
-    for (;;) {
-        ncl++;                            /* Next cluster */
-        if (ncl >= mcl) {                /* Wrap around */
-            ncl = 2;
-            if (ncl > scl) return 0;    /* No free custer */
+    if (!ncl) {
+        scl = fs->last_clust;            /* Get suggested start point */
+        if (scl == 0 || scl >= mcl) scl = 1;
+        ncl = scl;                        /* Start cluster */
+        for (;;) {
+            ncl++;                            /* Next cluster */
+            if (ncl >= mcl) {                /* Wrap around */
+                ncl = 2;
+                if (ncl > scl) return 0;    /* No free custer */
+            }
+            cstat = get_cluster(fs, ncl);    /* Get the cluster status */
+            if (cstat == 0) break;            /* Found a free cluster */
+            if (cstat == 1) return 1;        /* Any error occured */
+            if (ncl == scl) return 0;        /* No free custer */
         }
-        cstat = get_cluster(fs, ncl);    /* Get the cluster status */
-        if (cstat == 0) break;            /* Found a free cluster */
-        if (cstat == 1) return 1;        /* Any error occured */
-        if (ncl == scl) return 0;        /* No free custer */
     }
 
     if (!put_cluster(fs, ncl, 0x0FFFFFFF)) return 1;        /* Mark the new cluster "in use" */
@@ -329,6 +511,91 @@ DWORD clust2sect (    /* !=0: sector number, 0: failed - invalid cluster# */
 
 
 
+#if _USE_FASTSEEK
+/*-----------------------------------------------------------------------*/
+/* Get cluster# from the cluster link map table                          */
+/*-----------------------------------------------------------------------*/
+
+static
+DWORD clmt_clust (    /* !=0: cluster number, 0: not in the table */
+    FIL *fp,        /* Pointer to the file object */
+    DWORD cofs,        /* Cluster offset from top of the file */
+    DWORD *ncont    /* Pointer to the number of contiguous clusters following it */
+)
+{
+    DWORD *tbl = fp->cltbl;
+    DWORD lo, hi, mid;
+
+
+    hi = (tbl[0] - 2) / 2;                    /* Number of fragments */
+    if (cofs >= tbl[1 + hi * 2]) return 0;    /* Beyond the mapped clusters */
+    lo = 0; hi--;
+    while (lo < hi) {                        /* Find the fragment containing the cluster */
+        mid = (lo + hi + 1) / 2;
+        if (tbl[1 + mid * 2] <= cofs) lo = mid; else hi = mid - 1;
+    }
+    tbl += 1 + lo * 2;
+    if (ncont) *ncont = tbl[2] - cofs - 1;    /* Next fragment (or the sentinel) bounds this one */
+    return tbl[1] + (cofs - tbl[0]);
+}
+
+
+
+
+/*-----------------------------------------------------------------------*/
+/* Get number of sectors that can be transferred at a time               */
+/*-----------------------------------------------------------------------*/
+
+static
+BYTE clmt_span (    /* Number of physically contiguous sectors from current sector */
+    FIL *fp,        /* Pointer to the file object (on the sector boundary) */
+    BYTE cc            /* Number of sectors requested */
+)
+{
+    DWORD ncont, n;
+    BYTE csize = fp->fs->sects_clust;
+
+
+    if (cc <= fp->sect_clust) return cc;
+    if (!fp->cltbl || !clmt_clust(fp, fp->fptr / S_SIZ / csize, &ncont))
+        return fp->sect_clust;
+    n = fp->sect_clust + ncont * csize;
+    return (n < cc) ? (BYTE)n : cc;
+}
+
+
+
+
+/*-----------------------------------------------------------------------*/
+/* Advance file R/W position over transferred sectors                    */
+/*-----------------------------------------------------------------------*/
+
+static
+void clmt_skip (
+    FIL *fp,        /* Pointer to the file object */
+    DWORD sect,        /* First sector transferred */
+    BYTE cc            /* Number of sectors transferred (returned by clmt_span) */
+)
+{
+    BYTE csize = fp->fs->sects_clust;
+    WORD m, k;
+
+
+    if (cc <= fp->sect_clust) {                /* Stayed in the current cluster */
+        fp->sect_clust -= cc - 1;
+    } else {                                /* Crossed into following clusters of the fragment */
+        m = cc - fp->sect_clust;            /* Sectors read from the following clusters */
+        k = (m - 1) / csize + 1;            /* Number of clusters advanced */
+        fp->curr_clust += k;
+        fp->sect_clust = csize - (BYTE)(m - (k - 1) * csize) + 1;
+    }
+    fp->curr_sect = sect + cc - 1;
+}
+#endif /* _USE_FASTSEEK */
+
+
+
+
 /*-----------------------------------------------------------------------*/
 /* Move directory pointer to next                                        */
 /*-----------------------------------------------------------------------*/
@@ -574,6 +841,9 @@ FRESULT reserve_direntry (    /* FR_OK: successful, FR_DENIED: no free entry, FR
     if (clust == 1 || !move_window(fs, 0)) return FR_RW_ERROR;
 
     fs->winsect = sector = clust2sect(fs, clust);        /* Cleanup the expanded table */
+#if _FS_CACHE
+    cache_drop(fs, sector, fs->sects_clust);            /* Cached copies are stale */
+#endif
     memset(fs->win, 0, S_SIZ);
     for (n = fs->sects_clust; n; n--) {
         if (disk_write(fs->drive, fs->win, sector, 1) != RES_OK)
@@ -720,7 +990,7 @@ FRESULT auto_mount (        /* FR_OK(0): successful, !=0: any error occured */
     /* Load fsinfo sector if needed */
     if (fmt == FS_FAT32) {
         fs->fsi_sector = bootsect + LD_WORD(&fs->win[BPB_FSInfo]);
-        if (disk_read(0, fs->win, fs->fsi_sector, 1) == RES_OK &&
+        if (disk_read(fs->drive, fs->win, fs->fsi_sector, 1) == RES_OK &&
             LD_WORD(&fs->win[BS_55AA]) == 0xAA55 &&
             LD_DWORD(&fs->win[FSI_LeadSig]) == 0x41615252 &&
             LD_DWORD(&fs->win[FSI_StrucSig]) == 0x61417272) {
@@ -871,6 +1141,7 @@ FRESULT f_open (
 
     fp->dir_sect = fs->winsect;            /* Pointer to the directory entry */
     fp->dir_ptr = dir;
+    fp->prealloc = 0;                    /* No cluster is preallocated */
 #endif
     fp->flag = mode;                    /* File access mode */
     fp->org_clust =                        /* File start cluster */
@@ -878,6 +1149,9 @@ FRESULT f_open (
     fp->fsize = LD_DWORD(&dir[DIR_FileSize]);    /* File size */
     fp->fptr = 0;                        /* File ptr */
     fp->sect_clust = 1;                    /* Sector counter */
+#if _USE_FASTSEEK
+    fp->cltbl = NULL;                    /* No cluster link map table */
+#endif
     fp->fs = fs; fp->id = fs->id;        /* Owner file system object of the file */
 
     return FR_OK;
@@ -918,6 +1192,11 @@ FRESULT f_read (
             if (--fp->sect_clust) {                    /* Decrement left sector counter */
                 sect = fp->curr_sect + 1;            /* Get current sector */
             } else {                                /* On the cluster boundary, get next cluster */
+#if _USE_FASTSEEK
+                clust = fp->cltbl ?                    /* Look up the link map table first */
+                    clmt_clust(fp, fp->fptr / S_SIZ / fs->sects_clust, NULL) : 0;
+                if (!clust)
+#endif
                 clust = (fp->fptr == 0) ?
                     fp->org_clust : get_cluster(fs, fp->curr_clust);
                 if (clust < 2 || clust >= fs->max_clust)
@@ -936,11 +1215,19 @@ FRESULT f_read (
             fp->curr_sect = sect;                    /* Update current sector */
             cc = btr / S_SIZ;                        /* When left bytes >= S_SIZ, */
             if (cc) {                                /* Read maximum contiguous sectors directly */
+#if _USE_FASTSEEK
+                cc = clmt_span(fp, cc);
+#else
                 if (cc > fp->sect_clust) cc = fp->sect_clust;
+#endif
                 if (disk_read(fs->drive, rbuff, sect, cc) != RES_OK)
                     goto fr_error;
+#if _USE_FASTSEEK
+                clmt_skip(fp, sect, cc);
+#else
                 fp->sect_clust -= cc - 1;
                 fp->curr_sect += cc - 1;
+#endif
                 rcnt = cc * S_SIZ; continue;
             }
             if (disk_read(fs->drive, fp->buffer, sect, 1) != RES_OK)    /* Load the sector into file I/O buffer */
@@ -999,6 +1286,11 @@ FRESULT f_write (
                     if (clust == 0)                    /* No cluster is created yet */
                         fp->org_clust = clust = create_chain(fs, 0);    /* Create a new cluster chain */
                 } else {                            /* Middle or end of file */
+#if _USE_FASTSEEK
+                    clust = fp->cltbl ?                /* Look up the link map table first */
+                        clmt_clust(fp, fp->fptr / S_SIZ / fs->sects_clust, NULL) : 0;
+                    if (!clust)
+#endif
                     clust = create_chain(fs, fp->curr_clust);            /* Trace or streach cluster chain */
                 }
                 if (clust == 0) break;                /* Disk full */
@@ -1015,11 +1307,19 @@ FRESULT f_write (
             fp->curr_sect = sect;                    /* Update current sector */
             cc = btw / S_SIZ;                        /* When left bytes >= S_SIZ, */
             if (cc) {                                /* Write maximum contiguous sectors directly */
+#if _USE_FASTSEEK
+                cc = clmt_span(fp, cc);
+#else
                 if (cc > fp->sect_clust) cc = fp->sect_clust;
+#endif
                 if (disk_write(fs->drive, wbuff, sect, cc) != RES_OK)
                     goto fw_error;
+#if _USE_FASTSEEK
+                clmt_skip(fp, sect, cc);
+#else
                 fp->sect_clust -= cc - 1;
                 fp->curr_sect += cc - 1;
+#endif
                 wcnt = cc * S_SIZ; continue;
             }
             if (fp->fptr < fp->fsize &&              /* Fill sector buffer with file data if needed */
@@ -1089,6 +1389,56 @@ FRESULT f_sync (
 
 
 
+#if !_FS_READONLY
+/*-----------------------------------------------------------------------*/
+/* Release clusters preallocated beyond the file size                    */
+/*-----------------------------------------------------------------------*/
+
+static
+FRESULT free_prealloc (
+    FIL *fp        /* Pointer to the file object */
+)
+{
+    DWORD clust, nxt, n, csize;
+    FATFS *fs = fp->fs;
+
+
+    if (fp->fsize == 0) {                            /* Remove the whole chain */
+        if (!remove_chain(fs, fp->org_clust)) goto fp_error;
+        fp->org_clust = 0;
+    } else {
+        csize = (DWORD)fs->sects_clust * S_SIZ;
+        n = (fp->fsize - 1) / csize;                /* Index of the last cluster in use */
+        if (fp->fptr && (fp->fptr - 1) / csize == n) {
+            clust = fp->curr_clust;                    /* The R/W pointer is in the last cluster */
+        } else {
+            clust = fp->org_clust;
+            for ( ; n; n--) {                        /* Follow the chain to the last cluster */
+                clust = get_cluster(fs, clust);
+                if (clust < 2 || clust >= fs->max_clust) goto fp_error;
+            }
+        }
+        nxt = get_cluster(fs, clust);
+        if (nxt == 1) goto fp_error;
+        if (nxt >= 2 && nxt < fs->max_clust) {        /* Cut the chain after the last cluster */
+            if (!put_cluster(fs, clust, 0x0FFFFFFF) || !remove_chain(fs, nxt))
+                goto fp_error;
+            fs->last_clust = clust;                    /* Reuse the released clusters first */
+        }
+    }
+    fp->prealloc = 0;
+    fp->flag |= FA__WRITTEN;
+    return FR_OK;
+
+fp_error:    /* Abort this file due to an unrecoverable error */
+    fp->flag |= FA__ERROR;
+    return FR_RW_ERROR;
+}
+#endif /* !_FS_READONLY */
+
+
+
+
 /*-----------------------------------------------------------------------*/
 /* Close File                                                            */
 /*-----------------------------------------------------------------------*/
@@ -1101,7 +1451,11 @@ FRESULT f_close (
 
 
 #if !_FS_READONLY
-    res = f_sync(fp);
+    res = validate(fp->fs, fp->id);
+    if (res == FR_OK && fp->prealloc > fp->fsize && !(fp->flag & FA__ERROR))
+        res = free_prealloc(fp);                /* Give back unused preallocated clusters */
+    if (res == FR_OK)
+        res = f_sync(fp);
 #else
     res = validate(fp->fs, fp->id);
 #endif
@@ -1113,6 +1467,119 @@ FRESULT f_close (
 
 
 
+#if !_FS_READONLY
+/*-----------------------------------------------------------------------*/
+/* Preallocate Clusters for Writing                                      */
+/*-----------------------------------------------------------------------*/
+
+FRESULT f_prealloc (
+    FIL *fp,        /* Pointer to the file object */
+    DWORD size        /* File size to allocate the clusters for */
+)
+{
+    DWORD clust, ncl, n, csize;
+    FRESULT res;
+    FATFS *fs = fp->fs;
+
+
+    res = validate(fs, fp->id);                        /* Check validity of the object */
+    if (res) return res;
+    if (fp->flag & FA__ERROR) return FR_RW_ERROR;    /* Check error flag */
+    if (!(fp->flag & FA_WRITE)) return FR_DENIED;    /* Check access mode */
+    if (size <= fp->fptr) return FR_OK;
+
+    csize = (DWORD)fs->sects_clust * S_SIZ;
+    n = (size - 1) / csize;                            /* Index of the last cluster needed */
+    if (fp->fptr) {                                    /* Start from the current cluster */
+        clust = fp->curr_clust;
+        n -= (fp->fptr - 1) / csize;
+    } else {                                        /* Start from top of the file */
+        clust = fp->org_clust;
+        if (!clust) {                                /* No cluster is created yet */
+            clust = create_chain(fs, 0);
+            if (clust == 0) return FR_DENIED;
+            if (clust == 1) goto fp_error;
+            fp->org_clust = clust;
+        }
+    }
+    for ( ; n; n--) {                                /* Follow or stretch the chain */
+        ncl = create_chain(fs, clust);
+        if (ncl == 0) break;                        /* Disk full */
+        if (ncl == 1 || ncl >= fs->max_clust) goto fp_error;
+        clust = ncl;
+    }
+    if (fp->prealloc < size) fp->prealloc = size;
+    fp->flag |= FA__WRITTEN;                        /* Commit the chain at f_sync */
+    return n ? FR_DENIED : FR_OK;
+
+fp_error:    /* Abort this file due to an unrecoverable error */
+    fp->flag |= FA__ERROR;
+    return FR_RW_ERROR;
+}
+#endif /* !_FS_READONLY */
+
+
+
+
+#if _USE_FASTSEEK
+/*-----------------------------------------------------------------------*/
+/* Build the Cluster Link Map Table                                      */
+/*-----------------------------------------------------------------------*/
+/* tbl[0] gives the table size in DWORDs and returns the size used or
+/  required. It is followed by a pair of the cluster offset in the file and
+/  the start cluster for each contiguous fragment, and the number of clusters
+/  in the file as a sentinel, 2*fragments+2 DWORDs in total. A contiguous
+/  file needs only 4. The table is valid for the clusters the file has when
+/  it is built; clusters appended later are followed in the FAT as usual.
+/  A null tbl releases the table from the file object. */
+
+FRESULT f_linkmap (
+    FIL *fp,        /* Pointer to the file object */
+    DWORD *tbl        /* Pointer to the link map table (null:stop using it) */
+)
+{
+    DWORD clust, nxt, cofs, ulen, *tp;
+    FRESULT res;
+    FATFS *fs = fp->fs;
+
+
+    res = validate(fs, fp->id);                    /* Check validity of the object */
+    if (res) return res;
+    if (fp->flag & FA__ERROR) return FR_RW_ERROR;
+    fp->cltbl = NULL;
+    if (!tbl) return FR_OK;
+
+    tp = tbl + 1; ulen = 2; cofs = 0;
+    clust = fp->org_clust;
+    while (clust >= 2 && clust < fs->max_clust) {    /* Repeat for each fragment */
+        ulen += 2;
+        if (ulen <= tbl[0]) {
+            *tp++ = cofs; *tp++ = clust;
+        }
+        do {                                        /* Count the clusters in the fragment */
+            nxt = get_cluster(fs, clust);
+            if (nxt < 2 || ++cofs >= fs->max_clust) goto fl_error;
+        } while (nxt == ++clust);
+        clust = nxt;
+    }
+    if (ulen > tbl[0]) {                            /* Given table is too small */
+        tbl[0] = ulen;
+        return FR_NOT_ENOUGH_CORE;
+    }
+    *tp = cofs;                                        /* Sentinel: number of clusters */
+    tbl[0] = ulen;
+    fp->cltbl = tbl;
+    return FR_OK;
+
+fl_error:    /* Broken cluster chain or disk error */
+    fp->flag |= FA__ERROR;
+    return FR_RW_ERROR;
+}
+#endif /* _USE_FASTSEEK */
+
+
+
+
 #if _FS_MINIMIZE <= 2
 /*-----------------------------------------------------------------------*/
 /* Seek File R/W Pointer                                                 */
@@ -1127,6 +1594,9 @@ FRESULT f_lseek (
     BYTE csect;
     FRESULT res;
     FATFS *fs = fp->fs;
+#if _USE_FASTSEEK
+    DWORD cofs;
+#endif
 
 
     res = validate(fs, fp->id);            /* Check validity of the object */
@@ -1145,6 +1615,26 @@ FRESULT f_lseek (
         ofs = fp->fsize;
     fp->fptr = 0; fp->sect_clust = 1;        /* Set file R/W pointer to top of the file */
 
+#if _USE_FASTSEEK
+    /* Jump to the cluster directly if it is in the link map table */
+    if (ofs && fp->cltbl) {
+        csize = (DWORD)fs->sects_clust * S_SIZ;
+        cofs = (ofs - 1) / csize;                    /* Cluster offset of the last byte before ofs */
+        clust = clmt_clust(fp, cofs, NULL);
+        if (clust) {
+            csect = (BYTE)((ofs - 1 - cofs * csize) / S_SIZ);    /* Sector offset in the cluster */
+            fp->curr_clust = clust;
+            fp->curr_sect = clust2sect(fs, clust) + csect;
+            if ((ofs & (S_SIZ - 1)) &&                /* Load current sector if needed */
+                disk_read(fs->drive, fp->buffer, fp->curr_sect, 1) != RES_OK)
+                goto fk_error;
+            fp->sect_clust = fs->sects_clust - csect;
+            fp->fptr = ofs;
+            ofs = 0;                                /* The chain need not be followed */
+        }
+    }
+#endif
+
     /* Move file R/W pointer if needed */
     if (ofs) {
         clust = fp->org_clust;    /* Get start cluster */
@@ -1459,6 +1949,9 @@ FRESULT f_mkdir (
 
     fw = fs->win;
     memset(fw, 0, S_SIZ);                        /* Clear the new directory table */
+#if _FS_CACHE
+    cache_drop(fs, dsect + 1, fs->sects_clust - 1);    /* Cached copies are stale */
+#endif
     for (n = 1; n < fs->sects_clust; n++) {
         if (disk_write(fs->drive, fw, ++dsect, 1) != RES_OK)
             return FR_RW_ERROR;
@@ -1662,7 +2155,7 @@ FRESULT f_mkfs (
     n_fat += (n - b_data) / N_FATS;
 #endif
     /* Determine number of cluster and final check of validity of the FAT type */
-    n_clust = (n_part - n_rsv - n_fat * 2 - n_dir) / allocsize;
+    n_clust = (n_part - n_rsv - n_fat * N_FATS - n_dir) / allocsize;
     if (   (fmt == FS_FAT16 && n_clust < 0xFF7)
         || (fmt == FS_FAT32 && n_clust < 0xFFF7))
         return FR_MKFS_ABORTED;
@@ -39,7 +39,9 @@
 #define _DRIVES        2
 /* Number of logical drives to be used. This affects the size of internal table. */
 
+#ifndef _USE_MKFS
 #define    _USE_MKFS    0
+#endif
 /* When _USE_MKFS is set to 1 and _FS_READONLY is set to 0, f_mkfs function is
 /  enabled. */
 
@@ -48,8 +50,13 @@
 /  physical drive number and can mount only 1st primaly partition. When it is
 /  set to 1, each logical drive can mount a partition listed in Drives[]. */
 
-#define _USE_FSINFO    0
-/* To enable FSInfo support on FAT32 volume, set _USE_FSINFO to 1. */
+#ifndef _USE_FSINFO
+#define _USE_FSINFO    1
+#endif
+/* To enable FSInfo support on FAT32 volume, set _USE_FSINFO to 1. The free
+/  cluster count and the last allocated cluster are then taken from the FSInfo
+/  sector at mount time, so that f_getfree and the first cluster allocation
+/  do not have to scan the FAT. */
 
 #define    _USE_SJIS    1
 /* When _USE_SJIS is set to 1, Shift-JIS code transparency is enabled, otherwise
@@ -59,6 +66,22 @@
 /* When _USE_NTFLAG is set to 1, upper/lower case of the file name is preserved.
 /  Note that the files are always accessed in case insensitive. */
 
+#ifndef _USE_FASTSEEK
+#define    _USE_FASTSEEK    0
+#endif
+/* When _USE_FASTSEEK is set to 1, f_linkmap function is enabled. It builds a
+/  table of the contiguous cluster runs of an open file so that f_lseek and
+/  f_read/f_write no longer follow the FAT chain, and so that multi-sector
+/  reads can cross cluster boundaries within a run. */
+
+#ifndef _FS_CACHE
+#define    _FS_CACHE    0
+#endif
+/* The _FS_CACHE defines number of sectors kept in a least recently used cache
+/  behind the FAT/directory window, 512 bytes each. Modified sectors are held
+/  in the cache and written back when they are evicted or by f_sync, f_close
+/  and the other functions that change the volume. 0 disables the cache. */
+
 
 #include "integer.h"
 
@@ -91,6 +114,12 @@ typedef struct _FATFS {
     BYTE    fsi_flag;        /* fsinfo dirty flag (1:must be written back) */
     BYTE    pad2;
 #endif
+#endif
+#if _FS_CACHE
+    DWORD    ctick;            /* Cache access counter */
+    DWORD    csect[_FS_CACHE];    /* Sector held in each cache line (0:empty) */
+    DWORD    cstamp[_FS_CACHE];    /* Last access to each cache line (0:empty) */
+    BYTE    cflag[_FS_CACHE];    /* Cache line dirty flags (1:must be written back) */
 #endif
     BYTE    fs_type;        /* FAT sub type */
     BYTE    sects_clust;    /* Sectors per cluster */
@@ -102,6 +131,9 @@ typedef struct _FATFS {
     BYTE    winflag;        /* win[] dirty flag (1:must be written back) */
     BYTE    pad1;
     BYTE    win[S_MAX_SIZ];    /* Disk access window for Directory/FAT */
+#if _FS_CACHE
+    BYTE    cbuf[_FS_CACHE][S_MAX_SIZ];    /* Cache lines behind the window */
+#endif
 } FATFS;
 
 
@@ -130,6 +162,10 @@ typedef struct _FIL {
 #if _FS_READONLY == 0
     DWORD    dir_sect;        /* Sector containing the directory entry */
     BYTE*    dir_ptr;        /* Ponter to the directory entry in the window */
+    DWORD    prealloc;        /* Size the clusters were preallocated for (0:none) */
+#endif
+#if _USE_FASTSEEK
+    DWORD*    cltbl;            /* Pointer to the cluster link map table (null:not used) */
 #endif
     BYTE    buffer[S_MAX_SIZ];    /* File R/W buffer */
 } FIL;
@@ -183,7 +219,8 @@ typedef enum {
     FR_NOT_ENABLED,        /* 10 */
     FR_NO_FILESYSTEM,    /* 11 */
     FR_INVALID_OBJECT,    /* 12 */
-    FR_MKFS_ABORTED        /* 13 */
+    FR_MKFS_ABORTED,    /* 13 */
+    FR_NOT_ENOUGH_CORE    /* 14 */
 } FRESULT;
 
 
@@ -207,6 +244,8 @@ FRESULT    f_mkdir (const char*);                        /* Create a new directo
 FRESULT f_chmod (const char*, BYTE, BYTE);            /* Change file/dir attriburte */
 FRESULT f_rename (const char*, const char*);        /* Rename/Move a file or directory */
 FRESULT f_mkfs (BYTE, BYTE, BYTE);                    /* Create a file system on the drive */
+FRESULT f_linkmap (FIL*, DWORD*);                    /* Build the cluster link map of a file */
+FRESULT f_prealloc (FIL*, DWORD);                    /* Allocate clusters ahead of writing a file */
 
 
 /* User defined function to give a current time to fatfs module */
@@ -14,9 +14,15 @@ typedef unsigned short	USHORT;
 typedef unsigned short	WORD;
 
 /* These types are assumed as 32-bit integer */
+#if defined(__LP64__) || defined(_LP64)
+typedef signed int		LONG;
+typedef unsigned int	ULONG;
+typedef unsigned int	DWORD;
+#else
 typedef signed long		LONG;
 typedef unsigned long	ULONG;
 typedef unsigned long	DWORD;
+#endif
 
 /* Boolean type */
 typedef enum { FALSE = 0, TRUE } BOOL;
@@ -0,0 +1,631 @@
+//*****************************************************************************
+//
+// bcmsim.c - A command line utility that builds utils/bcm.c for the host,
+//            drives it as an output interrupt handler would, and integrates
+//            the time each channel is on to report the error in the
+//            brightness that is perceived.
+//
+//*****************************************************************************
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#include <math.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+#include "inc/hw_types.h"
+#include "utils/bcm.h"
+#include "utils/color.h"
+
+typedef unsigned char BOOL;
+#define FALSE 0
+#define TRUE  1
+
+//*****************************************************************************
+//
+// The largest number of slices that can be simulated.
+//
+//*****************************************************************************
+#define MAX_SLICES              256
+
+//*****************************************************************************
+//
+// The largest number of refreshes in a cycle of BCM_MODE_DITHER.
+//
+//*****************************************************************************
+#define MAX_CYCLE               ((1 << BCM_MAX_BITS) - 1)
+
+//*****************************************************************************
+//
+// Globals controlled by various command line parameters.
+//
+//*****************************************************************************
+BOOL g_bVerbose              = FALSE;
+BOOL g_bQuiet                = FALSE;
+BOOL g_bGamma                = FALSE;
+unsigned long g_ulSlices     = 8;
+unsigned long g_ulChannels   = 24;
+unsigned long g_ulBits       = 8;
+unsigned long g_ulMode       = BCM_MODE_WEIGHTED;
+unsigned long g_ulBrightness = BCM_BRIGHTNESS_FULL;
+unsigned long g_ulFrames     = 100;
+unsigned long g_ulWindow     = 16;
+unsigned long g_ulIterations = 10000000;
+unsigned long g_ulSeed       = 1;
+
+//*****************************************************************************
+//
+// Helpful macros for generating output depending upon verbose and quiet flags.
+//
+//*****************************************************************************
+#define VERBOSEPRINT(...) if(g_bVerbose) { printf(__VA_ARGS__); }
+#define QUIETPRINT(...) if(!g_bQuiet) { printf(__VA_ARGS__); }
+
+//*****************************************************************************
+//
+// The engine, its bit planes, and the frame of intensities being shown.
+//
+//*****************************************************************************
+static tBCMInstance g_sBCM;
+static unsigned long g_pulPlanes[2 * MAX_SLICES * BCM_MAX_BITS];
+static unsigned char g_pucFrame[MAX_SLICES * BCM_MAX_CHANNELS];
+
+//*****************************************************************************
+//
+// The ticks that each channel was on, the ticks that each slice was shown,
+// and, in BCM_MODE_DITHER, the word shown for each slice in each refresh.
+//
+//*****************************************************************************
+static unsigned long g_pulOnTicks[MAX_SLICES * BCM_MAX_CHANNELS];
+static unsigned long g_pulTicks[MAX_SLICES];
+static unsigned long g_pulShown[MAX_CYCLE * MAX_SLICES];
+
+//*****************************************************************************
+//
+// The error statistics, in units of an 8-bit intensity.
+//
+//*****************************************************************************
+typedef struct
+{
+    double dMax;
+    double dSumSquares;
+    unsigned long ulCount;
+}
+tError;
+
+//*****************************************************************************
+//
+// Returns the next value from a xorshift generator, so that a run can be
+// repeated with the same seed.
+//
+//*****************************************************************************
+static unsigned long
+Random(void)
+{
+    g_ulSeed ^= (g_ulSeed << 13) & 0xffffffff;
+    g_ulSeed ^= g_ulSeed >> 17;
+    g_ulSeed ^= (g_ulSeed << 5) & 0xffffffff;
+
+    return(g_ulSeed);
+}
+
+//*****************************************************************************
+//
+// Returns the time in nanoseconds from an arbitrary point.
+//
+//*****************************************************************************
+static unsigned long long
+Nanoseconds(void)
+{
+    struct timespec sTime;
+
+    clock_gettime(CLOCK_MONOTONIC, &sTime);
+
+    return(((unsigned long long)sTime.tv_sec * 1000000000ULL) +
+           sTime.tv_nsec);
+}
+
+//*****************************************************************************
+//
+// Returns the processor's cycle count, where it can be read.
+//
+//*****************************************************************************
+static unsigned long long
+Cycles(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+    return(__rdtsc());
+#else
+    return(0);
+#endif
+}
+
+//*****************************************************************************
+//
+// Adds an error to the statistics.
+//
+//*****************************************************************************
+static void
+ErrorAdd(tError *psError, double dError)
+{
+    dError = fabs(dError);
+    psError->dMax = fmax(psError->dMax, dError);
+    psError->dSumSquares += dError * dError;
+    psError->ulCount++;
+}
+
+//*****************************************************************************
+//
+// Prints the error statistics.
+//
+//*****************************************************************************
+static void
+ErrorPrint(const char *pcName, const tError *psError)
+{
+    QUIETPRINT("  %-34s max %7.3f  rms %7.3f\n", pcName, psError->dMax,
+               psError->ulCount ? sqrt(psError->dSumSquares /
+                                       psError->ulCount) : 0.0);
+}
+
+//*****************************************************************************
+//
+// Show the startup banner.
+//
+//*****************************************************************************
+void
+PrintWelcome(void)
+{
+    QUIETPRINT("\nbcmsim - Simulate binary code modulation of LED channels.\n\n");
+}
+
+//*****************************************************************************
+//
+// Show help on the application's command line parameters.
+//
+//*****************************************************************************
+void
+ShowHelp(void)
+{
+    //
+    // Only print help if we are not in quiet mode.
+    //
+    if(g_bQuiet)
+    {
+        return;
+    }
+
+    printf("This application builds utils/bcm.c for the host and shows\n");
+    printf("random frames with it, integrating the time that each channel\n");
+    printf("is on over a whole cycle to find the brightness that is\n");
+    printf("perceived, and reports its error against the intensity that was\n");
+    printf("set.  With dithering, it also reports the error seen by an eye\n");
+    printf("that integrates over fewer refreshes than a cycle, for the\n");
+    printf("order of the planes used by the engine and for showing each\n");
+    printf("plane in a single run.  It then times the engine.\n\n");
+    printf("Supported parameters are:\n\n");
+    printf("-s <num>  - Simulate the given number of slices, up to %d\n",
+           MAX_SLICES);
+    printf("            (default 8).\n");
+    printf("-c <num>  - Simulate the given number of channels in each\n");
+    printf("            slice, up to %d (default 24).\n", BCM_MAX_CHANNELS);
+    printf("-b <num>  - Show each channel with the given number of bits, up\n");
+    printf("            to %d (default 8).\n", BCM_MAX_BITS);
+    printf("-d        - Dither the planes over refreshes, rather than weight\n");
+    printf("            the time each plane is shown in a slice.\n");
+    printf("-w <num>  - Integrate dithering over the given number of\n");
+    printf("            refreshes (default 16).\n");
+    printf("-l <num>  - Set the brightness, up to %d (default %d).\n",
+           BCM_BRIGHTNESS_FULL, BCM_BRIGHTNESS_FULL);
+    printf("-g        - Correct the intensities with a gamma of 2.2.\n");
+    printf("-f <num>  - Show the given number of random frames (default\n");
+    printf("            100).\n");
+    printf("-n <num>  - Time the given number of output words (default\n");
+    printf("            10000000), or none if 0.\n");
+    printf("-r <num>  - Seed the random frames with the given number\n");
+    printf("            (default 1).\n");
+    printf("-? or -h  - Show this help.\n");
+    printf("-q        - Quiet mode. Disable output to stdio.\n");
+    printf("-e        - Enable verbose output.\n\n");
+    printf("Example:\n\n");
+    printf("   bcmsim -d -b 6 -w 8\n\n");
+}
+
+//*****************************************************************************
+//
+// Parse the command line, extracting all parameters.
+//
+// Returns 0 on failure, 1 on success.
+//
+//*****************************************************************************
+int
+ParseCommandLine(int argc, char *argv[])
+{
+    int iRetcode;
+    BOOL bShowHelp;
+
+    //
+    // By default, don't show the help screen.
+    //
+    bShowHelp = FALSE;
+
+    while(1)
+    {
+        //
+        // Get the next command line parameter.
+        //
+        iRetcode = getopt(argc, argv, "s:c:b:dw:l:gf:n:r:eh?q");
+
+        if(iRetcode == -1)
+        {
+            break;
+        }
+
+        switch(iRetcode)
+        {
+            case 's':
+                g_ulSlices = strtoul(optarg, NULL, 0);
+                break;
+
+            case 'c':
+                g_ulChannels = strtoul(optarg, NULL, 0);
+                break;
+
+            case 'b':
+                g_ulBits = strtoul(optarg, NULL, 0);
+                break;
+
+            case 'd':
+                g_ulMode = BCM_MODE_DITHER;
+                break;
+
+            case 'w':
+                g_ulWindow = strtoul(optarg, NULL, 0);
+                break;
+
+            case 'l':
+                g_ulBrightness = strtoul(optarg, NULL, 0);
+                break;
+
+            case 'g':
+                g_bGamma = TRUE;
+                break;
+
+            case 'f':
+                g_ulFrames = strtoul(optarg, NULL, 0);
+                break;
+
+            case 'n':
+                g_ulIterations = strtoul(optarg, NULL, 0);
+                break;
+
+            case 'r':
+                g_ulSeed = strtoul(optarg, NULL, 0) & 0xffffffff;
+                break;
+
+            case 'e':
+                g_bVerbose = TRUE;
+                break;
+
+            case 'q':
+                g_bQuiet = TRUE;
+                break;
+
+            case '?':
+            case 'h':
+                bShowHelp = TRUE;
+                break;
+        }
+    }
+
+    //
+    // Show the welcome banner unless we have been told to be quiet.
+    //
+    PrintWelcome();
+
+    //
+    // Catch various invalid parameter cases.
+    //
+    if(bShowHelp || (g_ulSeed == 0) || (g_ulSlices == 0) ||
+       (g_ulSlices > MAX_SLICES) || (g_ulChannels == 0) ||
+       (g_ulChannels > BCM_MAX_CHANNELS) || (g_ulBits == 0) ||
+       (g_ulBits > BCM_MAX_BITS) || (g_ulWindow == 0) ||
+       (g_ulBrightness > BCM_BRIGHTNESS_FULL) || (optind != argc))
+    {
+        ShowHelp();
+        return(0);
+    }
+
+    return(1);
+}
+
+//*****************************************************************************
+//
+// Returns the brightness that a channel should be perceived at, from 0 to
+// 255, without the loss of the bits that are not shown.
+//
+//*****************************************************************************
+static double
+Ideal(unsigned char ucValue)
+{
+    double dValue;
+
+    dValue = g_bGamma ? (double)g_pucColorGamma8[ucValue] : (double)ucValue;
+
+    return((dValue * (double)g_ulBrightness) / BCM_BRIGHTNESS_FULL);
+}
+
+//*****************************************************************************
+//
+// Returns the brightness of a channel over a window of refreshes, from 0 to
+// 255, given the word shown for its slice in each refresh of a cycle.
+//
+//*****************************************************************************
+static double
+Windowed(const unsigned long *pulWords, unsigned long ulCycle,
+         unsigned long ulStart, unsigned long ulChannel)
+{
+    unsigned long ulIdx, ulOn;
+
+    ulOn = 0;
+    for(ulIdx = 0; ulIdx < g_ulWindow; ulIdx++)
+    {
+        ulOn += (pulWords[(ulStart + ulIdx) % ulCycle] >> ulChannel) & 1;
+    }
+
+    return(((double)ulOn * 255.0) / (double)g_ulWindow);
+}
+
+//*****************************************************************************
+//
+// Shows one frame for a whole cycle, integrating the time each channel is on,
+// and adds its errors to the statistics.
+//
+//*****************************************************************************
+static void
+SimulateFrame(tError *psStatic, tError *psEngine, tError *psRun)
+{
+    static unsigned long pulWords[MAX_CYCLE];
+    unsigned long ulCycle, ulCalls, ulCall, ulWord, ulSlice, ulTicks;
+    unsigned long ulChannel, ulPlane, ulIdx, ulRefresh, ulOn;
+    const unsigned long *pulPlanes;
+    double dAverage;
+
+    //
+    // Set a random frame, which is taken at the start of the next refresh.
+    //
+    for(ulIdx = 0; ulIdx < (g_ulSlices * g_ulChannels); ulIdx++)
+    {
+        g_pucFrame[ulIdx] = (unsigned char)Random();
+        g_pulOnTicks[ulIdx] = 0;
+    }
+    for(ulSlice = 0; ulSlice < g_ulSlices; ulSlice++)
+    {
+        g_pulTicks[ulSlice] = 0;
+    }
+    if(!BCMFrameSet(&g_sBCM, g_pucFrame))
+    {
+        QUIETPRINT("The previous frame was not taken.\n");
+        exit(1);
+    }
+
+    //
+    // Output a whole cycle, which is one refresh when the planes are
+    // weighted, or one refresh for each slot when they are dithered.
+    //
+    ulCycle = (g_ulMode == BCM_MODE_DITHER) ? ((1 << g_ulBits) - 1) : 1;
+    ulCalls = ulCycle * g_ulSlices * ((g_ulMode == BCM_MODE_DITHER) ?
+                                      1 : g_ulBits);
+    for(ulCall = 0; ulCall < ulCalls; ulCall++)
+    {
+        ulWord = BCMNext(&g_sBCM, &ulSlice, &ulTicks);
+        g_pulTicks[ulSlice] += ulTicks;
+        for(ulChannel = 0; ulChannel < g_ulChannels; ulChannel++)
+        {
+            if(ulWord & (1 << ulChannel))
+            {
+                g_pulOnTicks[(ulSlice * g_ulChannels) + ulChannel] += ulTicks;
+            }
+        }
+        if(g_ulMode == BCM_MODE_DITHER)
+        {
+            g_pulShown[((ulCall / g_ulSlices) * g_ulSlices) + ulSlice] =
+                ulWord;
+        }
+    }
+
+    //
+    // The brightness over the whole cycle, against the intensity set.
+    //
+    for(ulSlice = 0; ulSlice < g_ulSlices; ulSlice++)
+    {
+        for(ulChannel = 0; ulChannel < g_ulChannels; ulChannel++)
+        {
+            ulIdx = (ulSlice * g_ulChannels) + ulChannel;
+            ErrorAdd(psStatic,
+                     (((double)g_pulOnTicks[ulIdx] * 255.0) /
+                      (double)g_pulTicks[ulSlice]) -
+                     Ideal(g_pucFrame[ulIdx]));
+        }
+    }
+
+    if(g_ulMode != BCM_MODE_DITHER)
+    {
+        return;
+    }
+
+    //
+    // The brightness over each window of refreshes, against the brightness
+    // over the whole cycle, for the order used by the engine and for each
+    // plane shown in a single run from the most significant.
+    //
+    pulPlanes = g_sBCM.pulPlanes[g_sBCM.ulFront];
+    for(ulSlice = 0; ulSlice < g_ulSlices; ulSlice++)
+    {
+        for(ulChannel = 0; ulChannel < g_ulChannels; ulChannel++)
+        {
+            ulOn = g_pulOnTicks[(ulSlice * g_ulChannels) + ulChannel];
+            dAverage = ((double)ulOn * 255.0) / (double)ulCycle;
+
+            for(ulRefresh = 0; ulRefresh < ulCycle; ulRefresh++)
+            {
+                pulWords[ulRefresh] =
+                    g_pulShown[(ulRefresh * g_ulSlices) + ulSlice];
+            }
+            for(ulRefresh = 0; ulRefresh < ulCycle; ulRefresh++)
+            {
+                ErrorAdd(psEngine, Windowed(pulWords, ulCycle, ulRefresh,
+                                            ulChannel) - dAverage);
+            }
+
+            ulRefresh = 0;
+            for(ulPlane = g_ulBits; ulPlane-- != 0; )
+            {
+                for(ulIdx = 0; ulIdx < (1UL << ulPlane); ulIdx++)
+                {
+                    pulWords[ulRefresh++] =
+                        pulPlanes[(ulSlice * g_ulBits) + ulPlane];
+                }
+            }
+            for(ulRefresh = 0; ulRefresh < ulCycle; ulRefresh++)
+            {
+                ErrorAdd(psRun, Windowed(pulWords, ulCycle, ulRefresh,
+                                         ulChannel) - dAverage);
+            }
+        }
+    }
+}
+
+//*****************************************************************************
+//
+// Times the output of words, and the setting of frames, and prints the time
+// of each.
+//
+//*****************************************************************************
+static void
+TimeEngine(void)
+{
+    unsigned long long ullNs, ullCycles;
+    unsigned long ulIdx, ulSlice, ulTicks, ulSum, ulFrames;
+
+    ulSum = 0;
+    ullNs = Nanoseconds();
+    ullCycles = Cycles();
+    for(ulIdx = 0; ulIdx < g_ulIterations; ulIdx++)
+    {
+        ulSum += BCMNext(&g_sBCM, &ulSlice, &ulTicks) + ulTicks;
+    }
+    ullCycles = Cycles() - ullCycles;
+    ullNs = Nanoseconds() - ullNs;
+    QUIETPRINT("  BCMNext                %8.2fns", (double)ullNs /
+               (double)g_ulIterations);
+    if(ullCycles)
+    {
+        QUIETPRINT(" %8.2f cycles", (double)ullCycles /
+                   (double)g_ulIterations);
+    }
+    QUIETPRINT(" per word\n");
+
+    //
+    // Set frames, taking each one as BCMNext() would at the start of a
+    // refresh, so that only the building of the planes is timed.
+    //
+    ulFrames = (g_ulIterations / (g_ulSlices * g_ulChannels)) + 1;
+    ullNs = Nanoseconds();
+    ullCycles = Cycles();
+    for(ulIdx = 0; ulIdx < ulFrames; ulIdx++)
+    {
+        g_pucFrame[ulIdx % (g_ulSlices * g_ulChannels)] = (unsigned char)ulIdx;
+        BCMFrameSet(&g_sBCM, g_pucFrame);
+        g_sBCM.ulFront ^= 1;
+        g_sBCM.bPending = false;
+    }
+    ullCycles = Cycles() - ullCycles;
+    ullNs = Nanoseconds() - ullNs;
+    QUIETPRINT("  BCMFrameSet            %8.2fns", (double)ullNs /
+               (double)ulFrames);
+    if(ullCycles)
+    {
+        QUIETPRINT(" %8.2f cycles", (double)ullCycles / (double)ulFrames);
+    }
+    QUIETPRINT(" per frame\n");
+    VERBOSEPRINT("(checksum %lu)\n", ulSum);
+}
+
+//*****************************************************************************
+//
+// The main entry point of the utility.
+//
+//*****************************************************************************
+int
+main(int argc, char *argv[])
+{
+    tError sStatic, sEngine, sRun;
+    unsigned long ulFrame, ulTicks;
+
+    //
+    // Parse the command line.
+    //
+    if(!ParseCommandLine(argc, argv))
+    {
+        return(1);
+    }
+
+    BCMInit(&g_sBCM, g_pulPlanes, g_ulSlices, g_ulChannels, g_ulBits,
+            g_ulMode);
+    BCMBrightnessSet(&g_sBCM, g_ulBrightness);
+    BCMGammaSet(&g_sBCM, g_bGamma ? g_pucColorGamma8 : 0);
+
+    //
+    // Show each frame for a cycle.
+    //
+    memset(&sStatic, 0, sizeof(sStatic));
+    memset(&sEngine, 0, sizeof(sEngine));
+    memset(&sRun, 0, sizeof(sRun));
+    for(ulFrame = 0; ulFrame < g_ulFrames; ulFrame++)
+    {
+        SimulateFrame(&sStatic, &sEngine, &sRun);
+    }
+
+    ulTicks = (1 << g_ulBits) - 1;
+    QUIETPRINT("%lu slices of %lu channels with %lu bits, %s.\n",
+               g_ulSlices, g_ulChannels, g_ulBits,
+               (g_ulMode == BCM_MODE_DITHER) ? "dithered" : "weighted");
+    if(g_ulMode == BCM_MODE_DITHER)
+    {
+        QUIETPRINT("Each cycle is %lu refreshes of %lu words.\n", ulTicks,
+                   g_ulSlices);
+    }
+    else
+    {
+        QUIETPRINT("Each refresh is %lu words over %lu ticks.\n",
+                   g_ulSlices * g_ulBits, g_ulSlices * ulTicks);
+    }
+    QUIETPRINT("\nError in perceived brightness, of 255, over %lu frames:\n",
+               g_ulFrames);
+    ErrorPrint("whole cycle", &sStatic);
+    if(g_ulMode == BCM_MODE_DITHER)
+    {
+        char pcName[48];
+
+        snprintf(pcName, sizeof(pcName), "%lu refreshes, interleaved planes",
+                 g_ulWindow);
+        ErrorPrint(pcName, &sEngine);
+        snprintf(pcName, sizeof(pcName), "%lu refreshes, planes in runs",
+                 g_ulWindow);
+        ErrorPrint(pcName, &sRun);
+    }
+
+    //
+    // Time the engine.
+    //
+    if(g_ulIterations)
+    {
+        QUIETPRINT("\nTime:\n");
+        TimeEngine();
+    }
+
+    return(0);
+}
@@ -0,0 +1,748 @@
+//*****************************************************************************
+//
+// bitplanebench.c - A command line utility that builds utils/bitplane.c for
+//                   the host, checks each kernel against a bit at a time
+//                   reference, and measures its speed against it.
+//
+//*****************************************************************************
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+#include "utils/bitplane.h"
+
+typedef unsigned char BOOL;
+#define FALSE 0
+#define TRUE  1
+
+//*****************************************************************************
+//
+// The largest number of channels in a slice that is checked or timed.
+//
+//*****************************************************************************
+#define MAX_CHANNELS            768
+
+//*****************************************************************************
+//
+// Globals controlled by various command line parameters.
+//
+//*****************************************************************************
+BOOL g_bVerbose              = FALSE;
+BOOL g_bQuiet                = FALSE;
+unsigned long g_ulCases      = 100000;
+unsigned long g_ulChannels   = 96;
+unsigned long g_ulCalls      = 1000000;
+unsigned long g_ulSeed       = 1;
+
+//*****************************************************************************
+//
+// The number of checks that failed.
+//
+//*****************************************************************************
+unsigned long g_ulFailed = 0;
+
+//*****************************************************************************
+//
+// Helpful macros for generating output depending upon verbose and quiet flags.
+//
+//*****************************************************************************
+#define VERBOSEPRINT(...) if(g_bVerbose) { printf(__VA_ARGS__); }
+#define QUIETPRINT(...) if(!g_bQuiet) { printf(__VA_ARGS__); }
+
+//*****************************************************************************
+//
+// Records a failed check, showing the first few of them.
+//
+//*****************************************************************************
+#define CHECK(bOk, ...)                                                       \
+    do                                                                        \
+    {                                                                         \
+        if(!(bOk) && (g_ulFailed++ < 10))                                     \
+        {                                                                     \
+            VERBOSEPRINT(__VA_ARGS__);                                        \
+        }                                                                     \
+    }                                                                         \
+    while(0)
+
+//*****************************************************************************
+//
+// The input and output buffers.
+//
+//*****************************************************************************
+static unsigned char g_pucIn[MAX_CHANNELS];
+static unsigned char g_pucOut[MAX_CHANNELS];
+static unsigned char g_pucExpect[MAX_CHANNELS];
+static unsigned long g_pulPixels[MAX_CHANNELS / 3];
+static unsigned long g_pulIn[32];
+static unsigned long g_pulOut[32];
+static unsigned long g_pulExpect[32];
+static unsigned short g_pusOut[8];
+static unsigned short g_pusExpect[8];
+
+//*****************************************************************************
+//
+// Returns the next value from a xorshift generator, so that a run can be
+// repeated with the same seed.
+//
+//*****************************************************************************
+static unsigned long
+Random(void)
+{
+    g_ulSeed ^= (g_ulSeed << 13) & 0xffffffff;
+    g_ulSeed ^= g_ulSeed >> 17;
+    g_ulSeed ^= (g_ulSeed << 5) & 0xffffffff;
+
+    return(g_ulSeed);
+}
+
+//*****************************************************************************
+//
+// Fills the inputs with random values.
+//
+//*****************************************************************************
+static void
+RandomInputs(void)
+{
+    unsigned long ulIdx;
+
+    for(ulIdx = 0; ulIdx < MAX_CHANNELS; ulIdx++)
+    {
+        g_pucIn[ulIdx] = (unsigned char)Random();
+    }
+    for(ulIdx = 0; ulIdx < (MAX_CHANNELS / 3); ulIdx++)
+    {
+        g_pulPixels[ulIdx] = Random();
+    }
+    for(ulIdx = 0; ulIdx < 32; ulIdx++)
+    {
+        g_pulIn[ulIdx] = Random();
+    }
+}
+
+//*****************************************************************************
+//
+// Returns the time in nanoseconds from an arbitrary point.
+//
+//*****************************************************************************
+static unsigned long long
+Nanoseconds(void)
+{
+    struct timespec sTime;
+
+    clock_gettime(CLOCK_MONOTONIC, &sTime);
+
+    return(((unsigned long long)sTime.tv_sec * 1000000000ULL) +
+           sTime.tv_nsec);
+}
+
+//*****************************************************************************
+//
+// Returns the processor's cycle count, where it can be read.
+//
+//*****************************************************************************
+static unsigned long long
+Cycles(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+    return(__rdtsc());
+#else
+    return(0);
+#endif
+}
+
+//*****************************************************************************
+//
+// The references, which handle one bit at a time as the code that the
+// kernels replace did.  The byte reversal is the one from the faces example
+// of the Olimex 8x8 BoosterPack.
+//
+//*****************************************************************************
+static unsigned char
+NaiveReverse8(unsigned char ucNumber)
+{
+    unsigned short ucIndex;
+    unsigned short ucReversedNumber = 0;
+
+    for(ucIndex = 0; ucIndex < 8; ucIndex++)
+    {
+        ucReversedNumber = ucReversedNumber << 1;
+        ucReversedNumber |= ((1 << ucIndex) & ucNumber) >> ucIndex;
+    }
+
+    return(ucReversedNumber);
+}
+
+static unsigned long
+NaiveReverse32(unsigned long ulValue)
+{
+    unsigned long ulIdx, ulResult;
+
+    ulResult = 0;
+    for(ulIdx = 0; ulIdx < 32; ulIdx++)
+    {
+        ulResult |= ((ulValue >> ulIdx) & 1) << (31 - ulIdx);
+    }
+
+    return(ulResult);
+}
+
+static void
+NaiveTranspose8(unsigned char *pucOut, const unsigned char *pucIn)
+{
+    unsigned long ulRow, ulBit;
+
+    for(ulBit = 0; ulBit < 8; ulBit++)
+    {
+        pucOut[ulBit] = 0;
+        for(ulRow = 0; ulRow < 8; ulRow++)
+        {
+            pucOut[ulBit] |= ((pucIn[ulRow] >> ulBit) & 1) << ulRow;
+        }
+    }
+}
+
+static void
+NaiveTranspose32(unsigned long *pulOut, const unsigned long *pulIn)
+{
+    unsigned long ulRow, ulBit;
+
+    for(ulBit = 0; ulBit < 32; ulBit++)
+    {
+        pulOut[ulBit] = 0;
+        for(ulRow = 0; ulRow < 32; ulRow++)
+        {
+            pulOut[ulBit] |= ((pulIn[ulRow] >> ulBit) & 1) << ulRow;
+        }
+    }
+}
+
+static void
+NaiveSlice(unsigned char *pucOut, const unsigned char *pucIn,
+           unsigned long ulNumChannels, unsigned long ulFlags)
+{
+    unsigned long ulNumBytes, ulPlane, ulChannel, ulByte, ulBit;
+
+    ulNumBytes = ulNumChannels / 8;
+    memset(pucOut, 0, ulNumChannels);
+    for(ulPlane = 0; ulPlane < 8; ulPlane++)
+    {
+        for(ulChannel = 0; ulChannel < ulNumChannels; ulChannel++)
+        {
+            ulByte = ulChannel / 8;
+            ulBit = ulChannel % 8;
+            if(ulFlags & BITPLANE_REVERSE_CHAIN)
+            {
+                ulByte = ulNumBytes - 1 - ulByte;
+            }
+            if(ulFlags & BITPLANE_REVERSE_BITS)
+            {
+                ulBit = 7 - ulBit;
+            }
+            pucOut[(ulPlane * ulNumBytes) + ulByte] |=
+                ((pucIn[ulChannel] >> ulPlane) & 1) << ulBit;
+        }
+    }
+}
+
+static void
+NaiveSliceRGB(unsigned char *pucOut, const unsigned long *pulPixels,
+              unsigned long ulNumPixels, unsigned long ulFlags)
+{
+    unsigned char pucChannels[MAX_CHANNELS];
+    unsigned long ulIdx;
+
+    for(ulIdx = 0; ulIdx < ulNumPixels; ulIdx++)
+    {
+        pucChannels[(ulIdx * 3) + 0] = (pulPixels[ulIdx] >> 16) & 0xff;
+        pucChannels[(ulIdx * 3) + 1] = (pulPixels[ulIdx] >> 8) & 0xff;
+        pucChannels[(ulIdx * 3) + 2] = pulPixels[ulIdx] & 0xff;
+    }
+    NaiveSlice(pucOut, pucChannels, ulNumPixels * 3, ulFlags);
+}
+
+static void
+NaiveMatrix(unsigned short *pusOut, const unsigned char *pucRows,
+            unsigned long ulNumRows, unsigned long ulFlags)
+{
+    unsigned long ulRow, ulColumns;
+
+    for(ulRow = 0; ulRow < ulNumRows; ulRow++)
+    {
+        ulColumns = ((ulFlags & BITPLANE_REVERSE_BITS) ?
+                     NaiveReverse8(pucRows[ulRow]) : pucRows[ulRow]);
+        if(ulFlags & BITPLANE_REVERSE_CHAIN)
+        {
+            pusOut[ulRow] = (1 << (ulRow + 8)) + ulColumns;
+        }
+        else
+        {
+            pusOut[ulRow] = (ulColumns << 8) + (1 << ulRow);
+        }
+    }
+}
+
+//*****************************************************************************
+//
+// Show the startup banner.
+//
+//*****************************************************************************
+void
+PrintWelcome(void)
+{
+    QUIETPRINT("\nbitplanebench - Check and time the bit-plane kernels.\n\n");
+}
+
+//*****************************************************************************
+//
+// Show help on the application's command line parameters.
+//
+//*****************************************************************************
+void
+ShowHelp(void)
+{
+    //
+    // Only print help if we are not in quiet mode.
+    //
+    if(g_bQuiet)
+    {
+        return;
+    }
+
+    printf("This application builds utils/bitplane.c for the host and\n");
+    printf("checks each kernel against a reference that handles one bit\n");
+    printf("at a time, for every byte and for random inputs with each\n");
+    printf("combination of wiring flags.  It then times each kernel\n");
+    printf("against its reference.\n\n");
+    printf("Supported parameters are:\n\n");
+    printf("-c <num>  - Check the given number of random inputs (default\n");
+    printf("            100000).\n");
+    printf("-s <num>  - Time slices of the given number of channels, a\n");
+    printf("            multiple of 24 up to %d (default 96).\n",
+           MAX_CHANNELS);
+    printf("-n <num>  - Time the given number of calls of each kernel\n");
+    printf("            (default 1000000), or none if 0.\n");
+    printf("-r <num>  - Seed the random inputs with the given number\n");
+    printf("            (default 1).\n");
+    printf("-? or -h  - Show this help.\n");
+    printf("-q        - Quiet mode. Disable output to stdio.\n");
+    printf("-e        - Enable verbose output, showing failed checks.\n\n");
+    printf("Example:\n\n");
+    printf("   bitplanebench -s 192 -n 10000000\n\n");
+}
+
+//*****************************************************************************
+//
+// Parse the command line, extracting all parameters.
+//
+// Returns 0 on failure, 1 on success.
+//
+//*****************************************************************************
+int
+ParseCommandLine(int argc, char *argv[])
+{
+    int iRetcode;
+    BOOL bShowHelp;
+
+    //
+    // By default, don't show the help screen.
+    //
+    bShowHelp = FALSE;
+
+    while(1)
+    {
+        //
+        // Get the next command line parameter.
+        //
+        iRetcode = getopt(argc, argv, "c:s:n:r:eh?q");
+
+        if(iRetcode == -1)
+        {
+            break;
+        }
+
+        switch(iRetcode)
+        {
+            case 'c':
+                g_ulCases = strtoul(optarg, NULL, 0);
+                break;
+
+            case 's':
+                g_ulChannels = strtoul(optarg, NULL, 0);
+                break;
+
+            case 'n':
+                g_ulCalls = strtoul(optarg, NULL, 0);
+                break;
+
+            case 'r':
+                g_ulSeed = strtoul(optarg, NULL, 0) & 0xffffffff;
+                break;
+
+            case 'e':
+                g_bVerbose = TRUE;
+                break;
+
+            case 'q':
+                g_bQuiet = TRUE;
+                break;
+
+            case '?':
+            case 'h':
+                bShowHelp = TRUE;
+                break;
+        }
+    }
+
+    //
+    // Show the welcome banner unless we have been told to be quiet.
+    //
+    PrintWelcome();
+
+    //
+    // Catch various invalid parameter cases.  The slices are timed both as
+    // channels and as RGB pixels, so must fill a whole number of registers
+    // either way.
+    //
+    if(bShowHelp || (g_ulSeed == 0) || (g_ulChannels == 0) ||
+       ((g_ulChannels % 24) != 0) || (g_ulChannels > MAX_CHANNELS) ||
+       (optind != argc))
+    {
+        ShowHelp();
+        return(0);
+    }
+
+    return(1);
+}
+
+//*****************************************************************************
+//
+// Checks the byte reversal for every byte, and the word reversal and the two
+// transposes for random inputs.
+//
+//*****************************************************************************
+static void
+CheckReverseTranspose(void)
+{
+    unsigned long ulIdx, ulCase, ulValue;
+
+    for(ulIdx = 0; ulIdx < 256; ulIdx++)
+    {
+        CHECK(BITPLANE_REVERSE8(ulIdx) == NaiveReverse8(ulIdx),
+              "reverse8(%02lx) = %02x, expected %02x\n", ulIdx,
+              BITPLANE_REVERSE8(ulIdx), NaiveReverse8(ulIdx));
+    }
+
+    for(ulCase = 0; ulCase < g_ulCases; ulCase++)
+    {
+        ulValue = Random();
+        CHECK(BitPlaneReverse32(ulValue) == NaiveReverse32(ulValue),
+              "reverse32(%08lx) = %08lx, expected %08lx\n", ulValue,
+              BitPlaneReverse32(ulValue), NaiveReverse32(ulValue));
+    }
+
+    for(ulCase = 0; ulCase < g_ulCases; ulCase += 32)
+    {
+        RandomInputs();
+
+        //
+        // Transpose every group of eight bytes.
+        //
+        for(ulIdx = 0; ulIdx < MAX_CHANNELS; ulIdx += 8)
+        {
+            BitPlaneTranspose8(g_pucOut + ulIdx, g_pucIn + ulIdx);
+            NaiveTranspose8(g_pucExpect + ulIdx, g_pucIn + ulIdx);
+        }
+        CHECK(memcmp(g_pucOut, g_pucExpect, MAX_CHANNELS) == 0,
+              "transpose8 is wrong\n");
+
+        //
+        // Transpose the words, then transpose them back in place.
+        //
+        BitPlaneTranspose32(g_pulOut, g_pulIn);
+        NaiveTranspose32(g_pulExpect, g_pulIn);
+        CHECK(memcmp(g_pulOut, g_pulExpect, sizeof(g_pulOut)) == 0,
+              "transpose32 is wrong\n");
+        BitPlaneTranspose32(g_pulOut, g_pulOut);
+        for(ulIdx = 0; ulIdx < 32; ulIdx++)
+        {
+            CHECK(g_pulOut[ulIdx] == (g_pulIn[ulIdx] & 0xffffffff),
+                  "transpose32 in place of word %lu is %08lx, expected "
+                  "%08lx\n", ulIdx, g_pulOut[ulIdx], g_pulIn[ulIdx]);
+        }
+    }
+}
+
+//*****************************************************************************
+//
+// Checks the slice and matrix kernels for random inputs of every size, with
+// each combination of wiring flags.
+//
+//*****************************************************************************
+static void
+CheckSlices(void)
+{
+    unsigned long ulCase, ulFlags, ulCount;
+
+    for(ulCase = 0; ulCase < g_ulCases; ulCase += 32)
+    {
+        RandomInputs();
+        for(ulFlags = 0; ulFlags < 4; ulFlags++)
+        {
+            ulCount = ((Random() % (MAX_CHANNELS / 8)) + 1) * 8;
+            BitPlaneSlice(g_pucOut, g_pucIn, ulCount, ulFlags);
+            NaiveSlice(g_pucExpect, g_pucIn, ulCount, ulFlags);
+            CHECK(memcmp(g_pucOut, g_pucExpect, ulCount) == 0,
+                  "slice of %lu channels with flags %lu is wrong\n",
+                  ulCount, ulFlags);
+
+            ulCount = ((Random() % (MAX_CHANNELS / 24)) + 1) * 8;
+            BitPlaneSliceRGB(g_pucOut, g_pulPixels, ulCount, ulFlags);
+            NaiveSliceRGB(g_pucExpect, g_pulPixels, ulCount, ulFlags);
+            CHECK(memcmp(g_pucOut, g_pucExpect, ulCount * 3) == 0,
+                  "slice of %lu pixels with flags %lu is wrong\n",
+                  ulCount, ulFlags);
+
+            ulCount = (Random() % 8) + 1;
+            BitPlaneMatrix(g_pusOut, g_pucIn, ulCount, ulFlags);
+            NaiveMatrix(g_pusExpect, g_pucIn, ulCount, ulFlags);
+            CHECK(memcmp(g_pusOut, g_pusExpect,
+                         ulCount * sizeof(g_pusOut[0])) == 0,
+                  "matrix of %lu rows with flags %lu is wrong\n", ulCount,
+                  ulFlags);
+        }
+    }
+}
+
+//*****************************************************************************
+//
+// The sum of the outputs found while timing, which is printed so that the
+// work cannot be optimized away.
+//
+//*****************************************************************************
+static unsigned long g_ulSink;
+
+//*****************************************************************************
+//
+// Each kernel and its reference, on the inputs that are timed.
+//
+//*****************************************************************************
+static void
+KernelReverse8(void)
+{
+    unsigned long ulIdx;
+
+    for(ulIdx = 0; ulIdx < 8; ulIdx++)
+    {
+        g_ulSink += BITPLANE_REVERSE8(g_pucIn[ulIdx]);
+    }
+}
+
+static void
+NaiveReverse8x8(void)
+{
+    unsigned long ulIdx;
+
+    for(ulIdx = 0; ulIdx < 8; ulIdx++)
+    {
+        g_ulSink += NaiveReverse8(g_pucIn[ulIdx]);
+    }
+}
+
+static void
+KernelReverse32(void)
+{
+    g_ulSink += BitPlaneReverse32(g_pulIn[g_ulSink & 31]);
+}
+
+static void
+NaiveReverse32x1(void)
+{
+    g_ulSink += NaiveReverse32(g_pulIn[g_ulSink & 31]);
+}
+
+static void
+KernelTranspose8(void)
+{
+    BitPlaneTranspose8(g_pucOut, g_pucIn + (g_ulSink & 0xf8));
+    g_ulSink += g_pucOut[g_ulSink & 7];
+}
+
+static void
+NaiveTranspose8x1(void)
+{
+    NaiveTranspose8(g_pucOut, g_pucIn + (g_ulSink & 0xf8));
+    g_ulSink += g_pucOut[g_ulSink & 7];
+}
+
+static void
+KernelTranspose32(void)
+{
+    BitPlaneTranspose32(g_pulOut, g_pulIn);
+    g_ulSink += g_pulOut[g_ulSink & 31];
+}
+
+static void
+NaiveTranspose32x1(void)
+{
+    NaiveTranspose32(g_pulOut, g_pulIn);
+    g_ulSink += g_pulOut[g_ulSink & 31];
+}
+
+static void
+KernelSlice(void)
+{
+    BitPlaneSlice(g_pucOut, g_pucIn, g_ulChannels, BITPLANE_REVERSE_CHAIN);
+    g_ulSink += g_pucOut[g_ulSink % g_ulChannels];
+}
+
+static void
+NaiveSlice1(void)
+{
+    NaiveSlice(g_pucOut, g_pucIn, g_ulChannels, BITPLANE_REVERSE_CHAIN);
+    g_ulSink += g_pucOut[g_ulSink % g_ulChannels];
+}
+
+static void
+KernelSliceRGB(void)
+{
+    BitPlaneSliceRGB(g_pucOut, g_pulPixels, g_ulChannels / 3,
+                     BITPLANE_REVERSE_CHAIN);
+    g_ulSink += g_pucOut[g_ulSink % g_ulChannels];
+}
+
+static void
+NaiveSliceRGB1(void)
+{
+    NaiveSliceRGB(g_pucOut, g_pulPixels, g_ulChannels / 3,
+                  BITPLANE_REVERSE_CHAIN);
+    g_ulSink += g_pucOut[g_ulSink % g_ulChannels];
+}
+
+static void
+KernelMatrix(void)
+{
+    BitPlaneMatrix(g_pusOut, g_pucIn + (g_ulSink & 0xf8), 8,
+                   BITPLANE_REVERSE_BITS);
+    g_ulSink += g_pusOut[g_ulSink & 7];
+}
+
+static void
+NaiveMatrix1(void)
+{
+    NaiveMatrix(g_pusOut, g_pucIn + (g_ulSink & 0xf8), 8,
+                BITPLANE_REVERSE_BITS);
+    g_ulSink += g_pusOut[g_ulSink & 7];
+}
+
+//*****************************************************************************
+//
+// A kernel that is timed, and its reference.
+//
+//*****************************************************************************
+typedef struct
+{
+    const char *pcName;
+    void (*pfnKernel)(void);
+    void (*pfnNaive)(void);
+}
+tKernel;
+
+static const tKernel g_psKernels[] =
+{
+    { "reverse8 x 8", KernelReverse8, NaiveReverse8x8 },
+    { "reverse32", KernelReverse32, NaiveReverse32x1 },
+    { "transpose8", KernelTranspose8, NaiveTranspose8x1 },
+    { "transpose32", KernelTranspose32, NaiveTranspose32x1 },
+    { "slice", KernelSlice, NaiveSlice1 },
+    { "slice rgb", KernelSliceRGB, NaiveSliceRGB1 },
+    { "matrix 8x8", KernelMatrix, NaiveMatrix1 }
+};
+#define NUM_KERNELS             (sizeof(g_psKernels) / sizeof(g_psKernels[0]))
+
+//*****************************************************************************
+//
+// Times a kernel and its reference, and prints the time per call of each and
+// how many times faster the kernel is.
+//
+//*****************************************************************************
+static void
+TimeKernel(const tKernel *psKernel)
+{
+    unsigned long long pullNs[2], ullCycles;
+    unsigned long ulCall, ulMode;
+    void (*pfnCall)(void);
+
+    QUIETPRINT("  %-13s", psKernel->pcName);
+    for(ulMode = 0; ulMode < 2; ulMode++)
+    {
+        pfnCall = ulMode ? psKernel->pfnNaive : psKernel->pfnKernel;
+        pullNs[ulMode] = Nanoseconds();
+        ullCycles = Cycles();
+        for(ulCall = 0; ulCall < g_ulCalls; ulCall++)
+        {
+            pfnCall();
+        }
+        ullCycles = Cycles() - ullCycles;
+        pullNs[ulMode] = Nanoseconds() - pullNs[ulMode];
+
+        QUIETPRINT("  %9.2fns", (double)pullNs[ulMode] / g_ulCalls);
+        if(ullCycles)
+        {
+            QUIETPRINT(" %9.2f", (double)ullCycles / g_ulCalls);
+        }
+    }
+    QUIETPRINT("  %6.1fx\n", pullNs[0] ? ((double)pullNs[1] /
+                                          (double)pullNs[0]) : 0.0);
+}
+
+//*****************************************************************************
+//
+// The main entry point of the utility.
+//
+//*****************************************************************************
+int
+main(int argc, char *argv[])
+{
+    unsigned long ulIdx;
+
+    //
+    // Parse the command line.
+    //
+    if(!ParseCommandLine(argc, argv))
+    {
+        return(1);
+    }
+
+    //
+    // Check each kernel.
+    //
+    QUIETPRINT("Checking the kernels with %lu random inputs...\n",
+               g_ulCases);
+    CheckReverseTranspose();
+    CheckSlices();
+    QUIETPRINT("%lu checks failed.\n", g_ulFailed);
+
+    //
+    // Time each kernel.
+    //
+    if(g_ulCalls)
+    {
+        RandomInputs();
+        QUIETPRINT("\nTime per call, with slices of %lu channels%s:\n",
+                   g_ulChannels, Cycles() ? " (ns, cycles)" : "");
+        QUIETPRINT("  kernel         kernel                  "
+                   "bit at a time           speedup\n");
+        for(ulIdx = 0; ulIdx < NUM_KERNELS; ulIdx++)
+        {
+            TimeKernel(&g_psKernels[ulIdx]);
+        }
+        VERBOSEPRINT("(checksum %lu)\n", g_ulSink);
+    }
+
+    return(g_ulFailed ? 1 : 0);
+}
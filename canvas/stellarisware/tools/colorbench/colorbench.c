@@ -0,0 +1,899 @@
+//*****************************************************************************
+//
+// colorbench.c - A command line utility that builds utils/color.c for the
+//                host, checks each color kernel against a reference, and
+//                measures its speed against the same operation in float.
+//
+//*****************************************************************************
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#include <math.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+#include "utils/color.h"
+
+typedef unsigned char BOOL;
+#define FALSE 0
+#define TRUE  1
+
+//*****************************************************************************
+//
+// The largest number of colors in an array that is checked or timed.
+//
+//*****************************************************************************
+#define MAX_COLORS              4096
+
+//*****************************************************************************
+//
+// Globals controlled by various command line parameters.
+//
+//*****************************************************************************
+BOOL g_bVerbose              = FALSE;
+BOOL g_bQuiet                = FALSE;
+unsigned long g_ulCases      = 1000000;
+unsigned long g_ulPixels     = 32;
+unsigned long g_ulCalls      = 10000000;
+unsigned long g_ulSeed       = 1;
+
+//*****************************************************************************
+//
+// The number of checks that failed.
+//
+//*****************************************************************************
+unsigned long g_ulFailed = 0;
+
+//*****************************************************************************
+//
+// Helpful macros for generating output depending upon verbose and quiet flags.
+//
+//*****************************************************************************
+#define VERBOSEPRINT(...) if(g_bVerbose) { printf(__VA_ARGS__); }
+#define QUIETPRINT(...) if(!g_bQuiet) { printf(__VA_ARGS__); }
+
+//*****************************************************************************
+//
+// Records a failed check, showing the first few of them.
+//
+//*****************************************************************************
+#define CHECK(bOk, ...)                                                       \
+    do                                                                        \
+    {                                                                         \
+        if(!(bOk) && (g_ulFailed++ < 10))                                     \
+        {                                                                     \
+            VERBOSEPRINT(__VA_ARGS__);                                        \
+        }                                                                     \
+    }                                                                         \
+    while(0)
+
+//*****************************************************************************
+//
+// The input and output arrays.
+//
+//*****************************************************************************
+static unsigned long g_pulA[MAX_COLORS];
+static unsigned long g_pulB[MAX_COLORS];
+static unsigned long g_pulOut[MAX_COLORS];
+static unsigned long g_pulOutRGB[MAX_COLORS * 3];
+static unsigned char g_pucOut[MAX_COLORS];
+static float g_pfOut[MAX_COLORS * 3];
+
+//*****************************************************************************
+//
+// Returns the next value from a xorshift generator, so that a run can be
+// repeated with the same seed.
+//
+//*****************************************************************************
+static unsigned long
+Random(void)
+{
+    g_ulSeed ^= (g_ulSeed << 13) & 0xffffffff;
+    g_ulSeed ^= g_ulSeed >> 17;
+    g_ulSeed ^= (g_ulSeed << 5) & 0xffffffff;
+
+    return(g_ulSeed);
+}
+
+//*****************************************************************************
+//
+// Fills an array with random colors.
+//
+//*****************************************************************************
+static void
+RandomColors(unsigned long *pulColors, unsigned long ulCount)
+{
+    unsigned long ulIdx;
+
+    for(ulIdx = 0; ulIdx < ulCount; ulIdx++)
+    {
+        pulColors[ulIdx] = Random();
+    }
+}
+
+//*****************************************************************************
+//
+// Returns the time in nanoseconds from an arbitrary point.
+//
+//*****************************************************************************
+static unsigned long long
+Nanoseconds(void)
+{
+    struct timespec sTime;
+
+    clock_gettime(CLOCK_MONOTONIC, &sTime);
+
+    return(((unsigned long long)sTime.tv_sec * 1000000000ULL) +
+           sTime.tv_nsec);
+}
+
+//*****************************************************************************
+//
+// Returns the processor's cycle count, where it can be read.
+//
+//*****************************************************************************
+static unsigned long long
+Cycles(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+    return(__rdtsc());
+#else
+    return(0);
+#endif
+}
+
+//*****************************************************************************
+//
+// Converts a color from hue, saturation and value to RGB in floating point,
+// as in the usual definition, with each component from 0 to 1.
+//
+//*****************************************************************************
+static void
+FloatHSVToRGB(float fHue, float fSat, float fVal, float *pfRGB)
+{
+    float fK;
+    int iChan;
+
+    for(iChan = 0; iChan < 3; iChan++)
+    {
+        fK = fmodf((float)(5 - (2 * iChan)) + (fHue * 6.0f), 6.0f);
+        pfRGB[iChan] = fVal - (fVal * fSat *
+                               fmaxf(0.0f, fminf(fminf(fK, 4.0f - fK),
+                                                 1.0f)));
+    }
+}
+
+//*****************************************************************************
+//
+// Converts a color from hue, saturation and lightness to RGB in floating
+// point, as in the usual definition, with each component from 0 to 1.
+//
+//*****************************************************************************
+static void
+FloatHSLToRGB(float fHue, float fSat, float fLight, float *pfRGB)
+{
+    float fK, fA;
+    int iChan;
+
+    fA = fSat * fminf(fLight, 1.0f - fLight);
+    for(iChan = 0; iChan < 3; iChan++)
+    {
+        fK = fmodf((float)((8 * iChan) % 12) + (fHue * 12.0f), 12.0f);
+        pfRGB[iChan] = fLight - (fA * fmaxf(-1.0f,
+                                            fminf(fminf(fK - 3.0f,
+                                                        9.0f - fK), 1.0f)));
+    }
+}
+
+//*****************************************************************************
+//
+// Show the startup banner.
+//
+//*****************************************************************************
+void
+PrintWelcome(void)
+{
+    QUIETPRINT("\ncolorbench - Check and time the integer color kernels.\n\n");
+}
+
+//*****************************************************************************
+//
+// Show help on the application's command line parameters.
+//
+//*****************************************************************************
+void
+ShowHelp(void)
+{
+    //
+    // Only print help if we are not in quiet mode.
+    //
+    if(g_bQuiet)
+    {
+        return;
+    }
+
+    printf("This application builds utils/color.c for the host and checks\n");
+    printf("each kernel against a reference for random colors, and the\n");
+    printf("conversions from HSV and HSL for every hue and a sample of the\n");
+    printf("others.  It then times each kernel on an array of colors\n");
+    printf("against the same operation in float, and against calling the\n");
+    printf("kernel once for each color.\n\n");
+    printf("Supported parameters are:\n\n");
+    printf("-c <num>  - Check the given number of random colors (default\n");
+    printf("            1000000).\n");
+    printf("-p <num>  - Time arrays of the given number of colors, up to\n");
+    printf("            %d (default 32).\n", MAX_COLORS);
+    printf("-n <num>  - Time the given number of colors in all (default\n");
+    printf("            10000000), or none if 0.\n");
+    printf("-r <num>  - Seed the random inputs with the given number\n");
+    printf("            (default 1).\n");
+    printf("-? or -h  - Show this help.\n");
+    printf("-q        - Quiet mode. Disable output to stdio.\n");
+    printf("-e        - Enable verbose output, showing failed checks.\n\n");
+    printf("Example:\n\n");
+    printf("   colorbench -p 144 -n 100000000\n\n");
+}
+
+//*****************************************************************************
+//
+// Parse the command line, extracting all parameters.
+//
+// Returns 0 on failure, 1 on success.
+//
+//*****************************************************************************
+int
+ParseCommandLine(int argc, char *argv[])
+{
+    int iRetcode;
+    BOOL bShowHelp;
+
+    //
+    // By default, don't show the help screen.
+    //
+    bShowHelp = FALSE;
+
+    while(1)
+    {
+        //
+        // Get the next command line parameter.
+        //
+        iRetcode = getopt(argc, argv, "c:p:n:r:eh?q");
+
+        if(iRetcode == -1)
+        {
+            break;
+        }
+
+        switch(iRetcode)
+        {
+            case 'c':
+                g_ulCases = strtoul(optarg, NULL, 0);
+                break;
+
+            case 'p':
+                g_ulPixels = strtoul(optarg, NULL, 0);
+                break;
+
+            case 'n':
+                g_ulCalls = strtoul(optarg, NULL, 0);
+                break;
+
+            case 'r':
+                g_ulSeed = strtoul(optarg, NULL, 0) & 0xffffffff;
+                break;
+
+            case 'e':
+                g_bVerbose = TRUE;
+                break;
+
+            case 'q':
+                g_bQuiet = TRUE;
+                break;
+
+            case '?':
+            case 'h':
+                bShowHelp = TRUE;
+                break;
+        }
+    }
+
+    //
+    // Show the welcome banner unless we have been told to be quiet.
+    //
+    PrintWelcome();
+
+    //
+    // Catch various invalid parameter cases.
+    //
+    if(bShowHelp || (g_ulSeed == 0) || (g_ulPixels == 0) ||
+       (g_ulPixels > MAX_COLORS) || (optind != argc))
+    {
+        ShowHelp();
+        return(0);
+    }
+
+    return(1);
+}
+
+//*****************************************************************************
+//
+// Checks the gamma tables against the power law, and the gamma kernels
+// against the tables.
+//
+//*****************************************************************************
+static void
+CheckGamma(void)
+{
+    unsigned long ulIdx, ulColor;
+    double dGamma;
+
+    for(ulIdx = 0; ulIdx < 256; ulIdx++)
+    {
+        dGamma = pow((double)ulIdx / 255.0, 2.2);
+        CHECK((g_pucColorGamma8[ulIdx] == (unsigned char)floor((dGamma *
+                                                                 255.0) +
+                                                                0.5)) &&
+              (g_pusColorGamma16[ulIdx] == (unsigned short)floor((dGamma *
+                                                                   65535.0) +
+                                                                  0.5)),
+              "gamma table entry %lu is wrong\n", ulIdx);
+    }
+
+    RandomColors(g_pulA, MAX_COLORS);
+    ColorGamma(g_pulOut, g_pulA, MAX_COLORS, g_pucColorGamma8);
+    ColorGamma16(g_pulOutRGB, g_pulA, MAX_COLORS, g_pusColorGamma16);
+    for(ulIdx = 0; ulIdx < MAX_COLORS; ulIdx++)
+    {
+        ulColor = g_pulA[ulIdx];
+        CHECK((g_pulOut[ulIdx] ==
+               COLOR_ARGB(COLOR_ALPHA(ulColor),
+                          g_pucColorGamma8[COLOR_RED(ulColor)],
+                          g_pucColorGamma8[COLOR_GREEN(ulColor)],
+                          g_pucColorGamma8[COLOR_BLUE(ulColor)])) &&
+              (g_pulOutRGB[(ulIdx * 3) + 0] ==
+               g_pusColorGamma16[COLOR_RED(ulColor)]) &&
+              (g_pulOutRGB[(ulIdx * 3) + 1] ==
+               g_pusColorGamma16[COLOR_GREEN(ulColor)]) &&
+              (g_pulOutRGB[(ulIdx * 3) + 2] ==
+               g_pusColorGamma16[COLOR_BLUE(ulColor)]),
+              "gamma of %08lx is wrong\n", ulColor);
+    }
+}
+
+//*****************************************************************************
+//
+// Checks the conversion from HSV or HSL for every hue with random saturations
+// and values, and for random colors, and returns the largest error of any
+// component.
+//
+//*****************************************************************************
+static double
+CheckHue(BOOL bHSL)
+{
+    unsigned long ulIdx, ulBlock, ulCount, ulHSV, ulChan, ulComp;
+    float pfRGB[3];
+    double dErr, dMax;
+
+    dMax = 0.0;
+    for(ulBlock = 0; ulBlock < (65536 + g_ulCases); ulBlock += ulCount)
+    {
+        ulCount = MAX_COLORS;
+        for(ulIdx = 0; ulIdx < ulCount; ulIdx++)
+        {
+            g_pulA[ulIdx] = (((ulBlock + ulIdx) < 65536) ?
+                             COLOR_HSV(ulBlock + ulIdx, Random(), Random()) :
+                             (Random() & 0xffffffff));
+        }
+        if(bHSL)
+        {
+            ColorHSLToRGB(g_pulOut, g_pulA, ulCount);
+        }
+        else
+        {
+            ColorHSVToRGB(g_pulOut, g_pulA, ulCount);
+        }
+
+        for(ulIdx = 0; ulIdx < ulCount; ulIdx++)
+        {
+            ulHSV = g_pulA[ulIdx];
+            if(bHSL)
+            {
+                FloatHSLToRGB((float)(ulHSV >> 16) / 65536.0f,
+                              (float)((ulHSV >> 8) & 0xff) / 255.0f,
+                              (float)(ulHSV & 0xff) / 255.0f, pfRGB);
+            }
+            else
+            {
+                FloatHSVToRGB((float)(ulHSV >> 16) / 65536.0f,
+                              (float)((ulHSV >> 8) & 0xff) / 255.0f,
+                              (float)(ulHSV & 0xff) / 255.0f, pfRGB);
+            }
+            CHECK(COLOR_ALPHA(g_pulOut[ulIdx]) == 0xff,
+                  "%s(%08lx) is not opaque\n", bHSL ? "HSL" : "HSV", ulHSV);
+            for(ulChan = 0; ulChan < 3; ulChan++)
+            {
+                ulComp = (g_pulOut[ulIdx] >> (16 - (8 * ulChan))) & 0xff;
+                dErr = fabs((double)ulComp - ((double)pfRGB[ulChan] * 255.0));
+                dMax = fmax(dMax, dErr);
+                CHECK(dErr <= 0.51, "%s(%08lx) = %08lx, expected %.2f in "
+                      "component %lu\n", bHSL ? "HSL" : "HSV", ulHSV,
+                      g_pulOut[ulIdx], (double)pfRGB[ulChan] * 255.0,
+                      ulChan);
+            }
+        }
+    }
+
+    return(dMax);
+}
+
+//*****************************************************************************
+//
+// Returns a component blended from A to B by a weight from 0 to 256.
+//
+//*****************************************************************************
+static unsigned long
+BlendComponent(unsigned long ulA, unsigned long ulB, unsigned long ulWeight)
+{
+    return(((ulA * (256 - ulWeight)) + (ulB * ulWeight) + 128) >> 8);
+}
+
+//*****************************************************************************
+//
+// Checks the scale, blend, add, luma and difference kernels against the same
+// operation on one component at a time.
+//
+//*****************************************************************************
+static void
+CheckArithmetic(void)
+{
+    unsigned long ulBlock, ulIdx, ulShift, ulWeight, ulExpect, ulDiff;
+    unsigned long ulA, ulB, ulAlpha, ulLuma;
+
+    for(ulBlock = 0; ulBlock < g_ulCases; ulBlock += MAX_COLORS)
+    {
+        RandomColors(g_pulA, MAX_COLORS);
+        RandomColors(g_pulB, MAX_COLORS);
+        ulWeight = Random() % 257;
+
+        //
+        // Scale.
+        //
+        ColorScale(g_pulOut, g_pulA, ulWeight, MAX_COLORS);
+        for(ulIdx = 0; ulIdx < MAX_COLORS; ulIdx++)
+        {
+            ulA = g_pulA[ulIdx];
+            ulExpect = ulA & 0xff000000;
+            for(ulShift = 0; ulShift < 24; ulShift += 8)
+            {
+                ulExpect |= (BlendComponent(0, (ulA >> ulShift) & 0xff,
+                                            ulWeight) << ulShift);
+            }
+            CHECK(g_pulOut[ulIdx] == ulExpect, "scale(%08lx, %lu) = %08lx, "
+                  "expected %08lx\n", ulA, ulWeight, g_pulOut[ulIdx],
+                  ulExpect);
+        }
+
+        //
+        // Blend by a weight.
+        //
+        ColorBlend(g_pulOut, g_pulA, g_pulB, ulWeight, MAX_COLORS);
+        for(ulIdx = 0; ulIdx < MAX_COLORS; ulIdx++)
+        {
+            ulA = g_pulA[ulIdx];
+            ulB = g_pulB[ulIdx];
+            ulExpect = 0;
+            for(ulShift = 0; ulShift < 32; ulShift += 8)
+            {
+                ulExpect |= (BlendComponent((ulA >> ulShift) & 0xff,
+                                            (ulB >> ulShift) & 0xff,
+                                            ulWeight) << ulShift);
+            }
+            CHECK(g_pulOut[ulIdx] == ulExpect, "blend(%08lx, %08lx, %lu) = "
+                  "%08lx, expected %08lx\n", ulA, ulB, ulWeight,
+                  g_pulOut[ulIdx], ulExpect);
+        }
+
+        //
+        // Blend by alpha.
+        //
+        ColorBlendAlpha(g_pulOut, g_pulA, g_pulB, MAX_COLORS);
+        for(ulIdx = 0; ulIdx < MAX_COLORS; ulIdx++)
+        {
+            ulA = g_pulA[ulIdx];
+            ulB = g_pulB[ulIdx];
+            ulAlpha = COLOR_ALPHA(ulB) + (COLOR_ALPHA(ulB) >> 7);
+            ulExpect = ulA & 0xff000000;
+            for(ulShift = 0; ulShift < 24; ulShift += 8)
+            {
+                ulExpect |= (BlendComponent((ulA >> ulShift) & 0xff,
+                                            (ulB >> ulShift) & 0xff,
+                                            ulAlpha) << ulShift);
+            }
+            CHECK(g_pulOut[ulIdx] == ulExpect, "blend alpha(%08lx, %08lx) "
+                  "= %08lx, expected %08lx\n", ulA, ulB, g_pulOut[ulIdx],
+                  ulExpect);
+        }
+
+        //
+        // Saturating add.
+        //
+        ColorAdd(g_pulOut, g_pulA, g_pulB, MAX_COLORS);
+        for(ulIdx = 0; ulIdx < MAX_COLORS; ulIdx++)
+        {
+            ulA = g_pulA[ulIdx];
+            ulB = g_pulB[ulIdx];
+            ulExpect = 0;
+            for(ulShift = 0; ulShift < 32; ulShift += 8)
+            {
+                ulDiff = ((ulA >> ulShift) & 0xff) + ((ulB >> ulShift) & 0xff);
+                ulExpect |= ((ulDiff > 255) ? 255 : ulDiff) << ulShift;
+            }
+            CHECK(g_pulOut[ulIdx] == ulExpect, "add(%08lx, %08lx) = %08lx, "
+                  "expected %08lx\n", ulA, ulB, g_pulOut[ulIdx], ulExpect);
+        }
+
+        //
+        // Luma, which is also checked against BT.601 in floating point.
+        //
+        ColorLuma(g_pucOut, g_pulA, MAX_COLORS);
+        for(ulIdx = 0; ulIdx < MAX_COLORS; ulIdx++)
+        {
+            ulA = g_pulA[ulIdx];
+            ulLuma = g_pucOut[ulIdx];
+            CHECK(fabs((double)ulLuma - ((0.299 * COLOR_RED(ulA)) +
+                                         (0.587 * COLOR_GREEN(ulA)) +
+                                         (0.114 * COLOR_BLUE(ulA)))) <= 1.0,
+                  "luma(%08lx) = %lu\n", ulA, ulLuma);
+        }
+
+        //
+        // Difference, over a random length so that every tail is covered.
+        //
+        ulIdx = (Random() % MAX_COLORS) + 1;
+        ulDiff = ColorDifference(g_pulA, g_pulB, ulIdx);
+        ulExpect = 0;
+        while(ulIdx--)
+        {
+            for(ulShift = 0; ulShift < 32; ulShift += 8)
+            {
+                ulA = (g_pulA[ulIdx] >> ulShift) & 0xff;
+                ulB = (g_pulB[ulIdx] >> ulShift) & 0xff;
+                ulExpect += (ulA > ulB) ? (ulA - ulB) : (ulB - ulA);
+            }
+        }
+        CHECK(ulDiff == ulExpect, "difference = %lu, expected %lu\n", ulDiff,
+              ulExpect);
+    }
+}
+
+//*****************************************************************************
+//
+// The sum of the differences found while timing, which is printed so that
+// the work cannot be optimized away.
+//
+//*****************************************************************************
+static unsigned long g_ulSink;
+
+//*****************************************************************************
+//
+// Each kernel, and the same operation in floating point, as it would be
+// written without the kernels, on part of the arrays.
+//
+//*****************************************************************************
+static void
+KernelGamma(unsigned long ulFirst, unsigned long ulCount)
+{
+    ColorGamma16(g_pulOutRGB + (ulFirst * 3), g_pulA + ulFirst, ulCount,
+                 g_pusColorGamma16);
+}
+
+static void
+FloatGamma(unsigned long ulFirst, unsigned long ulCount)
+{
+    unsigned long ulIdx, ulChan;
+
+    for(ulIdx = ulFirst; ulIdx < (ulFirst + ulCount); ulIdx++)
+    {
+        for(ulChan = 0; ulChan < 3; ulChan++)
+        {
+            g_pulOutRGB[(ulIdx * 3) + ulChan] =
+                (unsigned long)((powf((float)((g_pulA[ulIdx] >>
+                                               (16 - (8 * ulChan))) &
+                                              0xff) / 255.0f, 2.2f) *
+                                 65535.0f) + 0.5f);
+        }
+    }
+}
+
+static void
+KernelHSV(unsigned long ulFirst, unsigned long ulCount)
+{
+    ColorHSVToRGB(g_pulOut + ulFirst, g_pulA + ulFirst, ulCount);
+}
+
+static void
+FloatHSV(unsigned long ulFirst, unsigned long ulCount)
+{
+    unsigned long ulIdx;
+
+    for(ulIdx = ulFirst; ulIdx < (ulFirst + ulCount); ulIdx++)
+    {
+        FloatHSVToRGB((float)(g_pulA[ulIdx] >> 16) / 65536.0f,
+                      (float)((g_pulA[ulIdx] >> 8) & 0xff) / 255.0f,
+                      (float)(g_pulA[ulIdx] & 0xff) / 255.0f,
+                      g_pfOut + (ulIdx * 3));
+    }
+}
+
+static void
+KernelHSL(unsigned long ulFirst, unsigned long ulCount)
+{
+    ColorHSLToRGB(g_pulOut + ulFirst, g_pulA + ulFirst, ulCount);
+}
+
+static void
+FloatHSL(unsigned long ulFirst, unsigned long ulCount)
+{
+    unsigned long ulIdx;
+
+    for(ulIdx = ulFirst; ulIdx < (ulFirst + ulCount); ulIdx++)
+    {
+        FloatHSLToRGB((float)(g_pulA[ulIdx] >> 16) / 65536.0f,
+                      (float)((g_pulA[ulIdx] >> 8) & 0xff) / 255.0f,
+                      (float)(g_pulA[ulIdx] & 0xff) / 255.0f,
+                      g_pfOut + (ulIdx * 3));
+    }
+}
+
+static void
+KernelScale(unsigned long ulFirst, unsigned long ulCount)
+{
+    ColorScale(g_pulOut + ulFirst, g_pulA + ulFirst, 77, ulCount);
+}
+
+static void
+FloatScale(unsigned long ulFirst, unsigned long ulCount)
+{
+    unsigned long ulIdx, ulChan;
+
+    for(ulIdx = ulFirst; ulIdx < (ulFirst + ulCount); ulIdx++)
+    {
+        for(ulChan = 0; ulChan < 3; ulChan++)
+        {
+            g_pulOutRGB[(ulIdx * 3) + ulChan] =
+                (unsigned long)(((float)((g_pulA[ulIdx] >>
+                                          (16 - (8 * ulChan))) & 0xff) *
+                                 0.3f) + 0.5f);
+        }
+    }
+}
+
+static void
+KernelBlend(unsigned long ulFirst, unsigned long ulCount)
+{
+    ColorBlend(g_pulOut + ulFirst, g_pulA + ulFirst, g_pulB + ulFirst, 77,
+               ulCount);
+}
+
+static void
+FloatBlend(unsigned long ulFirst, unsigned long ulCount)
+{
+    unsigned long ulIdx, ulChan;
+    float fA;
+
+    for(ulIdx = ulFirst; ulIdx < (ulFirst + ulCount); ulIdx++)
+    {
+        for(ulChan = 0; ulChan < 3; ulChan++)
+        {
+            fA = (float)((g_pulA[ulIdx] >> (16 - (8 * ulChan))) & 0xff);
+            g_pulOutRGB[(ulIdx * 3) + ulChan] =
+                (unsigned long)(fA + ((float)((g_pulB[ulIdx] >>
+                                               (16 - (8 * ulChan))) &
+                                              0xff) - fA) * 0.3f + 0.5f);
+        }
+    }
+}
+
+static void
+KernelAdd(unsigned long ulFirst, unsigned long ulCount)
+{
+    ColorAdd(g_pulOut + ulFirst, g_pulA + ulFirst, g_pulB + ulFirst,
+             ulCount);
+}
+
+static void
+FloatAdd(unsigned long ulFirst, unsigned long ulCount)
+{
+    unsigned long ulIdx, ulChan;
+
+    for(ulIdx = ulFirst; ulIdx < (ulFirst + ulCount); ulIdx++)
+    {
+        for(ulChan = 0; ulChan < 3; ulChan++)
+        {
+            g_pfOut[(ulIdx * 3) + ulChan] =
+                fminf((float)((g_pulA[ulIdx] >> (16 - (8 * ulChan))) &
+                              0xff) +
+                      (float)((g_pulB[ulIdx] >> (16 - (8 * ulChan))) &
+                              0xff), 255.0f);
+        }
+    }
+}
+
+static void
+KernelLuma(unsigned long ulFirst, unsigned long ulCount)
+{
+    ColorLuma(g_pucOut + ulFirst, g_pulA + ulFirst, ulCount);
+}
+
+static void
+FloatLuma(unsigned long ulFirst, unsigned long ulCount)
+{
+    unsigned long ulIdx;
+
+    for(ulIdx = ulFirst; ulIdx < (ulFirst + ulCount); ulIdx++)
+    {
+        g_pucOut[ulIdx] =
+            (unsigned char)((0.299f * (float)COLOR_RED(g_pulA[ulIdx])) +
+                            (0.587f * (float)COLOR_GREEN(g_pulA[ulIdx])) +
+                            (0.114f * (float)COLOR_BLUE(g_pulA[ulIdx])) +
+                            0.5f);
+    }
+}
+
+static void
+KernelDifference(unsigned long ulFirst, unsigned long ulCount)
+{
+    g_ulSink += ColorDifference(g_pulA + ulFirst, g_pulB + ulFirst, ulCount);
+}
+
+static void
+FloatDifference(unsigned long ulFirst, unsigned long ulCount)
+{
+    unsigned long ulIdx, ulChan;
+    float fSum;
+
+    fSum = 0.0f;
+    for(ulIdx = ulFirst; ulIdx < (ulFirst + ulCount); ulIdx++)
+    {
+        for(ulChan = 0; ulChan < 3; ulChan++)
+        {
+            fSum += fabsf((float)((g_pulA[ulIdx] >> (16 - (8 * ulChan))) &
+                                  0xff) -
+                          (float)((g_pulB[ulIdx] >> (16 - (8 * ulChan))) &
+                                  0xff));
+        }
+    }
+    g_ulSink += (unsigned long)fSum;
+}
+
+//*****************************************************************************
+//
+// A kernel that is timed, and the same operation in floating point.
+//
+//*****************************************************************************
+typedef struct
+{
+    const char *pcName;
+    void (*pfnKernel)(unsigned long ulFirst, unsigned long ulCount);
+    void (*pfnFloat)(unsigned long ulFirst, unsigned long ulCount);
+}
+tKernel;
+
+static const tKernel g_psKernels[] =
+{
+    { "gamma16", KernelGamma, FloatGamma },
+    { "hsv", KernelHSV, FloatHSV },
+    { "hsl", KernelHSL, FloatHSL },
+    { "scale", KernelScale, FloatScale },
+    { "blend", KernelBlend, FloatBlend },
+    { "add", KernelAdd, FloatAdd },
+    { "luma", KernelLuma, FloatLuma },
+    { "difference", KernelDifference, FloatDifference }
+};
+#define NUM_KERNELS             (sizeof(g_psKernels) / sizeof(g_psKernels[0]))
+
+//*****************************************************************************
+//
+// Times a kernel on the whole array, called once for each color, and the
+// same operation in floating point, and prints the time per color of each.
+//
+//*****************************************************************************
+static void
+TimeKernel(const tKernel *psKernel)
+{
+    unsigned long long ullNs, ullCycles;
+    unsigned long ulPass, ulPasses, ulIdx, ulMode;
+    double dColors;
+
+    ulPasses = (g_ulCalls + g_ulPixels - 1) / g_ulPixels;
+    dColors = (double)ulPasses * g_ulPixels;
+    QUIETPRINT("  %-10s", psKernel->pcName);
+    for(ulMode = 0; ulMode < 3; ulMode++)
+    {
+        ullNs = Nanoseconds();
+        ullCycles = Cycles();
+        for(ulPass = 0; ulPass < ulPasses; ulPass++)
+        {
+            if(ulMode == 0)
+            {
+                psKernel->pfnKernel(0, g_ulPixels);
+            }
+            else if(ulMode == 1)
+            {
+                for(ulIdx = 0; ulIdx < g_ulPixels; ulIdx++)
+                {
+                    psKernel->pfnKernel(ulIdx, 1);
+                }
+            }
+            else
+            {
+                psKernel->pfnFloat(0, g_ulPixels);
+            }
+        }
+        ullCycles = Cycles() - ullCycles;
+        ullNs = Nanoseconds() - ullNs;
+
+        QUIETPRINT("  %6.2fns", (double)ullNs / dColors);
+        if(ullCycles)
+        {
+            QUIETPRINT(" %6.2f", (double)ullCycles / dColors);
+        }
+    }
+    QUIETPRINT("\n");
+}
+
+//*****************************************************************************
+//
+// The main entry point of the utility.
+//
+//*****************************************************************************
+int
+main(int argc, char *argv[])
+{
+    unsigned long ulIdx;
+    double dHSV, dHSL;
+
+    //
+    // Parse the command line.
+    //
+    if(!ParseCommandLine(argc, argv))
+    {
+        return(1);
+    }
+
+    //
+    // Check each kernel.
+    //
+    QUIETPRINT("Checking the kernels with %lu random colors...\n",
+               g_ulCases);
+    CheckGamma();
+    dHSV = CheckHue(FALSE);
+    dHSL = CheckHue(TRUE);
+    CheckArithmetic();
+    QUIETPRINT("Largest error of HSV is %.3f and of HSL is %.3f.\n", dHSV,
+               dHSL);
+    QUIETPRINT("%lu checks failed.\n", g_ulFailed);
+
+    //
+    // Time each kernel.
+    //
+    if(g_ulCalls)
+    {
+        RandomColors(g_pulA, MAX_COLORS);
+        RandomColors(g_pulB, MAX_COLORS);
+        QUIETPRINT("\nTime per color, in arrays of %lu colors%s:\n",
+                   g_ulPixels, Cycles() ? " (ns, cycles)" : "");
+        QUIETPRINT("  kernel      array             one per call      "
+                   "float\n");
+        for(ulIdx = 0; ulIdx < NUM_KERNELS; ulIdx++)
+        {
+            TimeKernel(&g_psKernels[ulIdx]);
+        }
+        VERBOSEPRINT("(checksum %lu)\n", g_ulSink);
+    }
+
+    return(g_ulFailed ? 1 : 0);
+}
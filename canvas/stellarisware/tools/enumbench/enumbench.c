@@ -0,0 +1,632 @@
+//*****************************************************************************
+//
+// enumbench.c - A command line utility that builds the USB device
+//               configuration descriptor parsing functions for the host and
+//               measures the time taken by the descriptor queries which the
+//               device stack makes during enumeration, with and without the
+//               configuration descriptor index.
+//
+//*****************************************************************************
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+#include "inc/hw_types.h"
+#include "usblib/usblib.h"
+#include "usblib/device/usbdevice.h"
+
+typedef unsigned char BOOL;
+#define FALSE 0
+#define TRUE  1
+
+//*****************************************************************************
+//
+// The largest number of interfaces, alternate settings of each interface and
+// endpoints in each alternate setting that can be described.
+//
+//*****************************************************************************
+#define MAX_INTERFACES          32
+#define MAX_ALTERNATES          8
+#define MAX_ENDPOINTS           15
+
+//*****************************************************************************
+//
+// The size of the class-specific descriptor placed after each interface
+// descriptor, as most classes have one.
+//
+//*****************************************************************************
+#define CS_DESC_SIZE            5
+
+//*****************************************************************************
+//
+// The largest number of results recorded by a single enumeration.
+//
+//*****************************************************************************
+#define MAX_RESULTS             65536
+
+//*****************************************************************************
+//
+// Globals controlled by various command line parameters.
+//
+//*****************************************************************************
+BOOL g_bVerbose                = FALSE;
+BOOL g_bQuiet                  = FALSE;
+unsigned long g_ulInterfaces   = 4;
+unsigned long g_ulAlternates   = 2;
+unsigned long g_ulEndpoints    = 2;
+unsigned long g_ulIterations   = 100000;
+
+//*****************************************************************************
+//
+// Helpful macros for generating output depending upon verbose and quiet flags.
+//
+//*****************************************************************************
+#define VERBOSEPRINT(...) if(g_bVerbose) { printf(__VA_ARGS__); }
+#define QUIETPRINT(...) if(!g_bQuiet) { printf(__VA_ARGS__); }
+
+//*****************************************************************************
+//
+// Counts a check and reports it if it fails.
+//
+//*****************************************************************************
+static unsigned long g_ulFailed = 0;
+
+#define CHECK(bCond, ...)                                                     \
+    if(!(bCond))                                                              \
+    {                                                                         \
+        g_ulFailed++;                                                         \
+        QUIETPRINT("FAIL: " __VA_ARGS__);                                     \
+    }
+
+//*****************************************************************************
+//
+// The configuration descriptor, built as a composite device would be with
+// the configuration descriptor header in one section and each interface,
+// with all of its alternate settings, in a section of its own.
+//
+//*****************************************************************************
+static unsigned char g_pucConfigData[9];
+static unsigned char *g_ppucInterfaceData[MAX_INTERFACES];
+static tConfigSection g_psSections[MAX_INTERFACES + 1];
+static const tConfigSection *g_ppsSections[MAX_INTERFACES + 1];
+static tConfigHeader g_sConfig;
+
+//*****************************************************************************
+//
+// The results of the queries made by one enumeration.
+//
+//*****************************************************************************
+static unsigned long g_pulIndexed[MAX_RESULTS];
+static unsigned long g_pulWalked[MAX_RESULTS];
+
+//*****************************************************************************
+//
+// Returns the time in nanoseconds from an arbitrary point.
+//
+//*****************************************************************************
+static unsigned long long
+Nanoseconds(void)
+{
+    struct timespec sTime;
+
+    clock_gettime(CLOCK_MONOTONIC, &sTime);
+
+    return(((unsigned long long)sTime.tv_sec * 1000000000ULL) +
+           sTime.tv_nsec);
+}
+
+//*****************************************************************************
+//
+// Returns the processor's cycle count, where it can be read.
+//
+//*****************************************************************************
+static unsigned long long
+Cycles(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+    return(__rdtsc());
+#else
+    return(0);
+#endif
+}
+
+//*****************************************************************************
+//
+// Builds the configuration descriptor from the command line parameters.
+//
+//*****************************************************************************
+static void
+BuildConfigDescriptor(void)
+{
+    unsigned long ulIf, ulAlt, ulEp, ulSize, ulNum;
+    unsigned char *pucDesc;
+
+    g_pucConfigData[0] = 9;
+    g_pucConfigData[1] = USB_DTYPE_CONFIGURATION;
+    g_pucConfigData[4] = g_ulInterfaces;
+    g_pucConfigData[5] = 1;
+    g_pucConfigData[7] = 0x80;
+    g_pucConfigData[8] = 50;
+    g_psSections[0].usSize = sizeof(g_pucConfigData);
+    g_psSections[0].pucData = g_pucConfigData;
+    g_ppsSections[0] = &g_psSections[0];
+
+    ulSize = g_ulAlternates * (9 + CS_DESC_SIZE + (7 * g_ulEndpoints));
+    ulNum = 1;
+
+    for(ulIf = 0; ulIf < g_ulInterfaces; ulIf++)
+    {
+        g_ppucInterfaceData[ulIf] = calloc(1, ulSize);
+        pucDesc = g_ppucInterfaceData[ulIf];
+
+        for(ulAlt = 0; ulAlt < g_ulAlternates; ulAlt++)
+        {
+            pucDesc[0] = 9;
+            pucDesc[1] = USB_DTYPE_INTERFACE;
+            pucDesc[2] = ulIf;
+            pucDesc[3] = ulAlt;
+            pucDesc[4] = g_ulEndpoints;
+            pucDesc[5] = USB_CLASS_VEND_SPECIFIC;
+            pucDesc += 9;
+
+            pucDesc[0] = CS_DESC_SIZE;
+            pucDesc[1] = USB_DTYPE_CS_INTERFACE;
+            pucDesc += CS_DESC_SIZE;
+
+            //
+            // Each alternate setting uses the same endpoints with a larger
+            // packet size, as audio and video interfaces do.
+            //
+            for(ulEp = 0; ulEp < g_ulEndpoints; ulEp++)
+            {
+                pucDesc[0] = 7;
+                pucDesc[1] = USB_DTYPE_ENDPOINT;
+                pucDesc[2] = (((ulNum + ulEp - 1) % 15) + 1) |
+                             ((ulEp & 1) ? USB_EP_DESC_IN : USB_EP_DESC_OUT);
+                pucDesc[3] = USB_EP_ATTR_BULK;
+                pucDesc[4] = (ulAlt + 1) * 8;
+                pucDesc += 7;
+            }
+        }
+
+        ulNum += g_ulEndpoints;
+
+        g_psSections[ulIf + 1].usSize = ulSize;
+        g_psSections[ulIf + 1].pucData = g_ppucInterfaceData[ulIf];
+        g_ppsSections[ulIf + 1] = &g_psSections[ulIf + 1];
+    }
+
+    g_sConfig.ucNumSections = g_ulInterfaces + 1;
+    g_sConfig.psSections = g_ppsSections;
+}
+
+//*****************************************************************************
+//
+// Records one result, if there is space.
+//
+//*****************************************************************************
+#define RECORD(ulValue)                                                       \
+    if(pulResults && (ulCount < MAX_RESULTS))                                 \
+    {                                                                         \
+        pulResults[ulCount] = (unsigned long)(ulValue);                       \
+    }                                                                         \
+    ulCount++;
+
+//*****************************************************************************
+//
+// Makes the descriptor queries that the device stack makes when the host
+// reads the configuration descriptor, sets the configuration, which calls
+// USBDeviceConfig(), and then selects every alternate setting of every
+// interface, which calls USBDeviceConfigAlternate().  Returns the number of
+// results, which are recorded in pulResults if it is not 0.
+//
+//*****************************************************************************
+static unsigned long
+Enumerate(unsigned long *pulResults)
+{
+    tInterfaceDescriptor *psInterface;
+    tEndpointDescriptor *psEndpoint;
+    unsigned long ulNumEndpoints, ulNumInterfaces, ulLoop, ulEp, ulSection;
+    unsigned long ulIf, ulAlt, ulNumAlts, ulCount;
+
+    ulCount = 0;
+
+    //
+    // GET_DESCRIPTOR(CONFIGURATION).
+    //
+    RECORD(USBDCDConfigDescGetSize(&g_sConfig));
+
+    //
+    // USBDeviceConfig(): find the largest packet size of each endpoint, then
+    // configure the endpoints of the default setting of each interface.
+    //
+    ulNumEndpoints = USBDCDConfigDescGetNum(&g_sConfig, USB_DTYPE_ENDPOINT);
+    ulNumInterfaces = USBDCDConfigDescGetNum(&g_sConfig, USB_DTYPE_INTERFACE);
+    RECORD(ulNumEndpoints);
+    RECORD(ulNumInterfaces);
+
+    for(ulLoop = 0; ulLoop < ulNumEndpoints; ulLoop++)
+    {
+        psEndpoint = (tEndpointDescriptor *)USBDCDConfigDescGet(
+            &g_sConfig, USB_DTYPE_ENDPOINT, ulLoop, &ulSection);
+        RECORD(psEndpoint);
+        RECORD(ulSection);
+    }
+
+    for(ulLoop = 0; ulLoop < ulNumInterfaces; ulLoop++)
+    {
+        psInterface = USBDCDConfigGetInterface(&g_sConfig, ulLoop,
+                                               USB_DESC_ANY, &ulSection);
+        RECORD(psInterface);
+        RECORD(ulSection);
+        if(psInterface && (psInterface->bAlternateSetting == 0))
+        {
+            for(ulEp = 0; ulEp < psInterface->bNumEndpoints; ulEp++)
+            {
+                RECORD(USBDCDConfigGetInterfaceEndpoint(&g_sConfig,
+                           psInterface->bInterfaceNumber,
+                           psInterface->bAlternateSetting, ulEp));
+            }
+        }
+    }
+
+    //
+    // SET_INTERFACE for each alternate setting of each interface, which finds
+    // the interface descriptor and then has USBDeviceConfigAlternate() find
+    // it again and configure its endpoints.  The number of alternate
+    // settings and each setting's descriptor are looked up directly as
+    // class drivers do.
+    //
+    for(ulIf = 0; ulIf < g_ulInterfaces; ulIf++)
+    {
+        ulNumAlts = USBDCDConfigGetNumAlternateInterfaces(&g_sConfig, ulIf);
+        RECORD(ulNumAlts);
+
+        for(ulAlt = 0; ulAlt < ulNumAlts; ulAlt++)
+        {
+            psInterface = USBDCDConfigGetInterface(&g_sConfig, ulIf, ulAlt,
+                                                   &ulSection);
+            RECORD(psInterface);
+            RECORD(ulSection);
+
+            for(ulLoop = 0; ulLoop < ulNumInterfaces; ulLoop++)
+            {
+                psInterface = USBDCDConfigGetInterface(&g_sConfig, ulLoop,
+                                                       USB_DESC_ANY,
+                                                       &ulSection);
+                if(psInterface && (psInterface->bInterfaceNumber == ulIf) &&
+                   (psInterface->bAlternateSetting == ulAlt))
+                {
+                    break;
+                }
+            }
+            RECORD(ulLoop);
+
+            for(ulEp = 0; psInterface && (ulEp < psInterface->bNumEndpoints);
+                ulEp++)
+            {
+                RECORD(USBDCDConfigGetInterfaceEndpoint(&g_sConfig, ulIf,
+                                                        ulAlt, ulEp));
+            }
+        }
+    }
+
+    return(ulCount);
+}
+
+//*****************************************************************************
+//
+// Looks up each endpoint of each interface descriptor by its position in the
+// configuration descriptor, passing USB_DESC_ANY as the alternate setting,
+// including one interface and one endpoint past the end of each.  Returns the
+// number of results, which are recorded in pulResults if it is not 0.
+//
+//*****************************************************************************
+static unsigned long
+EnumerateByPosition(unsigned long *pulResults)
+{
+    tInterfaceDescriptor *psInterface;
+    unsigned long ulNumInterfaces, ulLoop, ulEp, ulSection, ulCount;
+
+    ulCount = 0;
+    ulNumInterfaces = USBDCDConfigDescGetNum(&g_sConfig, USB_DTYPE_INTERFACE);
+
+    for(ulLoop = 0; ulLoop <= ulNumInterfaces; ulLoop++)
+    {
+        psInterface = USBDCDConfigGetInterface(&g_sConfig, ulLoop,
+                                               USB_DESC_ANY, &ulSection);
+        for(ulEp = 0; ulEp <= (psInterface ? psInterface->bNumEndpoints : 0);
+            ulEp++)
+        {
+            RECORD(USBDCDConfigGetInterfaceEndpoint(&g_sConfig, ulLoop,
+                                                    USB_DESC_ANY, ulEp));
+        }
+    }
+
+    return(ulCount);
+}
+
+//*****************************************************************************
+//
+// Checks that the index gives the same answer to every query made by
+// pfnQueries as walking the descriptor does.  The number of queries is
+// returned in *pulQueries and true is returned if the descriptor could be
+// indexed.
+//
+//*****************************************************************************
+static BOOL
+CheckQueries(unsigned long (*pfnQueries)(unsigned long *pulResults),
+             const char *pcName, unsigned long *pulQueries)
+{
+    unsigned long ulIndexed, ulWalked, ulLoop;
+    BOOL bIndexed;
+
+    USBDCDConfigDescIndex(0);
+    ulWalked = pfnQueries(g_pulWalked);
+    bIndexed = USBDCDConfigDescIndex(&g_sConfig);
+    ulIndexed = pfnQueries(g_pulIndexed);
+
+    CHECK(ulWalked <= MAX_RESULTS, "Too many %s results to compare.\n",
+          pcName);
+    CHECK(ulIndexed == ulWalked,
+          "%lu %s queries with the index against %lu without.\n", ulIndexed,
+          pcName, ulWalked);
+    for(ulLoop = 0; (ulLoop < ulWalked) && (ulLoop < MAX_RESULTS) &&
+                    (ulIndexed == ulWalked); ulLoop++)
+    {
+        CHECK(g_pulIndexed[ulLoop] == g_pulWalked[ulLoop],
+              "%s query result %lu differs with the index.\n", pcName,
+              ulLoop);
+    }
+
+    *pulQueries = ulWalked;
+
+    return(bIndexed);
+}
+
+//*****************************************************************************
+//
+// Returns the average time in nanoseconds and cycles taken by an
+// enumeration.
+//
+//*****************************************************************************
+static void
+TimeEnumeration(double *pdNs, double *pdCycles)
+{
+    unsigned long long ullStart, ullStartCycles;
+    unsigned long ulLoop;
+
+    ullStartCycles = Cycles();
+    ullStart = Nanoseconds();
+
+    for(ulLoop = 0; ulLoop < g_ulIterations; ulLoop++)
+    {
+        Enumerate(0);
+    }
+
+    *pdNs = (double)(Nanoseconds() - ullStart) / g_ulIterations;
+    *pdCycles = (double)(Cycles() - ullStartCycles) / g_ulIterations;
+}
+
+//*****************************************************************************
+//
+// Print the welcome banner.
+//
+//*****************************************************************************
+void
+PrintWelcome(void)
+{
+    QUIETPRINT("\nenumbench - Time USB device enumeration descriptor "
+               "queries.\n\n");
+}
+
+//*****************************************************************************
+//
+// Show help on the application's command line parameters.
+//
+//*****************************************************************************
+void
+ShowHelp(void)
+{
+    //
+    // Only print help if we are not in quiet mode.
+    //
+    if(g_bQuiet)
+    {
+        return;
+    }
+
+    printf("This application builds usblib/device/usbdcdesc.c for the host\n");
+    printf("and makes the configuration descriptor queries that the device\n");
+    printf("stack makes during enumeration on a composite style descriptor.\n");
+    printf("It checks that every query returns the same result with the\n");
+    printf("configuration descriptor index as without, and reports the\n");
+    printf("time taken to build the index and to enumerate with and\n");
+    printf("without it.  Times are for the host, so only the ratio between\n");
+    printf("them carries over to a target.\n\n");
+    printf("Supported parameters are:\n\n");
+    printf("-i <num>  - Describe the given number of interfaces, up to %d\n",
+           MAX_INTERFACES);
+    printf("            (default 4).\n");
+    printf("-a <num>  - Give each interface the given number of alternate\n");
+    printf("            settings, up to %d (default 2).\n", MAX_ALTERNATES);
+    printf("-p <num>  - Give each setting the given number of endpoints,\n");
+    printf("            up to %d (default 2).\n", MAX_ENDPOINTS);
+    printf("-n <num>  - Time the given number of enumerations (default\n");
+    printf("            100000).\n");
+    printf("-? or -h  - Show this help.\n");
+    printf("-q        - Quiet mode. Disable output to stdio.\n");
+    printf("-e        - Enable verbose output.\n\n");
+    printf("Example:\n\n");
+    printf("   enumbench -i 8 -a 2 -p 1\n\n");
+}
+
+//*****************************************************************************
+//
+// Parse the command line, extracting all parameters.
+//
+// Returns 0 on failure, 1 on success.
+//
+//*****************************************************************************
+int
+ParseCommandLine(int argc, char *argv[])
+{
+    int iRetcode;
+    BOOL bShowHelp;
+
+    //
+    // By default, don't show the help screen.
+    //
+    bShowHelp = FALSE;
+
+    while(1)
+    {
+        //
+        // Get the next command line parameter.
+        //
+        iRetcode = getopt(argc, argv, "i:a:p:n:eh?q");
+
+        if(iRetcode == -1)
+        {
+            break;
+        }
+
+        switch(iRetcode)
+        {
+            case 'i':
+                g_ulInterfaces = strtoul(optarg, NULL, 0);
+                break;
+
+            case 'a':
+                g_ulAlternates = strtoul(optarg, NULL, 0);
+                break;
+
+            case 'p':
+                g_ulEndpoints = strtoul(optarg, NULL, 0);
+                break;
+
+            case 'n':
+                g_ulIterations = strtoul(optarg, NULL, 0);
+                break;
+
+            case 'e':
+                g_bVerbose = TRUE;
+                break;
+
+            case 'q':
+                g_bQuiet = TRUE;
+                break;
+
+            case '?':
+            case 'h':
+                bShowHelp = TRUE;
+                break;
+        }
+    }
+
+    //
+    // Show the welcome banner unless we have been told to be quiet.
+    //
+    PrintWelcome();
+
+    //
+    // Catch various invalid parameter cases.
+    //
+    if(bShowHelp || (g_ulInterfaces == 0) ||
+       (g_ulInterfaces > MAX_INTERFACES) || (g_ulAlternates == 0) ||
+       (g_ulAlternates > MAX_ALTERNATES) || (g_ulEndpoints > MAX_ENDPOINTS) ||
+       (g_ulIterations == 0) || (optind != argc))
+    {
+        ShowHelp();
+        return(0);
+    }
+
+    return(1);
+}
+
+//*****************************************************************************
+//
+// The main entry point of the application.
+//
+//*****************************************************************************
+int
+main(int argc, char *argv[])
+{
+    unsigned long ulWalked, ulLoop;
+    unsigned long long ullStart, ullStartCycles;
+    double dIndexNs, dIndexCycles, dIndexedNs, dIndexedCycles;
+    double dWalkedNs, dWalkedCycles;
+    BOOL bIndexed;
+
+    if(!ParseCommandLine(argc, argv))
+    {
+        return(1);
+    }
+
+    BuildConfigDescriptor();
+
+    QUIETPRINT("%lu interfaces with %lu alternate settings of %lu endpoints, "
+               "%lu bytes.\n\n", g_ulInterfaces, g_ulAlternates,
+               g_ulEndpoints, USBDCDConfigDescGetSize(&g_sConfig));
+
+    //
+    // Check that the index gives the same answer to every query as walking
+    // the descriptor does, both for the enumeration and for endpoints looked
+    // up by interface position.
+    //
+    CheckQueries(EnumerateByPosition, "Position", &ulLoop);
+    bIndexed = CheckQueries(Enumerate, "Enumeration", &ulWalked);
+
+    if(!bIndexed)
+    {
+        QUIETPRINT("The descriptor is too large to be indexed, so only the "
+                   "walk is timed.\n\n");
+    }
+
+    //
+    // Time building the index, as SET_CONFIGURATION does.
+    //
+    ullStartCycles = Cycles();
+    ullStart = Nanoseconds();
+    for(ulLoop = 0; ulLoop < g_ulIterations; ulLoop++)
+    {
+        USBDCDConfigDescIndex(&g_sConfig);
+    }
+    dIndexNs = (double)(Nanoseconds() - ullStart) / g_ulIterations;
+    dIndexCycles = (double)(Cycles() - ullStartCycles) / g_ulIterations;
+
+    //
+    // Time enumerating with and without the index.
+    //
+    TimeEnumeration(&dIndexedNs, &dIndexedCycles);
+    USBDCDConfigDescIndex(0);
+    TimeEnumeration(&dWalkedNs, &dWalkedCycles);
+
+    QUIETPRINT("%-22s %12s %12s\n", "", "ns", "cycles");
+    if(bIndexed)
+    {
+        QUIETPRINT("%-22s %12.1f %12.1f\n", "Build index", dIndexNs,
+                   dIndexCycles);
+        QUIETPRINT("%-22s %12.1f %12.1f\n", "Enumerate, indexed",
+                   dIndexedNs, dIndexedCycles);
+    }
+    QUIETPRINT("%-22s %12.1f %12.1f\n", "Enumerate, walked", dWalkedNs,
+               dWalkedCycles);
+    QUIETPRINT("\n%lu queries per enumeration", ulWalked);
+    if(bIndexed)
+    {
+        QUIETPRINT(", %.1fx faster with the index, including building it",
+                   dWalkedNs / (dIndexNs + dIndexedNs));
+    }
+    QUIETPRINT(".\n");
+
+    QUIETPRINT("\n%s: %lu checks failed.\n", g_ulFailed ? "FAILED" : "PASSED",
+               g_ulFailed);
+
+    return(g_ulFailed ? 1 : 0);
+}
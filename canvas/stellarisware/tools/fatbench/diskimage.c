@@ -0,0 +1,385 @@
+//*****************************************************************************
+//
+// diskimage.c - A FatFs disk driver that keeps drive 0 in an image file on
+//               the host, so that the file system can be exercised and
+//               measured without the target.
+//
+// The image is mapped into memory, so that the cost of the host file system
+// does not show up in the measurements.  A delay can be added to each
+// command to stand in for a slower disk, and commands can be failed on
+// purpose to exercise the error paths of the file system.
+//
+//*****************************************************************************
+
+#include <stdio.h>
+#include <string.h>
+#include <fcntl.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include "diskio.h"
+#include "diskimage.h"
+
+//*****************************************************************************
+//
+// The size of a sector, which is the only size that FatFs is built for.
+//
+//*****************************************************************************
+#define SECTOR_SIZE             512
+
+//*****************************************************************************
+//
+// The image file, where it is mapped, its size in sectors, and the status of
+// the drive.
+//
+//*****************************************************************************
+static int g_iImage = -1;
+static unsigned char *g_pucImage;
+static unsigned long g_ulSectors;
+static DSTATUS g_ucStatus = STA_NOINIT | STA_NODISK;
+
+//*****************************************************************************
+//
+// The commands and sectors seen since the counts were last cleared.
+//
+//*****************************************************************************
+static tDiskImageStats g_sStats;
+
+//*****************************************************************************
+//
+// The delay added to each command and to each sector it moves, in
+// microseconds.
+//
+//*****************************************************************************
+static unsigned long g_ulCommandUS;
+static unsigned long g_ulSectorUS;
+
+//*****************************************************************************
+//
+// The faults to inject: every so many commands fail, counting from when this
+// was set, as does any command that touches the bad sector.
+//
+//*****************************************************************************
+static unsigned long g_ulFaultEvery;
+static unsigned long g_ulFaultCount;
+static unsigned long g_ulBadSector = DISKIMAGE_NO_SECTOR;
+
+//*****************************************************************************
+//
+// Opens an image file and makes it the disk in drive 0.  If a number of
+// sectors is given, a new image of that size is created, replacing any file
+// that is already there.  Otherwise, the existing image is used, and its size
+// is taken from the file.
+//
+// Returns 0 on success or -1 if the file could not be opened or mapped.
+//
+//*****************************************************************************
+int
+DiskImageOpen(const char *pcPath, unsigned long ulSectors)
+{
+    struct stat sStat;
+    void *pvImage;
+
+    DiskImageClose();
+
+    g_iImage = open(pcPath, ulSectors ? (O_RDWR | O_CREAT | O_TRUNC) : O_RDWR,
+                    0644);
+    if(g_iImage < 0)
+    {
+        return(-1);
+    }
+
+    if(ulSectors)
+    {
+        //
+        // Size the file.  Unwritten sectors read as zero and take no space.
+        //
+        if(ftruncate(g_iImage, (off_t)ulSectors * SECTOR_SIZE) != 0)
+        {
+            DiskImageClose();
+            return(-1);
+        }
+    }
+    else
+    {
+        //
+        // Use as many whole sectors as there are in the file.
+        //
+        if(fstat(g_iImage, &sStat) != 0)
+        {
+            DiskImageClose();
+            return(-1);
+        }
+        ulSectors = sStat.st_size / SECTOR_SIZE;
+    }
+
+    if(!ulSectors)
+    {
+        DiskImageClose();
+        return(-1);
+    }
+
+    pvImage = mmap(NULL, (size_t)ulSectors * SECTOR_SIZE,
+                   PROT_READ | PROT_WRITE, MAP_SHARED, g_iImage, 0);
+    if(pvImage == MAP_FAILED)
+    {
+        DiskImageClose();
+        return(-1);
+    }
+
+    g_pucImage = pvImage;
+    g_ulSectors = ulSectors;
+    g_ucStatus = STA_NOINIT;
+    DiskImageStatsClear();
+
+    return(0);
+}
+
+//*****************************************************************************
+//
+// Removes the disk from drive 0, and writes back and closes the image file.
+//
+//*****************************************************************************
+void
+DiskImageClose(void)
+{
+    if(g_pucImage)
+    {
+        msync(g_pucImage, (size_t)g_ulSectors * SECTOR_SIZE, MS_SYNC);
+        munmap(g_pucImage, (size_t)g_ulSectors * SECTOR_SIZE);
+        g_pucImage = NULL;
+    }
+
+    if(g_iImage >= 0)
+    {
+        close(g_iImage);
+        g_iImage = -1;
+    }
+
+    g_ulSectors = 0;
+    g_ucStatus = STA_NOINIT | STA_NODISK;
+}
+
+//*****************************************************************************
+//
+// Returns or clears the commands and sectors seen by the driver.
+//
+//*****************************************************************************
+void
+DiskImageStatsGet(tDiskImageStats *psStats)
+{
+    *psStats = g_sStats;
+}
+
+void
+DiskImageStatsClear(void)
+{
+    memset(&g_sStats, 0, sizeof(g_sStats));
+}
+
+//*****************************************************************************
+//
+// Sets the delay added to each command, and to each sector that a command
+// reads or writes, in microseconds.  Zero for both runs at the speed of the
+// host.
+//
+//*****************************************************************************
+void
+DiskImageLatencySet(unsigned long ulCommandUS, unsigned long ulSectorUS)
+{
+    g_ulCommandUS = ulCommandUS;
+    g_ulSectorUS = ulSectorUS;
+}
+
+//*****************************************************************************
+//
+// Sets the commands that fail.  Every command numbered a multiple of ulEvery
+// from now on fails, or none if it is zero, and so does every command that
+// touches ulSector, or none if it is DISKIMAGE_NO_SECTOR.  A failed read
+// leaves the buffer untouched, and a failed write leaves the image untouched.
+//
+//*****************************************************************************
+void
+DiskImageFaultSet(unsigned long ulEvery, unsigned long ulSector)
+{
+    g_ulFaultEvery = ulEvery;
+    g_ulFaultCount = 0;
+    g_ulBadSector = ulSector;
+}
+
+//*****************************************************************************
+//
+// Waits for the delay of a command, and decides whether the command fails.
+// The delay is timed by spinning on the clock, since sleeping is far too
+// coarse for delays of a few microseconds.
+//
+// Returns 1 if the command is to fail, or 0 if it is to go ahead.
+//
+//*****************************************************************************
+static int
+DiskImageCommand(DWORD sector, BYTE count)
+{
+    struct timespec sNow;
+    unsigned long long ullEnd, ullNow;
+
+    if(g_ulCommandUS || g_ulSectorUS)
+    {
+        clock_gettime(CLOCK_MONOTONIC, &sNow);
+        ullNow = ((unsigned long long)sNow.tv_sec * 1000000000ULL) +
+                 sNow.tv_nsec;
+        ullEnd = ullNow + (((unsigned long long)g_ulCommandUS +
+                            ((unsigned long long)g_ulSectorUS * count)) *
+                           1000);
+        while(ullNow < ullEnd)
+        {
+            clock_gettime(CLOCK_MONOTONIC, &sNow);
+            ullNow = ((unsigned long long)sNow.tv_sec * 1000000000ULL) +
+                     sNow.tv_nsec;
+        }
+    }
+
+    if((g_ulFaultEvery && ((++g_ulFaultCount % g_ulFaultEvery) == 0)) ||
+       ((g_ulBadSector >= sector) && (g_ulBadSector < (sector + count))))
+    {
+        g_sStats.ulErrors++;
+        return(1);
+    }
+
+    return(0);
+}
+
+//*****************************************************************************
+//
+// The FatFs disk functions.
+//
+//*****************************************************************************
+DSTATUS
+disk_initialize(BYTE drv)
+{
+    if(drv)
+    {
+        return(STA_NOINIT);
+    }
+
+    if(!(g_ucStatus & STA_NODISK))
+    {
+        g_ucStatus &= ~STA_NOINIT;
+    }
+
+    return(g_ucStatus);
+}
+
+DSTATUS
+disk_status(BYTE drv)
+{
+    return(drv ? STA_NOINIT : g_ucStatus);
+}
+
+DRESULT
+disk_read(BYTE drv, BYTE *buff, DWORD sector, BYTE count)
+{
+    if(drv || !count)
+    {
+        return(RES_PARERR);
+    }
+
+    if(g_ucStatus & STA_NOINIT)
+    {
+        return(RES_NOTRDY);
+    }
+
+    if((sector + count) > g_ulSectors)
+    {
+        return(RES_PARERR);
+    }
+
+    g_sStats.ulReads++;
+    g_sStats.ulReadSectors += count;
+
+    if(DiskImageCommand(sector, count))
+    {
+        return(RES_ERROR);
+    }
+
+    memcpy(buff, g_pucImage + ((size_t)sector * SECTOR_SIZE),
+           (size_t)count * SECTOR_SIZE);
+
+    return(RES_OK);
+}
+
+DRESULT
+disk_write(BYTE drv, const BYTE *buff, DWORD sector, BYTE count)
+{
+    if(drv || !count)
+    {
+        return(RES_PARERR);
+    }
+
+    if(g_ucStatus & STA_NOINIT)
+    {
+        return(RES_NOTRDY);
+    }
+
+    if((sector + count) > g_ulSectors)
+    {
+        return(RES_PARERR);
+    }
+
+    g_sStats.ulWrites++;
+    g_sStats.ulWriteSectors += count;
+
+    if(DiskImageCommand(sector, count))
+    {
+        return(RES_ERROR);
+    }
+
+    memcpy(g_pucImage + ((size_t)sector * SECTOR_SIZE), buff,
+           (size_t)count * SECTOR_SIZE);
+
+    return(RES_OK);
+}
+
+DRESULT
+disk_ioctl(BYTE drv, BYTE ctrl, void *buff)
+{
+    if(drv)
+    {
+        return(RES_PARERR);
+    }
+
+    if(g_ucStatus & STA_NOINIT)
+    {
+        return(RES_NOTRDY);
+    }
+
+    switch(ctrl)
+    {
+        case GET_SECTOR_COUNT:
+        {
+            *(DWORD *)buff = g_ulSectors;
+            return(RES_OK);
+        }
+
+        case GET_SECTOR_SIZE:
+        {
+            *(WORD *)buff = SECTOR_SIZE;
+            return(RES_OK);
+        }
+
+        //
+        // The mapping is written back when the image is closed.  Writing it
+        // back here would measure the host disk rather than FatFs.
+        //
+        case CTRL_SYNC:
+        {
+            return(RES_OK);
+        }
+
+        default:
+        {
+            return(RES_PARERR);
+        }
+    }
+}
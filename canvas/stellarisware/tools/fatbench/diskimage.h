@@ -0,0 +1,46 @@
+//*****************************************************************************
+//
+// diskimage.h - Prototypes for the FatFs disk driver backed by an image file.
+//
+//*****************************************************************************
+
+#ifndef __DISKIMAGE_H__
+#define __DISKIMAGE_H__
+
+//*****************************************************************************
+//
+// The number of commands and sectors seen by the disk driver since the
+// counts were last cleared, and the number of commands failed on purpose.
+//
+//*****************************************************************************
+typedef struct
+{
+    unsigned long ulReads;
+    unsigned long ulReadSectors;
+    unsigned long ulWrites;
+    unsigned long ulWriteSectors;
+    unsigned long ulErrors;
+}
+tDiskImageStats;
+
+//*****************************************************************************
+//
+// The value passed to DiskImageFaultSet() for no bad sector.
+//
+//*****************************************************************************
+#define DISKIMAGE_NO_SECTOR     0xffffffff
+
+//*****************************************************************************
+//
+// Prototypes for the APIs.
+//
+//*****************************************************************************
+extern int DiskImageOpen(const char *pcPath, unsigned long ulSectors);
+extern void DiskImageClose(void);
+extern void DiskImageStatsGet(tDiskImageStats *psStats);
+extern void DiskImageStatsClear(void);
+extern void DiskImageLatencySet(unsigned long ulCommandUS,
+                                unsigned long ulSectorUS);
+extern void DiskImageFaultSet(unsigned long ulEvery, unsigned long ulSector);
+
+#endif // __DISKIMAGE_H__
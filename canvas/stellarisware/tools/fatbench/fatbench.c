@@ -0,0 +1,917 @@
+//*****************************************************************************
+//
+// fatbench.c - A command line utility that measures FatFs file access on the
+//              host, with the disk held in an image file.
+//
+//*****************************************************************************
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#include "ff.h"
+#include "fatfs/port/fat_bench.h"
+#include "diskimage.h"
+
+//*****************************************************************************
+//
+// The largest single read or write, which must fit in a WORD.
+//
+//*****************************************************************************
+#define MAX_CHUNK               32768
+
+//*****************************************************************************
+//
+// Globals controlled by various command line parameters.
+//
+//*****************************************************************************
+BOOL g_bVerbose       = FALSE;
+BOOL g_bQuiet         = FALSE;
+BOOL g_bExisting      = FALSE;
+const char *g_pcImage = "fatbench.img";
+unsigned long g_ulImageMB      = 64;
+unsigned long g_ulClusterSize  = 4;
+unsigned long g_ulFileKB       = 4096;
+unsigned long g_ulSeeks        = 2000;
+unsigned long g_ulRecordSize   = 512;
+unsigned long g_ulSyncCount    = 8;
+unsigned long g_ulFiles        = 200;
+unsigned long g_ulSmallSize    = 1024;
+unsigned long g_ulCommandUS    = 0;
+unsigned long g_ulSectorUS     = 0;
+unsigned long g_ulFaultEvery   = 0;
+unsigned long g_ulBadSector    = DISKIMAGE_NO_SECTOR;
+
+//*****************************************************************************
+//
+// Helpful macros for generating output depending upon verbose and quiet flags.
+//
+//*****************************************************************************
+#define VERBOSEPRINT(...) if(g_bVerbose) { printf(__VA_ARGS__); }
+#define QUIETPRINT(...) if(!g_bQuiet) { printf(__VA_ARGS__); }
+
+//*****************************************************************************
+//
+// Stops the utility if a FatFs call fails.
+//
+//*****************************************************************************
+#define CHECK(xCall)                                                          \
+    {                                                                         \
+        FRESULT xCheckResult = (xCall);                                       \
+        if(xCheckResult != FR_OK)                                             \
+        {                                                                     \
+            CheckFailed(#xCall, xCheckResult, __LINE__);                      \
+        }                                                                     \
+    }
+
+//*****************************************************************************
+//
+// The files measured.  The contiguous file is written in one go onto an empty
+// volume.  The fragmented file is written a cluster at a time, alternately
+// with a filler file, so that no two of its clusters are adjacent.
+//
+//*****************************************************************************
+#define CONTIG_FILE             "CONTIG.BIN"
+#define FRAG_FILE               "FRAG.BIN"
+#define FILL_FILE               "FILL.BIN"
+#define LOG_FILE                "LOG.BIN"
+
+//*****************************************************************************
+//
+// The mounted volume and a buffer for reads and writes.
+//
+//*****************************************************************************
+static FATFS g_sFatFs;
+static unsigned char g_pucBuffer[MAX_CHUNK];
+
+//*****************************************************************************
+//
+// Reports a failed FatFs call and stops.
+//
+//*****************************************************************************
+static void
+CheckFailed(const char *pcCall, FRESULT eResult, int iLine)
+{
+    fflush(stdout);
+    fprintf(stderr, "Line %d: %s returned %d\n", iLine, pcCall, eResult);
+    exit(1);
+}
+
+//*****************************************************************************
+//
+// Returns the current time in nanoseconds.
+//
+//*****************************************************************************
+static unsigned long long
+Now(void)
+{
+    struct timespec sNow;
+
+    clock_gettime(CLOCK_MONOTONIC, &sNow);
+    return(((unsigned long long)sNow.tv_sec * 1000000000ULL) + sNow.tv_nsec);
+}
+
+//*****************************************************************************
+//
+// The functions given to the benchmark suite.  The suite passes an unsigned
+// long to every %u, as UARTprintf() expects on the target, so each one is
+// widened to %lu before the format is handed to printf().
+//
+//*****************************************************************************
+static void
+SuitePrintf(const char *pcString, ...)
+{
+    char pcFormat[128], *pcOut;
+    BOOL bConversion;
+    va_list vaArgP;
+
+    if(g_bQuiet)
+    {
+        return;
+    }
+
+    bConversion = FALSE;
+    for(pcOut = pcFormat;
+        *pcString && (pcOut < (pcFormat + sizeof(pcFormat) - 2)); pcString++)
+    {
+        if(bConversion && (*pcString == 'u'))
+        {
+            *pcOut++ = 'l';
+        }
+        if(*pcString == '%')
+        {
+            bConversion = !bConversion;
+        }
+        else if((*pcString < '0') || (*pcString > '9'))
+        {
+            bConversion = FALSE;
+        }
+        *pcOut++ = *pcString;
+    }
+    *pcOut = '\0';
+
+    va_start(vaArgP, pcString);
+    vprintf(pcFormat, vaArgP);
+    va_end(vaArgP);
+}
+
+static unsigned long
+SuiteMicroseconds(void)
+{
+    return((unsigned long)(Now() / 1000));
+}
+
+static void
+SuiteDiskCounts(unsigned long *pulCommands, unsigned long *pulSectors)
+{
+    tDiskImageStats sStats;
+
+    DiskImageStatsGet(&sStats);
+    *pulCommands = sStats.ulReads + sStats.ulWrites;
+    *pulSectors = sStats.ulReadSectors + sStats.ulWriteSectors;
+}
+
+//*****************************************************************************
+//
+// A simple pseudo random number generator, so that every run seeks to the
+// same offsets on every host.
+//
+//*****************************************************************************
+static unsigned long g_ulRandom;
+
+static unsigned long
+Random(void)
+{
+    g_ulRandom = (g_ulRandom * 1664525) + 1013904223;
+    return((g_ulRandom >> 8) & 0xffffff);
+}
+
+//*****************************************************************************
+//
+// The value of the byte at a given offset in a file.  The seed differs
+// between files so that reading from the wrong file is caught.
+//
+//*****************************************************************************
+static unsigned char
+Pattern(unsigned long ulSeed, unsigned long ulOffset)
+{
+    return((unsigned char)(ulSeed ^ ulOffset ^ (ulOffset >> 8) ^
+                           (ulOffset >> 16)));
+}
+
+static void
+FillPattern(unsigned char *pucData, unsigned long ulSeed,
+            unsigned long ulOffset, unsigned long ulCount)
+{
+    while(ulCount--)
+    {
+        *pucData++ = Pattern(ulSeed, ulOffset++);
+    }
+}
+
+static void
+CheckPattern(const unsigned char *pucData, unsigned long ulSeed,
+             unsigned long ulOffset, unsigned long ulCount)
+{
+    while(ulCount--)
+    {
+        if(*pucData++ != Pattern(ulSeed, ulOffset))
+        {
+            fprintf(stderr, "File data corrupted at offset %lu.\n", ulOffset);
+            exit(1);
+        }
+
+        ulOffset++;
+    }
+}
+
+//*****************************************************************************
+//
+// Appends a number of bytes of the pattern to an open file.
+//
+//*****************************************************************************
+static void
+AppendPattern(FIL *psFile, unsigned long ulSeed, unsigned long ulCount)
+{
+    unsigned long ulChunk;
+    WORD usWritten;
+
+    while(ulCount)
+    {
+        ulChunk = (ulCount > MAX_CHUNK) ? MAX_CHUNK : ulCount;
+        FillPattern(g_pucBuffer, ulSeed, psFile->fptr, ulChunk);
+        CHECK(f_write(psFile, g_pucBuffer, (WORD)ulChunk, &usWritten));
+        if(usWritten != ulChunk)
+        {
+            fprintf(stderr, "The disk image is full.\n");
+            exit(1);
+        }
+
+        ulCount -= ulChunk;
+    }
+}
+
+//*****************************************************************************
+//
+// Unmounts and remounts the volume, as after a reset.  Anything the file
+// system had in memory, the window, the cache and the allocation hints, is
+// lost, and has to be read again from the disk.
+//
+//*****************************************************************************
+static void
+Remount(void)
+{
+    CHECK(f_mount(0, NULL));
+    CHECK(f_mount(0, &g_sFatFs));
+}
+
+//*****************************************************************************
+//
+// Formats the image and writes the files to be measured.
+//
+//*****************************************************************************
+static void
+CreateVolume(void)
+{
+    unsigned long ulSize, ulCluster;
+    FIL sFrag, sFill;
+
+    if(DiskImageOpen(g_pcImage, g_ulImageMB * 2048) != 0)
+    {
+        fprintf(stderr, "Unable to create image file %s.\n", g_pcImage);
+        exit(1);
+    }
+
+    CHECK(f_mount(0, &g_sFatFs));
+    CHECK(f_mkfs(0, 0, (BYTE)g_ulClusterSize));
+
+    ulSize = g_ulFileKB * 1024;
+    ulCluster = g_ulClusterSize * 512;
+
+    CHECK(f_open(&sFrag, CONTIG_FILE, FA_WRITE | FA_CREATE_ALWAYS));
+    AppendPattern(&sFrag, 1, ulSize);
+    CHECK(f_close(&sFrag));
+
+    CHECK(f_open(&sFrag, FRAG_FILE, FA_WRITE | FA_CREATE_ALWAYS));
+    CHECK(f_open(&sFill, FILL_FILE, FA_WRITE | FA_CREATE_ALWAYS));
+    while(sFrag.fptr < ulSize)
+    {
+        AppendPattern(&sFrag, 2, ((ulSize - sFrag.fptr) > ulCluster) ?
+                      ulCluster : (ulSize - sFrag.fptr));
+        AppendPattern(&sFill, 3, ulCluster);
+    }
+    CHECK(f_close(&sFill));
+    CHECK(f_close(&sFrag));
+
+    VERBOSEPRINT("Formatted %lu MB image %s as FAT%s, %lu byte clusters.\n",
+                 g_ulImageMB, g_pcImage,
+                 (g_sFatFs.fs_type == FS_FAT12) ? "12" :
+                 (g_sFatFs.fs_type == FS_FAT16) ? "16" : "32", ulCluster);
+
+    //
+    // Remount so that nothing is left in the window from writing the files.
+    //
+    Remount();
+}
+
+//*****************************************************************************
+//
+// Opens an existing image, as made by mkfs.fat or copied from a card, and
+// mounts it.
+//
+//*****************************************************************************
+static void
+OpenVolume(void)
+{
+    if(DiskImageOpen(g_pcImage, 0) != 0)
+    {
+        fprintf(stderr, "Unable to open image file %s.\n", g_pcImage);
+        exit(1);
+    }
+
+    CHECK(f_mount(0, &g_sFatFs));
+}
+
+//*****************************************************************************
+//
+// Runs the benchmark suite that is shared with the target, on a freshly
+// mounted volume.
+//
+//*****************************************************************************
+static void
+RunSuite(void)
+{
+    tFatBenchParams sParams;
+    tDiskImageStats sStats;
+
+    Remount();
+
+    sParams.ucDrive = 0;
+    sParams.pucBuffer = g_pucBuffer;
+    sParams.ulBufferSize = MAX_CHUNK;
+    sParams.ulFileSize = g_ulFileKB * 1024;
+    sParams.ulSeeks = g_ulSeeks;
+    sParams.ulRecordSize = g_ulRecordSize;
+    sParams.ulFiles = g_ulFiles;
+    sParams.ulSmallSize = g_ulSmallSize;
+    sParams.pfnPrintf = SuitePrintf;
+    sParams.pfnMicroseconds = SuiteMicroseconds;
+    sParams.pfnDiskCounts = SuiteDiskCounts;
+
+    if(FatBenchRun(&sParams) != FR_OK)
+    {
+        DiskImageStatsGet(&sStats);
+        fflush(stdout);
+        fprintf(stderr, "The benchmark suite failed, with %lu disk errors "
+                "injected.\n", sStats.ulErrors);
+        exit(1);
+    }
+}
+
+//*****************************************************************************
+//
+// Opens a file for reading and, if asked to, builds its link map.  The table
+// is sized by asking f_linkmap how much it needs.
+//
+//*****************************************************************************
+static DWORD *
+OpenFile(FIL *psFile, const char *pcName, BOOL bMap)
+{
+    DWORD pulProbe[4], *pulMap;
+    FRESULT eResult;
+
+    CHECK(f_open(psFile, pcName, FA_READ));
+    if(!bMap)
+    {
+        return(NULL);
+    }
+
+    pulProbe[0] = 4;
+    eResult = f_linkmap(psFile, pulProbe);
+    if((eResult != FR_OK) && (eResult != FR_NOT_ENOUGH_CORE))
+    {
+        CheckFailed("f_linkmap", eResult, __LINE__);
+    }
+
+    pulMap = malloc(pulProbe[0] * sizeof(DWORD));
+    if(!pulMap)
+    {
+        fprintf(stderr, "Out of memory.\n");
+        exit(1);
+    }
+
+    pulMap[0] = pulProbe[0];
+    CHECK(f_linkmap(psFile, pulMap));
+
+    return(pulMap);
+}
+
+//*****************************************************************************
+//
+// Reads records from random offsets in a file.
+//
+//*****************************************************************************
+static void
+RandomRead(FIL *psFile, unsigned long ulSeed)
+{
+    unsigned long ulCount, ulOffset;
+    WORD usRead;
+
+    g_ulRandom = 1;
+    for(ulCount = 0; ulCount < g_ulSeeks; ulCount++)
+    {
+        ulOffset = Random() % (psFile->fsize - g_ulRecordSize + 1);
+        CHECK(f_lseek(psFile, ulOffset));
+        CHECK(f_read(psFile, g_pucBuffer, (WORD)g_ulRecordSize, &usRead));
+        if(usRead != g_ulRecordSize)
+        {
+            fprintf(stderr, "Short read at offset %lu.\n", ulOffset);
+            exit(1);
+        }
+        CheckPattern(g_pucBuffer, ulSeed, ulOffset, usRead);
+    }
+}
+
+//*****************************************************************************
+//
+// Reads a file from start to end in the largest chunks possible.
+//
+//*****************************************************************************
+static void
+SequentialRead(FIL *psFile, unsigned long ulSeed)
+{
+    unsigned long ulOffset;
+    WORD usRead;
+
+    for(ulOffset = 0; ulOffset < psFile->fsize; ulOffset += usRead)
+    {
+        CHECK(f_read(psFile, g_pucBuffer, MAX_CHUNK, &usRead));
+        if(!usRead)
+        {
+            fprintf(stderr, "Short read at offset %lu.\n", ulOffset);
+            exit(1);
+        }
+        CheckPattern(g_pucBuffer, ulSeed, ulOffset, usRead);
+    }
+}
+
+//*****************************************************************************
+//
+// Runs one measurement and prints its results.
+//
+//*****************************************************************************
+static void
+Measure(const char *pcTest, const char *pcName, unsigned long ulSeed,
+        BOOL bMap, void (*pfnTest)(FIL *, unsigned long),
+        unsigned long ulOps)
+{
+    tDiskImageStats sStats;
+    unsigned long long ullTime;
+    DWORD *pulMap;
+    FIL sFile;
+
+    pulMap = OpenFile(&sFile, pcName, bMap);
+
+    DiskImageStatsClear();
+    ullTime = Now();
+    pfnTest(&sFile, ulSeed);
+    ullTime = Now() - ullTime;
+    DiskImageStatsGet(&sStats);
+
+    CHECK(f_close(&sFile));
+    free(pulMap);
+
+    QUIETPRINT("%-12s %-11s %-9s %10lu %10lu %10.2f %10.1f\n", pcTest, pcName,
+               bMap ? "link map" : "FAT", sStats.ulReads, sStats.ulReadSectors,
+               (double)sStats.ulReads / ulOps, (double)ullTime / 1000.0 / ulOps);
+}
+
+//*****************************************************************************
+//
+// Writes a log file a record at a time, syncing it every few records as a
+// data logger would, and prints the disk commands and time taken per record.
+// The worst case is what a logger has to buffer for.  The file is optionally
+// preallocated first, which is counted in the totals but not in the worst
+// case.
+//
+//*****************************************************************************
+static void
+MeasureAppend(BOOL bPrealloc)
+{
+    tDiskImageStats sStats;
+    unsigned long long ullTime, ullStart;
+    unsigned long ulRecords, ulRecord, ulCmds, ulPrev, ulMax, ulReads;
+    FIL sFile;
+    WORD usWritten;
+
+    Remount();
+
+    ulRecords = (g_ulFileKB * 1024) / g_ulRecordSize;
+    ullTime = 0;
+    ulMax = 0;
+
+    DiskImageStatsClear();
+    CHECK(f_open(&sFile, LOG_FILE, FA_WRITE | FA_CREATE_ALWAYS));
+    if(bPrealloc)
+    {
+        CHECK(f_prealloc(&sFile, ulRecords * g_ulRecordSize));
+    }
+    DiskImageStatsGet(&sStats);
+    ulPrev = sStats.ulReads + sStats.ulWrites;
+
+    for(ulRecord = 0; ulRecord < ulRecords; ulRecord++)
+    {
+        FillPattern(g_pucBuffer, 4, sFile.fptr, g_ulRecordSize);
+
+        ullStart = Now();
+        CHECK(f_write(&sFile, g_pucBuffer, (WORD)g_ulRecordSize, &usWritten));
+        if(((ulRecord + 1) % g_ulSyncCount) == 0)
+        {
+            CHECK(f_sync(&sFile));
+        }
+        ullStart = Now() - ullStart;
+
+        DiskImageStatsGet(&sStats);
+        ulCmds = sStats.ulReads + sStats.ulWrites;
+        if((ulCmds - ulPrev) > ulMax)
+        {
+            ulMax = ulCmds - ulPrev;
+        }
+        ulPrev = ulCmds;
+        ullTime += ullStart;
+    }
+
+    CHECK(f_close(&sFile));
+    DiskImageStatsGet(&sStats);
+    ulReads = sStats.ulReads;
+
+    QUIETPRINT("%-12s %-9s %10lu %10lu %10lu %10.2f %10.1f\n",
+               "Append", bPrealloc ? "prealloc" : "on demand", ulReads,
+               sStats.ulWrites, ulMax,
+               (double)(ulReads + sStats.ulWrites) / ulRecords,
+               (double)ullTime / 1000.0 / ulRecords);
+
+    CHECK(f_unlink(LOG_FILE));
+}
+
+//*****************************************************************************
+//
+// Counts the free clusters just after mounting the volume.
+//
+//*****************************************************************************
+static void
+MeasureFree(void)
+{
+    tDiskImageStats sStats;
+    unsigned long long ullTime;
+    FATFS *psFatFs;
+    DWORD ulFree;
+
+    Remount();
+
+    DiskImageStatsClear();
+    ullTime = Now();
+    CHECK(f_getfree("", &ulFree, &psFatFs));
+    ullTime = Now() - ullTime;
+    DiskImageStatsGet(&sStats);
+
+    QUIETPRINT("%-12s %-9s %10lu %10lu %10lu %10.2f %10.1f\n",
+               "Free count", "", sStats.ulReads, sStats.ulWrites,
+               sStats.ulReads + sStats.ulWrites,
+               (double)(sStats.ulReads + sStats.ulWrites),
+               (double)ullTime / 1000.0);
+    VERBOSEPRINT("%lu of %lu clusters are free.\n", (unsigned long)ulFree,
+                 (unsigned long)(psFatFs->max_clust - 2));
+}
+
+//*****************************************************************************
+//
+// Returns the current time, in the format used by FatFs, for the files that
+// are created.
+//
+//*****************************************************************************
+DWORD
+get_fattime(void)
+{
+    time_t lNow;
+    struct tm *psNow;
+
+    lNow = time(NULL);
+    psNow = localtime(&lNow);
+
+    return(((DWORD)(psNow->tm_year - 80) << 25) |
+           ((DWORD)(psNow->tm_mon + 1) << 21) |
+           ((DWORD)psNow->tm_mday << 16) |
+           ((DWORD)psNow->tm_hour << 11) |
+           ((DWORD)psNow->tm_min << 5) |
+           ((DWORD)psNow->tm_sec >> 1));
+}
+
+//*****************************************************************************
+//
+// Show the startup banner.
+//
+//*****************************************************************************
+void
+PrintWelcome(void)
+{
+    QUIETPRINT("\nfatbench - Measure FatFs file access on a disk image.\n\n");
+}
+
+//*****************************************************************************
+//
+// Show help on the application command line parameters.
+//
+//*****************************************************************************
+void
+ShowHelp(void)
+{
+    //
+    // Only print help if we are not in quiet mode.
+    //
+    if(g_bQuiet)
+    {
+        return;
+    }
+
+    printf("This application first runs the benchmark suite that is shared\n");
+    printf("with the target, which writes and reads a file sequentially and\n");
+    printf("at random, then creates, lists, reads and deletes small files.\n");
+    printf("For each test it reports the bytes moved, the time spent in FatFs,\n");
+    printf("and the disk commands and sectors.  With -o, only the suite is\n");
+    printf("run, on an existing FAT12, FAT16 or FAT32 image.\n\n");
+    printf("Otherwise, it formats a disk image file with FatFs, writes a\n");
+    printf("contiguous file and a fragmented file to it, then reads each of\n");
+    printf("them at random offsets and from start to end, first following the\n");
+    printf("FAT and then using a cluster link map built by f_linkmap.  Every\n");
+    printf("byte read is checked.  For each it reports the number of disk read\n");
+    printf("commands and sectors, and the reads and time per operation.\n\n");
+    printf("It then writes a log file a record at a time, syncing it every few\n");
+    printf("records, with the clusters allocated as the file grows and then\n");
+    printf("preallocated, and counts the free clusters just after mounting.\n");
+    printf("For these it reports the disk commands, the most commands taken by\n");
+    printf("one record, and the commands and time per record.  Build with\n");
+    printf("CACHE=<num> to give FatFs a cache of that many sectors.\n\n");
+    printf("A delay can be added to every disk command to stand in for a\n");
+    printf("slower disk, and commands can be failed to exercise the error\n");
+    printf("paths.  Neither applies while the image is being formatted.\n\n");
+    printf("Supported parameters are:\n\n");
+    printf("-i <file> - The image file to create (default fatbench.img).\n");
+    printf("-o        - Open the existing image file instead of creating it.\n");
+    printf("-m <num>  - The size of the image in megabytes (default 64).\n");
+    printf("-c <num>  - Sectors per cluster, 1 to 64 (default 4).\n");
+    printf("-f <num>  - The size of each file in kilobytes (default 4096).\n");
+    printf("-n <num>  - The number of random reads (default 2000).\n");
+    printf("-r <num>  - The size of each random read and log record in bytes\n");
+    printf("            (default 512).\n");
+    printf("-s <num>  - The number of log records between syncs (default 8).\n");
+    printf("-k <num>  - The number of small files (default 200).\n");
+    printf("-z <num>  - The size of each small file in bytes (default 1024).\n");
+    printf("-l <num>  - Microseconds added to each disk command (default 0).\n");
+    printf("-t <num>  - Microseconds added to each sector moved (default 0).\n");
+    printf("-x <num>  - Fail every <num>th disk command (default none).\n");
+    printf("-b <num>  - Fail every disk command that touches this sector\n");
+    printf("            (default none).\n");
+    printf("-? or -h  - Show this help.\n");
+    printf("-q        - Quiet mode. Disable output to stdio.\n");
+    printf("-e        - Enable verbose output\n\n");
+    printf("Example:\n\n");
+    printf("   fatbench -m 128 -c 1 -f 16384\n");
+    printf("   fatbench -o -i card.img -l 200 -t 50\n\n");
+}
+
+//*****************************************************************************
+//
+// Parse the command line, extracting all parameters.
+//
+// Returns 0 on failure, 1 on success.
+//
+//*****************************************************************************
+int
+ParseCommandLine(int argc, char *argv[])
+{
+    int iRetcode;
+    BOOL bShowHelp, bInvalid;
+
+    //
+    // By default, don't show the help screen.
+    //
+    bShowHelp = FALSE;
+
+    while(1)
+    {
+        //
+        // Get the next command line parameter.
+        //
+        iRetcode = getopt(argc, argv, "i:om:c:f:n:r:s:k:z:l:t:x:b:eqh?");
+
+        if(iRetcode == -1)
+        {
+            break;
+        }
+
+        switch(iRetcode)
+        {
+            case 'i':
+                g_pcImage = optarg;
+                break;
+
+            case 'o':
+                g_bExisting = TRUE;
+                break;
+
+            case 'm':
+                g_ulImageMB = strtoul(optarg, NULL, 0);
+                break;
+
+            case 'c':
+                g_ulClusterSize = strtoul(optarg, NULL, 0);
+                break;
+
+            case 'f':
+                g_ulFileKB = strtoul(optarg, NULL, 0);
+                break;
+
+            case 'n':
+                g_ulSeeks = strtoul(optarg, NULL, 0);
+                break;
+
+            case 'r':
+                g_ulRecordSize = strtoul(optarg, NULL, 0);
+                break;
+
+            case 's':
+                g_ulSyncCount = strtoul(optarg, NULL, 0);
+                break;
+
+            case 'k':
+                g_ulFiles = strtoul(optarg, NULL, 0);
+                break;
+
+            case 'z':
+                g_ulSmallSize = strtoul(optarg, NULL, 0);
+                break;
+
+            case 'l':
+                g_ulCommandUS = strtoul(optarg, NULL, 0);
+                break;
+
+            case 't':
+                g_ulSectorUS = strtoul(optarg, NULL, 0);
+                break;
+
+            case 'x':
+                g_ulFaultEvery = strtoul(optarg, NULL, 0);
+                break;
+
+            case 'b':
+                g_ulBadSector = strtoul(optarg, NULL, 0);
+                break;
+
+            case 'e':
+                g_bVerbose = TRUE;
+                break;
+
+            case 'q':
+                g_bQuiet = TRUE;
+                break;
+
+            case '?':
+            case 'h':
+                bShowHelp = TRUE;
+                break;
+        }
+    }
+
+    //
+    // Show the welcome banner unless we have been told to be quiet.
+    //
+    PrintWelcome();
+
+    //
+    // Catch various invalid parameter cases.  The cluster size must be a
+    // power of two, and the files and their filler, and the small files,
+    // must fit on the image.
+    //
+    bInvalid = ((g_ulClusterSize == 0) || (g_ulClusterSize > 64) ||
+                (g_ulClusterSize & (g_ulClusterSize - 1)) ||
+                (g_ulFileKB == 0) || (g_ulSeeks == 0) ||
+                (g_ulSyncCount == 0) ||
+                (g_ulRecordSize == 0) || (g_ulRecordSize > MAX_CHUNK) ||
+                (g_ulRecordSize > (g_ulFileKB * 1024)) ||
+                (g_ulFiles >= 10000) || (g_ulSmallSize == 0) ||
+                (g_ulSmallSize > MAX_CHUNK) ||
+                (g_ulImageMB > 4096) ||
+                (!g_bExisting &&
+                 (((g_ulFileKB * 4) +
+                   ((g_ulFiles * ((g_ulSmallSize / (g_ulClusterSize * 512)) +
+                                  1) * g_ulClusterSize) / 2)) >
+                  ((g_ulImageMB * 1024) - 1024))));
+
+    if(bShowHelp || bInvalid)
+    {
+        ShowHelp();
+
+        if(bInvalid)
+        {
+            fprintf(stderr, "The cluster size must be a power of two up to "
+                    "64, the image no larger\nthan 4096 MB and big enough "
+                    "for four times the file size and the small\nfiles, "
+                    "fewer than 10000 small files, and the read and small "
+                    "file sizes no\nlarger than %d or the file.\n",
+                    MAX_CHUNK);
+        }
+
+        return(0);
+    }
+
+    VERBOSEPRINT("Image %lu MB, cluster %lu sectors, files %lu KB, %lu reads "
+                 "of %lu bytes\n", g_ulImageMB, g_ulClusterSize, g_ulFileKB,
+                 g_ulSeeks, g_ulRecordSize);
+
+    return(1);
+}
+
+//*****************************************************************************
+//
+// The main entry point of the utility.
+//
+//*****************************************************************************
+int
+main(int argc, char *argv[])
+{
+    unsigned long ulChunks;
+
+    //
+    // Parse the command line.
+    //
+    if(!ParseCommandLine(argc, argv))
+    {
+        return(1);
+    }
+
+    //
+    // Open the image, or format it and write the files.
+    //
+    if(g_bExisting)
+    {
+        OpenVolume();
+    }
+    else
+    {
+        CreateVolume();
+    }
+
+    //
+    // Slow down and fail disk commands from here on, if asked to.
+    //
+    DiskImageLatencySet(g_ulCommandUS, g_ulSectorUS);
+    DiskImageFaultSet(g_ulFaultEvery, g_ulBadSector);
+
+    //
+    // Run the suite shared with the target.  That is all that is run on an
+    // existing image, since the measurements below need the files written by
+    // CreateVolume().
+    //
+    RunSuite();
+
+    if(g_bExisting)
+    {
+        CHECK(f_mount(0, NULL));
+        DiskImageClose();
+        return(0);
+    }
+
+    //
+    // Measure each file both ways.
+    //
+    QUIETPRINT("\n");
+    ulChunks = ((g_ulFileKB * 1024) + MAX_CHUNK - 1) / MAX_CHUNK;
+
+    QUIETPRINT("%-12s %-11s %-9s %10s %10s %10s %10s\n", "Test", "File",
+               "Lookup", "Reads", "Sectors", "Reads/op", "us/op");
+    Measure("Random", CONTIG_FILE, 1, FALSE, RandomRead, g_ulSeeks);
+    Measure("Random", CONTIG_FILE, 1, TRUE, RandomRead, g_ulSeeks);
+    Measure("Random", FRAG_FILE, 2, FALSE, RandomRead, g_ulSeeks);
+    Measure("Random", FRAG_FILE, 2, TRUE, RandomRead, g_ulSeeks);
+    Measure("Sequential", CONTIG_FILE, 1, FALSE, SequentialRead, ulChunks);
+    Measure("Sequential", CONTIG_FILE, 1, TRUE, SequentialRead, ulChunks);
+    Measure("Sequential", FRAG_FILE, 2, FALSE, SequentialRead, ulChunks);
+    Measure("Sequential", FRAG_FILE, 2, TRUE, SequentialRead, ulChunks);
+
+    //
+    // Measure writing a log file and counting the free space.
+    //
+    QUIETPRINT("\n%-12s %-9s %10s %10s %10s %10s %10s\n", "Test",
+               "Clusters", "Reads", "Writes", "Max/op", "Cmds/op", "us/op");
+    MeasureAppend(FALSE);
+    MeasureAppend(TRUE);
+    MeasureFree();
+
+    CHECK(f_mount(0, NULL));
+    DiskImageClose();
+
+    return(0);
+}
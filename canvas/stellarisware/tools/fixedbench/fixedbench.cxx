@@ -0,0 +1,596 @@
+//*****************************************************************************
+//
+// fixedbench.cxx - A command line utility that checks the fixed<Q> type in
+//                  IQmath/IQmathFixed.h against the C IQmath library and
+//                  against double, and times its array functions against
+//                  float and against a call per value to the C library.
+//
+//*****************************************************************************
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <time.h>
+#include <math.h>
+#include "IQmath/IQmathLib.h"
+#include "IQmath/IQmathFixed.h"
+
+typedef unsigned char BOOL;
+#define FALSE 0
+#define TRUE  1
+
+//*****************************************************************************
+//
+// The number of values in each array that is timed, which fit in the first
+// level cache so that the loops themselves are measured.
+//
+//*****************************************************************************
+#define NUM_VALUES              1024
+
+//*****************************************************************************
+//
+// The formats and policies that are checked and timed.
+//
+//*****************************************************************************
+typedef IQmath::fixed<24> tQ24;
+typedef IQmath::fixed<24, FIXED_ROUND> tQ24Round;
+typedef IQmath::fixed<24, FIXED_ROUND | FIXED_SATURATE> tQ24Sat;
+typedef IQmath::fixed<16> tQ16;
+typedef IQmath::fixed<16, FIXED_ROUND> tQ16Round;
+typedef IQmath::fixed<28, FIXED_SATURATE> tQ28Sat;
+typedef IQmath::fixed<30> tQ30;
+typedef IQmath::fixed<8> tQ8;
+
+//*****************************************************************************
+//
+// Constants and a table that are computed by the compiler.  The checks below
+// fail the build, rather than the run, if they are wrong.
+//
+//*****************************************************************************
+constexpr tQ16 g_sOneAndHalf(1.5);
+static_assert(g_sOneAndHalf.val == 0x18000, "Constant from a literal");
+static_assert(tQ24(g_sOneAndHalf).val == 0x1800000, "Conversion");
+static_assert((g_sOneAndHalf + tQ8(0.25)) == tQ24(1.75), "Mixed add");
+static_assert((g_sOneAndHalf * tQ30(0.5)).val == 0xc000, "Mixed multiply");
+static_assert(IQmath::mpy<20>(g_sOneAndHalf, g_sOneAndHalf) == tQ16(2.25),
+              "Product in another format");
+static_assert((g_sOneAndHalf / tQ8(0.5)).toInt() == 3, "Mixed divide");
+static_assert(tQ8(0.25) < g_sOneAndHalf, "Mixed compare");
+static_assert((tQ24Sat(100.0) * tQ24Sat(2.0)).val == 0x7fffffff,
+              "Saturating multiply");
+static_assert(tQ30(3.0).val == 0x7fffffff, "Saturating literal");
+static_assert((tQ16(1.0) / tQ16(0.0)).val == 0x7fffffff, "Divide by zero");
+
+//
+// An ease-in-out curve for an animation, 3t^2 - 2t^3, in 17 steps.
+//
+#define EASE(i)                 tQ16(((3.0 * (i) * (i)) / 256.0) -            \
+                                     ((2.0 * (i) * (i) * (i)) / 4096.0))
+constexpr tQ16 g_psEase[17] =
+{
+    EASE(0),  EASE(1),  EASE(2),  EASE(3),  EASE(4),  EASE(5),  EASE(6),
+    EASE(7),  EASE(8),  EASE(9),  EASE(10), EASE(11), EASE(12), EASE(13),
+    EASE(14), EASE(15), EASE(16)
+};
+static_assert((g_psEase[0].val == 0) && (g_psEase[8].val == 0x8000) &&
+              (g_psEase[16].val == 0x10000), "Table");
+
+//*****************************************************************************
+//
+// Globals controlled by various command line parameters.
+//
+//*****************************************************************************
+BOOL g_bVerbose              = FALSE;
+BOOL g_bQuiet                = FALSE;
+unsigned long g_ulCases      = 1000000;
+unsigned long g_ulIterations = 10000;
+unsigned long g_ulSeed       = 1;
+
+//*****************************************************************************
+//
+// The number of checks made, and the number that failed.
+//
+//*****************************************************************************
+unsigned long g_ulChecked = 0;
+unsigned long g_ulFailed  = 0;
+
+//*****************************************************************************
+//
+// Helpful macros for generating output depending upon verbose and quiet flags.
+//
+//*****************************************************************************
+#define VERBOSEPRINT(...) if(g_bVerbose) { printf(__VA_ARGS__); }
+#define QUIETPRINT(...) if(!g_bQuiet) { printf(__VA_ARGS__); }
+
+//*****************************************************************************
+//
+// Counts a check, and reports it if it failed.
+//
+//*****************************************************************************
+#define CHECK(bCondition, pcName, lA, lB)                                     \
+    {                                                                         \
+        g_ulChecked++;                                                        \
+        if(!(bCondition))                                                     \
+        {                                                                     \
+            if(g_ulFailed++ < 10)                                             \
+            {                                                                 \
+                VERBOSEPRINT("%s failed for 0x%08lx, 0x%08lx\n", pcName,      \
+                             (unsigned long)(uint32_t)(lA),                   \
+                             (unsigned long)(uint32_t)(lB));                  \
+            }                                                                 \
+        }                                                                     \
+    }
+
+//*****************************************************************************
+//
+// Returns the next value from a xorshift generator, so that a run can be
+// repeated with the same seed.
+//
+//*****************************************************************************
+static unsigned long
+Random(void)
+{
+    g_ulSeed ^= (g_ulSeed << 13) & 0xffffffff;
+    g_ulSeed ^= g_ulSeed >> 17;
+    g_ulSeed ^= (g_ulSeed << 5) & 0xffffffff;
+
+    return(g_ulSeed);
+}
+
+//*****************************************************************************
+//
+// Returns a random 32-bit value with a random number of significant bits, so
+// that small and large values are both checked.
+//
+//*****************************************************************************
+static int32_t
+RandomValue(void)
+{
+    return((int32_t)Random() >> (Random() % 32));
+}
+
+//*****************************************************************************
+//
+// Returns the time in nanoseconds from an arbitrary point.
+//
+//*****************************************************************************
+static unsigned long long
+Nanoseconds(void)
+{
+    struct timespec sTime;
+
+    clock_gettime(CLOCK_MONOTONIC, &sTime);
+
+    return(((unsigned long long)sTime.tv_sec * 1000000000ULL) +
+           sTime.tv_nsec);
+}
+
+//*****************************************************************************
+//
+// Show the startup banner.
+//
+//*****************************************************************************
+void
+PrintWelcome(void)
+{
+    QUIETPRINT("\nfixedbench - Check and time the fixed<Q> type.\n\n");
+}
+
+//*****************************************************************************
+//
+// Show help on the application's command line parameters.
+//
+//*****************************************************************************
+void
+ShowHelp(void)
+{
+    //
+    // Only print help if we are not in quiet mode.
+    //
+    if(g_bQuiet)
+    {
+        return;
+    }
+
+    printf("This application checks the arithmetic of the fixed<Q> type in\n");
+    printf("IQmath/IQmathFixed.h against the C IQmath library and against\n");
+    printf("double, for random values in several formats and policies.  It\n");
+    printf("then times the array functions against the same loops in float\n");
+    printf("and against a call to the C library for each value.\n\n");
+    printf("Supported parameters are:\n\n");
+    printf("-c <num>  - Check the given number of random cases (default\n");
+    printf("            1000000).\n");
+    printf("-n <num>  - Time the given number of passes over %d values\n",
+           NUM_VALUES);
+    printf("            (default 10000), or none if 0.\n");
+    printf("-r <num>  - Seed the random cases with the given number\n");
+    printf("            (default 1).\n");
+    printf("-? or -h  - Show this help.\n");
+    printf("-q        - Quiet mode. Disable output to stdio.\n");
+    printf("-e        - Enable verbose output, showing failures.\n\n");
+    printf("Example:\n\n");
+    printf("   fixedbench -c 10000000 -n 0\n\n");
+}
+
+//*****************************************************************************
+//
+// Parse the command line, extracting all parameters.
+//
+// Returns 0 on failure, 1 on success.
+//
+//*****************************************************************************
+int
+ParseCommandLine(int argc, char *argv[])
+{
+    int iRetcode;
+    BOOL bShowHelp;
+
+    //
+    // By default, don't show the help screen.
+    //
+    bShowHelp = FALSE;
+
+    while(1)
+    {
+        //
+        // Get the next command line parameter.
+        //
+        iRetcode = getopt(argc, argv, "c:n:r:eh?q");
+
+        if(iRetcode == -1)
+        {
+            break;
+        }
+
+        switch(iRetcode)
+        {
+            case 'c':
+                g_ulCases = strtoul(optarg, NULL, 0);
+                break;
+
+            case 'n':
+                g_ulIterations = strtoul(optarg, NULL, 0);
+                break;
+
+            case 'r':
+                g_ulSeed = strtoul(optarg, NULL, 0) & 0xffffffff;
+                break;
+
+            case 'e':
+                g_bVerbose = TRUE;
+                break;
+
+            case 'q':
+                g_bQuiet = TRUE;
+                break;
+
+            case '?':
+            case 'h':
+                bShowHelp = TRUE;
+                break;
+        }
+    }
+
+    //
+    // Show the welcome banner unless we have been told to be quiet.
+    //
+    PrintWelcome();
+
+    //
+    // Catch various invalid parameter cases.
+    //
+    if(bShowHelp || (g_ulSeed == 0) || (optind != argc))
+    {
+        ShowHelp();
+        return(0);
+    }
+
+    return(1);
+}
+
+//*****************************************************************************
+//
+// Checks the arithmetic in one format against the C library, which must give
+// the same bits, and the conversions and comparisons between formats against
+// the same operations done exactly in double.
+//
+//*****************************************************************************
+static void
+CheckCase(void)
+{
+    int32_t lA, lB;
+    double dA, dB;
+
+    lA = RandomValue();
+    lB = RandomValue();
+
+    //
+    // Each policy against the C function that follows it.
+    //
+    CHECK((tQ24::raw(lA) * tQ24::raw(lB)).val == _IQ24mpy(lA, lB),
+          "mpy", lA, lB);
+    CHECK((tQ24Round::raw(lA) * tQ24Round::raw(lB)).val ==
+          _IQ24rmpy(lA, lB), "rmpy", lA, lB);
+    CHECK((tQ24Sat::raw(lA) * tQ24Sat::raw(lB)).val == _IQ24rsmpy(lA, lB),
+          "rsmpy", lA, lB);
+    CHECK((tQ24::raw(lA) / tQ24::raw(lB)).val == _IQ24div(lA, lB),
+          "div", lA, lB);
+    CHECK((tQ30::raw(lA) / tQ30::raw(lB)).val == _IQ30div(lA, lB),
+          "div", lA, lB);
+    CHECK((tQ24::raw(lA) * (long)lB).val == (int32_t)(lA * (int64_t)lB),
+          "mpyI32", lA, lB);
+    CHECK(IQmath::mpy<20>(tQ16::raw(lA), tQ30::raw(lB)).val ==
+          (int32_t)__IQxmpy(lA, lB, 20 + 32 - 16 - 30), "mpyIQX", lA, lB);
+
+    //
+    // Sums in mixed formats, where the right operand is converted to the
+    // format of the left before it is added.
+    //
+    dA = tQ16::raw(lA).toDouble();
+    dB = tQ24::raw(lB).toDouble();
+    if(fabs(dA + dB) < 32767.0)
+    {
+        CHECK((tQ16::raw(lA) + tQ24::raw(lB)).toDouble() ==
+              floor((dA + dB) * 65536.0) / 65536.0, "add", lA, lB);
+    }
+    if(fabs(dA - dB) < 32767.0)
+    {
+        CHECK((tQ16Round::raw(lA) - tQ24::raw(lB)).toDouble() ==
+              dA - (floor((dB * 65536.0) + 0.5) / 65536.0), "sub", lA, lB);
+    }
+    CHECK((tQ16::raw(lA) < tQ24::raw(lB)) == (dA < dB), "<", lA, lB);
+    CHECK((tQ16::raw(lA) == tQ24::raw(lB)) == (dA == dB), "==", lA, lB);
+    CHECK((tQ24::raw(lB) >= tQ16::raw(lA)) == (dB >= dA), ">=", lA, lB);
+
+    //
+    // Saturated sums and conversions.
+    //
+    dA = tQ24::raw(lA).toDouble();
+    CHECK((tQ24Sat::raw(lA) + tQ24::raw(lB)).val ==
+          IQmath::FixedNarrow((int64_t)lA + lB, FIXED_SATURATE), "sat add", lA, lB);
+    CHECK(tQ28Sat(tQ24::raw(lA)).val ==
+          ((dA >= 8.0) ? 0x7fffffff : (dA < -8.0) ? (int32_t)0x80000000 :
+           (int32_t)(dA * 268435456.0)), "sat convert", lA, 0);
+    CHECK(tQ24(dA).val == lA, "literal", lA, 0);
+}
+
+//*****************************************************************************
+//
+// Checks the array functions against the same operations on each value.
+//
+//*****************************************************************************
+static void
+CheckArrays(void)
+{
+    static tQ24 psA[NUM_VALUES], psB[NUM_VALUES], psOut[NUM_VALUES];
+    static tQ16 psConv[NUM_VALUES];
+    constexpr tQ16 sScale(0.7);
+    constexpr tQ30 sT(0.3);
+    unsigned long ulIdx;
+    int64_t llSum;
+
+    for(ulIdx = 0; ulIdx < NUM_VALUES; ulIdx++)
+    {
+        psA[ulIdx] = tQ24::raw(RandomValue() >> 4);
+        psB[ulIdx] = tQ24::raw(RandomValue() >> 4);
+    }
+
+    FixedAdd(psOut, psA, psB, NUM_VALUES);
+    for(ulIdx = 0; ulIdx < NUM_VALUES; ulIdx++)
+    {
+        CHECK(psOut[ulIdx].val == (psA[ulIdx].val + psB[ulIdx].val),
+              "FixedAdd", psA[ulIdx].val, psB[ulIdx].val);
+    }
+
+    FixedScale(psOut, psA, sScale, NUM_VALUES);
+    for(ulIdx = 0; ulIdx < NUM_VALUES; ulIdx++)
+    {
+        CHECK(psOut[ulIdx] == (psA[ulIdx] * sScale), "FixedScale",
+              psA[ulIdx].val, sScale.val);
+    }
+
+    FixedLerp(psOut, psA, psB, sT, NUM_VALUES);
+    for(ulIdx = 0; ulIdx < NUM_VALUES; ulIdx++)
+    {
+        CHECK(psOut[ulIdx].val ==
+              (int32_t)(psA[ulIdx].val +
+                        ((((int64_t)psB[ulIdx].val - psA[ulIdx].val) *
+                          sT.val) >> 30)), "FixedLerp", psA[ulIdx].val,
+              psB[ulIdx].val);
+    }
+
+    FixedConvert(psConv, psA, NUM_VALUES);
+    for(ulIdx = 0; ulIdx < NUM_VALUES; ulIdx++)
+    {
+        CHECK(psConv[ulIdx].val == (psA[ulIdx].val >> 8), "FixedConvert",
+              psA[ulIdx].val, 0);
+    }
+
+    llSum = 0;
+    for(ulIdx = 0; ulIdx < NUM_VALUES; ulIdx++)
+    {
+        llSum += (int64_t)psA[ulIdx].val * psConv[ulIdx].val;
+    }
+    CHECK(FixedDot(psA, psConv, NUM_VALUES).val == (int32_t)(llSum >> 16),
+          "FixedDot", (int32_t)llSum, 0);
+}
+
+//*****************************************************************************
+//
+// Reports the time taken by a loop over the arrays.
+//
+//*****************************************************************************
+static void
+Report(const char *pcName, unsigned long long ullNs)
+{
+    QUIETPRINT("  %-28s %7.2fns per value\n", pcName,
+               (double)ullNs / ((double)g_ulIterations * NUM_VALUES));
+}
+
+//*****************************************************************************
+//
+// Times the array functions against the same loops in float, and against a
+// call to the C library for each value, which is what the structures in
+// IQmathCPP.h do.
+//
+//*****************************************************************************
+static void
+Benchmark(void)
+{
+    static tQ24 psA[NUM_VALUES], psB[NUM_VALUES], psOut[NUM_VALUES];
+    static float pfA[NUM_VALUES], pfB[NUM_VALUES], pfOut[NUM_VALUES];
+    static long plOut[NUM_VALUES];
+    unsigned long long ullStart;
+    unsigned long ulPass, ulIdx;
+    constexpr tQ24 sScale(0.7);
+    constexpr tQ30 sT(0.3);
+    double dSum;
+
+    for(ulIdx = 0; ulIdx < NUM_VALUES; ulIdx++)
+    {
+        pfA[ulIdx] = (float)((RandomValue() >> 8) / 65536.0);
+        pfB[ulIdx] = (float)((RandomValue() >> 8) / 65536.0);
+    }
+    FixedFromFloat(psA, pfA, NUM_VALUES);
+    FixedFromFloat(psB, pfB, NUM_VALUES);
+    dSum = 0.0;
+
+    QUIETPRINT("Time per value over %d values, %lu times:\n", NUM_VALUES,
+               g_ulIterations);
+
+    //
+    // Scale an array.
+    //
+    ullStart = Nanoseconds();
+    for(ulPass = 0; ulPass < g_ulIterations; ulPass++)
+    {
+        FixedScale(psOut, psA, sScale, NUM_VALUES);
+        dSum += psOut[ulPass % NUM_VALUES].val;
+    }
+    Report("FixedScale", Nanoseconds() - ullStart);
+
+    ullStart = Nanoseconds();
+    for(ulPass = 0; ulPass < g_ulIterations; ulPass++)
+    {
+        for(ulIdx = 0; ulIdx < NUM_VALUES; ulIdx++)
+        {
+            plOut[ulIdx] = _IQ24mpy(psA[ulIdx].val, sScale.val);
+        }
+        dSum += plOut[ulPass % NUM_VALUES];
+    }
+    Report("_IQ24mpy for each value", Nanoseconds() - ullStart);
+
+    ullStart = Nanoseconds();
+    for(ulPass = 0; ulPass < g_ulIterations; ulPass++)
+    {
+        for(ulIdx = 0; ulIdx < NUM_VALUES; ulIdx++)
+        {
+            pfOut[ulIdx] = pfA[ulIdx] * 0.7f;
+        }
+        dSum += pfOut[ulPass % NUM_VALUES];
+    }
+    Report("float scale", Nanoseconds() - ullStart);
+
+    //
+    // Blend two arrays.
+    //
+    ullStart = Nanoseconds();
+    for(ulPass = 0; ulPass < g_ulIterations; ulPass++)
+    {
+        FixedLerp(psOut, psA, psB, sT, NUM_VALUES);
+        dSum += psOut[ulPass % NUM_VALUES].val;
+    }
+    Report("FixedLerp", Nanoseconds() - ullStart);
+
+    ullStart = Nanoseconds();
+    for(ulPass = 0; ulPass < g_ulIterations; ulPass++)
+    {
+        for(ulIdx = 0; ulIdx < NUM_VALUES; ulIdx++)
+        {
+            pfOut[ulIdx] = pfA[ulIdx] + ((pfB[ulIdx] - pfA[ulIdx]) * 0.3f);
+        }
+        dSum += pfOut[ulPass % NUM_VALUES];
+    }
+    Report("float blend", Nanoseconds() - ullStart);
+
+    //
+    // Sum the products of two arrays.
+    //
+    ullStart = Nanoseconds();
+    for(ulPass = 0; ulPass < g_ulIterations; ulPass++)
+    {
+        dSum += FixedDot(psA, psB, NUM_VALUES).val;
+    }
+    Report("FixedDot", Nanoseconds() - ullStart);
+
+    ullStart = Nanoseconds();
+    for(ulPass = 0; ulPass < g_ulIterations; ulPass++)
+    {
+        float fSum;
+
+        fSum = 0.0f;
+        for(ulIdx = 0; ulIdx < NUM_VALUES; ulIdx++)
+        {
+            fSum += pfA[ulIdx] * pfB[ulIdx];
+        }
+        dSum += fSum;
+    }
+    Report("float dot product", Nanoseconds() - ullStart);
+
+    //
+    // Convert a table from float at startup, which a table of constants
+    // avoids.
+    //
+    ullStart = Nanoseconds();
+    for(ulPass = 0; ulPass < g_ulIterations; ulPass++)
+    {
+        FixedFromFloat(psOut, pfA, NUM_VALUES);
+        dSum += psOut[ulPass % NUM_VALUES].val;
+    }
+    Report("FixedFromFloat", Nanoseconds() - ullStart);
+
+    VERBOSEPRINT("(checksum %g)\n", dSum);
+}
+
+//*****************************************************************************
+//
+// The main entry point of the fixed-point benchmark.
+//
+//*****************************************************************************
+int
+main(int argc, char *argv[])
+{
+    unsigned long ulIdx;
+
+    //
+    // Parse the command line.
+    //
+    if(!ParseCommandLine(argc, argv))
+    {
+        return(1);
+    }
+
+    //
+    // Check random cases, then the array functions.
+    //
+    for(ulIdx = 0; ulIdx < g_ulCases; ulIdx++)
+    {
+        CheckCase();
+        if((ulIdx % 1024) == 0)
+        {
+            CheckArrays();
+        }
+    }
+
+    QUIETPRINT("Checked %lu cases, %lu failed.\n", g_ulChecked, g_ulFailed);
+
+    //
+    // Time the array functions.
+    //
+    if(g_ulIterations)
+    {
+        Benchmark();
+    }
+
+    return(g_ulFailed ? 1 : 0);
+}
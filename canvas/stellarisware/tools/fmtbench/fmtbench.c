@@ -0,0 +1,649 @@
+//*****************************************************************************
+//
+// fmtbench.c - A command line utility that checks the output of uvsnprintf()
+//              from utils/ustdlib.c against the C library's snprintf(), and
+//              measures how long each takes to format a typical status line.
+//
+//*****************************************************************************
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#include "utils/ustdlib.h"
+
+typedef unsigned char BOOL;
+#define FALSE 0
+#define TRUE  1
+
+//*****************************************************************************
+//
+// The size of the buffers that results are formatted into.
+//
+//*****************************************************************************
+#define BUF_SIZE                256
+
+//*****************************************************************************
+//
+// The most mismatches that are printed in verbose mode.
+//
+//*****************************************************************************
+#define MAX_REPORTS             20
+
+//*****************************************************************************
+//
+// Globals controlled by various command line parameters.
+//
+//*****************************************************************************
+BOOL g_bVerbose              = FALSE;
+BOOL g_bQuiet                = FALSE;
+unsigned long g_ulCases      = 200000;
+unsigned long g_ulIterations = 1000000;
+unsigned long g_ulSeed       = 1;
+
+//*****************************************************************************
+//
+// Helpful macros for generating output depending upon verbose and quiet flags.
+//
+//*****************************************************************************
+#define VERBOSEPRINT(...) if(g_bVerbose) { printf(__VA_ARGS__); }
+#define QUIETPRINT(...) if(!g_bQuiet) { printf(__VA_ARGS__); }
+
+//*****************************************************************************
+//
+// The number of cases checked and the number that did not match.
+//
+//*****************************************************************************
+unsigned long g_ulChecked;
+unsigned long g_ulFailed;
+
+//*****************************************************************************
+//
+// A fixed set of formats that covers the edge cases of each conversion.  All
+// of the arguments are passed as unsigned long, which on the hosts this runs
+// on occupies the same argument slot as an int or a pointer.  Values are
+// formatted as the target would, so every signed value fits in 32 bits.
+//
+//*****************************************************************************
+typedef struct
+{
+    const char *pcFormat;
+    unsigned long pulArgs[6];
+}
+tCase;
+
+static const tCase g_psCases[] =
+{
+    { "plain text", { 0 } },
+    { "", { 0 } },
+    { "%d", { 0 } },
+    { "%d", { (unsigned long)-1L } },
+    { "%d", { (unsigned long)-2147483647L - 1 } },
+    { "%d", { 2147483647 } },
+    { "%i|%5d|%-5d|%05d", { 42, 42, 42, 42 } },
+    { "%+d % d %+d % d", { 7, 7, (unsigned long)-7L, (unsigned long)-7L } },
+    { "%08d|%-08d|%8.3d", { (unsigned long)-123L, (unsigned long)-123L,
+                            (unsigned long)-5L } },
+    { "%.0d|%.0u|%.0x|%5.0d|", { 0, 0, 0 } },
+    { "%.5d|%3.1u", { (unsigned long)-42L, 0 } },
+    { "%u %u", { 0, 4294967295UL } },
+    { "%u %u", { 99, 100 } },
+    { "%u %u", { 999999999, 1000000000 } },
+    { "%x %X %x", { 0xdeadbeef, 0xdeadbeef, 0 } },
+    { "%08x|%-8X|%.6x", { 0x1f, 0x1f, 0x1f } },
+    { "%p", { 0x20001000 } },
+    { "%c%c%c", { 'a', 'b', 'c' } },
+    { "%3c|%-3c|%03c", { 'x', 'y', 'z' } },
+    { "%s", { (unsigned long)"hello" } },
+    { "%10s|%-10s|", { (unsigned long)"left", (unsigned long)"right" } },
+    { "%.3s|%8.2s|%-6.9s|", { (unsigned long)"abcdef", (unsigned long)"xyz",
+                              (unsigned long)"pq" } },
+    { "%s%s", { (unsigned long)"", (unsigned long)"" } },
+    { "%*d|%-*d|%*d", { 6, 12, 6, 12, (unsigned long)-6L } },
+    { "%.*d|%.*s", { 4, 7, 2, (unsigned long)"abcd" } },
+    { "100%% done %%%d", { 5 } },
+    { "%lu %ld %lx", { 1, (unsigned long)-1L, 255 } },
+    { "a%db%uc%xd", { 1, 2, 3 } },
+    { "0123456789abcdefghijklmnopqrstuvwxyz %d tail", { 9 } },
+};
+
+//*****************************************************************************
+//
+// A simple random number generator, so that a run can be repeated from its
+// seed on any host.
+//
+//*****************************************************************************
+static unsigned long
+Random(void)
+{
+    g_ulSeed ^= g_ulSeed << 13;
+    g_ulSeed &= 0xffffffff;
+    g_ulSeed ^= g_ulSeed >> 17;
+    g_ulSeed ^= g_ulSeed << 5;
+    g_ulSeed &= 0xffffffff;
+    return(g_ulSeed);
+}
+
+//*****************************************************************************
+//
+// Returns a random 32-bit value, biased towards values with few digits and
+// towards the edges of the range, where conversions tend to go wrong.
+//
+//*****************************************************************************
+static unsigned long
+RandomValue(void)
+{
+    unsigned long ulBits;
+
+    switch(Random() % 8)
+    {
+        case 0:
+            return(0);
+        case 1:
+            return(0x7fffffff + (Random() % 3));
+        case 2:
+            return(0xffffffff - (Random() % 3));
+        default:
+            ulBits = (Random() % 32) + 1;
+            return(Random() >> (32 - ulBits));
+    }
+}
+
+//*****************************************************************************
+//
+// Returns the time in nanoseconds.
+//
+//*****************************************************************************
+static unsigned long long
+Nanoseconds(void)
+{
+    struct timespec sNow;
+
+    clock_gettime(CLOCK_MONOTONIC, &sNow);
+    return(((unsigned long long)sNow.tv_sec * 1000000000ULL) + sNow.tv_nsec);
+}
+
+//*****************************************************************************
+//
+// Print the welcome banner.
+//
+//*****************************************************************************
+void
+PrintWelcome(void)
+{
+    QUIETPRINT("\nfmtbench - Check and time the ustdlib string formatter.\n\n");
+}
+
+//*****************************************************************************
+//
+// Show help on the application command line parameters.
+//
+//*****************************************************************************
+void
+ShowHelp(void)
+{
+    //
+    // Only print help if we are not in quiet mode.
+    //
+    if(g_bQuiet)
+    {
+        return;
+    }
+
+    printf("This application builds utils/ustdlib.c for the host and checks\n");
+    printf("that uvsnprintf() formats a set of edge cases and many random\n");
+    printf("formats and values exactly as the C library's snprintf() does,\n");
+    printf("including the return value when the buffer is too small.  The\n");
+    printf("fixed-point conversions are checked against %%f of the same\n");
+    printf("value.  It then times both formatting a typical status line.\n\n");
+    printf("Supported parameters are:\n\n");
+    printf("-c <num>  - Check the given number of random cases (default\n");
+    printf("            200000).\n");
+    printf("-n <num>  - Time the given number of status lines (default\n");
+    printf("            1000000), or none if 0.\n");
+    printf("-r <num>  - Seed the random cases with the given number\n");
+    printf("            (default 1).\n");
+    printf("-? or -h  - Show this help.\n");
+    printf("-q        - Quiet mode. Disable output to stdio.\n");
+    printf("-e        - Enable verbose output, showing mismatches.\n\n");
+    printf("Example:\n\n");
+    printf("   fmtbench -c 1000000 -r 7\n\n");
+}
+
+//*****************************************************************************
+//
+// Parse the command line, extracting all parameters.
+//
+// Returns 0 on failure, 1 on success.
+//
+//*****************************************************************************
+int
+ParseCommandLine(int argc, char *argv[])
+{
+    int iRetcode;
+    BOOL bShowHelp;
+
+    //
+    // By default, don't show the help screen.
+    //
+    bShowHelp = FALSE;
+
+    while(1)
+    {
+        //
+        // Get the next command line parameter.
+        //
+        iRetcode = getopt(argc, argv, "c:n:r:eh?q");
+
+        if(iRetcode == -1)
+        {
+            break;
+        }
+
+        switch(iRetcode)
+        {
+            case 'c':
+                g_ulCases = strtoul(optarg, NULL, 0);
+                break;
+
+            case 'n':
+                g_ulIterations = strtoul(optarg, NULL, 0);
+                break;
+
+            case 'r':
+                g_ulSeed = strtoul(optarg, NULL, 0) & 0xffffffff;
+                break;
+
+            case 'e':
+                g_bVerbose = TRUE;
+                break;
+
+            case 'q':
+                g_bQuiet = TRUE;
+                break;
+
+            case '?':
+            case 'h':
+                bShowHelp = TRUE;
+                break;
+        }
+    }
+
+    //
+    // Show the welcome banner unless we have been told to be quiet.
+    //
+    PrintWelcome();
+
+    //
+    // Catch various invalid parameter cases.
+    //
+    if(bShowHelp || (g_ulSeed == 0) || (optind != argc))
+    {
+        ShowHelp();
+        return(0);
+    }
+
+    return(1);
+}
+
+//*****************************************************************************
+//
+// Converts a format for uvsnprintf() into the same format for snprintf() on
+// the host, where a long is wider than an int.  Each integer conversion is
+// given an l, and %p becomes %lx since uvsnprintf() prints no 0x.
+//
+//*****************************************************************************
+static void
+HostFormat(char *pcHost, const char *pcFormat)
+{
+    while(*pcFormat)
+    {
+        *pcHost++ = *pcFormat;
+        if(*pcFormat++ != '%')
+        {
+            continue;
+        }
+        if(*pcFormat == '%')
+        {
+            *pcHost++ = *pcFormat++;
+            continue;
+        }
+
+        while(*pcFormat && strchr("-+ 0123456789.*", *pcFormat))
+        {
+            *pcHost++ = *pcFormat++;
+        }
+        while(*pcFormat == 'l')
+        {
+            pcFormat++;
+        }
+        if(*pcFormat && strchr("diuxXp", *pcFormat))
+        {
+            *pcHost++ = 'l';
+            *pcHost++ = (*pcFormat == 'p') ? 'x' : *pcFormat;
+            pcFormat++;
+        }
+    }
+    *pcHost = 0;
+}
+
+//*****************************************************************************
+//
+// Compares the result of a conversion with what was expected, for every
+// buffer size from zero characters up to one more than needed.  The format
+// is moved to each alignment so that every path through the scan for %
+// characters is taken.
+//
+//*****************************************************************************
+static void
+Check(const char *pcFormat, const char *pcHostFormat, const char *pcExpected,
+      int iExpected, const unsigned long *pulArgs)
+{
+    char pcBuf[BUF_SIZE + 8], pcMoved[BUF_SIZE + 8];
+    unsigned long ulSize, ulAlign;
+    int iRet;
+
+    for(ulSize = 1; ulSize <= (unsigned long)iExpected + 2; ulSize++)
+    {
+        //
+        // Checking every size of a long result takes too long, so only the
+        // edges are checked.
+        //
+        if((ulSize > 4) && ((ulSize + 4) < (unsigned long)iExpected))
+        {
+            continue;
+        }
+
+        ulAlign = ulSize % sizeof(unsigned long);
+        strcpy(pcMoved + ulAlign, pcFormat);
+        memset(pcBuf, 0x55, sizeof(pcBuf));
+        iRet = usnprintf(pcBuf, ulSize, pcMoved + ulAlign, pulArgs[0],
+                         pulArgs[1], pulArgs[2], pulArgs[3], pulArgs[4],
+                         pulArgs[5]);
+        g_ulChecked++;
+
+        if((iRet != iExpected) ||
+           strncmp(pcBuf, pcExpected, ulSize - 1) ||
+           (strlen(pcBuf) != ((ulSize - 1) < (unsigned long)iExpected ?
+                              (ulSize - 1) : (unsigned long)iExpected)) ||
+           (pcBuf[ulSize] != 0x55))
+        {
+            if(g_ulFailed++ < MAX_REPORTS)
+            {
+                VERBOSEPRINT("Mismatch for \"%s\" (host \"%s\") in %lu bytes: "
+                             "got %d \"%s\", expected %d \"%s\"\n", pcFormat,
+                             pcHostFormat, ulSize, iRet, pcBuf, iExpected,
+                             pcExpected);
+            }
+        }
+    }
+}
+
+//*****************************************************************************
+//
+// Checks a format of integer and string conversions against snprintf().
+//
+//*****************************************************************************
+static void
+CheckFormat(const char *pcFormat, const unsigned long *pulArgs)
+{
+    char pcHost[BUF_SIZE], pcExpected[BUF_SIZE];
+    int iExpected;
+
+    HostFormat(pcHost, pcFormat);
+    iExpected = snprintf(pcExpected, sizeof(pcExpected), pcHost, pulArgs[0],
+                         pulArgs[1], pulArgs[2], pulArgs[3], pulArgs[4],
+                         pulArgs[5]);
+    Check(pcFormat, pcHost, pcExpected, iExpected, pulArgs);
+}
+
+//*****************************************************************************
+//
+// Builds random flags, a field width and a precision for a conversion.
+// Zero fill is not combined with a precision, since snprintf() then ignores
+// it for integers but not for %f.
+//
+//*****************************************************************************
+static char *
+RandomSpec(char *pcSpec, BOOL bPrecision)
+{
+    unsigned long ulFlags;
+
+    *pcSpec++ = '%';
+    ulFlags = Random();
+    if(ulFlags & 1)
+    {
+        *pcSpec++ = '-';
+    }
+    if(ulFlags & 2)
+    {
+        *pcSpec++ = '+';
+    }
+    if(ulFlags & 4)
+    {
+        *pcSpec++ = ' ';
+    }
+    if((ulFlags & 8) && !(bPrecision && (ulFlags & 64)))
+    {
+        *pcSpec++ = '0';
+    }
+    if(ulFlags & 16)
+    {
+        pcSpec += sprintf(pcSpec, "%lu", Random() % 24);
+    }
+    if(bPrecision && (ulFlags & 64))
+    {
+        pcSpec += sprintf(pcSpec, ".%lu", Random() % 14);
+    }
+
+    return(pcSpec);
+}
+
+//*****************************************************************************
+//
+// Checks random integer and string conversions, with random text around them
+// so that the scan for % characters starts and ends at every alignment.
+//
+//*****************************************************************************
+static void
+CheckRandom(void)
+{
+    static const char *ppcStrings[] = { "", "a", "status", "0123456789abc" };
+    static const char pcConversions[] = "diuxXpcs";
+    char pcFormat[BUF_SIZE], *pcSpec, cConv;
+    unsigned long pulArgs[6], ulIdx, ulArg, ulLen;
+
+    pcSpec = pcFormat;
+    ulArg = 0;
+    for(ulIdx = Random() % 4; ulIdx; ulIdx--)
+    {
+        for(ulLen = Random() % 12; ulLen; ulLen--)
+        {
+            *pcSpec++ = 'A' + (Random() % 26);
+        }
+
+        cConv = pcConversions[Random() % (sizeof(pcConversions) - 1)];
+        pcSpec = RandomSpec(pcSpec, (cConv != 'c') ? TRUE : FALSE);
+        *pcSpec++ = cConv;
+
+        if(cConv == 's')
+        {
+            pulArgs[ulArg++] = (unsigned long)ppcStrings[Random() % 4];
+        }
+        else if(cConv == 'c')
+        {
+            pulArgs[ulArg++] = ' ' + (Random() % 95);
+        }
+        else if((cConv == 'd') || (cConv == 'i'))
+        {
+            pulArgs[ulArg++] = (unsigned long)(long)(int)RandomValue();
+        }
+        else
+        {
+            pulArgs[ulArg++] = RandomValue();
+        }
+    }
+    for(ulLen = Random() % 12; ulLen; ulLen--)
+    {
+        *pcSpec++ = 'a' + (Random() % 26);
+    }
+    *pcSpec = 0;
+
+    while(ulArg < 6)
+    {
+        pulArgs[ulArg++] = 0;
+    }
+
+    CheckFormat(pcFormat, pulArgs);
+}
+
+//*****************************************************************************
+//
+// Checks a random fixed-point conversion against %f of the same value, which
+// a double holds exactly.
+//
+//*****************************************************************************
+static void
+CheckFixed(void)
+{
+    char pcFormat[BUF_SIZE], pcHost[BUF_SIZE], pcExpected[BUF_SIZE];
+    char *pcSpec;
+    unsigned long pulArgs[6], ulQ;
+    long lValue;
+    int iExpected;
+
+    ulQ = Random() % 32;
+    lValue = (long)(int)RandomValue();
+
+    pcSpec = RandomSpec(pcFormat, TRUE);
+    strcpy(pcHost, pcFormat);
+    strcpy(pcSpec, "Q V");
+    strcpy(pcHost + (pcSpec - pcFormat), "f V");
+    iExpected = snprintf(pcExpected, sizeof(pcExpected), pcHost,
+                         (double)lValue / (double)(1UL << ulQ));
+
+    pulArgs[0] = ulQ;
+    pulArgs[1] = (unsigned long)lValue;
+    memset(pulArgs + 2, 0, sizeof(unsigned long) * 4);
+    Check(pcFormat, pcHost, pcExpected, iExpected, pulArgs);
+}
+
+//*****************************************************************************
+//
+// Checks that %q uses the default of 24 fractional bits.
+//
+//*****************************************************************************
+static void
+CheckGlobalQ(void)
+{
+    static const unsigned long pulArgs[6] =
+    {
+        (unsigned long)(long)(int)0xfe800000, 3, 0x01800000, 0, 0, 0
+    };
+
+    Check("%q|%.*q", "", "-1.500000|1.500", 15, pulArgs);
+}
+
+//*****************************************************************************
+//
+// Times formatting a status line with uvsnprintf() and with snprintf().
+//
+//*****************************************************************************
+static void
+Benchmark(void)
+{
+    unsigned long long ullStart, ullUstdlib, ullHost;
+    unsigned long ulIdx, ulSum;
+    char pcBuf[BUF_SIZE];
+
+    ulSum = 0;
+
+    ullStart = Nanoseconds();
+    for(ulIdx = 0; ulIdx < g_ulIterations; ulIdx++)
+    {
+        ulSum += usnprintf(pcBuf, sizeof(pcBuf),
+                           "t=%u adc=%4d,%4d,%4d,%4d err=%08x v=%.3q %s\r\n",
+                           ulIdx, ulIdx & 4095, (ulIdx * 7) & 4095,
+                           -(long)(ulIdx & 511), 1234567L,
+                           (ulIdx * 2654435761UL) & 0xffffffff,
+                           (long)(ulIdx << 12), "ok");
+        ulSum += pcBuf[ulIdx & 15];
+    }
+    ullUstdlib = Nanoseconds() - ullStart;
+
+    ullStart = Nanoseconds();
+    for(ulIdx = 0; ulIdx < g_ulIterations; ulIdx++)
+    {
+        ulSum += snprintf(pcBuf, sizeof(pcBuf),
+                          "t=%lu adc=%4ld,%4ld,%4ld,%4ld err=%08lx v=%.3f "
+                          "%s\r\n",
+                          ulIdx, ulIdx & 4095, (ulIdx * 7) & 4095,
+                          -(long)(ulIdx & 511), 1234567L,
+                          (ulIdx * 2654435761UL) & 0xffffffff,
+                          (double)(long)(ulIdx << 12) / 16777216.0, "ok");
+        ulSum += pcBuf[ulIdx & 15];
+    }
+    ullHost = Nanoseconds() - ullStart;
+
+    QUIETPRINT("Status line, %lu times:\n", g_ulIterations);
+    QUIETPRINT("  usnprintf  %8.1fns each\n",
+               (double)ullUstdlib / (double)g_ulIterations);
+    QUIETPRINT("  snprintf   %8.1fns each\n",
+               (double)ullHost / (double)g_ulIterations);
+    VERBOSEPRINT("(checksum %lu)\n", ulSum);
+}
+
+//*****************************************************************************
+//
+// The main entry point of the formatter benchmark.
+//
+//*****************************************************************************
+int
+main(int argc, char *argv[])
+{
+    unsigned long ulIdx;
+
+    //
+    // Parse the command line.
+    //
+    if(!ParseCommandLine(argc, argv))
+    {
+        return(1);
+    }
+
+    //
+    // Check the fixed cases, then the random ones.  Half of the random cases
+    // are fixed-point conversions.
+    //
+    for(ulIdx = 0; ulIdx < (sizeof(g_psCases) / sizeof(g_psCases[0]));
+        ulIdx++)
+    {
+        CheckFormat(g_psCases[ulIdx].pcFormat, g_psCases[ulIdx].pulArgs);
+    }
+    CheckGlobalQ();
+    for(ulIdx = 0; ulIdx < g_ulCases; ulIdx++)
+    {
+        if(ulIdx & 1)
+        {
+            CheckFixed();
+        }
+        else
+        {
+            CheckRandom();
+        }
+    }
+
+    QUIETPRINT("Checked %lu conversions, %lu mismatches.\n", g_ulChecked,
+               g_ulFailed);
+
+    //
+    // Time the formatters.
+    //
+    if(g_ulIterations)
+    {
+        Benchmark();
+    }
+
+    return(g_ulFailed ? 1 : 0);
+}
@@ -0,0 +1,53 @@
+//*****************************************************************************
+//
+// FreeRTOSConfig.h - The FreeRTOS configuration used to build the heap
+//                    implementation into the heaptrace host utility.
+//
+// Only the settings that the heap implementation refers to are meaningful.
+// The heap size defaults to that of the ek-lm4f120xl FreeRTOS demo, and can be
+// changed by defining HEAP_SIZE on the make command line.
+//
+//*****************************************************************************
+
+#ifndef __FREERTOS_CONFIG_H__
+#define __FREERTOS_CONFIG_H__
+
+#ifndef HEAP_SIZE
+#define HEAP_SIZE                       30000
+#endif
+
+#define configUSE_PREEMPTION            1
+#define configUSE_IDLE_HOOK             0
+#define configUSE_TICK_HOOK             0
+#define configCPU_CLOCK_HZ              ((unsigned long)50000000)
+#define configTICK_RATE_HZ              ((portTickType)1000)
+#define configMINIMAL_STACK_SIZE        ((unsigned short)128)
+#define configTOTAL_HEAP_SIZE           ((size_t)(HEAP_SIZE))
+#define configMAX_TASK_NAME_LEN         12
+#define configUSE_TRACE_FACILITY        0
+#define configUSE_16_BIT_TICKS          0
+#define configIDLE_SHOULD_YIELD         0
+#define configUSE_MUTEXES               0
+#define configUSE_CO_ROUTINES           0
+#define configUSE_MALLOC_FAILED_HOOK    0
+#define configMAX_PRIORITIES            ((unsigned portBASE_TYPE)2)
+#define configMAX_CO_ROUTINE_PRIORITIES 2
+
+#define INCLUDE_vTaskPrioritySet        0
+#define INCLUDE_uxTaskPriorityGet       0
+#define INCLUDE_vTaskDelete             0
+#define INCLUDE_vTaskSuspend            0
+#define INCLUDE_vTaskDelayUntil         0
+#define INCLUDE_vTaskDelay              0
+
+//
+// Any corruption of the heap detected by the implementation is fatal.
+//
+extern void HeapAssertFailed(const char *pcFile, int iLine);
+#define configASSERT(x)                                                       \
+    if(!(x))                                                                  \
+    {                                                                         \
+        HeapAssertFailed(__FILE__, __LINE__);                                 \
+    }
+
+#endif // __FREERTOS_CONFIG_H__
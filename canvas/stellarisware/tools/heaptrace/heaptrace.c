@@ -0,0 +1,783 @@
+//*****************************************************************************
+//
+// heaptrace.c - A command line utility that replays allocation traces against
+//               the FreeRTOS heap implementation on the host, checking it for
+//               corruption and reporting its speed and fragmentation.
+//
+//*****************************************************************************
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#include "FreeRTOS.h"
+#include "task.h"
+
+typedef unsigned char BOOL;
+#define FALSE 0
+#define TRUE  1
+
+//*****************************************************************************
+//
+// The largest number of allocations that a trace may refer to.  Allocation
+// identifiers in a trace must be less than this.
+//
+//*****************************************************************************
+#define MAX_IDS                 4096
+
+//*****************************************************************************
+//
+// Globals controlled by various command line parameters.
+//
+//*****************************************************************************
+BOOL g_bVerbose       = FALSE;
+BOOL g_bQuiet         = FALSE;
+unsigned long g_ulSeed       = 1;
+unsigned long g_ulOperations = 100000;
+unsigned long g_ulMaxLive    = 64;
+unsigned long g_ulMaxSize    = 2048;
+char *g_pszInput      = NULL;
+char *g_pszOutput     = NULL;
+
+//*****************************************************************************
+//
+// Helpful macros for generating output depending upon verbose and quiet flags.
+//
+//*****************************************************************************
+#define VERBOSEPRINT(...) if(g_bVerbose) { printf(__VA_ARGS__); }
+#define QUIETPRINT(...) if(!g_bQuiet) { printf(__VA_ARGS__); }
+
+//*****************************************************************************
+//
+// The state of each allocation identifier used by the trace.
+//
+//*****************************************************************************
+typedef struct
+{
+    unsigned char *pucData;
+    unsigned long ulSize;
+    BOOL bLive;
+}
+tAllocation;
+
+tAllocation g_psAllocations[MAX_IDS];
+
+//*****************************************************************************
+//
+// The timing and fragmentation results gathered while replaying a trace.
+// Times are in CPU cycles on x86 hosts and in nanoseconds elsewhere.
+//
+//*****************************************************************************
+typedef struct
+{
+    unsigned long ulCount;
+    unsigned long long ullTotal;
+    unsigned long long ullWorst;
+}
+tTiming;
+
+tTiming g_sAllocTime;
+tTiming g_sFreeTime;
+unsigned long g_ulFailed;
+unsigned long g_ulFailedWithSpace;
+unsigned long g_ulWorstFragmentation;
+size_t g_xWorstFragmentationFree;
+
+//*****************************************************************************
+//
+// The state of the random number generator used to build fuzz traces.
+//
+//*****************************************************************************
+unsigned long g_ulRandom;
+
+//*****************************************************************************
+//
+// The heap is only ever used from a single thread here, so the scheduler
+// hooks that it calls have nothing to do.
+//
+//*****************************************************************************
+void
+vTaskSuspendAll(void)
+{
+}
+
+signed portBASE_TYPE
+xTaskResumeAll(void)
+{
+    return(pdFALSE);
+}
+
+//*****************************************************************************
+//
+// Called by the heap implementation when it detects corruption.
+//
+//*****************************************************************************
+void
+HeapAssertFailed(const char *pcFile, int iLine)
+{
+    fprintf(stderr, "Heap assertion failed at %s:%d\n", pcFile, iLine);
+    exit(1);
+}
+
+//*****************************************************************************
+//
+// Returns a timestamp used to measure the cost of a heap call.
+//
+//*****************************************************************************
+static unsigned long long
+Timestamp(void)
+{
+#if defined(__i386__) || defined(__x86_64__)
+    return(__builtin_ia32_rdtsc());
+#else
+    struct timespec sNow;
+
+    clock_gettime(CLOCK_MONOTONIC, &sNow);
+    return(((unsigned long long)sNow.tv_sec * 1000000000ULL) + sNow.tv_nsec);
+#endif
+}
+
+//*****************************************************************************
+//
+// Returns the next value from a simple xorshift random number generator.
+//
+//*****************************************************************************
+static unsigned long
+Random(void)
+{
+    g_ulRandom ^= (g_ulRandom << 13) & 0xFFFFFFFF;
+    g_ulRandom ^= g_ulRandom >> 17;
+    g_ulRandom ^= (g_ulRandom << 5) & 0xFFFFFFFF;
+    return(g_ulRandom);
+}
+
+//*****************************************************************************
+//
+// Returns the byte used to fill position ulOffset of allocation ulID, so that
+// an allocation overwritten by another can be detected when it is freed.
+//
+//*****************************************************************************
+static unsigned char
+FillByte(unsigned long ulID, unsigned long ulOffset)
+{
+    return((unsigned char)((ulID * 131) + (ulOffset * 7) + 1));
+}
+
+//*****************************************************************************
+//
+// Show the startup banner.
+//
+//*****************************************************************************
+void
+PrintWelcome(void)
+{
+    QUIETPRINT("\nheaptrace - Replay allocation traces against the FreeRTOS "
+               "heap.\n\n");
+}
+
+//*****************************************************************************
+//
+// Show help on the application command line parameters.
+//
+//*****************************************************************************
+void
+ShowHelp(void)
+{
+    //
+    // Only print help if we are not in quiet mode.
+    //
+    if(g_bQuiet)
+    {
+        return;
+    }
+
+    printf("This application replays a trace of allocations and frees against\n");
+    printf("the FreeRTOS heap_4.c implementation, checking that no allocation\n");
+    printf("overlaps another and that every free block is merged back into a\n");
+    printf("single block once everything has been freed.  It reports the cost\n");
+    printf("of each call and the worst fragmentation seen.  If no trace is\n");
+    printf("given, a random trace is generated instead.\n\n");
+    printf("A trace is a text file with one operation per line:\n\n");
+    printf("   a <id> <size>  - Allocate <size> bytes and call the block <id>.\n");
+    printf("   f <id>         - Free the block called <id>.\n\n");
+    printf("Lines starting with # are ignored.  <id> must be less than %d.\n\n",
+           MAX_IDS);
+    printf("Supported parameters are:\n\n");
+    printf("-i <file> - Replay the trace in the given file.\n");
+    printf("-o <file> - Write the generated random trace to the given file.\n");
+    printf("-r <num>  - The seed for the random trace (default 1).\n");
+    printf("-n <num>  - The number of operations in the random trace (default 100000).\n");
+    printf("-l <num>  - The most blocks live at once in the random trace (default 64).\n");
+    printf("-s <num>  - The largest block in the random trace (default 2048).\n");
+    printf("-? or -h  - Show this help.\n");
+    printf("-q        - Quiet mode. Disable output to stdio.\n");
+    printf("-e        - Enable verbose output\n\n");
+    printf("The heap is %lu bytes.  Rebuild with \"make HEAP_SIZE=<bytes>\" to\n",
+           (unsigned long)configTOTAL_HEAP_SIZE);
+    printf("change it.\n\n");
+    printf("Example:\n\n");
+    printf("   heaptrace -r 7 -n 1000000 -l 128\n\n");
+}
+
+//*****************************************************************************
+//
+// Parse the command line, extracting all parameters.
+//
+// Returns 0 on failure, 1 on success.
+//
+//*****************************************************************************
+int
+ParseCommandLine(int argc, char *argv[])
+{
+    int iRetcode;
+    BOOL bShowHelp;
+
+    //
+    // By default, don't show the help screen.
+    //
+    bShowHelp = FALSE;
+
+    while(1)
+    {
+        //
+        // Get the next command line parameter.
+        //
+        iRetcode = getopt(argc, argv, "i:o:r:n:l:s:eh?q");
+
+        if(iRetcode == -1)
+        {
+            break;
+        }
+
+        switch(iRetcode)
+        {
+            case 'i':
+                g_pszInput = optarg;
+                break;
+
+            case 'o':
+                g_pszOutput = optarg;
+                break;
+
+            case 'r':
+                g_ulSeed = strtoul(optarg, NULL, 0);
+                break;
+
+            case 'n':
+                g_ulOperations = strtoul(optarg, NULL, 0);
+                break;
+
+            case 'l':
+                g_ulMaxLive = strtoul(optarg, NULL, 0);
+                break;
+
+            case 's':
+                g_ulMaxSize = strtoul(optarg, NULL, 0);
+                break;
+
+            case 'e':
+                g_bVerbose = TRUE;
+                break;
+
+            case 'q':
+                g_bQuiet = TRUE;
+                break;
+
+            case '?':
+            case 'h':
+                bShowHelp = TRUE;
+                break;
+        }
+    }
+
+    //
+    // Show the welcome banner unless we have been told to be quiet.
+    //
+    PrintWelcome();
+
+    //
+    // Catch various invalid parameter cases.
+    //
+    if(bShowHelp || (g_ulMaxLive == 0) || (g_ulMaxLive > MAX_IDS) ||
+       (g_ulMaxSize == 0) || (g_pszInput && g_pszOutput) || (optind != argc))
+    {
+        ShowHelp();
+        return(0);
+    }
+
+    //
+    // A seed of zero would leave the random number generator stuck at zero.
+    //
+    g_ulRandom = g_ulSeed ? (g_ulSeed & 0xFFFFFFFF) : 1;
+
+    return(1);
+}
+
+//*****************************************************************************
+//
+// Adds the time taken by one heap call to a set of timing results.
+//
+//*****************************************************************************
+static void
+RecordTime(tTiming *psTiming, unsigned long long ullTime)
+{
+    psTiming->ulCount++;
+    psTiming->ullTotal += ullTime;
+    if(ullTime > psTiming->ullWorst)
+    {
+        psTiming->ullWorst = ullTime;
+    }
+}
+
+//*****************************************************************************
+//
+// Records the fragmentation of the heap following a heap call.
+//
+// Fragmentation is the percentage of the free space that cannot be returned
+// by a single allocation.  It is only meaningful while a reasonable amount of
+// the heap is free, so it is ignored while less than an eighth is.
+//
+//*****************************************************************************
+static void
+RecordFragmentation(void)
+{
+    xHeapStats sStats;
+    unsigned long ulFragmentation;
+
+    vPortGetHeapStats(&sStats);
+
+    if(sStats.xFreeBytes < (configTOTAL_HEAP_SIZE / 8))
+    {
+        return;
+    }
+
+    ulFragmentation = 100 - (unsigned long)((sStats.xLargestFreeBlock * 100) /
+                                            sStats.xFreeBytes);
+    if(ulFragmentation > g_ulWorstFragmentation)
+    {
+        g_ulWorstFragmentation = ulFragmentation;
+        g_xWorstFragmentationFree = sStats.xFreeBytes;
+    }
+}
+
+//*****************************************************************************
+//
+// Allocates a block for allocation identifier ulID.
+//
+// Returns 0 if the trace is invalid, 1 otherwise.
+//
+//*****************************************************************************
+static int
+DoAlloc(unsigned long ulID, unsigned long ulSize, unsigned long ulLine)
+{
+    unsigned long long ullStart, ullEnd;
+    unsigned long ulIdx;
+    unsigned char *pucData;
+    xHeapStats sStats;
+
+    if((ulID >= MAX_IDS) || g_psAllocations[ulID].bLive)
+    {
+        fprintf(stderr, "Line %lu: block %lu is already allocated.\n", ulLine,
+                ulID);
+        return(0);
+    }
+
+    //
+    // Find out how much space there is, so that a failure caused by
+    // fragmentation can be told apart from one caused by running out.
+    //
+    vPortGetHeapStats(&sStats);
+
+    ullStart = Timestamp();
+    pucData = pvPortMalloc(ulSize);
+    ullEnd = Timestamp();
+    RecordTime(&g_sAllocTime, ullEnd - ullStart);
+
+    if(pucData == NULL)
+    {
+        VERBOSEPRINT("Line %lu: %lu bytes could not be allocated.\n", ulLine,
+                     ulSize);
+        g_ulFailed++;
+        if((ulSize != 0) && (ulSize <= sStats.xFreeBytes / 2))
+        {
+            g_ulFailedWithSpace++;
+        }
+    }
+    else
+    {
+        if(((unsigned long)pucData & portBYTE_ALIGNMENT_MASK) != 0)
+        {
+            fprintf(stderr, "Line %lu: block %lu is not aligned.\n", ulLine,
+                    ulID);
+            exit(1);
+        }
+
+        for(ulIdx = 0; ulIdx < ulSize; ulIdx++)
+        {
+            pucData[ulIdx] = FillByte(ulID, ulIdx);
+        }
+    }
+
+    g_psAllocations[ulID].pucData = pucData;
+    g_psAllocations[ulID].ulSize = ulSize;
+    g_psAllocations[ulID].bLive = TRUE;
+
+    RecordFragmentation();
+
+    return(1);
+}
+
+//*****************************************************************************
+//
+// Frees the block allocated for allocation identifier ulID.
+//
+// Returns 0 if the trace is invalid, 1 otherwise.
+//
+//*****************************************************************************
+static int
+DoFree(unsigned long ulID, unsigned long ulLine)
+{
+    unsigned long long ullStart, ullEnd;
+    unsigned long ulIdx;
+    unsigned char *pucData;
+
+    if((ulID >= MAX_IDS) || !g_psAllocations[ulID].bLive)
+    {
+        fprintf(stderr, "Line %lu: block %lu is not allocated.\n", ulLine,
+                ulID);
+        return(0);
+    }
+
+    //
+    // Check that nothing else has written to the block while it was
+    // allocated.
+    //
+    pucData = g_psAllocations[ulID].pucData;
+    if(pucData)
+    {
+        for(ulIdx = 0; ulIdx < g_psAllocations[ulID].ulSize; ulIdx++)
+        {
+            if(pucData[ulIdx] != FillByte(ulID, ulIdx))
+            {
+                fprintf(stderr, "Line %lu: block %lu was overwritten at "
+                        "offset %lu.\n", ulLine, ulID, ulIdx);
+                exit(1);
+            }
+        }
+    }
+
+    ullStart = Timestamp();
+    vPortFree(pucData);
+    ullEnd = Timestamp();
+
+    //
+    // Only count frees of blocks that were actually allocated.
+    //
+    if(pucData)
+    {
+        RecordTime(&g_sFreeTime, ullEnd - ullStart);
+    }
+
+    g_psAllocations[ulID].bLive = FALSE;
+
+    RecordFragmentation();
+
+    return(1);
+}
+
+//*****************************************************************************
+//
+// Replays the trace held in a file.
+//
+// Returns 0 on failure, 1 on success.
+//
+//*****************************************************************************
+static int
+ReplayFile(char *pszFile)
+{
+    FILE *fh;
+    char pcLine[128];
+    unsigned long ulLine, ulID, ulSize;
+    int iRetcode;
+
+    fh = fopen(pszFile, "r");
+    if(!fh)
+    {
+        fprintf(stderr, "Unable to open input file %s\n", pszFile);
+        return(0);
+    }
+
+    iRetcode = 1;
+    ulLine = 0;
+    while(iRetcode && fgets(pcLine, sizeof(pcLine), fh))
+    {
+        ulLine++;
+
+        if(sscanf(pcLine, " a %lu %lu", &ulID, &ulSize) == 2)
+        {
+            iRetcode = DoAlloc(ulID, ulSize, ulLine);
+        }
+        else if(sscanf(pcLine, " f %lu", &ulID) == 1)
+        {
+            iRetcode = DoFree(ulID, ulLine);
+        }
+        else if((pcLine[strspn(pcLine, " \t\r\n")] != '\0') &&
+                (pcLine[strspn(pcLine, " \t")] != '#'))
+        {
+            fprintf(stderr, "Line %lu: not understood.\n", ulLine);
+            iRetcode = 0;
+        }
+    }
+
+    fclose(fh);
+
+    return(iRetcode);
+}
+
+//*****************************************************************************
+//
+// Returns the size of a random allocation.  Most allocations are small, as
+// they are for an RTOS application; a few are large, like task stacks.
+//
+//*****************************************************************************
+static unsigned long
+RandomSize(void)
+{
+    unsigned long ulClass, ulLimit;
+
+    ulClass = Random() % 100;
+    if(ulClass < 60)
+    {
+        ulLimit = 64;
+    }
+    else if(ulClass < 90)
+    {
+        ulLimit = 512;
+    }
+    else
+    {
+        ulLimit = g_ulMaxSize;
+    }
+
+    if(ulLimit > g_ulMaxSize)
+    {
+        ulLimit = g_ulMaxSize;
+    }
+
+    return((Random() % ulLimit) + 1);
+}
+
+//*****************************************************************************
+//
+// Generates and replays a random trace, optionally writing it to a file so
+// that it can be replayed again later.
+//
+// Returns 0 on failure, 1 on success.
+//
+//*****************************************************************************
+static int
+ReplayRandom(char *pszFile)
+{
+    FILE *fh;
+    unsigned long ulOp, ulLine, ulID, ulSize, ulLive;
+    unsigned long pulLive[MAX_IDS];
+    unsigned long ulIdx;
+    int iRetcode;
+
+    fh = NULL;
+    if(pszFile)
+    {
+        fh = fopen(pszFile, "w");
+        if(!fh)
+        {
+            fprintf(stderr, "Unable to open output file %s\n", pszFile);
+            return(0);
+        }
+
+        fprintf(fh, "# heaptrace -r %lu -n %lu -l %lu -s %lu\n", g_ulSeed,
+                g_ulOperations, g_ulMaxLive, g_ulMaxSize);
+    }
+
+    //
+    // Every identifier below the limit starts out free.  Those that are live
+    // are kept at the start of pulLive, so one can be picked at random.
+    //
+    for(ulIdx = 0; ulIdx < g_ulMaxLive; ulIdx++)
+    {
+        pulLive[ulIdx] = ulIdx;
+    }
+    ulLive = 0;
+
+    iRetcode = 1;
+    ulLine = 1;
+    for(ulOp = 0; iRetcode && (ulOp < g_ulOperations); ulOp++)
+    {
+        ulLine++;
+
+        //
+        // Allocate or free with equal probability, unless all or none of the
+        // identifiers are live.
+        //
+        if((ulLive < g_ulMaxLive) && ((ulLive == 0) || (Random() & 1)))
+        {
+            ulIdx = ulLive + (Random() % (g_ulMaxLive - ulLive));
+            ulID = pulLive[ulIdx];
+            pulLive[ulIdx] = pulLive[ulLive];
+            pulLive[ulLive++] = ulID;
+
+            ulSize = RandomSize();
+            if(fh)
+            {
+                fprintf(fh, "a %lu %lu\n", ulID, ulSize);
+            }
+            iRetcode = DoAlloc(ulID, ulSize, ulLine);
+        }
+        else
+        {
+            ulIdx = Random() % ulLive;
+            ulID = pulLive[ulIdx];
+            pulLive[ulIdx] = pulLive[--ulLive];
+            pulLive[ulLive] = ulID;
+
+            if(fh)
+            {
+                fprintf(fh, "f %lu\n", ulID);
+            }
+            iRetcode = DoFree(ulID, ulLine);
+        }
+    }
+
+    if(fh)
+    {
+        fclose(fh);
+    }
+
+    return(iRetcode);
+}
+
+//*****************************************************************************
+//
+// Frees every block that the trace left allocated, then checks that the heap
+// has returned to a single free block of its original size.
+//
+// Returns 0 on failure, 1 on success.
+//
+//*****************************************************************************
+static int
+CheckEmpty(size_t xInitialFree)
+{
+    unsigned long ulID;
+    xHeapStats sStats;
+
+    for(ulID = 0; ulID < MAX_IDS; ulID++)
+    {
+        if(g_psAllocations[ulID].bLive)
+        {
+            DoFree(ulID, 0);
+        }
+    }
+
+    vPortGetHeapStats(&sStats);
+
+    if((sStats.xFreeBytes != xInitialFree) || (sStats.ulFreeBlocks != 1))
+    {
+        fprintf(stderr, "Heap did not recover: %lu of %lu bytes free in %lu "
+                "blocks.\n", (unsigned long)sStats.xFreeBytes,
+                (unsigned long)xInitialFree, sStats.ulFreeBlocks);
+        return(0);
+    }
+
+    return(1);
+}
+
+//*****************************************************************************
+//
+// Prints a set of timing results.
+//
+//*****************************************************************************
+static void
+PrintTiming(const char *pcName, tTiming *psTiming)
+{
+    QUIETPRINT("%-6s %10lu calls, average %6llu, worst %8llu %s\n", pcName,
+               psTiming->ulCount,
+               psTiming->ulCount ? (psTiming->ullTotal / psTiming->ulCount) : 0,
+               psTiming->ullWorst,
+#if defined(__i386__) || defined(__x86_64__)
+               "cycles"
+#else
+               "ns"
+#endif
+               );
+}
+
+//*****************************************************************************
+//
+// The main entry point of the utility.
+//
+//*****************************************************************************
+int
+main(int argc, char *argv[])
+{
+    xHeapStats sStats;
+    size_t xInitialFree;
+    int iRetcode;
+
+    //
+    // Parse the command line.
+    //
+    if(!ParseCommandLine(argc, argv))
+    {
+        return(1);
+    }
+
+    //
+    // Find the size of the heap before anything is allocated from it.
+    //
+    vPortGetHeapStats(&sStats);
+    xInitialFree = sStats.xFreeBytes;
+
+    //
+    // Replay the trace.
+    //
+    if(g_pszInput)
+    {
+        QUIETPRINT("Replaying %s\n", g_pszInput);
+        iRetcode = ReplayFile(g_pszInput);
+    }
+    else
+    {
+        QUIETPRINT("Replaying %lu random operations with seed %lu\n",
+                   g_ulOperations, g_ulSeed);
+        iRetcode = ReplayRandom(g_pszOutput);
+    }
+
+    if(!iRetcode)
+    {
+        return(1);
+    }
+
+    vPortGetHeapStats(&sStats);
+
+    if(!CheckEmpty(xInitialFree))
+    {
+        return(1);
+    }
+
+    //
+    // Report the results.
+    //
+    PrintTiming("Alloc", &g_sAllocTime);
+    PrintTiming("Free", &g_sFreeTime);
+    QUIETPRINT("Heap size             %lu bytes\n",
+               (unsigned long)xInitialFree);
+    QUIETPRINT("Minimum ever free     %lu bytes\n",
+               (unsigned long)sStats.xMinimumEverFreeBytes);
+    QUIETPRINT("Failed allocations    %lu, %lu with twice the space free\n",
+               g_ulFailed, g_ulFailedWithSpace);
+    QUIETPRINT("Worst fragmentation   %lu%% with %lu bytes free\n",
+               g_ulWorstFragmentation,
+               (unsigned long)g_xWorstFragmentationFree);
+
+    return(0);
+}
@@ -0,0 +1,997 @@
+//*****************************************************************************
+//
+// hidbench.c - A command line utility that builds the USB HID device class
+//              driver for the host, drives it with a simulated pointing device
+//              and a simulated USB host polling the interrupt IN endpoint, and
+//              reports the latency from each movement to its delivery.
+//
+//*****************************************************************************
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+#include "inc/hw_types.h"
+#include "driverlib/usb.h"
+#include "usblib/usblib.h"
+#include "usblib/usbhid.h"
+#include "usblib/usblibpriv.h"
+#include "usblib/device/usbdevice.h"
+#include "usblib/device/usbdhid.h"
+
+typedef unsigned char BOOL;
+#define FALSE 0
+#define TRUE  1
+
+//*****************************************************************************
+//
+// The size of the simulated report, which holds a button byte followed by
+// 8-bit relative X and Y movements, as a boot protocol mouse report does.
+//
+//*****************************************************************************
+#define REPORT_SIZE             3
+
+//*****************************************************************************
+//
+// The ways in which the simulated device may pass reports to the driver.
+//
+//*****************************************************************************
+typedef enum
+{
+    //
+    // Each report is passed to USBDHIDReportWrite() and is discarded if the
+    // previous report is still waiting for the host.
+    //
+    MODE_WRITE,
+
+    //
+    // Each report is passed to USBDHIDReportQueue() with its relative fields
+    // described so that waiting reports may be merged.
+    //
+    MODE_QUEUE
+}
+tMode;
+
+//*****************************************************************************
+//
+// Globals controlled by various command line parameters.
+//
+//*****************************************************************************
+BOOL g_bVerbose               = FALSE;
+BOOL g_bQuiet                 = FALSE;
+unsigned long g_ulPollmS      = 8;
+unsigned long g_ulPerioduS    = 250;
+unsigned long g_ulDurationmS  = 2000;
+unsigned long g_ulButtonEvery = 64;
+unsigned long g_ulSeed        = 1;
+
+//*****************************************************************************
+//
+// Helpful macros for generating output depending upon verbose and quiet flags.
+//
+//*****************************************************************************
+#define VERBOSEPRINT(...) if(g_bVerbose) { printf(__VA_ARGS__); }
+#define QUIETPRINT(...) if(!g_bQuiet) { printf(__VA_ARGS__); }
+
+//*****************************************************************************
+//
+// Counts a check and reports it if it fails.
+//
+//*****************************************************************************
+static unsigned long g_ulFailed = 0;
+
+#define CHECK(bCond, ...)                                                     \
+    if(!(bCond))                                                              \
+    {                                                                         \
+        g_ulFailed++;                                                         \
+        QUIETPRINT("FAIL: " __VA_ARGS__);                                     \
+    }
+
+//*****************************************************************************
+//
+// The interface and endpoint descriptor templates in the class driver, which
+// must not be changed by initializing an instance.
+//
+//*****************************************************************************
+extern const unsigned char g_pHIDInterface[];
+extern const unsigned char g_pHIDInEndpoint[];
+
+//*****************************************************************************
+//
+// The descriptors handed to the class driver.  Only their presence matters
+// since the simulated host never asks for them.
+//
+//*****************************************************************************
+static const unsigned char g_pucReportDescriptor[] =
+{
+    UsagePage(USB_HID_GENERIC_DESKTOP),
+    Usage(USB_HID_MOUSE),
+    Collection(USB_HID_APPLICATION),
+    EndCollection
+};
+
+static const tHIDDescriptor g_sHIDDescriptor =
+{
+    9,                                 // bLength
+    USB_HID_DTYPE_HID,                 // bDescriptorType
+    0x111,                             // bcdHID (version 1.11 compliant)
+    0,                                 // bCountryCode (not localized)
+    1,                                 // bNumDescriptors
+    {
+        {
+            USB_HID_DTYPE_REPORT,                  // Report descriptor
+            sizeof(g_pucReportDescriptor)          // Size of report descriptor
+        }
+    }
+};
+
+static const unsigned char * const g_ppucClassDescriptors[] =
+{
+    g_pucReportDescriptor
+};
+
+static const unsigned char g_pucLangDescriptor[] =
+{
+    4, USB_DTYPE_STRING, USBShort(USB_LANG_EN_US)
+};
+
+static const unsigned char * const g_ppucStringDescriptors[] =
+{
+    g_pucLangDescriptor
+};
+
+//*****************************************************************************
+//
+// The relative fields of the simulated report.
+//
+//*****************************************************************************
+static const tHIDCoalesceMap g_sReportMap =
+{
+    (1 << 1) | (1 << 2),
+    0
+};
+
+//*****************************************************************************
+//
+// The simulated interrupt IN endpoint FIFO, which holds a single packet
+// until the host collects it.
+//
+//*****************************************************************************
+static unsigned char g_pucFIFO[64];
+static unsigned long g_ulFIFOSize;
+static BOOL g_bFIFOReady;
+
+//*****************************************************************************
+//
+// The device information passed to USBDCDInit() by the class driver.
+//
+//*****************************************************************************
+static tDeviceInfo *g_psDevInfo;
+
+//*****************************************************************************
+//
+// The results of one run of the simulation.
+//
+//*****************************************************************************
+typedef struct
+{
+    //
+    // The time of each movement accepted by the driver, in microseconds, and
+    // the number accepted so far.  Each movement is one count in X, so the
+    // sum of the X fields seen by the host tells which have been delivered.
+    //
+    unsigned long *pulEventuS;
+    unsigned long ulAccepted;
+
+    //
+    // The latency of each delivered movement, in microseconds, and the
+    // number delivered so far.
+    //
+    unsigned long long *pullLatencyuS;
+    unsigned long ulDelivered;
+
+    //
+    // The time taken by each call to the driver, in nanoseconds, and the
+    // total number of processor cycles taken by them.
+    //
+    unsigned long long *pullCallNs;
+    unsigned long long ullCallCycles;
+    unsigned long ulCalls;
+
+    //
+    // The sum of the Y fields and the number of button changes in the
+    // accepted reports and in the reports seen by the host.
+    //
+    long lDeviceY;
+    long lHostY;
+    unsigned long ulDeviceButtons;
+    unsigned long ulHostButtons;
+    unsigned char ucDeviceButtons;
+    unsigned char ucHostButtons;
+
+    //
+    // The number of reports generated and seen by the host, and the number
+    // of button changes generated.
+    //
+    unsigned long ulGenerated;
+    unsigned long ulReports;
+    unsigned long ulButtons;
+}
+tRun;
+
+//*****************************************************************************
+//
+// Returns the next value from a xorshift generator, so that a run can be
+// repeated with the same seed.
+//
+//*****************************************************************************
+static unsigned long
+Random(void)
+{
+    g_ulSeed ^= (g_ulSeed << 13) & 0xffffffff;
+    g_ulSeed ^= g_ulSeed >> 17;
+    g_ulSeed ^= (g_ulSeed << 5) & 0xffffffff;
+
+    return(g_ulSeed);
+}
+
+//*****************************************************************************
+//
+// Returns the time in nanoseconds from an arbitrary point.
+//
+//*****************************************************************************
+static unsigned long long
+Nanoseconds(void)
+{
+    struct timespec sTime;
+
+    clock_gettime(CLOCK_MONOTONIC, &sTime);
+
+    return(((unsigned long long)sTime.tv_sec * 1000000000ULL) +
+           sTime.tv_nsec);
+}
+
+//*****************************************************************************
+//
+// Returns the processor's cycle count, where it can be read.
+//
+//*****************************************************************************
+static unsigned long long
+Cycles(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+    return(__rdtsc());
+#else
+    return(0);
+#endif
+}
+
+//*****************************************************************************
+//
+// The interrupt controller functions used by the class driver.  The
+// simulation is single threaded so there is nothing to mask.
+//
+//*****************************************************************************
+tBoolean
+IntMasterDisable(void)
+{
+    return(false);
+}
+
+tBoolean
+IntMasterEnable(void)
+{
+    return(false);
+}
+
+//*****************************************************************************
+//
+// The USB library functions used by the class driver.  The tick handler is
+// never called since it updates the deferred operation flags through the
+// bit-band alias, which does not exist on the host, and the simulated device
+// has no report idle timers for it to service.
+//
+//*****************************************************************************
+const tFIFOConfig g_sUSBDefaultFIFOConfig;
+
+void
+InternalUSBTickInit(void)
+{
+}
+
+long
+InternalUSBRegisterTickHandler(tUSBTickHandler pfHandler, void *pvInstance)
+{
+    return(0);
+}
+
+void
+USBDCDInit(unsigned long ulIndex, tDeviceInfo *psDevice)
+{
+    g_psDevInfo = psDevice;
+}
+
+void
+USBDCDTerm(unsigned long ulIndex)
+{
+}
+
+void
+USBDCDStallEP0(unsigned long ulIndex)
+{
+}
+
+void
+USBDCDRequestDataEP0(unsigned long ulIndex, unsigned char *pucData,
+                     unsigned long ulSize)
+{
+}
+
+void
+USBDCDSendDataEP0(unsigned long ulIndex, unsigned char *pucData,
+                  unsigned long ulSize)
+{
+}
+
+void
+USBDCDPowerStatusSet(unsigned long ulIndex, unsigned char ucPower)
+{
+}
+
+tBoolean
+USBDCDRemoteWakeupRequest(unsigned long ulIndex)
+{
+    return(false);
+}
+
+//*****************************************************************************
+//
+// The USB controller functions used by the class driver.  Only the interrupt
+// IN endpoint is simulated.
+//
+//*****************************************************************************
+long
+USBEndpointDataPut(unsigned long ulBase, unsigned long ulEndpoint,
+                   unsigned char *pucData, unsigned long ulSize)
+{
+    //
+    // The FIFO can't be written while it holds a packet for the host.
+    //
+    if(g_bFIFOReady || (g_ulFIFOSize + ulSize > sizeof(g_pucFIFO)))
+    {
+        return(-1);
+    }
+
+    memcpy(g_pucFIFO + g_ulFIFOSize, pucData, ulSize);
+    g_ulFIFOSize += ulSize;
+
+    return(0);
+}
+
+long
+USBEndpointDataSend(unsigned long ulBase, unsigned long ulEndpoint,
+                    unsigned long ulTransType)
+{
+    if(g_bFIFOReady)
+    {
+        return(-1);
+    }
+
+    g_bFIFOReady = TRUE;
+
+    return(0);
+}
+
+unsigned long
+USBEndpointStatus(unsigned long ulBase, unsigned long ulEndpoint)
+{
+    return(0);
+}
+
+void
+USBDevEndpointStatusClear(unsigned long ulBase, unsigned long ulEndpoint,
+                          unsigned long ulFlags)
+{
+}
+
+unsigned long
+USBEndpointDataAvail(unsigned long ulBase, unsigned long ulEndpoint)
+{
+    return(0);
+}
+
+long
+USBEndpointDataGet(unsigned long ulBase, unsigned long ulEndpoint,
+                   unsigned char *pucData, unsigned long *pulSize)
+{
+    *pulSize = 0;
+
+    return(-1);
+}
+
+void
+USBDevEndpointDataAck(unsigned long ulBase, unsigned long ulEndpoint,
+                      tBoolean bIsLastPacket)
+{
+}
+
+//*****************************************************************************
+//
+// The application callbacks, which have nothing to do.
+//
+//*****************************************************************************
+static unsigned long
+HIDCallback(void *pvCBData, unsigned long ulEvent, unsigned long ulMsgValue,
+            void *pvMsgData)
+{
+    return(0);
+}
+
+//*****************************************************************************
+//
+// Fills in a HID device structure for the simulated pointing device.
+//
+//*****************************************************************************
+static void
+DeviceSetup(tUSBDHIDDevice *psDevice, tHIDInstance *psInst,
+            unsigned char ucPollIntervalmS, tBoolean bUseOutEndpoint)
+{
+    memset(psDevice, 0, sizeof(tUSBDHIDDevice));
+    psDevice->usVID = 0x1cbe;
+    psDevice->usPID = 0;
+    psDevice->usMaxPowermA = 100;
+    psDevice->ucPwrAttributes = USB_CONF_ATTR_SELF_PWR;
+    psDevice->ucSubclass = USB_HID_SCLASS_BOOT;
+    psDevice->ucProtocol = USB_HID_PROTOCOL_MOUSE;
+    psDevice->pfnRxCallback = HIDCallback;
+    psDevice->pfnTxCallback = HIDCallback;
+    psDevice->bUseOutEndpoint = bUseOutEndpoint;
+    psDevice->psHIDDescriptor = &g_sHIDDescriptor;
+    psDevice->ppClassDescriptors = g_ppucClassDescriptors;
+    psDevice->ppStringDescriptors = g_ppucStringDescriptors;
+    psDevice->ulNumStringDescriptors = 1;
+    psDevice->psPrivateHIDData = psInst;
+    psDevice->ucPollIntervalmS = ucPollIntervalmS;
+}
+
+//*****************************************************************************
+//
+// Returns the polling interval published for the given endpoint of the
+// configuration descriptor reached through a device information structure,
+// as the device and composite drivers see it, or 0 if there is no such
+// endpoint.
+//
+//*****************************************************************************
+static unsigned long
+PublishedInterval(const tDeviceInfo *psDevInfo, unsigned long ulEndpoint)
+{
+    tEndpointDescriptor *psEndpoint;
+
+    psEndpoint = USBDCDConfigGetInterfaceEndpoint(
+                                        psDevInfo->ppConfigDescriptors[0], 0,
+                                        0, ulEndpoint);
+
+    return(psEndpoint ? psEndpoint->bInterval : 0);
+}
+
+//*****************************************************************************
+//
+// Returns the number of endpoints published in the interface descriptor of
+// the configuration descriptor reached through a device information
+// structure.
+//
+//*****************************************************************************
+static unsigned long
+PublishedEndpoints(const tDeviceInfo *psDevInfo)
+{
+    tInterfaceDescriptor *psInterface;
+    unsigned long ulSection;
+
+    psInterface = USBDCDConfigGetInterface(psDevInfo->ppConfigDescriptors[0],
+                                           0, 0, &ulSection);
+
+    return(psInterface ? psInterface->bNumEndpoints : 0);
+}
+
+//*****************************************************************************
+//
+// Checks that two instances initialized with different polling intervals
+// each publish their own through the device information structure handed to
+// the composite driver, and that neither changes the driver's templates.
+//
+//*****************************************************************************
+static void
+CheckInstances(void)
+{
+    tUSBDHIDDevice sDeviceA, sDeviceB;
+    tHIDInstance sInstA, sInstB;
+    const tDeviceInfo *psDevInfoA, *psDevInfoB;
+
+    DeviceSetup(&sDeviceA, &sInstA, 1, false);
+    DeviceSetup(&sDeviceB, &sInstB, 10, true);
+    psDevInfoA = ((tUSBDHIDDevice *)USBDHIDCompositeInit(0, &sDeviceA))->
+                                                psPrivateHIDData->psDevInfo;
+    psDevInfoB = ((tUSBDHIDDevice *)USBDHIDCompositeInit(0, &sDeviceB))->
+                                                psPrivateHIDData->psDevInfo;
+
+    CHECK(psDevInfoA != psDevInfoB,
+          "The two instances share a device information structure.\n");
+    CHECK(PublishedInterval(psDevInfoA, 0) == 1,
+          "The first instance publishes an interval of %lu ms, not 1 ms.\n",
+          PublishedInterval(psDevInfoA, 0));
+    CHECK((PublishedInterval(psDevInfoA, 1) == 0) &&
+          (PublishedEndpoints(psDevInfoA) == 1),
+          "The first instance publishes an OUT endpoint it doesn't use.\n");
+    CHECK((PublishedInterval(psDevInfoB, 0) == 10) &&
+          (PublishedInterval(psDevInfoB, 1) == 10),
+          "The second instance publishes intervals of %lu and %lu ms, not "
+          "10 ms.\n", PublishedInterval(psDevInfoB, 0),
+          PublishedInterval(psDevInfoB, 1));
+    CHECK(PublishedEndpoints(psDevInfoB) == 2,
+          "The second instance publishes %lu endpoints, not 2.\n",
+          PublishedEndpoints(psDevInfoB));
+    CHECK(g_pHIDInEndpoint[6] == USBDHID_POLL_INTERVAL_DEFAULT,
+          "The endpoint descriptor template was changed to %d ms.\n",
+          g_pHIDInEndpoint[6]);
+    CHECK(g_pHIDInterface[4] == 2,
+          "The interface descriptor template was changed to %d endpoints.\n",
+          g_pHIDInterface[4]);
+
+    //
+    // Initializing with no interval gives the default.
+    //
+    DeviceSetup(&sDeviceA, &sInstA, 0, false);
+    USBDHIDCompositeInit(0, &sDeviceA);
+    CHECK(PublishedInterval(psDevInfoA, 0) == USBDHID_POLL_INTERVAL_DEFAULT,
+          "The default instance publishes an interval of %lu ms.\n",
+          PublishedInterval(psDevInfoA, 0));
+    CHECK((PublishedInterval(psDevInfoB, 0) == 10) &&
+          (PublishedEndpoints(psDevInfoB) == 2),
+          "Initializing an instance changed another's descriptors.\n");
+}
+
+//*****************************************************************************
+//
+// Collects the packet waiting in the interrupt IN endpoint, as the host does
+// when it polls the endpoint, and passes the transmit complete interrupt to
+// the class driver.
+//
+//*****************************************************************************
+static void
+HostPoll(tRun *psRun, const tUSBDHIDDevice *psDevice, unsigned long ulNowuS)
+{
+    unsigned long ulIdx, ulCount;
+
+    if(!g_bFIFOReady)
+    {
+        return;
+    }
+
+    CHECK(g_ulFIFOSize == REPORT_SIZE,
+          "The host received a packet of %lu bytes.\n", g_ulFIFOSize);
+
+    //
+    // Each count in X delivers the next accepted movement.
+    //
+    ulCount = (signed char)g_pucFIFO[1];
+    CHECK(psRun->ulDelivered + ulCount <= psRun->ulAccepted,
+          "The host received more movement than was generated.\n");
+    for(ulIdx = 0; (ulIdx < ulCount) &&
+                   (psRun->ulDelivered < psRun->ulAccepted); ulIdx++)
+    {
+        psRun->pullLatencyuS[psRun->ulDelivered] =
+            ulNowuS - psRun->pulEventuS[psRun->ulDelivered];
+        psRun->ulDelivered++;
+    }
+
+    psRun->lHostY += (signed char)g_pucFIFO[2];
+    if(g_pucFIFO[0] != psRun->ucHostButtons)
+    {
+        psRun->ucHostButtons = g_pucFIFO[0];
+        psRun->ulHostButtons++;
+    }
+    psRun->ulReports++;
+
+    VERBOSEPRINT("%8lu us: buttons %d, X %d, Y %d\n", ulNowuS, g_pucFIFO[0],
+                 (signed char)g_pucFIFO[1], (signed char)g_pucFIFO[2]);
+
+    //
+    // Empty the FIFO and tell the driver the packet was acknowledged.
+    //
+    g_bFIFOReady = FALSE;
+    g_ulFIFOSize = 0;
+    g_psDevInfo->sCallbacks.pfnEndpointHandler(
+        (void *)psDevice,
+        1 << USB_EP_TO_INDEX(psDevice->psPrivateHIDData->ucINEndpoint));
+}
+
+//*****************************************************************************
+//
+// Orders two timings for qsort().
+//
+//*****************************************************************************
+static int
+CompareTimes(const void *pvA, const void *pvB)
+{
+    unsigned long long ullA, ullB;
+
+    ullA = *(const unsigned long long *)pvA;
+    ullB = *(const unsigned long long *)pvB;
+
+    return((ullA > ullB) - (ullA < ullB));
+}
+
+//*****************************************************************************
+//
+// Prints the count, mean, median, 99th percentile and maximum of a set of
+// times.
+//
+//*****************************************************************************
+static void
+PrintTimes(const char *pcName, unsigned long long *pullTimes,
+           unsigned long ulCount)
+{
+    unsigned long long ullTotal;
+    unsigned long ulIdx;
+
+    if(ulCount == 0)
+    {
+        QUIETPRINT("  %-16s %8s\n", pcName, "-");
+        return;
+    }
+
+    qsort(pullTimes, ulCount, sizeof(unsigned long long), CompareTimes);
+
+    for(ulIdx = 0, ullTotal = 0; ulIdx < ulCount; ulIdx++)
+    {
+        ullTotal += pullTimes[ulIdx];
+    }
+
+    QUIETPRINT("  %-16s %8lu %8.0f %8llu %8llu %8llu\n", pcName, ulCount,
+               (double)ullTotal / ulCount, pullTimes[ulCount / 2],
+               pullTimes[(ulCount * 99) / 100], pullTimes[ulCount - 1]);
+}
+
+//*****************************************************************************
+//
+// Runs the simulated device against the simulated host, passing reports to
+// the driver in the given way.
+//
+//*****************************************************************************
+static void
+RunMode(tMode eMode, const char *pcName)
+{
+    tUSBDHIDDevice sDevice;
+    tHIDInstance sInst;
+    tRun sRun;
+    unsigned char pucReport[REPORT_SIZE];
+    unsigned long ulEvents, ulEvent, ulNowuS, ulPolluS, ulNextPolluS, ulSeed;
+    unsigned long long ullStart, ullCycles;
+    unsigned long ulRetcode;
+
+    ulEvents = (g_ulDurationmS * 1000) / g_ulPerioduS;
+
+    memset(&sRun, 0, sizeof(sRun));
+    sRun.pulEventuS = malloc(ulEvents * sizeof(unsigned long));
+    sRun.pullLatencyuS = malloc(ulEvents * sizeof(unsigned long long));
+    sRun.pullCallNs = malloc(ulEvents * sizeof(unsigned long long));
+    if(!sRun.pulEventuS || !sRun.pullLatencyuS || !sRun.pullCallNs)
+    {
+        fprintf(stderr, "Unable to allocate the results.\n");
+        exit(1);
+    }
+
+    //
+    // Each mode sees the same movements.
+    //
+    ulSeed = g_ulSeed;
+
+    //
+    // Bring up the driver and have the host configure it.
+    //
+    g_bFIFOReady = FALSE;
+    g_ulFIFOSize = 0;
+    DeviceSetup(&sDevice, &sInst, g_ulPollmS, false);
+    USBDHIDInit(0, &sDevice);
+    g_psDevInfo->sCallbacks.pfnConfigChange(g_psDevInfo->pvInstance, 1);
+
+    //
+    // The host polls at the interval published in the configuration
+    // descriptor.
+    //
+    ulPolluS = PublishedInterval(g_psDevInfo, 0) * 1000;
+    CHECK(ulPolluS == g_ulPollmS * 1000,
+          "The device publishes an interval of %lu ms, not %lu ms.\n",
+          ulPolluS / 1000, g_ulPollmS);
+    ulNextPolluS = ulPolluS;
+
+    pucReport[0] = 0;
+    for(ulEvent = 0; ulEvent < ulEvents; ulEvent++)
+    {
+        ulNowuS = ulEvent * g_ulPerioduS;
+
+        //
+        // Let the host make any polls due before this movement.
+        //
+        while(ulNextPolluS <= ulNowuS)
+        {
+            HostPoll(&sRun, &sDevice, ulNextPolluS);
+            ulNextPolluS += ulPolluS;
+        }
+
+        //
+        // Move one count right and a few counts up or down, and change the
+        // buttons now and then.
+        //
+        if(g_ulButtonEvery && ((ulEvent % g_ulButtonEvery) ==
+                               (g_ulButtonEvery - 1)))
+        {
+            pucReport[0] ^= 1;
+            sRun.ulButtons++;
+        }
+        pucReport[1] = 1;
+        pucReport[2] = (unsigned char)((Random() % 7) - 3);
+        sRun.ulGenerated++;
+
+        ullCycles = Cycles();
+        ullStart = Nanoseconds();
+        if(eMode == MODE_WRITE)
+        {
+            ulRetcode = USBDHIDReportWrite(&sDevice, pucReport, REPORT_SIZE,
+                                           true);
+        }
+        else
+        {
+            ulRetcode = USBDHIDReportQueue(&sDevice, pucReport, REPORT_SIZE,
+                                           &g_sReportMap);
+        }
+        sRun.pullCallNs[sRun.ulCalls++] = Nanoseconds() - ullStart;
+        sRun.ullCallCycles += Cycles() - ullCycles;
+
+        //
+        // Remember what the host should see of the accepted movements.
+        //
+        if(ulRetcode == REPORT_SIZE)
+        {
+            sRun.pulEventuS[sRun.ulAccepted++] = ulNowuS;
+            sRun.lDeviceY += (signed char)pucReport[2];
+            if(pucReport[0] != sRun.ucDeviceButtons)
+            {
+                sRun.ucDeviceButtons = pucReport[0];
+                sRun.ulDeviceButtons++;
+            }
+        }
+        else
+        {
+            CHECK(ulRetcode == 0, "%s returned %lu.\n", pcName, ulRetcode);
+        }
+    }
+
+    //
+    // Let the host collect anything still waiting.
+    //
+    for(ulEvent = 0; (ulEvent < USBDHID_REPORT_QUEUE_DEPTH + 2); ulEvent++)
+    {
+        HostPoll(&sRun, &sDevice, ulNextPolluS);
+        ulNextPolluS += ulPolluS;
+    }
+
+    //
+    // Everything the driver accepted must have reached the host.
+    //
+    CHECK(sRun.ulDelivered == sRun.ulAccepted,
+          "%s: %lu of %lu accepted movements reached the host.\n", pcName,
+          sRun.ulDelivered, sRun.ulAccepted);
+    CHECK(sRun.lHostY == sRun.lDeviceY,
+          "%s: the host saw %ld counts in Y, not %ld.\n", pcName,
+          sRun.lHostY, sRun.lDeviceY);
+    CHECK(sRun.ulHostButtons == sRun.ulDeviceButtons,
+          "%s: the host saw %lu button changes, not %lu.\n", pcName,
+          sRun.ulHostButtons, sRun.ulDeviceButtons);
+
+    //
+    // The queue only turns reports away when it holds a full set of button
+    // changes, which can't happen if they are rarer than polls.
+    //
+    if((eMode == MODE_QUEUE) &&
+       (g_ulButtonEvery * g_ulPerioduS > ulPolluS * USBDHID_REPORT_QUEUE_DEPTH))
+    {
+        CHECK(sRun.ulAccepted == sRun.ulGenerated,
+              "%s: %lu of %lu movements were turned away.\n", pcName,
+              sRun.ulGenerated - sRun.ulAccepted, sRun.ulGenerated);
+    }
+
+    QUIETPRINT("\n%s: %lu movements, %lu lost, %lu reports sent, %lu of %lu "
+               "button changes sent.\n", pcName, sRun.ulGenerated,
+               sRun.ulGenerated - sRun.ulAccepted, sRun.ulReports,
+               sRun.ulHostButtons, sRun.ulButtons);
+    QUIETPRINT("  %-16s %8s %8s %8s %8s %8s\n", "", "count", "mean", "p50",
+               "p99", "max");
+    PrintTimes("Latency (us)", sRun.pullLatencyuS, sRun.ulDelivered);
+    PrintTimes("Call (ns)", sRun.pullCallNs, sRun.ulCalls);
+    QUIETPRINT("  %-16s %8.0f\n", "Call (cycles)",
+               sRun.ulCalls ? (double)sRun.ullCallCycles / sRun.ulCalls : 0.0);
+
+    USBDHIDTerm(&sDevice);
+    g_ulSeed = ulSeed;
+
+    free(sRun.pulEventuS);
+    free(sRun.pullLatencyuS);
+    free(sRun.pullCallNs);
+}
+
+//*****************************************************************************
+//
+// This function prints a welcome banner for the application.
+//
+//*****************************************************************************
+void
+PrintWelcome(void)
+{
+    QUIETPRINT("\nhidbench - Measure USB HID device input latency.\n\n");
+}
+
+//*****************************************************************************
+//
+// Show help on the application's command line parameters.
+//
+//*****************************************************************************
+void
+ShowHelp(void)
+{
+    //
+    // Only print help if we are not in quiet mode.
+    //
+    if(g_bQuiet)
+    {
+        return;
+    }
+
+    printf("This application builds usblib/device/usbdhid.c for the host\n");
+    printf("and drives it with a simulated pointing device, which moves at\n");
+    printf("a fixed rate, and a simulated USB host, which polls the\n");
+    printf("interrupt IN endpoint at the interval the device publishes.\n");
+    printf("Reports are passed to USBDHIDReportWrite(), dropping any made\n");
+    printf("while the previous one is waiting, and then to\n");
+    printf("USBDHIDReportQueue(), which merges them.  For each, it reports\n");
+    printf("the movements lost, the latency from each movement to the poll\n");
+    printf("which delivers it, and the time taken by each call, and checks\n");
+    printf("that the host sees every accepted movement and button change.\n");
+    printf("It also checks that instances with different polling intervals\n");
+    printf("each publish their own.  Call times are for the host and include\n");
+    printf("the overhead of reading the clock.\n\n");
+    printf("Supported parameters are:\n\n");
+    printf("-p <ms>   - Publish the given polling interval (default 8).\n");
+    printf("-i <us>   - Move once every given number of microseconds\n");
+    printf("            (default 250).\n");
+    printf("-t <ms>   - Run for the given number of milliseconds (default\n");
+    printf("            2000).\n");
+    printf("-b <num>  - Change the buttons every given number of movements,\n");
+    printf("            or never if 0 (default 64).\n");
+    printf("-r <num>  - Seed the movements with the given number (default\n");
+    printf("            1).\n");
+    printf("-? or -h  - Show this help.\n");
+    printf("-q        - Quiet mode. Disable output to stdio.\n");
+    printf("-e        - Enable verbose output.\n\n");
+    printf("Example:\n\n");
+    printf("   hidbench -p 1 -i 125\n\n");
+}
+
+//*****************************************************************************
+//
+// Parse the command line, extracting all parameters.
+//
+// Returns 0 on failure, 1 on success.
+//
+//*****************************************************************************
+int
+ParseCommandLine(int argc, char *argv[])
+{
+    int iRetcode;
+    BOOL bShowHelp;
+
+    //
+    // By default, don't show the help screen.
+    //
+    bShowHelp = FALSE;
+
+    while(1)
+    {
+        //
+        // Get the next command line parameter.
+        //
+        iRetcode = getopt(argc, argv, "p:i:t:b:r:eh?q");
+
+        if(iRetcode == -1)
+        {
+            break;
+        }
+
+        switch(iRetcode)
+        {
+            case 'p':
+                g_ulPollmS = strtoul(optarg, NULL, 0);
+                break;
+
+            case 'i':
+                g_ulPerioduS = strtoul(optarg, NULL, 0);
+                break;
+
+            case 't':
+                g_ulDurationmS = strtoul(optarg, NULL, 0);
+                break;
+
+            case 'b':
+                g_ulButtonEvery = strtoul(optarg, NULL, 0);
+                break;
+
+            case 'r':
+                g_ulSeed = strtoul(optarg, NULL, 0) & 0xffffffff;
+                break;
+
+            case 'e':
+                g_bVerbose = TRUE;
+                break;
+
+            case 'q':
+                g_bQuiet = TRUE;
+                break;
+
+            case '?':
+            case 'h':
+                bShowHelp = TRUE;
+                break;
+        }
+    }
+
+    //
+    // Show the welcome banner unless we have been told to be quiet.
+    //
+    PrintWelcome();
+
+    //
+    // Catch various invalid parameter cases.  A report holds at most 127
+    // counts in X, so there must be fewer movements than that per poll.
+    //
+    if(bShowHelp || (g_ulSeed == 0) || (g_ulPollmS == 0) ||
+       (g_ulPollmS > 255) || (g_ulPerioduS == 0) ||
+       ((g_ulPollmS * 1000) / g_ulPerioduS >= 127) ||
+       (g_ulDurationmS * 1000 < g_ulPerioduS) || (optind != argc))
+    {
+        ShowHelp();
+        return(0);
+    }
+
+    return(1);
+}
+
+//*****************************************************************************
+//
+// The main entry point of the application.
+//
+//*****************************************************************************
+int
+main(int argc, char *argv[])
+{
+    if(!ParseCommandLine(argc, argv))
+    {
+        return(1);
+    }
+
+    QUIETPRINT("Polling every %lu ms, moving every %lu us for %lu ms, queue of "
+               "%d reports.\n", g_ulPollmS, g_ulPerioduS, g_ulDurationmS,
+               USBDHID_REPORT_QUEUE_DEPTH);
+
+    CheckInstances();
+    RunMode(MODE_WRITE, "USBDHIDReportWrite");
+    RunMode(MODE_QUEUE, "USBDHIDReportQueue");
+
+    QUIETPRINT("\n%s: %lu checks failed.\n", g_ulFailed ? "FAILED" : "PASSED",
+               g_ulFailed);
+
+    return(g_ulFailed ? 1 : 0);
+}
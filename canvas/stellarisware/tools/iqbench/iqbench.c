@@ -0,0 +1,870 @@
+//*****************************************************************************
+//
+// iqbench.c - A command line utility that builds IQmath/iqmath.c for the host
+//             and measures the accuracy and speed of each function in every
+//             IQ format against the same function in float and in double.
+//
+//*****************************************************************************
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#include <math.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+#define MATH_TYPE               IQ_MATH
+#include "IQmath/IQmathLib.h"
+
+typedef unsigned char BOOL;
+#define FALSE 0
+#define TRUE  1
+
+//*****************************************************************************
+//
+// The value of pi, since M_PI is not provided in a strict C build.
+//
+//*****************************************************************************
+#define PI                      3.14159265358979323846
+
+//*****************************************************************************
+//
+// The number of inputs that are timed, which fit in the first level cache so
+// that the functions themselves are measured.
+//
+//*****************************************************************************
+#define NUM_TIMED               1024
+
+//*****************************************************************************
+//
+// The ranges that the inputs of a function are drawn from.  The largest
+// value of the format is M.
+//
+//*****************************************************************************
+#define RANGE_FULL              0       // -M to M
+#define RANGE_SQRT              1       // -sqrt(M) to sqrt(M)
+#define RANGE_POSITIVE          2       // 0 to M
+#define RANGE_UNIT              3       // -1 to 1
+#define RANGE_TURN              4       // -1 to 1, limited to M
+#define RANGE_RADIANS           5       // -2pi to 2pi, limited to M
+#define RANGE_EXP               6       // -25 to ln(M), limited to M
+#define RANGE_EXP2              7       // -32 to log2(M), limited to M
+
+//*****************************************************************************
+//
+// The types of the functions in IQmathLib.h, and the same functions in float
+// and double.  Each takes one or two arguments.
+//
+//*****************************************************************************
+typedef long (*tIQFunction1)(long lA);
+typedef long (*tIQFunction2)(long lA, long lB);
+typedef float (*tFloatFunction)(float fA, float fB);
+typedef double (*tDoubleFunction)(double dA, double dB);
+
+//*****************************************************************************
+//
+// Builds the table of a function in every format, which is indexed by the
+// number of fractional bits.  The radian functions are not provided for
+// IQ30, which cannot hold pi.
+//
+//*****************************************************************************
+#define IQ_LIST(T, F)                                                         \
+    {                                                                         \
+        0,                (T)_IQ1##F,  (T)_IQ2##F,  (T)_IQ3##F,  (T)_IQ4##F,  \
+        (T)_IQ5##F,  (T)_IQ6##F,  (T)_IQ7##F,  (T)_IQ8##F,  (T)_IQ9##F,       \
+        (T)_IQ10##F, (T)_IQ11##F, (T)_IQ12##F, (T)_IQ13##F, (T)_IQ14##F,      \
+        (T)_IQ15##F, (T)_IQ16##F, (T)_IQ17##F, (T)_IQ18##F, (T)_IQ19##F,      \
+        (T)_IQ20##F, (T)_IQ21##F, (T)_IQ22##F, (T)_IQ23##F, (T)_IQ24##F,      \
+        (T)_IQ25##F, (T)_IQ26##F, (T)_IQ27##F, (T)_IQ28##F, (T)_IQ29##F,      \
+        (T)_IQ30##F                                                           \
+    }
+#define IQ_LIST29(T, F)                                                       \
+    {                                                                         \
+        0,                (T)_IQ1##F,  (T)_IQ2##F,  (T)_IQ3##F,  (T)_IQ4##F,  \
+        (T)_IQ5##F,  (T)_IQ6##F,  (T)_IQ7##F,  (T)_IQ8##F,  (T)_IQ9##F,       \
+        (T)_IQ10##F, (T)_IQ11##F, (T)_IQ12##F, (T)_IQ13##F, (T)_IQ14##F,      \
+        (T)_IQ15##F, (T)_IQ16##F, (T)_IQ17##F, (T)_IQ18##F, (T)_IQ19##F,      \
+        (T)_IQ20##F, (T)_IQ21##F, (T)_IQ22##F, (T)_IQ23##F, (T)_IQ24##F,      \
+        (T)_IQ25##F, (T)_IQ26##F, (T)_IQ27##F, (T)_IQ28##F, (T)_IQ29##F,      \
+        0                                                                     \
+    }
+
+//*****************************************************************************
+//
+// The same functions in float and double.
+//
+//*****************************************************************************
+static float FloatMpy(float fA, float fB) { return(fA * fB); }
+static float FloatDiv(float fA, float fB) { return(fA / fB); }
+static float FloatSin(float fA, float fB) { return(sinf(fA)); }
+static float FloatCos(float fA, float fB) { return(cosf(fA)); }
+static float FloatSinPU(float fA, float fB) { return(sinf(fA * 6.2831853f)); }
+static float FloatCosPU(float fA, float fB) { return(cosf(fA * 6.2831853f)); }
+static float FloatAsin(float fA, float fB) { return(asinf(fA)); }
+static float FloatAtan2(float fA, float fB) { return(atan2f(fA, fB)); }
+static float
+FloatAtan2PU(float fA, float fB)
+{
+    float fTurn;
+
+    fTurn = atan2f(fA, fB) * (1.0f / 6.2831853f);
+    return((fTurn < 0.0f) ? (fTurn + 1.0f) : fTurn);
+}
+static float FloatSqrt(float fA, float fB) { return(sqrtf(fA)); }
+static float FloatIsqrt(float fA, float fB) { return(1.0f / sqrtf(fA)); }
+static float FloatExp(float fA, float fB) { return(expf(fA)); }
+static float FloatExp2(float fA, float fB) { return(exp2f(fA)); }
+static float FloatMag(float fA, float fB) { return(hypotf(fA, fB)); }
+
+static double DoubleMpy(double dA, double dB) { return(dA * dB); }
+static double DoubleDiv(double dA, double dB) { return(dA / dB); }
+static double DoubleSin(double dA, double dB) { return(sin(dA)); }
+static double DoubleCos(double dA, double dB) { return(cos(dA)); }
+static double DoubleSinPU(double dA, double dB) { return(sin(dA * 2 * PI)); }
+static double DoubleCosPU(double dA, double dB) { return(cos(dA * 2 * PI)); }
+static double DoubleAsin(double dA, double dB) { return(asin(dA)); }
+static double DoubleAtan2(double dA, double dB) { return(atan2(dA, dB)); }
+static double
+DoubleAtan2PU(double dA, double dB)
+{
+    double dTurn;
+
+    dTurn = atan2(dA, dB) / (2 * PI);
+    return((dTurn < 0.0) ? (dTurn + 1.0) : dTurn);
+}
+static double DoubleSqrt(double dA, double dB) { return(sqrt(dA)); }
+static double DoubleIsqrt(double dA, double dB) { return(1.0 / sqrt(dA)); }
+static double DoubleExp(double dA, double dB) { return(exp(dA)); }
+static double DoubleExp2(double dA, double dB) { return(exp2(dA)); }
+static double DoubleMag(double dA, double dB) { return(hypot(dA, dB)); }
+
+//*****************************************************************************
+//
+// A function that is measured, in every format that provides it.
+//
+//*****************************************************************************
+typedef struct
+{
+    //
+    // The name of the function, and the range its inputs are drawn from.
+    //
+    const char *pcName;
+    int iRange;
+
+    //
+    // The largest error allowed, in units of the last place of the format.
+    //
+    double dLimit;
+
+    //
+    // The function in float and in double.
+    //
+    tFloatFunction pfnFloat;
+    tDoubleFunction pfnDouble;
+
+    //
+    // The function in each format, with one or two arguments.
+    //
+    tIQFunction1 ppfnIQ1[31];
+    tIQFunction2 ppfnIQ2[31];
+}
+tFunction;
+
+//*****************************************************************************
+//
+// The functions that are measured.  The functions that truncate rather than
+// round are allowed an error of one, and those that are found with a series
+// in Q30 or Q31 are allowed a little more than that in the largest formats.
+//
+//*****************************************************************************
+static const tFunction g_psFunctions[] =
+{
+    {
+        "mpy", RANGE_SQRT, 1.0, FloatMpy, DoubleMpy,
+        { 0 }, IQ_LIST(tIQFunction2, mpy)
+    },
+    {
+        "div", RANGE_FULL, 1.0, FloatDiv, DoubleDiv,
+        { 0 }, IQ_LIST(tIQFunction2, div)
+    },
+    {
+        "sin", RANGE_RADIANS, 2.5, FloatSin, DoubleSin,
+        IQ_LIST29(tIQFunction1, sin), { 0 }
+    },
+    {
+        "cos", RANGE_RADIANS, 2.5, FloatCos, DoubleCos,
+        IQ_LIST29(tIQFunction1, cos), { 0 }
+    },
+    {
+        "sinPU", RANGE_TURN, 2.5, FloatSinPU, DoubleSinPU,
+        IQ_LIST(tIQFunction1, sinPU), { 0 }
+    },
+    {
+        "cosPU", RANGE_TURN, 2.5, FloatCosPU, DoubleCosPU,
+        IQ_LIST(tIQFunction1, cosPU), { 0 }
+    },
+    {
+        "asin", RANGE_UNIT, 2.5, FloatAsin, DoubleAsin,
+        IQ_LIST29(tIQFunction1, asin), { 0 }
+    },
+    {
+        "atan2", RANGE_FULL, 2.5, FloatAtan2, DoubleAtan2,
+        { 0 }, IQ_LIST29(tIQFunction2, atan2)
+    },
+    {
+        "atan2PU", RANGE_FULL, 1.0, FloatAtan2PU, DoubleAtan2PU,
+        { 0 }, IQ_LIST(tIQFunction2, atan2PU)
+    },
+    {
+        "sqrt", RANGE_POSITIVE, 0.5, FloatSqrt, DoubleSqrt,
+        IQ_LIST(tIQFunction1, sqrt), { 0 }
+    },
+    {
+        "isqrt", RANGE_POSITIVE, 2.0, FloatIsqrt, DoubleIsqrt,
+        IQ_LIST(tIQFunction1, isqrt), { 0 }
+    },
+    {
+        "exp", RANGE_EXP, 2.5, FloatExp, DoubleExp,
+        IQ_LIST(tIQFunction1, exp), { 0 }
+    },
+    {
+        "exp2", RANGE_EXP2, 2.5, FloatExp2, DoubleExp2,
+        IQ_LIST(tIQFunction1, exp2), { 0 }
+    },
+    {
+        "mag", RANGE_FULL, 0.5, FloatMag, DoubleMag,
+        { 0 }, IQ_LIST(tIQFunction2, mag)
+    }
+};
+#define NUM_FUNCTIONS           (sizeof(g_psFunctions) /                      \
+                                 sizeof(g_psFunctions[0]))
+
+//*****************************************************************************
+//
+// Globals controlled by various command line parameters.
+//
+//*****************************************************************************
+BOOL g_bVerbose              = FALSE;
+BOOL g_bQuiet                = FALSE;
+unsigned long g_ulCases      = 100000;
+unsigned long g_ulIterations = 1000;
+unsigned long g_ulSeed       = 1;
+int g_iTimedQ                = 24;
+
+//*****************************************************************************
+//
+// The number of checks that failed.
+//
+//*****************************************************************************
+unsigned long g_ulFailed = 0;
+
+//*****************************************************************************
+//
+// Helpful macros for generating output depending upon verbose and quiet flags.
+//
+//*****************************************************************************
+#define VERBOSEPRINT(...) if(g_bVerbose) { printf(__VA_ARGS__); }
+#define QUIETPRINT(...) if(!g_bQuiet) { printf(__VA_ARGS__); }
+
+//*****************************************************************************
+//
+// Returns the next value from a xorshift generator, so that a run can be
+// repeated with the same seed.
+//
+//*****************************************************************************
+static unsigned long
+Random(void)
+{
+    g_ulSeed ^= (g_ulSeed << 13) & 0xffffffff;
+    g_ulSeed ^= g_ulSeed >> 17;
+    g_ulSeed ^= (g_ulSeed << 5) & 0xffffffff;
+
+    return(g_ulSeed);
+}
+
+//*****************************************************************************
+//
+// Returns a random value from dMin to dMax in the given format.
+//
+//*****************************************************************************
+static long
+RandomIQ(double dMin, double dMax, int iQ)
+{
+    double dValue;
+
+    dValue = dMin + ((dMax - dMin) * ((double)Random() / 4294967296.0));
+    dValue = floor((dValue * (double)(1L << iQ)) + 0.5);
+    if(dValue > 2147483647.0)
+    {
+        dValue = 2147483647.0;
+    }
+    if(dValue < -2147483648.0)
+    {
+        dValue = -2147483648.0;
+    }
+
+    return((long)dValue);
+}
+
+//*****************************************************************************
+//
+// Returns a random input for a function in the given format.
+//
+//*****************************************************************************
+static long
+RandomInput(int iRange, int iQ)
+{
+    double dMax;
+
+    dMax = 2147483647.0 / (double)(1L << iQ);
+    switch(iRange)
+    {
+        case RANGE_SQRT:
+            return(RandomIQ(-sqrt(dMax), sqrt(dMax), iQ));
+
+        case RANGE_POSITIVE:
+            return(RandomIQ(0.0, dMax, iQ));
+
+        case RANGE_UNIT:
+            return(RandomIQ(-1.0, 1.0, iQ));
+
+        case RANGE_TURN:
+            return(RandomIQ(-fmin(1.0, dMax), fmin(1.0, dMax), iQ));
+
+        case RANGE_RADIANS:
+            return(RandomIQ(-fmin(2 * PI, dMax), fmin(2 * PI, dMax), iQ));
+
+        case RANGE_EXP:
+            return(RandomIQ(-fmin(25.0, dMax), fmin(log(dMax), dMax), iQ));
+
+        case RANGE_EXP2:
+            return(RandomIQ(-fmin(32.0, dMax), fmin(log2(dMax), dMax), iQ));
+
+        default:
+            return(RandomIQ(-dMax, dMax, iQ));
+    }
+}
+
+//*****************************************************************************
+//
+// Returns the time in nanoseconds from an arbitrary point.
+//
+//*****************************************************************************
+static unsigned long long
+Nanoseconds(void)
+{
+    struct timespec sTime;
+
+    clock_gettime(CLOCK_MONOTONIC, &sTime);
+
+    return(((unsigned long long)sTime.tv_sec * 1000000000ULL) +
+           sTime.tv_nsec);
+}
+
+//*****************************************************************************
+//
+// Returns the processor's cycle count, where it can be read.
+//
+//*****************************************************************************
+static unsigned long long
+Cycles(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+    return(__rdtsc());
+#else
+    return(0);
+#endif
+}
+
+//*****************************************************************************
+//
+// Show the startup banner.
+//
+//*****************************************************************************
+void
+PrintWelcome(void)
+{
+    QUIETPRINT("\niqbench - Check and time the IQmath functions.\n\n");
+}
+
+//*****************************************************************************
+//
+// Show help on the application's command line parameters.
+//
+//*****************************************************************************
+void
+ShowHelp(void)
+{
+    //
+    // Only print help if we are not in quiet mode.
+    //
+    if(g_bQuiet)
+    {
+        return;
+    }
+
+    printf("This application builds IQmath/iqmath.c for the host and checks\n");
+    printf("each function in every IQ format against the same function in\n");
+    printf("double, reporting the largest and RMS errors in units of the\n");
+    printf("last place of the format, along with those of the function in\n");
+    printf("float.  It then times the function in one format, in float and\n");
+    printf("in double.\n\n");
+    printf("Supported parameters are:\n\n");
+    printf("-c <num>  - Check the given number of random inputs in each\n");
+    printf("            format (default 100000).\n");
+    printf("-n <num>  - Time the given number of passes over %d inputs\n",
+           NUM_TIMED);
+    printf("            (default 1000), or none if 0.\n");
+    printf("-g <num>  - Time the functions in the given format (default\n");
+    printf("            24).\n");
+    printf("-r <num>  - Seed the random inputs with the given number\n");
+    printf("            (default 1).\n");
+    printf("-? or -h  - Show this help.\n");
+    printf("-q        - Quiet mode. Disable output to stdio.\n");
+    printf("-e        - Enable verbose output, showing every format.\n\n");
+    printf("Example:\n\n");
+    printf("   iqbench -c 1000000 -g 16\n\n");
+}
+
+//*****************************************************************************
+//
+// Parse the command line, extracting all parameters.
+//
+// Returns 0 on failure, 1 on success.
+//
+//*****************************************************************************
+int
+ParseCommandLine(int argc, char *argv[])
+{
+    int iRetcode;
+    BOOL bShowHelp;
+
+    //
+    // By default, don't show the help screen.
+    //
+    bShowHelp = FALSE;
+
+    while(1)
+    {
+        //
+        // Get the next command line parameter.
+        //
+        iRetcode = getopt(argc, argv, "c:n:g:r:eh?q");
+
+        if(iRetcode == -1)
+        {
+            break;
+        }
+
+        switch(iRetcode)
+        {
+            case 'c':
+                g_ulCases = strtoul(optarg, NULL, 0);
+                break;
+
+            case 'n':
+                g_ulIterations = strtoul(optarg, NULL, 0);
+                break;
+
+            case 'g':
+                g_iTimedQ = atoi(optarg);
+                break;
+
+            case 'r':
+                g_ulSeed = strtoul(optarg, NULL, 0) & 0xffffffff;
+                break;
+
+            case 'e':
+                g_bVerbose = TRUE;
+                break;
+
+            case 'q':
+                g_bQuiet = TRUE;
+                break;
+
+            case '?':
+            case 'h':
+                bShowHelp = TRUE;
+                break;
+        }
+    }
+
+    //
+    // Show the welcome banner unless we have been told to be quiet.
+    //
+    PrintWelcome();
+
+    //
+    // Catch various invalid parameter cases.
+    //
+    if(bShowHelp || (g_ulSeed == 0) || (g_iTimedQ < 1) || (g_iTimedQ > 29) ||
+       (optind != argc))
+    {
+        ShowHelp();
+        return(0);
+    }
+
+    return(1);
+}
+
+//*****************************************************************************
+//
+// Calls a function in the given format.
+//
+//*****************************************************************************
+static long
+CallIQ(const tFunction *psFunc, int iQ, long lA, long lB)
+{
+    if(psFunc->ppfnIQ1[iQ])
+    {
+        return(psFunc->ppfnIQ1[iQ](lA));
+    }
+
+    return(psFunc->ppfnIQ2[iQ](lA, lB));
+}
+
+//*****************************************************************************
+//
+// Checks a function in one format against double, and reports the errors of
+// the function and of float in units of the last place.  Inputs whose result
+// does not fit in the format are skipped.
+//
+//*****************************************************************************
+static void
+CheckFunction(const tFunction *psFunc, int iQ, double *pdMaxIQ,
+              double *pdMaxFloat)
+{
+    double dScale, dA, dB, dRef, dErr, dSumIQ, dSumFloat, dMaxIQ, dMaxFloat;
+    double dMax, dErrFloat;
+    unsigned long ulIdx, ulCount;
+    long lA, lB, lResult;
+
+    dScale = (double)(1L << iQ);
+    dMax = 2147483647.0 / dScale;
+    dSumIQ = dSumFloat = dMaxIQ = dMaxFloat = 0.0;
+    ulCount = 0;
+
+    for(ulIdx = 0; ulIdx < g_ulCases; ulIdx++)
+    {
+        lA = RandomInput(psFunc->iRange, iQ);
+        lB = RandomInput(psFunc->iRange, iQ);
+        dA = (double)lA / dScale;
+        dB = (double)lB / dScale;
+
+        //
+        // Skip inputs that have no result, or one that does not fit.
+        //
+        dRef = psFunc->pfnDouble(dA, dB);
+        if(isnan(dRef) || (fabs(dRef) >= dMax))
+        {
+            continue;
+        }
+
+        lResult = CallIQ(psFunc, iQ, lA, lB);
+        dErr = fabs(((double)lResult / dScale) - dRef) * dScale;
+        dErrFloat = fabs((double)psFunc->pfnFloat((float)dA, (float)dB) -
+                         dRef) * dScale;
+
+        //
+        // The turn returned by atan2PU is the same at 0 and 1.
+        //
+        if(psFunc->pfnDouble == DoubleAtan2PU)
+        {
+            dErr = fmin(dErr, fabs(dErr - dScale));
+            dErrFloat = fmin(dErrFloat, fabs(dErrFloat - dScale));
+        }
+
+        if(dErr > psFunc->dLimit + 1e-6)
+        {
+            if(g_ulFailed++ < 10)
+            {
+                VERBOSEPRINT("_IQ%d%s(%.10g, %.10g) = %.10g, expected "
+                             "%.10g\n", iQ, psFunc->pcName, dA, dB,
+                             (double)lResult / dScale, dRef);
+            }
+        }
+
+        dSumIQ += dErr * dErr;
+        dSumFloat += dErrFloat * dErrFloat;
+        dMaxIQ = fmax(dMaxIQ, dErr);
+        dMaxFloat = fmax(dMaxFloat, dErrFloat);
+        ulCount++;
+    }
+
+    if(ulCount)
+    {
+        VERBOSEPRINT("  %-8s IQ%-2d  %8.3f %8.3f   %12.3f %12.3f\n",
+                     psFunc->pcName, iQ, dMaxIQ, sqrt(dSumIQ / ulCount),
+                     dMaxFloat, sqrt(dSumFloat / ulCount));
+    }
+
+    *pdMaxIQ = fmax(*pdMaxIQ, dMaxIQ);
+    *pdMaxFloat = fmax(*pdMaxFloat, dMaxFloat);
+}
+
+//*****************************************************************************
+//
+// Checks the conversions and the functions that are exact against the same
+// arithmetic done in 64 bits.
+//
+//*****************************************************************************
+static void
+CheckExact(void)
+{
+    long long llProd, llExpect;
+    unsigned long ulIdx;
+    long lA, lB, lResult;
+    char pcBuf[32];
+    double dValue;
+    int iQ;
+
+    for(ulIdx = 0; ulIdx < g_ulCases; ulIdx++)
+    {
+        iQ = 1 + (Random() % 30);
+        lA = (long)(int)Random();
+        lB = (long)(int)Random() >> (Random() % 32);
+        llProd = (long long)lA * lB;
+
+        //
+        // The rounded and saturated product.
+        //
+        llExpect = (llProd + (1LL << 29)) >> 30;
+        llExpect = (llExpect > 2147483647LL) ? 2147483647LL :
+                   (llExpect < -2147483648LL) ? -2147483648LL : llExpect;
+        lResult = _IQ30rsmpy(lA, lB);
+        if(lResult != llExpect)
+        {
+            g_ulFailed++;
+            VERBOSEPRINT("_IQ30rsmpy(%ld, %ld) = %ld\n", lA, lB, lResult);
+        }
+
+        //
+        // The integer and fractional parts of a product with an integer,
+        // which add up to the product.
+        //
+        lResult = (iQ == 16) ? _IQ16mpyI32int(lA, lB) : _IQ8mpyI32int(lA, lB);
+        llExpect = (iQ == 16) ? (llProd / 65536) : (llProd / 256);
+        if((llExpect <= 2147483647LL) && (llExpect >= -2147483648LL) &&
+           (lResult != llExpect))
+        {
+            g_ulFailed++;
+            VERBOSEPRINT("mpyI32int(%ld, %ld) = %ld\n", lA, lB, lResult);
+        }
+        lResult = (iQ == 16) ? _IQ16mpyI32frac(lA, lB) :
+                  _IQ8mpyI32frac(lA, lB);
+        if(lResult != ((iQ == 16) ? (llProd % 65536) : (llProd % 256)))
+        {
+            g_ulFailed++;
+            VERBOSEPRINT("mpyI32frac(%ld, %ld) = %ld\n", lA, lB, lResult);
+        }
+
+        //
+        // The product of values in different formats.
+        //
+        lResult = __IQxmpy(lA, lB, 32 + iQ - 30 - 20);
+        if(lResult != (long)(int)(llProd >> (50 - iQ)))
+        {
+            g_ulFailed++;
+            VERBOSEPRINT("__IQxmpy(%ld, %ld, %d) = %ld\n", lA, lB,
+                         32 + iQ - 50, lResult);
+        }
+
+        //
+        // The fractional part, which keeps the sign.
+        //
+        lResult = _IQ20frac(lA);
+        if(lResult != (lA % (1L << 20)))
+        {
+            g_ulFailed++;
+            VERBOSEPRINT("_IQ20frac(%ld) = %ld\n", lA, lResult);
+        }
+
+        //
+        // A value printed to nine places and read back.
+        //
+        lA = (long)(int)Random() >> 2;
+        if(__IQNtoa(pcBuf, "%10.9f", lA, 20) != 0)
+        {
+            g_ulFailed++;
+            VERBOSEPRINT("__IQNtoa(%ld) failed\n", lA);
+            continue;
+        }
+        dValue = (double)lA / 1048576.0;
+        if((fabs(strtod(pcBuf, NULL) - dValue) > 1e-9) ||
+           (_atoIQN(pcBuf, 20) != lA))
+        {
+            g_ulFailed++;
+            VERBOSEPRINT("\"%s\" for %.10f, read as %ld for %ld\n", pcBuf,
+                         dValue, (long)_atoIQN(pcBuf, 20), lA);
+        }
+    }
+
+    //
+    // Values that are out of range.
+    //
+    if((_atoIQN("-2", 30) != -2147483647L - 1) ||
+       (_atoIQN("2", 30) != 2147483647L) ||
+       (__IQNtoa(pcBuf, "%2.3f", _IQ16(100.0), 16) != 1) ||
+       (__IQNtoa(pcBuf, "%2.3d", _IQ16(1.0), 16) != 2) ||
+       (__IQNtoa(pcBuf, "%3.2f", _IQ16(-12.345), 16) != 0) ||
+       strcmp(pcBuf, "-12.34"))
+    {
+        g_ulFailed++;
+        VERBOSEPRINT("Conversion of an out of range value is wrong\n");
+    }
+}
+
+//*****************************************************************************
+//
+// Times a function in one format, in float and in double, over the same
+// inputs.
+//
+//*****************************************************************************
+static void
+TimeFunction(const tFunction *psFunc, int iQ)
+{
+    static long plA[NUM_TIMED], plB[NUM_TIMED];
+    static float pfA[NUM_TIMED], pfB[NUM_TIMED];
+    static double pdA[NUM_TIMED], pdB[NUM_TIMED];
+    unsigned long long pullNs[3], pullCycles[3], ullStart, ullCycles;
+    unsigned long ulPass, ulIdx;
+    double dScale, dSum, dCalls;
+    long lSum;
+    float fSum;
+    int iIdx;
+
+    if(!psFunc->ppfnIQ1[iQ] && !psFunc->ppfnIQ2[iQ])
+    {
+        return;
+    }
+
+    //
+    // Build inputs whose results fit in the format.
+    //
+    dScale = (double)(1L << iQ);
+    for(ulIdx = 0; ulIdx < NUM_TIMED; )
+    {
+        plA[ulIdx] = RandomInput(psFunc->iRange, iQ);
+        plB[ulIdx] = RandomInput(psFunc->iRange, iQ);
+        pdA[ulIdx] = (double)plA[ulIdx] / dScale;
+        pdB[ulIdx] = (double)plB[ulIdx] / dScale;
+        pfA[ulIdx] = (float)pdA[ulIdx];
+        pfB[ulIdx] = (float)pdB[ulIdx];
+        dSum = psFunc->pfnDouble(pdA[ulIdx], pdB[ulIdx]);
+        if(!isnan(dSum) && (fabs(dSum) < (2147483647.0 / dScale)))
+        {
+            ulIdx++;
+        }
+    }
+
+    //
+    // Time each kind of the function, calling it through a pointer in each
+    // case so that the overhead of the call is the same.
+    //
+    lSum = 0;
+    fSum = 0.0f;
+    dSum = 0.0;
+    for(iIdx = 0; iIdx < 3; iIdx++)
+    {
+        ullStart = Nanoseconds();
+        ullCycles = Cycles();
+        for(ulPass = 0; ulPass < g_ulIterations; ulPass++)
+        {
+            for(ulIdx = 0; ulIdx < NUM_TIMED; ulIdx++)
+            {
+                if(iIdx == 0)
+                {
+                    lSum += CallIQ(psFunc, iQ, plA[ulIdx], plB[ulIdx]);
+                }
+                else if(iIdx == 1)
+                {
+                    fSum += psFunc->pfnFloat(pfA[ulIdx], pfB[ulIdx]);
+                }
+                else
+                {
+                    dSum += psFunc->pfnDouble(pdA[ulIdx], pdB[ulIdx]);
+                }
+            }
+        }
+        pullCycles[iIdx] = Cycles() - ullCycles;
+        pullNs[iIdx] = Nanoseconds() - ullStart;
+    }
+
+    dCalls = (double)g_ulIterations * NUM_TIMED;
+    QUIETPRINT("  %-8s", psFunc->pcName);
+    for(iIdx = 0; iIdx < 3; iIdx++)
+    {
+        QUIETPRINT("  %7.1fns", (double)pullNs[iIdx] / dCalls);
+        if(pullCycles[iIdx])
+        {
+            QUIETPRINT(" %6.1f", (double)pullCycles[iIdx] / dCalls);
+        }
+    }
+    QUIETPRINT("\n");
+    VERBOSEPRINT("(checksum %ld %g %g)\n", lSum, (double)fSum, dSum);
+}
+
+//*****************************************************************************
+//
+// The main entry point of the IQmath benchmark.
+//
+//*****************************************************************************
+int
+main(int argc, char *argv[])
+{
+    double dMaxIQ, dMaxFloat;
+    unsigned long ulFunc;
+    int iQ;
+
+    //
+    // Parse the command line.
+    //
+    if(!ParseCommandLine(argc, argv))
+    {
+        return(1);
+    }
+
+    //
+    // Check each function in every format that provides it, and summarize
+    // the largest errors over all of the formats.
+    //
+    QUIETPRINT("Largest error, in units of the last place, over %lu inputs in "
+               "each format:\n", g_ulCases);
+    VERBOSEPRINT("  function format  IQ max   IQ rms      float max    float "
+                 "rms\n");
+    for(ulFunc = 0; ulFunc < NUM_FUNCTIONS; ulFunc++)
+    {
+        dMaxIQ = 0.0;
+        dMaxFloat = 0.0;
+        for(iQ = 30; iQ >= 1; iQ--)
+        {
+            if(g_psFunctions[ulFunc].ppfnIQ1[iQ] ||
+               g_psFunctions[ulFunc].ppfnIQ2[iQ])
+            {
+                CheckFunction(&g_psFunctions[ulFunc], iQ, &dMaxIQ,
+                              &dMaxFloat);
+            }
+        }
+        QUIETPRINT("  %-8s IQ %8.3f   float %14.3f\n",
+                   g_psFunctions[ulFunc].pcName, dMaxIQ, dMaxFloat);
+    }
+    CheckExact();
+    QUIETPRINT("%lu checks failed.\n", g_ulFailed);
+
+    //
+    // Time each function in the chosen format.
+    //
+    if(g_ulIterations)
+    {
+        QUIETPRINT("\nTime per call in IQ%d, float and double%s:\n",
+                   g_iTimedQ, Cycles() ? " (ns, cycles)" : "");
+        for(ulFunc = 0; ulFunc < NUM_FUNCTIONS; ulFunc++)
+        {
+            TimeFunction(&g_psFunctions[ulFunc], g_iTimedQ);
+        }
+    }
+
+    return(g_ulFailed ? 1 : 0);
+}
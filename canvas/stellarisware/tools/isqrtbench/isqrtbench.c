@@ -0,0 +1,676 @@
+//*****************************************************************************
+//
+// isqrtbench.c - A command line utility that builds utils/isqrt.c for the
+//                host, checks every 32-bit input of isqrt() and a sample of
+//                the other functions, and measures their speed.
+//
+//*****************************************************************************
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#include <math.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+#include "utils/isqrt.h"
+
+typedef unsigned char BOOL;
+#define FALSE 0
+#define TRUE  1
+
+//*****************************************************************************
+//
+// The number of inputs that are timed, which fit in the first level cache so
+// that the functions themselves are measured.
+//
+//*****************************************************************************
+#define NUM_TIMED               1024
+
+//*****************************************************************************
+//
+// The largest error allowed in imagapprox(), as a fraction of the exact
+// magnitude and in units, the latter for the rounding of the result.
+//
+//*****************************************************************************
+#define APPROX_LIMIT            0.0122
+#define APPROX_UNITS            1.0
+
+//*****************************************************************************
+//
+// Globals controlled by various command line parameters.
+//
+//*****************************************************************************
+BOOL g_bVerbose              = FALSE;
+BOOL g_bQuiet                = FALSE;
+BOOL g_bExhaustive           = TRUE;
+unsigned long g_ulCases      = 10000000;
+unsigned long g_ulIterations = 10000;
+unsigned long g_ulSeed       = 1;
+
+//*****************************************************************************
+//
+// The number of checks that failed.
+//
+//*****************************************************************************
+unsigned long g_ulFailed = 0;
+
+//*****************************************************************************
+//
+// Helpful macros for generating output depending upon verbose and quiet flags.
+//
+//*****************************************************************************
+#define VERBOSEPRINT(...) if(g_bVerbose) { printf(__VA_ARGS__); }
+#define QUIETPRINT(...) if(!g_bQuiet) { printf(__VA_ARGS__); }
+
+//*****************************************************************************
+//
+// Records a failed check, showing the first few of them.
+//
+//*****************************************************************************
+#define CHECK(bOk, ...)                                                       \
+    do                                                                        \
+    {                                                                         \
+        if(!(bOk) && (g_ulFailed++ < 10))                                     \
+        {                                                                     \
+            VERBOSEPRINT(__VA_ARGS__);                                        \
+        }                                                                     \
+    }                                                                         \
+    while(0)
+
+//*****************************************************************************
+//
+// Returns the next value from a xorshift generator, so that a run can be
+// repeated with the same seed.
+//
+//*****************************************************************************
+static unsigned long
+Random(void)
+{
+    g_ulSeed ^= (g_ulSeed << 13) & 0xffffffff;
+    g_ulSeed ^= g_ulSeed >> 17;
+    g_ulSeed ^= (g_ulSeed << 5) & 0xffffffff;
+
+    return(g_ulSeed);
+}
+
+//*****************************************************************************
+//
+// Returns a random 64-bit value with a random number of significant bits, so
+// that every size of input is checked.
+//
+//*****************************************************************************
+static unsigned long long
+Random64(void)
+{
+    unsigned long long ullValue;
+
+    ullValue = ((unsigned long long)Random() << 32) | Random();
+
+    return(ullValue >> (Random() & 63));
+}
+
+//*****************************************************************************
+//
+// Returns a random signed component of at most the given number of bits.
+//
+//*****************************************************************************
+static long
+RandomComponent(unsigned long ulBits)
+{
+    long lValue;
+
+    lValue = (long)(Random() & ((1UL << ulBits) - 1));
+
+    return((Random() & 1) ? -lValue : lValue);
+}
+
+//*****************************************************************************
+//
+// Returns the time in nanoseconds from an arbitrary point.
+//
+//*****************************************************************************
+static unsigned long long
+Nanoseconds(void)
+{
+    struct timespec sTime;
+
+    clock_gettime(CLOCK_MONOTONIC, &sTime);
+
+    return(((unsigned long long)sTime.tv_sec * 1000000000ULL) +
+           sTime.tv_nsec);
+}
+
+//*****************************************************************************
+//
+// Returns the processor's cycle count, where it can be read.
+//
+//*****************************************************************************
+static unsigned long long
+Cycles(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+    return(__rdtsc());
+#else
+    return(0);
+#endif
+}
+
+//*****************************************************************************
+//
+// The bit at a time square root that utils/isqrt.c used to provide, which is
+// timed against the new one.
+//
+//*****************************************************************************
+static unsigned long
+BitwiseSqrt(unsigned long ulValue)
+{
+    unsigned long ulRem, ulRoot, ulIdx;
+
+    ulRem = 0;
+    ulRoot = 0;
+    for(ulIdx = 0; ulIdx < 16; ulIdx++)
+    {
+        ulRem = (ulRem << 2) + ((ulValue >> 30) & 3);
+        ulValue <<= 2;
+        ulRoot <<= 1;
+        if(ulRem >= ((ulRoot << 1) + 1))
+        {
+            ulRem -= (ulRoot << 1) + 1;
+            ulRoot++;
+        }
+    }
+
+    return(ulRoot);
+}
+
+//*****************************************************************************
+//
+// The functions that are timed, called through a pointer so that the
+// overhead of the call is the same for each.
+//
+//*****************************************************************************
+static unsigned long TimeIsqrt(unsigned long ulA, unsigned long ulB)
+    { return(isqrt(ulA)); }
+static unsigned long TimeBitwise(unsigned long ulA, unsigned long ulB)
+    { return(BitwiseSqrt(ulA)); }
+static unsigned long TimeSqrt(unsigned long ulA, unsigned long ulB)
+    { return((unsigned long)sqrt((double)ulA)); }
+static unsigned long TimeSqrtf(unsigned long ulA, unsigned long ulB)
+    { return((unsigned long)sqrtf((float)ulA)); }
+static unsigned long TimeImag(unsigned long ulA, unsigned long ulB)
+    { return(imag((long)ulA, (long)ulB)); }
+static unsigned long TimeImagApprox(unsigned long ulA, unsigned long ulB)
+    { return(imagapprox((long)ulA, (long)ulB)); }
+static unsigned long TimeHypot(unsigned long ulA, unsigned long ulB)
+    { return((unsigned long)hypot((double)(long)ulA, (double)(long)ulB)); }
+
+//*****************************************************************************
+//
+// Show the startup banner.
+//
+//*****************************************************************************
+void
+PrintWelcome(void)
+{
+    QUIETPRINT("\nisqrtbench - Check and time the integer square root.\n\n");
+}
+
+//*****************************************************************************
+//
+// Show help on the application's command line parameters.
+//
+//*****************************************************************************
+void
+ShowHelp(void)
+{
+    //
+    // Only print help if we are not in quiet mode.
+    //
+    if(g_bQuiet)
+    {
+        return;
+    }
+
+    printf("This application builds utils/isqrt.c for the host and checks\n");
+    printf("isqrt() for every 32-bit input, and the 64-bit root, the exact\n");
+    printf("and approximate magnitudes and the array forms for random\n");
+    printf("inputs.  It then times each function against the bit at a time\n");
+    printf("root it replaces and the C library.\n\n");
+    printf("Supported parameters are:\n\n");
+    printf("-c <num>  - Check the given number of random inputs (default\n");
+    printf("            10000000).\n");
+    printf("-n <num>  - Time the given number of passes over %d inputs\n",
+           NUM_TIMED);
+    printf("            (default 10000), or none if 0.\n");
+    printf("-r <num>  - Seed the random inputs with the given number\n");
+    printf("            (default 1).\n");
+    printf("-s        - Skip the check of every 32-bit input.\n");
+    printf("-? or -h  - Show this help.\n");
+    printf("-q        - Quiet mode. Disable output to stdio.\n");
+    printf("-e        - Enable verbose output, showing failed checks.\n\n");
+    printf("Example:\n\n");
+    printf("   isqrtbench -s -c 1000000\n\n");
+}
+
+//*****************************************************************************
+//
+// Parse the command line, extracting all parameters.
+//
+// Returns 0 on failure, 1 on success.
+//
+//*****************************************************************************
+int
+ParseCommandLine(int argc, char *argv[])
+{
+    int iRetcode;
+    BOOL bShowHelp;
+
+    //
+    // By default, don't show the help screen.
+    //
+    bShowHelp = FALSE;
+
+    while(1)
+    {
+        //
+        // Get the next command line parameter.
+        //
+        iRetcode = getopt(argc, argv, "c:n:r:seh?q");
+
+        if(iRetcode == -1)
+        {
+            break;
+        }
+
+        switch(iRetcode)
+        {
+            case 'c':
+                g_ulCases = strtoul(optarg, NULL, 0);
+                break;
+
+            case 'n':
+                g_ulIterations = strtoul(optarg, NULL, 0);
+                break;
+
+            case 'r':
+                g_ulSeed = strtoul(optarg, NULL, 0) & 0xffffffff;
+                break;
+
+            case 's':
+                g_bExhaustive = FALSE;
+                break;
+
+            case 'e':
+                g_bVerbose = TRUE;
+                break;
+
+            case 'q':
+                g_bQuiet = TRUE;
+                break;
+
+            case '?':
+            case 'h':
+                bShowHelp = TRUE;
+                break;
+        }
+    }
+
+    //
+    // Show the welcome banner unless we have been told to be quiet.
+    //
+    PrintWelcome();
+
+    //
+    // Catch various invalid parameter cases.
+    //
+    if(bShowHelp || (g_ulSeed == 0) || (optind != argc))
+    {
+        ShowHelp();
+        return(0);
+    }
+
+    return(1);
+}
+
+//*****************************************************************************
+//
+// Returns true if the root is the largest whose square is no more than the
+// value.
+//
+//*****************************************************************************
+static BOOL
+IsRoot(unsigned long long ullValue, unsigned long ulRoot)
+{
+    unsigned long long ullRoot;
+
+    ullRoot = ulRoot;
+    if((ullRoot * ullRoot) > ullValue)
+    {
+        return(FALSE);
+    }
+
+    return((ullRoot == 0xffffffff) ||
+           (((ullRoot + 1) * (ullRoot + 1)) > ullValue));
+}
+
+//*****************************************************************************
+//
+// Checks isqrt() for every 32-bit input, in blocks through isqrtarray() so
+// that the array form is checked as well.
+//
+//*****************************************************************************
+static void
+CheckExhaustive(void)
+{
+    static unsigned long pulValue[4096], pulRoot[4096];
+    unsigned long long ullBase;
+    unsigned long ulIdx, ulRoot;
+
+    for(ullBase = 0; ullBase < 0x100000000ULL; ullBase += 4096)
+    {
+        for(ulIdx = 0; ulIdx < 4096; ulIdx++)
+        {
+            pulValue[ulIdx] = (unsigned long)ullBase + ulIdx;
+        }
+        isqrtarray(pulRoot, pulValue, 4096);
+        for(ulIdx = 0; ulIdx < 4096; ulIdx++)
+        {
+            ulRoot = isqrt(pulValue[ulIdx]);
+            CHECK(IsRoot(pulValue[ulIdx], ulRoot) &&
+                  (pulRoot[ulIdx] == ulRoot),
+                  "isqrt(%lu) = %lu, isqrtarray = %lu\n", pulValue[ulIdx],
+                  ulRoot, pulRoot[ulIdx]);
+        }
+    }
+}
+
+//*****************************************************************************
+//
+// Checks the 64-bit root at the edges of each size of input, and for random
+// inputs.
+//
+//*****************************************************************************
+static void
+CheckRoot64(void)
+{
+    unsigned long long ullValue, ullRoot;
+    unsigned long ulIdx, ulBit;
+    long lDelta;
+
+    //
+    // The squares either side of each power of two, and of the largest roots.
+    //
+    for(ulBit = 0; ulBit < 32; ulBit++)
+    {
+        for(lDelta = -2; lDelta <= 2; lDelta++)
+        {
+            ullRoot = (1ULL << ulBit) + lDelta;
+            if(ullRoot > 0xffffffff)
+            {
+                ullRoot = 0xffffffff - (2 - lDelta);
+            }
+            ullValue = ullRoot * ullRoot;
+            CHECK(IsRoot(ullValue, isqrt64(ullValue)) &&
+                  IsRoot(ullValue - 1, isqrt64(ullValue - 1)) &&
+                  IsRoot(ullValue + 1, isqrt64(ullValue + 1)),
+                  "isqrt64 fails near %llu squared\n", ullRoot);
+        }
+    }
+    ullValue = 0xffffffffffffffffULL;
+    CHECK(isqrt64(ullValue) == 0xffffffff, "isqrt64(2^64 - 1) = %lu\n",
+          isqrt64(ullValue));
+
+    //
+    // Random inputs of every size.
+    //
+    for(ulIdx = 0; ulIdx < g_ulCases; ulIdx++)
+    {
+        ullValue = Random64();
+        CHECK(IsRoot(ullValue, isqrt64(ullValue)), "isqrt64(%llu) = %lu\n",
+              ullValue, isqrt64(ullValue));
+    }
+}
+
+//*****************************************************************************
+//
+// Checks the exact and approximate magnitudes, and their array forms, for
+// every vector near the origin and for random vectors of every size, and
+// reports the largest error of the approximation.
+//
+//*****************************************************************************
+static void
+CheckMagnitude(double *pdMaxApprox)
+{
+    static long plX[NUM_TIMED], plY[NUM_TIMED];
+    static unsigned long pulMag[NUM_TIMED], pulApprox[NUM_TIMED];
+    unsigned long long ullSquare;
+    unsigned long ulIdx, ulCount, ulExact, ulApprox;
+    double dExact, dErr;
+    long lX, lY;
+
+    *pdMaxApprox = 0.0;
+    ulCount = 0;
+    for(ulIdx = 0; ulIdx < g_ulCases + (513 * 513); ulIdx++)
+    {
+        //
+        // Every vector with components from -256 to 256, then random ones,
+        // including the most negative components.
+        //
+        if(ulIdx < (513 * 513))
+        {
+            lX = (long)(ulIdx % 513) - 256;
+            lY = (long)(ulIdx / 513) - 256;
+        }
+        else if((ulIdx & 1023) == 0)
+        {
+            lX = -2147483647L - 1;
+            lY = RandomComponent(31);
+        }
+        else
+        {
+            lX = RandomComponent(Random() & 31);
+            lY = RandomComponent(Random() & 31);
+        }
+
+        ullSquare = (((unsigned long long)(lX < 0 ? -lX : lX) *
+                      (unsigned long long)(lX < 0 ? -lX : lX)) +
+                     ((unsigned long long)(lY < 0 ? -lY : lY) *
+                      (unsigned long long)(lY < 0 ? -lY : lY)));
+        ulExact = imag(lX, lY);
+        CHECK(IsRoot(ullSquare, ulExact), "imag(%ld, %ld) = %lu\n", lX, lY,
+              ulExact);
+
+        ulApprox = imagapprox(lX, lY);
+        dExact = sqrt((double)ullSquare);
+        dErr = fabs((double)ulApprox - dExact);
+        CHECK(dErr <= ((dExact * APPROX_LIMIT) + APPROX_UNITS),
+              "imagapprox(%ld, %ld) = %lu, expected %.1f\n", lX, lY,
+              ulApprox, dExact);
+        if(dExact >= 65536.0)
+        {
+            *pdMaxApprox = fmax(*pdMaxApprox, dErr / dExact);
+        }
+
+        //
+        // Check the array forms a buffer at a time.
+        //
+        plX[ulCount] = lX;
+        plY[ulCount] = lY;
+        if(++ulCount == NUM_TIMED)
+        {
+            imagarray(pulMag, plX, plY, ulCount);
+            imagapproxarray(pulApprox, plX, plY, ulCount);
+            for(ulCount = 0; ulCount < NUM_TIMED; ulCount++)
+            {
+                CHECK((pulMag[ulCount] == imag(plX[ulCount], plY[ulCount])) &&
+                      (pulApprox[ulCount] ==
+                       imagapprox(plX[ulCount], plY[ulCount])),
+                      "imagarray(%ld, %ld) = %lu, %lu\n", plX[ulCount],
+                      plY[ulCount], pulMag[ulCount], pulApprox[ulCount]);
+            }
+            ulCount = 0;
+        }
+    }
+}
+
+//*****************************************************************************
+//
+// The type of a function that is timed.
+//
+//*****************************************************************************
+typedef unsigned long (*tTimedFunction)(unsigned long ulA, unsigned long ulB);
+
+//*****************************************************************************
+//
+// Times a set of functions over the same inputs, followed by the array form
+// of the first of them, and prints the time per call of each.
+//
+//*****************************************************************************
+static void
+TimeFunctions(const char *pcName, const tTimedFunction *ppfnFunc,
+              unsigned long ulNumFuncs, const unsigned long *pulA,
+              const unsigned long *pulB, BOOL bMagnitude)
+{
+    static unsigned long pulOut[NUM_TIMED];
+    unsigned long long ullNs, ullCycles;
+    unsigned long ulPass, ulIdx, ulFunc, ulSum;
+    double dCalls;
+
+    dCalls = (double)g_ulIterations * NUM_TIMED;
+    ulSum = 0;
+    QUIETPRINT("  %-12s", pcName);
+    for(ulFunc = 0; ulFunc <= ulNumFuncs; ulFunc++)
+    {
+        ullNs = Nanoseconds();
+        ullCycles = Cycles();
+        for(ulPass = 0; ulPass < g_ulIterations; ulPass++)
+        {
+            if(ulFunc < ulNumFuncs)
+            {
+                for(ulIdx = 0; ulIdx < NUM_TIMED; ulIdx++)
+                {
+                    ulSum += ppfnFunc[ulFunc](pulA[ulIdx], pulB[ulIdx]);
+                }
+            }
+            else if(bMagnitude)
+            {
+                imagarray(pulOut, (const long *)pulA, (const long *)pulB,
+                          NUM_TIMED);
+                ulSum += pulOut[ulPass & (NUM_TIMED - 1)];
+            }
+            else
+            {
+                isqrtarray(pulOut, pulA, NUM_TIMED);
+                ulSum += pulOut[ulPass & (NUM_TIMED - 1)];
+            }
+        }
+        ullCycles = Cycles() - ullCycles;
+        ullNs = Nanoseconds() - ullNs;
+
+        QUIETPRINT("  %6.1fns", (double)ullNs / dCalls);
+        if(ullCycles)
+        {
+            QUIETPRINT(" %6.1f", (double)ullCycles / dCalls);
+        }
+    }
+    QUIETPRINT("\n");
+    VERBOSEPRINT("(checksum %lu)\n", ulSum);
+}
+
+//*****************************************************************************
+//
+// Times the functions for small inputs, such as the distances of the LEDs of
+// a display from its center, and for inputs of any size.
+//
+//*****************************************************************************
+static void
+TimeAll(void)
+{
+    static const tTimedFunction ppfnRoot[] =
+    {
+        TimeIsqrt, TimeBitwise, TimeSqrt, TimeSqrtf
+    };
+    static const tTimedFunction ppfnMag[] =
+    {
+        TimeImag, TimeImagApprox, TimeHypot
+    };
+    static unsigned long pulA[NUM_TIMED], pulB[NUM_TIMED];
+    unsigned long ulIdx;
+
+    QUIETPRINT("\nTime per call%s:\n", Cycles() ? " (ns, cycles)" : "");
+    QUIETPRINT("  root          isqrt             bitwise           sqrt"
+               "              sqrtf             isqrtarray\n");
+    for(ulIdx = 0; ulIdx < NUM_TIMED; ulIdx++)
+    {
+        pulA[ulIdx] = Random() & 0x7ff;
+        pulB[ulIdx] = 0;
+    }
+    TimeFunctions("small", ppfnRoot, 4, pulA, pulB, FALSE);
+    for(ulIdx = 0; ulIdx < NUM_TIMED; ulIdx++)
+    {
+        pulA[ulIdx] = Random();
+    }
+    TimeFunctions("32-bit", ppfnRoot, 4, pulA, pulB, FALSE);
+
+    QUIETPRINT("  magnitude     imag              imagapprox        hypot"
+               "             imagarray\n");
+    for(ulIdx = 0; ulIdx < NUM_TIMED; ulIdx++)
+    {
+        pulA[ulIdx] = (unsigned long)RandomComponent(5);
+        pulB[ulIdx] = (unsigned long)RandomComponent(5);
+    }
+    TimeFunctions("small", ppfnMag, 3, pulA, pulB, TRUE);
+    for(ulIdx = 0; ulIdx < NUM_TIMED; ulIdx++)
+    {
+        pulA[ulIdx] = (unsigned long)RandomComponent(31);
+        pulB[ulIdx] = (unsigned long)RandomComponent(31);
+    }
+    TimeFunctions("32-bit", ppfnMag, 3, pulA, pulB, TRUE);
+}
+
+//*****************************************************************************
+//
+// The main entry point of the utility.
+//
+//*****************************************************************************
+int
+main(int argc, char *argv[])
+{
+    double dMaxApprox;
+
+    //
+    // Parse the command line.
+    //
+    if(!ParseCommandLine(argc, argv))
+    {
+        return(1);
+    }
+
+    //
+    // Check each function.
+    //
+    if(g_bExhaustive)
+    {
+        QUIETPRINT("Checking isqrt for every 32-bit input...\n");
+        CheckExhaustive();
+    }
+    QUIETPRINT("Checking isqrt64 and imag for %lu random inputs...\n",
+               g_ulCases);
+    CheckRoot64();
+    CheckMagnitude(&dMaxApprox);
+    QUIETPRINT("Largest error of imagapprox is %.3f%%.\n", dMaxApprox * 100);
+    QUIETPRINT("%lu checks failed.\n", g_ulFailed);
+
+    //
+    // Time each function.
+    //
+    if(g_ulIterations)
+    {
+        TimeAll();
+    }
+
+    return(g_ulFailed ? 1 : 0);
+}
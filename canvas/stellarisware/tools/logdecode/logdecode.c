@@ -0,0 +1,796 @@
+//*****************************************************************************
+//
+// logdecode.c - A command line utility that turns a log written by
+//               utils/binlog.c back into text, taking the format strings
+//               from the executable that wrote it.
+//
+//*****************************************************************************
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "utils/binlog.h"
+
+typedef unsigned char BOOL;
+#define FALSE 0
+#define TRUE  1
+
+//*****************************************************************************
+//
+// The size of the header at the start of each block.  This is fixed by the
+// block format, not by the size of the target's structures.
+//
+//*****************************************************************************
+#define HEADER_SIZE             24
+
+//*****************************************************************************
+//
+// The layout of the first word of a record, which holds the number of
+// arguments and the address of the format string.
+//
+//*****************************************************************************
+#define ARGS_S                  28
+#define FORMAT_M                0x0FFFFFFF
+
+//*****************************************************************************
+//
+// The parts of an ELF file that are used to find the strings.
+//
+//*****************************************************************************
+#define ELF_HEADER_SIZE         52
+#define ELF_SECTION_SIZE        40
+#define ELF_SHT_NOBITS          8
+#define ELF_SHF_ALLOC           2
+#define MAX_SECTIONS            64
+
+//*****************************************************************************
+//
+// Globals controlled by various command line parameters.
+//
+//*****************************************************************************
+BOOL g_bVerbose        = FALSE;
+BOOL g_bQuiet          = FALSE;
+BOOL g_bRaw            = FALSE;
+char *g_pszInput       = NULL;
+char *g_pszELF         = NULL;
+char *g_pszOutput      = NULL;
+
+//*****************************************************************************
+//
+// Helpful macros for generating output depending upon verbose and quiet flags.
+//
+//*****************************************************************************
+#define VERBOSEPRINT(...) if(g_bVerbose) { printf(__VA_ARGS__); }
+#define QUIETPRINT(...) if(!g_bQuiet) { printf(__VA_ARGS__); }
+
+//*****************************************************************************
+//
+// The sections of the executable that are loaded on the target and have
+// contents in the file, which are where the format strings are found.
+//
+//*****************************************************************************
+typedef struct
+{
+    unsigned long ulAddr;
+    unsigned long ulSize;
+    const unsigned char *pucData;
+}
+tSection;
+
+tSection g_psSections[MAX_SECTIONS];
+unsigned long g_ulNumSections;
+
+//*****************************************************************************
+//
+// The time of the last record, in cycles since the first, and the raw cycle
+// count it was taken from.
+//
+//*****************************************************************************
+unsigned long long g_ullNow;
+unsigned long g_ulLastStamp;
+BOOL g_bFirst = TRUE;
+
+//*****************************************************************************
+//
+// Counts of what was decoded.
+//
+//*****************************************************************************
+unsigned long g_ulBlocks;
+unsigned long g_ulMessages;
+unsigned long g_ulLost;
+unsigned long g_ulBad;
+
+//*****************************************************************************
+//
+// Reads little endian values from the log or the executable.
+//
+//*****************************************************************************
+static unsigned long
+Read16(const unsigned char *pucData)
+{
+    return(pucData[0] | (pucData[1] << 8));
+}
+
+static unsigned long
+Read32(const unsigned char *pucData)
+{
+    return(pucData[0] | (pucData[1] << 8) | (pucData[2] << 16) |
+           ((unsigned long)pucData[3] << 24));
+}
+
+//*****************************************************************************
+//
+// Print the welcome banner.
+//
+//*****************************************************************************
+void
+PrintWelcome(void)
+{
+    QUIETPRINT("\nlogdecode - Decode a deferred binary log.\n\n");
+}
+
+//*****************************************************************************
+//
+// Show help on the application command line parameters.
+//
+//*****************************************************************************
+void
+ShowHelp(void)
+{
+    //
+    // Only print help if we are not in quiet mode.
+    //
+    if(g_bQuiet)
+    {
+        return;
+    }
+
+    printf("This application decodes a log that was recorded by\n");
+    printf("utils/binlog.c and written out by BinLogDrain().  Each message\n");
+    printf("in the log holds the address of its format string rather than\n");
+    printf("the text, so the executable (.axf) that wrote the log must be\n");
+    printf("given too.  The input is searched for each block of the log, so\n");
+    printf("a capture of a UART that also carries other output can be given\n");
+    printf("as is.\n\n");
+    printf("Supported parameters are:\n\n");
+    printf("-i <file> - Decode the log in the given file.\n");
+    printf("-x <file> - Read the format strings from the given executable.\n");
+    printf("-o <file> - Write the messages to the given file rather than\n");
+    printf("            to stdout.\n");
+    printf("-r        - Show the address and arguments of each message.\n");
+    printf("-? or -h  - Show this help.\n");
+    printf("-q        - Quiet mode. Disable output to stdio.\n");
+    printf("-e        - Enable verbose output\n\n");
+    printf("Each message is prefixed with its time in seconds from the first\n");
+    printf("message.  The cycle counter wraps in under a minute, so gaps\n");
+    printf("longer than that between messages are not shown correctly.\n\n");
+    printf("Example:\n\n");
+    printf("   logdecode -i log.bin -x gcc/app.axf\n\n");
+}
+
+//*****************************************************************************
+//
+// Parse the command line, extracting all parameters.
+//
+// Returns 0 on failure, 1 on success.
+//
+//*****************************************************************************
+int
+ParseCommandLine(int argc, char *argv[])
+{
+    int iRetcode;
+    BOOL bShowHelp;
+
+    //
+    // By default, don't show the help screen.
+    //
+    bShowHelp = FALSE;
+
+    while(1)
+    {
+        //
+        // Get the next command line parameter.
+        //
+        iRetcode = getopt(argc, argv, "i:x:o:reh?q");
+
+        if(iRetcode == -1)
+        {
+            break;
+        }
+
+        switch(iRetcode)
+        {
+            case 'i':
+                g_pszInput = optarg;
+                break;
+
+            case 'x':
+                g_pszELF = optarg;
+                break;
+
+            case 'o':
+                g_pszOutput = optarg;
+                break;
+
+            case 'r':
+                g_bRaw = TRUE;
+                break;
+
+            case 'e':
+                g_bVerbose = TRUE;
+                break;
+
+            case 'q':
+                g_bQuiet = TRUE;
+                break;
+
+            case '?':
+            case 'h':
+                bShowHelp = TRUE;
+                break;
+        }
+    }
+
+    //
+    // Show the welcome banner unless we have been told to be quiet.
+    //
+    PrintWelcome();
+
+    //
+    // Catch various invalid parameter cases.
+    //
+    if(bShowHelp || !g_pszInput || !g_pszELF || (optind != argc))
+    {
+        ShowHelp();
+        return(0);
+    }
+
+    return(1);
+}
+
+//*****************************************************************************
+//
+// Reads the whole of a file into memory.
+//
+// Returns a pointer to the contents, which the caller frees, or NULL on
+// failure.
+//
+//*****************************************************************************
+static unsigned char *
+ReadFile(const char *pszFile, unsigned long *pulSize)
+{
+    unsigned char *pucData;
+    FILE *pfFile;
+    long lSize;
+
+    pfFile = fopen(pszFile, "rb");
+    if(!pfFile)
+    {
+        fprintf(stderr, "Can't open %s.\n", pszFile);
+        return(NULL);
+    }
+    fseek(pfFile, 0, SEEK_END);
+    lSize = ftell(pfFile);
+    fseek(pfFile, 0, SEEK_SET);
+    if(lSize <= 0)
+    {
+        fprintf(stderr, "%s is empty.\n", pszFile);
+        fclose(pfFile);
+        return(NULL);
+    }
+    *pulSize = lSize;
+    pucData = malloc(*pulSize);
+    if(!pucData || (fread(pucData, 1, *pulSize, pfFile) != *pulSize))
+    {
+        fprintf(stderr, "Can't read %s.\n", pszFile);
+        fclose(pfFile);
+        free(pucData);
+        return(NULL);
+    }
+    fclose(pfFile);
+
+    return(pucData);
+}
+
+//*****************************************************************************
+//
+// Finds the sections of a 32-bit little endian ELF file that are loaded on
+// the target and have contents in the file.
+//
+// Returns 0 on failure, 1 on success.
+//
+//*****************************************************************************
+static int
+ReadSections(const unsigned char *pucELF, unsigned long ulSize)
+{
+    unsigned long ulOffset, ulEntrySize, ulCount, ulIdx, ulType, ulData;
+    const unsigned char *pucSection;
+
+    if((ulSize < ELF_HEADER_SIZE) || memcmp(pucELF, "\177ELF", 4) ||
+       (pucELF[4] != 1) || (pucELF[5] != 1))
+    {
+        fprintf(stderr, "%s is not a 32-bit little endian ELF file.\n",
+                g_pszELF);
+        return(0);
+    }
+
+    ulOffset = Read32(pucELF + 32);
+    ulEntrySize = Read16(pucELF + 46);
+    ulCount = Read16(pucELF + 48);
+    if((ulEntrySize < ELF_SECTION_SIZE) ||
+       (ulOffset > ulSize) || (((ulSize - ulOffset) / ulEntrySize) < ulCount))
+    {
+        fprintf(stderr, "%s has no valid section table.\n", g_pszELF);
+        return(0);
+    }
+
+    for(ulIdx = 0; ulIdx < ulCount; ulIdx++)
+    {
+        pucSection = pucELF + ulOffset + (ulIdx * ulEntrySize);
+        ulType = Read32(pucSection + 4);
+        ulData = Read32(pucSection + 16);
+        if((ulType == ELF_SHT_NOBITS) ||
+           !(Read32(pucSection + 8) & ELF_SHF_ALLOC) ||
+           !Read32(pucSection + 20) || (ulData > ulSize) ||
+           (Read32(pucSection + 20) > (ulSize - ulData)))
+        {
+            continue;
+        }
+
+        if(g_ulNumSections == MAX_SECTIONS)
+        {
+            fprintf(stderr, "%s has too many sections.\n", g_pszELF);
+            return(0);
+        }
+
+        g_psSections[g_ulNumSections].ulAddr = Read32(pucSection + 12);
+        g_psSections[g_ulNumSections].ulSize = Read32(pucSection + 20);
+        g_psSections[g_ulNumSections].pucData = pucELF + ulData;
+        VERBOSEPRINT("Section at 0x%08lx, %lu bytes.\n",
+                     g_psSections[g_ulNumSections].ulAddr,
+                     g_psSections[g_ulNumSections].ulSize);
+        g_ulNumSections++;
+    }
+
+    return(1);
+}
+
+//*****************************************************************************
+//
+// Finds the string at an address on the target.
+//
+// Returns a pointer to the string, or NULL if the address is not in a loaded
+// section or the string runs off the end of it.
+//
+//*****************************************************************************
+static const char *
+TargetString(unsigned long ulAddr)
+{
+    unsigned long ulIdx, ulOffset;
+    tSection *psSection;
+
+    for(ulIdx = 0; ulIdx < g_ulNumSections; ulIdx++)
+    {
+        psSection = &g_psSections[ulIdx];
+        if((ulAddr < psSection->ulAddr) ||
+           ((ulAddr - psSection->ulAddr) >= psSection->ulSize))
+        {
+            continue;
+        }
+
+        ulOffset = ulAddr - psSection->ulAddr;
+        if(memchr(psSection->pucData + ulOffset, 0,
+                  psSection->ulSize - ulOffset))
+        {
+            return((const char *)psSection->pucData + ulOffset);
+        }
+    }
+
+    return(NULL);
+}
+
+//*****************************************************************************
+//
+// Writes a message, formatting its arguments as the target's format string
+// describes.  The flags, widths and precisions of printf are understood, as
+// are the conversions of UARTprintf; each argument is a 32-bit value, so
+// length modifiers are skipped.  A string argument is the address of a
+// string in the executable.
+//
+//*****************************************************************************
+static void
+PrintMessage(FILE *pfOut, const char *pcFormat, const unsigned long *pulArgs,
+             unsigned long ulNumArgs)
+{
+    char pcSpec[32];
+    unsigned long ulArg, ulLen;
+    const char *pcString;
+    int piStar[2], iStars;
+
+    ulArg = 0;
+    while(*pcFormat)
+    {
+        if(*pcFormat != '%')
+        {
+            fputc(*pcFormat++, pfOut);
+            continue;
+        }
+
+        //
+        // Copy the flags, width and precision into a format for the host,
+        // taking the value of each '*' from the arguments.
+        //
+        pcSpec[0] = *pcFormat++;
+        ulLen = 1;
+        iStars = 0;
+        while(*pcFormat && strchr("-+ #0123456789.*", *pcFormat) &&
+              (ulLen < (sizeof(pcSpec) - 3)))
+        {
+            if((*pcFormat == '*') && (iStars < 2))
+            {
+                piStar[iStars++] = (ulArg < ulNumArgs) ?
+                                   (int)pulArgs[ulArg] : 0;
+                ulArg++;
+            }
+            pcSpec[ulLen++] = *pcFormat++;
+        }
+        while((*pcFormat == 'l') || (*pcFormat == 'h'))
+        {
+            pcFormat++;
+        }
+
+        if(!*pcFormat)
+        {
+            break;
+        }
+
+        if(*pcFormat == '%')
+        {
+            fputc(*pcFormat++, pfOut);
+            continue;
+        }
+
+        if(!strchr("cdiuoxXps", *pcFormat))
+        {
+            fprintf(pfOut, "<bad format %%%c>", *pcFormat++);
+            continue;
+        }
+
+        if(ulArg >= ulNumArgs)
+        {
+            fprintf(pfOut, "<missing>");
+            pcFormat++;
+            continue;
+        }
+
+        //
+        // Print the argument with the host's printf.
+        //
+        switch(*pcFormat)
+        {
+            case 'd':
+            case 'i':
+            {
+                pcSpec[ulLen++] = 'l';
+                pcSpec[ulLen++] = *pcFormat;
+                pcSpec[ulLen] = 0;
+                if(iStars == 2)
+                {
+                    fprintf(pfOut, pcSpec, piStar[0], piStar[1],
+                            (long)(int)pulArgs[ulArg]);
+                }
+                else if(iStars == 1)
+                {
+                    fprintf(pfOut, pcSpec, piStar[0],
+                            (long)(int)pulArgs[ulArg]);
+                }
+                else
+                {
+                    fprintf(pfOut, pcSpec, (long)(int)pulArgs[ulArg]);
+                }
+                break;
+            }
+
+            case 'p':
+            {
+                fprintf(pfOut, "0x%08lx", pulArgs[ulArg]);
+                break;
+            }
+
+            case 's':
+            {
+                pcString = TargetString(pulArgs[ulArg]);
+                if(!pcString)
+                {
+                    fprintf(pfOut, "<string at 0x%08lx>", pulArgs[ulArg]);
+                    break;
+                }
+                pcSpec[ulLen++] = 's';
+                pcSpec[ulLen] = 0;
+                if(iStars == 2)
+                {
+                    fprintf(pfOut, pcSpec, piStar[0], piStar[1], pcString);
+                }
+                else if(iStars == 1)
+                {
+                    fprintf(pfOut, pcSpec, piStar[0], pcString);
+                }
+                else
+                {
+                    fprintf(pfOut, pcSpec, pcString);
+                }
+                break;
+            }
+
+            default:
+            {
+                if(*pcFormat == 'c')
+                {
+                    pcSpec[ulLen++] = 'c';
+                }
+                else
+                {
+                    pcSpec[ulLen++] = 'l';
+                    pcSpec[ulLen++] = *pcFormat;
+                }
+                pcSpec[ulLen] = 0;
+                if(iStars == 2)
+                {
+                    fprintf(pfOut, pcSpec, piStar[0], piStar[1],
+                            pulArgs[ulArg]);
+                }
+                else if(iStars == 1)
+                {
+                    fprintf(pfOut, pcSpec, piStar[0], pulArgs[ulArg]);
+                }
+                else
+                {
+                    fprintf(pfOut, pcSpec, pulArgs[ulArg]);
+                }
+                break;
+            }
+        }
+
+        ulArg++;
+        pcFormat++;
+    }
+}
+
+//*****************************************************************************
+//
+// Decodes the records of one block.  Each record is a word holding the
+// number of arguments and the address of the format string, a cycle count,
+// and then the arguments.
+//
+// Returns 0 if the block could not be decoded, 1 on success.
+//
+//*****************************************************************************
+static int
+DecodeBlock(FILE *pfOut, const unsigned char *pucBlock,
+            unsigned long ulClockRate)
+{
+    unsigned long ulWords, ulWord, ulNumArgs, ulIdx, ulStamp;
+    unsigned long pulArgs[BINLOG_MAX_ARGS];
+    const unsigned char *pucRecord;
+    const char *pcFormat;
+
+    if(Read32(pucBlock + 16))
+    {
+        fprintf(pfOut, "*** %lu messages lost ***\n", Read32(pucBlock + 16));
+        g_ulLost += Read32(pucBlock + 16);
+    }
+
+    ulWords = Read32(pucBlock + 20);
+    pucRecord = pucBlock + HEADER_SIZE;
+    ulWord = 0;
+    while(ulWord < ulWords)
+    {
+        ulNumArgs = Read32(pucRecord) >> ARGS_S;
+        if((ulNumArgs > BINLOG_MAX_ARGS) ||
+           ((ulWord + 2 + ulNumArgs) > ulWords))
+        {
+            fprintf(stderr, "Bad record in block %lu.\n", g_ulBlocks);
+            g_ulBad++;
+            return(0);
+        }
+
+        //
+        // Extend the cycle count to 64 bits.  The count is taken with
+        // interrupts masked as space is reserved, so records are in time
+        // order.
+        //
+        ulStamp = Read32(pucRecord + 4);
+        if(g_bFirst)
+        {
+            g_bFirst = FALSE;
+        }
+        else
+        {
+            g_ullNow += (unsigned long)((ulStamp - g_ulLastStamp) &
+                                        0xFFFFFFFF);
+        }
+        g_ulLastStamp = ulStamp;
+
+        for(ulIdx = 0; ulIdx < ulNumArgs; ulIdx++)
+        {
+            pulArgs[ulIdx] = Read32(pucRecord + 8 + (ulIdx * 4));
+        }
+
+        fprintf(pfOut, "[%12.6f] ", (double)g_ullNow / (double)ulClockRate);
+        pcFormat = TargetString(Read32(pucRecord) & FORMAT_M);
+        if(g_bRaw || !pcFormat)
+        {
+            fprintf(pfOut, "%s0x%08lx", pcFormat ? "" : "<unknown format> ",
+                    Read32(pucRecord) & FORMAT_M);
+            for(ulIdx = 0; ulIdx < ulNumArgs; ulIdx++)
+            {
+                fprintf(pfOut, " 0x%08lx", pulArgs[ulIdx]);
+            }
+            fputs(pcFormat ? ": " : "\n", pfOut);
+        }
+        if(pcFormat)
+        {
+            PrintMessage(pfOut, pcFormat, pulArgs, ulNumArgs);
+            ulIdx = strlen(pcFormat);
+            if(!ulIdx || (pcFormat[ulIdx - 1] != '\n'))
+            {
+                fputc('\n', pfOut);
+            }
+        }
+
+        g_ulMessages++;
+        ulWord += 2 + ulNumArgs;
+        pucRecord += (2 + ulNumArgs) * 4;
+    }
+
+    return(1);
+}
+
+//*****************************************************************************
+//
+// Finds and decodes every block in a capture.  A block is only taken as such
+// if its header is sane, its marker string is found in the executable, and
+// the whole block is present.
+//
+// Returns 0 on failure, 1 on success.
+//
+//*****************************************************************************
+static int
+DecodeLog(FILE *pfOut, const unsigned char *pucData, unsigned long ulSize)
+{
+    unsigned long ulOffset, ulLength, ulClockRate;
+    const char *pcMarker;
+
+    for(ulOffset = 0; (ulOffset + HEADER_SIZE) <= ulSize; ulOffset++)
+    {
+        if((Read32(pucData + ulOffset) != BINLOG_MAGIC) ||
+           (Read16(pucData + ulOffset + 4) != BINLOG_VERSION))
+        {
+            continue;
+        }
+
+        pcMarker = TargetString(Read32(pucData + ulOffset + 8));
+        if(!pcMarker || strcmp(pcMarker, "BinLog"))
+        {
+            fprintf(stderr, "The log at offset %lu was not written by %s.\n",
+                    ulOffset, g_pszELF);
+            return(0);
+        }
+
+        ulClockRate = Read32(pucData + ulOffset + 12);
+        ulLength = Read32(pucData + ulOffset + 20);
+        if(!ulClockRate || (ulLength > ((ulSize - ulOffset) / 4)) ||
+           ((HEADER_SIZE + (ulLength * 4)) > (ulSize - ulOffset)))
+        {
+            fprintf(stderr, "Ignoring truncated block at offset %lu.\n",
+                    ulOffset);
+            continue;
+        }
+
+        VERBOSEPRINT("Found block at offset %lu, %lu words.\n", ulOffset,
+                     ulLength);
+        g_ulBlocks++;
+        DecodeBlock(pfOut, pucData + ulOffset, ulClockRate);
+        ulOffset += HEADER_SIZE + (ulLength * 4) - 1;
+    }
+
+    return(1);
+}
+
+//*****************************************************************************
+//
+// The main entry point of the log decoder.
+//
+//*****************************************************************************
+int
+main(int argc, char *argv[])
+{
+    unsigned char *pucELF, *pucLog;
+    unsigned long ulELFSize, ulLogSize;
+    FILE *pfOut;
+    int iRet;
+
+    //
+    // Parse the command line.
+    //
+    if(!ParseCommandLine(argc, argv))
+    {
+        return(1);
+    }
+    fflush(stdout);
+
+    //
+    // Read the executable and the log.
+    //
+    pucELF = ReadFile(g_pszELF, &ulELFSize);
+    if(!pucELF)
+    {
+        return(1);
+    }
+    if(!ReadSections(pucELF, ulELFSize))
+    {
+        free(pucELF);
+        return(1);
+    }
+    pucLog = ReadFile(g_pszInput, &ulLogSize);
+    if(!pucLog)
+    {
+        free(pucELF);
+        return(1);
+    }
+
+    //
+    // Open the output.  Messages go to stdout even in quiet mode unless a
+    // file is given, since they are the point of the exercise.
+    //
+    pfOut = stdout;
+    if(g_pszOutput)
+    {
+        pfOut = fopen(g_pszOutput, "w");
+        if(!pfOut)
+        {
+            fprintf(stderr, "Can't create %s.\n", g_pszOutput);
+            free(pucLog);
+            free(pucELF);
+            return(1);
+        }
+    }
+
+    QUIETPRINT("Decoding %s with strings from %s\n", g_pszInput, g_pszELF);
+    fflush(stdout);
+    iRet = DecodeLog(pfOut, pucLog, ulLogSize);
+
+    if(g_pszOutput)
+    {
+        fclose(pfOut);
+    }
+    fflush(stdout);
+
+    if(iRet)
+    {
+        if(!g_ulBlocks)
+        {
+            fprintf(stderr, "No log found in %s.\n", g_pszInput);
+            iRet = 0;
+        }
+        else
+        {
+            QUIETPRINT("Decoded %lu messages in %lu blocks", g_ulMessages,
+                       g_ulBlocks);
+            if(g_ulLost)
+            {
+                QUIETPRINT(", %lu lost when the buffer filled", g_ulLost);
+            }
+            QUIETPRINT("\n");
+            if(g_ulBad)
+            {
+                QUIETPRINT("%lu blocks held bad records.\n", g_ulBad);
+            }
+        }
+    }
+
+    free(pucLog);
+    free(pucELF);
+    return(iRet ? 0 : 1);
+}
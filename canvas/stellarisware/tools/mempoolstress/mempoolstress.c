@@ -0,0 +1,907 @@
+//*****************************************************************************
+//
+// mempoolstress.c - A command line utility that builds the fixed-size block
+//                   pool allocator for the host and stresses it with random
+//                   interleaved allocations and frees, checking that no block
+//                   is ever handed out twice and that an exhausted pool fails
+//                   cleanly and recovers.
+//
+//*****************************************************************************
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#include <setjmp.h>
+#include <pthread.h>
+#include "inc/hw_types.h"
+#include "utils/mempool.h"
+
+typedef unsigned char BOOL;
+#define FALSE 0
+#define TRUE  1
+
+//*****************************************************************************
+//
+// The largest number of blocks and threads that may be requested.
+//
+//*****************************************************************************
+#define MAX_BLOCKS              4096
+#define MAX_THREADS             16
+
+//*****************************************************************************
+//
+// Globals controlled by various command line parameters.
+//
+//*****************************************************************************
+BOOL g_bVerbose               = FALSE;
+BOOL g_bQuiet                 = FALSE;
+unsigned long g_ulNumBlocks   = 64;
+unsigned long g_ulBlockSize   = 13;
+unsigned long g_ulIterations  = 1000000;
+unsigned long g_ulThreads     = 4;
+unsigned long g_ulSeed        = 1;
+
+//*****************************************************************************
+//
+// Helpful macros for generating output depending upon verbose and quiet flags.
+//
+//*****************************************************************************
+#define VERBOSEPRINT(...) if(g_bVerbose) { printf(__VA_ARGS__); }
+#define QUIETPRINT(...) if(!g_bQuiet) { printf(__VA_ARGS__); }
+
+//*****************************************************************************
+//
+// Counts a check and reports it if it fails.
+//
+//*****************************************************************************
+static unsigned long g_ulFailed = 0;
+
+#define CHECK(bCond, ...)                                                     \
+    if(!(bCond))                                                              \
+    {                                                                         \
+        g_ulFailed++;                                                         \
+        QUIETPRINT("FAIL: " __VA_ARGS__);                                     \
+    }
+
+//*****************************************************************************
+//
+// The pool under test and its storage.  The storage is sized for the largest
+// pool that may be requested.
+//
+//*****************************************************************************
+static tMemPool g_sPool;
+static unsigned long *g_pulStorage;
+
+//*****************************************************************************
+//
+// The owner of each block as seen by this application, which is 0 for a free
+// block, or one more than the number of the thread holding it.
+//
+//*****************************************************************************
+static volatile unsigned long g_pulOwner[MAX_BLOCKS];
+
+//*****************************************************************************
+//
+// The state used to turn an assertion in the pool into a result.  When an
+// assertion is expected, __error__() returns to the point saved here rather
+// than letting the pool carry on with a bad argument.
+//
+//*****************************************************************************
+static jmp_buf g_sAssertJump;
+static BOOL g_bAssertExpected = FALSE;
+
+//*****************************************************************************
+//
+// The handler for assertions in the pool, which is built with DEBUG defined.
+//
+//*****************************************************************************
+void
+__error__(char *pcFilename, unsigned long ulLine)
+{
+    if(g_bAssertExpected)
+    {
+        g_bAssertExpected = FALSE;
+        longjmp(g_sAssertJump, 1);
+    }
+
+    //
+    // An unexpected assertion leaves the pool in an unknown state, so there
+    // is no point in continuing.
+    //
+    fflush(stdout);
+    fprintf(stderr, "FAIL: Unexpected assertion at %s:%lu.\n", pcFilename,
+            ulLine);
+    exit(1);
+}
+
+//*****************************************************************************
+//
+// Returns a pseudo-random number from the given xorshift state.
+//
+//*****************************************************************************
+static unsigned long
+Random(unsigned long *pulState)
+{
+    *pulState ^= (*pulState << 13) & 0xffffffff;
+    *pulState ^= *pulState >> 17;
+    *pulState ^= (*pulState << 5) & 0xffffffff;
+
+    return(*pulState);
+}
+
+//*****************************************************************************
+//
+// Returns the current time in nanoseconds.
+//
+//*****************************************************************************
+static unsigned long long
+Nanoseconds(void)
+{
+    struct timespec sTime;
+
+    clock_gettime(CLOCK_MONOTONIC, &sTime);
+
+    return(((unsigned long long)sTime.tv_sec * 1000000000ULL) +
+           sTime.tv_nsec);
+}
+
+//*****************************************************************************
+//
+// Returns the index of a block given a pointer returned by MemPoolAlloc().
+//
+//*****************************************************************************
+static unsigned long
+BlockIndex(void *pvBlock)
+{
+    return(((unsigned char *)pvBlock - (unsigned char *)g_pulStorage) /
+           MEMPOOL_BLOCK_STRIDE(g_ulBlockSize));
+}
+
+//*****************************************************************************
+//
+// Fills a block with a pattern that depends on its owner, and checks that
+// the pattern is still there.  A block handed to two owners at once is caught
+// by the pattern of one being overwritten by the other.
+//
+//*****************************************************************************
+static void
+BlockFill(void *pvBlock, unsigned long ulOwner)
+{
+    memset(pvBlock, (int)(0x40 + ulOwner), g_ulBlockSize);
+}
+
+static BOOL
+BlockIntact(void *pvBlock, unsigned long ulOwner)
+{
+    unsigned char *pucByte;
+    unsigned long ulLoop;
+
+    pucByte = pvBlock;
+    for(ulLoop = 0; ulLoop < g_ulBlockSize; ulLoop++)
+    {
+        if(pucByte[ulLoop] != (unsigned char)(0x40 + ulOwner))
+        {
+            return(FALSE);
+        }
+    }
+
+    return(TRUE);
+}
+
+//*****************************************************************************
+//
+// Initializes the pool under test.
+//
+//*****************************************************************************
+static void
+PoolInit(void)
+{
+    memset((void *)g_pulOwner, 0, sizeof(g_pulOwner));
+    MemPoolInit(&g_sPool, g_pulStorage,
+                MEMPOOL_STORAGE_SIZE(g_ulBlockSize, g_ulNumBlocks),
+                g_ulBlockSize, g_ulNumBlocks);
+}
+
+//*****************************************************************************
+//
+// Allocates every block, checks that the next allocation fails, and checks
+// that a freed block can be allocated again.
+//
+//*****************************************************************************
+static void
+CheckExhaustion(void)
+{
+    void **ppvBlocks;
+    void *pvBlock;
+    unsigned long ulLoop, ulIndex;
+    tMemPoolStats sStats;
+
+    PoolInit();
+
+    ppvBlocks = malloc(g_ulNumBlocks * sizeof(void *));
+    if(!ppvBlocks)
+    {
+        fflush(stdout);
+        fprintf(stderr, "Out of memory.\n");
+        exit(1);
+    }
+
+    //
+    // Take every block, checking that each is a distinct block of the pool.
+    //
+    for(ulLoop = 0; ulLoop < g_ulNumBlocks; ulLoop++)
+    {
+        ppvBlocks[ulLoop] = MemPoolAlloc(&g_sPool);
+        if(!ppvBlocks[ulLoop])
+        {
+            CHECK(0, "Allocation %lu of %lu failed.\n", ulLoop + 1,
+                  g_ulNumBlocks);
+            break;
+        }
+        CHECK(MemPoolContains(&g_sPool, ppvBlocks[ulLoop]),
+              "Allocation %lu is not a block of the pool.\n", ulLoop + 1);
+        ulIndex = BlockIndex(ppvBlocks[ulLoop]);
+        CHECK(!g_pulOwner[ulIndex], "Block %lu was allocated twice.\n",
+              ulIndex);
+        g_pulOwner[ulIndex] = 1;
+        CHECK(((unsigned long)ppvBlocks[ulLoop] & 3) == 0,
+              "Block %lu is not word aligned.\n", ulIndex);
+        BlockFill(ppvBlocks[ulLoop], 1);
+    }
+
+    //
+    // The pool is now empty, so further allocations must fail without
+    // changing the blocks in use.
+    //
+    for(ulLoop = 0; ulLoop < 3; ulLoop++)
+    {
+        pvBlock = MemPoolAlloc(&g_sPool);
+        CHECK(pvBlock == 0, "Allocation from an exhausted pool returned "
+              "block %lu.\n", BlockIndex(pvBlock));
+    }
+    MemPoolStatsGet(&g_sPool, &sStats);
+    CHECK(sStats.ulInUse == g_ulNumBlocks, "%lu blocks in use when "
+          "exhausted, expected %lu.\n", sStats.ulInUse, g_ulNumBlocks);
+    CHECK(sStats.ulHighWater == g_ulNumBlocks, "High water %lu when "
+          "exhausted, expected %lu.\n", sStats.ulHighWater, g_ulNumBlocks);
+    CHECK(sStats.ulAllocs == g_ulNumBlocks, "%lu allocations counted, "
+          "expected %lu.\n", sStats.ulAllocs, g_ulNumBlocks);
+    CHECK(sStats.ulFailures == 3, "%lu failures counted, expected 3.\n",
+          sStats.ulFailures);
+    CHECK(MemPoolCheck(&g_sPool) == 0, "Guards damaged in a full pool.\n");
+
+    //
+    // A freed block must be the next one allocated, and the pool must be
+    // exhausted again afterwards.
+    //
+    ulIndex = g_ulNumBlocks / 2;
+    CHECK(BlockIntact(ppvBlocks[ulIndex], 1), "Block %lu was changed while "
+          "allocated.\n", BlockIndex(ppvBlocks[ulIndex]));
+    MemPoolFree(&g_sPool, ppvBlocks[ulIndex]);
+    pvBlock = MemPoolAlloc(&g_sPool);
+    CHECK(pvBlock == ppvBlocks[ulIndex], "A freed block was not reused.\n");
+    CHECK(MemPoolAlloc(&g_sPool) == 0, "Pool not exhausted after reusing a "
+          "block.\n");
+
+    //
+    // Free everything and take it all again.
+    //
+    for(ulLoop = 0; ulLoop < g_ulNumBlocks; ulLoop++)
+    {
+        CHECK(BlockIntact(ppvBlocks[ulLoop], 1), "Block %lu was changed while "
+              "allocated.\n", BlockIndex(ppvBlocks[ulLoop]));
+        MemPoolFree(&g_sPool, ppvBlocks[ulLoop]);
+        g_pulOwner[BlockIndex(ppvBlocks[ulLoop])] = 0;
+    }
+    MemPoolStatsGet(&g_sPool, &sStats);
+    CHECK(sStats.ulInUse == 0, "%lu blocks in use after freeing all.\n",
+          sStats.ulInUse);
+    MemPoolHighWaterReset(&g_sPool);
+    MemPoolStatsGet(&g_sPool, &sStats);
+    CHECK(sStats.ulHighWater == 0, "High water %lu after reset.\n",
+          sStats.ulHighWater);
+    for(ulLoop = 0; ulLoop < g_ulNumBlocks; ulLoop++)
+    {
+        pvBlock = MemPoolAlloc(&g_sPool);
+        CHECK(pvBlock != 0, "Allocation %lu failed after freeing all.\n",
+              ulLoop + 1);
+        if(pvBlock)
+        {
+            ulIndex = BlockIndex(pvBlock);
+            CHECK(!g_pulOwner[ulIndex], "Block %lu was allocated twice after "
+                  "freeing all.\n", ulIndex);
+            g_pulOwner[ulIndex] = 1;
+        }
+    }
+    CHECK(MemPoolAlloc(&g_sPool) == 0, "Pool not exhausted after freeing "
+          "all.\n");
+
+    free(ppvBlocks);
+
+    QUIETPRINT("Exhaustion:          %lu blocks of %lu bytes, stride %lu "
+               "bytes.\n", g_ulNumBlocks, g_ulBlockSize,
+               (unsigned long)MEMPOOL_BLOCK_STRIDE(g_ulBlockSize));
+}
+
+//*****************************************************************************
+//
+// Checks that the pool catches a block freed twice, a pointer that is not a
+// block, and a write beyond the end of a block.
+//
+//*****************************************************************************
+static void
+CheckMisuse(void)
+{
+    unsigned char *pucBlock;
+    volatile BOOL bCaught;
+    tMemPoolStats sStats;
+
+    PoolInit();
+
+    //
+    // Free a block twice.  The assertion must come before the free list is
+    // changed, so the pool must still hand out every block exactly once.
+    //
+    pucBlock = MemPoolAlloc(&g_sPool);
+    MemPoolFree(&g_sPool, pucBlock);
+    bCaught = FALSE;
+    g_bAssertExpected = TRUE;
+    if(setjmp(g_sAssertJump) == 0)
+    {
+        MemPoolFree(&g_sPool, pucBlock);
+    }
+    else
+    {
+        bCaught = TRUE;
+    }
+    g_bAssertExpected = FALSE;
+    CHECK(bCaught, "A block freed twice was not caught.\n");
+
+    //
+    // Free a pointer into the middle of a block.
+    //
+    pucBlock = MemPoolAlloc(&g_sPool);
+    bCaught = FALSE;
+    g_bAssertExpected = TRUE;
+    if(setjmp(g_sAssertJump) == 0)
+    {
+        MemPoolFree(&g_sPool, pucBlock + 1);
+    }
+    else
+    {
+        bCaught = TRUE;
+    }
+    g_bAssertExpected = FALSE;
+    CHECK(bCaught, "A pointer into a block was freed.\n");
+
+    //
+    // Write one byte beyond the end of the block.  The check and the free
+    // must both find it.
+    //
+    pucBlock[g_ulBlockSize] ^= 0xff;
+    CHECK(MemPoolCheck(&g_sPool) == 1, "An overrun was not found by "
+          "MemPoolCheck().\n");
+    bCaught = FALSE;
+    g_bAssertExpected = TRUE;
+    if(setjmp(g_sAssertJump) == 0)
+    {
+        MemPoolFree(&g_sPool, pucBlock);
+    }
+    else
+    {
+        bCaught = TRUE;
+    }
+    g_bAssertExpected = FALSE;
+    MemPoolStatsGet(&g_sPool, &sStats);
+    CHECK(bCaught && (sStats.ulGuardErrors == 1), "An overrun was not caught "
+          "when freed.\n");
+
+    QUIETPRINT("Misuse:              double free, bad pointer and overrun "
+               "checked.\n");
+}
+
+//*****************************************************************************
+//
+// Allocates and frees blocks in a random order from a single thread,
+// checking every result against the application's own record of the blocks
+// in use.  The proportion of allocations drifts between mostly allocating
+// and mostly freeing so that the pool is taken to exhaustion and back to
+// empty repeatedly.
+//
+//*****************************************************************************
+static void
+CheckRandom(void)
+{
+    void **ppvHeld;
+    void *pvBlock;
+    unsigned long ulHeld, ulMaxHeld, ulLoop, ulIndex, ulState, ulExhausted;
+    unsigned long ulEmptied;
+    unsigned long long ullStart, ullElapsed;
+    BOOL bFilling;
+    tMemPoolStats sStats;
+
+    PoolInit();
+
+    ppvHeld = malloc(g_ulNumBlocks * sizeof(void *));
+    if(!ppvHeld)
+    {
+        fflush(stdout);
+        fprintf(stderr, "Out of memory.\n");
+        exit(1);
+    }
+
+    ulState = g_ulSeed;
+    ulHeld = 0;
+    ulMaxHeld = 0;
+    ulExhausted = 0;
+    ulEmptied = 0;
+    bFilling = TRUE;
+    ullStart = Nanoseconds();
+
+    for(ulLoop = 0; ulLoop < g_ulIterations; ulLoop++)
+    {
+        //
+        // Allocate three times in four while filling, and once in four while
+        // draining.
+        //
+        if(((Random(&ulState) & 3) != 0) == bFilling)
+        {
+            pvBlock = MemPoolAlloc(&g_sPool);
+            if(ulHeld == g_ulNumBlocks)
+            {
+                CHECK(pvBlock == 0, "Iteration %lu: allocation succeeded "
+                      "with every block in use.\n", ulLoop);
+                ulExhausted++;
+                bFilling = FALSE;
+                continue;
+            }
+            if(!pvBlock)
+            {
+                CHECK(0, "Iteration %lu: allocation failed with %lu of %lu "
+                      "blocks in use.\n", ulLoop, ulHeld, g_ulNumBlocks);
+                continue;
+            }
+            ulIndex = BlockIndex(pvBlock);
+            if(!MemPoolContains(&g_sPool, pvBlock) || g_pulOwner[ulIndex])
+            {
+                CHECK(0, "Iteration %lu: block %lu allocated twice.\n",
+                      ulLoop, ulIndex);
+                continue;
+            }
+            g_pulOwner[ulIndex] = 1;
+            BlockFill(pvBlock, ulIndex & 0x3f);
+            ppvHeld[ulHeld++] = pvBlock;
+            if(ulHeld > ulMaxHeld)
+            {
+                ulMaxHeld = ulHeld;
+            }
+        }
+        else
+        {
+            if(ulHeld == 0)
+            {
+                ulEmptied++;
+                bFilling = TRUE;
+                continue;
+            }
+
+            //
+            // Free a random one of the blocks held, so that the free list is
+            // returned to in an order unrelated to the order of allocation.
+            //
+            ulIndex = Random(&ulState) % ulHeld;
+            pvBlock = ppvHeld[ulIndex];
+            ppvHeld[ulIndex] = ppvHeld[--ulHeld];
+            CHECK(BlockIntact(pvBlock, BlockIndex(pvBlock) & 0x3f),
+                  "Iteration %lu: block %lu was changed while allocated.\n",
+                  ulLoop, BlockIndex(pvBlock));
+            g_pulOwner[BlockIndex(pvBlock)] = 0;
+            MemPoolFree(&g_sPool, pvBlock);
+        }
+
+        //
+        // Occasionally check the pool's own view of itself.
+        //
+        if((ulLoop & 0xfff) == 0)
+        {
+            MemPoolStatsGet(&g_sPool, &sStats);
+            CHECK(sStats.ulInUse == ulHeld, "Iteration %lu: %lu blocks in "
+                  "use, expected %lu.\n", ulLoop, sStats.ulInUse, ulHeld);
+            CHECK(MemPoolCheck(&g_sPool) == 0, "Iteration %lu: guards "
+                  "damaged.\n", ulLoop);
+        }
+    }
+
+    ullElapsed = Nanoseconds() - ullStart;
+
+    MemPoolStatsGet(&g_sPool, &sStats);
+    CHECK(sStats.ulInUse == ulHeld, "%lu blocks in use at the end, expected "
+          "%lu.\n", sStats.ulInUse, ulHeld);
+    CHECK(sStats.ulHighWater == ulMaxHeld, "High water %lu, expected %lu.\n",
+          sStats.ulHighWater, ulMaxHeld);
+    CHECK(sStats.ulFailures == ulExhausted, "%lu failures counted, expected "
+          "%lu.\n", sStats.ulFailures, ulExhausted);
+    CHECK((g_ulIterations < 16 * g_ulNumBlocks) || (ulExhausted && ulEmptied),
+          "The pool was never taken to both exhaustion and empty.\n");
+
+    free(ppvHeld);
+
+    QUIETPRINT("Random, 1 thread:    %lu operations, exhausted %lu times, "
+               "emptied %lu times, %.1f ns per operation.\n", g_ulIterations,
+               ulExhausted, ulEmptied,
+               (double)ullElapsed / (double)g_ulIterations);
+}
+
+//*****************************************************************************
+//
+// The state of each thread in the threaded stress test.
+//
+//*****************************************************************************
+typedef struct
+{
+    pthread_t sThread;
+    unsigned long ulNumber;
+    unsigned long ulAllocs;
+    unsigned long ulFailures;
+    unsigned long ulErrors;
+}
+tThreadState;
+
+static volatile BOOL g_bGo = FALSE;
+
+//*****************************************************************************
+//
+// Allocates and frees blocks at random alongside the other threads.  Each
+// block taken is claimed in the record of owners with a compare and swap, so
+// a block handed to two threads at once is caught even if its contents are
+// not yet overwritten.
+//
+//*****************************************************************************
+static void *
+StressThread(void *pvArg)
+{
+    tThreadState *psState;
+    void *ppvHeld[MAX_BLOCKS];
+    void *pvBlock;
+    unsigned long ulHeld, ulMaxHeld, ulLoop, ulIndex, ulState, ulOwner;
+    unsigned long ulIterations;
+
+    psState = pvArg;
+    ulOwner = psState->ulNumber + 1;
+    ulState = (g_ulSeed + (psState->ulNumber * 0x9e3779b9)) & 0xffffffff;
+    ulState = ulState ? ulState : 1;
+    ulIterations = g_ulIterations / g_ulThreads;
+    ulHeld = 0;
+
+    //
+    // Each thread holds at most twice its share of the pool, so that the
+    // threads between them still exhaust it, but a thread that is preempted
+    // while holding blocks does not starve the others.
+    //
+    ulMaxHeld = (2 * g_ulNumBlocks) / g_ulThreads;
+    ulMaxHeld = ulMaxHeld ? ulMaxHeld : 1;
+
+    while(!g_bGo)
+    {
+    }
+
+    for(ulLoop = 0; ulLoop < ulIterations; ulLoop++)
+    {
+        if(((Random(&ulState) & 1) || !ulHeld) && (ulHeld < ulMaxHeld))
+        {
+            pvBlock = MemPoolAlloc(&g_sPool);
+            if(!pvBlock)
+            {
+                psState->ulFailures++;
+                continue;
+            }
+            psState->ulAllocs++;
+            ulIndex = BlockIndex(pvBlock);
+            if(!__sync_bool_compare_and_swap(&g_pulOwner[ulIndex], 0,
+                                             ulOwner))
+            {
+                psState->ulErrors++;
+                continue;
+            }
+            BlockFill(pvBlock, ulOwner);
+            ppvHeld[ulHeld++] = pvBlock;
+        }
+        else
+        {
+            ulIndex = Random(&ulState) % ulHeld;
+            pvBlock = ppvHeld[ulIndex];
+            ppvHeld[ulIndex] = ppvHeld[--ulHeld];
+            if(!BlockIntact(pvBlock, ulOwner) ||
+               !__sync_bool_compare_and_swap(&g_pulOwner[BlockIndex(pvBlock)],
+                                             ulOwner, 0))
+            {
+                psState->ulErrors++;
+            }
+            MemPoolFree(&g_sPool, pvBlock);
+        }
+    }
+
+    //
+    // Return everything that is still held.
+    //
+    while(ulHeld)
+    {
+        pvBlock = ppvHeld[--ulHeld];
+        if(!BlockIntact(pvBlock, ulOwner) ||
+           !__sync_bool_compare_and_swap(&g_pulOwner[BlockIndex(pvBlock)],
+                                         ulOwner, 0))
+        {
+            psState->ulErrors++;
+        }
+        MemPoolFree(&g_sPool, pvBlock);
+    }
+
+    return(0);
+}
+
+//*****************************************************************************
+//
+// Allocates and frees blocks in a random order from several threads at once,
+// standing in for tasks and interrupt handlers sharing a pool on the target.
+// With fewer blocks than the threads would like to hold, the pool is
+// exhausted throughout.
+//
+//*****************************************************************************
+static void
+CheckThreads(void)
+{
+    tThreadState psThreads[MAX_THREADS];
+    unsigned long ulLoop, ulAllocs, ulFailures, ulErrors;
+    unsigned long long ullStart, ullElapsed;
+    tMemPoolStats sStats;
+
+    PoolInit();
+
+    g_bGo = FALSE;
+    for(ulLoop = 0; ulLoop < g_ulThreads; ulLoop++)
+    {
+        memset(&psThreads[ulLoop], 0, sizeof(tThreadState));
+        psThreads[ulLoop].ulNumber = ulLoop;
+        if(pthread_create(&psThreads[ulLoop].sThread, NULL, StressThread,
+                          &psThreads[ulLoop]))
+        {
+            fflush(stdout);
+            fprintf(stderr, "Failed to start a stress thread.\n");
+            exit(1);
+        }
+    }
+
+    ullStart = Nanoseconds();
+    g_bGo = TRUE;
+
+    ulAllocs = 0;
+    ulFailures = 0;
+    ulErrors = 0;
+    for(ulLoop = 0; ulLoop < g_ulThreads; ulLoop++)
+    {
+        pthread_join(psThreads[ulLoop].sThread, NULL);
+        ulAllocs += psThreads[ulLoop].ulAllocs;
+        ulFailures += psThreads[ulLoop].ulFailures;
+        ulErrors += psThreads[ulLoop].ulErrors;
+        VERBOSEPRINT("  Thread %lu: %lu allocations, %lu failures, %lu "
+                     "errors.\n", ulLoop, psThreads[ulLoop].ulAllocs,
+                     psThreads[ulLoop].ulFailures,
+                     psThreads[ulLoop].ulErrors);
+    }
+
+    ullElapsed = Nanoseconds() - ullStart;
+
+    CHECK(ulErrors == 0, "%lu blocks were allocated twice or changed while "
+          "allocated.\n", ulErrors);
+
+    //
+    // Every thread returned every block, so the pool must be whole again.
+    //
+    MemPoolStatsGet(&g_sPool, &sStats);
+    CHECK(sStats.ulInUse == 0, "%lu blocks in use after the threads "
+          "finished.\n", sStats.ulInUse);
+    CHECK(sStats.ulHighWater <= g_ulNumBlocks, "High water %lu exceeds the "
+          "%lu blocks of the pool.\n", sStats.ulHighWater, g_ulNumBlocks);
+    CHECK(sStats.ulAllocs == ulAllocs, "%lu allocations counted, expected "
+          "%lu.\n", sStats.ulAllocs, ulAllocs);
+    CHECK(sStats.ulFailures == ulFailures, "%lu failures counted, expected "
+          "%lu.\n", sStats.ulFailures, ulFailures);
+    for(ulLoop = 0; ulLoop < g_ulNumBlocks; ulLoop++)
+    {
+        if(!MemPoolAlloc(&g_sPool))
+        {
+            break;
+        }
+    }
+    CHECK((ulLoop == g_ulNumBlocks) && !MemPoolAlloc(&g_sPool), "%lu blocks "
+          "could be allocated after the threads finished, expected %lu.\n",
+          ulLoop, g_ulNumBlocks);
+
+    QUIETPRINT("Random, %lu threads:   %lu allocations, %lu failed on an "
+               "exhausted pool, %.1f ns per operation.\n", g_ulThreads,
+               ulAllocs, ulFailures,
+               (double)ullElapsed /
+               (double)((g_ulIterations / g_ulThreads) * g_ulThreads));
+}
+
+//*****************************************************************************
+//
+// Show the startup banner.
+//
+//*****************************************************************************
+void
+PrintWelcome(void)
+{
+    QUIETPRINT("\nmempoolstress - Stress the fixed-size block pool.\n\n");
+}
+
+//*****************************************************************************
+//
+// Show help on the application's command line parameters.
+//
+//*****************************************************************************
+void
+ShowHelp(void)
+{
+    //
+    // Only print help if we are not in quiet mode.
+    //
+    if(g_bQuiet)
+    {
+        return;
+    }
+
+    printf("This application builds utils/mempool.c for the host, with\n");
+    printf("assertions and guards enabled, and checks that a pool:\n\n");
+    printf("- hands out every block exactly once before failing, counts the\n");
+    printf("  failures, and recovers when blocks are freed;\n");
+    printf("- catches a block freed twice, a pointer that is not a block,\n");
+    printf("  and a write beyond the end of a block;\n");
+    printf("- never hands out a block that is already in use, or loses\n");
+    printf("  one, under random interleaved allocations and frees from one\n");
+    printf("  thread and then from several threads at once.  On a single\n");
+    printf("  processor the threads only interleave when one is preempted.\n\n");
+    printf("Supported parameters are:\n\n");
+    printf("-n <num>  - Use a pool of the given number of blocks (default\n");
+    printf("            64).\n");
+    printf("-s <num>  - Use blocks of the given number of bytes (default\n");
+    printf("            13).\n");
+    printf("-i <num>  - Perform the given number of random operations\n");
+    printf("            (default 1000000).\n");
+    printf("-j <num>  - Use the given number of threads, up to %d, or none\n",
+           MAX_THREADS);
+    printf("            if 0 (default 4).\n");
+    printf("-r <num>  - Seed the operations with the given number (default\n");
+    printf("            1).\n");
+    printf("-? or -h  - Show this help.\n");
+    printf("-q        - Quiet mode. Disable output to stdio.\n");
+    printf("-e        - Enable verbose output.\n\n");
+    printf("Example:\n\n");
+    printf("   mempoolstress -n 8 -j 8\n\n");
+}
+
+//*****************************************************************************
+//
+// Parse the command line, extracting all parameters.
+//
+// Returns 0 on failure, 1 on success.
+//
+//*****************************************************************************
+int
+ParseCommandLine(int argc, char *argv[])
+{
+    int iRetcode;
+    BOOL bShowHelp;
+
+    //
+    // By default, don't show the help screen.
+    //
+    bShowHelp = FALSE;
+
+    while(1)
+    {
+        //
+        // Get the next command line parameter.
+        //
+        iRetcode = getopt(argc, argv, "n:s:i:j:r:eh?q");
+
+        if(iRetcode == -1)
+        {
+            break;
+        }
+
+        switch(iRetcode)
+        {
+            case 'n':
+                g_ulNumBlocks = strtoul(optarg, NULL, 0);
+                break;
+
+            case 's':
+                g_ulBlockSize = strtoul(optarg, NULL, 0);
+                break;
+
+            case 'i':
+                g_ulIterations = strtoul(optarg, NULL, 0);
+                break;
+
+            case 'j':
+                g_ulThreads = strtoul(optarg, NULL, 0);
+                break;
+
+            case 'r':
+                g_ulSeed = strtoul(optarg, NULL, 0) & 0xffffffff;
+                break;
+
+            case 'e':
+                g_bVerbose = TRUE;
+                break;
+
+            case 'q':
+                g_bQuiet = TRUE;
+                break;
+
+            case '?':
+            case 'h':
+                bShowHelp = TRUE;
+                break;
+        }
+    }
+
+    //
+    // Show the welcome banner unless we have been told to be quiet.
+    //
+    PrintWelcome();
+
+    //
+    // Catch various invalid parameter cases.
+    //
+    if(bShowHelp || (g_ulSeed == 0) || (g_ulNumBlocks == 0) ||
+       (g_ulNumBlocks > MAX_BLOCKS) || (g_ulBlockSize == 0) ||
+       (g_ulBlockSize > 1024) || (g_ulThreads > MAX_THREADS) ||
+       (optind != argc))
+    {
+        ShowHelp();
+        return(0);
+    }
+
+    return(1);
+}
+
+//*****************************************************************************
+//
+// The main entry point of the application.
+//
+//*****************************************************************************
+int
+main(int argc, char *argv[])
+{
+    if(!ParseCommandLine(argc, argv))
+    {
+        return(1);
+    }
+
+    g_pulStorage = malloc(MEMPOOL_STORAGE_SIZE(g_ulBlockSize, g_ulNumBlocks));
+    if(!g_pulStorage)
+    {
+        fflush(stdout);
+        fprintf(stderr, "Out of memory.\n");
+        return(1);
+    }
+
+    CheckExhaustion();
+    CheckMisuse();
+    CheckRandom();
+    if(g_ulThreads)
+    {
+        CheckThreads();
+    }
+
+    free(g_pulStorage);
+
+    QUIETPRINT("\n%s: %lu checks failed.\n", g_ulFailed ? "FAILED" : "PASSED",
+               g_ulFailed);
+
+    return(g_ulFailed ? 1 : 0);
+}
@@ -0,0 +1,739 @@
+//*****************************************************************************
+//
+// mscsim.c - A command line utility that builds the USB host mass storage
+//            class driver for the host, attaches it to a simulated mass
+//            storage device held in memory, and checks the block cache and
+//            read-ahead of USBHMSCBlockRead() against a reference copy of the
+//            device's blocks.
+//
+//*****************************************************************************
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "inc/hw_types.h"
+#include "usblib/usblib.h"
+#include "usblib/usbmsc.h"
+#include "usblib/host/usbhost.h"
+#include "usblib/host/usbhmsc.h"
+#include "usblib/host/usbhscsi.h"
+
+typedef unsigned char BOOL;
+#define FALSE 0
+#define TRUE  1
+
+//*****************************************************************************
+//
+// The size of a block on the simulated device.
+//
+//*****************************************************************************
+#define BLOCK_SIZE              512
+
+//*****************************************************************************
+//
+// The interface subclass and protocol of a SCSI bulk only transport device.
+//
+//*****************************************************************************
+#define USB_MSC_SUBCLASS_SCSI   0x6
+#define USB_MSC_PROTO_BULKONLY  0x50
+
+//*****************************************************************************
+//
+// The largest number of blocks transferred by a single simulated access.
+//
+//*****************************************************************************
+#define MAX_ACCESS_BLOCKS       32
+
+//*****************************************************************************
+//
+// The number of blocks at the start of the device used for the small random
+// accesses typical of FAT and directory sectors.
+//
+//*****************************************************************************
+#define TABLE_BLOCKS            64
+
+//*****************************************************************************
+//
+// Globals controlled by various command line parameters.
+//
+//*****************************************************************************
+BOOL g_bVerbose               = FALSE;
+BOOL g_bQuiet                 = FALSE;
+unsigned long g_ulDiskBlocks  = 4096;
+unsigned long g_ulAccesses    = 100000;
+unsigned long g_ulWritePct    = 20;
+unsigned long g_ulFailPct     = 0;
+unsigned long g_ulSeed        = 1;
+
+//*****************************************************************************
+//
+// Helpful macros for generating output depending upon verbose and quiet flags.
+//
+//*****************************************************************************
+#define VERBOSEPRINT(...) if(g_bVerbose) { printf(__VA_ARGS__); }
+#define QUIETPRINT(...) if(!g_bQuiet) { printf(__VA_ARGS__); }
+
+//*****************************************************************************
+//
+// Counts a check and reports it if it fails.
+//
+//*****************************************************************************
+static unsigned long g_ulFailed = 0;
+
+#define CHECK(bCond, ...)                                                     \
+    if(!(bCond))                                                              \
+    {                                                                         \
+        g_ulFailed++;                                                         \
+        QUIETPRINT("FAIL: " __VA_ARGS__);                                     \
+    }
+
+//*****************************************************************************
+//
+// The simulated device.  g_pucDisk holds the blocks on the device and
+// g_pucReference holds what the application expects them to contain, which
+// only differ if the driver has failed to write something through.
+//
+//*****************************************************************************
+static unsigned char *g_pucDisk;
+static unsigned char *g_pucReference;
+
+//*****************************************************************************
+//
+// The number of READ(10) and WRITE(10) commands seen by the device and the
+// number of blocks that they transferred.
+//
+//*****************************************************************************
+static unsigned long g_ulReadCommands;
+static unsigned long g_ulReadBlocks;
+static unsigned long g_ulWriteCommands;
+static unsigned long g_ulWriteBlocks;
+
+//*****************************************************************************
+//
+// When set, the next command fails.
+//
+//*****************************************************************************
+static BOOL g_bFailNext;
+
+//*****************************************************************************
+//
+// The configuration descriptor of the simulated device, which has a single
+// bulk only transport interface with one bulk IN and one bulk OUT endpoint.
+//
+//*****************************************************************************
+static unsigned char g_pucConfigDescriptor[] =
+{
+    9, USB_DTYPE_CONFIGURATION, 32, 0, 1, 1, 0, 0x80, 50,
+    9, USB_DTYPE_INTERFACE, 0, 0, 2, USB_CLASS_MASS_STORAGE,
+    USB_MSC_SUBCLASS_SCSI, USB_MSC_PROTO_BULKONLY, 0,
+    7, USB_DTYPE_ENDPOINT, USB_EP_DESC_IN | 1, USB_EP_ATTR_BULK, 64, 0, 0,
+    7, USB_DTYPE_ENDPOINT, USB_EP_DESC_OUT | 1, USB_EP_ATTR_BULK, 64, 0, 0
+};
+
+//*****************************************************************************
+//
+// Returns the next value from a xorshift generator, so that a run can be
+// repeated with the same seed.
+//
+//*****************************************************************************
+static unsigned long
+Random(void)
+{
+    g_ulSeed ^= (g_ulSeed << 13) & 0xffffffff;
+    g_ulSeed ^= g_ulSeed >> 17;
+    g_ulSeed ^= (g_ulSeed << 5) & 0xffffffff;
+
+    return(g_ulSeed);
+}
+
+//*****************************************************************************
+//
+// The host controller driver functions used by the class driver.  Only the
+// pipe handles matter, since the simulated device is reached through the
+// SCSI layer below.
+//
+//*****************************************************************************
+unsigned long
+USBHCDPipeAllocSize(unsigned long ulIndex, unsigned long ulEndpointType,
+                    tUSBHostDevice *pDevice, unsigned long ulSize,
+                    tHCDPipeCallback pCallback)
+{
+    return((ulEndpointType == USBHCD_PIPE_BULK_IN_DMA) ? 1 : 2);
+}
+
+unsigned long
+USBHCDPipeConfig(unsigned long ulPipe, unsigned long ulMaxPayload,
+                 unsigned long ulInterval, unsigned long ulTargetEndpoint)
+{
+    return(0);
+}
+
+void
+USBHCDPipeFree(unsigned long ulPipe)
+{
+}
+
+unsigned long
+USBHCDControlTransfer(unsigned long ulIndex, tUSBRequest *pSetupPacket,
+                      tUSBHostDevice *pDevice, unsigned char *pData,
+                      unsigned long ulSize, unsigned long ulMaxPacketSize)
+{
+    //
+    // The only request made is GET_MAX_LUN, and there is a single LUN.
+    //
+    *pData = 0;
+
+    return(1);
+}
+
+//*****************************************************************************
+//
+// The SCSI layer, which here is the simulated device itself.
+//
+//*****************************************************************************
+unsigned long
+USBHSCSIInquiry(unsigned long ulInPipe, unsigned long ulOutPipe,
+                unsigned char *pucBuffer, unsigned long *pulSize)
+{
+    memset(pucBuffer, 0, *pulSize);
+
+    return(SCSI_CMD_STATUS_PASS);
+}
+
+unsigned long
+USBHSCSIReadCapacity(unsigned long ulInPipe, unsigned long ulOutPipe,
+                     unsigned char *pData, unsigned long *pulSize)
+{
+    unsigned long ulLast;
+
+    //
+    // The address of the last block and the block size, both big endian.
+    //
+    ulLast = g_ulDiskBlocks - 1;
+    pData[0] = ulLast >> 24;
+    pData[1] = ulLast >> 16;
+    pData[2] = ulLast >> 8;
+    pData[3] = ulLast;
+    pData[4] = 0;
+    pData[5] = 0;
+    pData[6] = BLOCK_SIZE >> 8;
+    pData[7] = BLOCK_SIZE & 0xff;
+    *pulSize = 8;
+
+    return(SCSI_CMD_STATUS_PASS);
+}
+
+unsigned long
+USBHSCSITestUnitReady(unsigned long ulInPipe, unsigned long ulOutPipe)
+{
+    return(SCSI_CMD_STATUS_PASS);
+}
+
+unsigned long
+USBHSCSIRequestSense(unsigned long ulInPipe, unsigned long ulOutPipe,
+                     unsigned char *pucData, unsigned long *pulSize)
+{
+    memset(pucData, 0, *pulSize);
+    pucData[0] = SCSI_RS_CUR_ERRORS;
+    pucData[SCSI_RS_SKEY] = SCSI_RS_KEY_NO_SENSE;
+
+    return(SCSI_CMD_STATUS_PASS);
+}
+
+unsigned long
+USBHSCSIRead10(unsigned long ulInPipe, unsigned long ulOutPipe,
+               unsigned long ulLBA, unsigned char *pucData,
+               unsigned long *pulSize, unsigned long ulNumBlocks)
+{
+    g_ulReadCommands++;
+
+    if(g_bFailNext || (ulLBA + ulNumBlocks > g_ulDiskBlocks) ||
+       (*pulSize != ulNumBlocks * BLOCK_SIZE))
+    {
+        CHECK(g_bFailNext, "READ(10) of %lu blocks at %lu is invalid.\n",
+              ulNumBlocks, ulLBA);
+        g_bFailNext = FALSE;
+        *pulSize = 0;
+        return(SCSI_CMD_STATUS_FAIL);
+    }
+
+    g_ulReadBlocks += ulNumBlocks;
+    memcpy(pucData, g_pucDisk + (ulLBA * BLOCK_SIZE), *pulSize);
+
+    return(SCSI_CMD_STATUS_PASS);
+}
+
+unsigned long
+USBHSCSIWrite10(unsigned long ulInPipe, unsigned long ulOutPipe,
+                unsigned long ulLBA, unsigned char *pucData,
+                unsigned long *pulSize, unsigned long ulNumBlocks)
+{
+    g_ulWriteCommands++;
+
+    if(ulLBA + ulNumBlocks > g_ulDiskBlocks)
+    {
+        CHECK(0, "WRITE(10) of %lu blocks at %lu is invalid.\n",
+              ulNumBlocks, ulLBA);
+        return(SCSI_CMD_STATUS_FAIL);
+    }
+
+    //
+    // A failed write reaches the medium for only its first half, so that the
+    // driver must not trust anything it has cached for these blocks.
+    //
+    if(g_bFailNext)
+    {
+        g_bFailNext = FALSE;
+        ulNumBlocks /= 2;
+        memcpy(g_pucDisk + (ulLBA * BLOCK_SIZE), pucData,
+               ulNumBlocks * BLOCK_SIZE);
+        *pulSize = ulNumBlocks * BLOCK_SIZE;
+        return(SCSI_CMD_STATUS_FAIL);
+    }
+
+    g_ulWriteBlocks += ulNumBlocks;
+    memcpy(g_pucDisk + (ulLBA * BLOCK_SIZE), pucData, *pulSize);
+
+    return(SCSI_CMD_STATUS_PASS);
+}
+
+//*****************************************************************************
+//
+// Reads blocks through the driver and checks them against the reference.
+//
+//*****************************************************************************
+static void
+ReadAndCheck(unsigned long ulDrive, unsigned long ulLBA,
+             unsigned long ulNumBlocks)
+{
+    static unsigned char pucBuffer[MAX_ACCESS_BLOCKS * BLOCK_SIZE];
+    BOOL bFail;
+    long lRetcode;
+
+    bFail = (Random() % 100) < g_ulFailPct;
+    g_bFailNext = bFail;
+
+    lRetcode = USBHMSCBlockRead(ulDrive, ulLBA, pucBuffer, ulNumBlocks);
+
+    //
+    // A failure may not be seen if the blocks were all cached.
+    //
+    if(bFail)
+    {
+        g_bFailNext = FALSE;
+        if(lRetcode != 0)
+        {
+            return;
+        }
+    }
+
+    CHECK(lRetcode == 0, "Read of %lu blocks at %lu failed.\n", ulNumBlocks,
+          ulLBA);
+    CHECK(memcmp(pucBuffer, g_pucReference + (ulLBA * BLOCK_SIZE),
+                 ulNumBlocks * BLOCK_SIZE) == 0,
+          "Read of %lu blocks at %lu returned the wrong data.\n",
+          ulNumBlocks, ulLBA);
+}
+
+//*****************************************************************************
+//
+// Writes random data to blocks through the driver and to the reference.
+//
+//*****************************************************************************
+static void
+WriteRandom(unsigned long ulDrive, unsigned long ulLBA,
+            unsigned long ulNumBlocks)
+{
+    static unsigned char pucBuffer[MAX_ACCESS_BLOCKS * BLOCK_SIZE];
+    unsigned long ulIdx;
+    BOOL bFail;
+    long lRetcode;
+
+    for(ulIdx = 0; ulIdx < ulNumBlocks * BLOCK_SIZE; ulIdx++)
+    {
+        pucBuffer[ulIdx] = Random();
+    }
+
+    bFail = (Random() % 100) < g_ulFailPct;
+    g_bFailNext = bFail;
+
+    lRetcode = USBHMSCBlockWrite(ulDrive, ulLBA, pucBuffer, ulNumBlocks);
+
+    CHECK((lRetcode != 0) == bFail, "Write of %lu blocks at %lu %s.\n",
+          ulNumBlocks, ulLBA, bFail ? "did not fail" : "failed");
+
+    //
+    // The reference follows whatever reached the medium.
+    //
+    if(bFail)
+    {
+        ulNumBlocks /= 2;
+    }
+    memcpy(g_pucReference + (ulLBA * BLOCK_SIZE), pucBuffer,
+           ulNumBlocks * BLOCK_SIZE);
+}
+
+//*****************************************************************************
+//
+// Runs a random mix of the accesses a FAT file system makes: single block
+// reads and writes of the tables at the start of the device, short reads
+// which scan a file sequentially, and longer reads and writes of file data
+// anywhere on the device.
+//
+//*****************************************************************************
+static void
+RandomAccesses(unsigned long ulDrive)
+{
+    unsigned long ulAccess, ulLBA, ulNumBlocks, ulNext, ulReads, ulBlocks;
+    BOOL bWrite;
+
+    ulNext = TABLE_BLOCKS;
+    ulReads = 0;
+    ulBlocks = 0;
+    g_ulReadCommands = 0;
+    g_ulReadBlocks = 0;
+
+    for(ulAccess = 0; ulAccess < g_ulAccesses; ulAccess++)
+    {
+        bWrite = (Random() % 100) < g_ulWritePct;
+
+        switch(Random() % 3)
+        {
+            case 0:
+            {
+                ulLBA = Random() % TABLE_BLOCKS;
+                ulNumBlocks = 1;
+                break;
+            }
+
+            case 1:
+            {
+                ulNumBlocks = 1 + (Random() % 4);
+                if((ulNext + ulNumBlocks > g_ulDiskBlocks) ||
+                   ((Random() % 64) == 0))
+                {
+                    ulNext = TABLE_BLOCKS +
+                             (Random() % (g_ulDiskBlocks - TABLE_BLOCKS -
+                                          ulNumBlocks));
+                }
+                ulLBA = ulNext;
+                ulNext += ulNumBlocks;
+                break;
+            }
+
+            default:
+            {
+                ulNumBlocks = 1 + (Random() % MAX_ACCESS_BLOCKS);
+                ulLBA = Random() % (g_ulDiskBlocks - ulNumBlocks + 1);
+                break;
+            }
+        }
+
+        if(bWrite)
+        {
+            WriteRandom(ulDrive, ulLBA, ulNumBlocks);
+        }
+        else
+        {
+            ReadAndCheck(ulDrive, ulLBA, ulNumBlocks);
+            ulReads++;
+            ulBlocks += ulNumBlocks;
+        }
+    }
+
+    QUIETPRINT("Random accesses: %lu reads of %lu blocks took %lu READ(10) "
+               "commands of %lu blocks.\n", ulReads, ulBlocks,
+               g_ulReadCommands, g_ulReadBlocks);
+}
+
+//*****************************************************************************
+//
+// Checks the order in which blocks leave the LRU cache.  Each cache entry is
+// filled by a single block read, the first is then read again and the second
+// is written.  Only the read is a hit, so reading one more block must evict
+// the second entry and leave every other one in the cache.
+//
+//*****************************************************************************
+static void
+CheckLRUOrder(unsigned long ulDrive)
+{
+    unsigned long ulIdx, ulCommands;
+
+#if USBHMSC_CACHE_BLOCKS >= 2
+    //
+    // Use blocks two apart so that no read looks sequential.
+    //
+    for(ulIdx = 0; ulIdx < USBHMSC_CACHE_BLOCKS; ulIdx++)
+    {
+        ReadAndCheck(ulDrive, TABLE_BLOCKS + (ulIdx * 2), 1);
+    }
+
+    ulCommands = g_ulReadCommands;
+    ReadAndCheck(ulDrive, TABLE_BLOCKS, 1);
+    CHECK(g_ulReadCommands == ulCommands,
+          "A cached block was read from the device.\n");
+
+    WriteRandom(ulDrive, TABLE_BLOCKS + 2, 1);
+    ReadAndCheck(ulDrive, TABLE_BLOCKS + (USBHMSC_CACHE_BLOCKS * 2), 1);
+
+    ulCommands = g_ulReadCommands;
+    ReadAndCheck(ulDrive, TABLE_BLOCKS, 1);
+    for(ulIdx = 2; ulIdx <= USBHMSC_CACHE_BLOCKS; ulIdx++)
+    {
+        ReadAndCheck(ulDrive, TABLE_BLOCKS + (ulIdx * 2), 1);
+    }
+    CHECK(g_ulReadCommands == ulCommands,
+          "A recently used block was evicted from the cache.\n");
+
+    ReadAndCheck(ulDrive, TABLE_BLOCKS + 2, 1);
+    CHECK(g_ulReadCommands == ulCommands + 1,
+          "A written block was kept in the cache ahead of a read one.\n");
+
+    QUIETPRINT("LRU order: checked with %d cache entries.\n",
+               USBHMSC_CACHE_BLOCKS);
+#else
+    QUIETPRINT("LRU order: not checked with %d cache entries.\n",
+               USBHMSC_CACHE_BLOCKS);
+#endif
+}
+
+//*****************************************************************************
+//
+// Reads the whole device sequentially a block at a time and reports the
+// number of commands this took.
+//
+//*****************************************************************************
+static void
+SequentialScan(unsigned long ulDrive)
+{
+    unsigned long ulLBA;
+
+    g_ulReadCommands = 0;
+    g_ulReadBlocks = 0;
+
+    for(ulLBA = 0; ulLBA < g_ulDiskBlocks; ulLBA++)
+    {
+        ReadAndCheck(ulDrive, ulLBA, 1);
+    }
+
+    QUIETPRINT("Sequential scan: %lu single block reads took %lu READ(10) "
+               "commands.\n", g_ulDiskBlocks, g_ulReadCommands);
+}
+
+//*****************************************************************************
+//
+// Print the welcome banner.
+//
+//*****************************************************************************
+void
+PrintWelcome(void)
+{
+    QUIETPRINT("\nmscsim - Check the USB host mass storage block cache.\n\n");
+}
+
+//*****************************************************************************
+//
+// Show help on the application's command line parameters.
+//
+//*****************************************************************************
+void
+ShowHelp(void)
+{
+    //
+    // Only print help if we are not in quiet mode.
+    //
+    if(g_bQuiet)
+    {
+        return;
+    }
+
+    printf("This application builds usblib/host/usbhmsc.c for the host and\n");
+    printf("attaches it to a simulated mass storage device.  It checks\n");
+    printf("that random reads and writes through the block cache and\n");
+    printf("read-ahead window always see the data on the device, including\n");
+    printf("after failed commands, that only cache hits change the order\n");
+    printf("in which blocks are evicted, and reports the number of READ(10)\n");
+    printf("commands that reached the device.  The cache is configured when\n");
+    printf("the application is built, with \"make CACHE=<num>\n");
+    printf("READAHEAD=<num>\".\n\n");
+    printf("Supported parameters are:\n\n");
+    printf("-b <num>  - Simulate a device of the given number of blocks\n");
+    printf("            (default 4096).\n");
+    printf("-n <num>  - Make the given number of random accesses (default\n");
+    printf("            100000).\n");
+    printf("-w <pct>  - Make the given percentage of accesses writes\n");
+    printf("            (default 20).\n");
+    printf("-f <pct>  - Fail the given percentage of commands (default 0).\n");
+    printf("-r <num>  - Seed the random accesses with the given number\n");
+    printf("            (default 1).\n");
+    printf("-? or -h  - Show this help.\n");
+    printf("-q        - Quiet mode. Disable output to stdio.\n");
+    printf("-e        - Enable verbose output.\n\n");
+    printf("Example:\n\n");
+    printf("   mscsim -n 1000000 -f 5\n\n");
+}
+
+//*****************************************************************************
+//
+// Parse the command line, extracting all parameters.
+//
+// Returns 0 on failure, 1 on success.
+//
+//*****************************************************************************
+int
+ParseCommandLine(int argc, char *argv[])
+{
+    int iRetcode;
+    BOOL bShowHelp;
+
+    //
+    // By default, don't show the help screen.
+    //
+    bShowHelp = FALSE;
+
+    while(1)
+    {
+        //
+        // Get the next command line parameter.
+        //
+        iRetcode = getopt(argc, argv, "b:n:w:f:r:eh?q");
+
+        if(iRetcode == -1)
+        {
+            break;
+        }
+
+        switch(iRetcode)
+        {
+            case 'b':
+                g_ulDiskBlocks = strtoul(optarg, NULL, 0);
+                break;
+
+            case 'n':
+                g_ulAccesses = strtoul(optarg, NULL, 0);
+                break;
+
+            case 'w':
+                g_ulWritePct = strtoul(optarg, NULL, 0);
+                break;
+
+            case 'f':
+                g_ulFailPct = strtoul(optarg, NULL, 0);
+                break;
+
+            case 'r':
+                g_ulSeed = strtoul(optarg, NULL, 0) & 0xffffffff;
+                break;
+
+            case 'e':
+                g_bVerbose = TRUE;
+                break;
+
+            case 'q':
+                g_bQuiet = TRUE;
+                break;
+
+            case '?':
+            case 'h':
+                bShowHelp = TRUE;
+                break;
+        }
+    }
+
+    //
+    // Show the welcome banner unless we have been told to be quiet.
+    //
+    PrintWelcome();
+
+    //
+    // Catch various invalid parameter cases.  The device must hold the
+    // tables, the blocks used by the LRU check and a few file accesses.
+    //
+    if(bShowHelp || (g_ulSeed == 0) ||
+       (g_ulDiskBlocks < TABLE_BLOCKS + (4 * MAX_ACCESS_BLOCKS) +
+                         (2 * USBHMSC_CACHE_BLOCKS)) ||
+       (g_ulWritePct > 100) || (g_ulFailPct > 100) || (optind != argc))
+    {
+        ShowHelp();
+        return(0);
+    }
+
+    return(1);
+}
+
+//*****************************************************************************
+//
+// The main entry point of the application.
+//
+//*****************************************************************************
+int
+main(int argc, char *argv[])
+{
+    tUSBHostDevice sDevice;
+    unsigned long ulDrive, ulIdx;
+
+    if(!ParseCommandLine(argc, argv))
+    {
+        return(1);
+    }
+
+    QUIETPRINT("Cache of %d blocks, read-ahead of %d blocks, device of %lu "
+               "blocks.\n", USBHMSC_CACHE_BLOCKS, USBHMSC_READ_AHEAD_BLOCKS,
+               g_ulDiskBlocks);
+
+    //
+    // Fill the device with random data.
+    //
+    g_pucDisk = malloc(g_ulDiskBlocks * BLOCK_SIZE);
+    g_pucReference = malloc(g_ulDiskBlocks * BLOCK_SIZE);
+    if(!g_pucDisk || !g_pucReference)
+    {
+        fprintf(stderr, "Unable to allocate the simulated device.\n");
+        return(1);
+    }
+    for(ulIdx = 0; ulIdx < g_ulDiskBlocks * BLOCK_SIZE; ulIdx++)
+    {
+        g_pucDisk[ulIdx] = Random();
+    }
+    memcpy(g_pucReference, g_pucDisk, g_ulDiskBlocks * BLOCK_SIZE);
+
+    //
+    // Attach the device as the host stack would on enumeration.
+    //
+    memset(&sDevice, 0, sizeof(sDevice));
+    sDevice.pConfigDescriptor = (tConfigDescriptor *)g_pucConfigDescriptor;
+    sDevice.ulConfigDescriptorSize = sizeof(g_pucConfigDescriptor);
+
+    ulDrive = USBHMSCDriveOpen(0, 0);
+    CHECK(ulDrive != 0, "Unable to open the drive.\n");
+    CHECK(g_USBHostMSCClassDriver.pfnOpen(&sDevice) != 0,
+          "Unable to attach the device.\n");
+    CHECK(USBHMSCDriveReady(ulDrive) == 0, "The drive is not ready.\n");
+
+    if(!g_ulFailed)
+    {
+        SequentialScan(ulDrive);
+        CheckLRUOrder(ulDrive);
+        RandomAccesses(ulDrive);
+
+        //
+        // A final scan catches anything left stale in the cache.
+        //
+        g_ulFailPct = 0;
+        SequentialScan(ulDrive);
+        CHECK(memcmp(g_pucDisk, g_pucReference,
+                     g_ulDiskBlocks * BLOCK_SIZE) == 0,
+              "The device does not hold the data that was written.\n");
+    }
+
+    USBHMSCDriveClose(ulDrive);
+
+    QUIETPRINT("\n%s: %lu checks failed.\n", g_ulFailed ? "FAILED" : "PASSED",
+               g_ulFailed);
+
+    free(g_pucDisk);
+    free(g_pucReference);
+
+    return(g_ulFailed ? 1 : 0);
+}
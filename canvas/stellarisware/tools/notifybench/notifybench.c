@@ -0,0 +1,579 @@
+//*****************************************************************************
+//
+// notifybench.c - A command line utility that measures how quickly an
+//                 interrupt can wake a task through a semaphore, a queue and a
+//                 direct to task notification, running the FreeRTOS kernel on
+//                 the host.
+//
+//*****************************************************************************
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#include "FreeRTOS.h"
+#include "task.h"
+#include "queue.h"
+#include "semphr.h"
+
+typedef unsigned char BOOL;
+#define FALSE 0
+#define TRUE  1
+
+//*****************************************************************************
+//
+// The largest number of wake ups that may be measured for each method.
+//
+//*****************************************************************************
+#define MAX_SAMPLES             100000
+
+//*****************************************************************************
+//
+// Globals controlled by various command line parameters.
+//
+//*****************************************************************************
+BOOL g_bVerbose       = FALSE;
+BOOL g_bQuiet         = FALSE;
+unsigned long g_ulSamples    = 2000;
+unsigned long g_ulIterations = 100000;
+
+//*****************************************************************************
+//
+// Helpful macros for generating output depending upon verbose and quiet flags.
+//
+//*****************************************************************************
+#define VERBOSEPRINT(...) if(g_bVerbose) { printf(__VA_ARGS__); }
+#define QUIETPRINT(...) if(!g_bQuiet) { printf(__VA_ARGS__); }
+
+//*****************************************************************************
+//
+// A method of signalling the receiving task from an interrupt, along with the
+// results measured for it.  Times are in CPU cycles on x86 hosts and in
+// nanoseconds elsewhere.
+//
+//*****************************************************************************
+typedef struct
+{
+    //
+    // The name printed with the results.
+    //
+    const char *pcName;
+
+    //
+    // Signals the receiving task.  Called from the tick interrupt, and from
+    // the receiving task itself when measuring the cost without a wake up.
+    //
+    void (*pfnGive)(void);
+
+    //
+    // Waits for the signal in the receiving task.  Returns TRUE if the signal
+    // was received.
+    //
+    BOOL (*pfnTake)(portTickType xTicksToWait);
+
+    //
+    // The time taken by each call to pfnGive() from the interrupt, and from
+    // the start of that call until the receiving task was running again.
+    //
+    unsigned long long *pullGive;
+    unsigned long long *pullWake;
+
+    //
+    // The average time taken by a pfnGive() and pfnTake() pair when the
+    // receiving task is already running, so no task switch takes place.
+    //
+    unsigned long long ullPair;
+}
+tMethod;
+
+//*****************************************************************************
+//
+// The objects through which the receiving task is signalled.
+//
+//*****************************************************************************
+static xSemaphoreHandle g_xSemaphore;
+static xQueueHandle g_xQueue;
+static xTaskHandle g_xReceiver;
+
+//*****************************************************************************
+//
+// The method that the tick interrupt should use to signal the receiving task
+// next, or NULL if the receiving task is not ready for another signal.  The
+// sample being measured, and the time at which the signal was given.
+//
+//*****************************************************************************
+static tMethod * volatile g_psArmed;
+static volatile unsigned long g_ulSample;
+static volatile unsigned long long g_ullGiveStart;
+
+//*****************************************************************************
+//
+// Called by the kernel when it detects an inconsistency.
+//
+//*****************************************************************************
+void
+KernelAssertFailed(const char *pcFile, int iLine)
+{
+    fprintf(stderr, "Kernel assertion failed at %s:%d\n", pcFile, iLine);
+    exit(1);
+}
+
+//*****************************************************************************
+//
+// Returns a timestamp used to measure the cost of a kernel call.
+//
+//*****************************************************************************
+static unsigned long long
+Timestamp(void)
+{
+#if defined(__i386__) || defined(__x86_64__)
+    return(__builtin_ia32_rdtsc());
+#else
+    struct timespec sNow;
+
+    clock_gettime(CLOCK_MONOTONIC, &sNow);
+    return(((unsigned long long)sNow.tv_sec * 1000000000ULL) + sNow.tv_nsec);
+#endif
+}
+
+//*****************************************************************************
+//
+// The signalling methods under test.
+//
+//*****************************************************************************
+static void
+SemaphoreGive(void)
+{
+    signed portBASE_TYPE xWoken = pdFALSE;
+
+    xSemaphoreGiveFromISR(g_xSemaphore, &xWoken);
+}
+
+static BOOL
+SemaphoreTake(portTickType xTicksToWait)
+{
+    return(xSemaphoreTake(g_xSemaphore, xTicksToWait) == pdTRUE);
+}
+
+static void
+QueueGive(void)
+{
+    signed portBASE_TYPE xWoken = pdFALSE;
+    unsigned long ulValue = 1;
+
+    xQueueSendFromISR(g_xQueue, &ulValue, &xWoken);
+}
+
+static BOOL
+QueueTake(portTickType xTicksToWait)
+{
+    unsigned long ulValue;
+
+    return(xQueueReceive(g_xQueue, &ulValue, xTicksToWait) == pdTRUE);
+}
+
+static void
+NotifyGive(void)
+{
+    signed portBASE_TYPE xWoken = pdFALSE;
+
+    vTaskNotifyGiveFromISR(g_xReceiver, &xWoken);
+}
+
+static BOOL
+NotifyTake(portTickType xTicksToWait)
+{
+    return(ulTaskNotifyTake(pdTRUE, xTicksToWait) != 0);
+}
+
+static void
+NotifyBitsGive(void)
+{
+    signed portBASE_TYPE xWoken = pdFALSE;
+
+    xTaskNotifyFromISR(g_xReceiver, 1, eSetBits, &xWoken);
+}
+
+static BOOL
+NotifyBitsTake(portTickType xTicksToWait)
+{
+    unsigned long ulBits;
+
+    return(xTaskNotifyWait(0, 0xFFFFFFFF, &ulBits, xTicksToWait) == pdTRUE);
+}
+
+static tMethod g_psMethods[] =
+{
+    { "Binary semaphore", SemaphoreGive, SemaphoreTake },
+    { "Queue",            QueueGive,     QueueTake },
+    { "Notify give/take", NotifyGive,    NotifyTake },
+    { "Notify set bits",  NotifyBitsGive, NotifyBitsTake }
+};
+
+#define NUM_METHODS             (sizeof(g_psMethods) / sizeof(g_psMethods[0]))
+
+//*****************************************************************************
+//
+// The tick hook, which stands in for an interrupt handler that signals the
+// receiving task.  The signal is only given while the receiving task is
+// blocked waiting for it, so that every signal wakes the task.
+//
+//*****************************************************************************
+void
+vApplicationTickHook(void)
+{
+    tMethod *psMethod;
+    unsigned long long ullStart;
+
+    psMethod = g_psArmed;
+    if(!psMethod || (xTaskGetCurrentTaskHandle() == g_xReceiver))
+    {
+        return;
+    }
+
+    g_psArmed = NULL;
+
+    ullStart = Timestamp();
+    psMethod->pfnGive();
+    psMethod->pullGive[g_ulSample] = Timestamp() - ullStart;
+    g_ullGiveStart = ullStart;
+}
+
+//*****************************************************************************
+//
+// The receiving task, which runs every measurement in turn and then ends the
+// scheduler.  It runs at the highest priority, so it is only ever blocked
+// waiting for a signal while another task is running.
+//
+//*****************************************************************************
+static void
+ReceiverTask(void *pvParameters)
+{
+    tMethod *psMethod;
+    unsigned long ulMethod, ulSample, ulIdx;
+    unsigned long long ullStart, ullNow;
+
+    for(ulMethod = 0; ulMethod < NUM_METHODS; ulMethod++)
+    {
+        psMethod = &g_psMethods[ulMethod];
+
+        //
+        // Have the interrupt signal this task once per tick, and measure how
+        // long it takes for this task to run again.
+        //
+        ulSample = 0;
+        while(ulSample < g_ulSamples)
+        {
+            g_ulSample = ulSample;
+            g_psArmed = psMethod;
+
+            if(psMethod->pfnTake(portMAX_DELAY))
+            {
+                ullNow = Timestamp();
+                psMethod->pullWake[ulSample++] = ullNow - g_ullGiveStart;
+            }
+        }
+
+        //
+        // Measure the cost of the signalling calls alone, by giving and
+        // taking the signal from this task without ever blocking.
+        //
+        ullStart = Timestamp();
+        for(ulIdx = 0; ulIdx < g_ulIterations; ulIdx++)
+        {
+            psMethod->pfnGive();
+            psMethod->pfnTake(0);
+        }
+        psMethod->ullPair = (Timestamp() - ullStart) / g_ulIterations;
+    }
+
+    vTaskEndScheduler();
+}
+
+//*****************************************************************************
+//
+// A task that keeps the processor busy at the lowest priority, so that the
+// tick interrupt is always taken by a task other than the receiving task.
+//
+//*****************************************************************************
+static void
+SpinTask(void *pvParameters)
+{
+    for(;;)
+    {
+    }
+}
+
+//*****************************************************************************
+//
+// Show the startup banner.
+//
+//*****************************************************************************
+void
+PrintWelcome(void)
+{
+    QUIETPRINT("\nnotifybench - Measure interrupt to task signalling in "
+               "FreeRTOS.\n\n");
+}
+
+//*****************************************************************************
+//
+// Show help on the application command line parameters.
+//
+//*****************************************************************************
+void
+ShowHelp(void)
+{
+    //
+    // Only print help if we are not in quiet mode.
+    //
+    if(g_bQuiet)
+    {
+        return;
+    }
+
+    printf("This application runs the FreeRTOS kernel on the host and has the\n");
+    printf("tick interrupt wake a task using a binary semaphore, a queue, and\n");
+    printf("direct to task notifications.  For each method it reports the time\n");
+    printf("taken by the call made in the interrupt, the time from the start of\n");
+    printf("that call until the task is running again, and the time taken by a\n");
+    printf("give and take pair when no task needs to be woken.\n\n");
+    printf("On the host every change to the interrupt mask is a system call, and\n");
+    printf("every task switch is a switch between host threads, so the absolute\n");
+    printf("times are far longer than on the target.  The differences between\n");
+    printf("the methods are what matter.\n\n");
+    printf("Supported parameters are:\n\n");
+    printf("-n <num>  - The number of wake ups to measure for each method (default 2000).\n");
+    printf("-i <num>  - The number of give and take pairs to time (default 100000).\n");
+    printf("-? or -h  - Show this help.\n");
+    printf("-q        - Quiet mode. Disable output to stdio.\n");
+    printf("-e        - Enable verbose output\n\n");
+    printf("Example:\n\n");
+    printf("   notifybench -n 10000\n\n");
+}
+
+//*****************************************************************************
+//
+// Parse the command line, extracting all parameters.
+//
+// Returns 0 on failure, 1 on success.
+//
+//*****************************************************************************
+int
+ParseCommandLine(int argc, char *argv[])
+{
+    int iRetcode;
+    BOOL bShowHelp;
+
+    //
+    // By default, don't show the help screen.
+    //
+    bShowHelp = FALSE;
+
+    while(1)
+    {
+        //
+        // Get the next command line parameter.
+        //
+        iRetcode = getopt(argc, argv, "n:i:eh?q");
+
+        if(iRetcode == -1)
+        {
+            break;
+        }
+
+        switch(iRetcode)
+        {
+            case 'n':
+                g_ulSamples = strtoul(optarg, NULL, 0);
+                break;
+
+            case 'i':
+                g_ulIterations = strtoul(optarg, NULL, 0);
+                break;
+
+            case 'e':
+                g_bVerbose = TRUE;
+                break;
+
+            case 'q':
+                g_bQuiet = TRUE;
+                break;
+
+            case '?':
+            case 'h':
+                bShowHelp = TRUE;
+                break;
+        }
+    }
+
+    //
+    // Show the welcome banner unless we have been told to be quiet.
+    //
+    PrintWelcome();
+
+    //
+    // Catch various invalid parameter cases.
+    //
+    if(bShowHelp || (g_ulSamples == 0) || (g_ulSamples > MAX_SAMPLES) ||
+       (g_ulIterations == 0))
+    {
+        ShowHelp();
+
+        if((g_ulSamples == 0) || (g_ulSamples > MAX_SAMPLES))
+        {
+            fprintf(stderr, "The number of wake ups must be between 1 and "
+                    "%d.\n", MAX_SAMPLES);
+        }
+
+        if(g_ulIterations == 0)
+        {
+            fprintf(stderr, "The number of pairs must not be zero.\n");
+        }
+
+        return(0);
+    }
+
+    VERBOSEPRINT("Wake ups %lu, pairs %lu\n", g_ulSamples, g_ulIterations);
+
+    return(1);
+}
+
+//*****************************************************************************
+//
+// Compares two samples, for sorting.
+//
+//*****************************************************************************
+static int
+CompareSamples(const void *pvA, const void *pvB)
+{
+    unsigned long long ullA, ullB;
+
+    ullA = *(const unsigned long long *)pvA;
+    ullB = *(const unsigned long long *)pvB;
+
+    return((ullA > ullB) - (ullA < ullB));
+}
+
+//*****************************************************************************
+//
+// Prints the distribution of a set of samples.  The samples are sorted.
+//
+//*****************************************************************************
+static void
+PrintSamples(const char *pcName, unsigned long long *pullSamples,
+             unsigned long ulCount)
+{
+    unsigned long long ullTotal;
+    unsigned long ulIdx;
+
+    qsort(pullSamples, ulCount, sizeof(pullSamples[0]), CompareSamples);
+
+    ullTotal = 0;
+    for(ulIdx = 0; ulIdx < ulCount; ulIdx++)
+    {
+        ullTotal += pullSamples[ulIdx];
+    }
+
+    QUIETPRINT("  %-6s min %8llu  median %8llu  99%% %8llu  max %8llu  "
+               "average %8llu\n", pcName, pullSamples[0],
+               pullSamples[ulCount / 2], pullSamples[(ulCount * 99) / 100],
+               pullSamples[ulCount - 1], ullTotal / ulCount);
+}
+
+//*****************************************************************************
+//
+// The main entry point of the utility.
+//
+//*****************************************************************************
+int
+main(int argc, char *argv[])
+{
+    unsigned long ulMethod;
+
+    //
+    // Parse the command line.
+    //
+    if(!ParseCommandLine(argc, argv))
+    {
+        return(1);
+    }
+
+    //
+    // Allocate the space for the samples.
+    //
+    for(ulMethod = 0; ulMethod < NUM_METHODS; ulMethod++)
+    {
+        g_psMethods[ulMethod].pullGive =
+            malloc(g_ulSamples * sizeof(unsigned long long));
+        g_psMethods[ulMethod].pullWake =
+            malloc(g_ulSamples * sizeof(unsigned long long));
+
+        if(!g_psMethods[ulMethod].pullGive || !g_psMethods[ulMethod].pullWake)
+        {
+            fprintf(stderr, "Unable to allocate space for %lu samples.\n",
+                    g_ulSamples);
+            return(1);
+        }
+    }
+
+    //
+    // Create the objects that are used to signal the receiving task, and the
+    // tasks themselves.
+    //
+    vSemaphoreCreateBinary(g_xSemaphore);
+    g_xQueue = xQueueCreate(1, sizeof(unsigned long));
+    if(!g_xSemaphore || !g_xQueue)
+    {
+        fprintf(stderr, "Unable to create the semaphore and queue.\n");
+        return(1);
+    }
+
+    //
+    // The binary semaphore is created in the given state.
+    //
+    xSemaphoreTake(g_xSemaphore, 0);
+
+    if((xTaskCreate(ReceiverTask, (signed char *)"Receiver",
+                    configMINIMAL_STACK_SIZE, NULL, configMAX_PRIORITIES - 1,
+                    &g_xReceiver) != pdPASS) ||
+       (xTaskCreate(SpinTask, (signed char *)"Spin", configMINIMAL_STACK_SIZE,
+                    NULL, tskIDLE_PRIORITY + 1, NULL) != pdPASS))
+    {
+        fprintf(stderr, "Unable to create the tasks.\n");
+        return(1);
+    }
+
+    QUIETPRINT("Measuring %lu wake ups for each method.\n", g_ulSamples);
+
+    //
+    // Run the measurements.  This returns once the receiving task has ended
+    // the scheduler.
+    //
+    vTaskStartScheduler();
+
+    //
+    // Report the results.
+    //
+    QUIETPRINT("\nTimes are in %s.  \"Give\" is the call made in the "
+               "interrupt, \"Wake\"\nis from the start of that call until "
+               "the task runs, and \"Pair\" is a give\nand take that do not "
+               "switch tasks.\n\n",
+#if defined(__i386__) || defined(__x86_64__)
+               "CPU cycles"
+#else
+               "nanoseconds"
+#endif
+               );
+
+    for(ulMethod = 0; ulMethod < NUM_METHODS; ulMethod++)
+    {
+        QUIETPRINT("%s\n", g_psMethods[ulMethod].pcName);
+        PrintSamples("Give", g_psMethods[ulMethod].pullGive, g_ulSamples);
+        PrintSamples("Wake", g_psMethods[ulMethod].pullWake, g_ulSamples);
+        QUIETPRINT("  Pair   average %8llu\n\n", g_psMethods[ulMethod].ullPair);
+    }
+
+    return(0);
+}
@@ -0,0 +1,788 @@
+//*****************************************************************************
+//
+// rpcbench.c - A command line utility that checks the binary command channel
+//              in utils/rpc.c and measures its latency and throughput, either
+//              against a copy running on the host or against a device.
+//
+//*****************************************************************************
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#include <pthread.h>
+#include <termios.h>
+#include <sys/socket.h>
+#include "inc/hw_types.h"
+#include "utils/rpc.h"
+#include "rpcclient.h"
+
+typedef unsigned char BOOL;
+#define FALSE 0
+#define TRUE  1
+
+//*****************************************************************************
+//
+// The commands provided by the copy of the channel that runs on the host.
+// Only RPC_CMD_ECHO is used when running against a device.
+//
+//*****************************************************************************
+#define CMD_STREAM              1
+#define CMD_COUNT               2
+#define CMD_UNUSED              3
+
+//*****************************************************************************
+//
+// The size of the payload used to measure the round trip time.
+//
+//*****************************************************************************
+#define LATENCY_PAYLOAD         16
+
+//*****************************************************************************
+//
+// The size of each update sent without a response, which is that of a
+// typical command to set an output, and the number of frames of updates sent
+// between each wait for the device to catch up.
+//
+//*****************************************************************************
+#define UPDATE_PAYLOAD          6
+#define UPDATE_FRAMES           16
+
+//*****************************************************************************
+//
+// The largest payload that fits in a frame with its response.
+//
+//*****************************************************************************
+#define MAX_PAYLOAD             255
+
+//*****************************************************************************
+//
+// Globals controlled by various command line parameters.
+//
+//*****************************************************************************
+BOOL g_bVerbose              = FALSE;
+BOOL g_bQuiet                = FALSE;
+char *g_pcDevice             = NULL;
+unsigned long g_ulBaud       = 115200;
+char *g_pcConsoleCmd         = NULL;
+int g_iExitCmd               = -1;
+unsigned long g_ulIterations = 0;
+
+//*****************************************************************************
+//
+// Helpful macros for generating output depending upon verbose and quiet flags.
+//
+//*****************************************************************************
+#define VERBOSEPRINT(...) if(g_bVerbose) { printf(__VA_ARGS__); }
+#define QUIETPRINT(...) if(!g_bQuiet) { printf(__VA_ARGS__); }
+
+//*****************************************************************************
+//
+// Stops the utility if a check fails.
+//
+//*****************************************************************************
+#define CHECK(bCondition)                                                     \
+    if(!(bCondition))                                                         \
+    {                                                                         \
+        CheckFailed(#bCondition, __LINE__);                                   \
+    }
+
+//*****************************************************************************
+//
+// The connection to the device, or to the copy of the channel on the host.
+//
+//*****************************************************************************
+tRPCClient g_sClient;
+
+//*****************************************************************************
+//
+// The copy of the channel that runs on the host, and the socket that it
+// reads requests from and writes responses to.
+//
+//*****************************************************************************
+tRPCInstance g_sServer;
+int g_iServerFd = -1;
+
+//*****************************************************************************
+//
+// Reports a failed check and exits.
+//
+//*****************************************************************************
+static void
+CheckFailed(const char *pcCondition, int iLine)
+{
+    fflush(stdout);
+    fprintf(stderr, "Check failed at line %d: %s\n", iLine, pcCondition);
+    exit(1);
+}
+
+//*****************************************************************************
+//
+// Returns the time in seconds from an arbitrary point.
+//
+//*****************************************************************************
+static double
+Now(void)
+{
+    struct timespec sTime;
+
+    clock_gettime(CLOCK_MONOTONIC, &sTime);
+
+    return((double)sTime.tv_sec + ((double)sTime.tv_nsec / 1e9));
+}
+
+//*****************************************************************************
+//
+// Returns the byte at a given offset of the data sent by CMD_STREAM.
+//
+//*****************************************************************************
+static unsigned char
+StreamByte(unsigned long ulOffset)
+{
+    return((unsigned char)((ulOffset * 7) + (ulOffset >> 8)));
+}
+
+//*****************************************************************************
+//
+// Sends the number of bytes given as a 16 bit value, in pieces, to test
+// responses that span many frames.
+//
+//*****************************************************************************
+static unsigned long
+CmdStream(tRPCInstance *psInst, const unsigned char *pucData,
+          unsigned long ulLen)
+{
+    unsigned char pucPiece[100];
+    unsigned long ulSize, ulOffset, ulIdx, ulCount;
+
+    ulSize = pucData[0] | (pucData[1] << 8);
+    for(ulOffset = 0; ulOffset < ulSize; ulOffset += ulCount)
+    {
+        ulCount = ulSize - ulOffset;
+        if(ulCount > sizeof(pucPiece))
+        {
+            ulCount = sizeof(pucPiece);
+        }
+        for(ulIdx = 0; ulIdx < ulCount; ulIdx++)
+        {
+            pucPiece[ulIdx] = StreamByte(ulOffset + ulIdx);
+        }
+        RPCResponseWrite(psInst, pucPiece, ulCount);
+    }
+
+    return(RPC_STATUS_OK);
+}
+
+//*****************************************************************************
+//
+// Sends the number of commands handled so far.
+//
+//*****************************************************************************
+static unsigned long
+CmdCount(tRPCInstance *psInst, const unsigned char *pucData,
+         unsigned long ulLen)
+{
+    unsigned char pucCount[4];
+
+    pucCount[0] = psInst->ulCommands & 0xff;
+    pucCount[1] = (psInst->ulCommands >> 8) & 0xff;
+    pucCount[2] = (psInst->ulCommands >> 16) & 0xff;
+    pucCount[3] = (psInst->ulCommands >> 24) & 0xff;
+    RPCResponseWrite(psInst, pucCount, sizeof(pucCount));
+
+    return(RPC_STATUS_OK);
+}
+
+//*****************************************************************************
+//
+// The commands of the copy of the channel on the host.
+//
+//*****************************************************************************
+static const tRPCEntry g_psServerCommands[] =
+{
+    { RPCEcho, 0, 255 },
+    { CmdStream, 2, 2 },
+    { CmdCount, 0, 0 }
+};
+
+//*****************************************************************************
+//
+// Sends the responses of the copy of the channel on the host.
+//
+//*****************************************************************************
+static void
+ServerWrite(void *pvInstance, const unsigned char *pucData,
+            unsigned long ulSize)
+{
+    ssize_t iCount;
+
+    while(ulSize)
+    {
+        iCount = write(*(int *)pvInstance, pucData, ulSize);
+        if(iCount <= 0)
+        {
+            return;
+        }
+        pucData += iCount;
+        ulSize -= iCount;
+    }
+}
+
+//*****************************************************************************
+//
+// Runs the copy of the channel on the host, until the socket is closed.
+//
+//*****************************************************************************
+static void *
+ServerThread(void *pvParam)
+{
+    unsigned char pucBuffer[512];
+    ssize_t iCount;
+
+    while(1)
+    {
+        iCount = read(g_iServerFd, pucBuffer, sizeof(pucBuffer));
+        if(iCount <= 0)
+        {
+            break;
+        }
+        RPCReceive(&g_sServer, pucBuffer, iCount);
+    }
+
+    return(NULL);
+}
+
+//*****************************************************************************
+//
+// Counts the responses to a frame of echo requests, and checks that each
+// matches its request.
+//
+//*****************************************************************************
+typedef struct
+{
+    unsigned long ulCount;
+    unsigned long ulBytes;
+    unsigned long ulErrors;
+}
+tEchoState;
+
+static void
+EchoCallback(void *pvData, unsigned char ucCmd, unsigned char ucStatus,
+             const unsigned char *pucData, unsigned long ulLen)
+{
+    tEchoState *psState;
+    unsigned long ulIdx;
+
+    psState = pvData;
+    if((ucCmd != RPC_CMD_ECHO) || (ucStatus != RPC_STATUS_OK))
+    {
+        psState->ulErrors++;
+    }
+    for(ulIdx = 0; ulIdx < ulLen; ulIdx++)
+    {
+        if(pucData[ulIdx] != (unsigned char)(psState->ulCount + ulIdx))
+        {
+            psState->ulErrors++;
+            break;
+        }
+    }
+    psState->ulCount++;
+    psState->ulBytes += ulLen;
+}
+
+//*****************************************************************************
+//
+// Fills a payload for an echo request with a pattern that EchoCallback()
+// checks.
+//
+//*****************************************************************************
+static void
+FillEcho(unsigned char *pucData, unsigned long ulLen, unsigned long ulSeed)
+{
+    unsigned long ulIdx;
+
+    for(ulIdx = 0; ulIdx < ulLen; ulIdx++)
+    {
+        pucData[ulIdx] = (unsigned char)(ulSeed + ulIdx);
+    }
+}
+
+//*****************************************************************************
+//
+// Checks the handling of requests, responses and errors by the copy of the
+// channel on the host.
+//
+//*****************************************************************************
+static void
+CheckProtocol(void)
+{
+    unsigned char pucData[MAX_PAYLOAD], pucResponse[8192];
+    unsigned long ulLen, ulIdx, ulErrors, ulCommands;
+    tEchoState sState;
+    int iStatus;
+
+    QUIETPRINT("Checking the protocol...\n");
+
+    //
+    // Echo every length of payload, with data that needs escaping.
+    //
+    for(ulLen = 0; ulLen <= MAX_PAYLOAD; ulLen++)
+    {
+        for(ulIdx = 0; ulIdx < ulLen; ulIdx++)
+        {
+            pucData[ulIdx] = (ulIdx & 1) ? RPC_END : RPC_ESC;
+            if(ulIdx % 3 == 0)
+            {
+                pucData[ulIdx] = (unsigned char)(ulLen + ulIdx);
+            }
+        }
+        ulIdx = sizeof(pucResponse);
+        iStatus = RPCClientCall(&g_sClient, RPC_CMD_ECHO, pucData, ulLen,
+                                pucResponse, &ulIdx);
+        CHECK(iStatus == RPC_STATUS_OK);
+        CHECK(ulIdx == ulLen);
+        CHECK(!memcmp(pucData, pucResponse, ulLen));
+    }
+    VERBOSEPRINT("  Echo of 0 to %d bytes passed\n", MAX_PAYLOAD);
+
+    //
+    // Check that unknown commands and bad lengths are rejected.
+    //
+    ulIdx = sizeof(pucResponse);
+    CHECK(RPCClientCall(&g_sClient, CMD_UNUSED, NULL, 0, pucResponse,
+                        &ulIdx) == RPC_STATUS_BAD_CMD);
+    ulIdx = sizeof(pucResponse);
+    CHECK(RPCClientCall(&g_sClient, 200, NULL, 0, pucResponse,
+                        &ulIdx) == RPC_STATUS_BAD_CMD);
+    ulIdx = sizeof(pucResponse);
+    CHECK(RPCClientCall(&g_sClient, CMD_STREAM, pucData, 1, pucResponse,
+                        &ulIdx) == RPC_STATUS_BAD_LENGTH);
+    VERBOSEPRINT("  Bad commands and lengths rejected\n");
+
+    //
+    // Check a response that spans many frames.
+    //
+    pucData[0] = sizeof(pucResponse) & 0xff;
+    pucData[1] = sizeof(pucResponse) >> 8;
+    ulLen = sizeof(pucResponse);
+    CHECK(RPCClientCall(&g_sClient, CMD_STREAM, pucData, 2, pucResponse,
+                        &ulLen) == RPC_STATUS_OK);
+    CHECK(ulLen == sizeof(pucResponse));
+    for(ulIdx = 0; ulIdx < ulLen; ulIdx++)
+    {
+        CHECK(pucResponse[ulIdx] == StreamByte(ulIdx));
+    }
+    VERBOSEPRINT("  Streamed response of %lu bytes passed\n", ulLen);
+
+    //
+    // Check a batch of requests in one frame.
+    //
+    for(ulIdx = 0; ulIdx < 20; ulIdx++)
+    {
+        FillEcho(pucData, ulIdx, ulIdx);
+        CHECK(RPCClientAdd(&g_sClient, RPC_CMD_ECHO, pucData, ulIdx));
+    }
+    CHECK(RPCClientSend(&g_sClient, 1));
+    memset(&sState, 0, sizeof(sState));
+    CHECK(RPCClientReceive(&g_sClient, EchoCallback, &sState));
+    CHECK((sState.ulCount == 20) && !sState.ulErrors);
+    VERBOSEPRINT("  Batch of 20 requests passed\n");
+
+    //
+    // Check that requests sent without a response are handled, and that a
+    // corrupt frame is discarded without a response.
+    //
+    ulLen = sizeof(pucResponse);
+    CHECK(RPCClientCall(&g_sClient, CMD_COUNT, NULL, 0, pucResponse,
+                        &ulLen) == RPC_STATUS_OK);
+    CHECK(ulLen == 4);
+    ulCommands = (pucResponse[0] | (pucResponse[1] << 8) |
+                  (pucResponse[2] << 16) | ((unsigned long)pucResponse[3] << 24));
+    ulErrors = g_sServer.ulErrors;
+    for(ulIdx = 0; ulIdx < 5; ulIdx++)
+    {
+        CHECK(RPCClientAdd(&g_sClient, RPC_CMD_ECHO, pucData, 8));
+    }
+    CHECK(RPCClientSend(&g_sClient, 0));
+    pucData[0] = RPC_END;
+    pucData[1] = 0x01;
+    pucData[2] = 0x00;
+    pucData[3] = 0x00;
+    pucData[4] = 0x12;
+    pucData[5] = RPC_END;
+    pucData[6] = RPC_ESC;
+    pucData[7] = 0x00;
+    pucData[8] = RPC_END;
+    CHECK(write(g_sClient.iFd, pucData, 9) == 9);
+    ulLen = sizeof(pucResponse);
+    CHECK(RPCClientCall(&g_sClient, CMD_COUNT, NULL, 0, pucResponse,
+                        &ulLen) == RPC_STATUS_OK);
+    CHECK((pucResponse[0] | (pucResponse[1] << 8) | (pucResponse[2] << 16) |
+           ((unsigned long)pucResponse[3] << 24)) == (ulCommands + 6));
+    CHECK(g_sServer.ulErrors == (ulErrors + 2));
+    VERBOSEPRINT("  Requests without a response and corrupt frames passed\n");
+
+    QUIETPRINT("All checks passed.\n\n");
+}
+
+//*****************************************************************************
+//
+// Measures the time taken to send a request and receive its response.
+//
+//*****************************************************************************
+static void
+MeasureLatency(void)
+{
+    unsigned char pucData[LATENCY_PAYLOAD], pucResponse[LATENCY_PAYLOAD];
+    unsigned long ulIdx, ulLen;
+    double dStart, dTime;
+
+    FillEcho(pucData, sizeof(pucData), 0);
+    dStart = Now();
+    for(ulIdx = 0; ulIdx < g_ulIterations; ulIdx++)
+    {
+        ulLen = sizeof(pucResponse);
+        CHECK(RPCClientCall(&g_sClient, RPC_CMD_ECHO, pucData, sizeof(pucData),
+                            pucResponse, &ulLen) == RPC_STATUS_OK);
+        CHECK(ulLen == sizeof(pucData));
+    }
+    dTime = Now() - dStart;
+
+    QUIETPRINT("Round trip of a %d byte echo:       %10.1f us\n",
+               LATENCY_PAYLOAD, (dTime * 1e6) / g_ulIterations);
+}
+
+//*****************************************************************************
+//
+// Measures the rate at which small updates are handled when they are batched
+// and sent without a response, waiting for the device to catch up every few
+// frames.
+//
+//*****************************************************************************
+static void
+MeasureUpdates(void)
+{
+    unsigned char pucData[UPDATE_PAYLOAD];
+    unsigned long ulIdx, ulFrames;
+    double dStart, dTime;
+
+    FillEcho(pucData, sizeof(pucData), 0);
+    ulFrames = 0;
+    dStart = Now();
+    for(ulIdx = 0; ulIdx < g_ulIterations; ulIdx++)
+    {
+        if(!RPCClientAdd(&g_sClient, RPC_CMD_ECHO, pucData, sizeof(pucData)))
+        {
+            CHECK(RPCClientSend(&g_sClient, 0));
+            if(++ulFrames % UPDATE_FRAMES == 0)
+            {
+                CHECK(RPCClientSend(&g_sClient, 1));
+                CHECK(RPCClientReceive(&g_sClient, NULL, NULL));
+            }
+            CHECK(RPCClientAdd(&g_sClient, RPC_CMD_ECHO, pucData,
+                               sizeof(pucData)));
+        }
+    }
+    CHECK(RPCClientSend(&g_sClient, 0));
+    CHECK(RPCClientSend(&g_sClient, 1));
+    CHECK(RPCClientReceive(&g_sClient, NULL, NULL));
+    dTime = Now() - dStart;
+
+    QUIETPRINT("Batched %d byte updates:            %10.0f per second\n",
+               UPDATE_PAYLOAD, g_ulIterations / dTime);
+}
+
+//*****************************************************************************
+//
+// Measures the rate at which data is echoed, in frames that are as full as
+// possible, and for a device that takes many small requests per frame.
+//
+//*****************************************************************************
+static void
+MeasureThroughput(unsigned long ulPayload)
+{
+    unsigned char pucData[MAX_PAYLOAD];
+    unsigned long ulIdx, ulPerFrame;
+    tEchoState sState;
+    double dStart, dTime;
+
+    //
+    // Find the number of requests that fit in a frame, with their responses.
+    //
+    ulPerFrame = (RPC_MAX_FRAME - 4) / (ulPayload + 3);
+
+    memset(&sState, 0, sizeof(sState));
+    dStart = Now();
+    for(ulIdx = 0; ulIdx < g_ulIterations; ulIdx++)
+    {
+        FillEcho(pucData, ulPayload, sState.ulCount + (ulIdx % ulPerFrame));
+        CHECK(RPCClientAdd(&g_sClient, RPC_CMD_ECHO, pucData, ulPayload));
+        if(((ulIdx + 1) % ulPerFrame == 0) || (ulIdx + 1 == g_ulIterations))
+        {
+            CHECK(RPCClientSend(&g_sClient, 1));
+            CHECK(RPCClientReceive(&g_sClient, EchoCallback, &sState));
+        }
+    }
+    dTime = Now() - dStart;
+    CHECK((sState.ulCount == g_ulIterations) && !sState.ulErrors);
+
+    QUIETPRINT("Echo of %3lu byte requests, %2lu/frame: %10.0f bytes per "
+               "second each way\n", ulPayload, ulPerFrame,
+               sState.ulBytes / dTime);
+}
+
+//*****************************************************************************
+//
+// Print the welcome banner.
+//
+//*****************************************************************************
+void
+PrintWelcome(void)
+{
+    QUIETPRINT("\nrpcbench - Check and measure the binary command channel.\n\n");
+}
+
+//*****************************************************************************
+//
+// Show help on the application command line parameters.
+//
+//*****************************************************************************
+void
+ShowHelp(void)
+{
+    //
+    // Only print help if we are not in quiet mode.
+    //
+    if(g_bQuiet)
+    {
+        return;
+    }
+
+    printf("This application measures the round trip time of a request, the rate\n");
+    printf("at which small updates can be sent when batched without responses,\n");
+    printf("and the rate at which data can be echoed, over the binary command\n");
+    printf("channel of utils/rpc.c.  By default it runs a copy of the channel on\n");
+    printf("the host, connected by a socket, and first checks its handling of\n");
+    printf("batches, streamed responses and errors.  Given a serial port, it\n");
+    printf("measures a device that handles RPC_CMD_ECHO with RPCEcho().\n\n");
+    printf("Supported parameters are:\n\n");
+    printf("-d <dev>  - The serial port of the device.\n");
+    printf("-b <baud> - The baud rate of the serial port (default 115200).\n");
+    printf("-m <cmd>  - A console command that switches the device to the binary\n");
+    printf("            channel, sent before starting.\n");
+    printf("-x <id>   - A command that returns the device to its console, sent\n");
+    printf("            when finished.\n");
+    printf("-n <num>  - The number of requests for each measurement (default\n");
+    printf("            100000 on the host, 1000 for a device).\n");
+    printf("-? or -h  - Show this help.\n");
+    printf("-q        - Quiet mode. Disable output to stdio.\n");
+    printf("-e        - Enable verbose output\n\n");
+    printf("Example:\n\n");
+    printf("   rpcbench -d /dev/ttyACM0 -m rpc -x 4\n\n");
+}
+
+//*****************************************************************************
+//
+// Parse the command line, extracting all parameters.
+//
+// Returns 0 on failure, 1 on success.
+//
+//*****************************************************************************
+int
+ParseCommandLine(int argc, char *argv[])
+{
+    int iRetcode;
+    BOOL bShowHelp;
+
+    //
+    // By default, don't show the help screen.
+    //
+    bShowHelp = FALSE;
+
+    while(1)
+    {
+        //
+        // Get the next command line parameter.
+        //
+        iRetcode = getopt(argc, argv, "d:b:m:x:n:eh?q");
+
+        if(iRetcode == -1)
+        {
+            break;
+        }
+
+        switch(iRetcode)
+        {
+            case 'd':
+                g_pcDevice = optarg;
+                break;
+
+            case 'b':
+                g_ulBaud = strtoul(optarg, NULL, 0);
+                break;
+
+            case 'm':
+                g_pcConsoleCmd = optarg;
+                break;
+
+            case 'x':
+                g_iExitCmd = (int)strtol(optarg, NULL, 0);
+                break;
+
+            case 'n':
+                g_ulIterations = strtoul(optarg, NULL, 0);
+                break;
+
+            case 'e':
+                g_bVerbose = TRUE;
+                break;
+
+            case 'q':
+                g_bQuiet = TRUE;
+                break;
+
+            case '?':
+            case 'h':
+                bShowHelp = TRUE;
+                break;
+        }
+    }
+
+    //
+    // Show the welcome banner unless we have been told to be quiet.
+    //
+    PrintWelcome();
+
+    //
+    // Fewer requests are needed to measure a device, which is far slower.
+    //
+    if(!g_ulIterations)
+    {
+        g_ulIterations = g_pcDevice ? 1000 : 100000;
+    }
+
+    //
+    // Catch various invalid parameter cases.
+    //
+    if(bShowHelp || (g_iExitCmd > 255))
+    {
+        ShowHelp();
+
+        if(g_iExitCmd > 255)
+        {
+            fprintf(stderr, "Command identifiers must be less than 256.\n");
+        }
+
+        return(0);
+    }
+
+    VERBOSEPRINT("Device %s, baud %lu, requests %lu\n",
+                 g_pcDevice ? g_pcDevice : "on host", g_ulBaud,
+                 g_ulIterations);
+
+    return(1);
+}
+
+//*****************************************************************************
+//
+// The main entry point of the utility.
+//
+//*****************************************************************************
+int
+main(int argc, char *argv[])
+{
+    pthread_t sThread;
+    int piFds[2];
+
+    if(!ParseCommandLine(argc, argv))
+    {
+        return(1);
+    }
+
+    if(g_pcDevice)
+    {
+        //
+        // Open the serial port, and switch the device to the binary channel
+        // if asked to, discarding the echo of the command.
+        //
+        if(!RPCClientOpen(&g_sClient, g_pcDevice, g_ulBaud))
+        {
+            return(1);
+        }
+        if(g_pcConsoleCmd)
+        {
+            CHECK(write(g_sClient.iFd, "\r", 1) == 1);
+            CHECK(write(g_sClient.iFd, g_pcConsoleCmd,
+                        strlen(g_pcConsoleCmd)) ==
+                  (ssize_t)strlen(g_pcConsoleCmd));
+            CHECK(write(g_sClient.iFd, "\r", 1) == 1);
+            tcdrain(g_sClient.iFd);
+            usleep(200000);
+            tcflush(g_sClient.iFd, TCIFLUSH);
+        }
+
+        //
+        // Make sure that the device is answering before measuring it.
+        //
+        if(RPCClientCall(&g_sClient, RPC_CMD_ECHO, NULL, 0, NULL, NULL) !=
+           RPC_STATUS_OK)
+        {
+            fflush(stdout);
+            fprintf(stderr, "No response from %s.\n", g_pcDevice);
+            return(1);
+        }
+    }
+    else
+    {
+        //
+        // Run a copy of the channel on another thread, connected by a socket.
+        //
+        if(socketpair(AF_UNIX, SOCK_STREAM, 0, piFds) < 0)
+        {
+            perror("socketpair");
+            return(1);
+        }
+        g_iServerFd = piFds[1];
+        RPCInit(&g_sServer, g_psServerCommands,
+                sizeof(g_psServerCommands) / sizeof(g_psServerCommands[0]),
+                ServerWrite, &g_iServerFd);
+        if(pthread_create(&sThread, NULL, ServerThread, NULL))
+        {
+            fflush(stdout);
+            fprintf(stderr, "Failed to start the server thread.\n");
+            return(1);
+        }
+        RPCClientAttach(&g_sClient, piFds[0]);
+
+        CheckProtocol();
+    }
+
+    MeasureLatency();
+    MeasureUpdates();
+    MeasureThroughput(8);
+    MeasureThroughput(64);
+    MeasureThroughput(MAX_PAYLOAD);
+
+    VERBOSEPRINT("\nFrames discarded by the client: %lu\n", g_sClient.ulErrors);
+
+    if(g_pcDevice)
+    {
+        if(g_iExitCmd >= 0)
+        {
+            g_sClient.ulTxCount = 0;
+            RPCClientAdd(&g_sClient, (unsigned char)g_iExitCmd, NULL, 0);
+            RPCClientSend(&g_sClient, 0);
+            tcdrain(g_sClient.iFd);
+        }
+    }
+    else
+    {
+        shutdown(g_sClient.iFd, SHUT_RDWR);
+        pthread_join(sThread, NULL);
+        close(g_iServerFd);
+    }
+    RPCClientClose(&g_sClient);
+
+    return(0);
+}
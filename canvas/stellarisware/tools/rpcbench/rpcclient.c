@@ -0,0 +1,526 @@
+//*****************************************************************************
+//
+// rpcclient.c - A Linux client for the binary command channel in
+//               utils/rpc.c, for use by host programs that control a device
+//               over a serial port or any other byte stream.
+//
+//*****************************************************************************
+
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <termios.h>
+#include "inc/hw_types.h"
+#include "utils/crc.h"
+#include "utils/rpc.h"
+#include "rpcclient.h"
+
+//*****************************************************************************
+//
+// The number of milliseconds to wait for a response unless changed by the
+// caller.
+//
+//*****************************************************************************
+#define DEFAULT_TIMEOUT         1000
+
+//*****************************************************************************
+//
+// The baud rates that a serial port may be opened at.
+//
+//*****************************************************************************
+static const struct
+{
+    unsigned long ulBaud;
+    speed_t tSpeed;
+}
+g_psBaudRates[] =
+{
+    { 9600, B9600 },
+    { 19200, B19200 },
+    { 38400, B38400 },
+    { 57600, B57600 },
+    { 115200, B115200 },
+    { 230400, B230400 },
+    { 460800, B460800 },
+    { 921600, B921600 },
+    { 1000000, B1000000 },
+    { 2000000, B2000000 },
+    { 3000000, B3000000 }
+};
+
+//*****************************************************************************
+//
+// Opens a serial port, in raw mode at the given baud rate, and connects the
+// client to it.
+//
+// Returns 1 on success, or 0 if the port could not be opened.
+//
+//*****************************************************************************
+int
+RPCClientOpen(tRPCClient *psClient, const char *pcDevice, unsigned long ulBaud)
+{
+    struct termios sTermios;
+    unsigned long ulIdx;
+    int iFd;
+
+    //
+    // Find the baud rate.
+    //
+    for(ulIdx = 0; ulIdx < (sizeof(g_psBaudRates) / sizeof(g_psBaudRates[0]));
+        ulIdx++)
+    {
+        if(g_psBaudRates[ulIdx].ulBaud == ulBaud)
+        {
+            break;
+        }
+    }
+    if(ulIdx == (sizeof(g_psBaudRates) / sizeof(g_psBaudRates[0])))
+    {
+        fprintf(stderr, "Unsupported baud rate %lu.\n", ulBaud);
+        return(0);
+    }
+
+    iFd = open(pcDevice, O_RDWR | O_NOCTTY);
+    if(iFd < 0)
+    {
+        perror(pcDevice);
+        return(0);
+    }
+
+    //
+    // Pass every byte through unchanged, and return from a read with
+    // whatever has arrived.
+    //
+    if(tcgetattr(iFd, &sTermios) < 0)
+    {
+        perror(pcDevice);
+        close(iFd);
+        return(0);
+    }
+    cfmakeraw(&sTermios);
+    sTermios.c_cflag |= CLOCAL | CREAD;
+    sTermios.c_cc[VMIN] = 0;
+    sTermios.c_cc[VTIME] = 0;
+    cfsetispeed(&sTermios, g_psBaudRates[ulIdx].tSpeed);
+    cfsetospeed(&sTermios, g_psBaudRates[ulIdx].tSpeed);
+    if(tcsetattr(iFd, TCSANOW, &sTermios) < 0)
+    {
+        perror(pcDevice);
+        close(iFd);
+        return(0);
+    }
+    tcflush(iFd, TCIOFLUSH);
+
+    RPCClientAttach(psClient, iFd);
+
+    return(1);
+}
+
+//*****************************************************************************
+//
+// Connects the client to a file descriptor that is already open, such as a
+// socket.
+//
+//*****************************************************************************
+void
+RPCClientAttach(tRPCClient *psClient, int iFd)
+{
+    psClient->iFd = iFd;
+    psClient->ulTimeout = DEFAULT_TIMEOUT;
+    psClient->ucSeq = 0;
+    psClient->ulTxCount = 0;
+    psClient->ulRxCount = 0;
+    psClient->bRxEscape = 0;
+    psClient->bRxDiscard = 0;
+    psClient->ulReadCount = 0;
+    psClient->ulReadIndex = 0;
+    psClient->ulErrors = 0;
+}
+
+//*****************************************************************************
+//
+// Closes the connection to the device.
+//
+//*****************************************************************************
+void
+RPCClientClose(tRPCClient *psClient)
+{
+    if(psClient->iFd >= 0)
+    {
+        close(psClient->iFd);
+        psClient->iFd = -1;
+    }
+}
+
+//*****************************************************************************
+//
+// Adds a request to the frame being built.
+//
+// Returns 1 on success, or 0 if the payload is too long or there is no room
+// for it in the frame, in which case the frame should be sent first.
+//
+//*****************************************************************************
+int
+RPCClientAdd(tRPCClient *psClient, unsigned char ucCmd, const void *pvData,
+             unsigned long ulLen)
+{
+    //
+    // Leave room for the frame header at the start.
+    //
+    if(!psClient->ulTxCount)
+    {
+        psClient->ulTxCount = 2;
+    }
+
+    //
+    // Leave room for the CRC at the end.
+    //
+    if((ulLen > 255) || ((psClient->ulTxCount + 2 + ulLen + 2) > RPC_MAX_FRAME))
+    {
+        return(0);
+    }
+
+    psClient->pucTxFrame[psClient->ulTxCount++] = ucCmd;
+    psClient->pucTxFrame[psClient->ulTxCount++] = (unsigned char)ulLen;
+    if(ulLen)
+    {
+        memcpy(psClient->pucTxFrame + psClient->ulTxCount, pvData, ulLen);
+    }
+    psClient->ulTxCount += ulLen;
+
+    return(1);
+}
+
+//*****************************************************************************
+//
+// Writes a buffer to the device in full.
+//
+// Returns 1 on success, or 0 on error.
+//
+//*****************************************************************************
+static int
+WriteAll(int iFd, const unsigned char *pucData, unsigned long ulLen)
+{
+    ssize_t iCount;
+
+    while(ulLen)
+    {
+        iCount = write(iFd, pucData, ulLen);
+        if(iCount <= 0)
+        {
+            perror("write");
+            return(0);
+        }
+        pucData += iCount;
+        ulLen -= iCount;
+    }
+
+    return(1);
+}
+
+//*****************************************************************************
+//
+// Sends the frame that has been built, which may be empty.  If bResponse is
+// zero the device is asked to send no response, and the caller must not
+// wait for one.
+//
+// Returns 1 on success, or 0 on error.
+//
+//*****************************************************************************
+int
+RPCClientSend(tRPCClient *psClient, int bResponse)
+{
+    unsigned char pucWire[(RPC_MAX_FRAME * 2) + 2], ucByte;
+    unsigned long ulIdx, ulCount;
+    unsigned short usCrc;
+
+    if(!psClient->ulTxCount)
+    {
+        psClient->ulTxCount = 2;
+    }
+
+    psClient->pucTxFrame[0] = ++psClient->ucSeq;
+    psClient->pucTxFrame[1] = bResponse ? 0 : RPC_FLAG_NO_RESPONSE;
+    usCrc = Crc16(0, psClient->pucTxFrame, psClient->ulTxCount);
+    psClient->pucTxFrame[psClient->ulTxCount++] = usCrc & 0xff;
+    psClient->pucTxFrame[psClient->ulTxCount++] = usCrc >> 8;
+
+    //
+    // Escape the frame and put it between two RPC_END bytes.
+    //
+    ulCount = 0;
+    pucWire[ulCount++] = RPC_END;
+    for(ulIdx = 0; ulIdx < psClient->ulTxCount; ulIdx++)
+    {
+        ucByte = psClient->pucTxFrame[ulIdx];
+        if(ucByte == RPC_END)
+        {
+            pucWire[ulCount++] = RPC_ESC;
+            pucWire[ulCount++] = RPC_ESC_END;
+        }
+        else if(ucByte == RPC_ESC)
+        {
+            pucWire[ulCount++] = RPC_ESC;
+            pucWire[ulCount++] = RPC_ESC_ESC;
+        }
+        else
+        {
+            pucWire[ulCount++] = ucByte;
+        }
+    }
+    pucWire[ulCount++] = RPC_END;
+
+    psClient->ulTxCount = 0;
+
+    return(WriteAll(psClient->iFd, pucWire, ulCount));
+}
+
+//*****************************************************************************
+//
+// Reads the next byte from the device, waiting up to the timeout for it.
+//
+// Returns the byte, or -1 on timeout or error.
+//
+//*****************************************************************************
+static int
+ReadByte(tRPCClient *psClient)
+{
+    struct pollfd sPoll;
+    ssize_t iCount;
+
+    if(psClient->ulReadIndex == psClient->ulReadCount)
+    {
+        sPoll.fd = psClient->iFd;
+        sPoll.events = POLLIN;
+        if(poll(&sPoll, 1, (int)psClient->ulTimeout) <= 0)
+        {
+            return(-1);
+        }
+
+        iCount = read(psClient->iFd, psClient->pucRead,
+                      sizeof(psClient->pucRead));
+        if(iCount <= 0)
+        {
+            return(-1);
+        }
+        psClient->ulReadCount = iCount;
+        psClient->ulReadIndex = 0;
+    }
+
+    return(psClient->pucRead[psClient->ulReadIndex++]);
+}
+
+//*****************************************************************************
+//
+// Reads the next frame from the device that is intact and is a response to
+// the last frame sent.  Frames that are corrupt, or are responses to
+// earlier frames that were given up on, are counted and skipped.
+//
+// Returns the length of the frame without its CRC, or 0 on timeout.
+//
+//*****************************************************************************
+static unsigned long
+ReadFrame(tRPCClient *psClient)
+{
+    unsigned long ulCount;
+    unsigned char *pucFrame;
+    int iByte;
+
+    pucFrame = psClient->pucRxFrame;
+    while(1)
+    {
+        iByte = ReadByte(psClient);
+        if(iByte < 0)
+        {
+            return(0);
+        }
+
+        if(iByte == RPC_END)
+        {
+            ulCount = psClient->ulRxCount;
+            psClient->ulRxCount = 0;
+            if(psClient->bRxDiscard || psClient->bRxEscape)
+            {
+                psClient->bRxDiscard = 0;
+                psClient->bRxEscape = 0;
+                psClient->ulErrors++;
+                continue;
+            }
+            if(!ulCount)
+            {
+                continue;
+            }
+            if((ulCount < 4) ||
+               (Crc16(0, pucFrame, ulCount - 2) !=
+                (pucFrame[ulCount - 2] | (pucFrame[ulCount - 1] << 8))) ||
+               (pucFrame[0] != psClient->ucSeq))
+            {
+                psClient->ulErrors++;
+                continue;
+            }
+            return(ulCount - 2);
+        }
+
+        if(psClient->bRxEscape)
+        {
+            psClient->bRxEscape = 0;
+            if(iByte == RPC_ESC_END)
+            {
+                iByte = RPC_END;
+            }
+            else if(iByte == RPC_ESC_ESC)
+            {
+                iByte = RPC_ESC;
+            }
+            else
+            {
+                psClient->bRxDiscard = 1;
+            }
+        }
+        else if(iByte == RPC_ESC)
+        {
+            psClient->bRxEscape = 1;
+            continue;
+        }
+
+        if(psClient->ulRxCount < RPC_MAX_FRAME)
+        {
+            pucFrame[psClient->ulRxCount++] = (unsigned char)iByte;
+        }
+        else
+        {
+            psClient->bRxDiscard = 1;
+        }
+    }
+}
+
+//*****************************************************************************
+//
+// Receives the responses to the last frame sent, calling the callback for
+// each in turn, until the last frame of responses has been received.
+//
+// Returns 1 on success, or 0 on timeout or if a response is malformed.
+//
+//*****************************************************************************
+int
+RPCClientReceive(tRPCClient *psClient, tRPCClientCallback pfnCallback,
+                 void *pvData)
+{
+    unsigned long ulOffset, ulLen, ulFrameLen;
+    unsigned char *pucFrame;
+
+    pucFrame = psClient->pucRxFrame;
+    while(1)
+    {
+        ulFrameLen = ReadFrame(psClient);
+        if(!ulFrameLen)
+        {
+            return(0);
+        }
+
+        for(ulOffset = 2; ulOffset < ulFrameLen; ulOffset += ulLen)
+        {
+            if((ulOffset + 3) > ulFrameLen)
+            {
+                return(0);
+            }
+            ulLen = pucFrame[ulOffset + 2];
+            if((ulOffset + 3 + ulLen) > ulFrameLen)
+            {
+                return(0);
+            }
+            if(pfnCallback)
+            {
+                pfnCallback(pvData, pucFrame[ulOffset], pucFrame[ulOffset + 1],
+                            pucFrame + ulOffset + 3, ulLen);
+            }
+            ulOffset += 3;
+        }
+
+        if(!(pucFrame[1] & RPC_FLAG_MORE))
+        {
+            return(1);
+        }
+    }
+}
+
+//*****************************************************************************
+//
+// The state of a call made by RPCClientCall().
+//
+//*****************************************************************************
+typedef struct
+{
+    unsigned char *pucResponse;
+    unsigned long ulSize;
+    unsigned long ulLen;
+    int iStatus;
+}
+tCallState;
+
+//*****************************************************************************
+//
+// Collects the parts of the response to a call.
+//
+//*****************************************************************************
+static void
+CallCallback(void *pvData, unsigned char ucCmd, unsigned char ucStatus,
+             const unsigned char *pucData, unsigned long ulLen)
+{
+    tCallState *psState;
+
+    psState = pvData;
+    if(ulLen > (psState->ulSize - psState->ulLen))
+    {
+        ulLen = psState->ulSize - psState->ulLen;
+    }
+    if(ulLen)
+    {
+        memcpy(psState->pucResponse + psState->ulLen, pucData, ulLen);
+    }
+    psState->ulLen += ulLen;
+    psState->iStatus = ucStatus;
+}
+
+//*****************************************************************************
+//
+// Sends one request, discarding any others that have been added but not
+// sent, and waits for the response.  On entry *pulResponseLen is the size of
+// the response buffer, and on return it is the length of the response,
+// which is truncated to fit the buffer.
+//
+// Returns the status of the response, or -1 on timeout or error.
+//
+//*****************************************************************************
+int
+RPCClientCall(tRPCClient *psClient, unsigned char ucCmd, const void *pvData,
+              unsigned long ulLen, void *pvResponse,
+              unsigned long *pulResponseLen)
+{
+    tCallState sState;
+
+    psClient->ulTxCount = 0;
+    if(!RPCClientAdd(psClient, ucCmd, pvData, ulLen) ||
+       !RPCClientSend(psClient, 1))
+    {
+        return(-1);
+    }
+
+    sState.pucResponse = pvResponse;
+    sState.ulSize = pulResponseLen ? *pulResponseLen : 0;
+    sState.ulLen = 0;
+    sState.iStatus = -1;
+    if(!RPCClientReceive(psClient, CallCallback, &sState))
+    {
+        return(-1);
+    }
+
+    if(pulResponseLen)
+    {
+        *pulResponseLen = sState.ulLen;
+    }
+
+    return(sState.iStatus);
+}
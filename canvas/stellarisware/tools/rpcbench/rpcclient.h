@@ -0,0 +1,106 @@
+//*****************************************************************************
+//
+// rpcclient.h - Prototypes for the Linux client of the binary command channel
+//               in utils/rpc.c.
+//
+//*****************************************************************************
+
+#ifndef __RPCCLIENT_H__
+#define __RPCCLIENT_H__
+
+//*****************************************************************************
+//
+// The client uses the frame format and limits of the device.
+//
+//*****************************************************************************
+#include "inc/hw_types.h"
+#include "utils/rpc.h"
+
+//*****************************************************************************
+//
+// The number of bytes read from the device at a time.
+//
+//*****************************************************************************
+#define RPC_CLIENT_READ_SIZE    4096
+
+//*****************************************************************************
+//
+// The state of a connection to a device.
+//
+//*****************************************************************************
+typedef struct
+{
+    //
+    // The file descriptor of the serial port or socket.
+    //
+    int iFd;
+
+    //
+    // The number of milliseconds to wait for a response.
+    //
+    unsigned long ulTimeout;
+
+    //
+    // The sequence number of the last frame sent.
+    //
+    unsigned char ucSeq;
+
+    //
+    // The frame of requests being built, and the number of bytes in it.
+    //
+    unsigned char pucTxFrame[RPC_MAX_FRAME];
+    unsigned long ulTxCount;
+
+    //
+    // The frame being received, the number of bytes in it, and whether the
+    // last byte was RPC_ESC or the frame is to be discarded.
+    //
+    unsigned char pucRxFrame[RPC_MAX_FRAME];
+    unsigned long ulRxCount;
+    int bRxEscape;
+    int bRxDiscard;
+
+    //
+    // The bytes read from the device that have not yet been decoded.
+    //
+    unsigned char pucRead[RPC_CLIENT_READ_SIZE];
+    unsigned long ulReadCount;
+    unsigned long ulReadIndex;
+
+    //
+    // The number of frames discarded because they were corrupt, or were the
+    // response to an earlier request.
+    //
+    unsigned long ulErrors;
+}
+tRPCClient;
+
+//*****************************************************************************
+//
+// The function called for each response in a frame.
+//
+//*****************************************************************************
+typedef void (*tRPCClientCallback)(void *pvData, unsigned char ucCmd,
+                                   unsigned char ucStatus,
+                                   const unsigned char *pucData,
+                                   unsigned long ulLen);
+
+//*****************************************************************************
+//
+// Prototypes for the APIs.
+//
+//*****************************************************************************
+extern int RPCClientOpen(tRPCClient *psClient, const char *pcDevice,
+                         unsigned long ulBaud);
+extern void RPCClientAttach(tRPCClient *psClient, int iFd);
+extern void RPCClientClose(tRPCClient *psClient);
+extern int RPCClientAdd(tRPCClient *psClient, unsigned char ucCmd,
+                        const void *pvData, unsigned long ulLen);
+extern int RPCClientSend(tRPCClient *psClient, int bResponse);
+extern int RPCClientReceive(tRPCClient *psClient,
+                            tRPCClientCallback pfnCallback, void *pvData);
+extern int RPCClientCall(tRPCClient *psClient, unsigned char ucCmd,
+                         const void *pvData, unsigned long ulLen,
+                         void *pvResponse, unsigned long *pulResponseLen);
+
+#endif // __RPCCLIENT_H__
@@ -0,0 +1,815 @@
+//*****************************************************************************
+//
+// spectrumbench.c - A command line utility that builds utils/samplefifo.c and
+//                   utils/spectrum.c for the host, feeds them the samples of
+//                   a WAV file one USB audio packet at a time, and reports
+//                   the time taken by each stage for every packet and every
+//                   display frame.
+//
+//*****************************************************************************
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+#include "inc/hw_types.h"
+#include "utils/samplefifo.h"
+#include "utils/spectrum.h"
+
+typedef unsigned char BOOL;
+#define FALSE 0
+#define TRUE  1
+
+//*****************************************************************************
+//
+// The largest number of channels and FIFO slots supported.
+//
+//*****************************************************************************
+#define MAX_CHANNELS            8
+#define MAX_SLOTS               256
+
+//*****************************************************************************
+//
+// The rate and length of the tone generated when no WAV file is given.
+//
+//*****************************************************************************
+#define TONE_RATE               48000
+#define TONE_SECONDS            2
+
+//*****************************************************************************
+//
+// Globals controlled by various command line parameters.
+//
+//*****************************************************************************
+BOOL g_bVerbose               = FALSE;
+BOOL g_bQuiet                 = FALSE;
+char *g_pcFile                = NULL;
+unsigned long g_ulTone        = 1000;
+unsigned long g_ulSlots       = 8;
+unsigned long g_ulDrain       = 4;
+unsigned long g_ulDisplay     = 16;
+unsigned long g_ulBands       = 16;
+
+//*****************************************************************************
+//
+// Helpful macros for generating output depending upon verbose and quiet flags.
+//
+//*****************************************************************************
+#define VERBOSEPRINT(...) if(g_bVerbose) { printf(__VA_ARGS__); }
+#define QUIETPRINT(...) if(!g_bQuiet) { printf(__VA_ARGS__); }
+
+//*****************************************************************************
+//
+// Counts a check and reports it if it fails.
+//
+//*****************************************************************************
+static unsigned long g_ulFailed = 0;
+
+#define CHECK(bCond, ...)                                                     \
+    if(!(bCond))                                                              \
+    {                                                                         \
+        g_ulFailed++;                                                         \
+        QUIETPRINT("FAIL: " __VA_ARGS__);                                     \
+    }
+
+//*****************************************************************************
+//
+// The audio being played, as interleaved signed 16-bit samples.
+//
+//*****************************************************************************
+static short *g_psSamples;
+static unsigned long g_ulNumFrames;
+static unsigned long g_ulNumChannels;
+static unsigned long g_ulRate;
+
+//*****************************************************************************
+//
+// The timings of one stage of the pipeline.
+//
+//*****************************************************************************
+typedef struct
+{
+    const char *pcName;
+    unsigned long ulCount;
+    unsigned long ulMax;
+    unsigned long long *pullNs;
+    unsigned long long ullCycles;
+}
+tStage;
+
+//*****************************************************************************
+//
+// Returns the time in nanoseconds from an arbitrary point.
+//
+//*****************************************************************************
+static unsigned long long
+Nanoseconds(void)
+{
+    struct timespec sTime;
+
+    clock_gettime(CLOCK_MONOTONIC, &sTime);
+
+    return(((unsigned long long)sTime.tv_sec * 1000000000ULL) +
+           sTime.tv_nsec);
+}
+
+//*****************************************************************************
+//
+// Returns the processor's cycle count, where it can be read.
+//
+//*****************************************************************************
+static unsigned long long
+Cycles(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+    return(__rdtsc());
+#else
+    return(0);
+#endif
+}
+
+//*****************************************************************************
+//
+// Reads a little endian value from a WAV header.
+//
+//*****************************************************************************
+static unsigned long
+ReadLE(const unsigned char *pucData, unsigned long ulBytes)
+{
+    unsigned long ulValue;
+
+    ulValue = 0;
+    while(ulBytes--)
+    {
+        ulValue = (ulValue << 8) | pucData[ulBytes];
+    }
+
+    return(ulValue);
+}
+
+//*****************************************************************************
+//
+// Reads a 16-bit PCM WAV file into g_psSamples.  Returns TRUE on success.
+//
+//*****************************************************************************
+static BOOL
+ReadWAVFile(const char *pcFile)
+{
+    FILE *fhWAV;
+    unsigned char pucHeader[16];
+    unsigned long ulSize, ulFormat, ulBits, ulIdx;
+    BOOL bFormat;
+
+    fhWAV = fopen(pcFile, "rb");
+    if(!fhWAV)
+    {
+        fprintf(stderr, "Unable to open %s.\n", pcFile);
+        return(FALSE);
+    }
+
+    if((fread(pucHeader, 1, 12, fhWAV) != 12) ||
+       memcmp(pucHeader, "RIFF", 4) || memcmp(pucHeader + 8, "WAVE", 4))
+    {
+        fprintf(stderr, "%s is not a WAV file.\n", pcFile);
+        fclose(fhWAV);
+        return(FALSE);
+    }
+
+    //
+    // Walk the chunks until the data is found, noting the format on the
+    // way.
+    //
+    bFormat = FALSE;
+    while(fread(pucHeader, 1, 8, fhWAV) == 8)
+    {
+        ulSize = ReadLE(pucHeader + 4, 4);
+
+        if(!memcmp(pucHeader, "fmt ", 4) && (ulSize >= 16))
+        {
+            if(fread(pucHeader, 1, 16, fhWAV) != 16)
+            {
+                break;
+            }
+            ulFormat = ReadLE(pucHeader, 2);
+            g_ulNumChannels = ReadLE(pucHeader + 2, 2);
+            g_ulRate = ReadLE(pucHeader + 4, 4);
+            ulBits = ReadLE(pucHeader + 14, 2);
+
+            //
+            // Accept plain PCM and the extensible format, which is used for
+            // more than two channels.
+            //
+            if(((ulFormat != 1) && (ulFormat != 0xfffe)) || (ulBits != 16) ||
+               (g_ulNumChannels == 0) || (g_ulNumChannels > MAX_CHANNELS) ||
+               (g_ulRate < 1000))
+            {
+                fprintf(stderr, "%s is not 16-bit PCM with up to %d "
+                        "channels.\n", pcFile, MAX_CHANNELS);
+                fclose(fhWAV);
+                return(FALSE);
+            }
+            bFormat = TRUE;
+            ulSize -= 16;
+        }
+        else if(!memcmp(pucHeader, "data", 4) && bFormat)
+        {
+            g_ulNumFrames = ulSize / (2 * g_ulNumChannels);
+            g_psSamples = malloc(g_ulNumFrames * 2 * g_ulNumChannels);
+            if(!g_psSamples ||
+               (fread(g_psSamples, 2 * g_ulNumChannels, g_ulNumFrames,
+                      fhWAV) != g_ulNumFrames))
+            {
+                fprintf(stderr, "Unable to read the samples in %s.\n",
+                        pcFile);
+                fclose(fhWAV);
+                return(FALSE);
+            }
+
+            //
+            // The samples are little endian, so swap them on a big endian
+            // host.
+            //
+            for(ulIdx = 0; ulIdx < g_ulNumFrames * g_ulNumChannels; ulIdx++)
+            {
+                g_psSamples[ulIdx] =
+                    (short)ReadLE((unsigned char *)&g_psSamples[ulIdx], 2);
+            }
+
+            fclose(fhWAV);
+            return(TRUE);
+        }
+
+        //
+        // Skip the rest of this chunk, which is padded to an even size.
+        //
+        if(fseek(fhWAV, ulSize + (ulSize & 1), SEEK_CUR))
+        {
+            break;
+        }
+    }
+
+    fprintf(stderr, "%s has no 16-bit PCM data.\n", pcFile);
+    fclose(fhWAV);
+
+    return(FALSE);
+}
+
+//*****************************************************************************
+//
+// Generates a stereo tone at half of full scale in place of a WAV file.
+//
+//*****************************************************************************
+static BOOL
+GenerateTone(void)
+{
+    unsigned long ulIdx;
+    unsigned long ulPhase, ulStep;
+
+    g_ulRate = TONE_RATE;
+    g_ulNumChannels = 2;
+    g_ulNumFrames = TONE_RATE * TONE_SECONDS;
+    g_psSamples = malloc(g_ulNumFrames * 2 * g_ulNumChannels);
+    if(!g_psSamples)
+    {
+        return(FALSE);
+    }
+
+    //
+    // Use a triangle wave, whose fundamental holds 81% of its power, so that
+    // the check does not depend on the sine table under test.
+    //
+    ulStep = (unsigned long)(((unsigned long long)g_ulTone << 32) / g_ulRate);
+    ulPhase = 0;
+    for(ulIdx = 0; ulIdx < g_ulNumFrames; ulIdx++)
+    {
+        long lValue;
+
+        lValue = (long)(ulPhase >> 16) - 32768;
+        lValue = (lValue < 0) ? -lValue : lValue;
+        lValue = (lValue - 16384);
+        g_psSamples[ulIdx * 2] = (short)lValue;
+        g_psSamples[(ulIdx * 2) + 1] = (short)lValue;
+        ulPhase = (ulPhase + ulStep) & 0xffffffff;
+    }
+
+    return(TRUE);
+}
+
+//*****************************************************************************
+//
+// Records the time taken by one run of a stage.
+//
+//*****************************************************************************
+static void
+StageRecord(tStage *psStage, unsigned long long ullNs,
+            unsigned long long ullCycles)
+{
+    if(psStage->ulCount < psStage->ulMax)
+    {
+        psStage->pullNs[psStage->ulCount++] = ullNs;
+        psStage->ullCycles += ullCycles;
+    }
+}
+
+//*****************************************************************************
+//
+// Orders two timings for qsort().
+//
+//*****************************************************************************
+static int
+CompareTimes(const void *pvA, const void *pvB)
+{
+    unsigned long long ullA, ullB;
+
+    ullA = *(const unsigned long long *)pvA;
+    ullB = *(const unsigned long long *)pvB;
+
+    return((ullA > ullB) - (ullA < ullB));
+}
+
+//*****************************************************************************
+//
+// Prints the distribution of the times taken by a stage.
+//
+//*****************************************************************************
+static void
+StagePrint(tStage *psStage)
+{
+    unsigned long long ullTotal;
+    unsigned long ulIdx, ulCount;
+
+    ulCount = psStage->ulCount;
+    if(ulCount == 0)
+    {
+        QUIETPRINT("%-22s %8s\n", psStage->pcName, "-");
+        return;
+    }
+
+    qsort(psStage->pullNs, ulCount, sizeof(unsigned long long),
+          CompareTimes);
+
+    for(ulIdx = 0, ullTotal = 0; ulIdx < ulCount; ulIdx++)
+    {
+        ullTotal += psStage->pullNs[ulIdx];
+    }
+
+    QUIETPRINT("%-22s %8lu %8.0f %8llu %8llu %8llu %10.0f\n",
+               psStage->pcName, ulCount, (double)ullTotal / ulCount,
+               psStage->pullNs[ulCount / 2],
+               psStage->pullNs[(ulCount * 99) / 100],
+               psStage->pullNs[ulCount - 1],
+               (double)psStage->ullCycles / ulCount);
+}
+
+//*****************************************************************************
+//
+// Reads every slot in the FIFO into the analyzer, as the application does
+// from its main loop, and checks that each slot holds the samples which
+// follow ulConsumed if bCheck is set.  Returns the number of bytes read.
+//
+//*****************************************************************************
+static unsigned long
+Drain(tSampleFIFO *psFIFO, tSpectrum *psSpectrum, unsigned long ulConsumed,
+      BOOL bCheck, tStage *psStages)
+{
+    unsigned long long pullNs[4], pullCycles[4];
+    unsigned char *pucSlot;
+    unsigned long ulNumBytes, ulTotal;
+
+    ulTotal = 0;
+
+    while(1)
+    {
+        pullCycles[0] = Cycles();
+        pullNs[0] = Nanoseconds();
+        pucSlot = SampleFIFOReadSlotGet(psFIFO, &ulNumBytes);
+        pullNs[1] = Nanoseconds();
+        pullCycles[1] = Cycles();
+        if(!pucSlot)
+        {
+            break;
+        }
+
+        SpectrumSamplesAdd(psSpectrum, (short *)pucSlot,
+                           ulNumBytes / (2 * g_ulNumChannels),
+                           g_ulNumChannels);
+        StageRecord(&psStages[2], Nanoseconds() - pullNs[1],
+                    Cycles() - pullCycles[1]);
+
+        if(bCheck)
+        {
+            CHECK(memcmp(pucSlot,
+                         (unsigned char *)g_psSamples + ulConsumed + ulTotal,
+                         ulNumBytes) == 0,
+                  "The slot at byte %lu is corrupt.\n",
+                  ulConsumed + ulTotal);
+        }
+        ulTotal += ulNumBytes;
+
+        pullCycles[2] = Cycles();
+        pullNs[2] = Nanoseconds();
+        SampleFIFOReadSlotRelease(psFIFO);
+        pullNs[3] = Nanoseconds();
+        pullCycles[3] = Cycles();
+
+        //
+        // The FIFO's share is getting the slot and releasing it.
+        //
+        StageRecord(&psStages[1],
+                    (pullNs[1] - pullNs[0]) + (pullNs[3] - pullNs[2]),
+                    (pullCycles[1] - pullCycles[0]) +
+                    (pullCycles[3] - pullCycles[2]));
+    }
+
+    return(ulTotal);
+}
+
+//*****************************************************************************
+//
+// Prints the band levels of a spectrum as a row of bars.
+//
+//*****************************************************************************
+static void
+PrintBands(unsigned long ulFrame, const unsigned short *pusBands)
+{
+    static const char pcBars[] = " .:-=+*#%@";
+    unsigned long ulBand, ulLevel;
+
+    printf("%6lu ms |", ulFrame);
+    for(ulBand = 0; ulBand < g_ulBands; ulBand++)
+    {
+        //
+        // SpectrumLevel() is a 4.4 base two logarithm, so show the top
+        // nine octaves.
+        //
+        ulLevel = SpectrumLevel(pusBands[ulBand]) >> 4;
+        ulLevel = (ulLevel > 6) ? (ulLevel - 6) : 0;
+        printf("%c", pcBars[(ulLevel > 9) ? 9 : ulLevel]);
+    }
+    printf("|\n");
+}
+
+//*****************************************************************************
+//
+// Print the welcome banner.
+//
+//*****************************************************************************
+void
+PrintWelcome(void)
+{
+    QUIETPRINT("\nspectrumbench - Time the USB audio sample FIFO and "
+               "spectrum analyzer.\n\n");
+}
+
+//*****************************************************************************
+//
+// Show help on the application's command line parameters.
+//
+//*****************************************************************************
+void
+ShowHelp(void)
+{
+    //
+    // Only print help if we are not in quiet mode.
+    //
+    if(g_bQuiet)
+    {
+        return;
+    }
+
+    printf("This application builds utils/samplefifo.c and\n");
+    printf("utils/spectrum.c for the host and plays the samples of a 16-bit\n");
+    printf("PCM WAV file through them as a USB audio device would, one\n");
+    printf("packet per millisecond.  Each packet is committed to the FIFO\n");
+    printf("as the USBD_AUDIO_EVENT_DATAOUT callback would, the FIFO is\n");
+    printf("drained into the analyzer every few packets, and a spectrum is\n");
+    printf("computed for each display frame.  It checks that the analyzer\n");
+    printf("sees every sample in order and reports the time taken by each\n");
+    printf("stage.  Without a WAV file, a tone is played and its band is\n");
+    printf("checked.  Times are for the host and include the overhead of\n");
+    printf("reading the clock, so only the ratio between them carries over\n");
+    printf("to a target.\n\n");
+    printf("Supported parameters are:\n\n");
+    printf("-f <file> - Play the given WAV file.\n");
+    printf("-t <hz>   - Play a tone of the given frequency if there is no\n");
+    printf("            WAV file (default 1000).\n");
+    printf("-s <num>  - Use a FIFO of the given number of slots, a power of\n");
+    printf("            two up to %d (default 8).\n", MAX_SLOTS);
+    printf("-c <num>  - Drain the FIFO every given number of packets\n");
+    printf("            (default 4).\n");
+    printf("-d <num>  - Compute a spectrum every given number of packets\n");
+    printf("            (default 16).\n");
+    printf("-b <num>  - Divide the spectrum into the given number of bands,\n");
+    printf("            up to %d (default 16).\n", SPECTRUM_MAX_BANDS);
+    printf("-? or -h  - Show this help.\n");
+    printf("-q        - Quiet mode. Disable output to stdio.\n");
+    printf("-e        - Enable verbose output, showing each spectrum.\n\n");
+    printf("Example:\n\n");
+    printf("   spectrumbench -f music.wav -e\n\n");
+}
+
+//*****************************************************************************
+//
+// Parse the command line, extracting all parameters.
+//
+// Returns 0 on failure, 1 on success.
+//
+//*****************************************************************************
+int
+ParseCommandLine(int argc, char *argv[])
+{
+    int iRetcode;
+    BOOL bShowHelp;
+
+    //
+    // By default, don't show the help screen.
+    //
+    bShowHelp = FALSE;
+
+    while(1)
+    {
+        //
+        // Get the next command line parameter.
+        //
+        iRetcode = getopt(argc, argv, "f:t:s:c:d:b:eh?q");
+
+        if(iRetcode == -1)
+        {
+            break;
+        }
+
+        switch(iRetcode)
+        {
+            case 'f':
+                g_pcFile = optarg;
+                break;
+
+            case 't':
+                g_ulTone = strtoul(optarg, NULL, 0);
+                break;
+
+            case 's':
+                g_ulSlots = strtoul(optarg, NULL, 0);
+                break;
+
+            case 'c':
+                g_ulDrain = strtoul(optarg, NULL, 0);
+                break;
+
+            case 'd':
+                g_ulDisplay = strtoul(optarg, NULL, 0);
+                break;
+
+            case 'b':
+                g_ulBands = strtoul(optarg, NULL, 0);
+                break;
+
+            case 'e':
+                g_bVerbose = TRUE;
+                break;
+
+            case 'q':
+                g_bQuiet = TRUE;
+                break;
+
+            case '?':
+            case 'h':
+                bShowHelp = TRUE;
+                break;
+        }
+    }
+
+    //
+    // Show the welcome banner unless we have been told to be quiet.
+    //
+    PrintWelcome();
+
+    //
+    // Catch various invalid parameter cases.
+    //
+    if(bShowHelp || (g_ulSlots == 0) || (g_ulSlots > MAX_SLOTS) ||
+       (g_ulSlots & (g_ulSlots - 1)) || (g_ulDrain == 0) ||
+       (g_ulDisplay == 0) || (g_ulBands == 0) ||
+       (g_ulBands > SPECTRUM_MAX_BANDS) || (g_ulTone == 0) ||
+       (g_ulTone >= TONE_RATE / 2) || (optind != argc))
+    {
+        ShowHelp();
+        return(0);
+    }
+
+    return(1);
+}
+
+//*****************************************************************************
+//
+// The main entry point of the application.
+//
+//*****************************************************************************
+int
+main(int argc, char *argv[])
+{
+    static tSpectrum sSpectrum;
+    tSampleFIFO sFIFO;
+    unsigned char *pucSlots, *pucSlot;
+    unsigned short *pusNumBytes;
+    unsigned short pusBands[SPECTRUM_MAX_BANDS];
+    unsigned short pusPeak[SPECTRUM_MAX_BANDS];
+    unsigned long ulFrameBytes, ulSlotSize, ulPacket, ulNumPackets;
+    unsigned long ulOffset, ulConsumed, ulNumBytes, ulOverruns, ulBand;
+    unsigned long ulToneBand, ulBin;
+    unsigned long long ullStart, ullStartCycles;
+    tStage psStages[4];
+
+    if(!ParseCommandLine(argc, argv))
+    {
+        return(1);
+    }
+
+    if(g_pcFile ? !ReadWAVFile(g_pcFile) : !GenerateTone())
+    {
+        return(1);
+    }
+
+    //
+    // Each slot holds one USB packet, the samples of one millisecond, and
+    // the last packet may be short.
+    //
+    ulFrameBytes = 2 * g_ulNumChannels;
+    ulSlotSize = ((g_ulRate + 999) / 1000) * ulFrameBytes;
+    ulNumPackets = ((g_ulNumFrames * 1000) + g_ulRate - 1) / g_ulRate;
+
+    QUIETPRINT("%s: %lu Hz, %lu channels, %lu ms.\n",
+               g_pcFile ? g_pcFile : "Tone", g_ulRate, g_ulNumChannels,
+               ulNumPackets);
+    QUIETPRINT("%lu slots of %lu bytes, drained every %lu packets, %lu "
+               "bands every %lu packets.\n\n", g_ulSlots, ulSlotSize,
+               g_ulDrain, g_ulBands, g_ulDisplay);
+
+    pucSlots = malloc(g_ulSlots * ulSlotSize);
+    pusNumBytes = malloc(g_ulSlots * sizeof(unsigned short));
+    psStages[0].pcName = "FIFO write, packet";
+    psStages[1].pcName = "FIFO read, packet";
+    psStages[2].pcName = "Samples add, packet";
+    psStages[3].pcName = "Spectrum, frame";
+    for(ulBand = 0; ulBand < 4; ulBand++)
+    {
+        psStages[ulBand].ulCount = 0;
+        psStages[ulBand].ulMax = ulNumPackets;
+        psStages[ulBand].ullCycles = 0;
+        psStages[ulBand].pullNs = malloc(ulNumPackets *
+                                         sizeof(unsigned long long));
+        if(!psStages[ulBand].pullNs)
+        {
+            pucSlots = 0;
+        }
+    }
+    if(!pucSlots || !pusNumBytes)
+    {
+        fprintf(stderr, "Unable to allocate memory.\n");
+        return(1);
+    }
+
+    SampleFIFOInit(&sFIFO, pucSlots, pusNumBytes, g_ulSlots, ulSlotSize);
+    SpectrumInit(&sSpectrum, g_ulBands);
+    memset(pusPeak, 0, sizeof(pusPeak));
+
+    ulOffset = 0;
+    ulConsumed = 0;
+    ulOverruns = 0;
+
+    for(ulPacket = 0; ulPacket < ulNumPackets; ulPacket++)
+    {
+        //
+        // The USB audio device receives the next packet.  The copy stands in
+        // for the USB DMA filling the slot, so it is not timed.
+        //
+        ulNumBytes = ((((ulPacket + 1) * g_ulRate) / 1000) -
+                      ((ulPacket * g_ulRate) / 1000)) * ulFrameBytes;
+        if(ulOffset + ulNumBytes > g_ulNumFrames * ulFrameBytes)
+        {
+            ulNumBytes = (g_ulNumFrames * ulFrameBytes) - ulOffset;
+        }
+
+        ullStartCycles = Cycles();
+        ullStart = Nanoseconds();
+        pucSlot = SampleFIFOWriteSlotGet(&sFIFO);
+        if(pucSlot)
+        {
+            memcpy(pucSlot, (unsigned char *)g_psSamples + ulOffset,
+                   ulNumBytes);
+            SampleFIFOWriteSlotCommit(&sFIFO, ulNumBytes);
+            StageRecord(&psStages[0], Nanoseconds() - ullStart,
+                        Cycles() - ullStartCycles);
+        }
+        else
+        {
+            ulOverruns++;
+        }
+        ulOffset += ulNumBytes;
+
+        //
+        // The application drains the FIFO into the analyzer.
+        //
+        if(((ulPacket + 1) % g_ulDrain) == 0)
+        {
+            ulConsumed += Drain(&sFIFO, &sSpectrum, ulConsumed,
+                                ulOverruns == 0, psStages);
+        }
+
+        //
+        // The display asks for a spectrum.
+        //
+        if(((ulPacket + 1) % g_ulDisplay) == 0)
+        {
+            ullStartCycles = Cycles();
+            ullStart = Nanoseconds();
+            if(SpectrumCompute(&sSpectrum, pusBands))
+            {
+                StageRecord(&psStages[3], Nanoseconds() - ullStart,
+                            Cycles() - ullStartCycles);
+
+                for(ulBand = 0; ulBand < g_ulBands; ulBand++)
+                {
+                    if(pusBands[ulBand] > pusPeak[ulBand])
+                    {
+                        pusPeak[ulBand] = pusBands[ulBand];
+                    }
+                }
+
+                if(g_bVerbose)
+                {
+                    PrintBands(ulPacket + 1, pusBands);
+                }
+            }
+        }
+    }
+
+    //
+    // Whatever is left in the FIFO is read when playback stops.
+    //
+    ulConsumed += Drain(&sFIFO, &sSpectrum, ulConsumed, ulOverruns == 0,
+                        psStages);
+
+    QUIETPRINT("%-22s %8s %8s %8s %8s %8s %10s\n", "Stage (ns)", "count",
+               "mean", "p50", "p99", "max", "cycles");
+    for(ulBand = 0; ulBand < 4; ulBand++)
+    {
+        StagePrint(&psStages[ulBand]);
+    }
+
+    QUIETPRINT("\nPeak magnitude of each band:\n");
+    for(ulBand = 0; ulBand < g_ulBands; ulBand++)
+    {
+        QUIETPRINT("%s%5u", (ulBand % 8) ? " " : "\n  ", pusPeak[ulBand]);
+    }
+    QUIETPRINT("\n\n%lu packets dropped as the FIFO was full.\n", ulOverruns);
+
+    //
+    // Check that every sample was read unless packets were dropped, which
+    // only happens if the FIFO cannot hold the packets received between
+    // drains.
+    //
+    if(g_ulDrain <= g_ulSlots)
+    {
+        CHECK(ulOverruns == 0, "%lu packets were dropped.\n", ulOverruns);
+        CHECK(ulConsumed == ulOffset, "%lu of %lu bytes were read.\n",
+              ulConsumed, ulOffset);
+    }
+
+    //
+    // For the generated tone, check that the loudest band is the one which
+    // holds the tone's bin, or a neighbour if the tone lies within a bin of
+    // the band's edge, and that it is close to the expected magnitude.
+    //
+    if(!g_pcFile && psStages[3].ulCount)
+    {
+        for(ulBand = 0, ulToneBand = 0; ulBand < g_ulBands; ulBand++)
+        {
+            if(pusPeak[ulBand] > pusPeak[ulToneBand])
+            {
+                ulToneBand = ulBand;
+            }
+        }
+
+        ulBin = (g_ulTone * SPECTRUM_SIZE) / g_ulRate;
+        QUIETPRINT("The %lu Hz tone, in bin %lu, is loudest in band %lu "
+                   "(bins %u to %u).\n", g_ulTone, ulBin, ulToneBand,
+                   sSpectrum.pusBandEdge[ulToneBand],
+                   sSpectrum.pusBandEdge[ulToneBand + 1] - 1);
+        CHECK((ulBin + 1 >= sSpectrum.pusBandEdge[ulToneBand]) &&
+              (ulBin <= sSpectrum.pusBandEdge[ulToneBand + 1]),
+              "The tone is not in the loudest band.\n");
+        CHECK(pusPeak[ulToneBand] > 4096,
+              "The tone only reached a magnitude of %u.\n",
+              pusPeak[ulToneBand]);
+    }
+
+    QUIETPRINT("\n%s: %lu checks failed.\n", g_ulFailed ? "FAILED" : "PASSED",
+               g_ulFailed);
+
+    return(g_ulFailed ? 1 : 0);
+}
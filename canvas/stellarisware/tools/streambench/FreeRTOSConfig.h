@@ -0,0 +1,51 @@
+//*****************************************************************************
+//
+// FreeRTOSConfig.h - The FreeRTOS configuration used to build the kernel into
+//                    the streambench host utility.
+//
+// The tick runs from the host clock, and the tick hook stands in for an
+// interrupt that writes to a stream buffer.
+//
+//*****************************************************************************
+
+#ifndef __FREERTOS_CONFIG_H__
+#define __FREERTOS_CONFIG_H__
+
+#define configUSE_PREEMPTION            1
+#define configUSE_IDLE_HOOK             0
+#define configUSE_TICK_HOOK             1
+#define configCPU_CLOCK_HZ              ((unsigned long)50000000)
+#define configTICK_RATE_HZ              ((portTickType)1000)
+#define configMINIMAL_STACK_SIZE        ((unsigned short)64)
+#define configTOTAL_HEAP_SIZE           ((size_t)(256 * 1024))
+#define configMAX_TASK_NAME_LEN         12
+#define configUSE_TRACE_FACILITY        0
+#define configUSE_16_BIT_TICKS          0
+#define configIDLE_SHOULD_YIELD         1
+#define configUSE_MUTEXES               0
+#define configUSE_CO_ROUTINES           0
+#define configUSE_MALLOC_FAILED_HOOK    0
+#define configUSE_TASK_NOTIFICATIONS    1
+#define configMAX_PRIORITIES            ((unsigned portBASE_TYPE)4)
+#define configMAX_CO_ROUTINE_PRIORITIES 2
+#define configPOSIX_VIRTUAL_TIME        0
+
+#define INCLUDE_vTaskPrioritySet        0
+#define INCLUDE_uxTaskPriorityGet       0
+#define INCLUDE_vTaskDelete             0
+#define INCLUDE_vTaskSuspend            1
+#define INCLUDE_vTaskDelayUntil         0
+#define INCLUDE_vTaskDelay              0
+#define INCLUDE_xTaskGetCurrentTaskHandle 1
+
+//
+// Any inconsistency detected by the kernel is fatal.
+//
+extern void KernelAssertFailed(const char *pcFile, int iLine);
+#define configASSERT(x)                                                       \
+    if(!(x))                                                                  \
+    {                                                                         \
+        KernelAssertFailed(__FILE__, __LINE__);                               \
+    }
+
+#endif // __FREERTOS_CONFIG_H__
@@ -0,0 +1,926 @@
+//*****************************************************************************
+//
+// streambench.c - A command line utility that checks the FreeRTOS stream and
+//                 message buffers and measures their throughput against
+//                 queues, running the FreeRTOS kernel on the host.
+//
+//*****************************************************************************
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#include "FreeRTOS.h"
+#include "task.h"
+#include "queue.h"
+#include "stream_buffer.h"
+#include "message_buffer.h"
+
+typedef unsigned char BOOL;
+#define FALSE 0
+#define TRUE  1
+
+//*****************************************************************************
+//
+// The largest chunk that may be passed in one call.
+//
+//*****************************************************************************
+#define MAX_CHUNK               1024
+
+//*****************************************************************************
+//
+// Globals controlled by various command line parameters.
+//
+//*****************************************************************************
+BOOL g_bVerbose       = FALSE;
+BOOL g_bQuiet         = FALSE;
+unsigned long g_ulTotalBytes  = 256 * 1024;
+unsigned long g_ulBufferSize  = 1024;
+unsigned long g_ulChunkSize   = 64;
+unsigned long g_ulTriggerLevel = 1;
+
+//*****************************************************************************
+//
+// Helpful macros for generating output depending upon verbose and quiet flags.
+//
+//*****************************************************************************
+#define VERBOSEPRINT(...) if(g_bVerbose) { printf(__VA_ARGS__); }
+#define QUIETPRINT(...) if(!g_bQuiet) { printf(__VA_ARGS__); }
+
+//*****************************************************************************
+//
+// Stops the utility if a check fails.
+//
+//*****************************************************************************
+#define CHECK(bCondition)                                                     \
+    if(!(bCondition))                                                         \
+    {                                                                         \
+        CheckFailed(#bCondition, __LINE__);                                   \
+    }
+
+//*****************************************************************************
+//
+// A way of passing a stream of bytes from the sending task to the receiving
+// task, along with the time measured for it.
+//
+//*****************************************************************************
+typedef struct
+{
+    //
+    // The name printed with the results.
+    //
+    const char *pcName;
+
+    //
+    // Creates and deletes the queue or buffer used.
+    //
+    void (*pfnCreate)(void);
+    void (*pfnDelete)(void);
+
+    //
+    // Send and receive g_ulTotalBytes bytes.  The receiver checks every byte.
+    //
+    void (*pfnSend)(void);
+    void (*pfnReceive)(void);
+
+    //
+    // The time taken to pass all of the bytes, in nanoseconds.
+    //
+    unsigned long long ullTime;
+}
+tMethod;
+
+//*****************************************************************************
+//
+// The queue or buffer that the current method passes bytes through.
+//
+//*****************************************************************************
+static xQueueHandle g_xQueue;
+static xStreamBufferHandle g_xStreamBuffer;
+
+//*****************************************************************************
+//
+// The tasks that run the checks and the measurements.
+//
+//*****************************************************************************
+static xTaskHandle g_xController;
+static xTaskHandle g_xSender;
+static xTaskHandle g_xReceiver;
+
+//*****************************************************************************
+//
+// The method being measured.
+//
+//*****************************************************************************
+static tMethod *g_psMethod;
+
+//*****************************************************************************
+//
+// The stream buffer that the tick hook writes to, and the number of bytes it
+// has left to write.
+//
+//*****************************************************************************
+static xStreamBufferHandle volatile g_xTickStream;
+static volatile unsigned long g_ulTickBytes;
+
+//*****************************************************************************
+//
+// Called by the kernel when it detects an inconsistency.
+//
+//*****************************************************************************
+void
+KernelAssertFailed(const char *pcFile, int iLine)
+{
+    fprintf(stderr, "Kernel assertion failed at %s:%d\n", pcFile, iLine);
+    exit(1);
+}
+
+//*****************************************************************************
+//
+// Reports a failed check and stops.
+//
+//*****************************************************************************
+static void
+CheckFailed(const char *pcCondition, int iLine)
+{
+    fprintf(stderr, "Check failed at line %d: %s\n", iLine, pcCondition);
+    exit(1);
+}
+
+//*****************************************************************************
+//
+// Returns the current time in nanoseconds.
+//
+//*****************************************************************************
+static unsigned long long
+Now(void)
+{
+    struct timespec sNow;
+
+    clock_gettime(CLOCK_MONOTONIC, &sNow);
+    return(((unsigned long long)sNow.tv_sec * 1000000000ULL) + sNow.tv_nsec);
+}
+
+//*****************************************************************************
+//
+// The value of the byte at a given offset in the stream.  This differs
+// between nearby offsets in every byte of the offset, so that a lost,
+// repeated or reordered chunk is caught.
+//
+//*****************************************************************************
+static unsigned char
+Pattern(unsigned long ulOffset)
+{
+    return((unsigned char)(ulOffset ^ (ulOffset >> 8) ^ (ulOffset >> 16)));
+}
+
+static void
+FillPattern(unsigned char *pucData, unsigned long ulOffset,
+            unsigned long ulCount)
+{
+    while(ulCount--)
+    {
+        *pucData++ = Pattern(ulOffset++);
+    }
+}
+
+static void
+CheckPattern(const unsigned char *pucData, unsigned long ulOffset,
+             unsigned long ulCount)
+{
+    while(ulCount--)
+    {
+        if(*pucData++ != Pattern(ulOffset))
+        {
+            fprintf(stderr, "Stream corrupted at offset %lu.\n", ulOffset);
+            exit(1);
+        }
+
+        ulOffset++;
+    }
+}
+
+//*****************************************************************************
+//
+// The length of each message sent through the message buffer, which varies
+// between 1 and the chunk size.
+//
+//*****************************************************************************
+static unsigned long
+MessageLength(unsigned long ulMessage, unsigned long ulOffset)
+{
+    unsigned long ulLength;
+
+    ulLength = 1 + ((ulMessage * 7919) % g_ulChunkSize);
+
+    if(ulLength > (g_ulTotalBytes - ulOffset))
+    {
+        ulLength = g_ulTotalBytes - ulOffset;
+    }
+
+    return(ulLength);
+}
+
+//*****************************************************************************
+//
+// The time for the receiving task to wait for more of the stream.  A reader
+// waiting on a stream buffer is only woken once the trigger level is reached,
+// so if the rest of the stream is shorter than that, the wait has to time out
+// instead.
+//
+//*****************************************************************************
+static portTickType
+ReceiveWait(unsigned long ulOffset)
+{
+    return(((g_ulTotalBytes - ulOffset) < g_ulTriggerLevel) ? 1 :
+           portMAX_DELAY);
+}
+
+//*****************************************************************************
+//
+// The tick hook, which stands in for an interrupt that writes one byte to a
+// stream buffer on every tick while g_ulTickBytes is non-zero.
+//
+//*****************************************************************************
+void
+vApplicationTickHook(void)
+{
+    static unsigned long ulOffset = 0;
+    unsigned char ucByte;
+    signed portBASE_TYPE xWoken = pdFALSE;
+
+    if(g_xTickStream && g_ulTickBytes)
+    {
+        ucByte = Pattern(ulOffset);
+        if(xStreamBufferSendFromISR(g_xTickStream, &ucByte, 1, &xWoken) == 1)
+        {
+            ulOffset++;
+            g_ulTickBytes--;
+        }
+    }
+}
+
+//*****************************************************************************
+//
+// Passing the stream one byte at a time through a queue of bytes.
+//
+//*****************************************************************************
+static void
+QueueBytesCreate(void)
+{
+    g_xQueue = xQueueCreate(g_ulBufferSize, 1);
+    CHECK(g_xQueue != NULL);
+}
+
+static void
+QueueBytesSend(void)
+{
+    unsigned long ulOffset;
+    unsigned char ucByte;
+
+    for(ulOffset = 0; ulOffset < g_ulTotalBytes; ulOffset++)
+    {
+        ucByte = Pattern(ulOffset);
+        CHECK(xQueueSend(g_xQueue, &ucByte, portMAX_DELAY) == pdPASS);
+    }
+}
+
+static void
+QueueBytesReceive(void)
+{
+    unsigned long ulOffset;
+    unsigned char ucByte;
+
+    for(ulOffset = 0; ulOffset < g_ulTotalBytes; ulOffset++)
+    {
+        CHECK(xQueueReceive(g_xQueue, &ucByte, portMAX_DELAY) == pdPASS);
+        CheckPattern(&ucByte, ulOffset, 1);
+    }
+}
+
+static void
+QueueDelete(void)
+{
+    vQueueDelete(g_xQueue);
+}
+
+//*****************************************************************************
+//
+// Passing the stream in chunks through a queue of chunk sized items.  Every
+// item is copied whole, even the last one if it is only partly used.
+//
+//*****************************************************************************
+static void
+QueueChunksCreate(void)
+{
+    g_xQueue = xQueueCreate(g_ulBufferSize / g_ulChunkSize, g_ulChunkSize);
+    CHECK(g_xQueue != NULL);
+}
+
+static void
+QueueChunksSend(void)
+{
+    unsigned char pucChunk[MAX_CHUNK];
+    unsigned long ulOffset, ulCount;
+
+    for(ulOffset = 0; ulOffset < g_ulTotalBytes; ulOffset += ulCount)
+    {
+        ulCount = g_ulTotalBytes - ulOffset;
+        if(ulCount > g_ulChunkSize)
+        {
+            ulCount = g_ulChunkSize;
+        }
+
+        FillPattern(pucChunk, ulOffset, ulCount);
+        CHECK(xQueueSend(g_xQueue, pucChunk, portMAX_DELAY) == pdPASS);
+    }
+}
+
+static void
+QueueChunksReceive(void)
+{
+    unsigned char pucChunk[MAX_CHUNK];
+    unsigned long ulOffset, ulCount;
+
+    for(ulOffset = 0; ulOffset < g_ulTotalBytes; ulOffset += ulCount)
+    {
+        ulCount = g_ulTotalBytes - ulOffset;
+        if(ulCount > g_ulChunkSize)
+        {
+            ulCount = g_ulChunkSize;
+        }
+
+        CHECK(xQueueReceive(g_xQueue, pucChunk, portMAX_DELAY) == pdPASS);
+        CheckPattern(pucChunk, ulOffset, ulCount);
+    }
+}
+
+//*****************************************************************************
+//
+// Passing the stream in chunks through a stream buffer.  The receiver takes
+// whatever is in the buffer, up to a chunk at a time.
+//
+//*****************************************************************************
+static void
+StreamCreate(void)
+{
+    g_xStreamBuffer = xStreamBufferCreate(g_ulBufferSize, g_ulTriggerLevel);
+    CHECK(g_xStreamBuffer != NULL);
+}
+
+static void
+StreamSend(void)
+{
+    unsigned char pucChunk[MAX_CHUNK];
+    unsigned long ulOffset, ulCount;
+
+    for(ulOffset = 0; ulOffset < g_ulTotalBytes; ulOffset += ulCount)
+    {
+        ulCount = g_ulTotalBytes - ulOffset;
+        if(ulCount > g_ulChunkSize)
+        {
+            ulCount = g_ulChunkSize;
+        }
+
+        FillPattern(pucChunk, ulOffset, ulCount);
+        CHECK(xStreamBufferSend(g_xStreamBuffer, pucChunk, ulCount,
+                                portMAX_DELAY) == ulCount);
+    }
+}
+
+static void
+StreamReceive(void)
+{
+    unsigned char pucChunk[MAX_CHUNK];
+    unsigned long ulOffset, ulCount;
+
+    for(ulOffset = 0; ulOffset < g_ulTotalBytes; ulOffset += ulCount)
+    {
+        ulCount = xStreamBufferReceive(g_xStreamBuffer, pucChunk,
+                                       g_ulChunkSize, ReceiveWait(ulOffset));
+        CheckPattern(pucChunk, ulOffset, ulCount);
+    }
+}
+
+static void
+StreamDelete(void)
+{
+    vStreamBufferDelete(g_xStreamBuffer);
+}
+
+//*****************************************************************************
+//
+// Passing the stream through a stream buffer without copying it, by filling
+// and checking the bytes in place as a DMA channel would.
+//
+//*****************************************************************************
+static void
+ZeroCopySend(void)
+{
+    unsigned long ulOffset, ulCount;
+    void *pvWrite;
+
+    ulOffset = 0;
+    while(ulOffset < g_ulTotalBytes)
+    {
+        ulCount = xStreamBufferGetWritePointer(g_xStreamBuffer, &pvWrite);
+        if(ulCount == 0)
+        {
+            xStreamBufferWaitForSpace(g_xStreamBuffer, 1, portMAX_DELAY);
+            continue;
+        }
+
+        if(ulCount > g_ulChunkSize)
+        {
+            ulCount = g_ulChunkSize;
+        }
+
+        if(ulCount > (g_ulTotalBytes - ulOffset))
+        {
+            ulCount = g_ulTotalBytes - ulOffset;
+        }
+
+        FillPattern(pvWrite, ulOffset, ulCount);
+        vStreamBufferCommitWrite(g_xStreamBuffer, ulCount);
+        ulOffset += ulCount;
+    }
+}
+
+static void
+ZeroCopyReceive(void)
+{
+    unsigned long ulOffset, ulCount;
+    const void *pvRead;
+
+    ulOffset = 0;
+    while(ulOffset < g_ulTotalBytes)
+    {
+        ulCount = xStreamBufferGetReadPointer(g_xStreamBuffer, &pvRead);
+        if(ulCount == 0)
+        {
+            xStreamBufferWaitForData(g_xStreamBuffer, ReceiveWait(ulOffset));
+            continue;
+        }
+
+        CheckPattern(pvRead, ulOffset, ulCount);
+        vStreamBufferConsume(g_xStreamBuffer, ulCount);
+        ulOffset += ulCount;
+    }
+}
+
+//*****************************************************************************
+//
+// Passing the stream as messages of varying length through a message buffer.
+//
+//*****************************************************************************
+static void
+MessageCreate(void)
+{
+    g_xStreamBuffer = xMessageBufferCreate(g_ulBufferSize);
+    CHECK(g_xStreamBuffer != NULL);
+}
+
+static void
+MessageSend(void)
+{
+    unsigned char pucChunk[MAX_CHUNK];
+    unsigned long ulOffset, ulCount, ulMessage;
+
+    ulMessage = 0;
+    for(ulOffset = 0; ulOffset < g_ulTotalBytes; ulOffset += ulCount)
+    {
+        ulCount = MessageLength(ulMessage++, ulOffset);
+        FillPattern(pucChunk, ulOffset, ulCount);
+        CHECK(xMessageBufferSend(g_xStreamBuffer, pucChunk, ulCount,
+                                 portMAX_DELAY) == ulCount);
+    }
+}
+
+static void
+MessageReceive(void)
+{
+    unsigned char pucChunk[MAX_CHUNK];
+    unsigned long ulOffset, ulCount, ulMessage;
+
+    ulMessage = 0;
+    for(ulOffset = 0; ulOffset < g_ulTotalBytes; ulOffset += ulCount)
+    {
+        ulCount = xMessageBufferReceive(g_xStreamBuffer, pucChunk,
+                                        sizeof(pucChunk), portMAX_DELAY);
+        CHECK(ulCount == MessageLength(ulMessage++, ulOffset));
+        CheckPattern(pucChunk, ulOffset, ulCount);
+    }
+}
+
+//*****************************************************************************
+//
+// The methods measured.  The first is the baseline the others are compared
+// with.
+//
+//*****************************************************************************
+static tMethod g_psMethods[] =
+{
+    { "Queue of bytes", QueueBytesCreate, QueueDelete, QueueBytesSend,
+      QueueBytesReceive },
+    { "Queue of chunks", QueueChunksCreate, QueueDelete, QueueChunksSend,
+      QueueChunksReceive },
+    { "Stream buffer", StreamCreate, StreamDelete, StreamSend,
+      StreamReceive },
+    { "Stream buffer in place", StreamCreate, StreamDelete, ZeroCopySend,
+      ZeroCopyReceive },
+    { "Message buffer", MessageCreate, StreamDelete, MessageSend,
+      MessageReceive }
+};
+
+#define NUM_METHODS             (sizeof(g_psMethods) / sizeof(g_psMethods[0]))
+
+//*****************************************************************************
+//
+// Checks the behavior of the stream and message buffers that the throughput
+// measurements do not exercise.  Runs in the controlling task, which has the
+// highest priority.
+//
+//*****************************************************************************
+static void
+CheckBuffers(void)
+{
+    xStreamBufferHandle xStream;
+    unsigned char pucData[64];
+    const void *pvRead;
+    void *pvWrite;
+    portTickType xStart;
+
+    //
+    // A stream buffer holds as many bytes as it was created with, and a
+    // receive returns whatever is there even below the trigger level.
+    //
+    xStream = xStreamBufferCreate(16, 4);
+    CHECK(xStream != NULL);
+    CHECK(xStreamBufferIsEmpty(xStream) == pdTRUE);
+    FillPattern(pucData, 0, sizeof(pucData));
+    CHECK(xStreamBufferSend(xStream, pucData, 20, 0) == 16);
+    CHECK(xStreamBufferIsFull(xStream) == pdTRUE);
+    CHECK(xStreamBufferSpacesAvailable(xStream) == 0);
+    CHECK(xStreamBufferReceive(xStream, pucData, 3, 0) == 3);
+    CheckPattern(pucData, 0, 3);
+    CHECK(xStreamBufferBytesAvailable(xStream) == 13);
+    CHECK(xStreamBufferReceive(xStream, pucData, sizeof(pucData), 0) == 13);
+    CheckPattern(pucData, 3, 13);
+    VERBOSEPRINT("Stream buffer capacity ok.\n");
+
+    //
+    // A receive from an empty buffer waits for the timeout.
+    //
+    xStart = xTaskGetTickCount();
+    CHECK(xStreamBufferReceive(xStream, pucData, sizeof(pucData), 10) == 0);
+    CHECK((xTaskGetTickCount() - xStart) >= 10);
+    VERBOSEPRINT("Stream buffer timeout ok.\n");
+
+    //
+    // An interrupt writing one byte at a time only wakes the reader once the
+    // trigger level has been reached.
+    //
+    CHECK(xStreamBufferReset(xStream) == pdPASS);
+    CHECK(xStreamBufferSetTriggerLevel(xStream, 8) == pdPASS);
+    CHECK(xStreamBufferSetTriggerLevel(xStream, 17) == pdFAIL);
+    g_ulTickBytes = 8;
+    g_xTickStream = xStream;
+    CHECK(xStreamBufferReceive(xStream, pucData, sizeof(pucData),
+                               1000) == 8);
+    CheckPattern(pucData, 0, 8);
+    g_xTickStream = NULL;
+    VERBOSEPRINT("Stream buffer trigger level ok.\n");
+
+    //
+    // The pointer functions only return the part of the buffer that is
+    // contiguous, and see the bytes written by the copying functions.
+    //
+    CHECK(xStreamBufferReset(xStream) == pdPASS);
+    CHECK(xStreamBufferSend(xStream, pucData, 12, 0) == 12);
+    CHECK(xStreamBufferReceive(xStream, pucData, 12, 0) == 12);
+    CHECK(xStreamBufferGetWritePointer(xStream, &pvWrite) == 5);
+    FillPattern(pvWrite, 100, 5);
+    vStreamBufferCommitWrite(xStream, 5);
+    CHECK(xStreamBufferGetWritePointer(xStream, &pvWrite) == 11);
+    FillPattern(pvWrite, 105, 3);
+    vStreamBufferCommitWrite(xStream, 3);
+    CHECK(xStreamBufferGetReadPointer(xStream, &pvRead) == 5);
+    CheckPattern(pvRead, 100, 5);
+    vStreamBufferConsume(xStream, 5);
+    CHECK(xStreamBufferReceive(xStream, pucData, sizeof(pucData), 0) == 3);
+    CheckPattern(pucData, 105, 3);
+    CHECK(xStreamBufferGetReadPointer(xStream, &pvRead) == 0);
+    vStreamBufferDelete(xStream);
+    VERBOSEPRINT("Stream buffer pointers ok.\n");
+
+    //
+    // A message buffer passes whole messages, and leaves a message in the
+    // buffer if it will not fit in the receiver's buffer.
+    //
+    xStream = xMessageBufferCreate(32);
+    CHECK(xStream != NULL);
+    FillPattern(pucData, 0, sizeof(pucData));
+    CHECK(xMessageBufferSend(xStream, pucData, 10, 0) == 10);
+    CHECK(xMessageBufferNextLengthBytes(xStream) == 10);
+    CHECK(xMessageBufferSend(xStream, pucData, 20, 0) == 0);
+    CHECK(xMessageBufferReceive(xStream, pucData, 4, 0) == 0);
+    CHECK(xMessageBufferReceive(xStream, pucData, sizeof(pucData), 0) == 10);
+    CheckPattern(pucData, 0, 10);
+    CHECK(xMessageBufferIsEmpty(xStream) == pdTRUE);
+    CHECK(xMessageBufferNextLengthBytes(xStream) == 0);
+    CHECK(xMessageBufferReceive(xStream, pucData, sizeof(pucData), 5) == 0);
+    vMessageBufferDelete(xStream);
+    VERBOSEPRINT("Message buffer ok.\n");
+
+    QUIETPRINT("Stream and message buffer checks passed.\n\n");
+}
+
+//*****************************************************************************
+//
+// The sending and receiving tasks, which wait to be started by the
+// controlling task, pass the stream using the current method, then tell the
+// controlling task that they have finished.
+//
+//*****************************************************************************
+static void
+SenderTask(void *pvParameters)
+{
+    for(;;)
+    {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        g_psMethod->pfnSend();
+        xTaskNotifyGive(g_xController);
+    }
+}
+
+static void
+ReceiverTask(void *pvParameters)
+{
+    for(;;)
+    {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        g_psMethod->pfnReceive();
+        xTaskNotifyGive(g_xController);
+    }
+}
+
+//*****************************************************************************
+//
+// The controlling task, which runs the checks and each measurement in turn
+// and then ends the scheduler.
+//
+//*****************************************************************************
+static void
+ControllerTask(void *pvParameters)
+{
+    unsigned long ulMethod, ulDone;
+    unsigned long long ullStart;
+
+    CheckBuffers();
+
+    for(ulMethod = 0; ulMethod < NUM_METHODS; ulMethod++)
+    {
+        g_psMethod = &g_psMethods[ulMethod];
+        VERBOSEPRINT("Measuring %s.\n", g_psMethod->pcName);
+
+        g_psMethod->pfnCreate();
+
+        //
+        // Start both tasks, then wait for both to finish.
+        //
+        ullStart = Now();
+        xTaskNotifyGive(g_xSender);
+        xTaskNotifyGive(g_xReceiver);
+
+        ulDone = 0;
+        while(ulDone < 2)
+        {
+            ulDone += ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        }
+
+        g_psMethod->ullTime = Now() - ullStart;
+        g_psMethod->pfnDelete();
+    }
+
+    vTaskEndScheduler();
+}
+
+//*****************************************************************************
+//
+// Show the startup banner.
+//
+//*****************************************************************************
+void
+PrintWelcome(void)
+{
+    QUIETPRINT("\nstreambench - Measure FreeRTOS stream buffer throughput.\n\n");
+}
+
+//*****************************************************************************
+//
+// Show help on the application command line parameters.
+//
+//*****************************************************************************
+void
+ShowHelp(void)
+{
+    //
+    // Only print help if we are not in quiet mode.
+    //
+    if(g_bQuiet)
+    {
+        return;
+    }
+
+    printf("This application runs the FreeRTOS kernel on the host, checks the\n");
+    printf("behavior of the stream and message buffers, then passes a stream of\n");
+    printf("bytes between two tasks through a queue of bytes, a queue of chunk\n");
+    printf("sized items, a stream buffer, a stream buffer accessed in place and\n");
+    printf("a message buffer, and reports the throughput of each.  Every byte\n");
+    printf("received is checked.\n\n");
+    printf("On the host every change to the interrupt mask is a system call, and\n");
+    printf("every task switch is a switch between host threads, so absolute\n");
+    printf("throughput is far from that of the target.  The differences between\n");
+    printf("the methods are what matter.\n\n");
+    printf("Supported parameters are:\n\n");
+    printf("-n <num>  - The number of bytes to pass (default 262144).\n");
+    printf("-b <num>  - The size of each queue or buffer in bytes (default 1024).\n");
+    printf("-c <num>  - The largest chunk sent at once, up to %d (default 64).\n",
+           MAX_CHUNK);
+    printf("-t <num>  - The stream buffer trigger level (default 1).\n");
+    printf("-? or -h  - Show this help.\n");
+    printf("-q        - Quiet mode. Disable output to stdio.\n");
+    printf("-e        - Enable verbose output\n\n");
+    printf("Example:\n\n");
+    printf("   streambench -n 1048576 -c 256\n\n");
+}
+
+//*****************************************************************************
+//
+// Parse the command line, extracting all parameters.
+//
+// Returns 0 on failure, 1 on success.
+//
+//*****************************************************************************
+int
+ParseCommandLine(int argc, char *argv[])
+{
+    int iRetcode;
+    BOOL bShowHelp, bInvalid;
+
+    //
+    // By default, don't show the help screen.
+    //
+    bShowHelp = FALSE;
+
+    while(1)
+    {
+        //
+        // Get the next command line parameter.
+        //
+        iRetcode = getopt(argc, argv, "n:b:c:t:eh?q");
+
+        if(iRetcode == -1)
+        {
+            break;
+        }
+
+        switch(iRetcode)
+        {
+            case 'n':
+                g_ulTotalBytes = strtoul(optarg, NULL, 0);
+                break;
+
+            case 'b':
+                g_ulBufferSize = strtoul(optarg, NULL, 0);
+                break;
+
+            case 'c':
+                g_ulChunkSize = strtoul(optarg, NULL, 0);
+                break;
+
+            case 't':
+                g_ulTriggerLevel = strtoul(optarg, NULL, 0);
+                break;
+
+            case 'e':
+                g_bVerbose = TRUE;
+                break;
+
+            case 'q':
+                g_bQuiet = TRUE;
+                break;
+
+            case '?':
+            case 'h':
+                bShowHelp = TRUE;
+                break;
+        }
+    }
+
+    //
+    // Show the welcome banner unless we have been told to be quiet.
+    //
+    PrintWelcome();
+
+    //
+    // Catch various invalid parameter cases.  The buffer must hold at least
+    // one chunk as a queue item, and one chunk and its length as a message.
+    //
+    bInvalid = ((g_ulTotalBytes == 0) || (g_ulChunkSize == 0) ||
+                (g_ulChunkSize > MAX_CHUNK) ||
+                (g_ulBufferSize < (g_ulChunkSize + sizeof(size_t))) ||
+                (g_ulTriggerLevel > g_ulBufferSize));
+
+    if(bShowHelp || bInvalid)
+    {
+        ShowHelp();
+
+        if(bInvalid)
+        {
+            fprintf(stderr, "The byte count and chunk size must not be zero, "
+                    "the chunk must be no\nlarger than %d, the buffer must "
+                    "be larger than the chunk, and the\ntrigger level must "
+                    "fit in the buffer.\n", MAX_CHUNK);
+        }
+
+        return(0);
+    }
+
+    VERBOSEPRINT("Bytes %lu, buffer %lu, chunk %lu, trigger level %lu\n",
+                 g_ulTotalBytes, g_ulBufferSize, g_ulChunkSize,
+                 g_ulTriggerLevel);
+
+    return(1);
+}
+
+//*****************************************************************************
+//
+// The main entry point of the utility.
+//
+//*****************************************************************************
+int
+main(int argc, char *argv[])
+{
+    unsigned long ulMethod;
+    double dRate, dBaseline;
+
+    //
+    // Parse the command line.
+    //
+    if(!ParseCommandLine(argc, argv))
+    {
+        return(1);
+    }
+
+    //
+    // Create the tasks.  The controlling task runs above the other two, which
+    // share a priority so that neither is favored.
+    //
+    if((xTaskCreate(ControllerTask, (signed char *)"Control",
+                    configMINIMAL_STACK_SIZE, NULL, configMAX_PRIORITIES - 1,
+                    &g_xController) != pdPASS) ||
+       (xTaskCreate(SenderTask, (signed char *)"Sender",
+                    configMINIMAL_STACK_SIZE, NULL, tskIDLE_PRIORITY + 1,
+                    &g_xSender) != pdPASS) ||
+       (xTaskCreate(ReceiverTask, (signed char *)"Receiver",
+                    configMINIMAL_STACK_SIZE, NULL, tskIDLE_PRIORITY + 1,
+                    &g_xReceiver) != pdPASS))
+    {
+        fprintf(stderr, "Unable to create the tasks.\n");
+        return(1);
+    }
+
+    //
+    // Run the checks and the measurements.  This returns once the controlling
+    // task has ended the scheduler.
+    //
+    vTaskStartScheduler();
+
+    //
+    // Report the results.
+    //
+    QUIETPRINT("Passed %lu bytes in chunks of up to %lu through %lu byte "
+               "buffers.\n\n", g_ulTotalBytes, g_ulChunkSize, g_ulBufferSize);
+    QUIETPRINT("%-24s %10s %10s %8s\n", "Method", "Time (ms)", "MB/s",
+               "Speedup");
+
+    dBaseline = 0;
+    for(ulMethod = 0; ulMethod < NUM_METHODS; ulMethod++)
+    {
+        dRate = ((double)g_ulTotalBytes * 1000.0) /
+                (double)g_psMethods[ulMethod].ullTime;
+        if(ulMethod == 0)
+        {
+            dBaseline = dRate;
+        }
+
+        QUIETPRINT("%-24s %10.1f %10.2f %7.1fx\n",
+                   g_psMethods[ulMethod].pcName,
+                   (double)g_psMethods[ulMethod].ullTime / 1000000.0, dRate,
+                   dRate / dBaseline);
+    }
+
+    return(0);
+}
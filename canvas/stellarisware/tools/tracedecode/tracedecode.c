@@ -0,0 +1,1301 @@
+//*****************************************************************************
+//
+// tracedecode.c - A command line utility that decodes a FreeRTOS kernel event
+//                 trace written by utils/rtostrace.c, reporting per-task CPU
+//                 usage and latency histograms and writing a timeline that
+//                 can be viewed in a Chrome trace-event viewer.
+//
+//*****************************************************************************
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "utils/rtostrace.h"
+
+typedef unsigned char BOOL;
+#define FALSE 0
+#define TRUE  1
+
+//*****************************************************************************
+//
+// The size of the header at the start of a dump, and of each record.  These
+// are fixed by the dump format, not by the size of the target's structures.
+//
+//*****************************************************************************
+#define HEADER_SIZE             32
+#define RECORD_SIZE             8
+
+//*****************************************************************************
+//
+// The number of buckets in each histogram.  Bucket 0 counts values under one
+// microsecond, bucket n values from 2^(n-1) up to 2^n microseconds, and the
+// last bucket everything larger.
+//
+//*****************************************************************************
+#define HIST_BUCKETS            18
+
+//*****************************************************************************
+//
+// The deepest nesting of interrupt handlers that is tracked.
+//
+//*****************************************************************************
+#define MAX_ISR_DEPTH           16
+
+//*****************************************************************************
+//
+// The thread identifiers used for the rows of the timeline that are not
+// tasks.  Task n uses thread n + 1, vector n uses thread ISR_TID + n, and
+// events from outside any task use thread ISR_TID.
+//
+//*****************************************************************************
+#define SLEEP_TID               999
+#define ISR_TID                 1000
+
+//*****************************************************************************
+//
+// Globals controlled by various command line parameters.
+//
+//*****************************************************************************
+BOOL g_bVerbose        = FALSE;
+BOOL g_bQuiet          = FALSE;
+unsigned long g_ulDump = 1;
+char *g_pszInput       = NULL;
+char *g_pszJSON        = NULL;
+
+//*****************************************************************************
+//
+// Helpful macros for generating output depending upon verbose and quiet flags.
+//
+//*****************************************************************************
+#define VERBOSEPRINT(...) if(g_bVerbose) { printf(__VA_ARGS__); }
+#define QUIETPRINT(...) if(!g_bQuiet) { printf(__VA_ARGS__); }
+
+//*****************************************************************************
+//
+// A histogram of times, in cycles.
+//
+//*****************************************************************************
+typedef struct
+{
+    unsigned long pulBucket[HIST_BUCKETS];
+    unsigned long ulCount;
+    unsigned long long ullTotal;
+    unsigned long long ullMin;
+    unsigned long long ullMax;
+}
+tHistogram;
+
+//*****************************************************************************
+//
+// What is known about each task, queue and interrupt vector.
+//
+//*****************************************************************************
+typedef struct
+{
+    char pcName[32];
+    BOOL bSeen;
+    unsigned long ulPriority;
+    unsigned long long ullCycles;
+    unsigned long ulSwitches;
+    BOOL bReadyPending;
+    unsigned long long ullReadyTime;
+    tHistogram sLatency;
+}
+tTask;
+
+typedef struct
+{
+    char pcName[32];
+    BOOL bSeen;
+    unsigned long ulType;           // The type plus one, or zero if unknown
+    unsigned long ulSends;
+    unsigned long ulReceives;
+    unsigned long ulFailed;
+    unsigned long ulBlocked;
+}
+tQueue;
+
+typedef struct
+{
+    BOOL bSeen;
+    unsigned long long ullCycles;
+    tHistogram sDuration;
+}
+tVector;
+
+tTask g_psTasks[256];
+tQueue g_psQueues[256];
+tVector g_psVectors[256];
+
+//*****************************************************************************
+//
+// The values from the header of the dump being decoded.
+//
+//*****************************************************************************
+unsigned long g_ulClockRate;
+unsigned long g_ulTickRate;
+unsigned long g_ulNumRecords;
+unsigned long g_ulLost;
+
+//*****************************************************************************
+//
+// The state of the target as the records are replayed.  Time is in cycles
+// since the first record, extended to 64 bits and corrected for the time the
+// processor spent asleep, when the cycle counter stops.
+//
+//*****************************************************************************
+int g_iCurrentTask = -1;
+unsigned long long g_ullSliceStart;
+unsigned long g_pulISRVector[MAX_ISR_DEPTH];
+unsigned long long g_pullISRStart[MAX_ISR_DEPTH];
+unsigned long g_ulISRDepth;
+BOOL g_bAsleep;
+unsigned long g_ulSleepTick;
+unsigned long long g_ullSleepStart;
+unsigned long long g_ullSleepCycles;
+unsigned long long g_ullUnknownCycles;
+unsigned long long g_ullLastCharge;
+unsigned long long g_ullNow;
+unsigned long long g_ullSleepAdjust;
+unsigned long g_ulLastStamp;
+unsigned long g_ulUnmatchedISR;
+
+//*****************************************************************************
+//
+// The timeline being written, if any, and whether an event has been written
+// to it yet.
+//
+//*****************************************************************************
+FILE *g_pfJSON;
+BOOL g_bJSONFirst = TRUE;
+
+//*****************************************************************************
+//
+// Reads little endian values from the dump.
+//
+//*****************************************************************************
+static unsigned long
+Read16(const unsigned char *pucData)
+{
+    return(pucData[0] | (pucData[1] << 8));
+}
+
+static unsigned long
+Read32(const unsigned char *pucData)
+{
+    return(pucData[0] | (pucData[1] << 8) | (pucData[2] << 16) |
+           ((unsigned long)pucData[3] << 24));
+}
+
+//*****************************************************************************
+//
+// Converts a number of cycles to microseconds.
+//
+//*****************************************************************************
+static double
+Microseconds(unsigned long long ullCycles)
+{
+    return(((double)ullCycles * 1000000.0) / (double)g_ulClockRate);
+}
+
+//*****************************************************************************
+//
+// Returns the name of an interrupt vector.
+//
+//*****************************************************************************
+static const char *
+VectorName(unsigned long ulVector)
+{
+    static char pcName[24];
+
+    switch(ulVector)
+    {
+        case 11:
+            return("SVCall");
+
+        case 14:
+            return("PendSV");
+
+        case 15:
+            return("SysTick");
+
+        default:
+            snprintf(pcName, sizeof(pcName), "Vector %lu", ulVector);
+            return(pcName);
+    }
+}
+
+//*****************************************************************************
+//
+// Print the welcome banner.
+//
+//*****************************************************************************
+void
+PrintWelcome(void)
+{
+    QUIETPRINT("\ntracedecode - Decode a FreeRTOS kernel event trace.\n\n");
+}
+
+//*****************************************************************************
+//
+// Show help on the application command line parameters.
+//
+//*****************************************************************************
+void
+ShowHelp(void)
+{
+    //
+    // Only print help if we are not in quiet mode.
+    //
+    if(g_bQuiet)
+    {
+        return;
+    }
+
+    printf("This application decodes a trace of FreeRTOS kernel events that\n");
+    printf("was recorded by utils/rtostrace.c and written out by\n");
+    printf("RTOSTraceDump().  The input is searched for the start of the\n");
+    printf("dump, so a capture of a UART that also carries other output can\n");
+    printf("be given as is.  It reports the CPU time used by each task and\n");
+    printf("interrupt handler, the time from each task being made ready to it\n");
+    printf("running, and the time spent in each interrupt handler.\n\n");
+    printf("Supported parameters are:\n\n");
+    printf("-i <file> - Decode the trace in the given file.\n");
+    printf("-j <file> - Write a timeline of the trace to the given file in\n");
+    printf("            Chrome trace-event JSON format.\n");
+    printf("-d <num>  - Decode the given dump when the input holds several\n");
+    printf("            (default 1).\n");
+    printf("-? or -h  - Show this help.\n");
+    printf("-q        - Quiet mode. Disable output to stdio.\n");
+    printf("-e        - Enable verbose output\n\n");
+    printf("The timeline can be opened in chrome://tracing or in Perfetto.\n\n");
+    printf("Example:\n\n");
+    printf("   tracedecode -i trace.bin -j trace.json\n\n");
+}
+
+//*****************************************************************************
+//
+// Parse the command line, extracting all parameters.
+//
+// Returns 0 on failure, 1 on success.
+//
+//*****************************************************************************
+int
+ParseCommandLine(int argc, char *argv[])
+{
+    int iRetcode;
+    BOOL bShowHelp;
+
+    //
+    // By default, don't show the help screen.
+    //
+    bShowHelp = FALSE;
+
+    while(1)
+    {
+        //
+        // Get the next command line parameter.
+        //
+        iRetcode = getopt(argc, argv, "i:j:d:eh?q");
+
+        if(iRetcode == -1)
+        {
+            break;
+        }
+
+        switch(iRetcode)
+        {
+            case 'i':
+                g_pszInput = optarg;
+                break;
+
+            case 'j':
+                g_pszJSON = optarg;
+                break;
+
+            case 'd':
+                g_ulDump = strtoul(optarg, NULL, 0);
+                break;
+
+            case 'e':
+                g_bVerbose = TRUE;
+                break;
+
+            case 'q':
+                g_bQuiet = TRUE;
+                break;
+
+            case '?':
+            case 'h':
+                bShowHelp = TRUE;
+                break;
+        }
+    }
+
+    //
+    // Show the welcome banner unless we have been told to be quiet.
+    //
+    PrintWelcome();
+
+    //
+    // Catch various invalid parameter cases.
+    //
+    if(bShowHelp || !g_pszInput || (g_ulDump == 0) || (optind != argc))
+    {
+        ShowHelp();
+        return(0);
+    }
+
+    return(1);
+}
+
+//*****************************************************************************
+//
+// Adds a time to a histogram.
+//
+//*****************************************************************************
+static void
+HistogramAdd(tHistogram *psHist, unsigned long long ullCycles)
+{
+    unsigned long long ullMicroseconds;
+    unsigned long ulBucket;
+
+    ullMicroseconds = (ullCycles * 1000000) / g_ulClockRate;
+    for(ulBucket = 0; (ulBucket < (HIST_BUCKETS - 1)) && ullMicroseconds;
+        ulBucket++)
+    {
+        ullMicroseconds >>= 1;
+    }
+    psHist->pulBucket[ulBucket]++;
+
+    if(!psHist->ulCount || (ullCycles < psHist->ullMin))
+    {
+        psHist->ullMin = ullCycles;
+    }
+    if(ullCycles > psHist->ullMax)
+    {
+        psHist->ullMax = ullCycles;
+    }
+    psHist->ullTotal += ullCycles;
+    psHist->ulCount++;
+}
+
+//*****************************************************************************
+//
+// Prints a histogram, showing only the range of buckets that are in use.
+//
+//*****************************************************************************
+static void
+HistogramPrint(const char *pcTitle, const char *pcName, tHistogram *psHist)
+{
+    unsigned long ulFirst, ulLast, ulBucket, ulMost, ulBar;
+    char pcRange[32];
+
+    if(!psHist->ulCount)
+    {
+        return;
+    }
+
+    QUIETPRINT("\n%s for %s: %lu, min %.2fus, avg %.2fus, max %.2fus\n",
+               pcTitle, pcName, psHist->ulCount,
+               Microseconds(psHist->ullMin),
+               Microseconds(psHist->ullTotal / psHist->ulCount),
+               Microseconds(psHist->ullMax));
+
+    ulFirst = HIST_BUCKETS;
+    ulLast = 0;
+    ulMost = 0;
+    for(ulBucket = 0; ulBucket < HIST_BUCKETS; ulBucket++)
+    {
+        if(psHist->pulBucket[ulBucket])
+        {
+            if(ulFirst == HIST_BUCKETS)
+            {
+                ulFirst = ulBucket;
+            }
+            ulLast = ulBucket;
+            if(psHist->pulBucket[ulBucket] > ulMost)
+            {
+                ulMost = psHist->pulBucket[ulBucket];
+            }
+        }
+    }
+
+    for(ulBucket = ulFirst; ulBucket <= ulLast; ulBucket++)
+    {
+        if(ulBucket == 0)
+        {
+            snprintf(pcRange, sizeof(pcRange), "< 1us");
+        }
+        else if(ulBucket == (HIST_BUCKETS - 1))
+        {
+            snprintf(pcRange, sizeof(pcRange), ">= %luus",
+                     1UL << (ulBucket - 1));
+        }
+        else
+        {
+            snprintf(pcRange, sizeof(pcRange), "%lu - %luus",
+                     1UL << (ulBucket - 1), 1UL << ulBucket);
+        }
+
+        QUIETPRINT("  %16s %8lu ", pcRange, psHist->pulBucket[ulBucket]);
+        ulBar = ((psHist->pulBucket[ulBucket] * 40) + ulMost - 1) / ulMost;
+        while(ulBar--)
+        {
+            QUIETPRINT("#");
+        }
+        QUIETPRINT("\n");
+    }
+}
+
+//*****************************************************************************
+//
+// Writes a string to the timeline, escaping it as JSON requires.
+//
+//*****************************************************************************
+static void
+JSONString(const char *pcString)
+{
+    fputc('"', g_pfJSON);
+    for(; *pcString; pcString++)
+    {
+        if((*pcString == '"') || (*pcString == '\\'))
+        {
+            fputc('\\', g_pfJSON);
+            fputc(*pcString, g_pfJSON);
+        }
+        else if((unsigned char)*pcString < ' ')
+        {
+            fprintf(g_pfJSON, "\\u%04x", (unsigned char)*pcString);
+        }
+        else
+        {
+            fputc(*pcString, g_pfJSON);
+        }
+    }
+    fputc('"', g_pfJSON);
+}
+
+//*****************************************************************************
+//
+// Starts a new event in the timeline, writing the fields common to all.
+//
+//*****************************************************************************
+static void
+JSONEvent(const char *pcPhase, const char *pcName, unsigned long ulTID)
+{
+    fprintf(g_pfJSON, "%s\n{\"ph\":\"%s\",\"pid\":1,\"tid\":%lu,\"name\":",
+            g_bJSONFirst ? "" : ",", pcPhase, ulTID);
+    JSONString(pcName);
+    g_bJSONFirst = FALSE;
+}
+
+//*****************************************************************************
+//
+// Writes a slice of the timeline, such as a task running or an interrupt
+// handler.
+//
+//*****************************************************************************
+static void
+JSONSlice(const char *pcName, unsigned long ulTID,
+          unsigned long long ullStart, unsigned long long ullEnd)
+{
+    if(!g_pfJSON)
+    {
+        return;
+    }
+
+    JSONEvent("X", pcName, ulTID);
+    fprintf(g_pfJSON, ",\"ts\":%.3f,\"dur\":%.3f}", Microseconds(ullStart),
+            Microseconds(ullEnd - ullStart));
+}
+
+//*****************************************************************************
+//
+// Writes an instant event to the timeline, on the row of whatever is running
+// at the time.
+//
+//*****************************************************************************
+static void
+JSONInstant(const char *pcName, const char *pcObject, long lValue,
+            BOOL bFromISR)
+{
+    unsigned long ulTID;
+
+    if(!g_pfJSON)
+    {
+        return;
+    }
+
+    if(g_ulISRDepth)
+    {
+        ulTID = ISR_TID + g_pulISRVector[g_ulISRDepth - 1];
+    }
+    else if(bFromISR || (g_iCurrentTask < 0))
+    {
+        ulTID = ISR_TID;
+    }
+    else
+    {
+        ulTID = g_iCurrentTask + 1;
+    }
+
+    JSONEvent("i", pcName, ulTID);
+    fprintf(g_pfJSON, ",\"ts\":%.3f,\"s\":\"t\",\"args\":{\"object\":",
+            Microseconds(g_ullNow));
+    JSONString(pcObject);
+    if(lValue >= 0)
+    {
+        fprintf(g_pfJSON, ",\"value\":%ld", lValue);
+    }
+    fprintf(g_pfJSON, "}}");
+}
+
+//*****************************************************************************
+//
+// Writes the name of a row of the timeline.
+//
+//*****************************************************************************
+static void
+JSONThreadName(unsigned long ulTID, const char *pcName, unsigned long ulSort)
+{
+    JSONEvent("M", "thread_name", ulTID);
+    fprintf(g_pfJSON, ",\"args\":{\"name\":");
+    JSONString(pcName);
+    fprintf(g_pfJSON, "}}");
+    JSONEvent("M", "thread_sort_index", ulTID);
+    fprintf(g_pfJSON, ",\"args\":{\"sort_index\":%lu}}", ulSort);
+}
+
+//*****************************************************************************
+//
+// Charges the time since the last change of state to whatever was using the
+// processor: an interrupt handler, sleep or a task.
+//
+//*****************************************************************************
+static void
+Charge(void)
+{
+    unsigned long long ullCycles;
+
+    ullCycles = g_ullNow - g_ullLastCharge;
+    g_ullLastCharge = g_ullNow;
+
+    if(g_ulISRDepth)
+    {
+        g_psVectors[g_pulISRVector[g_ulISRDepth - 1]].ullCycles += ullCycles;
+    }
+    else if(g_bAsleep)
+    {
+        g_ullSleepCycles += ullCycles;
+    }
+    else if(g_iCurrentTask >= 0)
+    {
+        g_psTasks[g_iCurrentTask].ullCycles += ullCycles;
+    }
+    else
+    {
+        g_ullUnknownCycles += ullCycles;
+    }
+}
+
+//*****************************************************************************
+//
+// Ends the timeline slice of the running task.
+//
+//*****************************************************************************
+static void
+EndSlice(void)
+{
+    if((g_iCurrentTask >= 0) && (g_ullNow > g_ullSliceStart))
+    {
+        JSONSlice(g_psTasks[g_iCurrentTask].pcName, g_iCurrentTask + 1,
+                  g_ullSliceStart, g_ullNow);
+    }
+}
+
+//*****************************************************************************
+//
+// Returns the name of a queue, giving it a default name if it has none.
+//
+//*****************************************************************************
+static const char *
+QueueName(unsigned long ulQueue)
+{
+    if(!g_psQueues[ulQueue].pcName[0])
+    {
+        snprintf(g_psQueues[ulQueue].pcName, sizeof(g_psQueues[0].pcName),
+                 "Queue %lu", ulQueue);
+    }
+    g_psQueues[ulQueue].bSeen = TRUE;
+    return(g_psQueues[ulQueue].pcName);
+}
+
+//*****************************************************************************
+//
+// Returns the name of a task, giving it a default name if it has none.
+//
+//*****************************************************************************
+static const char *
+TaskName(unsigned long ulTask)
+{
+    if(!g_psTasks[ulTask].pcName[0])
+    {
+        snprintf(g_psTasks[ulTask].pcName, sizeof(g_psTasks[0].pcName),
+                 "Task %lu", ulTask);
+    }
+    g_psTasks[ulTask].bSeen = TRUE;
+    return(g_psTasks[ulTask].pcName);
+}
+
+//*****************************************************************************
+//
+// Replays one record, updating the state of the target.
+//
+//*****************************************************************************
+static void
+DecodeRecord(const unsigned char *pucRecord, BOOL bFirst)
+{
+    unsigned long ulStamp, ulEvent, ulObject, ulParam, ulTicks;
+    unsigned long long ullAsleep, ullMeasured;
+    BOOL bFromISR;
+    tTask *psTask;
+
+    ulStamp = Read32(pucRecord);
+    ulEvent = pucRecord[4];
+    ulObject = pucRecord[5];
+    ulParam = Read16(pucRecord + 6);
+
+    //
+    // Extend the timestamp, which wraps every 2^32 cycles.  Records are never
+    // further apart than that while the kernel is ticking.
+    //
+    if(!bFirst)
+    {
+        g_ullNow += (unsigned long)(ulStamp - g_ulLastStamp) & 0xFFFFFFFF;
+    }
+    g_ulLastStamp = ulStamp;
+
+    bFromISR = (ulEvent & RTOSTRACE_FROM_ISR) ? TRUE : FALSE;
+    ulEvent &= ~RTOSTRACE_FROM_ISR;
+
+    VERBOSEPRINT("%14.3f  event 0x%02lx object %3lu param %5lu%s\n",
+                 Microseconds(g_ullNow), ulEvent, ulObject, ulParam,
+                 bFromISR ? " (from ISR)" : "");
+
+    switch(ulEvent)
+    {
+        case RTOSTRACE_TASK_SWITCH:
+        {
+            Charge();
+            if(g_iCurrentTask == (int)ulObject)
+            {
+                break;
+            }
+            EndSlice();
+
+            psTask = &g_psTasks[ulObject];
+            TaskName(ulObject);
+            psTask->ulSwitches++;
+            if(psTask->bReadyPending)
+            {
+                HistogramAdd(&psTask->sLatency,
+                             g_ullNow - psTask->ullReadyTime);
+                psTask->bReadyPending = FALSE;
+            }
+            g_iCurrentTask = ulObject;
+            g_ullSliceStart = g_ullNow;
+            break;
+        }
+
+        case RTOSTRACE_TASK_READY:
+        {
+            //
+            // Only the first of several ready events before the task runs
+            // counts, and a task that is already running is not waiting.
+            //
+            psTask = &g_psTasks[ulObject];
+            TaskName(ulObject);
+            if(!psTask->bReadyPending && (g_iCurrentTask != (int)ulObject))
+            {
+                psTask->bReadyPending = TRUE;
+                psTask->ullReadyTime = g_ullNow;
+            }
+            break;
+        }
+
+        case RTOSTRACE_TASK_CREATE:
+        {
+            g_psTasks[ulObject].ulPriority = ulParam;
+            JSONInstant("Create", TaskName(ulObject), ulParam, bFromISR);
+            break;
+        }
+
+        case RTOSTRACE_TASK_DELETE:
+        {
+            g_psTasks[ulObject].bReadyPending = FALSE;
+            JSONInstant("Delete", TaskName(ulObject), -1, bFromISR);
+            break;
+        }
+
+        case RTOSTRACE_TASK_DELAY:
+        {
+            JSONInstant("Delay", TaskName(ulObject), -1, bFromISR);
+            break;
+        }
+
+        case RTOSTRACE_TASK_SUSPEND:
+        {
+            g_psTasks[ulObject].bReadyPending = FALSE;
+            JSONInstant("Suspend", TaskName(ulObject), -1, bFromISR);
+            break;
+        }
+
+        case RTOSTRACE_TASK_RESUME:
+        {
+            JSONInstant("Resume", TaskName(ulObject), -1, bFromISR);
+            break;
+        }
+
+        case RTOSTRACE_TASK_PRIORITY:
+        {
+            g_psTasks[ulObject].ulPriority = ulParam;
+            JSONInstant("Priority", TaskName(ulObject), ulParam, bFromISR);
+            break;
+        }
+
+        case RTOSTRACE_TICK:
+        {
+            break;
+        }
+
+        case RTOSTRACE_QUEUE_CREATE:
+        {
+            g_psQueues[ulObject].ulType = ulParam + 1;
+            JSONInstant("Create", QueueName(ulObject), ulParam, bFromISR);
+            break;
+        }
+
+        case RTOSTRACE_QUEUE_SEND:
+        {
+            g_psQueues[ulObject].ulSends++;
+            JSONInstant("Send", QueueName(ulObject), -1, bFromISR);
+            break;
+        }
+
+        case RTOSTRACE_QUEUE_RECEIVE:
+        case RTOSTRACE_QUEUE_PEEK:
+        {
+            g_psQueues[ulObject].ulReceives++;
+            JSONInstant((ulEvent == RTOSTRACE_QUEUE_PEEK) ? "Peek" : "Receive",
+                        QueueName(ulObject), -1, bFromISR);
+            break;
+        }
+
+        case RTOSTRACE_QUEUE_FAILED:
+        {
+            g_psQueues[ulObject].ulFailed++;
+            JSONInstant((ulParam == RTOSTRACE_QUEUE_SEND) ? "Send failed" :
+                        "Receive failed", QueueName(ulObject), -1, bFromISR);
+            break;
+        }
+
+        case RTOSTRACE_QUEUE_BLOCK:
+        {
+            g_psQueues[ulObject].ulBlocked++;
+            JSONInstant((ulParam == RTOSTRACE_QUEUE_SEND) ? "Block on send" :
+                        "Block on receive", QueueName(ulObject), -1,
+                        bFromISR);
+            break;
+        }
+
+        case RTOSTRACE_QUEUE_DELETE:
+        {
+            JSONInstant("Delete", QueueName(ulObject), -1, bFromISR);
+            break;
+        }
+
+        case RTOSTRACE_NOTIFY:
+        {
+            JSONInstant("Notify", TaskName(ulObject), -1, bFromISR);
+            break;
+        }
+
+        case RTOSTRACE_NOTIFY_BLOCK:
+        {
+            JSONInstant("Wait for notification", TaskName(ulObject), -1,
+                        bFromISR);
+            break;
+        }
+
+        case RTOSTRACE_NOTIFY_TAKE:
+        {
+            JSONInstant("Take notification", TaskName(ulObject), -1,
+                        bFromISR);
+            break;
+        }
+
+        case RTOSTRACE_ISR_ENTER:
+        {
+            Charge();
+            if(g_ulISRDepth < MAX_ISR_DEPTH)
+            {
+                g_pulISRVector[g_ulISRDepth] = ulParam & 0xFF;
+                g_pullISRStart[g_ulISRDepth] = g_ullNow;
+                g_psVectors[ulParam & 0xFF].bSeen = TRUE;
+                g_ulISRDepth++;
+            }
+            break;
+        }
+
+        case RTOSTRACE_ISR_EXIT:
+        {
+            //
+            // An exit without an entry is from a handler that was already
+            // running when the oldest record was made, so it is ignored.
+            //
+            if(!g_ulISRDepth ||
+               (g_pulISRVector[g_ulISRDepth - 1] != (ulParam & 0xFF)))
+            {
+                g_ulUnmatchedISR++;
+                break;
+            }
+            Charge();
+            g_ulISRDepth--;
+            HistogramAdd(&g_psVectors[ulParam & 0xFF].sDuration,
+                         g_ullNow - g_pullISRStart[g_ulISRDepth]);
+            JSONSlice(VectorName(ulParam & 0xFF), ISR_TID + (ulParam & 0xFF),
+                      g_pullISRStart[g_ulISRDepth], g_ullNow);
+            break;
+        }
+
+        case RTOSTRACE_IDLE_SLEEP:
+        {
+            Charge();
+            g_bAsleep = TRUE;
+            g_ulSleepTick = ulParam;
+            g_ullSleepStart = g_ullNow;
+            break;
+        }
+
+        case RTOSTRACE_IDLE_WAKE:
+        {
+            if(!g_bAsleep)
+            {
+                break;
+            }
+
+            //
+            // The cycle counter stopped while the processor slept, so use
+            // the number of ticks the kernel stepped over instead, and move
+            // every later event on by the difference.
+            //
+            ulTicks = (ulParam - g_ulSleepTick) & 0xFFFF;
+            ullAsleep = ((unsigned long long)ulTicks * g_ulClockRate) /
+                        g_ulTickRate;
+            ullMeasured = g_ullNow - g_ullSleepStart;
+            if(ullAsleep > ullMeasured)
+            {
+                g_ullSleepAdjust += ullAsleep - ullMeasured;
+                g_ullNow += ullAsleep - ullMeasured;
+            }
+
+            Charge();
+            g_bAsleep = FALSE;
+            JSONSlice("Sleep", SLEEP_TID, g_ullSleepStart, g_ullNow);
+            break;
+        }
+
+        case RTOSTRACE_USER:
+        {
+            char pcChannel[24];
+
+            snprintf(pcChannel, sizeof(pcChannel), "Channel %lu", ulObject);
+            JSONInstant("User", pcChannel, ulParam, bFromISR);
+            break;
+        }
+
+        default:
+        {
+            VERBOSEPRINT("Unknown event 0x%02lx\n", ulEvent);
+            break;
+        }
+    }
+}
+
+//*****************************************************************************
+//
+// Finds the requested dump in the input, checking that its header is one that
+// can be decoded and that the whole dump is present.
+//
+// Returns a pointer to the start of the dump, or NULL if none was found.
+//
+//*****************************************************************************
+static const unsigned char *
+FindDump(const unsigned char *pucData, unsigned long ulSize)
+{
+    unsigned long ulOffset, ulFound, ulNumNames, ulNameSize, ulLength;
+
+    ulFound = 0;
+    for(ulOffset = 0; (ulOffset + HEADER_SIZE) <= ulSize; ulOffset++)
+    {
+        if((Read32(pucData + ulOffset) != RTOSTRACE_MAGIC) ||
+           (Read16(pucData + ulOffset + 4) != RTOSTRACE_VERSION) ||
+           (Read16(pucData + ulOffset + 6) != RECORD_SIZE) ||
+           (Read32(pucData + ulOffset + 8) == 0) ||
+           (Read32(pucData + ulOffset + 12) == 0))
+        {
+            continue;
+        }
+
+        ulNumNames = (Read16(pucData + ulOffset + 24) +
+                      Read16(pucData + ulOffset + 26));
+        ulNameSize = Read16(pucData + ulOffset + 28);
+        ulLength = (HEADER_SIZE + (ulNumNames * ulNameSize) +
+                    (Read32(pucData + ulOffset + 16) * RECORD_SIZE));
+        if((ulNameSize < 3) || ((ulOffset + ulLength) > ulSize))
+        {
+            fprintf(stderr, "Ignoring truncated dump at offset %lu.\n",
+                    ulOffset);
+            continue;
+        }
+
+        if(++ulFound == g_ulDump)
+        {
+            VERBOSEPRINT("Found dump %lu at offset %lu.\n", ulFound, ulOffset);
+            return(pucData + ulOffset);
+        }
+        ulOffset += ulLength - 1;
+    }
+
+    return(NULL);
+}
+
+//*****************************************************************************
+//
+// Reads the names of the tasks and queues from the dump.  Each is a number,
+// a priority or type, and a name padded with zeros.
+//
+// Returns a pointer to the first record.
+//
+//*****************************************************************************
+static const unsigned char *
+ReadNames(const unsigned char *pucDump)
+{
+    unsigned long ulNumTasks, ulNumQueues, ulNameSize, ulIdx, ulLen;
+    const unsigned char *pucName;
+    char *pcName;
+
+    ulNumTasks = Read16(pucDump + 24);
+    ulNumQueues = Read16(pucDump + 26);
+    ulNameSize = Read16(pucDump + 28);
+    pucName = pucDump + HEADER_SIZE;
+
+    for(ulIdx = 0; ulIdx < (ulNumTasks + ulNumQueues); ulIdx++)
+    {
+        if(ulIdx < ulNumTasks)
+        {
+            pcName = g_psTasks[pucName[0]].pcName;
+            g_psTasks[pucName[0]].ulPriority = pucName[1];
+        }
+        else
+        {
+            pcName = g_psQueues[pucName[0]].pcName;
+        }
+
+        ulLen = ulNameSize - 2;
+        if(ulLen > 31)
+        {
+            ulLen = 31;
+        }
+        memcpy(pcName, pucName + 2, ulLen);
+        pcName[ulLen] = 0;
+
+        pucName += ulNameSize;
+    }
+
+    return(pucName);
+}
+
+//*****************************************************************************
+//
+// Prints the share of the processor used by each task and interrupt handler.
+//
+//*****************************************************************************
+static void
+PrintUsage(void)
+{
+    unsigned long long ullTotal;
+    unsigned long ulIdx;
+
+    ullTotal = g_ullSleepCycles + g_ullUnknownCycles;
+    for(ulIdx = 0; ulIdx < 256; ulIdx++)
+    {
+        ullTotal += g_psTasks[ulIdx].ullCycles + g_psVectors[ulIdx].ullCycles;
+    }
+    if(!ullTotal)
+    {
+        return;
+    }
+
+    QUIETPRINT("\n%-16s %4s %12s %7s %9s\n", "Task", "Pri", "Time (us)",
+               "CPU", "Switches");
+    for(ulIdx = 0; ulIdx < 256; ulIdx++)
+    {
+        if(g_psTasks[ulIdx].bSeen)
+        {
+            QUIETPRINT("%-16s %4lu %12.1f %6.2f%% %9lu\n",
+                       g_psTasks[ulIdx].pcName, g_psTasks[ulIdx].ulPriority,
+                       Microseconds(g_psTasks[ulIdx].ullCycles),
+                       (g_psTasks[ulIdx].ullCycles * 100.0) / ullTotal,
+                       g_psTasks[ulIdx].ulSwitches);
+        }
+    }
+    for(ulIdx = 0; ulIdx < 256; ulIdx++)
+    {
+        if(g_psVectors[ulIdx].bSeen)
+        {
+            QUIETPRINT("%-16s %4s %12.1f %6.2f%% %9lu\n",
+                       VectorName(ulIdx), "ISR",
+                       Microseconds(g_psVectors[ulIdx].ullCycles),
+                       (g_psVectors[ulIdx].ullCycles * 100.0) / ullTotal,
+                       g_psVectors[ulIdx].sDuration.ulCount);
+        }
+    }
+    if(g_ullSleepCycles)
+    {
+        QUIETPRINT("%-16s %4s %12.1f %6.2f%%\n", "(asleep)", "",
+                   Microseconds(g_ullSleepCycles),
+                   (g_ullSleepCycles * 100.0) / ullTotal);
+    }
+    if(g_ullUnknownCycles)
+    {
+        QUIETPRINT("%-16s %4s %12.1f %6.2f%%\n", "(no task yet)", "",
+                   Microseconds(g_ullUnknownCycles),
+                   (g_ullUnknownCycles * 100.0) / ullTotal);
+    }
+}
+
+//*****************************************************************************
+//
+// Prints the use made of each queue.
+//
+//*****************************************************************************
+static void
+PrintQueues(void)
+{
+    static const char *ppcTypes[] =
+    {
+        "-", "queue", "mutex", "counting", "binary", "recursive"
+    };
+    unsigned long ulIdx;
+    BOOL bHeading;
+
+    bHeading = FALSE;
+    for(ulIdx = 0; ulIdx < 256; ulIdx++)
+    {
+        if(!g_psQueues[ulIdx].bSeen)
+        {
+            continue;
+        }
+        if(!bHeading)
+        {
+            QUIETPRINT("\n%-16s %-9s %9s %9s %9s %9s\n", "Queue", "Type",
+                       "Sends", "Receives", "Failed", "Blocked");
+            bHeading = TRUE;
+        }
+        QUIETPRINT("%-16s %-9s %9lu %9lu %9lu %9lu\n",
+                   g_psQueues[ulIdx].pcName,
+                   (g_psQueues[ulIdx].ulType < 6) ?
+                   ppcTypes[g_psQueues[ulIdx].ulType] : "?",
+                   g_psQueues[ulIdx].ulSends, g_psQueues[ulIdx].ulReceives,
+                   g_psQueues[ulIdx].ulFailed, g_psQueues[ulIdx].ulBlocked);
+    }
+}
+
+//*****************************************************************************
+//
+// Decodes the trace in the given file.
+//
+// Returns 0 on failure, 1 on success.
+//
+//*****************************************************************************
+static int
+DecodeFile(char *pszFile)
+{
+    const unsigned char *pucDump, *pucRecord;
+    unsigned char *pucData;
+    unsigned long ulSize, ulIdx;
+    FILE *pfFile;
+    long lSize;
+
+    //
+    // Read the whole file.
+    //
+    pfFile = fopen(pszFile, "rb");
+    if(!pfFile)
+    {
+        fprintf(stderr, "Can't open %s.\n", pszFile);
+        return(0);
+    }
+    fseek(pfFile, 0, SEEK_END);
+    lSize = ftell(pfFile);
+    fseek(pfFile, 0, SEEK_SET);
+    if(lSize <= 0)
+    {
+        fprintf(stderr, "%s is empty.\n", pszFile);
+        fclose(pfFile);
+        return(0);
+    }
+    ulSize = lSize;
+    pucData = malloc(ulSize);
+    if(!pucData || (fread(pucData, 1, ulSize, pfFile) != ulSize))
+    {
+        fprintf(stderr, "Can't read %s.\n", pszFile);
+        fclose(pfFile);
+        free(pucData);
+        return(0);
+    }
+    fclose(pfFile);
+
+    pucDump = FindDump(pucData, ulSize);
+    if(!pucDump)
+    {
+        fprintf(stderr, "No trace dump %lu found in %s.\n", g_ulDump,
+                pszFile);
+        free(pucData);
+        return(0);
+    }
+
+    g_ulClockRate = Read32(pucDump + 8);
+    g_ulTickRate = Read32(pucDump + 12);
+    g_ulNumRecords = Read32(pucDump + 16);
+    g_ulLost = Read32(pucDump + 20);
+    pucRecord = ReadNames(pucDump);
+
+    //
+    // Open the timeline.
+    //
+    if(g_pszJSON)
+    {
+        g_pfJSON = fopen(g_pszJSON, "w");
+        if(!g_pfJSON)
+        {
+            fprintf(stderr, "Can't create %s.\n", g_pszJSON);
+            free(pucData);
+            return(0);
+        }
+        fprintf(g_pfJSON, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[");
+    }
+
+    //
+    // Replay the records.
+    //
+    for(ulIdx = 0; ulIdx < g_ulNumRecords; ulIdx++)
+    {
+        DecodeRecord(pucRecord, (ulIdx == 0) ? TRUE : FALSE);
+        pucRecord += RECORD_SIZE;
+    }
+
+    //
+    // Close off whatever was running when the trace ended.
+    //
+    Charge();
+    EndSlice();
+    if(g_bAsleep)
+    {
+        JSONSlice("Sleep", SLEEP_TID, g_ullSleepStart, g_ullNow);
+    }
+
+    if(g_pfJSON)
+    {
+        JSONEvent("M", "process_name", 0);
+        fprintf(g_pfJSON, ",\"args\":{\"name\":\"FreeRTOS\"}}");
+        for(ulIdx = 0; ulIdx < 256; ulIdx++)
+        {
+            if(g_psTasks[ulIdx].bSeen)
+            {
+                JSONThreadName(ulIdx + 1, g_psTasks[ulIdx].pcName, ulIdx + 1);
+            }
+            if(g_psVectors[ulIdx].bSeen)
+            {
+                JSONThreadName(ISR_TID + ulIdx, VectorName(ulIdx), 0);
+            }
+        }
+        JSONThreadName(ISR_TID, "Kernel", 0);
+        if(g_ullSleepCycles)
+        {
+            JSONThreadName(SLEEP_TID, "Sleep", 999);
+        }
+        fprintf(g_pfJSON, "\n]}\n");
+        fclose(g_pfJSON);
+        QUIETPRINT("Wrote timeline to %s\n", g_pszJSON);
+    }
+
+    QUIETPRINT("Decoded %lu events over %.1fus at %luHz", g_ulNumRecords,
+               Microseconds(g_ullNow), g_ulClockRate);
+    if(g_ullSleepAdjust)
+    {
+        QUIETPRINT(", %.1fus of them asleep", Microseconds(g_ullSleepCycles));
+    }
+    QUIETPRINT("\n");
+    if(g_ulLost)
+    {
+        QUIETPRINT("%lu events were lost when the buffer filled.\n", g_ulLost);
+    }
+    if(g_ulUnmatchedISR)
+    {
+        VERBOSEPRINT("%lu interrupt exits had no matching entry.\n",
+                     g_ulUnmatchedISR);
+    }
+
+    free(pucData);
+    return(1);
+}
+
+//*****************************************************************************
+//
+// The main entry point of the trace decoder.
+//
+//*****************************************************************************
+int
+main(int argc, char *argv[])
+{
+    unsigned long ulIdx;
+
+    //
+    // Parse the command line.
+    //
+    if(!ParseCommandLine(argc, argv))
+    {
+        return(1);
+    }
+
+    //
+    // Decode the trace.
+    //
+    QUIETPRINT("Decoding %s\n", g_pszInput);
+    if(!DecodeFile(g_pszInput))
+    {
+        return(1);
+    }
+
+    //
+    // Report the results.
+    //
+    PrintUsage();
+    PrintQueues();
+    for(ulIdx = 0; ulIdx < 256; ulIdx++)
+    {
+        HistogramPrint("Ready to running", g_psTasks[ulIdx].pcName,
+                       &g_psTasks[ulIdx].sLatency);
+    }
+    for(ulIdx = 0; ulIdx < 256; ulIdx++)
+    {
+        HistogramPrint("Time in handler", VectorName(ulIdx),
+                       &g_psVectors[ulIdx].sDuration);
+    }
+
+    return(0);
+}
@@ -1,52 +1,268 @@
 //
-// Implementation of the bulk_usb interface using the linusb-win32 API.
+// Implementation of the LMUSBDLL interface using the libusb-1.0 API.
 //
 
-#ifndef USE_WINUSB
+#ifdef USE_LIBUSB
 
-#include "libusb-win32\include\usb.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#ifndef _WIN32
+#include <time.h>
+#endif
+#include <libusb.h>
+#include "bulk_libusb.h"
+
+//****************************************************************************
+//
+// The configuration and interface used by the generic bulk device and the
+// endpoint addresses of its bulk IN and OUT pipes.
+//
+//****************************************************************************
+#define BULK_CONFIGURATION      1
+#define BULK_INTERFACE          0
+#define BULK_EP_IN              0x81
+#define BULK_EP_OUT             0x01
+
+//****************************************************************************
+//
+// The timeout, in milliseconds, applied to every transfer in benchmark mode.
+//
+//****************************************************************************
+#define BULK_TIMEOUT_MS         5000
+
+//****************************************************************************
+//
+// The maximum number of transfers which may be outstanding at once in
+// benchmark mode.
+//
+//****************************************************************************
+#define MAX_OUTSTANDING         64
+
+//****************************************************************************
+//
+// The packet which switches the usb_dev_bulk example into its source/sink
+// mode, in which it discards everything sent to its OUT endpoint and keeps
+// its IN endpoint supplied with an incrementing count.
+//
+//****************************************************************************
+#define SOURCE_SINK_COMMAND     0x00
 
 //****************************************************************************
 //
 // Structure containing handles and information required to communicate with
-// the USB bulk device.
+// the USB bulk device.  A pointer to this is the LMUSB_HANDLE.
 //
 //****************************************************************************
 typedef struct
 {
-    usb_dev_handle *hDevice;
+    libusb_context *psContext;
+    libusb_device_handle *hDevice;
+}
+tDeviceInfo;
+
+//****************************************************************************
+//
+// The state of a BenchmarkUSBBulk() run, shared with the transfer callback.
+//
+//****************************************************************************
+typedef struct
+{
+    unsigned long ulTransfers;
+    unsigned long ulSubmitted;
+    unsigned long ulCompleted;
+    unsigned long ulActive;
+    BOOL bIn;
+    BOOL bFailed;
+    BOOL bFirstData;
+    unsigned char ucNextData;
+    unsigned long long pullSubmitted[MAX_OUTSTANDING];
+    unsigned long long *pullLatency;
+    tBulkBenchmarkResults *psResults;
+}
+tBenchmark;
 
-} tDeviceInfo;
+//****************************************************************************
+//
+// Records a libusb error as the last error of the calling thread, so that
+// callers may use GetLastError() as they do with the WinUSB version of the
+// interface.
+//
+//****************************************************************************
+static void SetLibUSBError(int iError)
+{
+#ifdef _WIN32
+    DWORD dwError;
 
-tDeviceInfo devInfo;
+    switch(iError)
+    {
+        case LIBUSB_ERROR_TIMEOUT:   dwError = ERROR_SEM_TIMEOUT; break;
+        case LIBUSB_ERROR_NO_DEVICE: dwError = ERROR_DEV_NOT_EXIST; break;
+        case LIBUSB_ERROR_ACCESS:    dwError = ERROR_ACCESS_DENIED; break;
+        case LIBUSB_ERROR_NOT_FOUND: dwError = ERROR_FILE_NOT_FOUND; break;
+        case LIBUSB_ERROR_BUSY:      dwError = ERROR_BUSY; break;
+        case LIBUSB_ERROR_NO_MEM:    dwError = ERROR_NOT_ENOUGH_MEMORY; break;
+        default:                     dwError = ERROR_GEN_FAILURE; break;
+    }
+    SetLastError(dwError);
+#else
+    switch(iError)
+    {
+        case LIBUSB_ERROR_TIMEOUT:   errno = ETIMEDOUT; break;
+        case LIBUSB_ERROR_NO_DEVICE: errno = ENODEV; break;
+        case LIBUSB_ERROR_ACCESS:    errno = EACCES; break;
+        case LIBUSB_ERROR_NOT_FOUND: errno = ENOENT; break;
+        case LIBUSB_ERROR_BUSY:      errno = EBUSY; break;
+        case LIBUSB_ERROR_NO_MEM:    errno = ENOMEM; break;
+        default:                     errno = EIO; break;
+    }
+#endif
+}
+
+//****************************************************************************
+//
+// Returns the current value of a monotonic high resolution timer in
+// microseconds.
+//
+//****************************************************************************
+static unsigned long long GetTimeMicroseconds(void)
+{
+#ifdef _WIN32
+    LARGE_INTEGER liNow;
+    LARGE_INTEGER liFreq;
+
+    QueryPerformanceCounter(&liNow);
+    QueryPerformanceFrequency(&liFreq);
+
+    return(((unsigned long long)(liNow.QuadPart / liFreq.QuadPart) *
+            1000000) +
+           (((unsigned long long)(liNow.QuadPart % liFreq.QuadPart) *
+             1000000) / liFreq.QuadPart));
+#else
+    struct timespec sTime;
+
+    clock_gettime(CLOCK_MONOTONIC, &sTime);
+
+    return(((unsigned long long)sTime.tv_sec * 1000000) +
+           (sTime.tv_nsec / 1000));
+#endif
+}
+
+//****************************************************************************
+//
+// Comparison function used to sort the latency samples.
+//
+//****************************************************************************
+static int CompareLatency(const void *pvA, const void *pvB)
+{
+    unsigned long long ullA = *(const unsigned long long *)pvA;
+    unsigned long long ullB = *(const unsigned long long *)pvB;
+
+    return((ullA < ullB) ? -1 : ((ullA > ullB) ? 1 : 0));
+}
+
+//****************************************************************************
+//
+// Returns the given percentile of a sorted array of latency samples.
+//
+//****************************************************************************
+static unsigned long long GetPercentile(unsigned long long *pullSorted,
+                                        unsigned long ulCount,
+                                        unsigned long ulPercent)
+{
+    unsigned long ulIndex;
+
+    ulIndex = (ulCount * ulPercent) / 100;
+    if(ulIndex >= ulCount)
+    {
+        ulIndex = ulCount - 1;
+    }
+
+    return(pullSorted[ulIndex]);
+}
 
 //****************************************************************************
 //
 // Determines that the required USB device is present, opens it and gathers
 // required information to allow us to read and write it.
 //
-// \param None.
+// \param usVID is the vendor ID of the device to open.
+// \param usPID is the product ID of the device to open.
+// \param lpGUID is the device interface GUID, which is only used by the
+// WinUSB version of the interface since libusb finds devices by their IDs.
+// \param pbDriverInstalled is written with \e TRUE if libusb could be
+// initialized, whether or not the device was found.
 //
 // This function is called to initialize the USB device and perform one-off
 // setup required to allocate handles allowing the application to read and
-// write the device endpoints.
+// write the device endpoints.  Setting the configuration returns the
+// usb_dev_bulk example to its echo mode.
 //
-// \return Returns \e TRUE on success or \e FALSE on failure. In failing
-// cases, GetLastError() can be called to determine the cause.
+// \return Returns a handle to the device on success or \e NULL on failure.
+// In failing cases, GetLastError() can be called to determine the cause.
 //
 //****************************************************************************
-BOOL InitializeDevice(void)
+LMUSB_HANDLE __stdcall InitializeDevice(unsigned short usVID,
+                                        unsigned short usPID,
+                                        LPGUID lpGUID,
+                                        BOOL *pbDriverInstalled)
 {
+    tDeviceInfo *psDevInfo;
+    int iRetcode;
+
+    *pbDriverInstalled = FALSE;
+
+    psDevInfo = malloc(sizeof(tDeviceInfo));
+    if(!psDevInfo)
+    {
+        SetLibUSBError(LIBUSB_ERROR_NO_MEM);
+        return(NULL);
+    }
+
     //
-    // Initialize the libusb-win32 subsystem.
+    // Initialize a libusb context for this device.
     //
-    usb_init();
+    iRetcode = libusb_init(&psDevInfo->psContext);
+    if(iRetcode < 0)
+    {
+        SetLibUSBError(iRetcode);
+        free(psDevInfo);
+        return(NULL);
+    }
+    *pbDriverInstalled = TRUE;
 
     //
-    // 
+    // Look for the first device with the given VID and PID.
     //
+    psDevInfo->hDevice = libusb_open_device_with_vid_pid(psDevInfo->psContext,
+                                                         usVID, usPID);
+    if(!psDevInfo->hDevice)
+    {
+        SetLibUSBError(LIBUSB_ERROR_NOT_FOUND);
+        libusb_exit(psDevInfo->psContext);
+        free(psDevInfo);
+        return(NULL);
+    }
 
-    return(TRUE);
+    //
+    // Select the configuration and claim the bulk interface.
+    //
+    iRetcode = libusb_set_configuration(psDevInfo->hDevice,
+                                        BULK_CONFIGURATION);
+    if(iRetcode == 0)
+    {
+        iRetcode = libusb_claim_interface(psDevInfo->hDevice, BULK_INTERFACE);
+    }
+    if(iRetcode < 0)
+    {
+        SetLibUSBError(iRetcode);
+        libusb_close(psDevInfo->hDevice);
+        libusb_exit(psDevInfo->psContext);
+        free(psDevInfo);
+        return(NULL);
+    }
+
+    return((LMUSB_HANDLE)psDevInfo);
 }
 
 //****************************************************************************
@@ -54,7 +270,7 @@ BOOL InitializeDevice(void)
 // Cleans up and free resources associated with the USB device communication
 // prior to exiting the application.
 //
-// \param None.
+// \param hHandle is the handle returned by InitializeDevice().
 //
 // This function should be called prior to exiting the application to free
 // the resources allocated during InitializeDevice().
@@ -62,8 +278,20 @@ BOOL InitializeDevice(void)
 // \return Returns \e TRUE on success or \e FALSE on failure.
 //
 //****************************************************************************
-BOOL TerminateDevice(void)
+BOOL __stdcall TerminateDevice(LMUSB_HANDLE hHandle)
 {
+    tDeviceInfo *psDevInfo = (tDeviceInfo *)hHandle;
+
+    if(!psDevInfo)
+    {
+        return(FALSE);
+    }
+
+    libusb_release_interface(psDevInfo->hDevice, BULK_INTERFACE);
+    libusb_close(psDevInfo->hDevice);
+    libusb_exit(psDevInfo->psContext);
+    free(psDevInfo);
+
     return(TRUE);
 }
 
@@ -71,19 +299,38 @@ BOOL TerminateDevice(void)
 //
 // Writes a buffer of data to the USB device via the bulk OUT endpoint.
 //
+// \param hHandle is the handle returned by InitializeDevice().
 // \param pcBuffer points to the first byte of data to send.
 // \param ulSize contains the number of bytes of data to send.
-// \param pulWritten is a pointer which will be written with the number of 
+// \param pulWritten is a pointer which will be written with the number of
 // bytes of data actually written to the device.
 //
-// This function is used to send data to the USB device via its bulk OUT endpoint.
+// This function is used to send data to the USB device via its bulk OUT
+// endpoint.
 //
-// \return Returns \e TRUE on success or \e FALSE on failure.
+// \return Returns \e TRUE on success or \e FALSE on failure.  In failing
+// cases, GetLastError() can be called to determine the cause.
 //
 //****************************************************************************
-BOOL WriteUSBPacket(unsigned char *pcBuffer, unsigned long ulSize,
-                           unsigned long *pulWritten)
+BOOL __stdcall WriteUSBPacket(LMUSB_HANDLE hHandle, unsigned char *pcBuffer,
+                              unsigned long ulSize, unsigned long *pulWritten)
 {
+    tDeviceInfo *psDevInfo = (tDeviceInfo *)hHandle;
+    int iRetcode;
+    int iWritten;
+
+    iWritten = 0;
+    iRetcode = libusb_bulk_transfer(psDevInfo->hDevice, BULK_EP_OUT, pcBuffer,
+                                    (int)ulSize, &iWritten, BULK_TIMEOUT_MS);
+
+    *pulWritten = (unsigned long)iWritten;
+
+    if(iRetcode < 0)
+    {
+        SetLibUSBError(iRetcode);
+        return(FALSE);
+    }
+
     return(TRUE);
 }
 
@@ -91,24 +338,345 @@ BOOL WriteUSBPacket(unsigned char *pcBuffer, unsigned long ulSize,
 //
 // Reads data from the USB device via the bulk IN endpoint.
 //
+// \param hHandle is the handle returned by InitializeDevice().
 // \param pcBuffer points to a buffer into which the data from the device will
 // be written.
-// \param ulSize contains the number of bytes that are requested from the 
+// \param ulSize contains the number of bytes that are requested from the
 // device.
-// \param pulRead is a pointer which will be written with the number of 
+// \param pulRead is a pointer which will be written with the number of
 // bytes of data actually read from the device.
+// \param ulTimeoutMs is the number of milliseconds to wait for the data, or
+// \e INFINITE to wait until it arrives.
+// \param hBreak is not supported by this version of the interface and must
+// be \e NULL.
 //
-// This function is used to receivedata from the USB device via its bulk IN
+// This function is used to receive data from the USB device via its bulk IN
 // endpoint.
 //
+// \return Returns \e ERROR_SUCCESS on success or an error code on failure.
+//
+//****************************************************************************
+DWORD __stdcall ReadUSBPacket(LMUSB_HANDLE hHandle, unsigned char *pcBuffer,
+                              unsigned long ulSize, unsigned long *pulRead,
+                              unsigned long ulTimeoutMs, HANDLE hBreak)
+{
+    tDeviceInfo *psDevInfo = (tDeviceInfo *)hHandle;
+    int iRetcode;
+    int iRead;
+
+    iRead = 0;
+    iRetcode = libusb_bulk_transfer(psDevInfo->hDevice, BULK_EP_IN, pcBuffer,
+                                    (int)ulSize, &iRead,
+                                    (ulTimeoutMs == INFINITE) ? 0 :
+                                    (unsigned int)ulTimeoutMs);
+
+    *pulRead = (unsigned long)iRead;
+
+    if(iRetcode < 0)
+    {
+        SetLibUSBError(iRetcode);
+        return(GetLastError());
+    }
+
+    return(ERROR_SUCCESS);
+}
+
+//****************************************************************************
+//
+// Handles the completion of a transfer in benchmark mode, recording its
+// latency and resubmitting it if more transfers remain to be made.
+//
+//****************************************************************************
+static void LIBUSB_CALL BenchmarkCallback(struct libusb_transfer *psTransfer)
+{
+    tBenchmark *psBench = (tBenchmark *)psTransfer->user_data;
+    unsigned long ulSlot;
+    BOOL bError;
+    int iIdx;
+
+    //
+    // Bulk transfers on a single pipe complete in order, so the slot of this
+    // transfer is given by the number that have completed.
+    //
+    ulSlot = psBench->ulCompleted % MAX_OUTSTANDING;
+
+    if(psTransfer->status != LIBUSB_TRANSFER_COMPLETED)
+    {
+        psBench->bFailed = TRUE;
+        psBench->ulActive--;
+        return;
+    }
+
+    psBench->pullLatency[psBench->ulCompleted] =
+        GetTimeMicroseconds() - psBench->pullSubmitted[ulSlot];
+    psBench->psResults->ullBytes += (unsigned long long)psTransfer->actual_length;
+    psBench->ulCompleted++;
+
+    //
+    // Check that data from the device continues the incrementing count
+    // which the usb_dev_bulk example sources, counting each transfer which
+    // does not.
+    //
+    if(psBench->bIn)
+    {
+        bError = FALSE;
+        for(iIdx = 0; iIdx < psTransfer->actual_length; iIdx++)
+        {
+            if(!psBench->bFirstData &&
+               (psTransfer->buffer[iIdx] != psBench->ucNextData))
+            {
+                bError = TRUE;
+            }
+            psBench->bFirstData = FALSE;
+            psBench->ucNextData = psTransfer->buffer[iIdx] + 1;
+        }
+        if(bError)
+        {
+            psBench->psResults->ulDataErrors++;
+        }
+    }
+
+    //
+    // Resubmit the transfer immediately if more are needed.
+    //
+    if(!psBench->bFailed && (psBench->ulSubmitted < psBench->ulTransfers))
+    {
+        psBench->pullSubmitted[psBench->ulSubmitted % MAX_OUTSTANDING] =
+            GetTimeMicroseconds();
+        if(libusb_submit_transfer(psTransfer) == 0)
+        {
+            psBench->ulSubmitted++;
+            return;
+        }
+        psBench->bFailed = TRUE;
+    }
+
+    psBench->ulActive--;
+}
+
+//****************************************************************************
+//
+// Measures throughput and latency of one direction of the bulk pipe.
+//
+// \param hUSB is the handle returned by InitializeDevice().
+// \param bIn is \e TRUE to benchmark the bulk IN endpoint or \e FALSE to
+// benchmark the bulk OUT endpoint.
+// \param ulTransferSize is the number of bytes in each transfer.
+// \param ulOutstanding is the number of transfers which are kept queued to
+// the driver at any one time.  This must be between 1 and MAX_OUTSTANDING.
+// \param ulTransfers is the total number of transfers to perform.
+// \param psResults is a pointer to the structure which will be written with
+// the results of the run.
+//
+// This function keeps \e ulOutstanding asynchronous transfers in flight on
+// the chosen endpoint until \e ulTransfers have completed.  The latency of
+// each transfer is measured from the time it was submitted to the time it
+// completed.  The device at the other end of the pipe must source (for IN)
+// or sink (for OUT) data continuously for the run to complete, as the
+// usb_dev_bulk example does in its source/sink mode.
+//
 // \return Returns \e TRUE on success or \e FALSE on failure.
 //
 //****************************************************************************
-BOOL ReadUSBPacket(unsigned char *pcBuffer, unsigned long ulSize,
-                          unsigned long *pulRead)
+BOOL BenchmarkUSBBulk(LMUSB_HANDLE hUSB, BOOL bIn,
+                      unsigned long ulTransferSize,
+                      unsigned long ulOutstanding, unsigned long ulTransfers,
+                      tBulkBenchmarkResults *psResults)
+{
+    tDeviceInfo *psDevInfo = (tDeviceInfo *)hUSB;
+    struct libusb_transfer *ppsTransfer[MAX_OUTSTANDING];
+    unsigned char *ppucBuffer[MAX_OUTSTANDING];
+    tBenchmark sBench;
+    unsigned long long ullStart;
+    unsigned long ulIdx;
+    BOOL bCancelled;
+
+    memset(psResults, 0, sizeof(tBulkBenchmarkResults));
+
+    if(!psDevInfo || !ulTransferSize || !ulTransfers || !ulOutstanding ||
+       (ulOutstanding > MAX_OUTSTANDING))
+    {
+        return(FALSE);
+    }
+
+    if(ulOutstanding > ulTransfers)
+    {
+        ulOutstanding = ulTransfers;
+    }
 
+    memset(&sBench, 0, sizeof(sBench));
+    sBench.ulTransfers = ulTransfers;
+    sBench.bIn = bIn;
+    sBench.bFirstData = TRUE;
+    sBench.psResults = psResults;
+    sBench.pullLatency = malloc(ulTransfers * sizeof(unsigned long long));
+    if(!sBench.pullLatency)
+    {
+        return(FALSE);
+    }
+
+    //
+    // Set up one transfer and buffer for each slot.
+    //
+    memset(ppsTransfer, 0, sizeof(ppsTransfer));
+    memset(ppucBuffer, 0, sizeof(ppucBuffer));
+    for(ulIdx = 0; ulIdx < ulOutstanding; ulIdx++)
+    {
+        ppucBuffer[ulIdx] = malloc(ulTransferSize);
+        ppsTransfer[ulIdx] = libusb_alloc_transfer(0);
+        if(!ppucBuffer[ulIdx] || !ppsTransfer[ulIdx])
+        {
+            sBench.bFailed = TRUE;
+            break;
+        }
+
+        memset(ppucBuffer[ulIdx], (int)ulIdx, ulTransferSize);
+        libusb_fill_bulk_transfer(ppsTransfer[ulIdx], psDevInfo->hDevice,
+                                  bIn ? BULK_EP_IN : BULK_EP_OUT,
+                                  ppucBuffer[ulIdx], (int)ulTransferSize,
+                                  BenchmarkCallback, &sBench,
+                                  BULK_TIMEOUT_MS);
+    }
+
+    ullStart = GetTimeMicroseconds();
+
+    //
+    // Prime the pipe with the requested number of outstanding transfers.
+    //
+    for(ulIdx = 0; !sBench.bFailed && (ulIdx < ulOutstanding); ulIdx++)
+    {
+        sBench.pullSubmitted[ulIdx] = GetTimeMicroseconds();
+        if(libusb_submit_transfer(ppsTransfer[ulIdx]) < 0)
+        {
+            sBench.bFailed = TRUE;
+            break;
+        }
+        sBench.ulSubmitted++;
+        sBench.ulActive++;
+    }
+
+    //
+    // Let libusb call back as transfers complete until none are left in
+    // flight, cancelling any that remain after an error.
+    //
+    bCancelled = FALSE;
+    while(sBench.ulActive)
+    {
+        if(sBench.bFailed && !bCancelled)
+        {
+            for(ulIdx = 0; ulIdx < ulOutstanding; ulIdx++)
+            {
+                libusb_cancel_transfer(ppsTransfer[ulIdx]);
+            }
+            bCancelled = TRUE;
+        }
+
+        libusb_handle_events(psDevInfo->psContext);
+    }
+
+    psResults->ullMicroseconds = GetTimeMicroseconds() - ullStart;
+
+    //
+    // Free the slots.
+    //
+    for(ulIdx = 0; ulIdx < ulOutstanding; ulIdx++)
+    {
+        if(ppsTransfer[ulIdx])
+        {
+            libusb_free_transfer(ppsTransfer[ulIdx]);
+        }
+        free(ppucBuffer[ulIdx]);
+    }
+
+    //
+    // Summarize the run.
+    //
+    psResults->ulTransfers = sBench.ulCompleted;
+    if(sBench.ulCompleted)
+    {
+        qsort(sBench.pullLatency, sBench.ulCompleted,
+              sizeof(unsigned long long), CompareLatency);
+        psResults->ullLatencyP50 = GetPercentile(sBench.pullLatency,
+                                                 sBench.ulCompleted, 50);
+        psResults->ullLatencyP90 = GetPercentile(sBench.pullLatency,
+                                                 sBench.ulCompleted, 90);
+        psResults->ullLatencyP99 = GetPercentile(sBench.pullLatency,
+                                                 sBench.ulCompleted, 99);
+        psResults->ullLatencyMax = sBench.pullLatency[sBench.ulCompleted - 1];
+    }
+
+    free(sBench.pullLatency);
+
+    return(sBench.bFailed ? FALSE : TRUE);
+}
+
+//****************************************************************************
+//
+// Runs the bulk benchmark in both directions and prints the results.
+//
+// \param hUSB is the handle returned by InitializeDevice().
+// \param ulTransferSize is the number of bytes in each transfer.
+// \param ulOutstanding is the number of transfers kept in flight at once.
+// \param ulTransfers is the number of transfers to perform per direction.
+//
+// This function switches the usb_dev_bulk example into its source/sink mode
+// and then measures the OUT and IN directions in turn.  The device stays in
+// source/sink mode until its configuration is next set, such as by the next
+// call to InitializeDevice().
+//
+// \return Returns \e TRUE if both directions completed or \e FALSE on
+// failure.
+//
+//****************************************************************************
+BOOL RunUSBBulkBenchmark(LMUSB_HANDLE hUSB, unsigned long ulTransferSize,
+                         unsigned long ulOutstanding,
+                         unsigned long ulTransfers)
 {
-    return(TRUE);
+    tBulkBenchmarkResults sResults;
+    unsigned char ucCommand;
+    unsigned long ulWritten;
+    BOOL bRetcode;
+    int iDir;
+
+    //
+    // Switch the device into source/sink mode.
+    //
+    ucCommand = SOURCE_SINK_COMMAND;
+    if(!WriteUSBPacket(hUSB, &ucCommand, 1, &ulWritten) || (ulWritten != 1))
+    {
+        printf("Unable to switch the device to source/sink mode.\n");
+        return(FALSE);
+    }
+
+    bRetcode = TRUE;
+
+    printf("Transfer size %lu bytes, %lu outstanding, %lu transfers\n\n",
+           ulTransferSize, ulOutstanding, ulTransfers);
+    printf("Dir   MB/s      p50(us)   p90(us)   p99(us)   max(us)   "
+           "errors\n");
+
+    for(iDir = 0; iDir < 2; iDir++)
+    {
+        if(!BenchmarkUSBBulk(hUSB, iDir ? TRUE : FALSE, ulTransferSize,
+                             ulOutstanding, ulTransfers, &sResults))
+        {
+            printf("%-5s failed after %lu transfers\n", iDir ? "IN" : "OUT",
+                   sResults.ulTransfers);
+            bRetcode = FALSE;
+            continue;
+        }
+
+        printf("%-5s %-9.2f %-9llu %-9llu %-9llu %-9llu %lu\n",
+               iDir ? "IN" : "OUT",
+               sResults.ullMicroseconds ?
+               ((double)sResults.ullBytes / (double)sResults.ullMicroseconds) :
+               0.0,
+               sResults.ullLatencyP50, sResults.ullLatencyP90,
+               sResults.ullLatencyP99, sResults.ullLatencyMax,
+               sResults.ulDataErrors);
+    }
+
+    return(bRetcode);
 }
 
-#endif // not defined USE_WINUSB
+#endif // defined USE_LIBUSB
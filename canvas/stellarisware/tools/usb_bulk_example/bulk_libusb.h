@@ -0,0 +1,88 @@
+//*****************************************************************************
+//
+// bulk_libusb.h - Public header for the libusb-1.0 implementation of the
+//                 LMUSBDLL interface used by usb_bulk_example.
+//
+//*****************************************************************************
+
+#ifndef __BULK_LIBUSB_H__
+#define __BULK_LIBUSB_H__
+
+//****************************************************************************
+//
+// The LMUSBDLL interface is declared using Windows types.  On other hosts,
+// define the few of them that it and usb_bulk_example need.
+//
+//****************************************************************************
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <errno.h>
+#include <wchar.h>
+
+typedef int BOOL;
+typedef unsigned long DWORD;
+typedef unsigned long ULONG;
+typedef void *HANDLE;
+typedef unsigned char UCHAR, *PUCHAR;
+typedef unsigned short USHORT, *PUSHORT;
+typedef wchar_t TCHAR, *LPTSTR;
+
+typedef struct
+{
+    unsigned long Data1;
+    unsigned short Data2;
+    unsigned short Data3;
+    unsigned char Data4[8];
+}
+GUID, *LPGUID;
+
+#define TRUE                    1
+#define FALSE                   0
+#define INFINITE                0xffffffff
+#define ERROR_SUCCESS           0
+#define __stdcall
+#define GetLastError()          ((DWORD)errno)
+#define DEFINE_GUID(name, l, w1, w2, b1, b2, b3, b4, b5, b6, b7, b8)        \
+        const GUID name = { l, w1, w2, { b1, b2, b3, b4, b5, b6, b7, b8 } }
+#endif
+
+#include "lmusbdll.h"
+
+//****************************************************************************
+//
+// The results of a single direction of a BenchmarkUSBBulk() run.  Latencies
+// are in microseconds, measured from submission to completion of each
+// transfer.
+//
+//****************************************************************************
+typedef struct
+{
+    unsigned long ulTransfers;
+    unsigned long ulDataErrors;
+    unsigned long long ullBytes;
+    unsigned long long ullMicroseconds;
+    unsigned long long ullLatencyP50;
+    unsigned long long ullLatencyP90;
+    unsigned long long ullLatencyP99;
+    unsigned long long ullLatencyMax;
+}
+tBulkBenchmarkResults;
+
+//****************************************************************************
+//
+// The benchmark mode, which is only available in this implementation since
+// it relies upon the asynchronous transfer API of libusb.
+//
+//****************************************************************************
+extern BOOL BenchmarkUSBBulk(LMUSB_HANDLE hUSB, BOOL bIn,
+                             unsigned long ulTransferSize,
+                             unsigned long ulOutstanding,
+                             unsigned long ulTransfers,
+                             tBulkBenchmarkResults *psResults);
+extern BOOL RunUSBBulkBenchmark(LMUSB_HANDLE hUSB,
+                                unsigned long ulTransferSize,
+                                unsigned long ulOutstanding,
+                                unsigned long ulTransfers);
+
+#endif // __BULK_LIBUSB_H__
@@ -48,11 +48,28 @@
 // rebuilt even without the DDK installed on the development system.  To
 // update and rebuild lmusbdll itself, however, the DDK is still required.
 //
+// If built with USE_LIBUSB defined, the application uses bulk_libusb.c in
+// place of lmusbdll.  This implements the same interface using libusb-1.0,
+// allowing the application to be built for Linux as well as Windows, and
+// adds a benchmark mode, selected by the "-b" switch, which measures the
+// throughput and latency of both directions of the bulk pipe.
+//
 //****************************************************************************
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#ifdef _WIN32
 #include <windows.h>
 #include <strsafe.h>
 #include <initguid.h>
+#else
+#include <time.h>
+#endif
+#ifdef USE_LIBUSB
+#include "bulk_libusb.h"
+#else
 #include "lmusbdll.h"
+#endif
 #include "luminary_guids.h"
 
 //****************************************************************************
@@ -78,6 +95,16 @@
 //****************************************************************************
 #define ECHO_PACKET_SIZE 64
 
+//****************************************************************************
+//
+// The default transfer size, number of outstanding transfers and number of
+// transfers in each direction if in benchmark mode.
+//
+//****************************************************************************
+#define BENCH_TRANSFER_SIZE 4096
+#define BENCH_OUTSTANDING 8
+#define BENCH_TRANSFERS 1000
+
 //****************************************************************************
 //
 // Buffer into which error messages are written.
@@ -114,6 +141,7 @@ ULONG g_ulPacketCount = 0;
 //****************************************************************************
 LPTSTR GetSystemErrorString(DWORD dwError)
 {
+#ifdef _WIN32
     DWORD dwRetcode;
 
     //
@@ -141,6 +169,41 @@ LPTSTR GetSystemErrorString(DWORD dwError)
 
         return(g_pcErrorString);
     }
+#else
+    //
+    // Other hosts report errors using errno values.
+    //
+    mbstowcs(g_pcErrorString, strerror((int)dwError), MAX_STRING_LEN);
+    g_pcErrorString[MAX_STRING_LEN - 1] = 0;
+
+    return(g_pcErrorString);
+#endif
+}
+
+//****************************************************************************
+//
+// Returns the current time of day in milliseconds.
+//
+//****************************************************************************
+ULONG GetTimeMilliseconds(void)
+{
+#ifdef _WIN32
+    SYSTEMTIME sSysTime;
+
+    //
+    // Get the current system time.
+    //
+    GetSystemTime(&sSysTime);
+    return((((((sSysTime.wHour * 60) +
+               sSysTime.wMinute) * 60) +
+              sSysTime.wSecond) * 1000) + sSysTime.wMilliseconds);
+#else
+    struct timespec sTime;
+
+    clock_gettime(CLOCK_REALTIME, &sTime);
+    return((ULONG)(((sTime.tv_sec % 86400) * 1000) +
+                   (sTime.tv_nsec / 1000000)));
+#endif
 }
 
 //****************************************************************************
@@ -154,15 +217,11 @@ void UpdateThroughput(void)
     static ULONG ulLast = 0;
     ULONG ulNow;
     ULONG ulElapsed;
-    SYSTEMTIME sSysTime;
 
     //
     // Get the current system time.
     //
-    GetSystemTime(&sSysTime);
-    ulNow = (((((sSysTime.wHour * 60) +
-               sSysTime.wMinute) * 60) +
-              sSysTime.wSecond) * 1000) + sSysTime.wMilliseconds;
+    ulNow = GetTimeMilliseconds();
 
     //
     // If this is the first call, set the start time.
@@ -186,7 +245,7 @@ void UpdateThroughput(void)
     {
 
         //printf("\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b");
-        printf("\r%6dKbps Packets: %10d ", ((g_ulByteCount * 8) / ulElapsed), g_ulPacketCount);
+        printf("\r%6luKbps Packets: %10lu ", ((g_ulByteCount * 8) / ulElapsed), g_ulPacketCount);
         g_ulByteCount = 0;
         ulStartTime = ulNow;
     }
@@ -214,12 +273,17 @@ int main(int argc, char *argv[])
     BOOL bResult;
     BOOL bDriverInstalled;
     BOOL bEcho;
+    BOOL bBenchmark;
     char szBuffer[USB_BUFFER_LEN];
     ULONG ulWritten;
     ULONG ulRead;
     ULONG ulLength;
     DWORD dwError;
     LMUSB_HANDLE hUSB;
+    unsigned long ulTransferSize;
+    unsigned long ulOutstanding;
+    unsigned long ulTransfers;
+    int iExitCode;
 
     //
     // Are we operating in echo mode or not? The "-e" parameter tells the
@@ -227,13 +291,35 @@ int main(int argc, char *argv[])
     //
     bEcho = ((argc > 1) && (argv[1][1] == 'e')) ? TRUE : FALSE;
 
+    //
+    // Are we operating in benchmark mode?  The "-b" parameter may be
+    // followed by the transfer size, the number of transfers to keep
+    // outstanding and the number of transfers in each direction.
+    //
+    bBenchmark = ((argc > 1) && (argv[1][1] == 'b')) ? TRUE : FALSE;
+    ulTransferSize = (argc > 2) ? strtoul(argv[2], NULL, 0) :
+                                  BENCH_TRANSFER_SIZE;
+    ulOutstanding = (argc > 3) ? strtoul(argv[3], NULL, 0) :
+                                 BENCH_OUTSTANDING;
+    ulTransfers = (argc > 4) ? strtoul(argv[4], NULL, 0) : BENCH_TRANSFERS;
+    iExitCode = 0;
+
     //
     // Print a cheerful welcome.
     //
     printf("\nStellaris Bulk USB Device Example\n");
     printf( "---------------------------------\n\n");
     printf("Version %s\n\n", BLDVER);
-    if(!bEcho)
+    if(bBenchmark)
+    {
+        printf("If run with the \"-b [size] [outstanding] [transfers]\"\n");
+        printf("command line switch, this application switches the\n");
+        printf("usb_dev_bulk example into its source/sink mode then keeps\n");
+        printf("the given number of transfers of the given size in flight\n");
+        printf("on each bulk endpoint in turn, and reports the throughput\n");
+        printf("and latency of each direction.\n\n");
+    }
+    else if(!bEcho)
     {
         printf("This is a partner application to the usb_dev_bulk example\n");
         printf("shipped with StellarisWare software releases for USB-enabled\n");
@@ -260,11 +346,29 @@ int main(int argc, char *argv[])
 
     if(hUSB)
     {
+        if(bBenchmark)
+        {
+#ifdef USE_LIBUSB
+            //
+            // Measure both directions of the bulk pipe.
+            //
+            if(!RunUSBBulkBenchmark(hUSB, ulTransferSize, ulOutstanding,
+                                    ulTransfers))
+            {
+                iExitCode = 1;
+            }
+#else
+            printf("Benchmark mode requires the libusb build of this\n");
+            printf("application, with USE_LIBUSB defined.\n");
+            iExitCode = 1;
+#endif
+        }
+
         //
         // Are we operating in echo mode or not? The "-e" parameter tells the
         // app to echo everything it receives back to the device unchanged.
         //
-        if(bEcho)
+        else if(bEcho)
         {
             //
             // Yes - we are in echo mode.
@@ -276,7 +380,7 @@ int main(int argc, char *argv[])
                 //
                 // Read a block of data from the device.
                 //
-                dwError = ReadUSBPacket(hUSB, szBuffer, ECHO_PACKET_SIZE, &ulRead,
+                dwError = ReadUSBPacket(hUSB, (unsigned char *)szBuffer, ECHO_PACKET_SIZE, &ulRead,
                                         INFINITE, NULL);
 
                 if(dwError != ERROR_SUCCESS)
@@ -284,7 +388,7 @@ int main(int argc, char *argv[])
                     //
                     // We failed to read from the device.
                     //
-                    printf("\n\nError %d (%S) reading from bulk IN pipe.\n", dwError,
+                    printf("\n\nError %lu (%S) reading from bulk IN pipe.\n", dwError,
                            GetSystemErrorString(dwError));
                     break;
                 }
@@ -299,14 +403,14 @@ int main(int argc, char *argv[])
                     //
                     // Write the data back out to the device.
                     //
-                    bResult = WriteUSBPacket(hUSB, szBuffer, ulRead, &ulWritten);
+                    bResult = WriteUSBPacket(hUSB, (unsigned char *)szBuffer, ulRead, &ulWritten);
                     if(!bResult)
                     {
                         //
                         // We failed to write the data for some reason.
                         //
                         dwError = GetLastError();
-                        printf("\n\nError %d (%S) writing to bulk OUT pipe.\n", dwError,
+                        printf("\n\nError %lu (%S) writing to bulk OUT pipe.\n", dwError,
                                GetSystemErrorString(dwError));
                         break;
                     }
@@ -379,14 +483,14 @@ int main(int argc, char *argv[])
                 //
                 // Write the user's string to the device.
                 //
-                bResult = WriteUSBPacket(hUSB, szBuffer, ulLength, &ulWritten);
+                bResult = WriteUSBPacket(hUSB, (unsigned char *)szBuffer, ulLength, &ulWritten);
                 if(!bResult)
                 {
                     //
                     // We failed to write the data for some reason.
                     //
                     dwError = GetLastError();
-                    printf("Error %d (%S) writing to bulk OUT pipe.\n", dwError,
+                    printf("Error %lu (%S) writing to bulk OUT pipe.\n", dwError,
                            GetSystemErrorString(dwError));
                 }
                 else
@@ -394,13 +498,13 @@ int main(int argc, char *argv[])
                     //
                     // We wrote data successfully so now read it back.
                     //
-                    printf("Wrote %d bytes to the device. Expected %d\n",
+                    printf("Wrote %lu bytes to the device. Expected %lu\n",
                            ulWritten, ulLength);
 
                     //
                     // We expect the same number of bytes as we just sent.
                     //
-                    dwError = ReadUSBPacket(hUSB, szBuffer, ulWritten, &ulRead,
+                    dwError = ReadUSBPacket(hUSB, (unsigned char *)szBuffer, ulWritten, &ulRead,
                                             INFINITE, NULL);
 
                     if(dwError != ERROR_SUCCESS)
@@ -408,7 +512,7 @@ int main(int argc, char *argv[])
                         //
                         // We failed to read from the device.
                         //
-                        printf("Error %d (%S) reading from bulk IN pipe.\n", dwError,
+                        printf("Error %lu (%S) reading from bulk IN pipe.\n", dwError,
                                GetSystemErrorString(dwError));
                     }
                     else
@@ -419,7 +523,7 @@ int main(int argc, char *argv[])
                         //
                         szBuffer[ulRead] = '\0';
 
-                        printf("Read %d bytes from device. Expected %d\n",
+                        printf("Read %lu bytes from device. Expected %lu\n",
                                ulRead, ulWritten);
                         printf("\nReturned string: \"%s\"\n", szBuffer);
                     }
@@ -435,7 +539,7 @@ int main(int argc, char *argv[])
         dwError = GetLastError();
 
         printf("\nUnable to initialize the Stellaris Bulk USB Device.\n");
-        printf("Error code is %d (%S)\n\n", dwError, GetSystemErrorString(dwError));
+        printf("Error code is %lu (%S)\n\n", dwError, GetSystemErrorString(dwError));
         printf("Please make sure you have a Stellaris USB-enabled evaluation\n");
         printf("or development kit running the usb_dev_bulk example\n");
         printf("application connected to this system via the \"USB OTG\" or\n");
@@ -450,5 +554,5 @@ int main(int argc, char *argv[])
 
     TerminateDevice(hUSB);
 
-    return(0);
+    return(iExitCode);
 }
@@ -43,6 +43,82 @@
 //
 //*****************************************************************************
 
+//*****************************************************************************
+//
+// The maximum number of interface descriptors (counting each alternate
+// setting separately) and endpoint descriptors which can be held in the
+// configuration descriptor index.  Interface numbers must also be less than
+// USBDCD_INDEX_MAX_INTERFACES.  Lookups in a configuration which does not
+// fit fall back to walking the descriptor sections.
+//
+//*****************************************************************************
+#ifndef USBDCD_INDEX_MAX_INTERFACES
+#define USBDCD_INDEX_MAX_INTERFACES 16
+#endif
+#ifndef USBDCD_INDEX_MAX_ENDPOINTS
+#define USBDCD_INDEX_MAX_ENDPOINTS  32
+#endif
+
+//*****************************************************************************
+//
+// The index of the interface and endpoint descriptors in a single
+// configuration descriptor, built by USBDCDConfigDescIndex().
+//
+//*****************************************************************************
+typedef struct
+{
+    //
+    // The configuration descriptor that this index describes or 0 if there
+    // is no valid index.
+    //
+    const tConfigHeader *psConfig;
+
+    //
+    // The total size of the configuration descriptor.
+    //
+    unsigned long ulSize;
+
+    //
+    // The number of interface and endpoint descriptors in the configuration.
+    //
+    unsigned char ucNumInterfaces;
+    unsigned char ucNumEndpoints;
+
+    //
+    // The interface descriptors in the order they appear in the
+    // configuration, the section each is found in and the index within
+    // ppsEndpoint of the first endpoint descriptor that follows it.
+    //
+    tInterfaceDescriptor *ppsInterface[USBDCD_INDEX_MAX_INTERFACES];
+    unsigned char pucInterfaceSection[USBDCD_INDEX_MAX_INTERFACES];
+    unsigned char pucFirstEndpoint[USBDCD_INDEX_MAX_INTERFACES];
+
+    //
+    // The endpoint descriptors in the order they appear in the configuration
+    // and the section each is found in.
+    //
+    tEndpointDescriptor *ppsEndpoint[USBDCD_INDEX_MAX_ENDPOINTS];
+    unsigned char pucEndpointSection[USBDCD_INDEX_MAX_ENDPOINTS];
+
+    //
+    // The positions within ppsInterface of the interface descriptors grouped
+    // by interface number, keeping the order in which they appear within
+    // each group.  The descriptors for interface n are the pucAltCount[n]
+    // entries of pucAltOrder starting at pucAltStart[n].
+    //
+    unsigned char pucAltCount[USBDCD_INDEX_MAX_INTERFACES];
+    unsigned char pucAltStart[USBDCD_INDEX_MAX_INTERFACES];
+    unsigned char pucAltOrder[USBDCD_INDEX_MAX_INTERFACES];
+}
+tConfigDescIndex;
+
+//*****************************************************************************
+//
+// The index of the configuration descriptor currently in use.
+//
+//*****************************************************************************
+static tConfigDescIndex g_sConfigIndex;
+
 //*****************************************************************************
 //
 //! \internal
@@ -111,6 +187,27 @@ NextConfigDescGet(const tConfigHeader *psConfig, unsigned long *pulSec,
     return(psDesc);
 }
 
+//*****************************************************************************
+//
+// Finds the position within the configuration descriptor index of the
+// ulIndex-th interface descriptor with the given interface number.  Returns
+// -1 if there is no such descriptor.
+//
+//*****************************************************************************
+static long
+IndexAlternateInterfaceFind(unsigned char ucInterfaceNumber,
+                            unsigned long ulIndex)
+{
+    if((ucInterfaceNumber >= USBDCD_INDEX_MAX_INTERFACES) ||
+       (ulIndex >= g_sConfigIndex.pucAltCount[ucInterfaceNumber]))
+    {
+        return(-1);
+    }
+
+    return((long)g_sConfigIndex.pucAltOrder[
+                     g_sConfigIndex.pucAltStart[ucInterfaceNumber] + ulIndex]);
+}
+
 //*****************************************************************************
 //
 //! \internal
@@ -144,6 +241,22 @@ ConfigAlternateInterfaceGet(const tConfigHeader *psConfig,
     tDescriptorHeader *psDescCheck;
     unsigned long ulCount;
     unsigned long ulSec;
+    long lPos;
+
+    //
+    // If this configuration is indexed then look the descriptor up there.
+    //
+    if(psConfig == g_sConfigIndex.psConfig)
+    {
+        lPos = IndexAlternateInterfaceFind(ucInterfaceNumber, ulIndex);
+        if(lPos < 0)
+        {
+            return((tInterfaceDescriptor *)0);
+        }
+
+        *pulSection = g_sConfigIndex.pucInterfaceSection[lPos];
+        return(g_sConfigIndex.ppsInterface[lPos]);
+    }
 
     //
     // Set up for our descriptor counting loop.
@@ -200,6 +313,146 @@ ConfigAlternateInterfaceGet(const tConfigHeader *psConfig,
     return((tInterfaceDescriptor *)0);
 }
 
+//*****************************************************************************
+//
+//! \internal
+//!
+//! Builds an index of the interface and endpoint descriptors within a config
+//! descriptor defined in terms of a collection of concatenated sections.
+//!
+//! \param psConfig points to the header structure for the configuration
+//! descriptor which is to be indexed or 0 to discard the current index.
+//!
+//! This function walks the supplied configuration descriptor once and records
+//! the location of every interface and endpoint descriptor within it.  Until
+//! the next call, the USBDCDConfig functions in this file answer queries on
+//! \e psConfig from the index rather than searching the descriptor again,
+//! so enumeration requests no longer cost time proportional to the size of
+//! the descriptor.  Queries on any other configuration descriptor are
+//! unaffected.
+//!
+//! The index holds pointers into the descriptor sections so it must be
+//! rebuilt if the descriptor is changed after this call.
+//!
+//! \return Returns \b true if the index was built or \b false if the
+//! descriptor contains too many interfaces or endpoints, or an interface
+//! number too large, to be indexed, in which case queries continue to search
+//! the descriptor.
+//
+//*****************************************************************************
+tBoolean
+USBDCDConfigDescIndex(const tConfigHeader *psConfig)
+{
+    tDescriptorHeader *psDesc;
+    unsigned long ulSec;
+    unsigned long ulLoop;
+    unsigned long ulStart;
+    unsigned char ucNumber;
+
+    //
+    // Invalidate any previous index before we start.
+    //
+    g_sConfigIndex.psConfig = 0;
+    g_sConfigIndex.ucNumInterfaces = 0;
+    g_sConfigIndex.ucNumEndpoints = 0;
+
+    if(!psConfig)
+    {
+        return(false);
+    }
+
+    //
+    // Walk every descriptor in the configuration, noting the position of
+    // each interface and endpoint descriptor.
+    //
+    psDesc = (tDescriptorHeader *)psConfig->psSections[0]->pucData;
+    ulSec = 0;
+
+    while(psDesc)
+    {
+        if(psDesc->bDescriptorType == USB_DTYPE_INTERFACE)
+        {
+            if(g_sConfigIndex.ucNumInterfaces == USBDCD_INDEX_MAX_INTERFACES)
+            {
+                return(false);
+            }
+
+            g_sConfigIndex.ppsInterface[g_sConfigIndex.ucNumInterfaces] =
+                (tInterfaceDescriptor *)psDesc;
+            g_sConfigIndex.pucInterfaceSection[
+                g_sConfigIndex.ucNumInterfaces] = (unsigned char)ulSec;
+            g_sConfigIndex.pucFirstEndpoint[g_sConfigIndex.ucNumInterfaces] =
+                g_sConfigIndex.ucNumEndpoints;
+            g_sConfigIndex.ucNumInterfaces++;
+        }
+        else if(psDesc->bDescriptorType == USB_DTYPE_ENDPOINT)
+        {
+            if(g_sConfigIndex.ucNumEndpoints == USBDCD_INDEX_MAX_ENDPOINTS)
+            {
+                return(false);
+            }
+
+            g_sConfigIndex.ppsEndpoint[g_sConfigIndex.ucNumEndpoints] =
+                (tEndpointDescriptor *)psDesc;
+            g_sConfigIndex.pucEndpointSection[
+                g_sConfigIndex.ucNumEndpoints] = (unsigned char)ulSec;
+            g_sConfigIndex.ucNumEndpoints++;
+        }
+
+        psDesc = NextConfigDescGet(psConfig, &ulSec, psDesc);
+    }
+
+    //
+    // Group the interface descriptors by interface number so that each
+    // alternate setting can be found without a search.  Count the
+    // descriptors for each interface number and turn the counts into the
+    // start of each group.
+    //
+    for(ulLoop = 0; ulLoop < USBDCD_INDEX_MAX_INTERFACES; ulLoop++)
+    {
+        g_sConfigIndex.pucAltCount[ulLoop] = 0;
+    }
+
+    for(ulLoop = 0; ulLoop < g_sConfigIndex.ucNumInterfaces; ulLoop++)
+    {
+        ucNumber = g_sConfigIndex.ppsInterface[ulLoop]->bInterfaceNumber;
+        if(ucNumber >= USBDCD_INDEX_MAX_INTERFACES)
+        {
+            return(false);
+        }
+        g_sConfigIndex.pucAltCount[ucNumber]++;
+    }
+
+    ulStart = 0;
+    for(ulLoop = 0; ulLoop < USBDCD_INDEX_MAX_INTERFACES; ulLoop++)
+    {
+        g_sConfigIndex.pucAltStart[ulLoop] = (unsigned char)ulStart;
+        ulStart += g_sConfigIndex.pucAltCount[ulLoop];
+        g_sConfigIndex.pucAltCount[ulLoop] = 0;
+    }
+
+    //
+    // Place each descriptor in its group, counting the groups up again as
+    // they are filled so that the descriptors keep their order.
+    //
+    for(ulLoop = 0; ulLoop < g_sConfigIndex.ucNumInterfaces; ulLoop++)
+    {
+        ucNumber = g_sConfigIndex.ppsInterface[ulLoop]->bInterfaceNumber;
+        g_sConfigIndex.pucAltOrder[g_sConfigIndex.pucAltStart[ucNumber] +
+                                   g_sConfigIndex.pucAltCount[ucNumber]] =
+            (unsigned char)ulLoop;
+        g_sConfigIndex.pucAltCount[ucNumber]++;
+    }
+
+    //
+    // The index is complete so mark it valid.
+    //
+    g_sConfigIndex.ulSize = USBDCDConfigDescGetSize(psConfig);
+    g_sConfigIndex.psConfig = psConfig;
+
+    return(true);
+}
+
 //*****************************************************************************
 //
 //! \internal
@@ -220,6 +473,14 @@ USBDCDConfigDescGetSize(const tConfigHeader *psConfig)
     unsigned long ulLoop;
     unsigned long ulLen;
 
+    //
+    // Use the size recorded in the index if we have one.
+    //
+    if(psConfig == g_sConfigIndex.psConfig)
+    {
+        return(g_sConfigIndex.ulSize);
+    }
+
     ulLen = 0;
 
     //
@@ -268,6 +529,21 @@ USBDCDConfigDescGetNum(const tConfigHeader *psConfig, unsigned long ulType)
     unsigned long ulSection;
     unsigned long ulNumDescs;
 
+    //
+    // Interface and endpoint counts are available directly from the index.
+    //
+    if(psConfig == g_sConfigIndex.psConfig)
+    {
+        if(ulType == USB_DTYPE_INTERFACE)
+        {
+            return(g_sConfigIndex.ucNumInterfaces);
+        }
+        else if(ulType == USB_DTYPE_ENDPOINT)
+        {
+            return(g_sConfigIndex.ucNumEndpoints);
+        }
+    }
+
     //
     // Initialize our counts.
     //
@@ -328,6 +604,34 @@ USBDCDConfigDescGet(const tConfigHeader *psConfig, unsigned long ulType,
     unsigned long ulTotalDescs;
     unsigned long ulNumDescs;
 
+    //
+    // Interface and endpoint descriptors can be found directly from the
+    // index.
+    //
+    if(psConfig == g_sConfigIndex.psConfig)
+    {
+        if(ulType == USB_DTYPE_INTERFACE)
+        {
+            if(ulIndex >= g_sConfigIndex.ucNumInterfaces)
+            {
+                return((tDescriptorHeader *)0);
+            }
+
+            *pulSection = g_sConfigIndex.pucInterfaceSection[ulIndex];
+            return((tDescriptorHeader *)g_sConfigIndex.ppsInterface[ulIndex]);
+        }
+        else if(ulType == USB_DTYPE_ENDPOINT)
+        {
+            if(ulIndex >= g_sConfigIndex.ucNumEndpoints)
+            {
+                return((tDescriptorHeader *)0);
+            }
+
+            *pulSection = g_sConfigIndex.pucEndpointSection[ulIndex];
+            return((tDescriptorHeader *)g_sConfigIndex.ppsEndpoint[ulIndex]);
+        }
+    }
+
     //
     // Initialize our counts.
     //
@@ -419,6 +723,15 @@ USBDCDConfigGetNumAlternateInterfaces(const tConfigHeader *psConfig,
     unsigned long ulCount;
     unsigned long ulSec;
 
+    //
+    // If this configuration is indexed then the count is held there.
+    //
+    if(psConfig == g_sConfigIndex.psConfig)
+    {
+        return((ucInterfaceNumber < USBDCD_INDEX_MAX_INTERFACES) ?
+               g_sConfigIndex.pucAltCount[ucInterfaceNumber] : 0);
+    }
+
     //
     // Set up for our descriptor counting loop.
     //
@@ -570,6 +883,52 @@ USBDCDConfigGetInterfaceEndpoint(const tConfigHeader *psConfig,
     tDescriptorHeader *psEndpoint;
     unsigned long ulSection;
     unsigned long ulCount;
+    unsigned long ulLimit;
+    long lPos;
+
+    //
+    // If this configuration is indexed, the endpoint descriptors for each
+    // interface immediately follow it in the index.
+    //
+    if(psConfig == g_sConfigIndex.psConfig)
+    {
+        //
+        // As in USBDCDConfigGetInterface(), USB_DESC_ANY selects the
+        // ulInterfaceNumber-th interface descriptor in the configuration
+        // descriptor, which is its position in the index.
+        //
+        if(ulAltCfg == USB_DESC_ANY)
+        {
+            lPos = (ulInterfaceNumber < g_sConfigIndex.ucNumInterfaces) ?
+                   (long)ulInterfaceNumber : -1;
+        }
+        else
+        {
+            lPos = IndexAlternateInterfaceFind(
+                                        (unsigned char)ulInterfaceNumber,
+                                        ulAltCfg);
+        }
+
+        if((lPos < 0) ||
+           (ulIndex >= g_sConfigIndex.ppsInterface[lPos]->bNumEndpoints))
+        {
+            return((tEndpointDescriptor *)0);
+        }
+
+        ulCount = g_sConfigIndex.pucFirstEndpoint[lPos] + ulIndex;
+        ulLimit = ((lPos + 1) < g_sConfigIndex.ucNumInterfaces) ?
+                  g_sConfigIndex.pucFirstEndpoint[lPos + 1] :
+                  g_sConfigIndex.ucNumEndpoints;
+
+        //
+        // If the interface has fewer endpoint descriptors than it claims,
+        // fall back to the search below which behaves as it always has.
+        //
+        if(ulCount < ulLimit)
+        {
+            return(g_sConfigIndex.ppsEndpoint[ulCount]);
+        }
+    }
 
     //
     // Find the requested interface descriptor.
@@ -64,6 +64,7 @@ static void USBDSetInterface(void *pvInstance, tUSBRequest *pUSBRequest);
 static void USBDSyncFrame(void *pvInstance, tUSBRequest *pUSBRequest);
 static void USBDEP0StateTx(unsigned long ulIndex);
 static void USBDEP0StateTxConfig(unsigned long ulIndex);
+static void USBDStringTableIndex(tDeviceInstance *psDevInst);
 static long USBDStringIndexFromRequest(unsigned short usLang,
                                        unsigned short usIndex);
 
@@ -352,6 +353,13 @@ USBDCDInit(unsigned long ulIndex, tDeviceInfo *psDevice)
                 g_psUSBDevice[0].ulDefaultConfiguration - 1];
     psDesc = (const tConfigDescriptor *)(psHdr->psSections[0]->pucData);
 
+    //
+    // Index the default configuration descriptor and the string table so
+    // that enumeration requests do not need to search them.
+    //
+    USBDCDConfigDescIndex(psHdr);
+    USBDStringTableIndex(&g_psUSBDevice[0]);
+
     //
     // Default to the state where remote wake up is disabled.
     //
@@ -457,6 +465,11 @@ USBDCDTerm(unsigned long ulIndex)
     g_psUSBDevice[0].psInfo = (tDeviceInfo *)0;
     g_psUSBDevice[0].pvInstance = 0;
 
+    //
+    // The descriptors may not remain valid so discard the index.
+    //
+    USBDCDConfigDescIndex(0);
+
     MAP_USBIntDisableControl(USB0_BASE, USB_INTCTRL_ALL);
     MAP_USBIntDisableEndpoint(USB0_BASE, USB_INTEP_ALL);
 
@@ -1880,6 +1893,78 @@ USBDGetDescriptor(void *pvInstance, tUSBRequest *pUSBRequest)
     }
 }
 
+//*****************************************************************************
+//
+// This function records the layout of the device's string descriptor table.
+//
+// \param psDevInst is the USB device controller instance data.
+//
+// The string table is arranged as descriptor 0, which lists the supported
+// language IDs, followed by one group of strings for each language.  This
+// function determines the number of languages and the number of strings in
+// each group once so that USBDStringIndexFromRequest() does not need to do
+// so on every request.
+//
+// We assume that there are an equal number of strings per language.  If the
+// table does not have this layout, the number of strings per language is set
+// to 0 and all requests other than for descriptor 0 will fail.
+//
+// \return None.
+//
+//*****************************************************************************
+static void
+USBDStringTableIndex(tDeviceInstance *psDevInst)
+{
+    tDeviceInfo *psDevice;
+
+    psDevInst->ulNumStringLangs = 0;
+    psDevInst->ulNumStringsPerLang = 0;
+
+    //
+    // Make sure we have a string table at all.
+    //
+    psDevice = psDevInst->psInfo;
+    if((psDevice == 0) || (psDevice->ppStringDescriptors == 0) ||
+       (psDevice->ulNumStringDescriptors == 0))
+    {
+        return;
+    }
+
+    //
+    // How many languages does this device support?  This is determined by
+    // looking at the length of the first descriptor in the string table,
+    // subtracting 2 for the header and dividing by two (the size of each
+    // language code).
+    //
+    psDevInst->ulNumStringLangs = (psDevice->ppStringDescriptors[0][0] - 2) / 2;
+    if(psDevInst->ulNumStringLangs == 0)
+    {
+        return;
+    }
+
+    //
+    // We assume that the table includes the same number of strings for each
+    // supported language.  We know the number of entries in the string table,
+    // so how many are there for each language?  This may seem an odd way to
+    // do this (why not just have the application tell us in the device info
+    // structure?) but it's needed since we didn't want to change the API
+    // after the first release which did not support multiple languages.
+    //
+    psDevInst->ulNumStringsPerLang = ((psDevice->ulNumStringDescriptors - 1) /
+                                      psDevInst->ulNumStringLangs);
+
+    //
+    // Just to be sure, make sure that the calculation indicates an equal
+    // number of strings per language.  We expect the string table to contain
+    // (1 + (strings_per_language * languages)) entries.
+    //
+    if((1 + (psDevInst->ulNumStringsPerLang * psDevInst->ulNumStringLangs)) !=
+       psDevice->ulNumStringDescriptors)
+    {
+        psDevInst->ulNumStringsPerLang = 0;
+    }
+}
+
 //*****************************************************************************
 //
 // This function determines which string descriptor to send to satisfy a
@@ -1894,9 +1979,8 @@ USBDGetDescriptor(void *pvInstance, tUSBRequest *pUSBRequest)
 // descriptor array which is arranged as multiple groups of strings with
 // one group for each language advertised via string descriptor 0.
 //
-// We assume that there are an equal number of strings per language and
-// that the first descriptor is the language descriptor and use this fact to
-// perform the mapping.
+// The layout of the table is determined by USBDStringTableIndex() when the
+// device is initialized.
 //
 // \return The index of the string descriptor to return or -1 if the string
 // could not be found.
@@ -1906,8 +1990,6 @@ static long
 USBDStringIndexFromRequest(unsigned short usLang, unsigned short usIndex)
 {
     tString0Descriptor *pLang;
-    unsigned long ulNumLangs;
-    unsigned long ulNumStringsPerLang;
     unsigned long ulLoop;
 
     //
@@ -1930,31 +2012,10 @@ USBDStringIndexFromRequest(unsigned short usLang, unsigned short usIndex)
     }
 
     //
-    // How many languages does this device support?  This is determined by
-    // looking at the length of the first descriptor in the string table,
-    // subtracting 2 for the header and dividing by two (the size of each
-    // language code).
+    // Reject indices beyond the end of each language's group of strings.
+    // This also rejects every request if the table layout was not valid.
     //
-    ulNumLangs = (g_psUSBDevice[0].psInfo->ppStringDescriptors[0][0] - 2) / 2;
-
-    //
-    // We assume that the table includes the same number of strings for each
-    // supported language.  We know the number of entries in the string table,
-    // so how many are there for each language?  This may seem an odd way to
-    // do this (why not just have the application tell us in the device info
-    // structure?) but it's needed since we didn't want to change the API
-    // after the first release which did not support multiple languages.
-    //
-    ulNumStringsPerLang = ((g_psUSBDevice[0].psInfo->ulNumStringDescriptors - 1) /
-                           ulNumLangs);
-
-    //
-    // Just to be sure, make sure that the calculation indicates an equal
-    // number of strings per language.  We expect the string table to contain
-    // (1 + (strings_per_language * languages)) entries.
-    //
-    if((1 + (ulNumStringsPerLang * ulNumLangs)) !=
-       g_psUSBDevice[0].psInfo->ulNumStringDescriptors)
+    if(usIndex > g_psUSBDevice[0].ulNumStringsPerLang)
     {
         return(-1);
     }
@@ -1966,11 +2027,7 @@ USBDStringIndexFromRequest(unsigned short usLang, unsigned short usIndex)
     //
     pLang = (tString0Descriptor *)(g_psUSBDevice[0].psInfo->ppStringDescriptors[0]);
 
-    //
-    // Look through the supported languages looking for the one we were asked
-    // for.
-    //
-    for(ulLoop = 0; ulLoop < ulNumLangs; ulLoop++)
+    for(ulLoop = 0; ulLoop < g_psUSBDevice[0].ulNumStringLangs; ulLoop++)
     {
         //
         // Have we found the requested language?
@@ -1980,7 +2037,7 @@ USBDStringIndexFromRequest(unsigned short usLang, unsigned short usIndex)
             //
             // Yes - calculate the index of the descriptor to send.
             //
-            return((ulNumStringsPerLang * ulLoop) + usIndex);
+            return((g_psUSBDevice[0].ulNumStringsPerLang * ulLoop) + usIndex);
         }
     }
 
@@ -2148,6 +2205,12 @@ USBDSetConfiguration(void *pvInstance, tUSBRequest *pUSBRequest)
             psHdr = psDevice->ppConfigDescriptors[pUSBRequest->wValue - 1];
             psDesc = (const tConfigDescriptor *)(psHdr->psSections[0]->pucData);
 
+            //
+            // Index the new configuration so that configuring its endpoints
+            // and any later SET_INTERFACE requests do not need to search it.
+            //
+            USBDCDConfigDescIndex(psHdr);
+
             //
             // Remember the new self- or bus-powered state if the user has not
             // already called us to tell us the state to report.
@@ -170,6 +170,7 @@ extern void USBDCDSendDataEP0(unsigned long ulIndex, unsigned char *pucData,
                               unsigned long ulSize);
 extern void USBDCDSetDefaultConfiguration(unsigned long ulIndex,
                                           unsigned long ulDefaultConfig);
+extern tBoolean USBDCDConfigDescIndex(const tConfigHeader *psConfig);
 extern unsigned long USBDCDConfigDescGetSize(const tConfigHeader *psConfig);
 extern unsigned long USBDCDConfigDescGetNum(const tConfigHeader *psConfig,
                                             unsigned long ulType);
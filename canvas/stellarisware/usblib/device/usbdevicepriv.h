@@ -194,6 +194,15 @@ struct tDeviceInstance
     // number of milliseconds since the signaling was initiated.
     //
     unsigned char ucRemoteWakeupCount;
+
+    //
+    // The number of languages listed in string descriptor 0 and the number
+    // of strings provided for each.  These are calculated once by
+    // USBDCDInit() and the count of strings is 0 if the string table is not
+    // usable.
+    //
+    unsigned long ulNumStringLangs;
+    unsigned long ulNumStringsPerLang;
 };
 
 extern tDeviceInstance g_psUSBDevice[];
@@ -25,6 +25,7 @@
 #include "inc/hw_memmap.h"
 #include "inc/hw_types.h"
 #include "driverlib/debug.h"
+#include "driverlib/interrupt.h"
 #include "driverlib/usb.h"
 #include "driverlib/rom.h"
 #include "driverlib/rom_map.h"
@@ -159,10 +160,12 @@ unsigned char g_pHIDDescriptor[] =
 //*****************************************************************************
 //
 // The remainder of the configuration descriptor is stored in flash since we
-// don't need to modify anything in it at runtime.
+// don't need to modify anything in it at runtime.  The interface and endpoint
+// descriptors are templates which are copied into each instance so that the
+// endpoint count, protocol and polling interval can be set per instance.
 //
 //*****************************************************************************
-unsigned char g_pHIDInterface[] =
+const unsigned char g_pHIDInterface[] =
 {
     //
     // HID Device Class Interface Descriptor.
@@ -190,7 +193,7 @@ const unsigned char g_pHIDInEndpoint[] =
     USB_EP_DESC_IN | USB_EP_TO_INDEX(INT_IN_ENDPOINT),
     USB_EP_ATTR_INT,            // Endpoint is an interrupt endpoint.
     USBShort(INT_IN_EP_MAX_SIZE), // The maximum packet size.
-    16,                         // The polling interval for this endpoint.
+    USBDHID_POLL_INTERVAL_DEFAULT, // The polling interval for this endpoint.
 };
 
 const unsigned char g_pHIDOutEndpoint[] =
@@ -203,7 +206,7 @@ const unsigned char g_pHIDOutEndpoint[] =
     USB_EP_DESC_OUT | USB_EP_TO_INDEX(INT_OUT_ENDPOINT),
     USB_EP_ATTR_INT,            // Endpoint is an interrupt endpoint.
     USBShort(INT_OUT_EP_MAX_SIZE), // The maximum packet size.
-    16,                         // The polling interval for this endpoint.
+    USBDHID_POLL_INTERVAL_DEFAULT, // The polling interval for this endpoint.
 };
 
 //*****************************************************************************
@@ -212,11 +215,15 @@ const unsigned char g_pHIDOutEndpoint[] =
 // depending upon the client's configuration choice.  These sections are:
 //
 // 1.  The 9 byte configuration descriptor (RAM).
-// 2.  The interface descriptor (RAM).
+// 2.  The interface descriptor (RAM, per instance).
 // 3.  The HID report and physical descriptors (provided by the client)
 //     (FLASH).
-// 4.  The mandatory interrupt IN endpoint descriptor (FLASH).
-// 5.  The optional interrupt OUT endpoint descriptor (FLASH).
+// 4.  The mandatory interrupt IN endpoint descriptor (RAM, per instance).
+// 5.  The optional interrupt OUT endpoint descriptor (RAM, per instance).
+//
+// All but the first section, the list of sections, the configuration header
+// and the device information structure are held in the tHIDInstance
+// structure since they differ between instances.
 //
 //*****************************************************************************
 const tConfigSection g_sHIDConfigSection =
@@ -225,77 +232,6 @@ const tConfigSection g_sHIDConfigSection =
     g_pHIDDescriptor
 };
 
-const tConfigSection g_sHIDInterfaceSection =
-{
-    sizeof(g_pHIDInterface),
-    g_pHIDInterface
-};
-
-const tConfigSection g_sHIDInEndpointSection =
-{
-    sizeof(g_pHIDInEndpoint),
-    g_pHIDInEndpoint
-};
-
-const tConfigSection g_sHIDOutEndpointSection =
-{
-    sizeof(g_pHIDOutEndpoint),
-    g_pHIDOutEndpoint
-};
-
-//*****************************************************************************
-//
-// Place holder for the user's HID descriptor block.
-//
-//*****************************************************************************
-tConfigSection g_sHIDDescriptorSection =
-{
-   0, (void *)0
-};
-
-//*****************************************************************************
-//
-// This array lists all the sections that must be concatenated to make a
-// single, complete HID configuration descriptor.
-//
-//*****************************************************************************
-const tConfigSection *g_psHIDSections[] =
-{
-    &g_sHIDConfigSection,
-    &g_sHIDInterfaceSection,
-    &g_sHIDDescriptorSection,
-    &g_sHIDInEndpointSection,
-    &g_sHIDOutEndpointSection
-};
-
-#define NUM_HID_SECTIONS (sizeof(g_psHIDSections) /                         \
-                          sizeof(tConfigSection *))
-
-//*****************************************************************************
-//
-// The header for the single configuration we support.  This is the root of
-// the data structure that defines all the bits and pieces that are pulled
-// together to generate the configuration descriptor.  Note that this must be
-// in RAM since we need to include or exclude the final section based on
-// client supplied initialization parameters.
-//
-//*****************************************************************************
-tConfigHeader g_sHIDConfigHeader =
-{
-    NUM_HID_SECTIONS,
-    g_psHIDSections
-};
-
-//*****************************************************************************
-//
-// Configuration Descriptor.
-//
-//*****************************************************************************
-const tConfigHeader * const g_pHIDConfigDescriptors[] =
-{
-    &g_sHIDConfigHeader
-};
-
 //*****************************************************************************
 //
 // Forward references for device handler callbacks
@@ -316,7 +252,8 @@ static void HandleDevice(void *pvInstance, unsigned long ulRequest,
 
 //*****************************************************************************
 //
-// The device information structure for the USB HID devices.
+// The device information structure for the USB HID devices.  This is a
+// template which is copied into each instance's tHIDInstance structure.
 //
 //*****************************************************************************
 tDeviceInfo g_sHIDDeviceInfo =
@@ -339,7 +276,7 @@ tDeviceInfo g_sHIDDeviceInfo =
         HandleDevice           // Device handler.
     },
     g_pHIDDeviceDescriptor,
-    g_pHIDConfigDescriptors,
+    0,                         // Will be completed during USBDHIDInit().
     0,                         // Will be completed during USBDHIDInit().
     0,                         // Will be completed during USBDHIDInit().
     &g_sUSBDefaultFIFOConfig
@@ -861,6 +798,132 @@ ScheduleReportTransmission(tHIDInstance *psInst)
     return(lRetcode);
 }
 
+//*****************************************************************************
+//
+// Sends the oldest report held in the report queue.
+//
+// \param psDevice is the device instance whose report queue is to be serviced.
+//
+// This function is called whenever the interrupt IN endpoint may have become
+// free, either from the USB interrupt or with interrupts disabled.  If the
+// endpoint is idle and the queue holds a report, the report is scheduled for
+// transmission and removed from the queue.  Queued reports always fit in a
+// single packet so the endpoint FIFO holds a copy of the report once it has
+// been scheduled and the queue entry may be reused immediately.
+//
+// \return None.
+//
+//*****************************************************************************
+static void
+SendQueuedReport(const tUSBDHIDDevice *psDevice)
+{
+    tHIDInstance *psInst;
+    unsigned long ulRead;
+
+    psInst = psDevice->psPrivateHIDData;
+
+    if(psInst->ucQueueCount && (psInst->eHIDTxState == HID_STATE_IDLE) &&
+       (psInst->bSendInProgress == false))
+    {
+        ulRead = psInst->ucQueueRead;
+
+        if(USBDHIDReportWrite((void *)psDevice, psInst->pucQueue[ulRead],
+                              psInst->pucQueueSize[ulRead], true))
+        {
+            psInst->ucQueueRead = (ulRead + 1) % USBDHID_REPORT_QUEUE_DEPTH;
+            psInst->ucQueueCount--;
+        }
+    }
+}
+
+//*****************************************************************************
+//
+// Attempts to merge a report into a report that is waiting in the queue.
+//
+// \param pucQueued points to the queued report.
+// \param pucData points to the new report.
+// \param ulLength is the length of both reports in bytes.
+// \param psMap describes the relative fields of the reports.
+//
+// Two reports may be merged if every byte outside the relative fields is
+// identical, so that no button press or absolute position is lost, and if
+// summing each relative field does not overflow.  If so, the queued report
+// is updated with the sums.
+//
+// \return Returns \b true if the reports were merged or \b false otherwise.
+//
+//*****************************************************************************
+static tBoolean
+CoalesceReport(unsigned char *pucQueued, const unsigned char *pucData,
+               unsigned long ulLength, const tHIDCoalesceMap *psMap)
+{
+    unsigned long ulIdx, ulRelative;
+    long plSum[USBDHID_REPORT_QUEUE_SIZE];
+
+    //
+    // Build a mask of every byte that belongs to a relative field.
+    //
+    ulRelative = psMap->ulRelative8 | psMap->ulRelative16 |
+                 (psMap->ulRelative16 << 1);
+
+    //
+    // Check the fixed bytes and compute the sums before touching the queued
+    // report, since the merge must be all or nothing.
+    //
+    for(ulIdx = 0; ulIdx < ulLength; ulIdx++)
+    {
+        if(!(ulRelative & (1 << ulIdx)))
+        {
+            if(pucQueued[ulIdx] != pucData[ulIdx])
+            {
+                return(false);
+            }
+        }
+        else if(psMap->ulRelative8 & (1 << ulIdx))
+        {
+            plSum[ulIdx] = (long)(signed char)pucQueued[ulIdx] +
+                           (long)(signed char)pucData[ulIdx];
+            if((plSum[ulIdx] < -128) || (plSum[ulIdx] > 127))
+            {
+                return(false);
+            }
+        }
+        else if(psMap->ulRelative16 & (1 << ulIdx))
+        {
+            if(ulIdx + 1 >= ulLength)
+            {
+                return(false);
+            }
+            plSum[ulIdx] = (long)(short)(pucQueued[ulIdx] |
+                                         (pucQueued[ulIdx + 1] << 8)) +
+                           (long)(short)(pucData[ulIdx] |
+                                         (pucData[ulIdx + 1] << 8));
+            if((plSum[ulIdx] < -32768) || (plSum[ulIdx] > 32767))
+            {
+                return(false);
+            }
+        }
+    }
+
+    //
+    // The reports can be merged so store the sums.
+    //
+    for(ulIdx = 0; ulIdx < ulLength; ulIdx++)
+    {
+        if(psMap->ulRelative8 & (1 << ulIdx))
+        {
+            pucQueued[ulIdx] = (unsigned char)plSum[ulIdx];
+        }
+        else if(psMap->ulRelative16 & (1 << ulIdx))
+        {
+            pucQueued[ulIdx] = (unsigned char)plSum[ulIdx];
+            pucQueued[ulIdx + 1] = (unsigned char)(plSum[ulIdx] >> 8);
+        }
+    }
+
+    return(true);
+}
+
 //*****************************************************************************
 //
 // Receives notifications related to data received from the host.
@@ -971,6 +1034,7 @@ ProcessDataToHost(const tUSBDHIDDevice *psDevice, unsigned long ulStatus)
 {
     tHIDInstance *psInst;
     unsigned long ulEPStatus;
+    unsigned long ulSize;
 
     //
     // Get a pointer to our instance data.
@@ -999,12 +1063,19 @@ ProcessDataToHost(const tUSBDHIDDevice *psDevice, unsigned long ulStatus)
         // We finished sending the last report so are idle once again.
         //
         psInst->eHIDTxState = HID_STATE_IDLE;
+        ulSize = psInst->usInReportSize;
+
+        //
+        // If reports were queued while this one was being sent, send the
+        // next one straight away to keep the latency down.
+        //
+        SendQueuedReport(psDevice);
 
         //
         // Notify the client that the report transmission completed.
         //
         psDevice->pfnTxCallback(psDevice->pvTxCBData, USB_EVENT_TX_COMPLETE,
-                                psInst->usInReportSize, (void *)0);
+                                ulSize, (void *)0);
 
         //
         // Do we have any reports to send as a result of idle timer timeouts?
@@ -1101,6 +1172,11 @@ HandleConfigChange(void *pvInstance, unsigned long ulInfo)
     psInst->eHIDRxState = HID_STATE_IDLE;
     psInst->eHIDTxState = HID_STATE_IDLE;
 
+    //
+    // Discard any reports queued for a previous configuration.
+    //
+    psInst->ucQueueCount = 0;
+
     //
     // If we are not currently connected let the client know we are open for
     // business.
@@ -1220,9 +1296,11 @@ HandleDisconnect(void *pvInstance)
     }
 
     //
-    // Remember that we are no longer connected.
+    // Remember that we are no longer connected and discard any reports that
+    // were waiting to be sent.
     //
     psDevice->psPrivateHIDData->bConnected = false;
+    psDevice->psPrivateHIDData->ucQueueCount = 0;
 }
 
 //*****************************************************************************
@@ -1876,6 +1954,11 @@ HIDTickHandler(void *pvInstance, unsigned long ulTimemS)
 //! USB_EVENT_TX_COMPLETE event is sent to the application transmit callback to
 //! inform it that another report may be transmitted.
 //!
+//! Alternatively, reports of up to USBDHID_REPORT_QUEUE_SIZE bytes may be
+//! passed to USBDHIDReportQueue() at any time.  These are queued while a
+//! previous report is being transmitted and reports which differ only in
+//! their relative fields, such as pointer movement, are merged.
+//!
 //! Receive Operation (when using a dedicated interrupt OUT endpoint):
 //!
 //! An incoming USB data packet will result in a call to the application
@@ -1940,6 +2023,9 @@ USBDHIDInit(unsigned long ulIndex, const tUSBDHIDDevice *psDevice)
 //! \param psDevice points to a structure containing parameters customizing
 //! the operation of the HID device.
 //!
+//! Each instance builds its own device information structure, so the
+//! tCompositeEntry for this instance must point to the \e psDevInfo member
+//! of the instance's private data rather than to a shared structure.
 //!
 //! \return Returns NULL on failure or the \e psDevice pointer on success.
 //
@@ -1969,7 +2055,8 @@ USBDHIDCompositeInit(unsigned long ulIndex, const tUSBDHIDDevice *psDevice)
     //
     psInst = psDevice->psPrivateHIDData;
     psInst->psConfDescriptor = (tConfigDescriptor *)g_pHIDDescriptor;
-    psInst->psDevInfo = &g_sHIDDeviceInfo;
+    psInst->sDevInfo = g_sHIDDeviceInfo;
+    psInst->psDevInfo = &psInst->sDevInfo;
     psInst->ulUSBBase = USB0_BASE;
     psInst->eHIDRxState = HID_STATE_UNCONFIGURED;
     psInst->eHIDTxState = HID_STATE_UNCONFIGURED;
@@ -1982,6 +2069,8 @@ USBDHIDCompositeInit(unsigned long ulIndex, const tUSBDHIDDevice *psDevice)
     psInst->pucInReportData = (unsigned char *)0;
     psInst->usOutReportSize = 0;
     psInst->pucOutReportData = (unsigned char *)0;
+    psInst->ucQueueRead = 0;
+    psInst->ucQueueCount = 0;
 
     //
     // Set the default endpoint and interface assignments.
@@ -2008,30 +2097,64 @@ USBDHIDCompositeInit(unsigned long ulIndex, const tUSBDHIDDevice *psDevice)
     // Slot the client's HID descriptor into our standard configuration
     // descriptor.
     //
-    g_sHIDDescriptorSection.usSize = psDevice->psHIDDescriptor->bLength;
-    g_sHIDDescriptorSection.pucData =
+    psInst->sHIDDescriptorSection.usSize =
+                                psDevice->psHIDDescriptor->bLength;
+    psInst->sHIDDescriptorSection.pucData =
                                 (unsigned char *)psDevice->psHIDDescriptor;
 
     //
-    // Fix up the interface and endpoint descriptors depending upon client
-    // choices.
+    // Copy the interface descriptor into this instance and fix it up
+    // depending upon client choices.
     //
-    psDevIf = (tInterfaceDescriptor *)g_pHIDInterface;
+    psInst->sInterface = *(const tInterfaceDescriptor *)g_pHIDInterface;
+    psDevIf = &psInst->sInterface;
     psDevIf->bNumEndpoints = psDevice->bUseOutEndpoint ? 2 : 1;
     psDevIf->bInterfaceSubClass = psDevice->ucSubclass;
     psDevIf->bInterfaceProtocol = psDevice->ucProtocol;
 
+    //
+    // Copy the endpoint descriptors into this instance and set the polling
+    // interval for the interrupt endpoints.
+    //
+    psInst->sInEndpoint = *(const tEndpointDescriptor *)g_pHIDInEndpoint;
+    psInst->sOutEndpoint = *(const tEndpointDescriptor *)g_pHIDOutEndpoint;
+    psInst->sInEndpoint.bInterval =
+        psDevice->ucPollIntervalmS ? psDevice->ucPollIntervalmS :
+                                     USBDHID_POLL_INTERVAL_DEFAULT;
+    psInst->sOutEndpoint.bInterval = psInst->sInEndpoint.bInterval;
+
+    //
+    // Build the list of sections that make up this instance's configuration
+    // descriptor.
+    //
+    psInst->sInterfaceSection.usSize = sizeof(tInterfaceDescriptor);
+    psInst->sInterfaceSection.pucData =
+                                (unsigned char *)&psInst->sInterface;
+    psInst->sInEndpointSection.usSize = sizeof(tEndpointDescriptor);
+    psInst->sInEndpointSection.pucData =
+                                (unsigned char *)&psInst->sInEndpoint;
+    psInst->sOutEndpointSection.usSize = sizeof(tEndpointDescriptor);
+    psInst->sOutEndpointSection.pucData =
+                                (unsigned char *)&psInst->sOutEndpoint;
+    psInst->psConfigSections[0] = &g_sHIDConfigSection;
+    psInst->psConfigSections[1] = &psInst->sInterfaceSection;
+    psInst->psConfigSections[2] = &psInst->sHIDDescriptorSection;
+    psInst->psConfigSections[3] = &psInst->sInEndpointSection;
+    psInst->psConfigSections[4] = &psInst->sOutEndpointSection;
+    psInst->sConfigHeader.psSections = psInst->psConfigSections;
+    psInst->psConfigHeader = &psInst->sConfigHeader;
+
     //
     // If necessary, remove the interrupt OUT endpoint from the configuration
     // descriptor.
     //
     if(psDevice->bUseOutEndpoint == false)
     {
-        g_sHIDConfigHeader.ucNumSections = (NUM_HID_SECTIONS - 1);
+        psInst->sConfigHeader.ucNumSections = (NUM_HID_SECTIONS - 1);
     }
     else
     {
-        g_sHIDConfigHeader.ucNumSections = NUM_HID_SECTIONS;
+        psInst->sConfigHeader.ucNumSections = NUM_HID_SECTIONS;
     }
 
     //
@@ -2041,6 +2164,7 @@ USBDHIDCompositeInit(unsigned long ulIndex, const tUSBDHIDDevice *psDevice)
     psInst->psDevInfo->ppStringDescriptors = psDevice->ppStringDescriptors;
     psInst->psDevInfo->ulNumStringDescriptors
             = psDevice->ulNumStringDescriptors;
+    psInst->psDevInfo->ppConfigDescriptors = &psInst->psConfigHeader;
     psInst->psDevInfo->pvInstance = (void *)psDevice;
 
     //
@@ -2302,6 +2426,130 @@ USBDHIDReportWrite(void *pvInstance, unsigned char *pcData,
     }
 }
 
+//*****************************************************************************
+//
+//! Queues a HID device report for transmission to the USB host, merging it
+//! with a waiting report where possible.
+//!
+//! \param pvInstance is the pointer to the device instance structure as
+//! returned by USBDHIDInit().
+//! \param pcData points to the first byte of the report to transmit.
+//! \param ulLength is the number of bytes in the report.  This must not
+//! exceed USBDHID_REPORT_QUEUE_SIZE.
+//! \param psMap describes the relative fields of the report or is 0 if the
+//! report must never be merged with another.
+//!
+//! This function is an alternative to USBDHIDReportWrite() for devices which
+//! generate reports faster than the host polls for them, such as pens, mice
+//! and rotary encoders.  If the interrupt IN endpoint is idle, the report is
+//! sent immediately.  Otherwise, it is copied into a queue of up to
+//! USBDHID_REPORT_QUEUE_DEPTH reports which are sent, oldest first, as each
+//! earlier transmission completes.
+//!
+//! If the newest queued report has the same length as the new report and
+//! differs only in the relative fields described by \e psMap, the new report
+//! is merged into it by adding the relative fields rather than being queued
+//! separately.  Motion is therefore never lost and never delayed by more than
+//! one polling interval, while the number of reports sent is bounded by the
+//! polling rate.  Reports which change buttons or absolute fields, or whose
+//! sums would overflow, are queued in order.
+//!
+//! The buffer pointed to by \e pcData may be reused as soon as this function
+//! returns.  A \b USB_EVENT_TX_COMPLETE event is sent to the application
+//! transmit callback as each report is acknowledged by the host.
+//!
+//! \return Returns \e ulLength if the report was sent, queued or merged, or 0
+//! if the device is not configured or the queue is full.
+//
+//*****************************************************************************
+unsigned long
+USBDHIDReportQueue(void *pvInstance, unsigned char *pcData,
+                   unsigned long ulLength, const tHIDCoalesceMap *psMap)
+{
+    tHIDInstance *psInst;
+    unsigned long ulWrite, ulIdx;
+    tBoolean bIntsOff, bMerged;
+
+    ASSERT(pvInstance);
+    ASSERT(ulLength && (ulLength <= USBDHID_REPORT_QUEUE_SIZE));
+    ASSERT(USBDHID_REPORT_QUEUE_SIZE <= 32);
+
+    //
+    // Get our instance data pointer
+    //
+    psInst = ((tUSBDHIDDevice *)pvInstance)->psPrivateHIDData;
+
+    //
+    // Reports can't be sent until the host has configured the device.
+    //
+    if(psInst->eHIDTxState == HID_STATE_UNCONFIGURED)
+    {
+        return(0);
+    }
+
+    //
+    // The queue is shared with the USB interrupt handler so keep it out
+    // while the queue is updated.
+    //
+    bIntsOff = IntMasterDisable();
+
+    //
+    // Try to merge this report into the newest waiting report.
+    //
+    bMerged = false;
+    if(psInst->ucQueueCount && psMap)
+    {
+        ulWrite = (psInst->ucQueueRead + psInst->ucQueueCount - 1) %
+                  USBDHID_REPORT_QUEUE_DEPTH;
+
+        if(psInst->pucQueueSize[ulWrite] == ulLength)
+        {
+            bMerged = CoalesceReport(psInst->pucQueue[ulWrite], pcData,
+                                     ulLength, psMap);
+        }
+    }
+
+    //
+    // If the report was not merged, add it to the end of the queue.
+    //
+    if(!bMerged)
+    {
+        if(psInst->ucQueueCount == USBDHID_REPORT_QUEUE_DEPTH)
+        {
+            //
+            // The queue is full so the report can't be accepted.
+            //
+            ulLength = 0;
+        }
+        else
+        {
+            ulWrite = (psInst->ucQueueRead + psInst->ucQueueCount) %
+                      USBDHID_REPORT_QUEUE_DEPTH;
+            for(ulIdx = 0; ulIdx < ulLength; ulIdx++)
+            {
+                psInst->pucQueue[ulWrite][ulIdx] = pcData[ulIdx];
+            }
+            psInst->pucQueueSize[ulWrite] = (unsigned char)ulLength;
+            psInst->ucQueueCount++;
+
+            //
+            // Send the report now if the endpoint is idle.
+            //
+            SendQueuedReport((const tUSBDHIDDevice *)pvInstance);
+        }
+    }
+
+    //
+    // Restore the interrupt state.
+    //
+    if(!bIntsOff)
+    {
+        IntMasterEnable();
+    }
+
+    return(ulLength);
+}
+
 //*****************************************************************************
 //
 //! Reads a packet of data received from the USB host via the interrupt OUT
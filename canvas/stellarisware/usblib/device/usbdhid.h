@@ -51,12 +51,45 @@ extern "C"
 //! ignored by the composite device class.
 //
 // For reference this is
-// sizeof(g_sHIDInterfaceSection) +  sizeof(g_sHIDDescriptorSection) +
-// sizeof(g_sHIDInEndpointSection) + sizeof(g_sHIDOutEndpointSection)
+// sizeof(sInterfaceSection) +  sizeof(sHIDDescriptorSection) +
+// sizeof(sInEndpointSection) + sizeof(sOutEndpointSection)
 //
 //*****************************************************************************
 #define COMPOSITE_DHID_SIZE     (32)
 
+//*****************************************************************************
+//
+// The interrupt endpoint polling interval, in milliseconds, used when the
+// application does not specify one in the tUSBDHIDDevice structure.
+//
+//*****************************************************************************
+#ifndef USBDHID_POLL_INTERVAL_DEFAULT
+#define USBDHID_POLL_INTERVAL_DEFAULT                                         \
+                                16
+#endif
+
+//*****************************************************************************
+//
+// The number of Input reports that may be held by the report queue used by
+// USBDHIDReportQueue() while a previous report is being transmitted.
+//
+//*****************************************************************************
+#ifndef USBDHID_REPORT_QUEUE_DEPTH
+#define USBDHID_REPORT_QUEUE_DEPTH                                            \
+                                4
+#endif
+
+//*****************************************************************************
+//
+// The largest Input report, in bytes, that may be passed to
+// USBDHIDReportQueue().  This must not exceed 32.
+//
+//*****************************************************************************
+#ifndef USBDHID_REPORT_QUEUE_SIZE
+#define USBDHID_REPORT_QUEUE_SIZE                                             \
+                                16
+#endif
+
 //*****************************************************************************
 //
 // Macros used to create the static Report Descriptors.
@@ -592,6 +625,17 @@ typedef enum
 }
 tHIDState;
 
+//*****************************************************************************
+//
+// PRIVATE
+//
+// The number of sections in the HID configuration descriptor.  These are the
+// configuration, interface, HID, interrupt IN endpoint and optional interrupt
+// OUT endpoint descriptors.
+//
+//*****************************************************************************
+#define NUM_HID_SECTIONS        5
+
 //*****************************************************************************
 //
 // PRIVATE
@@ -621,6 +665,22 @@ typedef struct
     unsigned char ucINEndpoint;
     unsigned char ucOUTEndpoint;
     unsigned char ucInterface;
+    unsigned char ucQueueRead;
+    volatile unsigned char ucQueueCount;
+    unsigned char pucQueueSize[USBDHID_REPORT_QUEUE_DEPTH];
+    unsigned char pucQueue[USBDHID_REPORT_QUEUE_DEPTH]
+                          [USBDHID_REPORT_QUEUE_SIZE];
+    tDeviceInfo sDevInfo;
+    tInterfaceDescriptor sInterface;
+    tEndpointDescriptor sInEndpoint;
+    tEndpointDescriptor sOutEndpoint;
+    tConfigSection sInterfaceSection;
+    tConfigSection sHIDDescriptorSection;
+    tConfigSection sInEndpointSection;
+    tConfigSection sOutEndpointSection;
+    const tConfigSection *psConfigSections[NUM_HID_SECTIONS];
+    tConfigHeader sConfigHeader;
+    const tConfigHeader *psConfigHeader;
 }
 tHIDInstance;
 
@@ -678,6 +738,30 @@ typedef struct
 }
 tHIDReportIdle;
 
+//*****************************************************************************
+//
+//! The structure used to describe the relative fields of an Input report
+//! passed to USBDHIDReportQueue().  Reports which differ only in these fields
+//! may be merged by summing the fields while an earlier report is waiting to
+//! be transmitted.  Relative fields are signed, two's complement values.
+//
+//*****************************************************************************
+typedef struct
+{
+    //
+    //! Bit n of this mask is set if byte n of the report is an 8-bit relative
+    //! field, such as a mouse X or Y movement.
+    //
+    unsigned long ulRelative8;
+
+    //
+    //! Bit n of this mask is set if bytes n and n + 1 of the report form a
+    //! little-endian 16-bit relative field, such as a rotary encoder count.
+    //
+    unsigned long ulRelative16;
+}
+tHIDCoalesceMap;
+
 //*****************************************************************************
 //
 //! The structure used by the application to define operating parameters for
@@ -823,6 +907,13 @@ typedef struct
     //! and must not be modified by any code outside the HID class driver.
     //
     tHIDInstance *psPrivateHIDData;
+
+    //
+    //! The polling interval, in milliseconds, to publish for the interrupt
+    //! endpoints.  Smaller values reduce input latency at the cost of bus
+    //! bandwidth.  If 0, USBDHID_POLL_INTERVAL_DEFAULT is used.
+    //
+    unsigned char ucPollIntervalmS;
 }
 tUSBDHIDDevice;
 
@@ -946,6 +1037,10 @@ extern unsigned long USBDHIDReportWrite(void *pvInstance,
                                         unsigned char *pcData,
                                         unsigned long ulLength,
                                         tBoolean bLast);
+extern unsigned long USBDHIDReportQueue(void *pvInstance,
+                                        unsigned char *pcData,
+                                        unsigned long ulLength,
+                                        const tHIDCoalesceMap *psMap);
 extern unsigned long USBDHIDPacketRead(void *pvInstance,
                                        unsigned char *pcData,
                                        unsigned long ulLength,
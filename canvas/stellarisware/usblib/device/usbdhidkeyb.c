@@ -756,6 +756,7 @@ USBDHIDKeyboardCompositeInit(unsigned long ulIndex,
     psHIDDevice->ppStringDescriptors = psDevice->ppStringDescriptors;
     psHIDDevice->ulNumStringDescriptors = psDevice->ulNumStringDescriptors;
     psHIDDevice->psPrivateHIDData = &psInst->sHIDInstance;
+    psHIDDevice->ucPollIntervalmS = 0;
     psHIDDevice->psReportIdle = &psInst->sReportIdle;
 
     //
@@ -540,6 +540,7 @@ USBDHIDMouseCompositeInit(unsigned long ulIndex,
     psHIDDevice->ppStringDescriptors = psDevice->ppStringDescriptors;
     psHIDDevice->ulNumStringDescriptors = psDevice->ulNumStringDescriptors;
     psHIDDevice->psPrivateHIDData = &psInst->sHIDInstance;
+    psHIDDevice->ucPollIntervalmS = 0;
 
     //
     // Initialize the lower layer HID driver and pass it the various structures
@@ -22,6 +22,7 @@
 //
 //*****************************************************************************
 
+#include <string.h>
 #include "inc/hw_types.h"
 #include "driverlib/usb.h"
 #include "usblib/usblib.h"
@@ -86,6 +87,51 @@ typedef struct
     // Bulk OUT pipe.
     //
     unsigned long ulBulkOutPipe;
+
+    //
+    // The block address following the last block returned by a read.  This
+    // is used to detect sequential access.
+    //
+    unsigned long ulNextLBA;
+
+#if USBHMSC_CACHE_BLOCKS > 0
+    //
+    // The block address held in each cache entry.
+    //
+    unsigned long pulCacheLBA[USBHMSC_CACHE_BLOCKS];
+
+    //
+    // The value of ulCacheTick when each cache entry was last used, or zero
+    // if the entry does not hold valid data.
+    //
+    unsigned long pulCacheAge[USBHMSC_CACHE_BLOCKS];
+
+    //
+    // Incremented on every cache hit or insertion to provide the LRU
+    // ordering.
+    //
+    unsigned long ulCacheTick;
+
+    //
+    // The cached block data.
+    //
+    unsigned char pucCache[USBHMSC_CACHE_BLOCKS][USBHMSC_CACHE_BLOCK_SIZE];
+#endif
+
+#if USBHMSC_READ_AHEAD_BLOCKS > 0
+    //
+    // The first block address and the number of valid blocks held in the
+    // read-ahead window.
+    //
+    unsigned long ulReadAheadLBA;
+    unsigned long ulReadAheadCount;
+
+    //
+    // The read-ahead window data.
+    //
+    unsigned char pucReadAhead[USBHMSC_READ_AHEAD_BLOCKS *
+                               USBHMSC_CACHE_BLOCK_SIZE];
+#endif
 }
 tUSBHMSCInstance;
 
@@ -99,6 +145,157 @@ static tUSBHMSCInstance g_USBHMSCDevice =
     0
 };
 
+//*****************************************************************************
+//
+// Discards everything held in the block cache and read-ahead window.
+//
+//*****************************************************************************
+static void
+USBHMSCCacheFlush(tUSBHMSCInstance *pMSCDevice)
+{
+#if USBHMSC_CACHE_BLOCKS > 0
+    unsigned long ulIdx;
+
+    for(ulIdx = 0; ulIdx < USBHMSC_CACHE_BLOCKS; ulIdx++)
+    {
+        pMSCDevice->pulCacheAge[ulIdx] = 0;
+    }
+    pMSCDevice->ulCacheTick = 0;
+#endif
+
+#if USBHMSC_READ_AHEAD_BLOCKS > 0
+    pMSCDevice->ulReadAheadCount = 0;
+#endif
+
+    pMSCDevice->ulNextLBA = 0;
+}
+
+#if USBHMSC_CACHE_BLOCKS > 0
+//*****************************************************************************
+//
+// Makes a cache entry the most recently used one.
+//
+//*****************************************************************************
+static void
+USBHMSCCacheTouch(tUSBHMSCInstance *pMSCDevice, unsigned long ulEntry)
+{
+    unsigned long ulIdx, ulOther, ulRank;
+    unsigned long pulRank[USBHMSC_CACHE_BLOCKS];
+
+    //
+    // Rather than let the tick wrap to the value used to mark an empty
+    // entry, renumber the valid entries 1, 2, 3... in their current order.
+    //
+    if(pMSCDevice->ulCacheTick == 0xffffffff)
+    {
+        pMSCDevice->ulCacheTick = 0;
+        for(ulIdx = 0; ulIdx < USBHMSC_CACHE_BLOCKS; ulIdx++)
+        {
+            ulRank = 0;
+            if(pMSCDevice->pulCacheAge[ulIdx])
+            {
+                for(ulOther = 0; ulOther < USBHMSC_CACHE_BLOCKS; ulOther++)
+                {
+                    if(pMSCDevice->pulCacheAge[ulOther] &&
+                       (pMSCDevice->pulCacheAge[ulOther] <=
+                        pMSCDevice->pulCacheAge[ulIdx]))
+                    {
+                        ulRank++;
+                    }
+                }
+                pMSCDevice->ulCacheTick++;
+            }
+            pulRank[ulIdx] = ulRank;
+        }
+
+        for(ulIdx = 0; ulIdx < USBHMSC_CACHE_BLOCKS; ulIdx++)
+        {
+            pMSCDevice->pulCacheAge[ulIdx] = pulRank[ulIdx];
+        }
+    }
+
+    pMSCDevice->pulCacheAge[ulEntry] = ++pMSCDevice->ulCacheTick;
+}
+#endif
+
+#if (USBHMSC_CACHE_BLOCKS > 0) || (USBHMSC_READ_AHEAD_BLOCKS > 0)
+//*****************************************************************************
+//
+// Returns a pointer to the cached copy of a block, or 0 if the block is not
+// held in either the LRU cache or the read-ahead window.  The LRU order is
+// only updated if bHit is true, meaning that the caller is about to return
+// the cached copy to the application, so that looking ahead for cached
+// blocks or refreshing them on a write does not keep them in the cache.
+//
+//*****************************************************************************
+static unsigned char *
+USBHMSCCacheLookup(tUSBHMSCInstance *pMSCDevice, unsigned long ulLBA,
+                   tBoolean bHit)
+{
+#if USBHMSC_CACHE_BLOCKS > 0
+    unsigned long ulIdx;
+
+    for(ulIdx = 0; ulIdx < USBHMSC_CACHE_BLOCKS; ulIdx++)
+    {
+        if(pMSCDevice->pulCacheAge[ulIdx] &&
+           (pMSCDevice->pulCacheLBA[ulIdx] == ulLBA))
+        {
+            if(bHit)
+            {
+                USBHMSCCacheTouch(pMSCDevice, ulIdx);
+            }
+            return(pMSCDevice->pucCache[ulIdx]);
+        }
+    }
+#endif
+
+#if USBHMSC_READ_AHEAD_BLOCKS > 0
+    if((ulLBA >= pMSCDevice->ulReadAheadLBA) &&
+       ((ulLBA - pMSCDevice->ulReadAheadLBA) < pMSCDevice->ulReadAheadCount))
+    {
+        return(pMSCDevice->pucReadAhead +
+               ((ulLBA - pMSCDevice->ulReadAheadLBA) *
+                pMSCDevice->ulBlockSize));
+    }
+#endif
+
+    return(0);
+}
+#endif
+
+#if USBHMSC_CACHE_BLOCKS > 0
+//*****************************************************************************
+//
+// Places a copy of a block in the LRU cache, replacing the least recently
+// used entry.
+//
+//*****************************************************************************
+static void
+USBHMSCCacheInsert(tUSBHMSCInstance *pMSCDevice, unsigned long ulLBA,
+                   const unsigned char *pucData)
+{
+    unsigned long ulIdx;
+    unsigned long ulVictim;
+
+    //
+    // Pick an empty entry if there is one, otherwise the oldest.
+    //
+    ulVictim = 0;
+    for(ulIdx = 0; ulIdx < USBHMSC_CACHE_BLOCKS; ulIdx++)
+    {
+        if(pMSCDevice->pulCacheAge[ulIdx] < pMSCDevice->pulCacheAge[ulVictim])
+        {
+            ulVictim = ulIdx;
+        }
+    }
+
+    memcpy(pMSCDevice->pucCache[ulVictim], pucData, pMSCDevice->ulBlockSize);
+    pMSCDevice->pulCacheLBA[ulVictim] = ulLBA;
+    pMSCDevice->pulCacheAge[ulVictim] = 0;
+    USBHMSCCacheTouch(pMSCDevice, ulVictim);
+}
+#endif
+
 //*****************************************************************************
 //
 //! This constant global structure defines the Mass Storage Class Driver that
@@ -148,6 +345,11 @@ USBHMSCOpen(tUSBHostDevice *pDevice)
     //
     g_USBHMSCDevice.pDevice = pDevice;
 
+    //
+    // Nothing cached from a previous device is valid for this one.
+    //
+    USBHMSCCacheFlush(&g_USBHMSCDevice);
+
     //
     // Get the interface descriptor.
     //
@@ -270,6 +472,11 @@ USBHMSCClose(void *pvInstance)
     //
     g_USBHMSCDevice.pDevice = 0;
 
+    //
+    // Discard any cached blocks from the removed device.
+    //
+    USBHMSCCacheFlush(&g_USBHMSCDevice);
+
     //
     // Free the Bulk IN pipe.
     //
@@ -478,6 +685,11 @@ USBHMSCDriveReady(unsigned long ulInstance)
         pMSCDevice->ulNumBlocks =
             (pBuffer[3] | (pBuffer[2] << 8) | pBuffer[1] << 16 |
              (pBuffer[0] << 24));
+
+        //
+        // The medium may have changed so drop anything that was cached.
+        //
+        USBHMSCCacheFlush(pMSCDevice);
     }
 
     //
@@ -608,6 +820,10 @@ USBHMSCBlockRead(unsigned long ulInstance, unsigned long ulLBA,
 {
     tUSBHMSCInstance *pMSCDevice;
     unsigned long ulSize;
+#if (USBHMSC_CACHE_BLOCKS > 0) || (USBHMSC_READ_AHEAD_BLOCKS > 0)
+    unsigned char *pucCached;
+    unsigned long ulRun;
+#endif
 
     //
     // Get the instance pointer in a more usable form.
@@ -622,6 +838,101 @@ USBHMSCBlockRead(unsigned long ulInstance, unsigned long ulLBA,
         return(-1);
     }
 
+#if (USBHMSC_CACHE_BLOCKS > 0) || (USBHMSC_READ_AHEAD_BLOCKS > 0)
+    //
+    // Only go through the cache if a block fits in a cache entry.
+    //
+    if(pMSCDevice->ulBlockSize <= USBHMSC_CACHE_BLOCK_SIZE)
+    {
+        while(ulNumBlocks)
+        {
+            //
+            // Satisfy the block from the cache if it is there.
+            //
+            pucCached = USBHMSCCacheLookup(pMSCDevice, ulLBA, true);
+            if(pucCached)
+            {
+                memcpy(pucData, pucCached, pMSCDevice->ulBlockSize);
+                pucData += pMSCDevice->ulBlockSize;
+                ulLBA++;
+                ulNumBlocks--;
+                continue;
+            }
+
+#if USBHMSC_READ_AHEAD_BLOCKS > 0
+            //
+            // A short read which carries on from where the last one left off
+            // is most likely part of a sequential scan, so fetch a whole
+            // read-ahead window with one command and serve it from there.
+            // Larger reads already make good use of a single command.
+            //
+            if((ulNumBlocks < USBHMSC_READ_AHEAD_BLOCKS) &&
+               (ulLBA == pMSCDevice->ulNextLBA) &&
+               (ulLBA <= pMSCDevice->ulNumBlocks))
+            {
+                ulRun = pMSCDevice->ulNumBlocks - ulLBA + 1;
+                if(ulRun > USBHMSC_READ_AHEAD_BLOCKS)
+                {
+                    ulRun = USBHMSC_READ_AHEAD_BLOCKS;
+                }
+
+                pMSCDevice->ulReadAheadCount = 0;
+                ulSize = pMSCDevice->ulBlockSize * ulRun;
+                if(USBHSCSIRead10(pMSCDevice->ulBulkInPipe,
+                                  pMSCDevice->ulBulkOutPipe, ulLBA,
+                                  pMSCDevice->pucReadAhead, &ulSize,
+                                  ulRun) != SCSI_CMD_STATUS_PASS)
+                {
+                    return(-1);
+                }
+                pMSCDevice->ulReadAheadLBA = ulLBA;
+                pMSCDevice->ulReadAheadCount = ulRun;
+                pMSCDevice->ulNextLBA = ulLBA + ulRun;
+                continue;
+            }
+#endif
+
+            //
+            // Gather every following block which is also not cached so that
+            // the whole extent is read with a single command.
+            //
+            for(ulRun = 1; ulRun < ulNumBlocks; ulRun++)
+            {
+                if(USBHMSCCacheLookup(pMSCDevice, ulLBA + ulRun, false))
+                {
+                    break;
+                }
+            }
+
+            ulSize = pMSCDevice->ulBlockSize * ulRun;
+            if(USBHSCSIRead10(pMSCDevice->ulBulkInPipe,
+                              pMSCDevice->ulBulkOutPipe, ulLBA, pucData,
+                              &ulSize, ulRun) != SCSI_CMD_STATUS_PASS)
+            {
+                return(-1);
+            }
+
+#if USBHMSC_CACHE_BLOCKS > 0
+            //
+            // Keep isolated blocks, which are typically FAT and directory
+            // sectors, but do not let bulk data push them out of the cache.
+            //
+            if(ulRun == 1)
+            {
+                USBHMSCCacheInsert(pMSCDevice, ulLBA, pucData);
+            }
+#endif
+
+            pucData += ulSize;
+            ulLBA += ulRun;
+            ulNumBlocks -= ulRun;
+            pMSCDevice->ulNextLBA = ulLBA;
+        }
+
+        return(0);
+    }
+#endif
+
     //
     // Calculate the actual byte size of the read.
     //
@@ -670,6 +981,10 @@ USBHMSCBlockWrite(unsigned long ulInstance, unsigned long ulLBA,
 {
     tUSBHMSCInstance *pMSCDevice;
     unsigned long ulSize;
+#if (USBHMSC_CACHE_BLOCKS > 0) || (USBHMSC_READ_AHEAD_BLOCKS > 0)
+    unsigned char *pucCached;
+    unsigned long ulIdx;
+#endif
 
     //
     // Get the instance pointer in a more usable form.
@@ -696,9 +1011,34 @@ USBHMSCBlockWrite(unsigned long ulInstance, unsigned long ulLBA,
                        ulLBA, pucData, &ulSize,
                        ulNumBlocks) != SCSI_CMD_STATUS_PASS)
     {
+        //
+        // The state of the blocks on the device is unknown so nothing
+        // cached can be trusted any longer.
+        //
+        USBHMSCCacheFlush(pMSCDevice);
+
         return(-1);
     }
 
+#if (USBHMSC_CACHE_BLOCKS > 0) || (USBHMSC_READ_AHEAD_BLOCKS > 0)
+    //
+    // The cache is write-through, so refresh any cached copies of the blocks
+    // which were just written.
+    //
+    if(pMSCDevice->ulBlockSize <= USBHMSC_CACHE_BLOCK_SIZE)
+    {
+        for(ulIdx = 0; ulIdx < ulNumBlocks; ulIdx++)
+        {
+            pucCached = USBHMSCCacheLookup(pMSCDevice, ulLBA + ulIdx, false);
+            if(pucCached)
+            {
+                memcpy(pucCached, pucData + (ulIdx * pMSCDevice->ulBlockSize),
+                       pMSCDevice->ulBlockSize);
+            }
+        }
+    }
+#endif
+
     //
     // Success.
     //
@@ -43,6 +43,32 @@ extern "C"
 //
 //*****************************************************************************
 
+//*****************************************************************************
+//
+// The following labels configure the block cache used by USBHMSCBlockRead()
+// and USBHMSCBlockWrite().  USBHMSC_CACHE_BLOCKS is the number of blocks held
+// in the least recently used cache and USBHMSC_READ_AHEAD_BLOCKS is the size
+// of the window fetched by a single READ(10) when sequential access is
+// detected.  Blocks larger than USBHMSC_CACHE_BLOCK_SIZE bytes are never
+// cached.
+//
+// Both counts default to 0, which removes the cache entirely.  Enabling it
+// costs (USBHMSC_CACHE_BLOCKS + USBHMSC_READ_AHEAD_BLOCKS) *
+// USBHMSC_CACHE_BLOCK_SIZE bytes of RAM, so 6 KB for a cache of 4 blocks
+// and a read-ahead window of 8 blocks.  The values must be defined when the
+// USB library is built, typically on the compiler command line.
+//
+//*****************************************************************************
+#ifndef USBHMSC_CACHE_BLOCKS
+#define USBHMSC_CACHE_BLOCKS    0
+#endif
+#ifndef USBHMSC_READ_AHEAD_BLOCKS
+#define USBHMSC_READ_AHEAD_BLOCKS 0
+#endif
+#ifndef USBHMSC_CACHE_BLOCK_SIZE
+#define USBHMSC_CACHE_BLOCK_SIZE 512
+#endif
+
 //*****************************************************************************
 //
 // These defines are the the events that will be passed in the \e ulEvent
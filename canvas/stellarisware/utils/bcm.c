@@ -0,0 +1,380 @@
+//*****************************************************************************
+//
+// bcm.c - Binary code modulation of bit planes for low-bit LED drivers.
+//
+//*****************************************************************************
+
+#include "inc/hw_types.h"
+#include "driverlib/debug.h"
+#include "utils/bcm.h"
+#include "utils/bitplane.h"
+
+//*****************************************************************************
+//
+//! \addtogroup bcm_api
+//! @{
+//
+//*****************************************************************************
+
+//*****************************************************************************
+//
+// Prevents the compiler from moving the writes of the bit planes past the
+// setting of the pending flag.  The engine is only shared between contexts on
+// a single core so no hardware barrier is needed, only a compiler one.  The
+// other toolchains do not move accesses across the volatile flag update.
+//
+//*****************************************************************************
+#if defined(codered) || defined(gcc) || defined(sourcerygxx)
+#define COMPILER_BARRIER()      __asm volatile("" : : : "memory")
+#else
+#define COMPILER_BARRIER()
+#endif
+
+//*****************************************************************************
+//
+// The number of trailing zero bits in each slot number, which orders the bit
+// planes in BCM_MODE_DITHER.  Slot S from 1 to 2^bits - 1 shows plane
+// bits - 1 - g_pucBCMTrailingZeros[S], so that the most significant plane is
+// shown in every other slot, the next in every fourth, and so on, and the
+// time that each channel is on is spread as evenly as possible over the
+// cycle.
+//
+//*****************************************************************************
+static const unsigned char g_pucBCMTrailingZeros[256] =
+{
+    0, 0, 1, 0, 2, 0, 1, 0, 3, 0, 1, 0, 2, 0, 1, 0,
+    4, 0, 1, 0, 2, 0, 1, 0, 3, 0, 1, 0, 2, 0, 1, 0,
+    5, 0, 1, 0, 2, 0, 1, 0, 3, 0, 1, 0, 2, 0, 1, 0,
+    4, 0, 1, 0, 2, 0, 1, 0, 3, 0, 1, 0, 2, 0, 1, 0,
+    6, 0, 1, 0, 2, 0, 1, 0, 3, 0, 1, 0, 2, 0, 1, 0,
+    4, 0, 1, 0, 2, 0, 1, 0, 3, 0, 1, 0, 2, 0, 1, 0,
+    5, 0, 1, 0, 2, 0, 1, 0, 3, 0, 1, 0, 2, 0, 1, 0,
+    4, 0, 1, 0, 2, 0, 1, 0, 3, 0, 1, 0, 2, 0, 1, 0,
+    7, 0, 1, 0, 2, 0, 1, 0, 3, 0, 1, 0, 2, 0, 1, 0,
+    4, 0, 1, 0, 2, 0, 1, 0, 3, 0, 1, 0, 2, 0, 1, 0,
+    5, 0, 1, 0, 2, 0, 1, 0, 3, 0, 1, 0, 2, 0, 1, 0,
+    4, 0, 1, 0, 2, 0, 1, 0, 3, 0, 1, 0, 2, 0, 1, 0,
+    6, 0, 1, 0, 2, 0, 1, 0, 3, 0, 1, 0, 2, 0, 1, 0,
+    4, 0, 1, 0, 2, 0, 1, 0, 3, 0, 1, 0, 2, 0, 1, 0,
+    5, 0, 1, 0, 2, 0, 1, 0, 3, 0, 1, 0, 2, 0, 1, 0,
+    4, 0, 1, 0, 2, 0, 1, 0, 3, 0, 1, 0, 2, 0, 1, 0
+};
+
+//*****************************************************************************
+//
+//! Initializes a binary code modulation engine.
+//!
+//! \param psInst points to the engine structure to initialize.
+//! \param pulPlanes points to the storage for the bit planes, which must be
+//! at least 2 * \e ulNumSlices * \e ulBits words in size.
+//! \param ulNumSlices is the number of slices in a frame, such as the rows of
+//! a multiplexed matrix or the angles of a persistence of vision display.
+//! \param ulNumChannels is the number of channels in each slice, from 1 to
+//! \b BCM_MAX_CHANNELS, such as the columns of a matrix times the number of
+//! colors in each LED.
+//! \param ulBits is the number of bits of intensity that each channel is
+//! shown with, from 1 to \b BCM_MAX_BITS.
+//! \param ulMode is \b BCM_MODE_WEIGHTED to show every plane of a slice each
+//! time it is shown, or \b BCM_MODE_DITHER to show one plane of every slice
+//! in each refresh of the frame.
+//!
+//! This function prepares an engine that shows frames of 8-bit intensities on
+//! a driver that can only turn each channel on or off, such as a chain of
+//! shift registers.  The frame is split into one word for each bit of
+//! intensity of each slice, which the output interrupt handler sends as it
+//! is without further work, for a time that is weighted by the bit.  The
+//! frame is blank until the first call to BCMFrameSet().
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+BCMInit(tBCMInstance *psInst, unsigned long *pulPlanes,
+        unsigned long ulNumSlices, unsigned long ulNumChannels,
+        unsigned long ulBits, unsigned long ulMode)
+{
+    unsigned long ulIdx;
+
+    //
+    // Check the arguments.
+    //
+    ASSERT(psInst != 0);
+    ASSERT(pulPlanes != 0);
+    ASSERT(ulNumSlices != 0);
+    ASSERT((ulNumChannels != 0) && (ulNumChannels <= BCM_MAX_CHANNELS));
+    ASSERT((ulBits != 0) && (ulBits <= BCM_MAX_BITS));
+    ASSERT((ulMode == BCM_MODE_WEIGHTED) || (ulMode == BCM_MODE_DITHER));
+
+    //
+    // Initialize the engine.
+    //
+    psInst->ulNumSlices = ulNumSlices;
+    psInst->ulNumChannels = ulNumChannels;
+    psInst->ulBits = ulBits;
+    psInst->ulMode = ulMode;
+    psInst->ulBrightness = BCM_BRIGHTNESS_FULL;
+    psInst->pucGamma = 0;
+    psInst->pulPlanes[0] = pulPlanes;
+    psInst->pulPlanes[1] = pulPlanes + (ulNumSlices * ulBits);
+    psInst->ulFront = 0;
+    psInst->bPending = false;
+    psInst->ulSlice = 0;
+    psInst->ulPlane = 0;
+    psInst->ulSlot = 0;
+
+    //
+    // Start with a blank frame.
+    //
+    for(ulIdx = 0; ulIdx < (2 * ulNumSlices * ulBits); ulIdx++)
+    {
+        pulPlanes[ulIdx] = 0;
+    }
+}
+
+//*****************************************************************************
+//
+//! Sets the brightness of a binary code modulation engine.
+//!
+//! \param psInst points to the engine.
+//! \param ulBrightness is the brightness, from 0 for black to
+//! \b BCM_BRIGHTNESS_FULL to show each intensity unchanged.
+//!
+//! This function sets the brightness that every intensity is scaled by, which
+//! applies from the next call to BCMFrameSet().  Since the scaling is done
+//! when the planes are built, the brightness costs nothing while they are
+//! shown.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+BCMBrightnessSet(tBCMInstance *psInst, unsigned long ulBrightness)
+{
+    ASSERT(psInst != 0);
+    ASSERT(ulBrightness <= BCM_BRIGHTNESS_FULL);
+
+    psInst->ulBrightness = ulBrightness;
+}
+
+//*****************************************************************************
+//
+//! Sets the gamma correction of a binary code modulation engine.
+//!
+//! \param psInst points to the engine.
+//! \param pucTable points to the 256 entry table that maps each intensity to
+//! the one that is shown, such as \b g_pucColorGamma8 from utils/color.c, or
+//! is 0 to show each intensity as it is.
+//!
+//! This function sets the table that corrects each intensity before it is
+//! scaled by the brightness, which applies from the next call to
+//! BCMFrameSet().
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+BCMGammaSet(tBCMInstance *psInst, const unsigned char *pucTable)
+{
+    ASSERT(psInst != 0);
+
+    psInst->pucGamma = pucTable;
+}
+
+//*****************************************************************************
+//
+//! Sets the frame shown by a binary code modulation engine.
+//!
+//! \param psInst points to the engine.
+//! \param pucValues points to the intensities of the frame, from 0 to 255,
+//! with the \e ulNumChannels intensities of the first slice followed by
+//! those of each following slice.
+//!
+//! This function corrects and scales each intensity, reduces it to the number
+//! of bits that the engine shows, and splits it into bit planes in the buffer
+//! that is not being shown.  BCMNext() starts to show the new frame at the
+//! start of the next refresh, so that no refresh shows part of two frames.
+//! All of the work is done here, at the rate that frames change, rather than
+//! in the output interrupt handler.
+//!
+//! This function must not be called from the context of BCMNext().
+//!
+//! \return Returns \b false if the previous frame has not yet been shown, in
+//! which case the new frame is not taken and the call should be repeated, or
+//! \b true if the new frame will be shown.
+//
+//*****************************************************************************
+tBoolean
+BCMFrameSet(tBCMInstance *psInst, const unsigned char *pucValues)
+{
+    unsigned long *pulPlanes, ulSlice, ulChannel, ulPlane, ulValue, ulMax;
+    unsigned char pucLevels[BCM_MAX_CHANNELS], pucBits[8];
+
+    ASSERT(psInst != 0);
+    ASSERT(pucValues != 0);
+
+    //
+    // The buffer that is not being shown holds a frame that has not been
+    // taken yet, so it cannot be written.
+    //
+    if(psInst->bPending)
+    {
+        return(false);
+    }
+
+    pulPlanes = psInst->pulPlanes[psInst->ulFront ^ 1];
+    ulMax = (1 << psInst->ulBits) - 1;
+    for(ulSlice = 0; ulSlice < psInst->ulNumSlices; ulSlice++)
+    {
+        for(ulPlane = 0; ulPlane < psInst->ulBits; ulPlane++)
+        {
+            pulPlanes[ulPlane] = 0;
+        }
+
+        for(ulChannel = 0; ulChannel < psInst->ulNumChannels; ulChannel++)
+        {
+            //
+            // Correct and scale the intensity, then reduce it to the number
+            // of bits shown, rounding to the nearest level.
+            //
+            ulValue = *pucValues++;
+            if(psInst->pucGamma)
+            {
+                ulValue = psInst->pucGamma[ulValue];
+            }
+            ulValue = ((ulValue * psInst->ulBrightness) + 128) >> 8;
+            ulValue = (ulValue * ulMax) + 127;
+            pucLevels[ulChannel] = (ulValue + 1 + (ulValue >> 8)) >> 8;
+        }
+
+        //
+        // Pad the last group of eight channels with channels that are off.
+        //
+        for(; (ulChannel & 7) != 0; ulChannel++)
+        {
+            pucLevels[ulChannel] = 0;
+        }
+
+        //
+        // Split each group of eight channels into its planes at once, and add
+        // them to the words of the slice.
+        //
+        for(ulChannel = 0; ulChannel < psInst->ulNumChannels; ulChannel += 8)
+        {
+            BitPlaneTranspose8(pucBits, pucLevels + ulChannel);
+            for(ulPlane = 0; ulPlane < psInst->ulBits; ulPlane++)
+            {
+                pulPlanes[ulPlane] |= ((unsigned long)pucBits[ulPlane] <<
+                                       ulChannel);
+            }
+        }
+        pulPlanes += psInst->ulBits;
+    }
+
+    //
+    // Hand the new frame to the output.
+    //
+    COMPILER_BARRIER();
+    psInst->bPending = true;
+
+    return(true);
+}
+
+//*****************************************************************************
+//
+//! Returns the next word to output from a binary code modulation engine.
+//!
+//! \param psInst points to the engine.
+//! \param pulSlice points to storage for the slice that the word is for.
+//! \param pulTicks points to storage for the number of ticks that the word is
+//! to be shown for, or is 0 if the caller shows each word for the same time.
+//!
+//! This function is called by the output interrupt handler to get the word to
+//! send for each slice, in which bit C turns channel C on.  In
+//! \b BCM_MODE_WEIGHTED each slice is returned once for each plane, plane N
+//! for 2^N ticks, and the handler should set its timer to the number of
+//! ticks for the next interrupt.  In \b BCM_MODE_DITHER each slice is
+//! returned once in each refresh, always for a single tick.  In both modes
+//! the slices are returned in order, and a new frame set by BCMFrameSet() is
+//! taken when the first slice is returned.
+//!
+//! \return Returns the word to output.
+//
+//*****************************************************************************
+unsigned long
+BCMNext(tBCMInstance *psInst, unsigned long *pulSlice,
+        unsigned long *pulTicks)
+{
+    unsigned long ulSlice, ulPlane, ulWord;
+
+    ulSlice = psInst->ulSlice;
+
+    //
+    // At the start of a refresh, take a new frame if there is one.  In
+    // BCM_MODE_DITHER the plane for the whole refresh is chosen from the
+    // next slot of the cycle.
+    //
+    if((ulSlice == 0) && (psInst->ulPlane == 0))
+    {
+        if(psInst->bPending)
+        {
+            psInst->ulFront ^= 1;
+            psInst->bPending = false;
+        }
+        if(psInst->ulMode == BCM_MODE_DITHER)
+        {
+            psInst->ulSlot = ((psInst->ulSlot + 1) &
+                              ((1 << psInst->ulBits) - 1));
+            psInst->ulSlot += (psInst->ulSlot == 0) ? 1 : 0;
+        }
+    }
+
+    if(psInst->ulMode == BCM_MODE_DITHER)
+    {
+        //
+        // Show the plane of this refresh, for a single tick.
+        //
+        ulPlane = (psInst->ulBits - 1 -
+                   g_pucBCMTrailingZeros[psInst->ulSlot]);
+        if(pulTicks)
+        {
+            *pulTicks = 1;
+        }
+        psInst->ulSlice = ((ulSlice + 1) == psInst->ulNumSlices) ?
+                          0 : (ulSlice + 1);
+    }
+    else
+    {
+        //
+        // Show each plane of the slice in turn, for a time weighted by the
+        // bit.
+        //
+        ulPlane = psInst->ulPlane;
+        if(pulTicks)
+        {
+            *pulTicks = 1 << ulPlane;
+        }
+        if((ulPlane + 1) == psInst->ulBits)
+        {
+            psInst->ulPlane = 0;
+            psInst->ulSlice = ((ulSlice + 1) == psInst->ulNumSlices) ?
+                              0 : (ulSlice + 1);
+        }
+        else
+        {
+            psInst->ulPlane = ulPlane + 1;
+        }
+    }
+
+    ulWord = psInst->pulPlanes[psInst->ulFront][(ulSlice * psInst->ulBits) +
+                                                ulPlane];
+    *pulSlice = ulSlice;
+
+    return(ulWord);
+}
+
+//*****************************************************************************
+//
+// Close the Doxygen group.
+//! @}
+//
+//*****************************************************************************
@@ -0,0 +1,151 @@
+//*****************************************************************************
+//
+// bcm.h - Prototypes for the binary code modulation engine.
+//
+//*****************************************************************************
+
+#ifndef __BCM_H__
+#define __BCM_H__
+
+//*****************************************************************************
+//
+// If building with a C++ compiler, make all of the definitions in this header
+// have a C binding.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+//*****************************************************************************
+//
+//! \addtogroup bcm_api
+//! @{
+//
+//*****************************************************************************
+
+//*****************************************************************************
+//
+//! The largest number of bits of intensity that a channel may be shown with.
+//
+//*****************************************************************************
+#define BCM_MAX_BITS            8
+
+//*****************************************************************************
+//
+//! The largest number of channels in a slice, which is the number of bits in
+//! the word that is output for each slice.
+//
+//*****************************************************************************
+#define BCM_MAX_CHANNELS        32
+
+//*****************************************************************************
+//
+//! The ways that the bit planes of a frame may be spread over time.  In
+//! BCM_MODE_WEIGHTED every plane of a slice is shown each time the slice is
+//! shown, plane N for 2^N ticks, so that the output is reprogrammed once per
+//! plane rather than once per tick.  In BCM_MODE_DITHER a single plane of
+//! each slice is shown each time the frame is refreshed, such as on each
+//! revolution of a persistence of vision display, and the planes are spread
+//! over 2^bits - 1 refreshes so that each is shown 2^N times.
+//
+//*****************************************************************************
+#define BCM_MODE_WEIGHTED       0
+#define BCM_MODE_DITHER         1
+
+//*****************************************************************************
+//
+//! The brightness that shows each intensity unchanged.
+//
+//*****************************************************************************
+#define BCM_BRIGHTNESS_FULL     256
+
+//*****************************************************************************
+//
+//! The structure used for encapsulating all the items associated with a
+//! binary code modulation engine.  The application sets whole frames with
+//! BCMFrameSet(), which splits them into bit planes, and the output interrupt
+//! handler takes one word at a time with BCMNext().  The planes are double
+//! buffered so that a new frame is only shown from the start of a refresh.
+//
+//*****************************************************************************
+typedef struct
+{
+    //
+    //! The number of slices in a frame, the number of channels in each
+    //! slice, the number of bits each channel is shown with, and the mode.
+    //
+    unsigned long ulNumSlices;
+    unsigned long ulNumChannels;
+    unsigned long ulBits;
+    unsigned long ulMode;
+
+    //
+    //! The brightness that every intensity is scaled by, from 0 to
+    //! BCM_BRIGHTNESS_FULL, and the table that corrects each intensity first,
+    //! or 0 for none.
+    //
+    unsigned long ulBrightness;
+    const unsigned char *pucGamma;
+
+    //
+    //! The two buffers of bit planes, each holding ulBits words for each
+    //! slice, with bit C of word N set if plane N of channel C is on.
+    //
+    unsigned long *pulPlanes[2];
+
+    //
+    //! The index of the buffer being shown.  Only written by BCMNext().
+    //
+    volatile unsigned long ulFront;
+
+    //
+    //! Set by BCMFrameSet() when the other buffer holds a new frame, and
+    //! cleared by BCMNext() when it starts to show it.
+    //
+    volatile tBoolean bPending;
+
+    //
+    //! The slice and plane that BCMNext() will output next, and the slot
+    //! within the cycle of refreshes in BCM_MODE_DITHER.
+    //
+    unsigned long ulSlice;
+    unsigned long ulPlane;
+    unsigned long ulSlot;
+}
+tBCMInstance;
+
+//*****************************************************************************
+//
+// Close the Doxygen group.
+//! @}
+//
+//*****************************************************************************
+
+//*****************************************************************************
+//
+// Prototypes for the APIs.
+//
+//*****************************************************************************
+extern void BCMInit(tBCMInstance *psInst, unsigned long *pulPlanes,
+                    unsigned long ulNumSlices, unsigned long ulNumChannels,
+                    unsigned long ulBits, unsigned long ulMode);
+extern void BCMBrightnessSet(tBCMInstance *psInst,
+                             unsigned long ulBrightness);
+extern void BCMGammaSet(tBCMInstance *psInst, const unsigned char *pucTable);
+extern tBoolean BCMFrameSet(tBCMInstance *psInst,
+                            const unsigned char *pucValues);
+extern unsigned long BCMNext(tBCMInstance *psInst, unsigned long *pulSlice,
+                             unsigned long *pulTicks);
+
+//*****************************************************************************
+//
+// Mark the end of the C bindings section for C++ compilers.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __BCM_H__
@@ -0,0 +1,482 @@
+//*****************************************************************************
+//
+// binlog.c - Deferred binary logger, which records the address of a format
+//            string and its arguments instead of formatting them on target.
+//
+//*****************************************************************************
+
+#include "inc/hw_nvic.h"
+#include "inc/hw_types.h"
+#include "driverlib/cpu.h"
+#include "driverlib/debug.h"
+#include "driverlib/uart.h"
+#include "utils/binlog.h"
+
+//*****************************************************************************
+//
+//! \addtogroup binlog_api
+//! @{
+//
+//*****************************************************************************
+
+//*****************************************************************************
+//
+// The Cortex-M data watchpoint and trace unit registers used to timestamp
+// records, and the trace enable bit of the debug exception and monitor
+// control register (NVIC_DBG_INT), none of which are provided by
+// inc/hw_nvic.h.
+//
+//*****************************************************************************
+#define DWT_CTRL                0xE0001000  // DWT Control
+#define DWT_CYCCNT              0xE0001004  // DWT Cycle Count
+#define DWT_CTRL_CYCCNTENA      0x00000001  // Enable the cycle counter
+#define NVIC_DBG_INT_TRCENA     0x01000000  // Enable the DWT and ITM
+
+//*****************************************************************************
+//
+// The first word of each record holds the number of arguments that follow
+// the timestamp in its top four bits, and the address of the format string
+// in the rest.  Format strings are constants, so are always in the code
+// region below 0x10000000.  Since no string is at address 0, the first word
+// is never zero once the record has been written.
+//
+//*****************************************************************************
+#define BINLOG_ARGS_S           28
+#define BINLOG_FORMAT_M         0x0FFFFFFF
+
+//*****************************************************************************
+//
+// The header at the start of each block written by BinLogDrain().  All of
+// the values are little endian, and the records follow it.
+//
+//*****************************************************************************
+typedef struct
+{
+    unsigned long ulMagic;
+    unsigned short usVersion;
+    unsigned short usReserved;
+    unsigned long ulMarker;
+    unsigned long ulClockRate;
+    unsigned long ulLost;
+    unsigned long ulWords;
+}
+tBinLogHeader;
+
+//*****************************************************************************
+//
+// A string whose address is sent in every block.  The decoder checks that it
+// finds this string at that address in the executable it was given, so that
+// a log is not decoded with the strings of a different build.
+//
+//*****************************************************************************
+static const char g_pcBinLogMarker[] = "BinLog";
+
+//*****************************************************************************
+//
+// The state of the logger.  The buffer holds a power of two number of words
+// so that an index wraps with a mask.  The indices count words written and
+// read since the logger was initialized, so the difference between them is
+// the number of words in use.
+//
+//*****************************************************************************
+static volatile unsigned long *g_pulBinLogBuffer;
+static unsigned long g_ulBinLogMask;
+static unsigned long g_ulBinLogWrite;
+static unsigned long g_ulBinLogRead;
+static unsigned long g_ulBinLogLost;
+static unsigned long g_ulBinLogClock;
+
+//*****************************************************************************
+//
+//! Initializes the logger.
+//!
+//! \param pvBuffer is a pointer to the memory used to hold log records.
+//! \param ulSize is the size of the buffer in bytes.
+//! \param ulClockRate is the processor clock rate, in Hz.
+//!
+//! This function prepares the logger to use the given buffer, of which the
+//! largest power of two number of words is used.  Each record takes two words,
+//! for the format string and a timestamp, plus a word for each argument.  The
+//! timestamp is the DWT cycle counter, which this function enables.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+BinLogInit(void *pvBuffer, unsigned long ulSize, unsigned long ulClockRate)
+{
+    unsigned long ulWords, ulIdx;
+
+    ASSERT(pvBuffer && !((unsigned long)pvBuffer & 3));
+    ASSERT(ulSize >= (4 * (BINLOG_MAX_ARGS + 2)));
+
+    //
+    // Find the largest power of two number of words that fits.
+    //
+    ulWords = ulSize / 4;
+    while(ulWords & (ulWords - 1))
+    {
+        ulWords &= ulWords - 1;
+    }
+
+    //
+    // A word of zero at the start of a record marks it as not yet written,
+    // so the whole buffer starts out zero.
+    //
+    g_pulBinLogBuffer = pvBuffer;
+    for(ulIdx = 0; ulIdx < ulWords; ulIdx++)
+    {
+        g_pulBinLogBuffer[ulIdx] = 0;
+    }
+
+    g_ulBinLogMask = ulWords - 1;
+    g_ulBinLogWrite = 0;
+    g_ulBinLogRead = 0;
+    g_ulBinLogLost = 0;
+    g_ulBinLogClock = ulClockRate;
+
+    HWREG(NVIC_DBG_INT) |= NVIC_DBG_INT_TRCENA;
+    HWREG(DWT_CTRL) |= DWT_CTRL_CYCCNTENA;
+}
+
+//*****************************************************************************
+//
+// Reserves space for a record and writes its timestamp.  Interrupts are only
+// masked while the space is reserved, so a record is written while
+// interrupts that preempt it write records of their own.
+//
+// Returns the index of the first word of the record, or 0xFFFFFFFF if the
+// buffer is full, in which case the record is counted as lost.
+//
+//*****************************************************************************
+static unsigned long
+BinLogReserve(unsigned long ulWords)
+{
+    unsigned long ulPrimask, ulWrite, ulStamp;
+
+    ulPrimask = CPUcpsid();
+
+    ulWrite = g_ulBinLogWrite;
+    ulStamp = HWREG(DWT_CYCCNT);
+    if((ulWrite - g_ulBinLogRead + ulWords) > (g_ulBinLogMask + 1))
+    {
+        g_ulBinLogLost++;
+        ulWrite = 0xFFFFFFFF;
+    }
+    else
+    {
+        g_ulBinLogWrite = ulWrite + ulWords;
+    }
+
+    if(!ulPrimask)
+    {
+        CPUcpsie();
+    }
+
+    if(ulWrite != 0xFFFFFFFF)
+    {
+        g_pulBinLogBuffer[(ulWrite + 1) & g_ulBinLogMask] = ulStamp;
+    }
+
+    return(ulWrite);
+}
+
+//*****************************************************************************
+//
+// Completes a record by writing its first word, which makes it visible to
+// BinLogDrain().
+//
+//*****************************************************************************
+#define BinLogCommit(ulWrite, pcFormat, ulArgs)                               \
+        g_pulBinLogBuffer[(ulWrite) & g_ulBinLogMask] =                       \
+            (((ulArgs) << BINLOG_ARGS_S) |                                    \
+             ((unsigned long)(pcFormat) & BINLOG_FORMAT_M))
+
+//*****************************************************************************
+//
+//! Logs a message with no arguments.
+//!
+//! \param pcFormat is the format string, which must be a string constant.
+//!
+//! This function and BinLog1() to BinLog4() record the address of the format
+//! string, the time and the arguments in the log buffer, taking a few tens of
+//! cycles.  The message is formatted on the host by tools/logdecode, which
+//! reads the format string from the executable.  The formats of UARTprintf()
+//! are understood, and each argument is a 32-bit value; \%s can be used for a
+//! pointer to a string constant, but not to a string in RAM.
+//!
+//! These functions may be called from any task or interrupt handler.  If the
+//! buffer is full, the message is dropped and counted.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+BinLog0(const char *pcFormat)
+{
+    unsigned long ulWrite;
+
+    ASSERT(((unsigned long)pcFormat & ~BINLOG_FORMAT_M) == 0);
+
+    ulWrite = BinLogReserve(2);
+    if(ulWrite != 0xFFFFFFFF)
+    {
+        BinLogCommit(ulWrite, pcFormat, 0);
+    }
+}
+
+//*****************************************************************************
+//
+//! Logs a message with one argument.
+//!
+//! \param pcFormat is the format string, which must be a string constant.
+//! \param ulArg1 is the argument.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+BinLog1(const char *pcFormat, unsigned long ulArg1)
+{
+    unsigned long ulWrite;
+
+    ASSERT(((unsigned long)pcFormat & ~BINLOG_FORMAT_M) == 0);
+
+    ulWrite = BinLogReserve(3);
+    if(ulWrite != 0xFFFFFFFF)
+    {
+        g_pulBinLogBuffer[(ulWrite + 2) & g_ulBinLogMask] = ulArg1;
+        BinLogCommit(ulWrite, pcFormat, 1);
+    }
+}
+
+//*****************************************************************************
+//
+//! Logs a message with two arguments.
+//!
+//! \param pcFormat is the format string, which must be a string constant.
+//! \param ulArg1 is the first argument.
+//! \param ulArg2 is the second argument.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+BinLog2(const char *pcFormat, unsigned long ulArg1, unsigned long ulArg2)
+{
+    unsigned long ulWrite;
+
+    ASSERT(((unsigned long)pcFormat & ~BINLOG_FORMAT_M) == 0);
+
+    ulWrite = BinLogReserve(4);
+    if(ulWrite != 0xFFFFFFFF)
+    {
+        g_pulBinLogBuffer[(ulWrite + 2) & g_ulBinLogMask] = ulArg1;
+        g_pulBinLogBuffer[(ulWrite + 3) & g_ulBinLogMask] = ulArg2;
+        BinLogCommit(ulWrite, pcFormat, 2);
+    }
+}
+
+//*****************************************************************************
+//
+//! Logs a message with three arguments.
+//!
+//! \param pcFormat is the format string, which must be a string constant.
+//! \param ulArg1 is the first argument.
+//! \param ulArg2 is the second argument.
+//! \param ulArg3 is the third argument.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+BinLog3(const char *pcFormat, unsigned long ulArg1, unsigned long ulArg2,
+        unsigned long ulArg3)
+{
+    unsigned long ulWrite;
+
+    ASSERT(((unsigned long)pcFormat & ~BINLOG_FORMAT_M) == 0);
+
+    ulWrite = BinLogReserve(5);
+    if(ulWrite != 0xFFFFFFFF)
+    {
+        g_pulBinLogBuffer[(ulWrite + 2) & g_ulBinLogMask] = ulArg1;
+        g_pulBinLogBuffer[(ulWrite + 3) & g_ulBinLogMask] = ulArg2;
+        g_pulBinLogBuffer[(ulWrite + 4) & g_ulBinLogMask] = ulArg3;
+        BinLogCommit(ulWrite, pcFormat, 3);
+    }
+}
+
+//*****************************************************************************
+//
+//! Logs a message with four arguments.
+//!
+//! \param pcFormat is the format string, which must be a string constant.
+//! \param ulArg1 is the first argument.
+//! \param ulArg2 is the second argument.
+//! \param ulArg3 is the third argument.
+//! \param ulArg4 is the fourth argument.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+BinLog4(const char *pcFormat, unsigned long ulArg1, unsigned long ulArg2,
+        unsigned long ulArg3, unsigned long ulArg4)
+{
+    unsigned long ulWrite;
+
+    ASSERT(((unsigned long)pcFormat & ~BINLOG_FORMAT_M) == 0);
+
+    ulWrite = BinLogReserve(6);
+    if(ulWrite != 0xFFFFFFFF)
+    {
+        g_pulBinLogBuffer[(ulWrite + 2) & g_ulBinLogMask] = ulArg1;
+        g_pulBinLogBuffer[(ulWrite + 3) & g_ulBinLogMask] = ulArg2;
+        g_pulBinLogBuffer[(ulWrite + 4) & g_ulBinLogMask] = ulArg3;
+        g_pulBinLogBuffer[(ulWrite + 5) & g_ulBinLogMask] = ulArg4;
+        BinLogCommit(ulWrite, pcFormat, 4);
+    }
+}
+
+//*****************************************************************************
+//
+//! Writes the logged messages out as a block.
+//!
+//! \param pfnWrite is the function to call to write each part of the block.
+//! \param pvInstance is a value passed to \e pfnWrite.
+//!
+//! This function writes a header followed by every complete record in the
+//! buffer, oldest first, and then frees their space.  A record that is still
+//! being written by an interrupted task is left for the next call.  Nothing
+//! is written if there are no records and none have been lost.
+//!
+//! The block is decoded on the host by tools/logdecode, which searches its
+//! input for the start of each block, so the log can share a channel with
+//! other output.  This function should be called from one place only, such
+//! as the idle loop or a low priority task.
+//!
+//! \return Returns the number of words of records written.
+//
+//*****************************************************************************
+unsigned long
+BinLogDrain(tBinLogWrite pfnWrite, void *pvInstance)
+{
+    unsigned long ulPrimask, ulRead, ulWords, ulWord, ulLen, ulFirst;
+    tBinLogHeader sHeader;
+
+    ASSERT(pfnWrite);
+
+    //
+    // Find the run of complete records from the read index.
+    //
+    ulRead = g_ulBinLogRead;
+    ulWords = 0;
+    while((ulRead + ulWords) != g_ulBinLogWrite)
+    {
+        ulWord = g_pulBinLogBuffer[(ulRead + ulWords) & g_ulBinLogMask];
+        if(!ulWord)
+        {
+            break;
+        }
+        ulWords += (ulWord >> BINLOG_ARGS_S) + 2;
+    }
+
+    //
+    // Take the count of lost records.
+    //
+    ulPrimask = CPUcpsid();
+    sHeader.ulLost = g_ulBinLogLost;
+    g_ulBinLogLost = 0;
+    if(!ulPrimask)
+    {
+        CPUcpsie();
+    }
+
+    if(!ulWords && !sHeader.ulLost)
+    {
+        return(0);
+    }
+
+    sHeader.ulMagic = BINLOG_MAGIC;
+    sHeader.usVersion = BINLOG_VERSION;
+    sHeader.usReserved = 0;
+    sHeader.ulMarker = (unsigned long)g_pcBinLogMarker;
+    sHeader.ulClockRate = g_ulBinLogClock;
+    sHeader.ulWords = ulWords;
+    pfnWrite(pvInstance, (const unsigned char *)&sHeader, sizeof(sHeader));
+
+    //
+    // Write the records, in two parts if they wrap around the end of the
+    // buffer, and then clear their words so that the space reads as not yet
+    // written when it is used again.
+    //
+    ulFirst = ulRead & g_ulBinLogMask;
+    ulLen = g_ulBinLogMask + 1 - ulFirst;
+    if(ulLen > ulWords)
+    {
+        ulLen = ulWords;
+    }
+    pfnWrite(pvInstance,
+             (const unsigned char *)&g_pulBinLogBuffer[ulFirst], ulLen * 4);
+    if(ulLen < ulWords)
+    {
+        pfnWrite(pvInstance, (const unsigned char *)&g_pulBinLogBuffer[0],
+                 (ulWords - ulLen) * 4);
+    }
+
+    for(ulWord = 0; ulWord < ulWords; ulWord++)
+    {
+        g_pulBinLogBuffer[(ulRead + ulWord) & g_ulBinLogMask] = 0;
+    }
+
+    //
+    // Free the space.  This is the only place the read index is changed, and
+    // a single store, so interrupts need not be masked.
+    //
+    g_ulBinLogRead = ulRead + ulWords;
+
+    return(ulWords);
+}
+
+//*****************************************************************************
+//
+// Writes part of a block to a UART, waiting for space in its FIFO.
+//
+//*****************************************************************************
+static void
+BinLogUARTWrite(void *pvInstance, const unsigned char *pucData,
+                unsigned long ulSize)
+{
+    while(ulSize--)
+    {
+        UARTCharPut((unsigned long)pvInstance, *pucData++);
+    }
+}
+
+//*****************************************************************************
+//
+//! Writes the logged messages to a UART.
+//!
+//! \param ulBase is the base address of the UART, which must already be
+//! configured.
+//!
+//! This function calls BinLogDrain() to write the log to a UART, waiting for
+//! each byte to be accepted.  The log can be captured on the host with, for
+//! example, "cat /dev/ttyACM0 > log.bin" and decoded by tools/logdecode.
+//!
+//! \return Returns the number of words of records written.
+//
+//*****************************************************************************
+unsigned long
+BinLogDrainUART(unsigned long ulBase)
+{
+    return(BinLogDrain(BinLogUARTWrite, (void *)ulBase));
+}
+
+//*****************************************************************************
+//
+// Close the Doxygen group.
+//! @}
+//
+//*****************************************************************************
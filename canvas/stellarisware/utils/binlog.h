@@ -0,0 +1,93 @@
+//*****************************************************************************
+//
+// binlog.h - Prototypes for the deferred binary logger.
+//
+//*****************************************************************************
+
+#ifndef __BINLOG_H__
+#define __BINLOG_H__
+
+//*****************************************************************************
+//
+// If building with a C++ compiler, make all of the definitions in this header
+// have a C binding.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+//*****************************************************************************
+//
+//! \addtogroup binlog_api
+//! @{
+//
+//*****************************************************************************
+
+//*****************************************************************************
+//
+//! The most arguments that a log site can pass with its format string.
+//
+//*****************************************************************************
+#define BINLOG_MAX_ARGS         4
+
+//*****************************************************************************
+//
+//! The value found in the first four bytes of each block written by
+//! BinLogDrain().
+//
+//*****************************************************************************
+#define BINLOG_MAGIC            0x474f4c42  // "BLOG"
+
+//*****************************************************************************
+//
+//! The version of the block format written by BinLogDrain().
+//
+//*****************************************************************************
+#define BINLOG_VERSION          1
+
+//*****************************************************************************
+//
+//! The function used by BinLogDrain() to send each part of a block.
+//
+//*****************************************************************************
+typedef void (*tBinLogWrite)(void *pvInstance, const unsigned char *pucData,
+                             unsigned long ulSize);
+
+//*****************************************************************************
+//
+// Close the Doxygen group.
+//! @}
+//
+//*****************************************************************************
+
+//*****************************************************************************
+//
+// Prototypes for the logger.
+//
+//*****************************************************************************
+extern void BinLogInit(void *pvBuffer, unsigned long ulSize,
+                       unsigned long ulClockRate);
+extern void BinLog0(const char *pcFormat);
+extern void BinLog1(const char *pcFormat, unsigned long ulArg1);
+extern void BinLog2(const char *pcFormat, unsigned long ulArg1,
+                    unsigned long ulArg2);
+extern void BinLog3(const char *pcFormat, unsigned long ulArg1,
+                    unsigned long ulArg2, unsigned long ulArg3);
+extern void BinLog4(const char *pcFormat, unsigned long ulArg1,
+                    unsigned long ulArg2, unsigned long ulArg3,
+                    unsigned long ulArg4);
+extern unsigned long BinLogDrain(tBinLogWrite pfnWrite, void *pvInstance);
+extern unsigned long BinLogDrainUART(unsigned long ulBase);
+
+//*****************************************************************************
+//
+// Mark the end of the C bindings section for C++ compilers.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __BINLOG_H__
@@ -0,0 +1,385 @@
+//*****************************************************************************
+//
+// bitplane.c - Bit reversal and bit-plane transpose kernels for shift
+//              register chains.
+//
+//*****************************************************************************
+
+#include "inc/hw_types.h"
+#include "driverlib/debug.h"
+#include "utils/bitplane.h"
+
+//*****************************************************************************
+//
+//! \addtogroup bitplane_api
+//! @{
+//
+//*****************************************************************************
+
+//*****************************************************************************
+//
+// Reverses the bits of a word with the RBIT instruction where the compiler
+// provides a way to use it.  Otherwise BitPlaneReverse32() looks up each
+// byte in the table.
+//
+//*****************************************************************************
+#if (defined(codered) || defined(gcc) || defined(sourcerygxx)) &&           \
+    (defined(__ARM_ARCH_7M__) || defined(__ARM_ARCH_7EM__))
+#define BITPLANE_RBIT
+static unsigned long
+BitPlaneRBIT(unsigned long ulValue)
+{
+    unsigned long ulResult;
+
+    __asm("rbit %0, %1" : "=r" (ulResult) : "r" (ulValue));
+
+    return(ulResult);
+}
+#elif defined(ewarm)
+#include <intrinsics.h>
+#define BITPLANE_RBIT
+#define BitPlaneRBIT(ulValue)   __RBIT(ulValue)
+#elif defined(rvmdk) || defined(__ARMCC_VERSION)
+#define BITPLANE_RBIT
+#define BitPlaneRBIT(ulValue)   __rbit(ulValue)
+#endif
+
+//*****************************************************************************
+//
+//! The table of each byte with the order of its bits reversed, which is used
+//! by BITPLANE_REVERSE8().
+//
+//*****************************************************************************
+const unsigned char g_pucBitPlaneReverse[256] =
+{
+    0x00, 0x80, 0x40, 0xc0, 0x20, 0xa0, 0x60, 0xe0,
+    0x10, 0x90, 0x50, 0xd0, 0x30, 0xb0, 0x70, 0xf0,
+    0x08, 0x88, 0x48, 0xc8, 0x28, 0xa8, 0x68, 0xe8,
+    0x18, 0x98, 0x58, 0xd8, 0x38, 0xb8, 0x78, 0xf8,
+    0x04, 0x84, 0x44, 0xc4, 0x24, 0xa4, 0x64, 0xe4,
+    0x14, 0x94, 0x54, 0xd4, 0x34, 0xb4, 0x74, 0xf4,
+    0x0c, 0x8c, 0x4c, 0xcc, 0x2c, 0xac, 0x6c, 0xec,
+    0x1c, 0x9c, 0x5c, 0xdc, 0x3c, 0xbc, 0x7c, 0xfc,
+    0x02, 0x82, 0x42, 0xc2, 0x22, 0xa2, 0x62, 0xe2,
+    0x12, 0x92, 0x52, 0xd2, 0x32, 0xb2, 0x72, 0xf2,
+    0x0a, 0x8a, 0x4a, 0xca, 0x2a, 0xaa, 0x6a, 0xea,
+    0x1a, 0x9a, 0x5a, 0xda, 0x3a, 0xba, 0x7a, 0xfa,
+    0x06, 0x86, 0x46, 0xc6, 0x26, 0xa6, 0x66, 0xe6,
+    0x16, 0x96, 0x56, 0xd6, 0x36, 0xb6, 0x76, 0xf6,
+    0x0e, 0x8e, 0x4e, 0xce, 0x2e, 0xae, 0x6e, 0xee,
+    0x1e, 0x9e, 0x5e, 0xde, 0x3e, 0xbe, 0x7e, 0xfe,
+    0x01, 0x81, 0x41, 0xc1, 0x21, 0xa1, 0x61, 0xe1,
+    0x11, 0x91, 0x51, 0xd1, 0x31, 0xb1, 0x71, 0xf1,
+    0x09, 0x89, 0x49, 0xc9, 0x29, 0xa9, 0x69, 0xe9,
+    0x19, 0x99, 0x59, 0xd9, 0x39, 0xb9, 0x79, 0xf9,
+    0x05, 0x85, 0x45, 0xc5, 0x25, 0xa5, 0x65, 0xe5,
+    0x15, 0x95, 0x55, 0xd5, 0x35, 0xb5, 0x75, 0xf5,
+    0x0d, 0x8d, 0x4d, 0xcd, 0x2d, 0xad, 0x6d, 0xed,
+    0x1d, 0x9d, 0x5d, 0xdd, 0x3d, 0xbd, 0x7d, 0xfd,
+    0x03, 0x83, 0x43, 0xc3, 0x23, 0xa3, 0x63, 0xe3,
+    0x13, 0x93, 0x53, 0xd3, 0x33, 0xb3, 0x73, 0xf3,
+    0x0b, 0x8b, 0x4b, 0xcb, 0x2b, 0xab, 0x6b, 0xeb,
+    0x1b, 0x9b, 0x5b, 0xdb, 0x3b, 0xbb, 0x7b, 0xfb,
+    0x07, 0x87, 0x47, 0xc7, 0x27, 0xa7, 0x67, 0xe7,
+    0x17, 0x97, 0x57, 0xd7, 0x37, 0xb7, 0x77, 0xf7,
+    0x0f, 0x8f, 0x4f, 0xcf, 0x2f, 0xaf, 0x6f, 0xef,
+    0x1f, 0x9f, 0x5f, 0xdf, 0x3f, 0xbf, 0x7f, 0xff
+};
+
+//*****************************************************************************
+//
+//! Reverses the order of the bits of a word.
+//!
+//! \param ulValue is the word to reverse.
+//!
+//! This function will move bit N of the word to bit 31 - N, with a single
+//! instruction on a Cortex-M3 or Cortex-M4, or with four table lookups
+//! elsewhere.
+//!
+//! \return Returns the reversed word.
+//
+//*****************************************************************************
+unsigned long
+BitPlaneReverse32(unsigned long ulValue)
+{
+#ifdef BITPLANE_RBIT
+    return(BitPlaneRBIT(ulValue));
+#else
+    return(((unsigned long)g_pucBitPlaneReverse[ulValue & 0xff] << 24) |
+           ((unsigned long)g_pucBitPlaneReverse[(ulValue >> 8) & 0xff] <<
+            16) |
+           ((unsigned long)g_pucBitPlaneReverse[(ulValue >> 16) & 0xff] <<
+            8) |
+           (unsigned long)g_pucBitPlaneReverse[(ulValue >> 24) & 0xff]);
+#endif
+}
+
+//*****************************************************************************
+//
+//! Transposes an 8 by 8 matrix of bits.
+//!
+//! \param pucOut is the array of eight bytes to store the transpose in.
+//! \param pucIn is the array of eight bytes to transpose.
+//!
+//! This function will set bit N of byte M of the output to bit M of byte N of
+//! the input, so that eight 8-bit intensities are split into their eight bit
+//! planes, or eight planes are joined into intensities.  The matrix is held
+//! in two words and transposed by swapping blocks of 1, 2 and 4 bits with
+//! masks, rather than one bit at a time.  The two arrays must not be the
+//! same.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+BitPlaneTranspose8(unsigned char *pucOut, const unsigned char *pucIn)
+{
+    unsigned long ulLow, ulHigh, ulTemp;
+
+    //
+    // Hold bytes 0 to 3 in the low word and bytes 4 to 7 in the high word,
+    // each with the first byte in the least significant bits.
+    //
+    ulLow = (((unsigned long)pucIn[0]) | ((unsigned long)pucIn[1] << 8) |
+             ((unsigned long)pucIn[2] << 16) |
+             ((unsigned long)pucIn[3] << 24));
+    ulHigh = (((unsigned long)pucIn[4]) | ((unsigned long)pucIn[5] << 8) |
+              ((unsigned long)pucIn[6] << 16) |
+              ((unsigned long)pucIn[7] << 24));
+
+    //
+    // Transpose each 2 by 2 block of bits, then each 2 by 2 block of those,
+    // within each word.
+    //
+    ulTemp = (ulLow ^ (ulLow >> 7)) & 0x00aa00aa;
+    ulLow ^= ulTemp ^ (ulTemp << 7);
+    ulTemp = (ulHigh ^ (ulHigh >> 7)) & 0x00aa00aa;
+    ulHigh ^= ulTemp ^ (ulTemp << 7);
+    ulTemp = (ulLow ^ (ulLow >> 14)) & 0x0000cccc;
+    ulLow ^= ulTemp ^ (ulTemp << 14);
+    ulTemp = (ulHigh ^ (ulHigh >> 14)) & 0x0000cccc;
+    ulHigh ^= ulTemp ^ (ulTemp << 14);
+
+    //
+    // Swap the 4 by 4 blocks between the words.
+    //
+    ulTemp = (ulLow & 0x0f0f0f0f) | ((ulHigh << 4) & 0xf0f0f0f0);
+    ulHigh = ((ulLow >> 4) & 0x0f0f0f0f) | (ulHigh & 0xf0f0f0f0);
+    ulLow = ulTemp;
+
+    pucOut[0] = (unsigned char)ulLow;
+    pucOut[1] = (unsigned char)(ulLow >> 8);
+    pucOut[2] = (unsigned char)(ulLow >> 16);
+    pucOut[3] = (unsigned char)(ulLow >> 24);
+    pucOut[4] = (unsigned char)ulHigh;
+    pucOut[5] = (unsigned char)(ulHigh >> 8);
+    pucOut[6] = (unsigned char)(ulHigh >> 16);
+    pucOut[7] = (unsigned char)(ulHigh >> 24);
+}
+
+//*****************************************************************************
+//
+//! Transposes a 32 by 32 matrix of bits.
+//!
+//! \param pulOut is the array of 32 words to store the transpose in.
+//! \param pulIn is the array of 32 words to transpose.
+//!
+//! This function will set bit N of word M of the output to bit M of word N of
+//! the input, such as to turn the bits of 32 channels taken one at a time
+//! into one word for each of 32 time slots.  The matrix is transposed in
+//! five passes, each of which swaps blocks of half the size of the last
+//! with masks, for 80 swaps of whole words in all.  The two arrays may be
+//! the same.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+BitPlaneTranspose32(unsigned long *pulOut, const unsigned long *pulIn)
+{
+    unsigned long ulIdx, ulShift, ulMask, ulTemp;
+
+    if(pulOut != pulIn)
+    {
+        for(ulIdx = 0; ulIdx < 32; ulIdx++)
+        {
+            pulOut[ulIdx] = pulIn[ulIdx];
+        }
+    }
+
+    //
+    // Swap the upper bits of each word in the first half of each block with
+    // the lower bits of the matching word in the second half.
+    //
+    ulMask = 0x0000ffff;
+    for(ulShift = 16; ulShift != 0; ulShift >>= 1)
+    {
+        for(ulIdx = 0; ulIdx < 32; ulIdx = (ulIdx + ulShift + 1) & ~ulShift)
+        {
+            ulTemp = ((pulOut[ulIdx] >> ulShift) ^
+                      pulOut[ulIdx + ulShift]) & ulMask;
+            pulOut[ulIdx + ulShift] ^= ulTemp;
+            pulOut[ulIdx] ^= ulTemp << ulShift;
+        }
+        ulMask ^= ulMask << (ulShift >> 1);
+    }
+}
+
+//*****************************************************************************
+//
+//! Splits a slice of intensities into bit planes for a chain of shift
+//! registers.
+//!
+//! \param pucOut is the buffer to store the planes in, which must hold
+//! \e ulNumChannels bytes.
+//! \param pucIn is the array of 8-bit intensities, one for each channel.
+//! \param ulNumChannels is the number of channels, which must be a multiple
+//! of eight.
+//! \param ulFlags is a combination of \b BITPLANE_REVERSE_BITS and
+//! \b BITPLANE_REVERSE_CHAIN that describes the wiring of the chain.
+//!
+//! This function will split the intensities of a slice into eight planes of
+//! \e ulNumChannels / 8 bytes, plane 0 first, each of which turns on the
+//! channels with that bit of their intensity set when it is shifted into
+//! the chain of 8-bit registers.  Each plane may be sent as it is by the
+//! uDMA controller to an SSI, such as for binary code modulation.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+BitPlaneSlice(unsigned char *pucOut, const unsigned char *pucIn,
+              unsigned long ulNumChannels, unsigned long ulFlags)
+{
+    unsigned char pucPlanes[8];
+    unsigned long ulNumBytes, ulByte, ulPlane, ulPos;
+
+    ASSERT((ulNumChannels & 7) == 0);
+
+    ulNumBytes = ulNumChannels / 8;
+    for(ulByte = 0; ulByte < ulNumBytes; ulByte++)
+    {
+        BitPlaneTranspose8(pucPlanes, pucIn + (ulByte * 8));
+
+        ulPos = (ulFlags & BITPLANE_REVERSE_CHAIN) ?
+                (ulNumBytes - 1 - ulByte) : ulByte;
+        for(ulPlane = 0; ulPlane < 8; ulPlane++)
+        {
+            pucOut[(ulPlane * ulNumBytes) + ulPos] =
+                ((ulFlags & BITPLANE_REVERSE_BITS) ?
+                 BITPLANE_REVERSE8(pucPlanes[ulPlane]) : pucPlanes[ulPlane]);
+        }
+    }
+}
+
+//*****************************************************************************
+//
+//! Splits a slice of colors into bit planes for a chain of shift registers.
+//!
+//! \param pucOut is the buffer to store the planes in, which must hold
+//! 3 * \e ulNumPixels bytes.
+//! \param pulPixels is the array of colors, packed as by COLOR_RGB() in
+//! utils/color.h.
+//! \param ulNumPixels is the number of colors, which must be a multiple of
+//! eight.
+//! \param ulFlags is a combination of \b BITPLANE_REVERSE_BITS and
+//! \b BITPLANE_REVERSE_CHAIN that describes the wiring of the chain.
+//!
+//! This function will split a slice of RGB LEDs in the same way as
+//! BitPlaneSlice(), where the red, green and blue of each LED are three
+//! channels in that order.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+BitPlaneSliceRGB(unsigned char *pucOut, const unsigned long *pulPixels,
+                 unsigned long ulNumPixels, unsigned long ulFlags)
+{
+    unsigned char pucChannels[24], pucPlanes[8];
+    unsigned long ulNumBytes, ulPixel, ulIdx, ulByte, ulPlane, ulPos;
+
+    ASSERT((ulNumPixels & 7) == 0);
+
+    ulNumBytes = (ulNumPixels * 3) / 8;
+    for(ulPixel = 0; ulPixel < ulNumPixels; ulPixel += 8)
+    {
+        //
+        // Unpack eight colors into 24 channels, which fill three registers.
+        //
+        for(ulIdx = 0; ulIdx < 8; ulIdx++)
+        {
+            pucChannels[(ulIdx * 3) + 0] =
+                (unsigned char)(pulPixels[ulPixel + ulIdx] >> 16);
+            pucChannels[(ulIdx * 3) + 1] =
+                (unsigned char)(pulPixels[ulPixel + ulIdx] >> 8);
+            pucChannels[(ulIdx * 3) + 2] =
+                (unsigned char)pulPixels[ulPixel + ulIdx];
+        }
+
+        for(ulIdx = 0; ulIdx < 3; ulIdx++)
+        {
+            BitPlaneTranspose8(pucPlanes, pucChannels + (ulIdx * 8));
+
+            ulByte = ((ulPixel * 3) / 8) + ulIdx;
+            ulPos = (ulFlags & BITPLANE_REVERSE_CHAIN) ?
+                    (ulNumBytes - 1 - ulByte) : ulByte;
+            for(ulPlane = 0; ulPlane < 8; ulPlane++)
+            {
+                pucOut[(ulPlane * ulNumBytes) + ulPos] =
+                    ((ulFlags & BITPLANE_REVERSE_BITS) ?
+                     BITPLANE_REVERSE8(pucPlanes[ulPlane]) :
+                     pucPlanes[ulPlane]);
+            }
+        }
+    }
+}
+
+//*****************************************************************************
+//
+//! Builds the words that show a frame on a multiplexed matrix of up to eight
+//! rows.
+//!
+//! \param pusOut is the array to store one word for each row in.
+//! \param pucRows is the array of the on or off state of the columns of each
+//! row, with column N in bit N.
+//! \param ulNumRows is the number of rows, from 1 to 8.
+//! \param ulFlags is a combination of \b BITPLANE_REVERSE_BITS and
+//! \b BITPLANE_REVERSE_CHAIN that describes the wiring of the chain.
+//!
+//! This function will build the 16-bit word that shows each row of a matrix
+//! driven by a chain of two 8-bit registers, the first selecting the row and
+//! the second driving the columns, such as the 8x8 LED matrix of the Olimex
+//! BoosterPack.  Each word is sent most significant bit first, so without
+//! \b BITPLANE_REVERSE_CHAIN the columns are in the upper byte, and the row
+//! select is in the lower byte with only bit N set for row N.  The words
+//! may be sent as they are by the uDMA controller to an SSI configured for
+//! 16-bit frames.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+BitPlaneMatrix(unsigned short *pusOut, const unsigned char *pucRows,
+               unsigned long ulNumRows, unsigned long ulFlags)
+{
+    unsigned long ulRow, ulColumns;
+
+    ASSERT((ulNumRows != 0) && (ulNumRows <= 8));
+
+    for(ulRow = 0; ulRow < ulNumRows; ulRow++)
+    {
+        ulColumns = ((ulFlags & BITPLANE_REVERSE_BITS) ?
+                     BITPLANE_REVERSE8(pucRows[ulRow]) : pucRows[ulRow]);
+        pusOut[ulRow] = (unsigned short)((ulFlags & BITPLANE_REVERSE_CHAIN) ?
+                                         ((1 << (ulRow + 8)) | ulColumns) :
+                                         ((ulColumns << 8) | (1 << ulRow)));
+    }
+}
+
+//*****************************************************************************
+//
+// Close the Doxygen group.
+//! @}
+//
+//*****************************************************************************
@@ -0,0 +1,96 @@
+//*****************************************************************************
+//
+// bitplane.h - Prototypes for the bit reversal and bit-plane transpose
+//              kernels.
+//
+//*****************************************************************************
+
+#ifndef __BITPLANE_H__
+#define __BITPLANE_H__
+
+//*****************************************************************************
+//
+// If building with a C++ compiler, make all of the definitions in this header
+// have a C binding.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+//*****************************************************************************
+//
+//! \addtogroup bitplane_api
+//! @{
+//
+//*****************************************************************************
+
+//*****************************************************************************
+//
+//! Flags that describe how a chain of shift registers is wired, for
+//! BitPlaneSlice(), BitPlaneSliceRGB() and BitPlaneMatrix().  Without flags,
+//! channel N of a register is driven by bit N of its byte, and the byte for
+//! the first register of the chain is first in the buffer.
+//! BITPLANE_REVERSE_BITS drives channel N by bit 7 - N instead, for a
+//! register whose outputs are wired in the opposite order or that is
+//! shifted least significant bit first.  BITPLANE_REVERSE_CHAIN puts the
+//! byte for the last register first, since the first byte shifted into a
+//! chain ends up in its last register.
+//
+//*****************************************************************************
+#define BITPLANE_REVERSE_BITS   0x00000001
+#define BITPLANE_REVERSE_CHAIN  0x00000002
+
+//*****************************************************************************
+//
+//! Returns a byte with the order of its bits reversed, from a table.
+//
+//*****************************************************************************
+#define BITPLANE_REVERSE8(ucValue)                                            \
+                                (g_pucBitPlaneReverse[(ucValue) & 0xff])
+
+//*****************************************************************************
+//
+// Close the Doxygen group.
+//! @}
+//
+//*****************************************************************************
+
+//*****************************************************************************
+//
+// The table of each byte with the order of its bits reversed.
+//
+//*****************************************************************************
+extern const unsigned char g_pucBitPlaneReverse[256];
+
+//*****************************************************************************
+//
+// Prototypes for the APIs.
+//
+//*****************************************************************************
+extern unsigned long BitPlaneReverse32(unsigned long ulValue);
+extern void BitPlaneTranspose8(unsigned char *pucOut,
+                               const unsigned char *pucIn);
+extern void BitPlaneTranspose32(unsigned long *pulOut,
+                                const unsigned long *pulIn);
+extern void BitPlaneSlice(unsigned char *pucOut, const unsigned char *pucIn,
+                          unsigned long ulNumChannels, unsigned long ulFlags);
+extern void BitPlaneSliceRGB(unsigned char *pucOut,
+                             const unsigned long *pulPixels,
+                             unsigned long ulNumPixels,
+                             unsigned long ulFlags);
+extern void BitPlaneMatrix(unsigned short *pusOut,
+                           const unsigned char *pucRows,
+                           unsigned long ulNumRows, unsigned long ulFlags);
+
+//*****************************************************************************
+//
+// Mark the end of the C bindings section for C++ compilers.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __BITPLANE_H__
@@ -0,0 +1,637 @@
+//*****************************************************************************
+//
+// color.c - Integer color kernels for LED and display updates.
+//
+//*****************************************************************************
+
+#include "utils/color.h"
+
+//*****************************************************************************
+//
+//! \addtogroup color_api
+//! @{
+//
+//*****************************************************************************
+
+//*****************************************************************************
+//
+// Each kernel works on a whole array of colors in one call, packed one to a
+// word, so that an update of many LEDs pays for a single call.  The kernels
+// are written as simple loops over the array, without branches that depend
+// on the data, so that a compiler can vectorize them for the host.  On a
+// Cortex-M4 the saturating add, the difference and the luma use the UQADD8,
+// USADA8 and SMLAD instructions, which work on every byte or halfword of a
+// word at once; elsewhere the bytes are worked on two at a time in a word.
+//
+//*****************************************************************************
+#if (defined(codered) || defined(gcc) || defined(sourcerygxx)) &&           \
+    defined(__ARM_ARCH_7EM__)
+#define COLOR_DSP
+static unsigned long
+ColorUQADD8(unsigned long ulA, unsigned long ulB)
+{
+    unsigned long ulResult;
+
+    __asm("uqadd8 %0, %1, %2" : "=r" (ulResult) : "r" (ulA), "r" (ulB));
+
+    return(ulResult);
+}
+static unsigned long
+ColorUSADA8(unsigned long ulA, unsigned long ulB, unsigned long ulAcc)
+{
+    unsigned long ulResult;
+
+    __asm("usada8 %0, %1, %2, %3" : "=r" (ulResult) :
+          "r" (ulA), "r" (ulB), "r" (ulAcc));
+
+    return(ulResult);
+}
+static unsigned long
+ColorUXTB16(unsigned long ulA)
+{
+    unsigned long ulResult;
+
+    __asm("uxtb16 %0, %1" : "=r" (ulResult) : "r" (ulA));
+
+    return(ulResult);
+}
+static unsigned long
+ColorSMLAD(unsigned long ulA, unsigned long ulB, unsigned long ulAcc)
+{
+    unsigned long ulResult;
+
+    __asm("smlad %0, %1, %2, %3" : "=r" (ulResult) :
+          "r" (ulA), "r" (ulB), "r" (ulAcc));
+
+    return(ulResult);
+}
+#elif defined(ewarm) && defined(__ARM_MEDIA__)
+#include <intrinsics.h>
+#define COLOR_DSP
+#define ColorUQADD8(ulA, ulB)   __UQADD8(ulA, ulB)
+#define ColorUSADA8(ulA, ulB, ulAcc)                                          \
+                                __USADA8(ulA, ulB, ulAcc)
+#define ColorUXTB16(ulA)        __UXTB16(ulA)
+#define ColorSMLAD(ulA, ulB, ulAcc)                                           \
+                                __SMLAD(ulA, ulB, ulAcc)
+#elif defined(rvmdk) && defined(__TARGET_ARCH_7E_M)
+#define COLOR_DSP
+#define ColorUQADD8(ulA, ulB)   __uqadd8(ulA, ulB)
+#define ColorUSADA8(ulA, ulB, ulAcc)                                          \
+                                __usada8(ulA, ulB, ulAcc)
+#define ColorUXTB16(ulA)        __uxtb16(ulA)
+#define ColorSMLAD(ulA, ulB, ulAcc)                                           \
+                                __smlad(ulA, ulB, ulAcc)
+#endif
+
+//*****************************************************************************
+//
+// The weights of red, green and blue in the luma of a color, from ITU-R
+// BT.601, which add to 256.
+//
+//*****************************************************************************
+#define LUMA_RED                77
+#define LUMA_GREEN              150
+#define LUMA_BLUE               29
+
+//*****************************************************************************
+//
+//! The gamma correction table for a gamma of 2.2 and an 8-bit output, such as
+//! the brightness sent to a strip of smart LEDs, for use with ColorGamma().
+//
+//*****************************************************************************
+const unsigned char g_pucColorGamma8[256] =
+{
+      0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+      0,   0,   0,   1,   1,   1,   1,   1,   1,   1,   1,   1,
+      1,   2,   2,   2,   2,   2,   2,   2,   3,   3,   3,   3,
+      3,   4,   4,   4,   4,   5,   5,   5,   5,   6,   6,   6,
+      6,   7,   7,   7,   8,   8,   8,   9,   9,   9,  10,  10,
+     11,  11,  11,  12,  12,  13,  13,  13,  14,  14,  15,  15,
+     16,  16,  17,  17,  18,  18,  19,  19,  20,  20,  21,  22,
+     22,  23,  23,  24,  25,  25,  26,  26,  27,  28,  28,  29,
+     30,  30,  31,  32,  33,  33,  34,  35,  35,  36,  37,  38,
+     39,  39,  40,  41,  42,  43,  43,  44,  45,  46,  47,  48,
+     49,  49,  50,  51,  52,  53,  54,  55,  56,  57,  58,  59,
+     60,  61,  62,  63,  64,  65,  66,  67,  68,  69,  70,  71,
+     73,  74,  75,  76,  77,  78,  79,  81,  82,  83,  84,  85,
+     87,  88,  89,  90,  91,  93,  94,  95,  97,  98,  99, 100,
+    102, 103, 105, 106, 107, 109, 110, 111, 113, 114, 116, 117,
+    119, 120, 121, 123, 124, 126, 127, 129, 130, 132, 133, 135,
+    137, 138, 140, 141, 143, 145, 146, 148, 149, 151, 153, 154,
+    156, 158, 159, 161, 163, 165, 166, 168, 170, 172, 173, 175,
+    177, 179, 181, 182, 184, 186, 188, 190, 192, 194, 196, 197,
+    199, 201, 203, 205, 207, 209, 211, 213, 215, 217, 219, 221,
+    223, 225, 227, 229, 231, 234, 236, 238, 240, 242, 244, 246,
+    248, 251, 253, 255
+};
+
+//*****************************************************************************
+//
+//! The gamma correction table for a gamma of 2.2 and a 16-bit output, such as
+//! the match value of a PWM timer, for use with ColorGamma16().
+//
+//*****************************************************************************
+const unsigned short g_pusColorGamma16[256] =
+{
+        0,     0,     2,     4,     7,    11,    17,    24,
+       32,    42,    53,    65,    79,    94,   111,   129,
+      148,   169,   192,   216,   242,   270,   299,   330,
+      362,   396,   432,   469,   508,   549,   591,   635,
+      681,   729,   779,   830,   883,   938,   995,  1053,
+     1113,  1175,  1239,  1305,  1373,  1443,  1514,  1587,
+     1663,  1740,  1819,  1900,  1983,  2068,  2155,  2243,
+     2334,  2427,  2521,  2618,  2717,  2817,  2920,  3024,
+     3131,  3240,  3350,  3463,  3578,  3694,  3813,  3934,
+     4057,  4182,  4309,  4438,  4570,  4703,  4838,  4976,
+     5115,  5257,  5401,  5547,  5695,  5845,  5998,  6152,
+     6309,  6468,  6629,  6792,  6957,  7124,  7294,  7466,
+     7640,  7816,  7994,  8175,  8358,  8543,  8730,  8919,
+     9111,  9305,  9501,  9699,  9900, 10102, 10307, 10515,
+    10724, 10936, 11150, 11366, 11585, 11806, 12029, 12254,
+    12482, 12712, 12944, 13179, 13416, 13655, 13896, 14140,
+    14386, 14635, 14885, 15138, 15394, 15652, 15912, 16174,
+    16439, 16706, 16975, 17247, 17521, 17798, 18077, 18358,
+    18642, 18928, 19216, 19507, 19800, 20095, 20393, 20694,
+    20996, 21301, 21609, 21919, 22231, 22546, 22863, 23182,
+    23504, 23829, 24156, 24485, 24817, 25151, 25487, 25826,
+    26168, 26512, 26858, 27207, 27558, 27912, 28268, 28627,
+    28988, 29351, 29717, 30086, 30457, 30830, 31206, 31585,
+    31966, 32349, 32735, 33124, 33514, 33908, 34304, 34702,
+    35103, 35507, 35913, 36321, 36732, 37146, 37562, 37981,
+    38402, 38825, 39252, 39680, 40112, 40546, 40982, 41421,
+    41862, 42306, 42753, 43202, 43654, 44108, 44565, 45025,
+    45487, 45951, 46418, 46888, 47360, 47835, 48313, 48793,
+    49275, 49761, 50249, 50739, 51232, 51728, 52226, 52727,
+    53230, 53736, 54245, 54756, 55270, 55787, 56306, 56828,
+    57352, 57879, 58409, 58941, 59476, 60014, 60554, 61097,
+    61642, 62190, 62741, 63295, 63851, 64410, 64971, 65535
+};
+
+//*****************************************************************************
+//
+// Returns a value from 0 to 65535 divided by 255, rounded to the nearest
+// integer, without a division.
+//
+//*****************************************************************************
+#define DIV255(ulValue)                                                       \
+    (((ulValue) + 128 + (((ulValue) + 128) >> 8)) >> 8)
+
+//*****************************************************************************
+//
+//! Gamma corrects an array of colors.
+//!
+//! \param pulOut is the array to store the corrected colors in.
+//! \param pulIn is the array of colors to correct.
+//! \param ulCount is the number of colors.
+//! \param pucTable is the 256 entry table that maps each component to its
+//! corrected value, such as \b g_pucColorGamma8.
+//!
+//! This function will look up the red, green and blue components of each
+//! color in the table, so that steps in the value of a component appear as
+//! even steps of brightness.  The alpha component is copied unchanged.  The
+//! two arrays may be the same.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+ColorGamma(unsigned long *pulOut, const unsigned long *pulIn,
+           unsigned long ulCount, const unsigned char *pucTable)
+{
+    unsigned long ulIdx, ulColor;
+
+    for(ulIdx = 0; ulIdx < ulCount; ulIdx++)
+    {
+        ulColor = pulIn[ulIdx];
+        pulOut[ulIdx] = ((ulColor & 0xff000000) |
+                         ((unsigned long)pucTable[COLOR_RED(ulColor)] << 16) |
+                         ((unsigned long)pucTable[COLOR_GREEN(ulColor)] << 8) |
+                         (unsigned long)pucTable[COLOR_BLUE(ulColor)]);
+    }
+}
+
+//*****************************************************************************
+//
+//! Gamma corrects an array of colors to 16-bit components.
+//!
+//! \param pulOut is the array to store the corrected components in, which
+//! must hold three times \e ulCount values.
+//! \param pulIn is the array of colors to correct.
+//! \param ulCount is the number of colors.
+//! \param pusTable is the 256 entry table that maps each component to its
+//! corrected 16-bit value, such as \b g_pusColorGamma16.
+//!
+//! This function will look up the red, green and blue components of each
+//! color in the table and store them in that order, from 0x0000 to 0xFFFF,
+//! each in a word.  This is the three element array that RGBColorSet() and
+//! RGBSet() of the EK-LM4F120XL RGB LED driver take, so the output for one
+//! LED can be passed to them directly.  The finer output gives the dim end of
+//! the range more steps than there are in the input.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+ColorGamma16(unsigned long *pulOut, const unsigned long *pulIn,
+             unsigned long ulCount, const unsigned short *pusTable)
+{
+    unsigned long ulIdx, ulColor;
+
+    for(ulIdx = 0; ulIdx < ulCount; ulIdx++)
+    {
+        ulColor = pulIn[ulIdx];
+        pulOut[0] = pusTable[COLOR_RED(ulColor)];
+        pulOut[1] = pusTable[COLOR_GREEN(ulColor)];
+        pulOut[2] = pusTable[COLOR_BLUE(ulColor)];
+        pulOut += 3;
+    }
+}
+
+//*****************************************************************************
+//
+//! Converts an array of colors from hue, saturation and value to RGB.
+//!
+//! \param pulOut is the array to store the opaque RGB colors in.
+//! \param pulHSV is the array of colors to convert, each packed by
+//! COLOR_HSV().
+//! \param ulCount is the number of colors.
+//!
+//! This function will convert each color, so that a rainbow or a fade can be
+//! generated by stepping the hue or the value of an array of colors.  Each
+//! component is found as value - value * saturation * weight, where the
+//! weight is a trapezoid of the hue in sixths of a turn, using only
+//! multiplies, shifts and the selection of a minimum or maximum.  Each
+//! component is rounded to the nearest value.  The two arrays may be the
+//! same.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+ColorHSVToRGB(unsigned long *pulOut, const unsigned long *pulHSV,
+              unsigned long ulCount)
+{
+    unsigned long ulIdx, ulHSV, ulSatVal, ulVal, ulColor, ulChan;
+    long lHue, lK, lWeight;
+
+    for(ulIdx = 0; ulIdx < ulCount; ulIdx++)
+    {
+        ulHSV = pulHSV[ulIdx];
+        ulVal = ulHSV & 0xff;
+        ulSatVal = ((ulHSV >> 8) & 0xff) * ulVal;
+
+        //
+        // The hue in 1/65536ths of a sixth of a turn.
+        //
+        lHue = (long)((ulHSV >> 16) * 6);
+
+        //
+        // Find red, green and blue, which are the same function of the hue
+        // offset by five, three and one sixths of a turn.  The amount taken
+        // from the value is found in 1/255ths, so that there is a single
+        // rounding.
+        //
+        ulColor = 0xff000000;
+        for(ulChan = 0; ulChan < 3; ulChan++)
+        {
+            lK = lHue + (long)((5 - (2 * ulChan)) << 16);
+            lK -= (lK >= (6 << 16)) ? (6 << 16) : 0;
+            lWeight = (((4 << 16) - lK) < lK) ? ((4 << 16) - lK) : lK;
+            lWeight = (lWeight < 0) ? 0 : lWeight;
+            lWeight = (lWeight > 65536) ? 65536 : lWeight;
+            ulColor |= (DIV255((ulVal * 255) -
+                               (((ulSatVal * (unsigned long)lWeight) +
+                                 32768) >> 16)) << (16 - (8 * ulChan)));
+        }
+        pulOut[ulIdx] = ulColor;
+    }
+}
+
+//*****************************************************************************
+//
+//! Converts an array of colors from hue, saturation and lightness to RGB.
+//!
+//! \param pulOut is the array to store the opaque RGB colors in.
+//! \param pulHSL is the array of colors to convert, each packed by
+//! COLOR_HSV() with the lightness in place of the value.
+//! \param ulCount is the number of colors.
+//!
+//! This function will convert each color in the same way as ColorHSVToRGB(),
+//! except that a lightness of 255 is always white and a lightness of 128 is
+//! the fully saturated color.  Each component is found as lightness -
+//! chroma * weight, where the weight is a trapezoid of the hue in twelfths
+//! of a turn from -1 to 1.  The two arrays may be the same.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+ColorHSLToRGB(unsigned long *pulOut, const unsigned long *pulHSL,
+              unsigned long ulCount)
+{
+    unsigned long ulIdx, ulHSL, ulLight, ulChroma, ulColor, ulChan;
+    long lHue, lK, lWeight;
+
+    for(ulIdx = 0; ulIdx < ulCount; ulIdx++)
+    {
+        ulHSL = pulHSL[ulIdx];
+        ulLight = ulHSL & 0xff;
+
+        //
+        // Half of the chroma, in 1/255ths, which is largest at the middle
+        // lightness.
+        //
+        ulChroma = (ulLight < (255 - ulLight)) ? ulLight : (255 - ulLight);
+        ulChroma *= (ulHSL >> 8) & 0xff;
+
+        //
+        // The hue in 1/65536ths of a twelfth of a turn.
+        //
+        lHue = (long)((ulHSL >> 16) * 12);
+
+        //
+        // Find red, green and blue, which are the same function of the hue
+        // offset by none, eight and four twelfths of a turn.  The weight is
+        // used as one less itself, from 0 to 2, so that the product is never
+        // negative, and the components are found in 1/255ths, so that there
+        // is a single rounding.
+        //
+        ulColor = 0xff000000;
+        for(ulChan = 0; ulChan < 3; ulChan++)
+        {
+            lK = lHue + (long)(((8 * ulChan) % 12) << 16);
+            lK -= (lK >= (12 << 16)) ? (12 << 16) : 0;
+            lWeight = (((9 << 16) - lK) < (lK - (3 << 16))) ?
+                       ((9 << 16) - lK) : (lK - (3 << 16));
+            lWeight = (lWeight < -65536) ? -65536 : lWeight;
+            lWeight = (lWeight > 65536) ? 65536 : lWeight;
+            ulColor |= (DIV255(((ulLight * 255) - ulChroma) +
+                               (((ulChroma *
+                                  (unsigned long)(65536 - lWeight)) +
+                                 32768) >> 16)) << (16 - (8 * ulChan)));
+        }
+        pulOut[ulIdx] = ulColor;
+    }
+}
+
+//*****************************************************************************
+//
+//! Scales the brightness of an array of colors.
+//!
+//! \param pulOut is the array to store the scaled colors in.
+//! \param pulIn is the array of colors to scale.
+//! \param ulScale is the scale, from 0 for black to \b COLOR_SCALE_ONE for
+//! no change.
+//! \param ulCount is the number of colors.
+//!
+//! This function will multiply the red, green and blue components of each
+//! color by the scale, rounding to the nearest value, in place of the
+//! floating point intensity of the RGB LED driver.  Red and blue are scaled
+//! together in one word, and green in another.  The alpha component is
+//! copied unchanged.  The two arrays may be the same.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+ColorScale(unsigned long *pulOut, const unsigned long *pulIn,
+           unsigned long ulScale, unsigned long ulCount)
+{
+    unsigned long ulIdx, ulColor;
+
+    for(ulIdx = 0; ulIdx < ulCount; ulIdx++)
+    {
+        ulColor = pulIn[ulIdx];
+        pulOut[ulIdx] = ((ulColor & 0xff000000) |
+                         (((((ulColor & 0x00ff00ff) * ulScale) +
+                            0x00800080) >> 8) & 0x00ff00ff) |
+                         (((((ulColor & 0x0000ff00) * ulScale) +
+                            0x00008000) >> 8) & 0x0000ff00));
+    }
+}
+
+//*****************************************************************************
+//
+//! Blends two arrays of colors by a weight.
+//!
+//! \param pulOut is the array to store the blended colors in.
+//! \param pulA is the first array of colors.
+//! \param pulB is the second array of colors.
+//! \param ulWeight is the weight of the second array, from 0 for the first
+//! color to \b COLOR_SCALE_ONE for the second.
+//! \param ulCount is the number of colors.
+//!
+//! This function will compute A + (B - A) * weight for each component of
+//! each pair of colors, including alpha, rounding to the nearest value, such
+//! as to cross fade from one pattern to another.  Two components are blended
+//! at a time in each word.  The output array may be the same as either
+//! input.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+ColorBlend(unsigned long *pulOut, const unsigned long *pulA,
+           const unsigned long *pulB, unsigned long ulWeight,
+           unsigned long ulCount)
+{
+    unsigned long ulIdx, ulA, ulB, ulInverse;
+
+    ulInverse = COLOR_SCALE_ONE - ulWeight;
+    for(ulIdx = 0; ulIdx < ulCount; ulIdx++)
+    {
+        ulA = pulA[ulIdx];
+        ulB = pulB[ulIdx];
+        pulOut[ulIdx] = ((((((ulA & 0x00ff00ff) * ulInverse) +
+                            ((ulB & 0x00ff00ff) * ulWeight) + 0x00800080) >>
+                           8) & 0x00ff00ff) |
+                         (((((ulA >> 8) & 0x00ff00ff) * ulInverse) +
+                           (((ulB >> 8) & 0x00ff00ff) * ulWeight) +
+                           0x00800080) & 0xff00ff00));
+    }
+}
+
+//*****************************************************************************
+//
+//! Blends an array of colors over another by the alpha of each.
+//!
+//! \param pulOut is the array to store the blended colors in.
+//! \param pulDst is the array of colors that are blended over.
+//! \param pulSrc is the array of colors that are blended over them.
+//! \param ulCount is the number of colors.
+//!
+//! This function will blend the red, green and blue components of each
+//! source color over the destination color by the alpha component of the
+//! source, where 255 replaces the destination and 0 leaves it unchanged,
+//! such as to draw a sprite over a background.  The alpha of the result is
+//! that of the destination.  The output array may be the same as either
+//! input.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+ColorBlendAlpha(unsigned long *pulOut, const unsigned long *pulDst,
+                const unsigned long *pulSrc, unsigned long ulCount)
+{
+    unsigned long ulIdx, ulDst, ulSrc, ulWeight;
+
+    for(ulIdx = 0; ulIdx < ulCount; ulIdx++)
+    {
+        ulDst = pulDst[ulIdx];
+        ulSrc = pulSrc[ulIdx];
+
+        //
+        // Map the alpha from 0 to 255 onto a weight from 0 to 256.
+        //
+        ulWeight = COLOR_ALPHA(ulSrc);
+        ulWeight += ulWeight >> 7;
+
+        pulOut[ulIdx] = ((ulDst & 0xff000000) |
+                         ((((((ulDst & 0x00ff00ff) * (256 - ulWeight)) +
+                             ((ulSrc & 0x00ff00ff) * ulWeight) +
+                             0x00800080) >> 8) & 0x00ff00ff)) |
+                         (((((ulDst & 0x0000ff00) * (256 - ulWeight)) +
+                            ((ulSrc & 0x0000ff00) * ulWeight) +
+                            0x00008000) >> 8) & 0x0000ff00));
+    }
+}
+
+//*****************************************************************************
+//
+//! Adds two arrays of colors.
+//!
+//! \param pulOut is the array to store the sums in.
+//! \param pulA is the first array of colors.
+//! \param pulB is the second array of colors.
+//! \param ulCount is the number of colors.
+//!
+//! This function will add each component of each pair of colors, including
+//! alpha, saturating at 255, such as to add a highlight or to combine
+//! patterns.  On a Cortex-M4 all four components are added by a single
+//! instruction.  The output array may be the same as either input.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+ColorAdd(unsigned long *pulOut, const unsigned long *pulA,
+         const unsigned long *pulB, unsigned long ulCount)
+{
+    unsigned long ulIdx;
+#ifndef COLOR_DSP
+    unsigned long ulA, ulB, ulSum, ulCarry;
+#endif
+
+    for(ulIdx = 0; ulIdx < ulCount; ulIdx++)
+    {
+#ifdef COLOR_DSP
+        pulOut[ulIdx] = ColorUQADD8(pulA[ulIdx], pulB[ulIdx]);
+#else
+        //
+        // Add the low seven bits of each component, find the carry out of
+        // each from the top bits, and set each component that carried to
+        // 255.
+        //
+        ulA = pulA[ulIdx];
+        ulB = pulB[ulIdx];
+        ulSum = (ulA & 0x7f7f7f7f) + (ulB & 0x7f7f7f7f);
+        ulCarry = ((ulA & ulB) | ((ulA | ulB) & ulSum)) & 0x80808080;
+        pulOut[ulIdx] = ((ulSum ^ ((ulA ^ ulB) & 0x80808080)) |
+                         ((ulCarry >> 7) * 0xff));
+#endif
+    }
+}
+
+//*****************************************************************************
+//
+//! Finds the luma of an array of colors.
+//!
+//! \param pucOut is the array to store the luma of each color in.
+//! \param pulIn is the array of colors.
+//! \param ulCount is the number of colors.
+//!
+//! This function will find the perceived brightness of each color, from 0
+//! to 255, from a weighted sum of the red, green and blue components, such
+//! as to show a pattern on a single color or monochrome display.  On a
+//! Cortex-M4 the red and blue products are found by a single instruction.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+ColorLuma(unsigned char *pucOut, const unsigned long *pulIn,
+          unsigned long ulCount)
+{
+    unsigned long ulIdx, ulColor;
+
+    for(ulIdx = 0; ulIdx < ulCount; ulIdx++)
+    {
+        ulColor = pulIn[ulIdx];
+#ifdef COLOR_DSP
+        pucOut[ulIdx] = (unsigned char)(ColorSMLAD(ColorUXTB16(ulColor),
+                                                   (LUMA_RED << 16) |
+                                                   LUMA_BLUE,
+                                                   (COLOR_GREEN(ulColor) *
+                                                    LUMA_GREEN) + 128) >> 8);
+#else
+        pucOut[ulIdx] = (unsigned char)(((COLOR_RED(ulColor) * LUMA_RED) +
+                                         (COLOR_GREEN(ulColor) *
+                                          LUMA_GREEN) +
+                                         (COLOR_BLUE(ulColor) * LUMA_BLUE) +
+                                         128) >> 8);
+#endif
+    }
+}
+
+//*****************************************************************************
+//
+//! Finds the difference between two arrays of colors.
+//!
+//! \param pulA is the first array of colors.
+//! \param pulB is the second array of colors.
+//! \param ulCount is the number of colors.
+//!
+//! This function will sum the absolute differences of each component of each
+//! pair of colors, including alpha, such as to skip sending a frame to a
+//! strip of LEDs when it has not changed enough to be seen.  On a Cortex-M4
+//! the four differences of a pair are summed by a single instruction.
+//!
+//! \return Returns the sum of the absolute differences.
+//
+//*****************************************************************************
+unsigned long
+ColorDifference(const unsigned long *pulA, const unsigned long *pulB,
+                unsigned long ulCount)
+{
+    unsigned long ulIdx, ulSum;
+#ifndef COLOR_DSP
+    unsigned long ulShift;
+    long lDiff;
+#endif
+
+    ulSum = 0;
+    for(ulIdx = 0; ulIdx < ulCount; ulIdx++)
+    {
+#ifdef COLOR_DSP
+        ulSum = ColorUSADA8(pulA[ulIdx], pulB[ulIdx], ulSum);
+#else
+        for(ulShift = 0; ulShift < 32; ulShift += 8)
+        {
+            lDiff = ((long)((pulA[ulIdx] >> ulShift) & 0xff) -
+                     (long)((pulB[ulIdx] >> ulShift) & 0xff));
+            ulSum += (unsigned long)((lDiff < 0) ? -lDiff : lDiff);
+        }
+#endif
+    }
+
+    return(ulSum);
+}
+
+//*****************************************************************************
+//
+// Close the Doxygen group.
+//! @}
+//
+//*****************************************************************************
@@ -0,0 +1,131 @@
+//*****************************************************************************
+//
+// color.h - Prototypes for the integer color kernels.
+//
+//*****************************************************************************
+
+#ifndef __COLOR_H__
+#define __COLOR_H__
+
+//*****************************************************************************
+//
+// If building with a C++ compiler, make all of the definitions in this header
+// have a C binding.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+//*****************************************************************************
+//
+//! \addtogroup color_api
+//! @{
+//
+//*****************************************************************************
+
+//*****************************************************************************
+//
+//! Packs a color from its alpha, red, green and blue components, each from 0
+//! to 255.  The alpha component is only used by ColorBlendAlpha(), where 255
+//! is opaque.
+//
+//*****************************************************************************
+#define COLOR_ARGB(a, r, g, b)  ((((unsigned long)(a) & 0xff) << 24) |       \
+                                 (((unsigned long)(r) & 0xff) << 16) |       \
+                                 (((unsigned long)(g) & 0xff) << 8) |        \
+                                 ((unsigned long)(b) & 0xff))
+
+//*****************************************************************************
+//
+//! Packs an opaque color from its red, green and blue components.
+//
+//*****************************************************************************
+#define COLOR_RGB(r, g, b)      COLOR_ARGB(0xff, r, g, b)
+
+//*****************************************************************************
+//
+//! Extracts the components of a packed color.
+//
+//*****************************************************************************
+#define COLOR_ALPHA(c)          (((c) >> 24) & 0xff)
+#define COLOR_RED(c)            (((c) >> 16) & 0xff)
+#define COLOR_GREEN(c)          (((c) >> 8) & 0xff)
+#define COLOR_BLUE(c)           ((c) & 0xff)
+
+//*****************************************************************************
+//
+//! Packs a color from its hue, from 0 to 65535 for a whole turn starting at
+//! red, and its saturation and value (or lightness) from 0 to 255, for
+//! ColorHSVToRGB() and ColorHSLToRGB().
+//
+//*****************************************************************************
+#define COLOR_HSV(h, s, v)      ((((unsigned long)(h) & 0xffff) << 16) |     \
+                                 (((unsigned long)(s) & 0xff) << 8) |        \
+                                 ((unsigned long)(v) & 0xff))
+
+//*****************************************************************************
+//
+//! The scale or weight that leaves a color unchanged in ColorScale() and
+//! ColorBlend().
+//
+//*****************************************************************************
+#define COLOR_SCALE_ONE         256
+
+//*****************************************************************************
+//
+// Close the Doxygen group.
+//! @}
+//
+//*****************************************************************************
+
+//*****************************************************************************
+//
+// The gamma correction tables for a gamma of 2.2, for 8-bit and 16-bit
+// outputs.
+//
+//*****************************************************************************
+extern const unsigned char g_pucColorGamma8[256];
+extern const unsigned short g_pusColorGamma16[256];
+
+//*****************************************************************************
+//
+// Prototypes for the APIs.
+//
+//*****************************************************************************
+extern void ColorGamma(unsigned long *pulOut, const unsigned long *pulIn,
+                       unsigned long ulCount, const unsigned char *pucTable);
+extern void ColorGamma16(unsigned long *pulOut, const unsigned long *pulIn,
+                         unsigned long ulCount,
+                         const unsigned short *pusTable);
+extern void ColorHSVToRGB(unsigned long *pulOut, const unsigned long *pulHSV,
+                          unsigned long ulCount);
+extern void ColorHSLToRGB(unsigned long *pulOut, const unsigned long *pulHSL,
+                          unsigned long ulCount);
+extern void ColorScale(unsigned long *pulOut, const unsigned long *pulIn,
+                       unsigned long ulScale, unsigned long ulCount);
+extern void ColorBlend(unsigned long *pulOut, const unsigned long *pulA,
+                       const unsigned long *pulB, unsigned long ulWeight,
+                       unsigned long ulCount);
+extern void ColorBlendAlpha(unsigned long *pulOut, const unsigned long *pulDst,
+                            const unsigned long *pulSrc,
+                            unsigned long ulCount);
+extern void ColorAdd(unsigned long *pulOut, const unsigned long *pulA,
+                     const unsigned long *pulB, unsigned long ulCount);
+extern void ColorLuma(unsigned char *pucOut, const unsigned long *pulIn,
+                      unsigned long ulCount);
+extern unsigned long ColorDifference(const unsigned long *pulA,
+                                     const unsigned long *pulB,
+                                     unsigned long ulCount);
+
+//*****************************************************************************
+//
+// Mark the end of the C bindings section for C++ compilers.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __COLOR_H__
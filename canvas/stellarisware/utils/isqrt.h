@@ -1,6 +1,6 @@
 //*****************************************************************************
 //
-// isqrt.h - Prototype for the integer square root function.
+// isqrt.h - Prototypes for the integer square root and magnitude functions.
 //
 // Copyright (c) 2006-2012 Texas Instruments Incorporated.  All rights reserved.
 // Software License Agreement
@@ -38,10 +38,19 @@ extern "C"
 
 //*****************************************************************************
 //
-// The prototype for the integer square root function.
+// Prototypes for the integer square root and magnitude functions.
 //
 //*****************************************************************************
 extern unsigned long isqrt(unsigned long ulValue);
+extern unsigned long isqrt64(unsigned long long ullValue);
+extern unsigned long imag(long lX, long lY);
+extern unsigned long imagapprox(long lX, long lY);
+extern void isqrtarray(unsigned long *pulRoot, const unsigned long *pulValue,
+                       unsigned long ulCount);
+extern void imagarray(unsigned long *pulMag, const long *plX, const long *plY,
+                      unsigned long ulCount);
+extern void imagapproxarray(unsigned long *pulMag, const long *plX,
+                            const long *plY, unsigned long ulCount);
 
 //*****************************************************************************
 //
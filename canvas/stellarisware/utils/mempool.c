@@ -0,0 +1,538 @@
+//*****************************************************************************
+//
+// mempool.c - Fixed-size block pool allocator usable from interrupt context.
+//
+//*****************************************************************************
+
+#include "inc/hw_types.h"
+#include "driverlib/debug.h"
+#include "utils/mempool.h"
+
+#if defined(ewarm)
+#include <intrinsics.h>
+#elif !defined(codered) && !defined(gcc) && !defined(sourcerygxx) &&          \
+      !defined(rvmdk) && !defined(__ARMCC_VERSION)
+#include "driverlib/cpu.h"
+#endif
+
+//*****************************************************************************
+//
+//! \addtogroup mempool_api
+//! @{
+//
+//*****************************************************************************
+
+//*****************************************************************************
+//
+// The layout of the word at the start of every block.  The lower 16 bits hold
+// the index of the next free block while the block is on the free list.  The
+// upper 16 bits record whether the block is free or allocated, so that a block
+// freed twice, or a pointer that was never allocated, can be caught.
+//
+//*****************************************************************************
+#define MEMPOOL_INDEX_M         0x0000FFFF
+#define MEMPOOL_INDEX_NONE      0x0000FFFF
+#define MEMPOOL_STATE_M         0xFFFF0000
+#define MEMPOOL_STATE_FREE      0xF4EE0000
+#define MEMPOOL_STATE_USED      0xA1100000
+
+//*****************************************************************************
+//
+// The amount added to the upper 16 bits of the free list head each time the
+// list is changed.
+//
+//*****************************************************************************
+#define MEMPOOL_TAG_M           0xFFFF0000
+#define MEMPOOL_TAG_INC         0x00010000
+
+//*****************************************************************************
+//
+// The value written to every guard byte.
+//
+//*****************************************************************************
+#define MEMPOOL_GUARD_BYTE      0xFD
+
+//*****************************************************************************
+//
+// Returns a pointer to the header word of a block.
+//
+//*****************************************************************************
+#define BlockHeader(psPool, ulIndex)                                          \
+        ((volatile unsigned long *)((psPool)->pucStorage +                    \
+                                    ((ulIndex) * (psPool)->ulStride)))
+
+//*****************************************************************************
+//
+// Returns a pointer to the application's part of a block, given a pointer to
+// its header.
+//
+//*****************************************************************************
+#define BlockData(pulHeader)                                                  \
+        ((unsigned char *)(pulHeader) + sizeof(unsigned long) +               \
+         MEMPOOL_GUARD_SIZE)
+
+//*****************************************************************************
+//
+// Stores ulNew at pulAddr if it currently holds ulOld, as a single operation
+// that cannot be split by an interrupt.  Returns true if the value was stored.
+// The exclusive access versions may fail even though the value matched, for
+// example if an interrupt occurred, so every caller retries until it succeeds.
+//
+//*****************************************************************************
+static tBoolean
+AtomicCompareSwap(volatile unsigned long *pulAddr, unsigned long ulOld,
+                  unsigned long ulNew)
+{
+#if defined(codered) || defined(gcc) || defined(sourcerygxx)
+    return(__sync_bool_compare_and_swap(pulAddr, ulOld, ulNew) ? true : false);
+#elif defined(ewarm)
+    if(__LDREX((unsigned long *)pulAddr) != ulOld)
+    {
+        return(false);
+    }
+    return((__STREX(ulNew, (unsigned long *)pulAddr) == 0) ? true : false);
+#elif defined(rvmdk) || defined(__ARMCC_VERSION)
+    if(__ldrex(pulAddr) != ulOld)
+    {
+        return(false);
+    }
+    return((__strex(ulNew, pulAddr) == 0) ? true : false);
+#else
+    unsigned long ulPrimask;
+    tBoolean bStored;
+
+    //
+    // This compiler has no exclusive access intrinsics, so fall back to
+    // masking interrupts around the comparison.
+    //
+    ulPrimask = CPUcpsid();
+    bStored = (*pulAddr == ulOld) ? true : false;
+    if(bStored)
+    {
+        *pulAddr = ulNew;
+    }
+    if(!ulPrimask)
+    {
+        CPUcpsie();
+    }
+    return(bStored);
+#endif
+}
+
+//*****************************************************************************
+//
+// Adds lDelta to the value at pulAddr and returns the new value.
+//
+//*****************************************************************************
+static unsigned long
+AtomicAdd(volatile unsigned long *pulAddr, long lDelta)
+{
+    unsigned long ulValue;
+
+    do
+    {
+        ulValue = *pulAddr;
+    }
+    while(!AtomicCompareSwap(pulAddr, ulValue, ulValue + lDelta));
+
+    return(ulValue + lDelta);
+}
+
+//*****************************************************************************
+//
+// Raises the value at pulAddr to ulValue if it is lower.
+//
+//*****************************************************************************
+static void
+AtomicMax(volatile unsigned long *pulAddr, unsigned long ulValue)
+{
+    unsigned long ulOld;
+
+    do
+    {
+        ulOld = *pulAddr;
+        if(ulOld >= ulValue)
+        {
+            return;
+        }
+    }
+    while(!AtomicCompareSwap(pulAddr, ulOld, ulValue));
+}
+
+#if MEMPOOL_GUARD_SIZE
+//*****************************************************************************
+//
+// Returns true if both guards of a block are intact.  The trailing guard also
+// covers any padding between the end of the block and the next header.
+//
+//*****************************************************************************
+static tBoolean
+GuardsIntact(tMemPool *psPool, volatile unsigned long *pulHeader)
+{
+    unsigned char *pucByte, *pucEnd;
+
+    pucByte = (unsigned char *)pulHeader + sizeof(unsigned long);
+    pucEnd = BlockData(pulHeader);
+    while(pucByte < pucEnd)
+    {
+        if(*pucByte++ != MEMPOOL_GUARD_BYTE)
+        {
+            return(false);
+        }
+    }
+
+    pucByte = BlockData(pulHeader) + psPool->ulBlockSize;
+    pucEnd = (unsigned char *)pulHeader + psPool->ulStride;
+    while(pucByte < pucEnd)
+    {
+        if(*pucByte++ != MEMPOOL_GUARD_BYTE)
+        {
+            return(false);
+        }
+    }
+
+    return(true);
+}
+#endif
+
+//*****************************************************************************
+//
+//! Initializes a pool of fixed size blocks.
+//!
+//! \param psPool points to the pool structure to initialize.
+//! \param pvStorage points to the storage for the blocks, which must be word
+//! aligned.
+//! \param ulStorageSize is the size of the storage in bytes.  This must be at
+//! least MEMPOOL_STORAGE_SIZE(\e ulBlockSize, \e ulNumBlocks).
+//! \param ulBlockSize is the number of bytes in each block.
+//! \param ulNumBlocks is the number of blocks in the pool, which must be less
+//! than 65535.
+//!
+//! This function prepares a pool from which blocks of \e ulBlockSize bytes
+//! can be allocated and freed in constant time from any context, including
+//! interrupt handlers, without disabling interrupts.  Every block is word
+//! aligned.  A block allocated by one stage of a pipeline may be passed to
+//! and freed by another.
+//!
+//! MEMPOOL_DEFINE() and MEMPOOL_INIT() may be used to define and initialize
+//! a pool holding a particular type, with storage of the correct size.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+MemPoolInit(tMemPool *psPool, void *pvStorage, unsigned long ulStorageSize,
+            unsigned long ulBlockSize, unsigned long ulNumBlocks)
+{
+    volatile unsigned long *pulHeader;
+    unsigned long ulIndex;
+
+    //
+    // Check the arguments.
+    //
+    ASSERT(psPool != 0);
+    ASSERT(pvStorage != 0);
+    ASSERT(((unsigned long)pvStorage & 3) == 0);
+    ASSERT(ulBlockSize != 0);
+    ASSERT(ulNumBlocks && (ulNumBlocks < MEMPOOL_INDEX_NONE));
+    ASSERT(ulStorageSize >= MEMPOOL_STORAGE_SIZE(ulBlockSize, ulNumBlocks));
+    ASSERT((MEMPOOL_GUARD_SIZE & 3) == 0);
+
+    //
+    // Initialize the pool object.
+    //
+    psPool->pucStorage = pvStorage;
+    psPool->ulStride = MEMPOOL_BLOCK_STRIDE(ulBlockSize);
+    psPool->ulBlockSize = ulBlockSize;
+    psPool->ulNumBlocks = ulNumBlocks;
+    psPool->ulInUse = 0;
+    psPool->ulHighWater = 0;
+    psPool->ulAllocs = 0;
+    psPool->ulFailures = 0;
+    psPool->ulGuardErrors = 0;
+
+    //
+    // Link every block onto the free list in order, and fill in the guards.
+    //
+    for(ulIndex = 0; ulIndex < ulNumBlocks; ulIndex++)
+    {
+        pulHeader = BlockHeader(psPool, ulIndex);
+        *pulHeader = (MEMPOOL_STATE_FREE |
+                      ((ulIndex == (ulNumBlocks - 1)) ? MEMPOOL_INDEX_NONE :
+                       (ulIndex + 1)));
+
+#if MEMPOOL_GUARD_SIZE
+        {
+            unsigned char *pucByte;
+
+            for(pucByte = (unsigned char *)pulHeader + sizeof(unsigned long);
+                pucByte < (unsigned char *)pulHeader + psPool->ulStride;
+                pucByte++)
+            {
+                *pucByte = MEMPOOL_GUARD_BYTE;
+            }
+        }
+#endif
+    }
+
+    psPool->ulFreeHead = 0;
+}
+
+//*****************************************************************************
+//
+//! Allocates a block from a pool.
+//!
+//! \param psPool points to the pool to allocate from.
+//!
+//! This function takes a block from the pool.  It may be called from any
+//! context, including interrupt handlers, and may preempt or be preempted by
+//! another call to MemPoolAlloc() or MemPoolFree() on the same pool.  It never
+//! waits; if the pool is empty it fails at once.
+//!
+//! \return Returns a pointer to the block, or 0 if every block is in use.
+//
+//*****************************************************************************
+void *
+MemPoolAlloc(tMemPool *psPool)
+{
+    volatile unsigned long *pulHeader;
+    unsigned long ulHead, ulIndex, ulNext;
+
+    ASSERT(psPool != 0);
+
+    //
+    // Take the first block from the free list.  If the list is changed by an
+    // interrupt between reading the head and replacing it, the count in the
+    // upper half of the head will have changed, so the swap fails and is
+    // retried.  This is also why reading a stale link from a block that has
+    // just been allocated elsewhere does no harm.
+    //
+    do
+    {
+        ulHead = psPool->ulFreeHead;
+        ulIndex = ulHead & MEMPOOL_INDEX_M;
+        if(ulIndex == MEMPOOL_INDEX_NONE)
+        {
+            AtomicAdd(&psPool->ulFailures, 1);
+            return(0);
+        }
+
+        pulHeader = BlockHeader(psPool, ulIndex);
+        ulNext = *pulHeader & MEMPOOL_INDEX_M;
+    }
+    while(!AtomicCompareSwap(&psPool->ulFreeHead, ulHead,
+                             ((ulHead + MEMPOOL_TAG_INC) & MEMPOOL_TAG_M) |
+                             ulNext));
+
+    *pulHeader = MEMPOOL_STATE_USED | MEMPOOL_INDEX_NONE;
+
+    //
+    // Update the usage counters.
+    //
+    AtomicMax(&psPool->ulHighWater, AtomicAdd(&psPool->ulInUse, 1));
+    AtomicAdd(&psPool->ulAllocs, 1);
+
+    return(BlockData(pulHeader));
+}
+
+//*****************************************************************************
+//
+//! Returns a block to a pool.
+//!
+//! \param psPool points to the pool that the block was allocated from.
+//! \param pvBlock points to the block to free.
+//!
+//! This function puts a block returned by MemPoolAlloc() back into the pool.
+//! Like MemPoolAlloc(), it may be called from any context, and the block need
+//! not be freed from the context that allocated it.
+//!
+//! If the pool has guards, they are checked, and a damaged guard is counted
+//! in the \e ulGuardErrors statistic.  In a DEBUG build, freeing a block with
+//! a damaged guard, freeing a block twice or freeing a pointer that did not
+//! come from the pool causes an assertion.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+MemPoolFree(tMemPool *psPool, void *pvBlock)
+{
+    volatile unsigned long *pulHeader;
+    unsigned long ulHead, ulIndex;
+
+    ASSERT(psPool != 0);
+    ASSERT(MemPoolContains(psPool, pvBlock));
+
+    //
+    // Find the header of the block, and check that the block is allocated.
+    //
+    ulIndex = (((unsigned char *)pvBlock - psPool->pucStorage) /
+               psPool->ulStride);
+    pulHeader = BlockHeader(psPool, ulIndex);
+    ASSERT((*pulHeader & MEMPOOL_STATE_M) == MEMPOOL_STATE_USED);
+
+#if MEMPOOL_GUARD_SIZE
+    //
+    // Check that nothing has been written beyond either end of the block.
+    //
+    if(!GuardsIntact(psPool, pulHeader))
+    {
+        AtomicAdd(&psPool->ulGuardErrors, 1);
+        ASSERT(0);
+    }
+#endif
+
+    //
+    // Count the block as free before it can be allocated again, so that the
+    // count never exceeds the number of blocks in the pool.
+    //
+    AtomicAdd(&psPool->ulInUse, -1);
+
+    //
+    // Push the block onto the head of the free list.  The link is written
+    // before the swap makes the block visible to other contexts.
+    //
+    do
+    {
+        ulHead = psPool->ulFreeHead;
+        *pulHeader = MEMPOOL_STATE_FREE | (ulHead & MEMPOOL_INDEX_M);
+    }
+    while(!AtomicCompareSwap(&psPool->ulFreeHead, ulHead,
+                             ((ulHead + MEMPOOL_TAG_INC) & MEMPOOL_TAG_M) |
+                             ulIndex));
+}
+
+//*****************************************************************************
+//
+//! Determines whether a pointer refers to a block of a pool.
+//!
+//! \param psPool points to the pool to check.
+//! \param pvBlock is the pointer to check.
+//!
+//! This function may be used to find which of several pools a block came
+//! from before freeing it.
+//!
+//! \return Returns \b true if \e pvBlock is the start of one of the blocks
+//! of the pool, whether or not it is currently allocated, and \b false
+//! otherwise.
+//
+//*****************************************************************************
+tBoolean
+MemPoolContains(tMemPool *psPool, void *pvBlock)
+{
+    unsigned long ulOffset;
+
+    ASSERT(psPool != 0);
+
+    if(((unsigned char *)pvBlock < psPool->pucStorage) ||
+       ((unsigned char *)pvBlock >=
+        (psPool->pucStorage + (psPool->ulStride * psPool->ulNumBlocks))))
+    {
+        return(false);
+    }
+
+    ulOffset = (unsigned char *)pvBlock - psPool->pucStorage;
+
+    return(((ulOffset % psPool->ulStride) ==
+            (sizeof(unsigned long) + MEMPOOL_GUARD_SIZE)) ? true : false);
+}
+
+//*****************************************************************************
+//
+//! Checks the guards of every allocated block of a pool.
+//!
+//! \param psPool points to the pool to check.
+//!
+//! This function may be called periodically from a task to find a damaged
+//! block before it is freed.  The guards are never written once the pool is
+//! initialized, so it is safe to call this while other contexts allocate and
+//! free blocks.  It takes time proportional to the size of the pool, so it
+//! should not be called from an interrupt handler.
+//!
+//! \return Returns the number of allocated blocks with a damaged guard.  This
+//! is always zero if the pool has no guards.
+//
+//*****************************************************************************
+unsigned long
+MemPoolCheck(tMemPool *psPool)
+{
+    unsigned long ulDamaged;
+#if MEMPOOL_GUARD_SIZE
+    volatile unsigned long *pulHeader;
+    unsigned long ulIndex;
+#endif
+
+    ASSERT(psPool != 0);
+
+    ulDamaged = 0;
+
+#if MEMPOOL_GUARD_SIZE
+    for(ulIndex = 0; ulIndex < psPool->ulNumBlocks; ulIndex++)
+    {
+        pulHeader = BlockHeader(psPool, ulIndex);
+        if(((*pulHeader & MEMPOOL_STATE_M) == MEMPOOL_STATE_USED) &&
+           !GuardsIntact(psPool, pulHeader))
+        {
+            ulDamaged++;
+        }
+    }
+#endif
+
+    return(ulDamaged);
+}
+
+//*****************************************************************************
+//
+//! Returns the usage counters of a pool.
+//!
+//! \param psPool points to the pool to query.
+//! \param psStats points to the structure that receives the counters.
+//!
+//! The counters are read one at a time, so if the pool is in use by another
+//! context they may not all describe exactly the same moment.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+MemPoolStatsGet(tMemPool *psPool, tMemPoolStats *psStats)
+{
+    ASSERT(psPool != 0);
+    ASSERT(psStats != 0);
+
+    psStats->ulBlockSize = psPool->ulBlockSize;
+    psStats->ulNumBlocks = psPool->ulNumBlocks;
+    psStats->ulInUse = psPool->ulInUse;
+    psStats->ulHighWater = psPool->ulHighWater;
+    psStats->ulAllocs = psPool->ulAllocs;
+    psStats->ulFailures = psPool->ulFailures;
+    psStats->ulGuardErrors = psPool->ulGuardErrors;
+}
+
+//*****************************************************************************
+//
+//! Resets the high-water mark of a pool.
+//!
+//! \param psPool points to the pool to reset.
+//!
+//! This function sets the high-water mark to the number of blocks currently
+//! in use, so that the peak usage of a particular phase of the application
+//! can be measured.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+MemPoolHighWaterReset(tMemPool *psPool)
+{
+    ASSERT(psPool != 0);
+
+    psPool->ulHighWater = psPool->ulInUse;
+}
+
+//*****************************************************************************
+//
+// Close the Doxygen group.
+//! @}
+//
+//*****************************************************************************
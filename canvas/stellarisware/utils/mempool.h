@@ -0,0 +1,236 @@
+//*****************************************************************************
+//
+// mempool.h - Prototypes for the fixed-size block pool allocator.
+//
+//*****************************************************************************
+
+#ifndef __MEMPOOL_H__
+#define __MEMPOOL_H__
+
+//*****************************************************************************
+//
+// If building with a C++ compiler, make all of the definitions in this header
+// have a C binding.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+//*****************************************************************************
+//
+//! \addtogroup mempool_api
+//! @{
+//
+//*****************************************************************************
+
+//*****************************************************************************
+//
+//! The number of guard bytes placed on each side of every block.  The guards
+//! are filled with a known pattern when the pool is initialized and checked
+//! whenever a block is freed, so that a write past either end of a block is
+//! caught.  This must be a multiple of four.  By default, guards are only
+//! used in DEBUG builds.
+//
+//*****************************************************************************
+#ifndef MEMPOOL_GUARD_SIZE
+#ifdef DEBUG
+#define MEMPOOL_GUARD_SIZE      4
+#else
+#define MEMPOOL_GUARD_SIZE      0
+#endif
+#endif
+
+//*****************************************************************************
+//
+//! The number of bytes of pool storage used by each block of
+//! \e ulBlockSize bytes, including its header and guards.
+//
+//*****************************************************************************
+#define MEMPOOL_BLOCK_STRIDE(ulBlockSize)                                     \
+        (sizeof(unsigned long) + (2 * MEMPOOL_GUARD_SIZE) +                   \
+         (((ulBlockSize) + 3) & ~3))
+
+//*****************************************************************************
+//
+//! The number of bytes of storage needed for a pool of \e ulNumBlocks blocks
+//! of \e ulBlockSize bytes each.
+//
+//*****************************************************************************
+#define MEMPOOL_STORAGE_SIZE(ulBlockSize, ulNumBlocks)                        \
+        (MEMPOOL_BLOCK_STRIDE(ulBlockSize) * (ulNumBlocks))
+
+//*****************************************************************************
+//
+//! Defines a pool named \e sName of \e ulNumBlocks blocks, each large enough
+//! to hold one \e tType, along with its storage.  The pool must be prepared
+//! by MEMPOOL_INIT() before it is used.  Prefix with \b static to make the
+//! pool private to a file.
+//
+//*****************************************************************************
+#define MEMPOOL_DEFINE(sName, tType, ulNumBlocks)                             \
+        unsigned long sName##Storage[(MEMPOOL_STORAGE_SIZE(sizeof(tType),     \
+                                                           ulNumBlocks) +     \
+                                      sizeof(unsigned long) - 1) /            \
+                                     sizeof(unsigned long)];                  \
+        tMemPool sName
+
+//*****************************************************************************
+//
+//! Initializes a pool defined by MEMPOOL_DEFINE().
+//
+//*****************************************************************************
+#define MEMPOOL_INIT(sName, tType, ulNumBlocks)                               \
+        MemPoolInit(&(sName), (sName##Storage), sizeof(sName##Storage),       \
+                    sizeof(tType), (ulNumBlocks))
+
+//*****************************************************************************
+//
+//! Allocates a block for one \e tType from the pool pointed to by \e psPool.
+//
+//*****************************************************************************
+#define MEMPOOL_ALLOC(psPool, tType)                                          \
+        ((tType *)MemPoolAlloc(psPool))
+
+//*****************************************************************************
+//
+//! The structure used for encapsulating all the items associated with a
+//! pool of fixed size blocks.  The members are private to the allocator;
+//! use MemPoolStatsGet() to read the counters.
+//
+//*****************************************************************************
+typedef struct
+{
+    //
+    //! The storage holding the blocks.
+    //
+    unsigned char *pucStorage;
+
+    //
+    //! The number of bytes from one block to the next in the storage.
+    //
+    unsigned long ulStride;
+
+    //
+    //! The number of bytes available to the application in each block.
+    //
+    unsigned long ulBlockSize;
+
+    //
+    //! The number of blocks in the pool.
+    //
+    unsigned long ulNumBlocks;
+
+    //
+    //! The index of the first free block in the lower 16 bits, and a count
+    //! of the changes made to the free list in the upper 16 bits.  The count
+    //! stops a context that is preempted part way through an allocation from
+    //! acting on a stale copy of the list.
+    //
+    volatile unsigned long ulFreeHead;
+
+    //
+    //! The number of blocks currently allocated.
+    //
+    volatile unsigned long ulInUse;
+
+    //
+    //! The largest number of blocks that have been allocated at once.
+    //
+    volatile unsigned long ulHighWater;
+
+    //
+    //! The number of successful allocations.
+    //
+    volatile unsigned long ulAllocs;
+
+    //
+    //! The number of allocations that failed because the pool was empty.
+    //
+    volatile unsigned long ulFailures;
+
+    //
+    //! The number of blocks found with a damaged guard.
+    //
+    volatile unsigned long ulGuardErrors;
+}
+tMemPool;
+
+//*****************************************************************************
+//
+//! The usage counters of a pool, as returned by MemPoolStatsGet().
+//
+//*****************************************************************************
+typedef struct
+{
+    //
+    //! The number of bytes available to the application in each block.
+    //
+    unsigned long ulBlockSize;
+
+    //
+    //! The number of blocks in the pool.
+    //
+    unsigned long ulNumBlocks;
+
+    //
+    //! The number of blocks currently allocated.
+    //
+    unsigned long ulInUse;
+
+    //
+    //! The largest number of blocks that have been allocated at once since
+    //! the pool was initialized or MemPoolHighWaterReset() was called.
+    //
+    unsigned long ulHighWater;
+
+    //
+    //! The number of successful allocations.
+    //
+    unsigned long ulAllocs;
+
+    //
+    //! The number of allocations that failed because the pool was empty.
+    //
+    unsigned long ulFailures;
+
+    //
+    //! The number of blocks found with a damaged guard.
+    //
+    unsigned long ulGuardErrors;
+}
+tMemPoolStats;
+
+//*****************************************************************************
+//
+// Close the Doxygen group.
+//! @}
+//
+//*****************************************************************************
+
+//*****************************************************************************
+//
+// API Function prototypes
+//
+//*****************************************************************************
+extern void MemPoolInit(tMemPool *psPool, void *pvStorage,
+                        unsigned long ulStorageSize, unsigned long ulBlockSize,
+                        unsigned long ulNumBlocks);
+extern void *MemPoolAlloc(tMemPool *psPool);
+extern void MemPoolFree(tMemPool *psPool, void *pvBlock);
+extern tBoolean MemPoolContains(tMemPool *psPool, void *pvBlock);
+extern unsigned long MemPoolCheck(tMemPool *psPool);
+extern void MemPoolStatsGet(tMemPool *psPool, tMemPoolStats *psStats);
+extern void MemPoolHighWaterReset(tMemPool *psPool);
+
+//*****************************************************************************
+//
+// Mark the end of the C bindings section for C++ compilers.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __MEMPOOL_H__
@@ -0,0 +1,477 @@
+//*****************************************************************************
+//
+// rpc.c - A binary command channel, for programs rather than people to
+//         control the application over a UART, USB or a radio link.
+//
+//*****************************************************************************
+
+#include "inc/hw_types.h"
+#include "driverlib/debug.h"
+#include "utils/crc.h"
+#include "utils/rpc.h"
+
+//*****************************************************************************
+//
+//! \addtogroup rpc_api
+//! @{
+//
+//*****************************************************************************
+
+//*****************************************************************************
+//
+// The sizes of the parts of a frame.  A frame is a sequence number and the
+// flags, then the requests or responses, then a CRC-16 of all that comes
+// before it, least significant byte first.  A request is a command
+// identifier, the length of the payload and the payload.  A response is the
+// command identifier, a status, the length of the payload and the payload.
+//
+//*****************************************************************************
+#define FRAME_HEADER_SIZE       2
+#define FRAME_CRC_SIZE          2
+#define REQUEST_HEADER_SIZE     2
+#define RESPONSE_HEADER_SIZE    3
+#define MAX_PAYLOAD             255
+
+//*****************************************************************************
+//
+// The number of encoded bytes collected before they are passed to the write
+// function.
+//
+//*****************************************************************************
+#define WRITE_CHUNK             32
+
+//*****************************************************************************
+//
+//! Initializes a command channel.
+//!
+//! \param psInst is the channel to initialize.
+//! \param psTable is the table of commands, indexed by command identifier.
+//! \param ulNumEntries is the number of entries in the table.
+//! \param pfnWrite is the function that sends frames.
+//! \param pvWriteData is a value passed to \e pfnWrite.
+//!
+//! This function prepares a channel that carries commands as frames of
+//! binary requests, for use alongside the text command line of
+//! utils/cmdline.c where a program rather than a person is in control.  A
+//! command is found by indexing the table with its identifier, its payload is
+//! passed to the handler as bytes, and any number of requests may be sent in
+//! one frame.  Frames are delimited as in SLIP and checked with a CRC-16, so
+//! the channel works over any byte stream, such as a UART, a USB bulk
+//! endpoint or a radio link.  tools/rpcbench contains a client library for
+//! Linux.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+RPCInit(tRPCInstance *psInst, const tRPCEntry *psTable,
+        unsigned long ulNumEntries, tRPCWrite pfnWrite, void *pvWriteData)
+{
+    ASSERT(psInst);
+    ASSERT(psTable || !ulNumEntries);
+    ASSERT(pfnWrite);
+
+    psInst->psTable = psTable;
+    psInst->ulNumEntries = ulNumEntries;
+    psInst->pfnWrite = pfnWrite;
+    psInst->pvWriteData = pvWriteData;
+    psInst->ulRxCount = 0;
+    psInst->bRxEscape = false;
+    psInst->bRxDiscard = false;
+    psInst->ulTxCount = 0;
+    psInst->bNoResponse = true;
+    psInst->ulFrames = 0;
+    psInst->ulErrors = 0;
+    psInst->ulCommands = 0;
+}
+
+//*****************************************************************************
+//
+// Adds the CRC to the response frame, and sends it with the given flags.
+//
+//*****************************************************************************
+static void
+RPCSend(tRPCInstance *psInst, unsigned char ucFlags)
+{
+    unsigned char pucChunk[WRITE_CHUNK], ucByte;
+    unsigned long ulIdx, ulCount;
+    unsigned short usCrc;
+
+    psInst->pucTxFrame[1] = ucFlags;
+    usCrc = Crc16(0, psInst->pucTxFrame, psInst->ulTxCount);
+    psInst->pucTxFrame[psInst->ulTxCount++] = usCrc & 0xff;
+    psInst->pucTxFrame[psInst->ulTxCount++] = usCrc >> 8;
+
+    //
+    // Send the frame between two RPC_END bytes, escaping any RPC_END or
+    // RPC_ESC in it.  The first RPC_END ends any noise that the receiver has
+    // collected since the last frame.
+    //
+    pucChunk[0] = RPC_END;
+    ulCount = 1;
+    for(ulIdx = 0; ulIdx < psInst->ulTxCount; ulIdx++)
+    {
+        if(ulCount > (WRITE_CHUNK - 2))
+        {
+            psInst->pfnWrite(psInst->pvWriteData, pucChunk, ulCount);
+            ulCount = 0;
+        }
+
+        ucByte = psInst->pucTxFrame[ulIdx];
+        if(ucByte == RPC_END)
+        {
+            pucChunk[ulCount++] = RPC_ESC;
+            pucChunk[ulCount++] = RPC_ESC_END;
+        }
+        else if(ucByte == RPC_ESC)
+        {
+            pucChunk[ulCount++] = RPC_ESC;
+            pucChunk[ulCount++] = RPC_ESC_ESC;
+        }
+        else
+        {
+            pucChunk[ulCount++] = ucByte;
+        }
+    }
+    pucChunk[ulCount++] = RPC_END;
+    psInst->pfnWrite(psInst->pvWriteData, pucChunk, ulCount);
+
+    //
+    // Start the next frame of responses to the same request.
+    //
+    psInst->ulTxCount = FRAME_HEADER_SIZE;
+}
+
+//*****************************************************************************
+//
+// Starts a response to the current command, first sending the frame if there
+// is no room in it for the response header and at least one byte.
+//
+//*****************************************************************************
+static void
+RPCResponseStart(tRPCInstance *psInst)
+{
+    if((psInst->ulTxCount + RESPONSE_HEADER_SIZE + 1 + FRAME_CRC_SIZE) >
+       RPC_MAX_FRAME)
+    {
+        RPCSend(psInst, RPC_FLAG_MORE);
+    }
+
+    psInst->ulTxResponse = psInst->ulTxCount;
+    psInst->pucTxFrame[psInst->ulTxCount++] = psInst->ucCmd;
+    psInst->ulTxCount += RESPONSE_HEADER_SIZE - 1;
+}
+
+//*****************************************************************************
+//
+// Fills in the status and length of the response being written.
+//
+//*****************************************************************************
+static void
+RPCResponseEnd(tRPCInstance *psInst, unsigned long ulStatus)
+{
+    psInst->pucTxFrame[psInst->ulTxResponse + 1] = (unsigned char)ulStatus;
+    psInst->pucTxFrame[psInst->ulTxResponse + 2] =
+        (unsigned char)(psInst->ulTxCount - psInst->ulTxResponse -
+                        RESPONSE_HEADER_SIZE);
+}
+
+//*****************************************************************************
+//
+//! Writes part of the response to a command.
+//!
+//! \param psInst is the channel that the command was received on.
+//! \param pvData is a pointer to the data to send.
+//! \param ulLen is the number of bytes to send.
+//!
+//! This function may only be called by a command handler, and may be called
+//! as many times as needed to send a response of any length.  The response
+//! is sent in parts of up to 255 bytes, each with the status
+//! RPC_STATUS_PARTIAL apart from the last, which carries the status returned
+//! by the handler.  When a frame fills it is sent, flagged with
+//! RPC_FLAG_MORE, so a long response streams out as it is written.  Nothing
+//! is sent if the request asked for no response.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+RPCResponseWrite(tRPCInstance *psInst, const void *pvData, unsigned long ulLen)
+{
+    const unsigned char *pucData;
+    unsigned long ulRoom, ulIdx;
+
+    ASSERT(psInst);
+    ASSERT(pvData || !ulLen);
+
+    if(psInst->bNoResponse)
+    {
+        return;
+    }
+
+    pucData = pvData;
+    while(ulLen)
+    {
+        //
+        // Find the room left in this part of the response.  If there is none,
+        // end the part and start another, in a new frame if need be.
+        //
+        ulRoom = RPC_MAX_FRAME - FRAME_CRC_SIZE - psInst->ulTxCount;
+        ulIdx = (MAX_PAYLOAD + RESPONSE_HEADER_SIZE + psInst->ulTxResponse -
+                 psInst->ulTxCount);
+        if(ulIdx < ulRoom)
+        {
+            ulRoom = ulIdx;
+        }
+        if(!ulRoom)
+        {
+            RPCResponseEnd(psInst, RPC_STATUS_PARTIAL);
+            RPCResponseStart(psInst);
+            continue;
+        }
+
+        if(ulRoom > ulLen)
+        {
+            ulRoom = ulLen;
+        }
+        for(ulIdx = 0; ulIdx < ulRoom; ulIdx++)
+        {
+            psInst->pucTxFrame[psInst->ulTxCount++] = pucData[ulIdx];
+        }
+        pucData += ulRoom;
+        ulLen -= ulRoom;
+    }
+}
+
+//*****************************************************************************
+//
+// Handles the requests in a frame that has been received, and sends the
+// responses.
+//
+//*****************************************************************************
+static void
+RPCProcessFrame(tRPCInstance *psInst)
+{
+    unsigned long ulOffset, ulEnd, ulLen, ulStatus;
+    const unsigned char *pucFrame;
+    const tRPCEntry *psEntry;
+
+    //
+    // Check the CRC, and discard the frame if it does not match.
+    //
+    pucFrame = psInst->pucRxFrame;
+    ulEnd = psInst->ulRxCount;
+    if((ulEnd < (FRAME_HEADER_SIZE + FRAME_CRC_SIZE)) ||
+       (Crc16(0, pucFrame, ulEnd - FRAME_CRC_SIZE) !=
+        (pucFrame[ulEnd - 2] | (pucFrame[ulEnd - 1] << 8))))
+    {
+        psInst->ulErrors++;
+        return;
+    }
+    psInst->ulFrames++;
+    ulEnd -= FRAME_CRC_SIZE;
+
+    //
+    // Start the response frame, which has the sequence number of the
+    // request.
+    //
+    psInst->bNoResponse = (pucFrame[1] & RPC_FLAG_NO_RESPONSE) ? true : false;
+    psInst->pucTxFrame[0] = pucFrame[0];
+    psInst->ulTxCount = FRAME_HEADER_SIZE;
+
+    //
+    // Handle each request in turn.
+    //
+    for(ulOffset = FRAME_HEADER_SIZE; ulOffset < ulEnd; ulOffset += ulLen)
+    {
+        psInst->ucCmd = pucFrame[ulOffset];
+        if(!psInst->bNoResponse)
+        {
+            RPCResponseStart(psInst);
+        }
+
+        //
+        // Stop at a request that runs past the end of the frame.
+        //
+        if((ulOffset + REQUEST_HEADER_SIZE) > ulEnd)
+        {
+            ulStatus = RPC_STATUS_BAD_LENGTH;
+            ulLen = 0;
+        }
+        else
+        {
+            ulLen = pucFrame[ulOffset + 1];
+            ulOffset += REQUEST_HEADER_SIZE;
+            if((ulOffset + ulLen) > ulEnd)
+            {
+                ulStatus = RPC_STATUS_BAD_LENGTH;
+            }
+            else if((psInst->ucCmd >= psInst->ulNumEntries) ||
+                    !psInst->psTable[psInst->ucCmd].pfnHandler)
+            {
+                ulStatus = RPC_STATUS_BAD_CMD;
+            }
+            else
+            {
+                psEntry = &psInst->psTable[psInst->ucCmd];
+                if((ulLen < psEntry->ucMinLen) || (ulLen > psEntry->ucMaxLen))
+                {
+                    ulStatus = RPC_STATUS_BAD_LENGTH;
+                }
+                else
+                {
+                    ulStatus = psEntry->pfnHandler(psInst,
+                                                   pucFrame + ulOffset,
+                                                   ulLen);
+                    psInst->ulCommands++;
+                }
+            }
+        }
+
+        if(!psInst->bNoResponse)
+        {
+            RPCResponseEnd(psInst, ulStatus);
+        }
+
+        if(ulStatus == RPC_STATUS_BAD_LENGTH)
+        {
+            break;
+        }
+    }
+
+    //
+    // Send the last frame of responses.  A frame with no requests is
+    // answered with an empty frame, which a client can use to wait for the
+    // requests before it to be handled.
+    //
+    if(!psInst->bNoResponse)
+    {
+        RPCSend(psInst, 0);
+    }
+    psInst->bNoResponse = true;
+}
+
+//*****************************************************************************
+//
+//! Passes received bytes to a command channel.
+//!
+//! \param psInst is the channel that the bytes were received on.
+//! \param pucData is a pointer to the bytes.
+//! \param ulCount is the number of bytes.
+//!
+//! This function collects bytes into frames, and handles the requests in
+//! each frame as it is completed, calling the write function of the channel
+//! to send the responses.  The bytes may be passed in pieces of any size,
+//! as they arrive.  Frames that are corrupt or longer than RPC_MAX_FRAME are
+//! discarded, with no response, and counted.
+//!
+//! The handlers are called from this function, so it should be called from
+//! the main loop or a task rather than from an interrupt handler.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+RPCReceive(tRPCInstance *psInst, const unsigned char *pucData,
+           unsigned long ulCount)
+{
+    unsigned char ucByte;
+
+    ASSERT(psInst);
+    ASSERT(pucData || !ulCount);
+
+    while(ulCount--)
+    {
+        ucByte = *pucData++;
+
+        //
+        // At the end of a frame, handle it unless it is to be discarded.
+        // Empty frames come from the RPC_END that starts each frame, and are
+        // ignored.
+        //
+        if(ucByte == RPC_END)
+        {
+            if(psInst->bRxDiscard || psInst->bRxEscape)
+            {
+                psInst->ulErrors++;
+            }
+            else if(psInst->ulRxCount)
+            {
+                RPCProcessFrame(psInst);
+            }
+            psInst->ulRxCount = 0;
+            psInst->bRxEscape = false;
+            psInst->bRxDiscard = false;
+            continue;
+        }
+
+        //
+        // Undo the escaping of RPC_END and RPC_ESC.  Anything else after an
+        // RPC_ESC is an error.
+        //
+        if(psInst->bRxEscape)
+        {
+            psInst->bRxEscape = false;
+            if(ucByte == RPC_ESC_END)
+            {
+                ucByte = RPC_END;
+            }
+            else if(ucByte == RPC_ESC_ESC)
+            {
+                ucByte = RPC_ESC;
+            }
+            else
+            {
+                psInst->bRxDiscard = true;
+            }
+        }
+        else if(ucByte == RPC_ESC)
+        {
+            psInst->bRxEscape = true;
+            continue;
+        }
+
+        //
+        // Store the byte, or discard the frame if it is too long.
+        //
+        if(psInst->ulRxCount < RPC_MAX_FRAME)
+        {
+            psInst->pucRxFrame[psInst->ulRxCount++] = ucByte;
+        }
+        else
+        {
+            psInst->bRxDiscard = true;
+        }
+    }
+}
+
+//*****************************************************************************
+//
+//! Handles a command by sending its payload back.
+//!
+//! \param psInst is the channel that the command was received on.
+//! \param pucData is a pointer to the payload of the command.
+//! \param ulLen is the length of the payload.
+//!
+//! This function is a command handler that may be placed in the command
+//! table.  By convention it is given the identifier RPC_CMD_ECHO, so that
+//! the link to any device can be checked and measured with tools/rpcbench.
+//!
+//! \return Returns RPC_STATUS_OK.
+//
+//*****************************************************************************
+unsigned long
+RPCEcho(tRPCInstance *psInst, const unsigned char *pucData,
+        unsigned long ulLen)
+{
+    RPCResponseWrite(psInst, pucData, ulLen);
+
+    return(RPC_STATUS_OK);
+}
+
+//*****************************************************************************
+//
+// Close the Doxygen group.
+//! @}
+//
+//*****************************************************************************
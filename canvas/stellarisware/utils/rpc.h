@@ -0,0 +1,217 @@
+//*****************************************************************************
+//
+// rpc.h - Prototypes for the binary command channel.
+//
+//*****************************************************************************
+
+#ifndef __RPC_H__
+#define __RPC_H__
+
+//*****************************************************************************
+//
+// If building with a C++ compiler, make all of the definitions in this header
+// have a C binding.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+//*****************************************************************************
+//
+//! \addtogroup rpc_api
+//! @{
+//
+//*****************************************************************************
+
+//*****************************************************************************
+//
+//! The largest frame that can be received or sent, in bytes, not counting
+//! the framing bytes that are added on the wire.  A frame holds a two byte
+//! header and a two byte CRC, so this must be at least 261 for a request
+//! with the largest payload of 255 bytes to be accepted.  It may be defined
+//! for the build to trade RAM for larger batches.
+//
+//*****************************************************************************
+#ifndef RPC_MAX_FRAME
+#define RPC_MAX_FRAME           264
+#endif
+
+//*****************************************************************************
+//
+//! The bytes that delimit and escape frames on the wire, as in SLIP (RFC
+//! 1055).  A frame is sent as an RPC_END, the frame with any RPC_END or
+//! RPC_ESC byte replaced by RPC_ESC followed by RPC_ESC_END or RPC_ESC_ESC,
+//! and another RPC_END.
+//
+//*****************************************************************************
+#define RPC_END                 0xC0
+#define RPC_ESC                 0xDB
+#define RPC_ESC_END             0xDC
+#define RPC_ESC_ESC             0xDD
+
+//*****************************************************************************
+//
+//! Flags in the second byte of a frame.  In a request, RPC_FLAG_NO_RESPONSE
+//! asks for no response frame to be sent, so that a stream of updates can be
+//! sent without waiting.  In a response, RPC_FLAG_MORE marks a frame that is
+//! followed by more responses to the same request.
+//
+//*****************************************************************************
+#define RPC_FLAG_NO_RESPONSE    0x01
+#define RPC_FLAG_MORE           0x02
+
+//*****************************************************************************
+//
+//! The status returned in a response.  Handlers return RPC_STATUS_OK or a
+//! status of their own below RPC_STATUS_BAD_CMD.  RPC_STATUS_PARTIAL marks a
+//! part of a response that is continued by the next response to the same
+//! command.
+//
+//*****************************************************************************
+#define RPC_STATUS_OK           0x00
+#define RPC_STATUS_BAD_CMD      0xFC
+#define RPC_STATUS_BAD_LENGTH   0xFD
+#define RPC_STATUS_PARTIAL      0xFF
+
+//*****************************************************************************
+//
+//! The command identifier that, by convention, is handled by RPCEcho(), so
+//! that any device can be tested and measured by the same host tools.
+//
+//*****************************************************************************
+#define RPC_CMD_ECHO            0
+
+//*****************************************************************************
+//
+// The instance type is used before it is defined by the handler type.
+//
+//*****************************************************************************
+typedef struct tRPCInstance tRPCInstance;
+
+//*****************************************************************************
+//
+//! The function that handles a command.  It is given the payload of the
+//! request, may send a response of any length with RPCResponseWrite(), and
+//! returns the status to send with it.
+//
+//*****************************************************************************
+typedef unsigned long (*tRPCHandler)(tRPCInstance *psInst,
+                                     const unsigned char *pucData,
+                                     unsigned long ulLen);
+
+//*****************************************************************************
+//
+//! The function used to send frames, which is given the encoded bytes a piece
+//! at a time.
+//
+//*****************************************************************************
+typedef void (*tRPCWrite)(void *pvInstance, const unsigned char *pucData,
+                          unsigned long ulSize);
+
+//*****************************************************************************
+//
+//! An entry in the command table.  The command identifier is the index of the
+//! entry in the table, so that a command is found without searching.
+//
+//*****************************************************************************
+typedef struct
+{
+    //
+    //! The function that handles the command, or NULL if there is no command
+    //! with this identifier.
+    //
+    tRPCHandler pfnHandler;
+
+    //
+    //! The shortest and longest payloads that the command accepts.  Others
+    //! are answered with RPC_STATUS_BAD_LENGTH without calling the handler.
+    //
+    unsigned char ucMinLen;
+    unsigned char ucMaxLen;
+}
+tRPCEntry;
+
+//*****************************************************************************
+//
+//! The state of a command channel.  The members are private to utils/rpc.c,
+//! apart from the counts, which the application may read.
+//
+//*****************************************************************************
+struct tRPCInstance
+{
+    //
+    // The command table and the number of entries in it.
+    //
+    const tRPCEntry *psTable;
+    unsigned long ulNumEntries;
+
+    //
+    // The function that sends frames, and the value passed to it.
+    //
+    tRPCWrite pfnWrite;
+    void *pvWriteData;
+
+    //
+    // The frame being received, the number of bytes in it, and whether the
+    // last byte was RPC_ESC or the frame is to be discarded.
+    //
+    unsigned char pucRxFrame[RPC_MAX_FRAME];
+    unsigned long ulRxCount;
+    tBoolean bRxEscape;
+    tBoolean bRxDiscard;
+
+    //
+    // The response frame being built, the number of bytes in it, and where
+    // the header of the response being written starts.  No response is
+    // built if the request asked for none.
+    //
+    unsigned char pucTxFrame[RPC_MAX_FRAME];
+    unsigned long ulTxCount;
+    unsigned long ulTxResponse;
+    unsigned char ucCmd;
+    tBoolean bNoResponse;
+
+    //
+    //! The number of frames received intact, the number discarded because
+    //! they were corrupt or too long, and the number of commands handled.
+    //
+    unsigned long ulFrames;
+    unsigned long ulErrors;
+    unsigned long ulCommands;
+};
+
+//*****************************************************************************
+//
+// Close the Doxygen group.
+//! @}
+//
+//*****************************************************************************
+
+//*****************************************************************************
+//
+// Prototypes for the APIs.
+//
+//*****************************************************************************
+extern void RPCInit(tRPCInstance *psInst, const tRPCEntry *psTable,
+                    unsigned long ulNumEntries, tRPCWrite pfnWrite,
+                    void *pvWriteData);
+extern void RPCReceive(tRPCInstance *psInst, const unsigned char *pucData,
+                       unsigned long ulCount);
+extern void RPCResponseWrite(tRPCInstance *psInst, const void *pvData,
+                             unsigned long ulLen);
+extern unsigned long RPCEcho(tRPCInstance *psInst,
+                             const unsigned char *pucData,
+                             unsigned long ulLen);
+
+//*****************************************************************************
+//
+// Mark the end of the C bindings section for C++ compilers.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __RPC_H__
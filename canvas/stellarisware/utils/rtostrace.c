@@ -0,0 +1,662 @@
+//*****************************************************************************
+//
+// rtostrace.c - Binary trace recorder for FreeRTOS kernel events.
+//
+//*****************************************************************************
+
+#include "inc/hw_nvic.h"
+#include "inc/hw_types.h"
+#include "driverlib/cpu.h"
+#include "driverlib/debug.h"
+#include "driverlib/uart.h"
+#include "FreeRTOS.h"
+#include "queue.h"
+#include "utils/rtostrace.h"
+
+//*****************************************************************************
+//
+//! \addtogroup rtostrace_api
+//! @{
+//
+//*****************************************************************************
+
+//*****************************************************************************
+//
+// The Cortex-M data watchpoint and trace unit registers used to timestamp
+// events, and the trace enable bit of the debug exception and monitor control
+// register (NVIC_DBG_INT), none of which are provided by inc/hw_nvic.h.
+//
+//*****************************************************************************
+#define DWT_CTRL                0xE0001000  // DWT Control
+#define DWT_CYCCNT              0xE0001004  // DWT Cycle Count
+#define DWT_CTRL_CYCCNTENA      0x00000001  // Enable the cycle counter
+#define NVIC_DBG_INT_TRCENA     0x01000000  // Enable the DWT and ITM
+
+//*****************************************************************************
+//
+// The name of a task or queue, as it is written to the trace dump.
+//
+//*****************************************************************************
+typedef struct
+{
+    unsigned char ucNumber;
+    unsigned char ucInfo;
+    char pcName[RTOSTRACE_NAME_LEN];
+}
+tRTOSTraceName;
+
+//*****************************************************************************
+//
+// The header at the start of a trace dump.  All of the values are little
+// endian; the task names, the queue names and then the records follow it.
+//
+//*****************************************************************************
+typedef struct
+{
+    unsigned long ulMagic;
+    unsigned short usVersion;
+    unsigned short usRecordSize;
+    unsigned long ulClockRate;
+    unsigned long ulTickRate;
+    unsigned long ulNumRecords;
+    unsigned long ulLost;
+    unsigned short usNumTasks;
+    unsigned short usNumQueues;
+    unsigned short usNameSize;
+    unsigned short usReserved;
+}
+tRTOSTraceHeader;
+
+//*****************************************************************************
+//
+// The state of the trace recorder.  The record buffer holds a power of two
+// number of records so that the write index wraps with a mask.
+//
+//*****************************************************************************
+static tRTOSTraceRecord *g_psRTOSTraceRecords;
+static unsigned long g_ulRTOSTraceMask;
+static unsigned long g_ulRTOSTraceWrite;
+static unsigned long g_ulRTOSTraceCount;
+static unsigned long g_ulRTOSTraceLost;
+static unsigned long g_ulRTOSTraceClock;
+static unsigned long g_ulRTOSTraceFlags;
+static volatile tBoolean g_bRTOSTraceRunning;
+
+//*****************************************************************************
+//
+// The names of the tasks and queues, kept apart from the records so that
+// they survive the records that created them being overwritten.
+//
+//*****************************************************************************
+static tRTOSTraceName g_psRTOSTraceTasks[RTOSTRACE_MAX_TASKS];
+static unsigned long g_ulRTOSTraceNumTasks;
+static tRTOSTraceName g_psRTOSTraceQueues[RTOSTRACE_MAX_QUEUES];
+static unsigned long g_ulRTOSTraceNumQueues;
+static unsigned long g_ulRTOSTraceNextQueue;
+
+//*****************************************************************************
+//
+// The state used to extend the cycle counter for the run-time statistics.
+//
+//*****************************************************************************
+static unsigned long g_ulRTOSTraceLastCycles;
+static unsigned long g_ulRTOSTraceHighCycles;
+
+//*****************************************************************************
+//
+// This function is not prototyped in queue.h, but is provided by queue.c when
+// configUSE_TRACE_FACILITY is 1.
+//
+//*****************************************************************************
+extern unsigned char ucQueueGetQueueNumber(xQueueHandle pxQueue);
+
+//*****************************************************************************
+//
+// Copies a name into a name table entry, padding it with zeros.
+//
+//*****************************************************************************
+static void
+RTOSTraceNameCopy(tRTOSTraceName *psName, const char *pcName)
+{
+    unsigned long ulIdx;
+
+    for(ulIdx = 0; ulIdx < RTOSTRACE_NAME_LEN; ulIdx++)
+    {
+        psName->pcName[ulIdx] = *pcName;
+        if(*pcName)
+        {
+            pcName++;
+        }
+    }
+}
+
+//*****************************************************************************
+//
+//! Enables the processor cycle counter.
+//!
+//! This function turns on the DWT cycle counter that is used to timestamp
+//! trace records.  It is called by RTOSTraceInit(), and by the kernel to start
+//! the run-time statistics counter if configGENERATE_RUN_TIME_STATS is 1.
+//!
+//! The cycle counter does not count while the processor is sleeping.  The
+//! tick count is recorded when the idle task enters and leaves low power
+//! idle, so that the decoder can account for the time spent asleep.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+RTOSTraceTimerInit(void)
+{
+    HWREG(NVIC_DBG_INT) |= NVIC_DBG_INT_TRCENA;
+    HWREG(DWT_CTRL) |= DWT_CTRL_CYCCNTENA;
+}
+
+//*****************************************************************************
+//
+//! Returns the run-time statistics counter.
+//!
+//! This function returns the cycle counter divided by
+//! 2^RTOSTRACE_RUNTIME_SHIFT, extended so that it does not wrap when the
+//! 32-bit cycle counter does.  The kernel reads it at every context switch,
+//! which is often enough for every wrap of the cycle counter to be seen.
+//!
+//! \return Returns the current run-time statistics count.
+//
+//*****************************************************************************
+unsigned long
+RTOSTraceRunTimeCounter(void)
+{
+    unsigned long ulPrimask, ulCycles, ulCount;
+
+    ulPrimask = CPUcpsid();
+
+    ulCycles = HWREG(DWT_CYCCNT);
+    if(ulCycles < g_ulRTOSTraceLastCycles)
+    {
+        g_ulRTOSTraceHighCycles++;
+    }
+    g_ulRTOSTraceLastCycles = ulCycles;
+
+    ulCount = ((g_ulRTOSTraceHighCycles << (32 - RTOSTRACE_RUNTIME_SHIFT)) |
+               (ulCycles >> RTOSTRACE_RUNTIME_SHIFT));
+
+    if(!ulPrimask)
+    {
+        CPUcpsie();
+    }
+
+    return(ulCount);
+}
+
+//*****************************************************************************
+//
+//! Initializes the trace recorder.
+//!
+//! \param pvBuffer is a pointer to the memory used to hold trace records.
+//! \param ulSize is the size of the buffer in bytes.
+//! \param ulClockRate is the processor clock rate, in Hz.
+//! \param ulFlags is the logical OR of any of \b RTOSTRACE_FLAG_ONESHOT,
+//! \b RTOSTRACE_FLAG_TICKS and \b RTOSTRACE_FLAG_START.
+//!
+//! This function prepares the recorder to use the given buffer.  The number
+//! of records the buffer holds is rounded down to a power of two, each record
+//! being eight bytes.  By default the oldest records are overwritten once the
+//! buffer is full; with \b RTOSTRACE_FLAG_ONESHOT recording stops instead.
+//! Kernel ticks are only recorded if \b RTOSTRACE_FLAG_TICKS is given.
+//! Recording begins when RTOSTraceStart() is called, or immediately if
+//! \b RTOSTRACE_FLAG_START is given.
+//!
+//! This must be called before any tasks or queues are created, so that their
+//! names and numbers are known.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+RTOSTraceInit(void *pvBuffer, unsigned long ulSize, unsigned long ulClockRate,
+              unsigned long ulFlags)
+{
+    unsigned long ulRecords;
+
+    ASSERT(pvBuffer && !((unsigned long)pvBuffer & 3));
+    ASSERT(ulSize >= (2 * sizeof(tRTOSTraceRecord)));
+
+    //
+    // Find the largest power of two number of records that fits.
+    //
+    ulRecords = ulSize / sizeof(tRTOSTraceRecord);
+    while(ulRecords & (ulRecords - 1))
+    {
+        ulRecords &= ulRecords - 1;
+    }
+
+    g_bRTOSTraceRunning = false;
+    g_psRTOSTraceRecords = pvBuffer;
+    g_ulRTOSTraceMask = ulRecords - 1;
+    g_ulRTOSTraceClock = ulClockRate;
+    g_ulRTOSTraceFlags = ulFlags;
+    g_ulRTOSTraceNumTasks = 0;
+    g_ulRTOSTraceNumQueues = 0;
+    g_ulRTOSTraceNextQueue = 0;
+    RTOSTraceClear();
+
+    RTOSTraceTimerInit();
+
+    if(ulFlags & RTOSTRACE_FLAG_START)
+    {
+        g_bRTOSTraceRunning = true;
+    }
+}
+
+//*****************************************************************************
+//
+//! Starts recording events.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+RTOSTraceStart(void)
+{
+    g_bRTOSTraceRunning = true;
+}
+
+//*****************************************************************************
+//
+//! Stops recording events.
+//!
+//! The records already made are kept until RTOSTraceClear() is called.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+RTOSTraceStop(void)
+{
+    g_bRTOSTraceRunning = false;
+}
+
+//*****************************************************************************
+//
+//! Discards all of the recorded events.
+//!
+//! The task and queue names are kept.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+RTOSTraceClear(void)
+{
+    unsigned long ulPrimask;
+
+    ulPrimask = CPUcpsid();
+
+    g_ulRTOSTraceWrite = 0;
+    g_ulRTOSTraceCount = 0;
+    g_ulRTOSTraceLost = 0;
+
+    if(!ulPrimask)
+    {
+        CPUcpsie();
+    }
+}
+
+//*****************************************************************************
+//
+//! Returns the number of events held in the trace buffer.
+//!
+//! \return Returns the number of records that a dump would contain.
+//
+//*****************************************************************************
+unsigned long
+RTOSTraceCount(void)
+{
+    return(g_ulRTOSTraceCount);
+}
+
+//*****************************************************************************
+//
+//! Records an event.
+//!
+//! \param ucEvent is the event, one of the \b RTOSTRACE_* event values.
+//! \param ucObject is the task, queue or channel the event applies to.
+//! \param usParam is the event-specific value.
+//!
+//! This function is called by the kernel trace hooks, and may be called from
+//! any task or interrupt, including interrupts above
+//! configMAX_SYSCALL_INTERRUPT_PRIORITY.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+RTOSTraceRecord(unsigned char ucEvent, unsigned char ucObject,
+                unsigned short usParam)
+{
+    unsigned long ulPrimask;
+    tRTOSTraceRecord *psRecord;
+
+    if(!g_bRTOSTraceRunning)
+    {
+        return;
+    }
+
+    ulPrimask = CPUcpsid();
+
+    //
+    // See if the buffer is full.
+    //
+    if(g_ulRTOSTraceCount > g_ulRTOSTraceMask)
+    {
+        g_ulRTOSTraceLost++;
+        if(g_ulRTOSTraceFlags & RTOSTRACE_FLAG_ONESHOT)
+        {
+            g_bRTOSTraceRunning = false;
+            if(!ulPrimask)
+            {
+                CPUcpsie();
+            }
+            return;
+        }
+    }
+    else
+    {
+        g_ulRTOSTraceCount++;
+    }
+
+    psRecord = &g_psRTOSTraceRecords[g_ulRTOSTraceWrite];
+    g_ulRTOSTraceWrite = (g_ulRTOSTraceWrite + 1) & g_ulRTOSTraceMask;
+
+    psRecord->ulTimestamp = HWREG(DWT_CYCCNT);
+    psRecord->ucEvent = ucEvent;
+    psRecord->ucObject = ucObject;
+    psRecord->usParam = usParam;
+
+    if(!ulPrimask)
+    {
+        CPUcpsie();
+    }
+}
+
+//*****************************************************************************
+//
+//! Records a kernel tick.
+//!
+//! \param usTick is the low 16 bits of the tick count.
+//!
+//! This function is called by the kernel from the tick interrupt.  The tick
+//! is only recorded if \b RTOSTRACE_FLAG_TICKS was passed to RTOSTraceInit().
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+RTOSTraceTick(unsigned short usTick)
+{
+    if(g_ulRTOSTraceFlags & RTOSTRACE_FLAG_TICKS)
+    {
+        RTOSTraceRecord(RTOSTRACE_TICK, 0, usTick);
+    }
+}
+
+//*****************************************************************************
+//
+//! Records an application event.
+//!
+//! \param ucChannel is a number chosen by the application to identify the
+//! kind of event.
+//! \param usValue is a value associated with the event.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+RTOSTraceUser(unsigned char ucChannel, unsigned short usValue)
+{
+    RTOSTraceRecord(RTOSTRACE_USER, ucChannel, usValue);
+}
+
+//*****************************************************************************
+//
+//! Records entry to an interrupt handler.
+//!
+//! This function should be called at the start of each interrupt handler
+//! that is to appear in the trace.  The active vector number is read from the
+//! NVIC, so the same call is used in every handler.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+RTOSTraceISREnter(void)
+{
+    RTOSTraceRecord(RTOSTRACE_ISR_ENTER, 0,
+                    HWREG(NVIC_INT_CTRL) & NVIC_INT_CTRL_VEC_ACT_M);
+}
+
+//*****************************************************************************
+//
+//! Records exit from an interrupt handler.
+//!
+//! This function should be called at the end of each interrupt handler that
+//! calls RTOSTraceISREnter().
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+RTOSTraceISRExit(void)
+{
+    RTOSTraceRecord(RTOSTRACE_ISR_EXIT, 0,
+                    HWREG(NVIC_INT_CTRL) & NVIC_INT_CTRL_VEC_ACT_M);
+}
+
+//*****************************************************************************
+//
+//! Records the creation of a task.
+//!
+//! \param ucTask is the number of the task.
+//! \param ucPriority is the priority of the task.
+//! \param pcName is the name of the task.
+//!
+//! This function is called by the kernel when a task is created.  The name
+//! is kept for the dump even if recording is stopped.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+RTOSTraceTaskCreate(unsigned char ucTask, unsigned char ucPriority,
+                    const signed char *pcName)
+{
+    tRTOSTraceName *psName;
+
+    if(g_ulRTOSTraceNumTasks < RTOSTRACE_MAX_TASKS)
+    {
+        psName = &g_psRTOSTraceTasks[g_ulRTOSTraceNumTasks++];
+        psName->ucNumber = ucTask;
+        psName->ucInfo = ucPriority;
+        RTOSTraceNameCopy(psName, (const char *)pcName);
+    }
+
+    RTOSTraceRecord(RTOSTRACE_TASK_CREATE, ucTask, ucPriority);
+}
+
+//*****************************************************************************
+//
+//! Records the creation of a queue.
+//!
+//! \param ucType is the queue type, one of the \b queueQUEUE_TYPE_* values.
+//!
+//! This function is called by the kernel when a queue, semaphore or mutex is
+//! created, and assigns it a number.
+//!
+//! \return Returns the number assigned to the queue.
+//
+//*****************************************************************************
+unsigned char
+RTOSTraceQueueCreate(unsigned char ucType)
+{
+    unsigned char ucQueue;
+
+    ucQueue = (unsigned char)g_ulRTOSTraceNextQueue++;
+
+    RTOSTraceRecord(RTOSTRACE_QUEUE_CREATE, ucQueue, ucType);
+
+    return(ucQueue);
+}
+
+//*****************************************************************************
+//
+//! Names a queue for the trace dump.
+//!
+//! \param pvQueue is the handle of the queue, semaphore or mutex.
+//! \param pcName is the name to give it.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+RTOSTraceQueueName(void *pvQueue, const char *pcName)
+{
+    unsigned long ulIdx;
+    unsigned char ucQueue;
+
+    ucQueue = ucQueueGetQueueNumber((xQueueHandle)pvQueue);
+
+    //
+    // Rename the queue if it already has a name.
+    //
+    for(ulIdx = 0; ulIdx < g_ulRTOSTraceNumQueues; ulIdx++)
+    {
+        if(g_psRTOSTraceQueues[ulIdx].ucNumber == ucQueue)
+        {
+            break;
+        }
+    }
+
+    if(ulIdx == RTOSTRACE_MAX_QUEUES)
+    {
+        return;
+    }
+    if(ulIdx == g_ulRTOSTraceNumQueues)
+    {
+        g_ulRTOSTraceNumQueues++;
+    }
+
+    g_psRTOSTraceQueues[ulIdx].ucNumber = ucQueue;
+    g_psRTOSTraceQueues[ulIdx].ucInfo = 0;
+    RTOSTraceNameCopy(&g_psRTOSTraceQueues[ulIdx], pcName);
+}
+
+//*****************************************************************************
+//
+//! Writes the recorded events.
+//!
+//! \param pfnWrite is the function called to write each part of the dump.
+//! \param pvInstance is passed to \e pfnWrite.
+//!
+//! This function stops recording and writes a header, the task and queue
+//! names and then the records, oldest first.  The records are left in the
+//! buffer; call RTOSTraceClear() and RTOSTraceStart() to begin a new trace.
+//! The dump is decoded on the host by tools/tracedecode, which searches its
+//! input for the start of the dump, so the dump can share a channel with
+//! other output.
+//!
+//! \e pfnWrite may be called many times; a USB device, for example, can pass
+//! a function that places the data in its transmit buffer.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+RTOSTraceDump(tRTOSTraceWrite pfnWrite, void *pvInstance)
+{
+    tRTOSTraceHeader sHeader;
+    unsigned long ulFirst, ulCount;
+
+    ASSERT(pfnWrite);
+
+    RTOSTraceStop();
+
+    sHeader.ulMagic = RTOSTRACE_MAGIC;
+    sHeader.usVersion = RTOSTRACE_VERSION;
+    sHeader.usRecordSize = sizeof(tRTOSTraceRecord);
+    sHeader.ulClockRate = g_ulRTOSTraceClock;
+    sHeader.ulTickRate = configTICK_RATE_HZ;
+    sHeader.ulNumRecords = g_ulRTOSTraceCount;
+    sHeader.ulLost = g_ulRTOSTraceLost;
+    sHeader.usNumTasks = (unsigned short)g_ulRTOSTraceNumTasks;
+    sHeader.usNumQueues = (unsigned short)g_ulRTOSTraceNumQueues;
+    sHeader.usNameSize = sizeof(tRTOSTraceName);
+    sHeader.usReserved = 0;
+    pfnWrite(pvInstance, (const unsigned char *)&sHeader, sizeof(sHeader));
+
+    pfnWrite(pvInstance, (const unsigned char *)g_psRTOSTraceTasks,
+             g_ulRTOSTraceNumTasks * sizeof(tRTOSTraceName));
+    pfnWrite(pvInstance, (const unsigned char *)g_psRTOSTraceQueues,
+             g_ulRTOSTraceNumQueues * sizeof(tRTOSTraceName));
+
+    //
+    // Once the buffer has filled, the oldest record is the next one to be
+    // overwritten.  Write from there to the end of the buffer, then from the
+    // start of the buffer.
+    //
+    ulCount = g_ulRTOSTraceCount;
+    ulFirst = (ulCount > g_ulRTOSTraceMask) ? g_ulRTOSTraceWrite : 0;
+    if((ulFirst + ulCount) > (g_ulRTOSTraceMask + 1))
+    {
+        pfnWrite(pvInstance,
+                 (const unsigned char *)&g_psRTOSTraceRecords[ulFirst],
+                 (g_ulRTOSTraceMask + 1 - ulFirst) * sizeof(tRTOSTraceRecord));
+        ulCount -= g_ulRTOSTraceMask + 1 - ulFirst;
+        ulFirst = 0;
+    }
+    pfnWrite(pvInstance, (const unsigned char *)&g_psRTOSTraceRecords[ulFirst],
+             ulCount * sizeof(tRTOSTraceRecord));
+}
+
+//*****************************************************************************
+//
+// Writes part of a trace dump to a UART, waiting for space in its FIFO.
+//
+//*****************************************************************************
+static void
+RTOSTraceUARTWrite(void *pvInstance, const unsigned char *pucData,
+                   unsigned long ulSize)
+{
+    while(ulSize--)
+    {
+        UARTCharPut((unsigned long)pvInstance, *pucData++);
+    }
+}
+
+//*****************************************************************************
+//
+//! Writes the recorded events to a UART.
+//!
+//! \param ulBase is the base address of the UART, which must already be
+//! configured.
+//!
+//! This function calls RTOSTraceDump() to write the trace to a UART, waiting
+//! for each byte to be accepted.  The dump can be captured on the host with,
+//! for example, "cat /dev/ttyACM0 > trace.bin" and decoded by
+//! tools/tracedecode.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+RTOSTraceDumpUART(unsigned long ulBase)
+{
+    RTOSTraceDump(RTOSTraceUARTWrite, (void *)ulBase);
+}
+
+//*****************************************************************************
+//
+// Close the Doxygen group.
+//! @}
+//
+//*****************************************************************************
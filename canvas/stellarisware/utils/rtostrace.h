@@ -0,0 +1,346 @@
+//*****************************************************************************
+//
+// rtostrace.h - Prototypes and kernel hooks for the FreeRTOS trace recorder.
+//
+//*****************************************************************************
+
+#ifndef __RTOSTRACE_H__
+#define __RTOSTRACE_H__
+
+//*****************************************************************************
+//
+// If building with a C++ compiler, make all of the definitions in this header
+// have a C binding.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+//*****************************************************************************
+//
+//! \addtogroup rtostrace_api
+//! @{
+//
+//*****************************************************************************
+
+//*****************************************************************************
+//
+//! The number of tasks whose names are remembered for the trace dump.  Tasks
+//! created after this many have their events recorded but appear by number
+//! only.
+//
+//*****************************************************************************
+#ifndef RTOSTRACE_MAX_TASKS
+#define RTOSTRACE_MAX_TASKS     16
+#endif
+
+//*****************************************************************************
+//
+//! The number of queues, semaphores and mutexes that can be given a name with
+//! RTOSTraceQueueName().
+//
+//*****************************************************************************
+#ifndef RTOSTRACE_MAX_QUEUES
+#define RTOSTRACE_MAX_QUEUES    8
+#endif
+
+//*****************************************************************************
+//
+//! The number of characters of each task or queue name kept for the dump.
+//
+//*****************************************************************************
+#ifndef RTOSTRACE_NAME_LEN
+#define RTOSTRACE_NAME_LEN      12
+#endif
+
+//*****************************************************************************
+//
+//! The number of bits the cycle counter is shifted right by to give the
+//! run-time statistics counter.  The default gives a counter that increments
+//! every 64 processor clocks.
+//
+//*****************************************************************************
+#ifndef RTOSTRACE_RUNTIME_SHIFT
+#define RTOSTRACE_RUNTIME_SHIFT 6
+#endif
+
+//*****************************************************************************
+//
+// Values that can be passed to RTOSTraceInit() as the ulFlags parameter.
+//
+//*****************************************************************************
+#define RTOSTRACE_FLAG_RING     0x00000000  // Overwrite the oldest records
+#define RTOSTRACE_FLAG_ONESHOT  0x00000001  // Stop when the buffer is full
+#define RTOSTRACE_FLAG_TICKS    0x00000002  // Record every kernel tick
+#define RTOSTRACE_FLAG_START    0x00000004  // Start recording immediately
+
+//*****************************************************************************
+//
+// The events held in the ucEvent field of a trace record.  The ucObject and
+// usParam fields of each event are noted alongside it.
+//
+//*****************************************************************************
+#define RTOSTRACE_TASK_SWITCH   0x01        // Task, 0
+#define RTOSTRACE_TASK_READY    0x02        // Task, 0
+#define RTOSTRACE_TASK_CREATE   0x03        // Task, priority
+#define RTOSTRACE_TASK_DELETE   0x04        // Task, 0
+#define RTOSTRACE_TASK_DELAY    0x05        // Task, 0
+#define RTOSTRACE_TASK_SUSPEND  0x06        // Task, 0
+#define RTOSTRACE_TASK_RESUME   0x07        // Task, 0
+#define RTOSTRACE_TASK_PRIORITY 0x08        // Task, new priority
+#define RTOSTRACE_TICK          0x09        // 0, tick count
+#define RTOSTRACE_QUEUE_CREATE  0x10        // Queue, queue type
+#define RTOSTRACE_QUEUE_SEND    0x11        // Queue, 0
+#define RTOSTRACE_QUEUE_RECEIVE 0x12        // Queue, 0
+#define RTOSTRACE_QUEUE_PEEK    0x13        // Queue, 0
+#define RTOSTRACE_QUEUE_FAILED  0x14        // Queue, send or receive event
+#define RTOSTRACE_QUEUE_BLOCK   0x15        // Queue, send or receive event
+#define RTOSTRACE_QUEUE_DELETE  0x16        // Queue, 0
+#define RTOSTRACE_NOTIFY        0x20        // Task notified, 0
+#define RTOSTRACE_NOTIFY_BLOCK  0x21        // Task, 0
+#define RTOSTRACE_NOTIFY_TAKE   0x22        // Task, 0
+#define RTOSTRACE_ISR_ENTER     0x30        // 0, vector number
+#define RTOSTRACE_ISR_EXIT      0x31        // 0, vector number
+#define RTOSTRACE_IDLE_SLEEP    0x38        // 0, tick count
+#define RTOSTRACE_IDLE_WAKE     0x39        // 0, tick count
+#define RTOSTRACE_USER          0x40        // Channel, value
+#define RTOSTRACE_FROM_ISR      0x80        // Added to queue and notify events
+
+//*****************************************************************************
+//
+//! The format of each record in the trace buffer.  The timestamp is the value
+//! of the Cortex-M DWT cycle counter when the event occurred.
+//
+//*****************************************************************************
+typedef struct
+{
+    //
+    //! The processor clock cycle counter at the time of the event.
+    //
+    unsigned long ulTimestamp;
+
+    //
+    //! The event that occurred, one of the RTOSTRACE_* event values.
+    //
+    unsigned char ucEvent;
+
+    //
+    //! The task, queue or user channel number that the event applies to.
+    //
+    unsigned char ucObject;
+
+    //
+    //! An event-specific value.
+    //
+    unsigned short usParam;
+}
+tRTOSTraceRecord;
+
+//*****************************************************************************
+//
+//! The value found in the first four bytes of a trace dump.
+//
+//*****************************************************************************
+#define RTOSTRACE_MAGIC         0x43525452  // "RTRC"
+
+//*****************************************************************************
+//
+//! The version of the dump format written by RTOSTraceDump().
+//
+//*****************************************************************************
+#define RTOSTRACE_VERSION       1
+
+//*****************************************************************************
+//
+//! The function used by RTOSTraceDump() to send each part of the dump.
+//
+//*****************************************************************************
+typedef void (*tRTOSTraceWrite)(void *pvInstance,
+                                const unsigned char *pucData,
+                                unsigned long ulSize);
+
+//*****************************************************************************
+//
+// Close the Doxygen group.
+//! @}
+//
+//*****************************************************************************
+
+//*****************************************************************************
+//
+// Prototypes for the trace recorder.
+//
+//*****************************************************************************
+extern void RTOSTraceInit(void *pvBuffer, unsigned long ulSize,
+                          unsigned long ulClockRate, unsigned long ulFlags);
+extern void RTOSTraceStart(void);
+extern void RTOSTraceStop(void);
+extern void RTOSTraceClear(void);
+extern unsigned long RTOSTraceCount(void);
+extern void RTOSTraceRecord(unsigned char ucEvent, unsigned char ucObject,
+                            unsigned short usParam);
+extern void RTOSTraceTick(unsigned short usTick);
+extern void RTOSTraceUser(unsigned char ucChannel, unsigned short usValue);
+extern void RTOSTraceISREnter(void);
+extern void RTOSTraceISRExit(void);
+extern void RTOSTraceTaskCreate(unsigned char ucTask, unsigned char ucPriority,
+                                const signed char *pcName);
+extern unsigned char RTOSTraceQueueCreate(unsigned char ucType);
+extern void RTOSTraceQueueName(void *pvQueue, const char *pcName);
+extern void RTOSTraceDump(tRTOSTraceWrite pfnWrite, void *pvInstance);
+extern void RTOSTraceDumpUART(unsigned long ulBase);
+extern void RTOSTraceTimerInit(void);
+extern unsigned long RTOSTraceRunTimeCounter(void);
+
+//*****************************************************************************
+//
+// The kernel trace hooks.  These are only defined when this header is
+// included from FreeRTOSConfig.h, before FreeRTOS.h supplies its empty
+// defaults; they expand inside tasks.c and queue.c, where the task control
+// block and queue structures are visible.  configUSE_TRACE_FACILITY must be
+// 1 so that every task and queue carries a number.
+//
+//*****************************************************************************
+#if defined(configUSE_TRACE_FACILITY) && !defined(traceTASK_SWITCHED_IN)
+
+#if configUSE_TRACE_FACILITY != 1
+#error "The trace recorder requires configUSE_TRACE_FACILITY to be 1"
+#endif
+
+#define traceTASK_SWITCHED_IN()                                               \
+        RTOSTraceRecord(RTOSTRACE_TASK_SWITCH,                                \
+                        (unsigned char)pxCurrentTCB->uxTCBNumber, 0)
+//
+// The kernel uses this hook without a semicolon after it, so it supplies its
+// own.
+//
+#define traceMOVED_TASK_TO_READY_STATE(pxTCB)                                 \
+        RTOSTraceRecord(RTOSTRACE_TASK_READY,                                 \
+                        (unsigned char)(pxTCB)->uxTCBNumber, 0);
+#define traceTASK_CREATE(pxNewTCB)                                            \
+        RTOSTraceTaskCreate((unsigned char)(pxNewTCB)->uxTCBNumber,           \
+                            (unsigned char)(pxNewTCB)->uxPriority,            \
+                            (pxNewTCB)->pcTaskName)
+#define traceTASK_DELETE(pxTaskToDelete)                                      \
+        RTOSTraceRecord(RTOSTRACE_TASK_DELETE,                                \
+                        (unsigned char)(pxTaskToDelete)->uxTCBNumber, 0)
+#define traceTASK_DELAY()                                                     \
+        RTOSTraceRecord(RTOSTRACE_TASK_DELAY,                                 \
+                        (unsigned char)pxCurrentTCB->uxTCBNumber, 0)
+#define traceTASK_DELAY_UNTIL()                                               \
+        RTOSTraceRecord(RTOSTRACE_TASK_DELAY,                                 \
+                        (unsigned char)pxCurrentTCB->uxTCBNumber, 0)
+#define traceTASK_SUSPEND(pxTaskToSuspend)                                    \
+        RTOSTraceRecord(RTOSTRACE_TASK_SUSPEND,                               \
+                        (unsigned char)(pxTaskToSuspend)->uxTCBNumber, 0)
+#define traceTASK_RESUME(pxTaskToResume)                                      \
+        RTOSTraceRecord(RTOSTRACE_TASK_RESUME,                                \
+                        (unsigned char)(pxTaskToResume)->uxTCBNumber, 0)
+#define traceTASK_RESUME_FROM_ISR(pxTaskToResume)                             \
+        RTOSTraceRecord(RTOSTRACE_TASK_RESUME,                                \
+                        (unsigned char)(pxTaskToResume)->uxTCBNumber, 0)
+#define traceTASK_PRIORITY_SET(pxTask, uxNewPriority)                         \
+        RTOSTraceRecord(RTOSTRACE_TASK_PRIORITY,                              \
+                        (unsigned char)(pxTask)->uxTCBNumber,                 \
+                        (unsigned short)(uxNewPriority))
+#define traceTASK_PRIORITY_INHERIT(pxTCBOfMutexHolder, uxInheritedPriority)   \
+        RTOSTraceRecord(RTOSTRACE_TASK_PRIORITY,                              \
+                        (unsigned char)(pxTCBOfMutexHolder)->uxTCBNumber,     \
+                        (unsigned short)(uxInheritedPriority))
+#define traceTASK_PRIORITY_DISINHERIT(pxTCBOfMutexHolder, uxOriginalPriority) \
+        RTOSTraceRecord(RTOSTRACE_TASK_PRIORITY,                              \
+                        (unsigned char)(pxTCBOfMutexHolder)->uxTCBNumber,     \
+                        (unsigned short)(uxOriginalPriority))
+#define traceTASK_INCREMENT_TICK(xTickCount)                                  \
+        RTOSTraceTick((unsigned short)(xTickCount))
+#define traceLOW_POWER_IDLE_BEGIN()                                           \
+        RTOSTraceRecord(RTOSTRACE_IDLE_SLEEP, 0, (unsigned short)xTickCount)
+#define traceLOW_POWER_IDLE_END()                                             \
+        RTOSTraceRecord(RTOSTRACE_IDLE_WAKE, 0, (unsigned short)xTickCount)
+
+#define traceQUEUE_CREATE(pxNewQueue)                                         \
+        (pxNewQueue)->ucQueueNumber =                                         \
+            RTOSTraceQueueCreate((pxNewQueue)->ucQueueType)
+#define traceCREATE_MUTEX(pxNewQueue)                                         \
+        (pxNewQueue)->ucQueueNumber =                                         \
+            RTOSTraceQueueCreate((pxNewQueue)->ucQueueType)
+#define traceQUEUE_DELETE(pxQueue)                                            \
+        RTOSTraceRecord(RTOSTRACE_QUEUE_DELETE, (pxQueue)->ucQueueNumber, 0)
+#define traceQUEUE_SEND(pxQueue)                                              \
+        RTOSTraceRecord(RTOSTRACE_QUEUE_SEND, (pxQueue)->ucQueueNumber, 0)
+#define traceQUEUE_SEND_FAILED(pxQueue)                                       \
+        RTOSTraceRecord(RTOSTRACE_QUEUE_FAILED, (pxQueue)->ucQueueNumber,     \
+                        RTOSTRACE_QUEUE_SEND)
+#define traceBLOCKING_ON_QUEUE_SEND(pxQueue)                                  \
+        RTOSTraceRecord(RTOSTRACE_QUEUE_BLOCK, (pxQueue)->ucQueueNumber,      \
+                        RTOSTRACE_QUEUE_SEND)
+#define traceQUEUE_RECEIVE(pxQueue)                                           \
+        RTOSTraceRecord(RTOSTRACE_QUEUE_RECEIVE, (pxQueue)->ucQueueNumber, 0)
+#define traceQUEUE_PEEK(pxQueue)                                              \
+        RTOSTraceRecord(RTOSTRACE_QUEUE_PEEK, (pxQueue)->ucQueueNumber, 0)
+#define traceQUEUE_RECEIVE_FAILED(pxQueue)                                    \
+        RTOSTraceRecord(RTOSTRACE_QUEUE_FAILED, (pxQueue)->ucQueueNumber,     \
+                        RTOSTRACE_QUEUE_RECEIVE)
+#define traceBLOCKING_ON_QUEUE_RECEIVE(pxQueue)                               \
+        RTOSTraceRecord(RTOSTRACE_QUEUE_BLOCK, (pxQueue)->ucQueueNumber,      \
+                        RTOSTRACE_QUEUE_RECEIVE)
+#define traceQUEUE_SEND_FROM_ISR(pxQueue)                                     \
+        RTOSTraceRecord(RTOSTRACE_QUEUE_SEND | RTOSTRACE_FROM_ISR,            \
+                        (pxQueue)->ucQueueNumber, 0)
+#define traceQUEUE_SEND_FROM_ISR_FAILED(pxQueue)                              \
+        RTOSTraceRecord(RTOSTRACE_QUEUE_FAILED | RTOSTRACE_FROM_ISR,          \
+                        (pxQueue)->ucQueueNumber, RTOSTRACE_QUEUE_SEND)
+#define traceQUEUE_RECEIVE_FROM_ISR(pxQueue)                                  \
+        RTOSTraceRecord(RTOSTRACE_QUEUE_RECEIVE | RTOSTRACE_FROM_ISR,         \
+                        (pxQueue)->ucQueueNumber, 0)
+#define traceQUEUE_RECEIVE_FROM_ISR_FAILED(pxQueue)                           \
+        RTOSTraceRecord(RTOSTRACE_QUEUE_FAILED | RTOSTRACE_FROM_ISR,          \
+                        (pxQueue)->ucQueueNumber, RTOSTRACE_QUEUE_RECEIVE)
+
+#define traceTASK_NOTIFY()                                                    \
+        RTOSTraceRecord(RTOSTRACE_NOTIFY,                                     \
+                        (unsigned char)pxTCB->uxTCBNumber, 0)
+#define traceTASK_NOTIFY_FROM_ISR()                                           \
+        RTOSTraceRecord(RTOSTRACE_NOTIFY | RTOSTRACE_FROM_ISR,                \
+                        (unsigned char)pxTCB->uxTCBNumber, 0)
+#define traceTASK_NOTIFY_GIVE_FROM_ISR()                                      \
+        RTOSTraceRecord(RTOSTRACE_NOTIFY | RTOSTRACE_FROM_ISR,                \
+                        (unsigned char)pxTCB->uxTCBNumber, 0)
+#define traceTASK_NOTIFY_TAKE_BLOCK()                                         \
+        RTOSTraceRecord(RTOSTRACE_NOTIFY_BLOCK,                               \
+                        (unsigned char)pxCurrentTCB->uxTCBNumber, 0)
+#define traceTASK_NOTIFY_WAIT_BLOCK()                                         \
+        RTOSTraceRecord(RTOSTRACE_NOTIFY_BLOCK,                               \
+                        (unsigned char)pxCurrentTCB->uxTCBNumber, 0)
+#define traceTASK_NOTIFY_TAKE()                                               \
+        RTOSTraceRecord(RTOSTRACE_NOTIFY_TAKE,                                \
+                        (unsigned char)pxCurrentTCB->uxTCBNumber, 0)
+#define traceTASK_NOTIFY_WAIT()                                               \
+        RTOSTraceRecord(RTOSTRACE_NOTIFY_TAKE,                                \
+                        (unsigned char)pxCurrentTCB->uxTCBNumber, 0)
+
+//
+// The cycle counter also drives the kernel's run-time statistics, if they
+// are enabled.
+//
+#if defined(configGENERATE_RUN_TIME_STATS) &&                                 \
+    (configGENERATE_RUN_TIME_STATS == 1) &&                                   \
+    !defined(portCONFIGURE_TIMER_FOR_RUN_TIME_STATS)
+#define portCONFIGURE_TIMER_FOR_RUN_TIME_STATS() RTOSTraceTimerInit()
+#define portGET_RUN_TIME_COUNTER_VALUE()         RTOSTraceRunTimeCounter()
+#endif
+
+#endif
+
+//*****************************************************************************
+//
+// Mark the end of the C bindings section for C++ compilers.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __RTOSTRACE_H__
@@ -0,0 +1,281 @@
+//*****************************************************************************
+//
+// samplefifo.c - Lock-free FIFO of sample packets filled by DMA.
+//
+//*****************************************************************************
+
+#include "inc/hw_types.h"
+#include "driverlib/debug.h"
+#include "utils/samplefifo.h"
+
+//*****************************************************************************
+//
+//! \addtogroup samplefifo_api
+//! @{
+//
+//*****************************************************************************
+
+//*****************************************************************************
+//
+// Prevents the compiler from moving memory accesses across the update of a
+// FIFO count.  The FIFO is only shared between contexts on a single core so
+// no hardware barrier is needed, only a compiler one.  The other toolchains
+// do not move accesses across the volatile count updates.
+//
+//*****************************************************************************
+#if defined(codered) || defined(gcc) || defined(sourcerygxx)
+#define COMPILER_BARRIER()      __asm volatile("" : : : "memory")
+#else
+#define COMPILER_BARRIER()
+#endif
+
+//*****************************************************************************
+//
+//! Initializes a sample FIFO.
+//!
+//! \param psFIFO points to the FIFO structure to initialize.
+//! \param pucBuf points to the storage for the slots, which must be at least
+//! \e ulNumSlots * \e ulSlotSize bytes in size.
+//! \param pusNumBytes points to an array of \e ulNumSlots entries used to hold
+//! the number of valid bytes in each slot.
+//! \param ulNumSlots is the number of slots in the FIFO.  This must be a power
+//! of two.
+//! \param ulSlotSize is the size of each slot in bytes.  When the slots are
+//! filled by uDMA in 32-bit units this must be a multiple of four, and
+//! \e pucBuf must be word aligned.
+//!
+//! This function prepares a FIFO of fixed size slots that is filled one slot
+//! at a time by a producer, typically a DMA completion handler, and drained
+//! one slot at a time by a consumer.  The producer obtains a pointer to the
+//! next free slot with SampleFIFOWriteSlotGet() and hands it directly to the
+//! DMA controller, for example through USBAudioBufferOut(), then publishes it
+//! with SampleFIFOWriteSlotCommit() once the transfer completes.  No sample
+//! is ever copied by the FIFO itself.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+SampleFIFOInit(tSampleFIFO *psFIFO, unsigned char *pucBuf,
+               unsigned short *pusNumBytes, unsigned long ulNumSlots,
+               unsigned long ulSlotSize)
+{
+    //
+    // Check the arguments.
+    //
+    ASSERT(psFIFO != 0);
+    ASSERT(pucBuf != 0);
+    ASSERT(pusNumBytes != 0);
+    ASSERT(ulNumSlots && !(ulNumSlots & (ulNumSlots - 1)));
+    ASSERT(ulSlotSize && (ulSlotSize <= 0xffff));
+
+    //
+    // Initialize the FIFO object.
+    //
+    psFIFO->ulSlotMask = ulNumSlots - 1;
+    psFIFO->ulSlotSize = ulSlotSize;
+    psFIFO->pucBuf = pucBuf;
+    psFIFO->pusNumBytes = pusNumBytes;
+    psFIFO->ulWriteCount = 0;
+    psFIFO->ulReadCount = 0;
+}
+
+//*****************************************************************************
+//
+//! Empties a sample FIFO.
+//!
+//! \param psFIFO points to the FIFO to empty.
+//!
+//! This function discards every committed slot.  It is called from the
+//! consumer's context and must not be called while the consumer holds a slot
+//! obtained from SampleFIFOReadSlotGet().
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+SampleFIFOFlush(tSampleFIFO *psFIFO)
+{
+    ASSERT(psFIFO != 0);
+
+    psFIFO->ulReadCount = psFIFO->ulWriteCount;
+}
+
+//*****************************************************************************
+//
+//! Returns the number of committed slots waiting to be read.
+//!
+//! \param psFIFO points to the FIFO to query.
+//!
+//! \return Returns the number of slots that may be read.
+//
+//*****************************************************************************
+unsigned long
+SampleFIFOUsed(tSampleFIFO *psFIFO)
+{
+    unsigned long ulWrite;
+    unsigned long ulRead;
+
+    ASSERT(psFIFO != 0);
+
+    //
+    // Copy the counts so that the order of the volatile accesses is
+    // defined.  The free running counts make wrap irrelevant.
+    //
+    ulWrite = psFIFO->ulWriteCount;
+    ulRead = psFIFO->ulReadCount;
+
+    return(ulWrite - ulRead);
+}
+
+//*****************************************************************************
+//
+//! Returns the number of slots available to the producer.
+//!
+//! \param psFIFO points to the FIFO to query.
+//!
+//! \return Returns the number of slots that may be written.
+//
+//*****************************************************************************
+unsigned long
+SampleFIFOFree(tSampleFIFO *psFIFO)
+{
+    ASSERT(psFIFO != 0);
+
+    return((psFIFO->ulSlotMask + 1) - SampleFIFOUsed(psFIFO));
+}
+
+//*****************************************************************************
+//
+//! Returns the next slot to be filled by the producer.
+//!
+//! \param psFIFO points to the FIFO to write.
+//!
+//! This function returns a pointer to the slot that will be published by the
+//! next call to SampleFIFOWriteSlotCommit().  The same slot is returned until
+//! it is committed.  The slot is \e ulSlotSize bytes in size.
+//!
+//! \return Returns a pointer to the slot or 0 if the FIFO is full.
+//
+//*****************************************************************************
+unsigned char *
+SampleFIFOWriteSlotGet(tSampleFIFO *psFIFO)
+{
+    unsigned long ulWrite;
+
+    ASSERT(psFIFO != 0);
+
+    if(SampleFIFOFree(psFIFO) == 0)
+    {
+        return(0);
+    }
+
+    ulWrite = psFIFO->ulWriteCount & psFIFO->ulSlotMask;
+
+    return(psFIFO->pucBuf + (ulWrite * psFIFO->ulSlotSize));
+}
+
+//*****************************************************************************
+//
+//! Publishes the slot most recently returned by SampleFIFOWriteSlotGet().
+//!
+//! \param psFIFO points to the FIFO to write.
+//! \param ulNumBytes is the number of valid bytes placed in the slot.
+//!
+//! This function makes the slot visible to the consumer.  It must only be
+//! called after SampleFIFOWriteSlotGet() has returned a non-zero pointer.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+SampleFIFOWriteSlotCommit(tSampleFIFO *psFIFO, unsigned long ulNumBytes)
+{
+    unsigned long ulWrite;
+
+    ASSERT(psFIFO != 0);
+    ASSERT(ulNumBytes <= psFIFO->ulSlotSize);
+    ASSERT(SampleFIFOFree(psFIFO) != 0);
+
+    ulWrite = psFIFO->ulWriteCount;
+    psFIFO->pusNumBytes[ulWrite & psFIFO->ulSlotMask] =
+        (unsigned short)ulNumBytes;
+
+    //
+    // Make sure the slot contents are in place before the consumer can see
+    // the slot.
+    //
+    COMPILER_BARRIER();
+
+    psFIFO->ulWriteCount = ulWrite + 1;
+}
+
+//*****************************************************************************
+//
+//! Returns the oldest committed slot.
+//!
+//! \param psFIFO points to the FIFO to read.
+//! \param pulNumBytes points to storage which is written with the number of
+//! valid bytes in the slot.
+//!
+//! This function returns a pointer to the oldest slot published by the
+//! producer.  The slot remains owned by the consumer, and will not be
+//! overwritten, until it is passed back with SampleFIFOReadSlotRelease().
+//!
+//! \return Returns a pointer to the slot or 0 if the FIFO is empty.
+//
+//*****************************************************************************
+unsigned char *
+SampleFIFOReadSlotGet(tSampleFIFO *psFIFO, unsigned long *pulNumBytes)
+{
+    unsigned long ulRead;
+
+    ASSERT(psFIFO != 0);
+    ASSERT(pulNumBytes != 0);
+
+    if(SampleFIFOUsed(psFIFO) == 0)
+    {
+        return(0);
+    }
+
+    COMPILER_BARRIER();
+
+    ulRead = psFIFO->ulReadCount & psFIFO->ulSlotMask;
+    *pulNumBytes = psFIFO->pusNumBytes[ulRead];
+
+    return(psFIFO->pucBuf + (ulRead * psFIFO->ulSlotSize));
+}
+
+//*****************************************************************************
+//
+//! Returns the slot most recently obtained by SampleFIFOReadSlotGet().
+//!
+//! \param psFIFO points to the FIFO to read.
+//!
+//! This function hands the slot back to the producer so that it may be
+//! filled again.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+SampleFIFOReadSlotRelease(tSampleFIFO *psFIFO)
+{
+    ASSERT(psFIFO != 0);
+    ASSERT(SampleFIFOUsed(psFIFO) != 0);
+
+    //
+    // Make sure that the consumer has finished with the slot before the
+    // producer can reuse it.
+    //
+    COMPILER_BARRIER();
+
+    psFIFO->ulReadCount = psFIFO->ulReadCount + 1;
+}
+
+//*****************************************************************************
+//
+// Close the Doxygen group.
+//! @}
+//
+//*****************************************************************************
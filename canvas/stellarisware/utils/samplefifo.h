@@ -0,0 +1,108 @@
+//*****************************************************************************
+//
+// samplefifo.h - Prototypes for the lock-free sample packet FIFO.
+//
+//*****************************************************************************
+
+#ifndef __SAMPLEFIFO_H__
+#define __SAMPLEFIFO_H__
+
+//*****************************************************************************
+//
+// If building with a C++ compiler, make all of the definitions in this header
+// have a C binding.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+//*****************************************************************************
+//
+//! \addtogroup samplefifo_api
+//! @{
+//
+//*****************************************************************************
+
+//*****************************************************************************
+//
+//! The structure used for encapsulating all the items associated with a
+//! sample FIFO.  The FIFO holds a power of two number of fixed size slots,
+//! each of which receives one packet of samples.  The producer and the
+//! consumer each own one index so a single producer and a single consumer
+//! may use the FIFO from different contexts without disabling interrupts.
+//
+//*****************************************************************************
+typedef struct
+{
+    //
+    //! The number of slots in the FIFO minus one.  The number of slots must
+    //! be a power of two.
+    //
+    unsigned long ulSlotMask;
+
+    //
+    //! The size of each slot in bytes.
+    //
+    unsigned long ulSlotSize;
+
+    //
+    //! The number of slots that have been committed by the producer.  This
+    //! is a free running count which is only written by the producer.
+    //
+    volatile unsigned long ulWriteCount;
+
+    //
+    //! The number of slots that have been released by the consumer.  This is
+    //! a free running count which is only written by the consumer.
+    //
+    volatile unsigned long ulReadCount;
+
+    //
+    //! The storage for the slots, ulSlotSize bytes each.
+    //
+    unsigned char *pucBuf;
+
+    //
+    //! The number of valid bytes in each slot.
+    //
+    unsigned short *pusNumBytes;
+}
+tSampleFIFO;
+
+//*****************************************************************************
+//
+// Close the Doxygen group.
+//! @}
+//
+//*****************************************************************************
+
+//*****************************************************************************
+//
+// API Function prototypes
+//
+//*****************************************************************************
+extern void SampleFIFOInit(tSampleFIFO *psFIFO, unsigned char *pucBuf,
+                           unsigned short *pusNumBytes,
+                           unsigned long ulNumSlots, unsigned long ulSlotSize);
+extern void SampleFIFOFlush(tSampleFIFO *psFIFO);
+extern unsigned long SampleFIFOUsed(tSampleFIFO *psFIFO);
+extern unsigned long SampleFIFOFree(tSampleFIFO *psFIFO);
+extern unsigned char *SampleFIFOWriteSlotGet(tSampleFIFO *psFIFO);
+extern void SampleFIFOWriteSlotCommit(tSampleFIFO *psFIFO,
+                                      unsigned long ulNumBytes);
+extern unsigned char *SampleFIFOReadSlotGet(tSampleFIFO *psFIFO,
+                                            unsigned long *pulNumBytes);
+extern void SampleFIFOReadSlotRelease(tSampleFIFO *psFIFO);
+
+//*****************************************************************************
+//
+// Mark the end of the C bindings section for C++ compilers.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __SAMPLEFIFO_H__
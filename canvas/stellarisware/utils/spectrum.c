@@ -0,0 +1,448 @@
+//*****************************************************************************
+//
+// spectrum.c - Fixed point audio spectrum analyzer.
+//
+//*****************************************************************************
+
+#include "inc/hw_types.h"
+#include "driverlib/debug.h"
+#include "utils/isqrt.h"
+#include "utils/sine.h"
+#include "utils/spectrum.h"
+
+//*****************************************************************************
+//
+//! \addtogroup spectrum_api
+//! @{
+//
+//*****************************************************************************
+
+//*****************************************************************************
+//
+// The cosine and sine of the FFT twiddle factors, in Q15 format.  Entry k
+// holds the value for the angle 2 * pi * k / SPECTRUM_SIZE.
+//
+//*****************************************************************************
+static short g_psTwiddleCos[SPECTRUM_SIZE / 2];
+static short g_psTwiddleSin[SPECTRUM_SIZE / 2];
+
+//*****************************************************************************
+//
+// The Hann window applied to the samples before they are transformed, in Q15
+// format.
+//
+//*****************************************************************************
+static short g_psWindow[SPECTRUM_SIZE];
+
+//*****************************************************************************
+//
+// A flag that indicates that the tables above have been computed.
+//
+//*****************************************************************************
+static tBoolean g_bTablesValid = false;
+
+//*****************************************************************************
+//
+// Converts a 16.16 fixed point value in the range [-1, 1], as returned by
+// sine(), to Q15 format.
+//
+//*****************************************************************************
+static short
+SpectrumQ15(long lValue)
+{
+    lValue >>= 1;
+
+    if(lValue > 32767)
+    {
+        lValue = 32767;
+    }
+
+    return((short)lValue);
+}
+
+//*****************************************************************************
+//
+// Computes the twiddle factor and window tables.  These depend only upon
+// SPECTRUM_SIZE so they are shared by all analyzers.
+//
+//*****************************************************************************
+static void
+SpectrumTablesInit(void)
+{
+    unsigned long ulIdx;
+    unsigned long ulAngle;
+
+    //
+    // Compute the twiddle factors.  A full turn is 2^32 for sine().
+    //
+    for(ulIdx = 0; ulIdx < (SPECTRUM_SIZE / 2); ulIdx++)
+    {
+        ulAngle = ulIdx << (32 - SPECTRUM_SIZE_LOG2);
+        g_psTwiddleCos[ulIdx] = SpectrumQ15(cosine(ulAngle));
+        g_psTwiddleSin[ulIdx] = SpectrumQ15(sine(ulAngle));
+    }
+
+    //
+    // Compute the Hann window, which is (1 - cos(2 * pi * n / N)) / 2.
+    //
+    for(ulIdx = 0; ulIdx < SPECTRUM_SIZE; ulIdx++)
+    {
+        ulAngle = ulIdx << (32 - SPECTRUM_SIZE_LOG2);
+        g_psWindow[ulIdx] = SpectrumQ15((65536 - cosine(ulAngle)) >> 1);
+    }
+
+    g_bTablesValid = true;
+}
+
+//*****************************************************************************
+//
+// Computes an approximation of 2 raised to the power of the given 16.16 fixed
+// point value, rounded to the nearest integer.  The fractional power is
+// linearly interpolated, which is accurate to within 6%.
+//
+//*****************************************************************************
+static unsigned long
+SpectrumExp2(unsigned long ulExp)
+{
+    unsigned long ulInt;
+
+    ulInt = 1 << (ulExp >> 16);
+
+    return(((ulInt * (0x10000 + (ulExp & 0xffff))) + 0x8000) >> 16);
+}
+
+//*****************************************************************************
+//
+// Performs an in-place radix-2 decimation in time FFT of the working buffer.
+// Each stage halves the result to prevent overflow, so the output is the
+// transform divided by SPECTRUM_SIZE.
+//
+//*****************************************************************************
+static void
+SpectrumFFT(short *psReal, short *psImag)
+{
+    unsigned long ulIdx, ulRev, ulBit;
+    unsigned long ulSpan, ulStep, ulGroup, ulTop, ulBottom;
+    long lCos, lSin, lReal, lImag, lTopReal, lTopImag;
+    short sTemp;
+
+    //
+    // Place the samples in bit reversed order.  The imaginary parts are all
+    // zero at this point so only the real parts need to be moved.
+    //
+    for(ulIdx = 1, ulRev = 0; ulIdx < SPECTRUM_SIZE; ulIdx++)
+    {
+        ulBit = SPECTRUM_SIZE >> 1;
+        while(ulRev & ulBit)
+        {
+            ulRev ^= ulBit;
+            ulBit >>= 1;
+        }
+        ulRev |= ulBit;
+
+        if(ulIdx < ulRev)
+        {
+            sTemp = psReal[ulIdx];
+            psReal[ulIdx] = psReal[ulRev];
+            psReal[ulRev] = sTemp;
+        }
+    }
+
+    //
+    // Perform the butterflies, one stage at a time.
+    //
+    for(ulSpan = 1, ulStep = SPECTRUM_SIZE / 2; ulSpan < SPECTRUM_SIZE;
+        ulSpan <<= 1, ulStep >>= 1)
+    {
+        for(ulGroup = 0; ulGroup < ulSpan; ulGroup++)
+        {
+            //
+            // The twiddle factor for this butterfly is cos - j * sin.
+            //
+            lCos = g_psTwiddleCos[ulGroup * ulStep];
+            lSin = g_psTwiddleSin[ulGroup * ulStep];
+
+            for(ulTop = ulGroup; ulTop < SPECTRUM_SIZE; ulTop += ulSpan << 1)
+            {
+                ulBottom = ulTop + ulSpan;
+
+                lReal = ((lCos * psReal[ulBottom]) +
+                         (lSin * psImag[ulBottom])) >> 15;
+                lImag = ((lCos * psImag[ulBottom]) -
+                         (lSin * psReal[ulBottom])) >> 15;
+                lTopReal = psReal[ulTop];
+                lTopImag = psImag[ulTop];
+
+                psReal[ulBottom] = (short)((lTopReal - lReal) >> 1);
+                psImag[ulBottom] = (short)((lTopImag - lImag) >> 1);
+                psReal[ulTop] = (short)((lTopReal + lReal) >> 1);
+                psImag[ulTop] = (short)((lTopImag + lImag) >> 1);
+            }
+        }
+    }
+}
+
+//*****************************************************************************
+//
+//! Initializes a spectrum analyzer.
+//!
+//! \param psSpectrum points to the analyzer structure to initialize.
+//! \param ulNumBands is the number of bands to divide the spectrum into.  This
+//! must be between one and SPECTRUM_MAX_BANDS.
+//!
+//! This function prepares a spectrum analyzer which divides the audio
+//! spectrum into bands of logarithmically increasing width, so that each
+//! octave is given roughly the same number of bands.  The lowest band starts
+//! at the first bin above DC and the highest band ends at the Nyquist
+//! frequency.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+SpectrumInit(tSpectrum *psSpectrum, unsigned long ulNumBands)
+{
+    unsigned long ulBand, ulEdge;
+
+    //
+    // Check the arguments.
+    //
+    ASSERT(psSpectrum != 0);
+    ASSERT((ulNumBands != 0) && (ulNumBands <= SPECTRUM_MAX_BANDS));
+    ASSERT(SPECTRUM_MAX_BANDS < (SPECTRUM_SIZE / 2));
+
+    //
+    // Compute the shared tables if this is the first analyzer.
+    //
+    if(!g_bTablesValid)
+    {
+        SpectrumTablesInit();
+    }
+
+    psSpectrum->ulNumBands = ulNumBands;
+    psSpectrum->ulHistoryIndex = 0;
+    psSpectrum->ulHistoryCount = 0;
+
+    //
+    // Space the band edges evenly between bin 1 and bin SPECTRUM_SIZE / 2 on
+    // a logarithmic scale, making sure that each band is at least one bin
+    // wide.
+    //
+    for(ulBand = 0; ulBand <= ulNumBands; ulBand++)
+    {
+        ulEdge = SpectrumExp2((((SPECTRUM_SIZE_LOG2 - 1) << 16) * ulBand) /
+                              ulNumBands);
+
+        if((ulBand != 0) && (ulEdge <= psSpectrum->pusBandEdge[ulBand - 1]))
+        {
+            ulEdge = psSpectrum->pusBandEdge[ulBand - 1] + 1;
+        }
+
+        psSpectrum->pusBandEdge[ulBand] = (unsigned short)ulEdge;
+    }
+
+    //
+    // Widening the low bands may have pushed the high edges past the end of
+    // the spectrum, so pull them back in from the top.
+    //
+    psSpectrum->pusBandEdge[ulNumBands] = SPECTRUM_SIZE / 2;
+    for(ulBand = ulNumBands; ulBand > 0; ulBand--)
+    {
+        if(psSpectrum->pusBandEdge[ulBand - 1] >=
+           psSpectrum->pusBandEdge[ulBand])
+        {
+            psSpectrum->pusBandEdge[ulBand - 1] =
+                psSpectrum->pusBandEdge[ulBand] - 1;
+        }
+    }
+}
+
+//*****************************************************************************
+//
+//! Adds audio samples to a spectrum analyzer.
+//!
+//! \param psSpectrum points to the analyzer.
+//! \param psSamples points to the signed 16-bit PCM samples to add.
+//! \param ulNumFrames is the number of sample frames to add.
+//! \param ulNumChannels is the number of interleaved channels in each frame.
+//!
+//! This function mixes each frame down to a single channel and adds it to the
+//! history used by SpectrumCompute().  It is typically called with each slot
+//! read from a sample FIFO filled by the USB audio device.  Only the most
+//! recent SPECTRUM_SIZE frames are retained.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+SpectrumSamplesAdd(tSpectrum *psSpectrum, const short *psSamples,
+                   unsigned long ulNumFrames, unsigned long ulNumChannels)
+{
+    unsigned long ulIdx, ulChannel;
+    long lSum;
+
+    ASSERT(psSpectrum != 0);
+    ASSERT(psSamples != 0);
+    ASSERT(ulNumChannels != 0);
+
+    ulIdx = psSpectrum->ulHistoryIndex;
+
+    while(ulNumFrames--)
+    {
+        //
+        // Mix the channels of this frame.  The common mono and stereo cases
+        // avoid the division.
+        //
+        if(ulNumChannels == 1)
+        {
+            lSum = *psSamples++;
+        }
+        else if(ulNumChannels == 2)
+        {
+            lSum = ((long)psSamples[0] + (long)psSamples[1]) >> 1;
+            psSamples += 2;
+        }
+        else
+        {
+            for(ulChannel = 0, lSum = 0; ulChannel < ulNumChannels;
+                ulChannel++)
+            {
+                lSum += *psSamples++;
+            }
+            lSum /= (long)ulNumChannels;
+        }
+
+        psSpectrum->psHistory[ulIdx] = (short)lSum;
+        ulIdx = (ulIdx + 1) & (SPECTRUM_SIZE - 1);
+
+        if(psSpectrum->ulHistoryCount < SPECTRUM_SIZE)
+        {
+            psSpectrum->ulHistoryCount++;
+        }
+    }
+
+    psSpectrum->ulHistoryIndex = ulIdx;
+}
+
+//*****************************************************************************
+//
+//! Computes the spectrum of the most recent audio samples.
+//!
+//! \param psSpectrum points to the analyzer.
+//! \param pusBands points to an array of \e ulNumBands entries which is
+//! written with the magnitude of each band, lowest frequency first.
+//!
+//! This function windows the most recent SPECTRUM_SIZE samples, transforms
+//! them, and reports the peak bin magnitude within each band.  A full scale
+//! sine wave gives a magnitude of approximately 16384.  This function is
+//! intended to be called once per display update, such as once per
+//! revolution, and is independent of the rate at which samples are added.
+//!
+//! \return Returns \b true if the spectrum was computed or \b false if fewer
+//! than SPECTRUM_SIZE samples have been added since the analyzer was
+//! initialized.
+//
+//*****************************************************************************
+tBoolean
+SpectrumCompute(tSpectrum *psSpectrum, unsigned short *pusBands)
+{
+    unsigned long ulIdx, ulSample, ulBand, ulBin, ulMag, ulPeak;
+    long lReal, lImag;
+
+    ASSERT(psSpectrum != 0);
+    ASSERT(pusBands != 0);
+
+    if(psSpectrum->ulHistoryCount < SPECTRUM_SIZE)
+    {
+        return(false);
+    }
+
+    //
+    // Window the history into the working buffer, oldest sample first.
+    //
+    ulSample = psSpectrum->ulHistoryIndex;
+    for(ulIdx = 0; ulIdx < SPECTRUM_SIZE; ulIdx++)
+    {
+        psSpectrum->psReal[ulIdx] =
+            (short)(((long)psSpectrum->psHistory[ulSample] *
+                     g_psWindow[ulIdx]) >> 15);
+        psSpectrum->psImag[ulIdx] = 0;
+        ulSample = (ulSample + 1) & (SPECTRUM_SIZE - 1);
+    }
+
+    SpectrumFFT(psSpectrum->psReal, psSpectrum->psImag);
+
+    //
+    // Find the peak magnitude within each band.  The magnitude of a bin is
+    // scaled by two to account for the energy in the mirrored negative
+    // frequency bin.
+    //
+    for(ulBand = 0; ulBand < psSpectrum->ulNumBands; ulBand++)
+    {
+        ulPeak = 0;
+
+        for(ulBin = psSpectrum->pusBandEdge[ulBand];
+            ulBin < psSpectrum->pusBandEdge[ulBand + 1]; ulBin++)
+        {
+            lReal = psSpectrum->psReal[ulBin];
+            lImag = psSpectrum->psImag[ulBin];
+            ulMag = (unsigned long)((lReal * lReal) + (lImag * lImag));
+
+            if(ulMag > ulPeak)
+            {
+                ulPeak = ulMag;
+            }
+        }
+
+        ulMag = isqrt(ulPeak) << 1;
+        pusBands[ulBand] = (ulMag > 0xffff) ? 0xffff : (unsigned short)ulMag;
+    }
+
+    return(true);
+}
+
+//*****************************************************************************
+//
+//! Converts a band magnitude to a logarithmic level.
+//!
+//! \param ulMagnitude is a band magnitude returned by SpectrumCompute().
+//!
+//! This function computes an approximation of the base two logarithm of the
+//! magnitude, which better matches the perceived loudness of each band.
+//! Each step of 16 in the result corresponds to 6 dB.
+//!
+//! \return Returns the level in 4.4 fixed point format, from 0 to 255.
+//
+//*****************************************************************************
+unsigned long
+SpectrumLevel(unsigned long ulMagnitude)
+{
+    unsigned long ulBit;
+
+    if(ulMagnitude > 0xffff)
+    {
+        ulMagnitude = 0xffff;
+    }
+
+    if(ulMagnitude == 0)
+    {
+        return(0);
+    }
+
+    //
+    // Find the most significant set bit, which is the integer part of the
+    // logarithm, and use the four bits below it as the fractional part.
+    //
+    for(ulBit = 15; !(ulMagnitude & (1 << ulBit)); ulBit--)
+    {
+    }
+
+    return((ulBit << 4) + (((ulMagnitude << 4) >> ulBit) & 15));
+}
+
+//*****************************************************************************
+//
+// Close the Doxygen group.
+//! @}
+//
+//*****************************************************************************
@@ -0,0 +1,134 @@
+//*****************************************************************************
+//
+// spectrum.h - Prototypes for the fixed point audio spectrum analyzer.
+//
+//*****************************************************************************
+
+#ifndef __SPECTRUM_H__
+#define __SPECTRUM_H__
+
+//*****************************************************************************
+//
+// If building with a C++ compiler, make all of the definitions in this header
+// have a C binding.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+//*****************************************************************************
+//
+//! \addtogroup spectrum_api
+//! @{
+//
+//*****************************************************************************
+
+//*****************************************************************************
+//
+// The base two logarithm of the number of samples transformed by each call to
+// SpectrumCompute().  The default of 256 samples covers 5.3 ms of audio at
+// 48 kHz and gives bins 187.5 Hz wide.
+//
+//*****************************************************************************
+#ifndef SPECTRUM_SIZE_LOG2
+#define SPECTRUM_SIZE_LOG2      8
+#endif
+
+//*****************************************************************************
+//
+// The number of samples transformed by each call to SpectrumCompute().
+//
+//*****************************************************************************
+#define SPECTRUM_SIZE           (1 << SPECTRUM_SIZE_LOG2)
+
+//*****************************************************************************
+//
+// The largest number of bands that the spectrum may be divided into.  This
+// must be smaller than half of SPECTRUM_SIZE.
+//
+//*****************************************************************************
+#ifndef SPECTRUM_MAX_BANDS
+#define SPECTRUM_MAX_BANDS      16
+#endif
+
+//*****************************************************************************
+//
+//! The structure used for encapsulating all the items associated with a
+//! spectrum analyzer.  The analyzer keeps a history of the most recent
+//! SPECTRUM_SIZE mono samples so that a spectrum may be computed at any time,
+//! regardless of how the audio packets line up with the display.
+//
+//*****************************************************************************
+typedef struct
+{
+    //
+    //! The number of bands that the spectrum is divided into.
+    //
+    unsigned long ulNumBands;
+
+    //
+    //! The index into psHistory where the next sample is stored.
+    //
+    unsigned long ulHistoryIndex;
+
+    //
+    //! The number of samples added since the analyzer was initialized,
+    //! saturating at SPECTRUM_SIZE.
+    //
+    unsigned long ulHistoryCount;
+
+    //
+    //! The first FFT bin of each band.  Entry ulNumBands is one past the last
+    //! bin of the last band.
+    //
+    unsigned short pusBandEdge[SPECTRUM_MAX_BANDS + 1];
+
+    //
+    //! The most recent mono samples, stored circularly.
+    //
+    short psHistory[SPECTRUM_SIZE];
+
+    //
+    //! The real parts of the FFT working buffer.
+    //
+    short psReal[SPECTRUM_SIZE];
+
+    //
+    //! The imaginary parts of the FFT working buffer.
+    //
+    short psImag[SPECTRUM_SIZE];
+}
+tSpectrum;
+
+//*****************************************************************************
+//
+// Close the Doxygen group.
+//! @}
+//
+//*****************************************************************************
+
+//*****************************************************************************
+//
+// API Function prototypes
+//
+//*****************************************************************************
+extern void SpectrumInit(tSpectrum *psSpectrum, unsigned long ulNumBands);
+extern void SpectrumSamplesAdd(tSpectrum *psSpectrum, const short *psSamples,
+                               unsigned long ulNumFrames,
+                               unsigned long ulNumChannels);
+extern tBoolean SpectrumCompute(tSpectrum *psSpectrum,
+                                unsigned short *pusBands);
+extern unsigned long SpectrumLevel(unsigned long ulMagnitude);
+
+//*****************************************************************************
+//
+// Mark the end of the C bindings section for C++ compilers.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __SPECTRUM_H__
@@ -23,6 +23,7 @@
 //*****************************************************************************
 
 #include <stdarg.h>
+#include <string.h>
 #include "inc/hw_ints.h"
 #include "inc/hw_memmap.h"
 #include "inc/hw_types.h"
@@ -33,6 +34,7 @@
 #include "driverlib/rom_map.h"
 #include "driverlib/sysctl.h"
 #include "driverlib/uart.h"
+#include "driverlib/udma.h"
 #include "utils/uartstdio.h"
 
 //*****************************************************************************
@@ -84,6 +86,8 @@ static volatile unsigned long g_ulUARTRxReadIndex = 0;
 //*****************************************************************************
 //
 // Macros to determine number of free and used bytes in the transmit buffer.
+// An index is wrapped with a mask rather than a division when the buffer
+// size is a power of two.
 //
 //*****************************************************************************
 #define TX_BUFFER_USED          (GetBufferCount(&g_ulUARTTxReadIndex,  \
@@ -95,8 +99,15 @@ static volatile unsigned long g_ulUARTRxReadIndex = 0;
 #define TX_BUFFER_FULL          (IsBufferFull(&g_ulUARTTxReadIndex,  \
                                               &g_ulUARTTxWriteIndex, \
                                               UART_TX_BUFFER_SIZE))
+#if (UART_TX_BUFFER_SIZE & (UART_TX_BUFFER_SIZE - 1)) == 0
+#define WRAP_TX_BUFFER_INDEX(Index)                                           \
+                                ((Index) & (UART_TX_BUFFER_SIZE - 1))
+#else
+#define WRAP_TX_BUFFER_INDEX(Index)                                           \
+                                ((Index) % UART_TX_BUFFER_SIZE)
+#endif
 #define ADVANCE_TX_BUFFER_INDEX(Index) \
-                                (Index) = ((Index) + 1) % UART_TX_BUFFER_SIZE
+                                (Index) = WRAP_TX_BUFFER_INDEX((Index) + 1)
 
 //*****************************************************************************
 //
@@ -112,8 +123,51 @@ static volatile unsigned long g_ulUARTRxReadIndex = 0;
 #define RX_BUFFER_FULL          (IsBufferFull(&g_ulUARTRxReadIndex,  \
                                               &g_ulUARTRxWriteIndex, \
                                               UART_RX_BUFFER_SIZE))
+#if (UART_RX_BUFFER_SIZE & (UART_RX_BUFFER_SIZE - 1)) == 0
+#define WRAP_RX_BUFFER_INDEX(Index)                                           \
+                                ((Index) & (UART_RX_BUFFER_SIZE - 1))
+#else
+#define WRAP_RX_BUFFER_INDEX(Index)                                           \
+                                ((Index) % UART_RX_BUFFER_SIZE)
+#endif
 #define ADVANCE_RX_BUFFER_INDEX(Index) \
-                                (Index) = ((Index) + 1) % UART_RX_BUFFER_SIZE
+                                (Index) = WRAP_RX_BUFFER_INDEX((Index) + 1)
+#endif
+
+#ifdef UART_DMA
+//*****************************************************************************
+//
+// The largest number of items that the uDMA controller can move in one
+// transfer.
+//
+//*****************************************************************************
+#define UART_DMA_MAX_TRANSFER   1024
+
+//*****************************************************************************
+//
+// The number of bytes from the read index of the transmit buffer that the
+// uDMA controller has been given to send.  The read index is only moved past
+// them once the transfer is complete, so that they are not overwritten.
+//
+//*****************************************************************************
+static volatile unsigned long g_ulUARTTxDMACount = 0;
+
+//*****************************************************************************
+//
+// The uDMA channel mappings for the transmit side of each console UART.
+//
+//*****************************************************************************
+static const unsigned long g_ulUARTTxDMA[3] =
+{
+    UDMA_CH9_UART0TX, UDMA_CH23_UART1TX, UDMA_CH1_UART2TX
+};
+
+//*****************************************************************************
+//
+// The uDMA channel used for the console UART.
+//
+//*****************************************************************************
+static unsigned long g_ulUARTTxChannel;
 #endif
 
 //*****************************************************************************
@@ -195,10 +249,19 @@ IsBufferFull(volatile unsigned long *pulRead,
     unsigned long ulWrite;
     unsigned long ulRead;
 
-    ulWrite = *pulWrite;
+    ulWrite = *pulWrite + 1;
     ulRead = *pulRead;
 
-    return((((ulWrite + 1) % ulSize) == ulRead) ? true : false);
+    //
+    // Wrap the next write index without a division, since this is called for
+    // each character received.
+    //
+    if(ulWrite == ulSize)
+    {
+        ulWrite = 0;
+    }
+
+    return((ulWrite == ulRead) ? true : false);
 }
 #endif
 
@@ -270,8 +333,73 @@ GetBufferCount(volatile unsigned long *pulRead,
 // Take as many bytes from the transmit buffer as we have space for and move
 // them into the UART transmit FIFO.
 //
+// When built with UART_DMA, instead hand the uDMA controller the longest run
+// of bytes that does not wrap around the end of the buffer, once the last run
+// that it was given has been sent.
+//
 //*****************************************************************************
-#ifdef UART_BUFFERED
+#ifdef UART_DMA
+static void
+UARTPrimeTransmit(unsigned long ulBase)
+{
+    unsigned long ulRead, ulWrite, ulCount;
+
+    //
+    // Disable the UART interrupt. If we don't do this there is a race
+    // condition which can cause the read index to be corrupted.
+    //
+    MAP_IntDisable(g_ulUARTInt[g_ulPortNum]);
+
+    //
+    // Nothing can be done until the uDMA controller has finished with the
+    // run it was last given.
+    //
+    if(!MAP_uDMAChannelIsEnabled(g_ulUARTTxChannel))
+    {
+        //
+        // Free the space taken by the run that has just been sent.
+        //
+        if(g_ulUARTTxDMACount)
+        {
+            g_ulUARTTxReadIndex = WRAP_TX_BUFFER_INDEX(g_ulUARTTxReadIndex +
+                                                       g_ulUARTTxDMACount);
+            g_ulUARTTxDMACount = 0;
+        }
+
+        //
+        // Find the bytes waiting up to the write index or the end of the
+        // buffer, whichever is first.
+        //
+        ulRead = g_ulUARTTxReadIndex;
+        ulWrite = g_ulUARTTxWriteIndex;
+        ulCount = ((ulWrite >= ulRead) ? ulWrite : UART_TX_BUFFER_SIZE) -
+                  ulRead;
+        if(ulCount > UART_DMA_MAX_TRANSFER)
+        {
+            ulCount = UART_DMA_MAX_TRANSFER;
+        }
+
+        //
+        // Start sending them.  The UART interrupt is raised when they have
+        // all been moved into the FIFO.
+        //
+        if(ulCount)
+        {
+            g_ulUARTTxDMACount = ulCount;
+            MAP_uDMAChannelTransferSet(g_ulUARTTxChannel | UDMA_PRI_SELECT,
+                                       UDMA_MODE_BASIC,
+                                       g_pcUARTTxBuffer + ulRead,
+                                       (void *)(ulBase + UART_O_DR), ulCount);
+            MAP_uDMAChannelEnable(g_ulUARTTxChannel);
+        }
+    }
+
+    //
+    // Reenable the UART interrupt.
+    //
+    MAP_IntEnable(g_ulUARTInt[g_ulPortNum]);
+}
+#elif defined(UART_BUFFERED)
 static void
 UARTPrimeTransmit(unsigned long ulBase)
 {
@@ -324,6 +452,10 @@ UARTPrimeTransmit(unsigned long ulBase)
 //! caller has previously configured the relevant UART pins for operation as a
 //! UART rather than as GPIOs.
 //!
+//! When the module is built with \b UART_DMA, this function also takes the
+//! uDMA channel for the transmit side of the UART, so the caller must have
+//! enabled the uDMA controller and set its control table first.
+//!
 //! \return None.
 //
 //*****************************************************************************
@@ -369,12 +501,37 @@ UARTStdioConfig(unsigned long ulPortNum, unsigned long ulBaud,
                             (UART_CONFIG_PAR_NONE | UART_CONFIG_STOP_ONE |
                              UART_CONFIG_WLEN_8));
 
-#ifdef UART_BUFFERED
+#ifdef UART_DMA
+    //
+    // Have the UART ask the uDMA controller for more data whenever the TX
+    // FIFO has room for a burst of four bytes, and interrupt when any
+    // character is received.
+    //
+    MAP_UARTFIFOLevelSet(g_ulBase, UART_FIFO_TX4_8, UART_FIFO_RX1_8);
+
+    //
+    // Set up the uDMA channel to move bytes from the transmit buffer into the
+    // UART data register, four at a time.
+    //
+    g_ulUARTTxChannel = g_ulUARTTxDMA[ulPortNum] & 0xff;
+    MAP_uDMAChannelAssign(g_ulUARTTxDMA[ulPortNum]);
+    MAP_uDMAChannelAttributeDisable(g_ulUARTTxChannel,
+                                    UDMA_ATTR_ALTSELECT | UDMA_ATTR_USEBURST |
+                                    UDMA_ATTR_HIGH_PRIORITY |
+                                    UDMA_ATTR_REQMASK);
+    MAP_uDMAChannelControlSet(g_ulUARTTxChannel | UDMA_PRI_SELECT,
+                              UDMA_SIZE_8 | UDMA_SRC_INC_8 |
+                              UDMA_DST_INC_NONE | UDMA_ARB_4);
+    MAP_UARTDMAEnable(g_ulBase, UART_DMA_TX);
+#elif defined(UART_BUFFERED)
     //
     // Set the UART to interrupt whenever the TX FIFO is almost empty or
     // when any character is received.
     //
     MAP_UARTFIFOLevelSet(g_ulBase, UART_FIFO_TX1_8, UART_FIFO_RX1_8);
+#endif
+
+#ifdef UART_BUFFERED
 
     //
     // Flush both the buffers.
@@ -391,7 +548,8 @@ UARTStdioConfig(unsigned long ulPortNum, unsigned long ulBaud,
     // We are configured for buffered output so enable the master interrupt
     // for this UART and the receive interrupts.  We don't actually enable the
     // transmit interrupt in the UART itself until some data has been placed
-    // in the transmit buffer.
+    // in the transmit buffer.  With UART_DMA it is never enabled, since the
+    // end of each uDMA transfer raises the UART interrupt instead.
     //
     MAP_UARTIntDisable(g_ulBase, 0xFFFFFFFF);
     MAP_UARTIntEnable(g_ulBase, UART_INT_RX | UART_INT_RT);
@@ -498,7 +656,7 @@ int
 UARTwrite(const char *pcBuf, unsigned long ulLen)
 {
 #ifdef UART_BUFFERED
-    unsigned int uIdx;
+    unsigned long ulIdx, ulRun, ulSpan, ulFree, ulWrite;
 
     //
     // Check for valid arguments.
@@ -507,45 +665,69 @@ UARTwrite(const char *pcBuf, unsigned long ulLen)
     ASSERT(g_ulBase != 0);
 
     //
-    // Send the characters
+    // Find the room in the buffer once, rather than for each character.  One
+    // byte is always left unused so that a full buffer is not mistaken for
+    // an empty one.
     //
-    for(uIdx = 0; uIdx < ulLen; uIdx++)
+    ulFree = TX_BUFFER_FREE - 1;
+    ulWrite = g_ulUARTTxWriteIndex;
+
+    //
+    // Send the characters a run at a time, each run ending at a \n or at the
+    // end of the string.
+    //
+    for(ulIdx = 0; ulIdx < ulLen; )
     {
         //
-        // If the character to the UART is \n, then add a \r before it so that
-        // \n is translated to \n\r in the output.
+        // Find the end of this run, and cut it short if it does not all fit.
         //
-        if(pcBuf[uIdx] == '\n')
+        for(ulRun = ulIdx; (ulRun < ulLen) && (pcBuf[ulRun] != '\n'); ulRun++)
         {
-            if(!TX_BUFFER_FULL)
-            {
-                g_pcUARTTxBuffer[g_ulUARTTxWriteIndex] = '\r';
-                ADVANCE_TX_BUFFER_INDEX(g_ulUARTTxWriteIndex);
-            }
-            else
-            {
-                //
-                // Buffer is full - discard remaining characters and return.
-                //
-                break;
-            }
         }
+        ulRun -= ulIdx;
+        if(ulRun > ulFree)
+        {
+            ulRun = ulFree;
+        }
+        ulFree -= ulRun;
 
         //
-        // Send the character to the UART output.
+        // Copy the run into the buffer, in two pieces if it wraps around the
+        // end.
         //
-        if(!TX_BUFFER_FULL)
+        while(ulRun)
         {
-            g_pcUARTTxBuffer[g_ulUARTTxWriteIndex] = pcBuf[uIdx];
-            ADVANCE_TX_BUFFER_INDEX(g_ulUARTTxWriteIndex);
+            ulSpan = UART_TX_BUFFER_SIZE - ulWrite;
+            if(ulSpan > ulRun)
+            {
+                ulSpan = ulRun;
+            }
+            memcpy(g_pcUARTTxBuffer + ulWrite, pcBuf + ulIdx, ulSpan);
+            ulWrite = WRAP_TX_BUFFER_INDEX(ulWrite + ulSpan);
+            g_ulUARTTxWriteIndex = ulWrite;
+            ulIdx += ulSpan;
+            ulRun -= ulSpan;
         }
-        else
+
+        //
+        // Stop if the whole string has been sent, or the buffer is full.
+        //
+        if((ulIdx == ulLen) || (pcBuf[ulIdx] != '\n') || (ulFree < 2))
         {
-            //
-            // Buffer is full - discard remaining characters and return.
-            //
             break;
         }
+
+        //
+        // The character to the UART is \n, so add a \r before it so that \n
+        // is translated to \r\n in the output.
+        //
+        g_pcUARTTxBuffer[ulWrite] = '\r';
+        ulWrite = WRAP_TX_BUFFER_INDEX(ulWrite + 1);
+        g_pcUARTTxBuffer[ulWrite] = '\n';
+        ulWrite = WRAP_TX_BUFFER_INDEX(ulWrite + 1);
+        g_ulUARTTxWriteIndex = ulWrite;
+        ulFree -= 2;
+        ulIdx++;
     }
 
     //
@@ -555,13 +737,15 @@ UARTwrite(const char *pcBuf, unsigned long ulLen)
     if(!TX_BUFFER_EMPTY)
     {
         UARTPrimeTransmit(g_ulBase);
+#ifndef UART_DMA
         MAP_UARTIntEnable(g_ulBase, UART_INT_TX);
+#endif
     }
 
     //
     // Return the number of characters written.
     //
-    return(uIdx);
+    return(ulIdx);
 #else
     unsigned int uIdx;
 
@@ -1492,6 +1676,14 @@ UARTFlushTx(tBoolean bDiscard)
         //
         ulInt = MAP_IntMasterDisable();
 
+#ifdef UART_DMA
+        //
+        // Stop the uDMA controller part way through the run it was sending.
+        //
+        MAP_uDMAChannelDisable(g_ulUARTTxChannel);
+        g_ulUARTTxDMACount = 0;
+#endif
+
         //
         // Flush the transmit buffer.
         //
@@ -1574,6 +1766,14 @@ UARTStdioIntHandler(void)
     ulInts = MAP_UARTIntStatus(g_ulBase, true);
     MAP_UARTIntClear(g_ulBase, ulInts);
 
+#ifdef UART_DMA
+    //
+    // The end of a uDMA transfer raises this interrupt without setting any
+    // status bit, so see whether the transmit channel has finished and, if
+    // it has, start sending whatever has been written since.
+    //
+    UARTPrimeTransmit(g_ulBase);
+#else
     //
     // Are we being interrupted because the TX FIFO has space available?
     //
@@ -1592,6 +1792,7 @@ UARTStdioIntHandler(void)
             MAP_UARTIntDisable(g_ulBase, UART_INT_TX);
         }
     }
+#endif
 
     //
     // Are we being interrupted due to a received character?
@@ -1719,7 +1920,9 @@ UARTStdioIntHandler(void)
         // gets transmitted.
         //
         UARTPrimeTransmit(g_ulBase);
+#ifndef UART_DMA
         MAP_UARTIntEnable(g_ulBase, UART_INT_TX);
+#endif
     }
 }
 #endif
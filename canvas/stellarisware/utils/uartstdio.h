@@ -51,6 +51,20 @@ extern "C"
 #endif
 #endif
 
+//*****************************************************************************
+//
+// If UART_DMA is defined as well as UART_BUFFERED, the transmit buffer is
+// emptied into the UART by the uDMA controller instead of a byte at a time by
+// the interrupt handler.  The application must enable the uDMA controller and
+// give it a control table, with uDMAEnable() and uDMAControlBaseSet(), before
+// calling UARTStdioConfig().  Buffer sizes that are powers of two are
+// cheapest in either buffered mode.
+//
+//*****************************************************************************
+#if defined(UART_DMA) && !defined(UART_BUFFERED)
+#error "UART_DMA requires UART_BUFFERED."
+#endif
+
 //*****************************************************************************
 //
 // Prototypes for the APIs.
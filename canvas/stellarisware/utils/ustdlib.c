@@ -35,11 +35,77 @@
 
 //*****************************************************************************
 //
-// A mapping from an integer between 0 and 15 to its ASCII character
-// equivalent.
+// Mappings from an integer between 0 and 15 to its ASCII character
+// equivalent, in lower and upper case.
 //
 //*****************************************************************************
 static const char * const g_pcHex = "0123456789abcdef";
+static const char * const g_pcHexUpper = "0123456789ABCDEF";
+
+//*****************************************************************************
+//
+// The two ASCII digits of each number between 0 and 99, so that decimal
+// conversions produce two digits for each division.
+//
+//*****************************************************************************
+static const char g_pcDigitPairs[201] =
+    "0001020304050607080910111213141516171819"
+    "2021222324252627282930313233343536373839"
+    "4041424344454647484950515253545556575859"
+    "6061626364656667686970717273747576777879"
+    "8081828384858687888990919293949596979899";
+
+//*****************************************************************************
+//
+// The number of fractional bits in the values printed by %q.  This follows
+// GLOBAL_Q if it is defined for the build, as IQmath/IQmathLib.h expects, and
+// otherwise matches the default of IQmath.
+//
+//*****************************************************************************
+#ifndef USTDLIB_GLOBAL_Q
+#ifdef GLOBAL_Q
+#define USTDLIB_GLOBAL_Q        GLOBAL_Q
+#else
+#define USTDLIB_GLOBAL_Q        24
+#endif
+#endif
+
+//*****************************************************************************
+//
+// The precision used by %q and %Q when none is given, as for %f.
+//
+//*****************************************************************************
+#define DEFAULT_PRECISION       6
+
+//*****************************************************************************
+//
+// The value of the precision of a conversion when none is given.
+//
+//*****************************************************************************
+#define NO_PRECISION            0xffffffff
+
+//*****************************************************************************
+//
+// The size of the buffer used to convert a number, and where the decimal
+// point of a fixed-point value is placed in it.  There is room for the
+// integer part of the largest value before the point, and for all 31
+// fraction digits that the smallest fraction can have after it.
+//
+//*****************************************************************************
+#define NUM_SIZE                64
+#define NUM_POINT               24
+
+//*****************************************************************************
+//
+// Values used to scan the format string a word at a time.  HAS_ZERO_BYTE() is
+// non-zero if any byte of the word is zero, and exclusive ORing the word with
+// PERCENT_BYTES makes zero any byte that is a '%'.
+//
+//*****************************************************************************
+#define LOW_BYTES               (~0UL / 255)
+#define HIGH_BITS               (LOW_BYTES * 0x80)
+#define PERCENT_BYTES           (LOW_BYTES * '%')
+#define HAS_ZERO_BYTE(x)        (((x) - LOW_BYTES) & ~(x) & HIGH_BITS)
 
 //*****************************************************************************
 //
@@ -103,8 +169,181 @@ ustrncpy (char *pcDst, const char *pcSrc, int iNum)
 
 //*****************************************************************************
 //
-//! A simple vsnprintf function supporting \%c, \%d, \%p, \%s, \%u, \%x, and
-//! \%X.
+// Copies characters to the output buffer, or as many of them as there is
+// room for, and updates the space remaining.
+//
+// Returns a pointer to the end of what was copied.
+//
+//*****************************************************************************
+static char *
+UCopy(char *pcBuf, unsigned long *pulSize, const char *pcSrc,
+      unsigned long ulCount)
+{
+    if(ulCount > *pulSize)
+    {
+        ulCount = *pulSize;
+    }
+    memcpy(pcBuf, pcSrc, ulCount);
+    *pulSize -= ulCount;
+    return(pcBuf + ulCount);
+}
+
+//*****************************************************************************
+//
+// Fills the output buffer with a number of copies of a character, or as many
+// as there is room for, and updates the space remaining.
+//
+// Returns a pointer to the end of what was filled.
+//
+//*****************************************************************************
+static char *
+UFill(char *pcBuf, unsigned long *pulSize, char cFill, unsigned long ulCount)
+{
+    if(ulCount > *pulSize)
+    {
+        ulCount = *pulSize;
+    }
+    memset(pcBuf, cFill, ulCount);
+    *pulSize -= ulCount;
+    return(pcBuf + ulCount);
+}
+
+//*****************************************************************************
+//
+// Converts a value to decimal, working back from the end of a buffer.  The
+// digits are produced two at a time from a table, and since the divisor is a
+// constant the compiler divides with a multiply, so this takes a fraction of
+// the time of dividing by the base for each digit.
+//
+// Returns a pointer to the first digit.
+//
+//*****************************************************************************
+static char *
+UDecimal(char *pcEnd, unsigned long ulValue)
+{
+    unsigned long ulPair;
+
+    while(ulValue >= 100)
+    {
+        ulPair = (ulValue % 100) * 2;
+        ulValue /= 100;
+        *--pcEnd = g_pcDigitPairs[ulPair + 1];
+        *--pcEnd = g_pcDigitPairs[ulPair];
+    }
+
+    if(ulValue >= 10)
+    {
+        *--pcEnd = g_pcDigitPairs[(ulValue * 2) + 1];
+        *--pcEnd = g_pcDigitPairs[ulValue * 2];
+    }
+    else
+    {
+        *--pcEnd = '0' + (char)ulValue;
+    }
+
+    return(pcEnd);
+}
+
+//*****************************************************************************
+//
+// Converts a value to hexadecimal, working back from the end of a buffer.
+// Each digit is the bottom four bits of the value, so no division is needed.
+//
+// Returns a pointer to the first digit.
+//
+//*****************************************************************************
+static char *
+UHex(char *pcEnd, unsigned long ulValue, const char *pcDigits)
+{
+    do
+    {
+        *--pcEnd = pcDigits[ulValue & 15];
+        ulValue >>= 4;
+    }
+    while(ulValue);
+
+    return(pcEnd);
+}
+
+//*****************************************************************************
+//
+// Converts the magnitude of a fixed-point value with ulQ fractional bits to
+// decimal with ulPrec digits after the point.  The exact value is rounded to
+// the nearest, with ties to even, as the C library does for %f.  The integer
+// part is written back from pcPoint, and the point and the fraction forward
+// from it.  At most ulQ fraction digits are written, since any more would all
+// be zero.
+//
+// Returns a pointer to the first digit, and the number of fraction digits
+// written in *pulFrac.
+//
+//*****************************************************************************
+static char *
+UFixed(char *pcPoint, unsigned long ulValue, unsigned long ulQ,
+       unsigned long ulPrec, unsigned long *pulFrac)
+{
+    unsigned long long ullFrac, ullMask;
+    unsigned long ulDigits, ulIdx;
+
+    //
+    // Split the value into its integer and fraction parts.
+    //
+    ullMask = (1ULL << ulQ) - 1;
+    ullFrac = ulValue & ullMask;
+    ulValue >>= ulQ;
+
+    //
+    // Produce each fraction digit by multiplying the fraction by ten and
+    // taking the integer part.
+    //
+    ulDigits = (ulPrec < ulQ) ? ulPrec : ulQ;
+    for(ulIdx = 1; ulIdx <= ulDigits; ulIdx++)
+    {
+        ullFrac *= 10;
+        pcPoint[ulIdx] = '0' + (char)(ullFrac >> ulQ);
+        ullFrac &= ullMask;
+    }
+
+    //
+    // Round on what is left of the fraction.  The parity of an ASCII digit is
+    // that of the digit, so the last digit written can be tested directly.
+    //
+    if((ulDigits < ulQ) &&
+       ((ullFrac > (1ULL << (ulQ - 1))) ||
+        ((ullFrac == (1ULL << (ulQ - 1))) &&
+         ((ulDigits ? (unsigned long)pcPoint[ulDigits] : ulValue) & 1))))
+    {
+        //
+        // Carry into the fraction digits, and on into the integer part if
+        // they are all nines.
+        //
+        for(ulIdx = ulDigits; ulIdx; ulIdx--)
+        {
+            if(pcPoint[ulIdx] != '9')
+            {
+                pcPoint[ulIdx]++;
+                break;
+            }
+            pcPoint[ulIdx] = '0';
+        }
+        if(!ulIdx)
+        {
+            ulValue++;
+        }
+    }
+
+    //
+    // Place the point and convert the integer part.
+    //
+    *pcPoint = '.';
+    *pulFrac = ulDigits;
+    return(UDecimal(pcPoint, ulValue));
+}
+
+//*****************************************************************************
+//
+//! A simple vsnprintf function supporting \%c, \%d, \%p, \%q, \%s, \%u, \%x,
+//! and \%X.
 //!
 //! \param pcBuf points to the buffer where the converted string is stored.
 //! \param ulSize is the size of the buffer.
@@ -120,18 +359,29 @@ ustrncpy (char *pcDst, const char *pcSrc, int iNum)
 //! - \%s to print a string
 //! - \%u to print an unsigned decimal value
 //! - \%x to print a hexadecimal value using lower case letters
-//! - \%X to print a hexadecimal value using lower case letters (not upper case
-//! letters as would typically be used)
+//! - \%X to print a hexadecimal value using upper case letters
 //! - \%p to print a pointer as a hexadecimal value
+//! - \%q to print a signed fixed-point value, such as an IQmath \e _iq, with
+//! USTDLIB_GLOBAL_Q fractional bits
+//! - \%Q to print a signed fixed-point value whose number of fractional bits,
+//! from 0 to 31, is given by an \e int argument before the value
 //! - \%\% to print out a \% character
 //!
-//! For \%d, \%i, \%p, \%s, \%u, \%x, and \%X, an optional number may reside
-//! between the \% and the format character, which specifies the minimum number
-//! of characters to use for that value; if preceded by a 0 then the extra
-//! characters will be filled with zeros instead of spaces.  For example,
-//! ``\%8d'' will use eight characters to print the decimal value with spaces
-//! added to reach eight; ``\%08d'' will use eight characters as well but will
-//! add zeroes instead of spaces.
+//! Between the \% and the format character there may be, in order, any of the
+//! flags \b -, \b +, space and \b 0, a minimum field width, a precision, and
+//! an \b l, which is ignored since all values are \e long sized.  These have
+//! the same meaning as in the C library, and the width and precision may be
+//! given as \b * to take them from an \e int argument.  For example, ``\%8d''
+//! will use eight characters to print the decimal value with spaces added to
+//! reach eight; ``\%08d'' will use eight characters as well but will add
+//! zeroes instead of spaces; and ``\%-8s'' will add spaces after the string
+//! rather than before it.
+//!
+//! The precision of \%q and \%Q is the number of digits after the decimal
+//! point, six by default, and the value is rounded as by \%f in the C library.
+//! For example, with the default of 24 fractional bits, ``\%.3q'' prints
+//! _IQ(1.5) as ``1.500''.  USTDLIB_GLOBAL_Q follows GLOBAL_Q if that is
+//! defined when this file is built, and is otherwise 24.
 //!
 //! The type of the arguments after \e pcString must match the requirements of
 //! the format string.  For example, if an integer was passed where a string
@@ -156,9 +406,11 @@ int
 uvsnprintf(char *pcBuf, unsigned long ulSize, const char *pcString,
            va_list vaArgP)
 {
-    unsigned long ulIdx, ulValue, ulCount, ulBase, ulNeg;
-    char *pcStr, cFill;
-    int iConvertCount = 0;
+    unsigned long ulIdx, ulValue, ulWidth, ulPrec, ulLen, ulZeros, ulTrail;
+    unsigned long ulPad, ulQ, ulLeft, ulWord;
+    const char *pcStr;
+    char pcNum[NUM_SIZE], cFill, cPlus, cSign;
+    int iConvertCount, iArg;
 
     //
     // Check the arguments.
@@ -186,491 +438,437 @@ uvsnprintf(char *pcBuf, unsigned long ulSize, const char *pcString,
     while(*pcString)
     {
         //
-        // Find the first non-% character, or the end of the string.
+        // Find the first % character, or the end of the string.  Once the
+        // pointer is word aligned, a whole word is checked at a time.  Reading
+        // an aligned word never crosses into another page or memory
+        // protection region, so it is safe to read past the end of the string
+        // within the last word.  The word is copied out with memcpy() rather
+        // than read through a cast pointer, which would access the characters
+        // as an unsigned long; with the pointer aligned, the compiler still
+        // makes the copy a single load.
         //
-        for(ulIdx = 0; (pcString[ulIdx] != '%') && (pcString[ulIdx] != '\0');
-            ulIdx++)
+        pcStr = pcString;
+        while(((unsigned long)pcStr & (sizeof(unsigned long) - 1)) &&
+              (*pcStr != '%') && (*pcStr != '\0'))
         {
+            pcStr++;
         }
+        if((*pcStr != '%') && (*pcStr != '\0'))
+        {
+            while(1)
+            {
+                memcpy(&ulWord, pcStr, sizeof(ulWord));
+                if(HAS_ZERO_BYTE(ulWord) ||
+                   HAS_ZERO_BYTE(ulWord ^ PERCENT_BYTES))
+                {
+                    break;
+                }
+                pcStr += sizeof(unsigned long);
+            }
+            while((*pcStr != '%') && (*pcStr != '\0'))
+            {
+                pcStr++;
+            }
+        }
+
+        //
+        // Write this portion of the string to the output buffer, or as much
+        // of it as will fit.  Update the conversion count.  This will be the
+        // number of characters that should have been written, even if there
+        // was not room in the buffer.
+        //
+        ulIdx = pcStr - pcString;
+        pcBuf = UCopy(pcBuf, &ulSize, pcString, ulIdx);
+        iConvertCount += ulIdx;
+        pcString = pcStr;
 
         //
-        // Write this portion of the string to the output buffer.  If there are
-        // more characters to write than there is space in the buffer, then
-        // only write as much as will fit in the buffer.
+        // Stop at the end of the string.
         //
-        if(ulIdx > ulSize)
+        if(*pcString != '%')
         {
-            ustrncpy(pcBuf, pcString, ulSize);
-            pcBuf += ulSize;
-            ulSize = 0;
+            break;
         }
-        else
+
+        //
+        // Skip the %.
+        //
+        pcString++;
+
+        //
+        // Set the field width to zero, the fill character to space, and no
+        // precision or sign (that is, to the defaults).
+        //
+        ulWidth = 0;
+        ulPrec = NO_PRECISION;
+        ulLeft = 0;
+        cFill = ' ';
+        cPlus = 0;
+
+        //
+        // Read the flags.
+        //
+        for(;; pcString++)
         {
-            ustrncpy(pcBuf, pcString, ulIdx);
-            pcBuf += ulIdx;
-            ulSize -= ulIdx;
+            if(*pcString == '-')
+            {
+                ulLeft = 1;
+            }
+            else if(*pcString == '0')
+            {
+                cFill = '0';
+            }
+            else if(*pcString == '+')
+            {
+                cPlus = '+';
+            }
+            else if(*pcString == ' ')
+            {
+                if(!cPlus)
+                {
+                    cPlus = ' ';
+                }
+            }
+            else
+            {
+                break;
+            }
         }
 
         //
-        // Update the conversion count.  This will be the number of characters
-        // that should have been written, even if there was not room in the
-        // buffer.
+        // Read the field width.  A negative width from the arguments is a -
+        // flag and a positive width.
         //
-        iConvertCount += ulIdx;
+        if(*pcString == '*')
+        {
+            iArg = va_arg(vaArgP, int);
+            if(iArg < 0)
+            {
+                ulLeft = 1;
+                iArg = -iArg;
+            }
+            ulWidth = iArg;
+            pcString++;
+        }
+        else
+        {
+            while((*pcString >= '0') && (*pcString <= '9'))
+            {
+                ulWidth = (ulWidth * 10) + (*pcString++ - '0');
+            }
+        }
 
         //
-        // Skip the portion of the format string that was written.
+        // Read the precision.  A negative precision from the arguments is
+        // taken as none.
         //
-        pcString += ulIdx;
+        if(*pcString == '.')
+        {
+            pcString++;
+            if(*pcString == '*')
+            {
+                iArg = va_arg(vaArgP, int);
+                ulPrec = (iArg < 0) ? NO_PRECISION : (unsigned long)iArg;
+                pcString++;
+            }
+            else
+            {
+                ulPrec = 0;
+                while((*pcString >= '0') && (*pcString <= '9'))
+                {
+                    ulPrec = (ulPrec * 10) + (*pcString++ - '0');
+                }
+            }
+        }
 
         //
-        // See if the next character is a %.
+        // Skip the length modifier, since every value is a long.
         //
-        if(*pcString == '%')
+        while(*pcString == 'l')
         {
-            //
-            // Skip the %.
-            //
             pcString++;
+        }
 
-            //
-            // Set the digit count to zero, and the fill character to space
-            // (that is, to the defaults).
-            //
-            ulCount = 0;
-            cFill = ' ';
+        //
+        // The field is made up of the sign, any zeros needed to reach the
+        // precision, the converted value, and any trailing zeros of a fixed
+        // point fraction.  Most conversions have none but the value.
+        //
+        cSign = 0;
+        ulZeros = 0;
+        ulTrail = 0;
 
+        //
+        // Determine how to handle the next character.
+        //
+        switch(*pcString++)
+        {
             //
-            // It may be necessary to get back here to process more characters.
-            // Goto's aren't pretty, but effective.  I feel extremely dirty for
-            // using not one but two of the beasts.
+            // Handle the %c command.
             //
-again:
+            case 'c':
+            {
+                //
+                // Get the value from the varargs.
+                //
+                pcNum[0] = (char)va_arg(vaArgP, unsigned long);
+                pcStr = pcNum;
+                ulLen = 1;
+                cFill = ' ';
+                break;
+            }
 
             //
-            // Determine how to handle the next character.
+            // Handle the %d and %i commands.
             //
-            switch(*pcString++)
+            case 'd':
+            case 'i':
             {
                 //
-                // Handle the digit characters.
+                // Get the value from the varargs.
+                //
+                ulValue = va_arg(vaArgP, unsigned long);
+
+                //
+                // If the value is negative, make it positive and indicate
+                // that a minus sign is needed.
                 //
-                case '0':
-                case '1':
-                case '2':
-                case '3':
-                case '4':
-                case '5':
-                case '6':
-                case '7':
-                case '8':
-                case '9':
+                if((long)ulValue < 0)
                 {
-                    //
-                    // If this is a zero, and it is the first digit, then the
-                    // fill character is a zero instead of a space.
-                    //
-                    if((pcString[-1] == '0') && (ulCount == 0))
-                    {
-                        cFill = '0';
-                    }
+                    ulValue = -(long)ulValue;
+                    cSign = '-';
+                }
+                else
+                {
+                    cSign = cPlus;
+                }
 
-                    //
-                    // Update the digit count.
-                    //
-                    ulCount *= 10;
-                    ulCount += pcString[-1] - '0';
+                //
+                // Convert the value to ASCII.
+                //
+                pcStr = UDecimal(pcNum + NUM_SIZE, ulValue);
+                goto integer;
+            }
 
-                    //
-                    // Get the next character.
-                    //
-                    goto again;
-                }
+            //
+            // Handle the %s command.
+            //
+            case 's':
+            {
+                //
+                // Get the string pointer from the varargs.
+                //
+                pcStr = va_arg(vaArgP, char *);
 
                 //
-                // Handle the %c command.
+                // Determine the length of the string, which is no more than
+                // the precision.
                 //
-                case 'c':
+                if(ulPrec == NO_PRECISION)
+                {
+                    ulLen = strlen(pcStr);
+                }
+                else
                 {
-                    //
-                    // Get the value from the varargs.
-                    //
-                    ulValue = va_arg(vaArgP, unsigned long);
-
-                    //
-                    // Copy the character to the output buffer, if there is
-                    // room.  Update the buffer size remaining.
-                    //
-                    if(ulSize != 0)
+                    for(ulLen = 0; (ulLen < ulPrec) && pcStr[ulLen]; ulLen++)
                     {
-                        *pcBuf++ = (char)ulValue;
-                        ulSize--;
                     }
-
-                    //
-                    // Update the conversion count.
-                    //
-                    iConvertCount++;
-
-                    //
-                    // This command has been handled.
-                    //
-                    break;
                 }
 
                 //
-                // Handle the %d and %i commands.
+                // Strings are only padded with spaces.
                 //
-                case 'd':
-                case 'i':
-                {
-                    //
-                    // Get the value from the varargs.
-                    //
-                    ulValue = va_arg(vaArgP, unsigned long);
-
-                    //
-                    // If the value is negative, make it positive and indicate
-                    // that a minus sign is needed.
-                    //
-                    if((long)ulValue < 0)
-                    {
-                        //
-                        // Make the value positive.
-                        //
-                        ulValue = -(long)ulValue;
-
-                        //
-                        // Indicate that the value is negative.
-                        //
-                        ulNeg = 1;
-                    }
-                    else
-                    {
-                        //
-                        // Indicate that the value is positive so that a
-                        // negative sign isn't inserted.
-                        //
-                        ulNeg = 0;
-                    }
+                cFill = ' ';
+                break;
+            }
 
-                    //
-                    // Set the base to 10.
-                    //
-                    ulBase = 10;
+            //
+            // Handle the %u command.
+            //
+            case 'u':
+            {
+                //
+                // Get the value from the varargs and convert it to ASCII.
+                //
+                ulValue = va_arg(vaArgP, unsigned long);
+                pcStr = UDecimal(pcNum + NUM_SIZE, ulValue);
+                goto integer;
+            }
 
-                    //
-                    // Convert the value to ASCII.
-                    //
-                    goto convert;
-                }
+            //
+            // Handle the %x, %X and %p commands.  We alias %p to %x.
+            //
+            case 'x':
+            case 'X':
+            case 'p':
+            {
+                //
+                // Get the value from the varargs and convert it to ASCII.
+                //
+                ulValue = va_arg(vaArgP, unsigned long);
+                pcStr = UHex(pcNum + NUM_SIZE, ulValue,
+                             (pcString[-1] == 'X') ? g_pcHexUpper : g_pcHex);
 
                 //
-                // Handle the %s command.
+                // A precision is the minimum number of digits, and turns off
+                // zero fill.  A value of zero with a precision of zero has no
+                // digits at all.
                 //
-                case 's':
+integer:
+                ulLen = (pcNum + NUM_SIZE) - pcStr;
+                if(ulPrec != NO_PRECISION)
                 {
-                    //
-                    // Get the string pointer from the varargs.
-                    //
-                    pcStr = va_arg(vaArgP, char *);
-
-                    //
-                    // Determine the length of the string.
-                    //
-                    for(ulIdx = 0; pcStr[ulIdx] != '\0'; ulIdx++)
+                    cFill = ' ';
+                    if(!ulPrec && !ulValue)
                     {
+                        ulLen = 0;
                     }
-
-                    //
-                    // Update the convert count to include any padding that
-                    // should be necessary (regardless of whether we have space
-                    // to write it or not).
-                    //
-                    if(ulCount > ulIdx)
-                    {
-                        iConvertCount += (ulCount - ulIdx);
-                    }
-
-                    //
-                    // Copy the string to the output buffer.  Only copy as much
-                    // as will fit in the buffer.  Update the output buffer
-                    // pointer and the space remaining.
-                    //
-                    if(ulIdx > ulSize)
+                    if(ulPrec > ulLen)
                     {
-                        ustrncpy(pcBuf, pcStr, ulSize);
-                        pcBuf += ulSize;
-                        ulSize = 0;
+                        ulZeros = ulPrec - ulLen;
                     }
-                    else
-                    {
-                        ustrncpy(pcBuf, pcStr, ulIdx);
-                        pcBuf += ulIdx;
-                        ulSize -= ulIdx;
-
-                        //
-                        // Write any required padding spaces assuming there is
-                        // still space in the buffer.
-                        //
-                        if(ulCount > ulIdx)
-                        {
-                            ulCount -= ulIdx;
-                            if(ulCount > ulSize)
-                            {
-                                ulCount = ulSize;
-                            }
-                            ulSize =- ulCount;
-
-                            while(ulCount--)
-                            {
-                                *pcBuf++ = ' ';
-                            }
-                        }
-                    }
-
-                    //
-                    // Update the conversion count.  This will be the number of
-                    // characters that should have been written, even if there
-                    // was not room in the buffer.
-                    //
-                    iConvertCount += ulIdx;
-
-                    //
-                    // This command has been handled.
-                    //
-                    break;
                 }
+                break;
+            }
 
+            //
+            // Handle the %q and %Q commands.
+            //
+            case 'q':
+            case 'Q':
+            {
                 //
-                // Handle the %u command.
+                // Get the number of fractional bits and the value.
                 //
-                case 'u':
+                if(pcString[-1] == 'Q')
+                {
+                    ulQ = va_arg(vaArgP, int);
+                }
+                else
                 {
-                    //
-                    // Get the value from the varargs.
-                    //
-                    ulValue = va_arg(vaArgP, unsigned long);
-
-                    //
-                    // Set the base to 10.
-                    //
-                    ulBase = 10;
-
-                    //
-                    // Indicate that the value is positive so that a minus sign
-                    // isn't inserted.
-                    //
-                    ulNeg = 0;
-
-                    //
-                    // Convert the value to ASCII.
-                    //
-                    goto convert;
+                    ulQ = USTDLIB_GLOBAL_Q;
                 }
+                ASSERT(ulQ < 32);
+                ulValue = va_arg(vaArgP, unsigned long);
 
                 //
-                // Handle the %x and %X commands.  Note that they are treated
-                // identically; that is, %X will use lower case letters for a-f
-                // instead of the upper case letters is should use.  We also
-                // alias %p to %x.
+                // If the value is negative, make it positive and indicate
+                // that a minus sign is needed.
                 //
-                case 'x':
-                case 'X':
-                case 'p':
+                if((long)ulValue < 0)
                 {
-                    //
-                    // Get the value from the varargs.
-                    //
-                    ulValue = va_arg(vaArgP, unsigned long);
-
-                    //
-                    // Set the base to 16.
-                    //
-                    ulBase = 16;
-
-                    //
-                    // Indicate that the value is positive so that a minus sign
-                    // isn't inserted.
-                    //
-                    ulNeg = 0;
-
-                    //
-                    // Determine the number of digits in the string version of
-                    // the value.
-                    //
-convert:
-                    for(ulIdx = 1;
-                        (((ulIdx * ulBase) <= ulValue) &&
-                         (((ulIdx * ulBase) / ulBase) == ulIdx));
-                        ulIdx *= ulBase, ulCount--)
-                    {
-                    }
-
-                    //
-                    // If the value is negative, reduce the count of padding
-                    // characters needed.
-                    //
-                    if(ulNeg)
-                    {
-                        ulCount--;
-                    }
-
-                    //
-                    // If the value is negative and the value is padded with
-                    // zeros, then place the minus sign before the padding.
-                    //
-                    if(ulNeg && (ulSize != 0) && (cFill == '0'))
-                    {
-                        //
-                        // Place the minus sign in the output buffer.
-                        //
-                        *pcBuf++ = '-';
-                        ulSize--;
-
-                        //
-                        // Update the conversion count.
-                        //
-                        iConvertCount++;
-
-                        //
-                        // The minus sign has been placed, so turn off the
-                        // negative flag.
-                        //
-                        ulNeg = 0;
-                    }
+                    ulValue = -(long)ulValue;
+                    cSign = '-';
+                }
+                else
+                {
+                    cSign = cPlus;
+                }
 
-                    //
-                    // See if there are more characters in the specified field
-                    // width than there are in the conversion of this value.
-                    //
-                    if((ulCount > 1) && (ulCount < 65536))
-                    {
-                        //
-                        // Loop through the required padding characters.
-                        //
-                        for(ulCount--; ulCount; ulCount--)
-                        {
-                            //
-                            // Copy the character to the output buffer if there
-                            // is room.
-                            //
-                            if(ulSize != 0)
-                            {
-                                *pcBuf++ = cFill;
-                                ulSize--;
-                            }
-
-                            //
-                            // Update the conversion count.
-                            //
-                            iConvertCount++;
-                        }
-                    }
+                //
+                // Convert the value to ASCII.  Any digits beyond those that
+                // the fraction can have are zeros added after it, and with a
+                // precision of zero there is no decimal point.
+                //
+                if(ulPrec == NO_PRECISION)
+                {
+                    ulPrec = DEFAULT_PRECISION;
+                }
+                pcStr = UFixed(pcNum + NUM_POINT, ulValue, ulQ, ulPrec,
+                               &ulIdx);
+                ulLen = (pcNum + NUM_POINT) - pcStr;
+                if(ulPrec)
+                {
+                    ulLen += ulIdx + 1;
+                }
+                ulTrail = ulPrec - ulIdx;
+                break;
+            }
 
-                    //
-                    // If the value is negative, then place the minus sign
-                    // before the number.
-                    //
-                    if(ulNeg && (ulSize != 0))
-                    {
-                        //
-                        // Place the minus sign in the output buffer.
-                        //
-                        *pcBuf++ = '-';
-                        ulSize--;
-
-                        //
-                        // Update the conversion count.
-                        //
-                        iConvertCount++;
-                    }
+            //
+            // Handle the %% command.
+            //
+            case '%':
+            {
+                //
+                // Simply write a single %.
+                //
+                pcBuf = UCopy(pcBuf, &ulSize, pcString - 1, 1);
 
-                    //
-                    // Convert the value into a string.
-                    //
-                    for(; ulIdx; ulIdx /= ulBase)
-                    {
-                        //
-                        // Copy the character to the output buffer if there is
-                        // room.
-                        //
-                        if(ulSize != 0)
-                        {
-                            *pcBuf++ = g_pcHex[(ulValue / ulIdx) % ulBase];
-                            ulSize--;
-                        }
-
-                        //
-                        // Update the conversion count.
-                        //
-                        iConvertCount++;
-                    }
+                //
+                // Update the conversion count.
+                //
+                iConvertCount++;
 
-                    //
-                    // This command has been handled.
-                    //
-                    break;
-                }
+                //
+                // This command has been handled.
+                //
+                continue;
+            }
 
+            //
+            // Handle all other commands.
+            //
+            default:
+            {
                 //
-                // Handle the %% command.
+                // Indicate an error.  If the format string ended part way
+                // through the command, stop at the end of it.
                 //
-                case '%':
+                pcBuf = UCopy(pcBuf, &ulSize, "ERROR", 5);
+                iConvertCount += 5;
+                if(pcString[-1] == '\0')
                 {
-                    //
-                    // Simply write a single %.
-                    //
-                    if(ulSize != 0)
-                    {
-                        *pcBuf++ = pcString[-1];
-                        ulSize--;
-                    }
-
-                    //
-                    // Update the conversion count.
-                    //
-                    iConvertCount++;
-
-                    //
-                    // This command has been handled.
-                    //
-                    break;
+                    pcString--;
                 }
 
                 //
-                // Handle all other commands.
+                // This command has been handled.
                 //
-                default:
-                {
-                    //
-                    // Indicate an error.
-                    //
-                    if(ulSize >= 5)
-                    {
-                        ustrncpy(pcBuf, "ERROR", 5);
-                        pcBuf += 5;
-                        ulSize -= 5;
-                    }
-                    else
-                    {
-                        ustrncpy(pcBuf, "ERROR", ulSize);
-                        pcBuf += ulSize;
-                        ulSize = 0;
-                    }
+                continue;
+            }
+        }
 
-                    //
-                    // Update the conversion count.
-                    //
-                    iConvertCount += 5;
+        //
+        // Find the padding needed to reach the field width.
+        //
+        ulIdx = (cSign ? 1 : 0) + ulZeros + ulLen + ulTrail;
+        ulPad = (ulWidth > ulIdx) ? (ulWidth - ulIdx) : 0;
 
-                    //
-                    // This command has been handled.
-                    //
-                    break;
-                }
-            }
+        //
+        // Pad with spaces before the field, unless it is padded with zeros
+        // after the sign or with spaces after the field.
+        //
+        if(!ulLeft && (cFill == ' '))
+        {
+            pcBuf = UFill(pcBuf, &ulSize, ' ', ulPad);
         }
+        if(cSign)
+        {
+            pcBuf = UCopy(pcBuf, &ulSize, &cSign, 1);
+        }
+        if(!ulLeft && (cFill == '0'))
+        {
+            ulZeros += ulPad;
+        }
+
+        //
+        // Write the field, and any padding after it.
+        //
+        pcBuf = UFill(pcBuf, &ulSize, '0', ulZeros);
+        pcBuf = UCopy(pcBuf, &ulSize, pcStr, ulLen);
+        pcBuf = UFill(pcBuf, &ulSize, '0', ulTrail);
+        if(ulLeft)
+        {
+            pcBuf = UFill(pcBuf, &ulSize, ' ', ulPad);
+        }
+
+        //
+        // Update the conversion count.  This will be the number of characters
+        // that should have been written, even if there was not room in the
+        // buffer.
+        //
+        iConvertCount += ulIdx + ulPad;
     }
 
     //
@@ -686,7 +884,8 @@ convert:
 
 //*****************************************************************************
 //
-//! A simple sprintf function supporting \%c, \%d, \%p, \%s, \%u, \%x, and \%X.
+//! A simple sprintf function supporting \%c, \%d, \%p, \%q, \%s, \%u, \%x,
+//! and \%X.
 //!
 //! \param pcBuf is the buffer where the converted string is stored.
 //! \param pcString is the format string.
@@ -694,25 +893,8 @@ convert:
 //! format string.
 //!
 //! This function is very similar to the C library <tt>sprintf()</tt> function.
-//! Only the following formatting characters are supported:
-//!
-//! - \%c to print a character
-//! - \%d or \%i to print a decimal value
-//! - \%s to print a string
-//! - \%u to print an unsigned decimal value
-//! - \%x to print a hexadecimal value using lower case letters
-//! - \%X to print a hexadecimal value using lower case letters (not upper case
-//! letters as would typically be used)
-//! - \%p to print a pointer as a hexadecimal value
-//! - \%\% to print out a \% character
-//!
-//! For \%d, \%i, \%p, \%s, \%u, \%x, and \%X, an optional number may reside
-//! between the \% and the format character, which specifies the minimum number
-//! of characters to use for that value; if preceded by a 0 then the extra
-//! characters will be filled with zeros instead of spaces.  For example,
-//! ``\%8d'' will use eight characters to print the decimal value with spaces
-//! added to reach eight; ``\%08d'' will use eight characters as well but will
-//! add zeros instead of spaces.
+//! The formatting characters, flags, field widths and precisions that are
+//! supported are those of uvsnprintf().
 //!
 //! The type of the arguments after \e pcString must match the requirements of
 //! the format string.  For example, if an integer was passed where a string
@@ -755,8 +937,8 @@ usprintf(char *pcBuf, const char *pcString, ...)
 
 //*****************************************************************************
 //
-//! A simple snprintf function supporting \%c, \%d, \%p, \%s, \%u, \%x, and
-//! \%X.
+//! A simple snprintf function supporting \%c, \%d, \%p, \%q, \%s, \%u, \%x,
+//! and \%X.
 //!
 //! \param pcBuf is the buffer where the converted string is stored.
 //! \param ulSize is the size of the buffer.
@@ -765,25 +947,8 @@ usprintf(char *pcBuf, const char *pcString, ...)
 //! format string.
 //!
 //! This function is very similar to the C library <tt>sprintf()</tt> function.
-//! Only the following formatting characters are supported:
-//!
-//! - \%c to print a character
-//! - \%d or \%i to print a decimal value
-//! - \%s to print a string
-//! - \%u to print an unsigned decimal value
-//! - \%x to print a hexadecimal value using lower case letters
-//! - \%X to print a hexadecimal value using lower case letters (not upper case
-//! letters as would typically be used)
-//! - \%p to print a pointer as a hexadecimal value
-//! - \%\% to print out a \% character
-//!
-//! For \%d, \%i, \%p, \%s, \%u, \%x, and \%X, an optional number may reside
-//! between the \% and the format character, which specifies the minimum number
-//! of characters to use for that value; if preceded by a 0 then the extra
-//! characters will be filled with zeros instead of spaces.  For example,
-//! ``\%8d'' will use eight characters to print the decimal value with spaces
-//! added to reach eight; ``\%08d'' will use eight characters as well but will
-//! add zeros instead of spaces.
+//! The formatting characters, flags, field widths and precisions that are
+//! supported are those of uvsnprintf().
 //!
 //! The type of the arguments after \e pcString must match the requirements of
 //! the format string.  For example, if an integer was passed where a string